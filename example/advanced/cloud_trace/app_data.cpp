@@ -38,6 +38,7 @@ AppData::AppData(void)
  , render_width(raytrace_width)
  , render_height(raytrace_height)
  , tile(16)
+ , work_unit_time(20.0f)
  , unit_opacity(0.03)
  , unit_attenuation(0.02)
  , cloud_count(512)
@@ -129,6 +130,16 @@ bool AppData::ParseArgs(int argc, char** argv)
 		"by this argument."
 		);
 
+	// raytrace work unit time
+	parser.AddArg("-wt", "--work-unit-time", work_unit_time)
+		.SetMin(0.0f)
+		.AddDesc(
+		"Sets the time (in milliseconds) that the raytracer threads "
+		"should spend on a single unit of work. The threads raytrace "
+		"runs of adjacent tiles, the length of which is adapted "
+		"to the measured time per tile. Zero means single tiles."
+		);
+
 	// cloud count
 	parser.AddArg("-cc", "--cloud-count", cloud_count)
 		.SetMax(1024)
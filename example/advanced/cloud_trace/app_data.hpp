@@ -77,6 +77,9 @@ struct AppData
 	unsigned cols(void) const;
 	unsigned tiles(void) const;
 
+	// the target duration of a unit of raytracer work (in milliseconds)
+	float work_unit_time;
+
 	// cloud parameters
 	float unit_opacity, unit_attenuation;
 	unsigned cloud_count, cloud_res;
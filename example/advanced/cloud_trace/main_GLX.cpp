@@ -50,9 +50,12 @@ public:
 private:
 
 	const unsigned max_tiles;
-	unsigned tile, face;
+	const unsigned row_length;
+	unsigned face;
 	bool keep_running;
 
+	TileScheduler tile_scheduler;
+
 	void SkipFaces(const AppData& app_data)
 	{
 		while((face < 6) && (app_data.skip_face[face]))
@@ -80,17 +83,20 @@ public:
 		x11::Display& disp,
 		glx::Context& ctx,
 		RaytracerData& rtd,
-		RaytracerTarget& rtt
+		RaytracerTarget& rtt,
+		unsigned n_threads
 	): display(disp)
 	 , context(ctx)
 	 , rt_data(rtd)
 	 , rt_target(rtt)
 	 , max_tiles(app_data.tiles())
-	 , tile(0)
+	 , row_length(app_data.cols())
 	 , face(0)
 	 , keep_running(true)
+	 , tile_scheduler(n_threads, app_data.work_unit_time*0.001)
 	{
 		SkipFaces(app_data);
+		tile_scheduler.Reset(max_tiles, row_length);
 	}
 
 	std::unique_lock<std::mutex> Lock(void)
@@ -135,9 +141,7 @@ public:
 
 	bool FaceDone(void)
 	{
-		std::lock_guard<std::mutex> lock(mutex);
-
-		return (tile >= max_tiles);
+		return tile_scheduler.Dispatched();
 	}
 
 	void NextFace(const AppData& app_data)
@@ -149,31 +153,26 @@ public:
 			++face;
 			SkipFaces(app_data);
 
-			if(face < 6) tile = 0;
+			if(face < 6) tile_scheduler.Reset(max_tiles, row_length);
 			else keep_running = false;
 		}
 		else keep_running = false;
 	}
 
-	bool NextFaceTile(unsigned& rt_tile)
+	bool NextFaceTiles(unsigned thread_id, unsigned& rt_tile, unsigned& count)
 	{
-		std::lock_guard<std::mutex> lock(mutex);
-
-		rt_tile = tile;
+		if(Done()) return false;
+		return tile_scheduler.Next(thread_id, rt_tile, count);
+	}
 
-		if(keep_running)
-		{
-			if(tile < max_tiles)
-			{
-				++tile;
-				return true;
-			}
-		}
-		return false;
+	void FinishedTiles(unsigned thread_id, unsigned count, double seconds)
+	{
+		tile_scheduler.Finished(thread_id, count, seconds);
 	}
 
 	void LogProgress(const AppData& app_data)
 	{
+		unsigned tile = tile_scheduler.TilesDone();
 		unsigned prom = ((1000*tile)/app_data.tiles());
 		app_data.logstr()
 			<< "Rendering face tile "
@@ -187,9 +186,50 @@ public:
 			<< " %)"
 			<< std::endl;
 	}
+
+	void LogThreadStats(const AppData& app_data, double face_time)
+	{
+		if(app_data.verbosity > 1)
+		{
+			app_data.logstr()
+				<< "Raytraced cube face "
+				<< face
+				<< " in "
+				<< face_time
+				<< " s"
+				<< std::endl;
+
+			for(unsigned t=0; t!=tile_scheduler.Workers(); ++t)
+			{
+				TileSchedulerStats stats = tile_scheduler.Stats(t);
+				app_data.logstr()
+					<< " Raytracer thread "
+					<< t
+					<< ": "
+					<< stats.tiles
+					<< " tiles in "
+					<< stats.units
+					<< " units, "
+					<< stats.steals
+					<< " steals, "
+					<< stats.busy_time
+					<< " s busy ("
+					<< (stats.tiles?1000*stats.busy_time/stats.tiles:0.0)
+					<< " ms per tile)"
+					<< std::endl;
+			}
+		}
+		tile_scheduler.ResetStats();
+	}
 };
 
-void thread_loop(AppData& app_data, CommonData& common, x11::Display& display, glx::Context& context)
+void thread_loop(
+	AppData& app_data,
+	CommonData& common,
+	x11::Display& display,
+	glx::Context& context,
+	unsigned thread_id
+)
 {
 	Context gl;
 	ResourceAllocator alloc;
@@ -219,17 +259,27 @@ void thread_loop(AppData& app_data, CommonData& common, x11::Display& display, g
 		raytracer.BeginWork(app_data);
 
 		auto bl_begin = std::chrono::steady_clock::now();
-		unsigned tile = 0;
-		while(common.NextFaceTile(tile))
+		unsigned tile = 0, count = 0;
+		while(common.NextFaceTiles(thread_id, tile, count))
 		{
-			raytracer.Raytrace(app_data, tile);
-			backlog.push_back(tile);
+			auto rt_begin = std::chrono::steady_clock::now();
+			raytracer.Raytrace(app_data, tile, count);
+			gl.Finish();
 
 			auto now = std::chrono::steady_clock::now();
+			common.FinishedTiles(
+				thread_id,
+				count,
+				std::chrono::duration<double>(now-rt_begin).count()
+			);
+
+			for(unsigned t=0; t!=count; ++t)
+			{
+				backlog.push_back(tile+t);
+			}
 
 			if(bl_begin + bl_interval < now)
 			{
-				gl.Finish();
 				auto lock = common.Lock();
 				for(unsigned bl_tile : backlog)
 				{
@@ -244,7 +294,6 @@ void thread_loop(AppData& app_data, CommonData& common, x11::Display& display, g
 				backlog.clear();
 				bl_begin = now;
 			}
-			else gl.Finish();
 		}
 		auto lock = common.Lock();
 		for(unsigned bl_tile : backlog)
@@ -303,6 +352,7 @@ void pbuffer_loop(
 		gl.Finish();
 
 		// signal all threads that they can start raytracing tiles
+		auto face_begin = std::chrono::steady_clock::now();
 		common.master_ready.Signal(n_threads);
 
 		if(common.Done()) break;
@@ -345,6 +395,12 @@ void pbuffer_loop(
 
 		// wait for all raytracer threads to finish
 		common.thread_ready.Wait(n_threads);
+		common.LogThreadStats(
+			app_data,
+			std::chrono::duration<double>(
+				std::chrono::steady_clock::now()-face_begin
+			).count()
+		);
 
 		for(unsigned b=0; b!=2; ++b)
 		{
@@ -418,6 +474,7 @@ void window_loop(
 		auto log_time = std::chrono::system_clock::now();
 
 		// signal all threads that they can start raytracing tiles
+		auto face_begin = std::chrono::steady_clock::now();
 		common.master_ready.Signal(n_threads);
 
 		while(!common.FaceDone())
@@ -474,6 +531,12 @@ void window_loop(
 
 		// wait for all raytracer threads to finish
 		common.thread_ready.Wait(n_threads);
+		common.LogThreadStats(
+			app_data,
+			std::chrono::duration<double>(
+				std::chrono::steady_clock::now()-face_begin
+			).count()
+		);
 
 		renderer.Render(app_data);
 		common.context.SwapBuffers(window);
@@ -500,7 +563,8 @@ void window_loop(
 void main_thread(
 	AppData& app_data,
 	CommonData& common,
-	const std::string& screen_name
+	const std::string& screen_name,
+	unsigned thread_id
 )
 {
 #ifdef CLOUD_TRACE_USE_NV_copy_image
@@ -546,7 +610,7 @@ void main_thread(
 
 	if(!common.Done())
 	{
-		try { thread_loop(app_data, common, display, context); }
+		try { thread_loop(app_data, common, display, context, thread_id); }
 		catch(...)
 		{
 			common.PushError(std::current_exception());
@@ -570,23 +634,24 @@ void call_drawable_loop(
 	ResourceAllocator res_alloc;
 	RaytracerTarget rt_target(app_data, res_alloc);
 
+	if(app_data.raytracer_params.empty())
+	{
+		app_data.raytracer_params.push_back(std::string());
+	}
+
 	CommonData common(
 		app_data,
 		display,
 		context,
 		rt_data,
-		rt_target
+		rt_target,
+		unsigned(app_data.raytracer_params.size())
 	);
 
 	std::vector<std::thread> threads;
 
 	try
 	{
-		if(app_data.raytracer_params.empty())
-		{
-			app_data.raytracer_params.push_back(std::string());
-		}
-
 		for(auto& param : app_data.raytracer_params)
 		{
 			if(app_data.verbosity > 2)
@@ -611,7 +676,8 @@ void call_drawable_loop(
 					main_thread,
 					std::ref(app_data),
 					std::ref(common),
-					std::cref(param)
+					std::cref(param),
+					unsigned(threads.size())
 				)
 			);
 		}
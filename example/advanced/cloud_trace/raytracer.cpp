@@ -136,14 +136,18 @@ void Raytracer::EndWork(const AppData& app_data)
 	else gl.Disable(Capability::ScissorTest);
 }
 
-void Raytracer::Raytrace(const AppData& app_data, unsigned tile)
+void Raytracer::Raytrace(const AppData& app_data, unsigned tile, unsigned count)
 {
 	unsigned i = tile % w;
 	unsigned j = tile / w;
-	assert(j*h+i < w*h);
+	assert(j < h);
+	// a run of adjacent tiles in the same row
+	assert(count > 0);
+	assert(i+count <= w);
 
 	int sx = app_data.tile*i;
 	int sy = app_data.tile*(h-j-1);
+	int sw = app_data.tile*count;
 	int ss = app_data.tile;
 
 	if(app_data.clip_tiles)
@@ -160,7 +164,7 @@ void Raytracer::Raytrace(const AppData& app_data, unsigned tile)
 
 		resources.raytrace_prog.clip_plane1.Set(
 			Planef::FromPointAndNormal(
-				Vec3f((sx+ss)*iw-1, 0, 1),
+				Vec3f((sx+sw)*iw-1, 0, 1),
 				Vec3f(-1, 0, 0)
 			).Equation()
 		);
@@ -179,7 +183,7 @@ void Raytracer::Raytrace(const AppData& app_data, unsigned tile)
 			).Equation()
 		);
 	}
-	else gl.Scissor(sx, sy, ss, ss);
+	else gl.Scissor(sx, sy, sw, ss);
 
 	screen.Draw();
 }
@@ -85,7 +85,7 @@ public:
 	void InitFrame(AppData&, unsigned face);
 	void BeginWork(const AppData&);
 	void EndWork(const AppData&);
-	void Raytrace(const AppData&, unsigned tile);
+	void Raytrace(const AppData&, unsigned tile, unsigned count = 1);
 };
 
 } // namespace cloud_trace
@@ -4,13 +4,16 @@
  *
  *  @author Matus Chochlik
  *
- *  Copyright 2008-2014 Matus Chochlik. Distributed under the Boost
+ *  Copyright 2008-2015 Matus Chochlik. Distributed under the Boost
  *  Software License, Version 1.0. (See accompanying file
  *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
  */
 
 #include "threads.hpp"
 
+#include <algorithm>
+#include <cassert>
+
 namespace oglplus {
 namespace cloud_trace {
 
@@ -48,5 +51,142 @@ bool Semaphore::Signalled(unsigned n)
 	return _value >= n;
 }
 
+TileScheduler::TileScheduler(unsigned workers, double unit_time)
+ : _workers(std::max(workers, 1u))
+ , _unit_time(unit_time)
+ , _row_length(1)
+ , _remaining(0)
+ , _done(0)
+{
+	for(Worker& w: _workers)
+	{
+		w.begin = w.end = 0;
+		w.tile_time = 0.0;
+	}
+	ResetStats();
+}
+
+void TileScheduler::Reset(unsigned tiles, unsigned row_length)
+{
+	assert(row_length > 0);
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	_row_length = row_length;
+	_remaining = tiles;
+	_done = 0;
+
+	const unsigned n = unsigned(_workers.size());
+	for(unsigned w=0; w!=n; ++w)
+	{
+		_workers[w].begin = (tiles*(w+0))/n;
+		_workers[w].end   = (tiles*(w+1))/n;
+	}
+}
+
+bool TileScheduler::_steal(unsigned worker)
+{
+	unsigned victim = worker;
+	unsigned most = 0;
+	for(unsigned w=0; w!=_workers.size(); ++w)
+	{
+		unsigned left = _workers[w].end-_workers[w].begin;
+		if(most < left)
+		{
+			most = left;
+			victim = w;
+		}
+	}
+	if(most == 0) return false;
+
+	// the thief takes the back half of the victim's range
+	Worker& v = _workers[victim];
+	Worker& t = _workers[worker];
+	unsigned n = (most+1)/2;
+	t.end = v.end;
+	t.begin = v.end-n;
+	v.end -= n;
+	++t.stats.steals;
+	return true;
+}
+
+bool TileScheduler::Next(unsigned worker, unsigned& first, unsigned& count)
+{
+	assert(worker < _workers.size());
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	Worker& w = _workers[worker];
+	if((w.begin == w.end) && !_steal(worker))
+	{
+		return false;
+	}
+
+	// until the tile time is measured single tiles are raytraced
+	unsigned n = 1;
+	if(w.tile_time > 0.0)
+	{
+		n = std::max(unsigned(_unit_time/w.tile_time), 1u);
+	}
+	n = std::min(n, w.end-w.begin);
+	n = std::min(n, _row_length-(w.begin % _row_length));
+
+	first = w.begin;
+	count = n;
+	w.begin += n;
+	_remaining -= n;
+	return true;
+}
+
+void TileScheduler::Finished(unsigned worker, unsigned count, double seconds)
+{
+	assert(worker < _workers.size());
+	assert(count > 0);
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	Worker& w = _workers[worker];
+	double t = seconds/count;
+	w.tile_time = (w.tile_time > 0.0)?(0.75*w.tile_time+0.25*t):t;
+
+	w.stats.tiles += count;
+	w.stats.units += 1;
+	w.stats.busy_time += seconds;
+	_done += count;
+}
+
+bool TileScheduler::Dispatched(void)
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	return _remaining == 0;
+}
+
+unsigned TileScheduler::TilesDone(void)
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	return _done;
+}
+
+unsigned TileScheduler::Workers(void) const
+{
+	return unsigned(_workers.size());
+}
+
+TileSchedulerStats TileScheduler::Stats(unsigned worker)
+{
+	assert(worker < _workers.size());
+	std::lock_guard<std::mutex> lock(_mutex);
+	return _workers[worker].stats;
+}
+
+void TileScheduler::ResetStats(void)
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	for(Worker& w: _workers)
+	{
+		w.stats.tiles = 0;
+		w.stats.units = 0;
+		w.stats.steals = 0;
+		w.stats.busy_time = 0.0;
+	}
+}
+
 } // namespace cloud_trace
 } // namespace oglplus
@@ -4,7 +4,7 @@
  *
  *  @author Matus Chochlik
  *
- *  Copyright 2008-2014 Matus Chochlik. Distributed under the Boost
+ *  Copyright 2008-2015 Matus Chochlik. Distributed under the Boost
  *  Software License, Version 1.0. (See accompanying file
  *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
  */
@@ -13,6 +13,7 @@
 
 #include <mutex>
 #include <condition_variable>
+#include <vector>
 
 namespace oglplus {
 namespace cloud_trace {
@@ -34,6 +35,67 @@ public:
 	bool Signalled(unsigned n = 1);
 };
 
+struct TileSchedulerStats
+{
+	// the number of raytraced tiles
+	unsigned tiles;
+	// the number of work units (runs of adjacent tiles)
+	unsigned units;
+	// the number of times work was stolen from other workers
+	unsigned steals;
+	// the time spent raytracing (in seconds)
+	double busy_time;
+};
+
+// Distributes the tiles of a face between the raytracer threads.
+// Each worker starts with a contiguous range of tiles and takes
+// runs of adjacent tiles from its front. The length of the runs
+// is adapted so that they take roughly the same time to raytrace.
+// Workers that run out of tiles steal half of the range of the most
+// loaded worker.
+class TileScheduler
+{
+private:
+	struct Worker
+	{
+		unsigned begin, end;
+		// the measured (smoothed) time per tile
+		double tile_time;
+		TileSchedulerStats stats;
+	};
+	std::mutex _mutex;
+	std::vector<Worker> _workers;
+	const double _unit_time;
+	unsigned _row_length;
+	unsigned _remaining;
+	unsigned _done;
+
+	bool _steal(unsigned worker);
+public:
+	TileScheduler(unsigned workers, double unit_time);
+
+	// starts a new face with the specified number of tiles,
+	// the runs of tiles do not cross the rows of the face
+	void Reset(unsigned tiles, unsigned row_length);
+
+	// gets the next run of tiles for the specified worker
+	bool Next(unsigned worker, unsigned& first, unsigned& count);
+
+	// reports that a worker raytraced count tiles in seconds
+	void Finished(unsigned worker, unsigned count, double seconds);
+
+	// returns true if all tiles of the face were handed out
+	bool Dispatched(void);
+
+	unsigned TilesDone(void);
+
+	unsigned Workers(void) const;
+
+	TileSchedulerStats Stats(unsigned worker);
+
+	void ResetStats(void);
+};
+
 } // namespace cloud_trace
 } // namespace oglplus
 
@@ -4,7 +4,7 @@
  *
  *  @author Matus Chochlik
  *
- *  Copyright 2012-2013 Matus Chochlik. Distributed under the Boost
+ *  Copyright 2012-2015 Matus Chochlik. Distributed under the Boost
  *  Software License, Version 1.0. (See accompanying file
  *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
  */
@@ -12,8 +12,7 @@
 #ifndef OGLPLUS_EXAMPLE_SPECTRA_CALCULATOR_HPP
 #define OGLPLUS_EXAMPLE_SPECTRA_CALCULATOR_HPP
 
-#include <wx/string.h>
-
+#include <cstddef>
 #include <cstdint>
 #include <complex>
 #include <memory>
@@ -56,6 +55,13 @@ SpectraGetDefaultSignalTransform(
 	std::size_t spectrum_size
 );
 
+// the calculators running on the CPU do not need the shared objects
+extern std::shared_ptr<SpectraCalculator>
+SpectraMakeCPUFourierTransf(std::size_t spectrum_size);
+
+extern std::shared_ptr<SpectraCalculator>
+SpectraMakeCPUFFTTransf(std::size_t spectrum_size, unsigned thread_count);
+
 struct SpectraFourierMatrixGen
 {
 	double inv_n;
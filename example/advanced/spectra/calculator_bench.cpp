@@ -0,0 +1,230 @@
+/*
+ *  .file advanced/spectra/calculator_bench.cpp
+ *  .brief Measures the throughput of the CPU spectrum calculators
+ *
+ *  @author Matus Chochlik
+ *
+ *  Copyright 2012-2015 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#include <oglplus/math/constants.hpp>
+
+#include "calculator.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <complex>
+#include <iostream>
+#include <iomanip>
+#include <thread>
+#include <vector>
+#include <cmath>
+
+// calculates the spectra of the rows of a signal the same way
+// as the visualisation does and returns the number of rows per second
+static double SpectraBenchCalculator(
+	SpectraCalculator& calc,
+	const std::vector<float>& signal,
+	std::size_t rows
+)
+{
+	const std::size_t m = calc.MaxConcurrentTransforms();
+	const std::size_t spectrum_size = calc.OutputSize();
+	std::vector<float> output(spectrum_size*rows);
+	std::vector<unsigned> transform_ids(m);
+
+	std::size_t done = 0;
+	auto start = std::chrono::steady_clock::now();
+	double seconds = 0.0;
+	do
+	{
+		calc.BeginBatch();
+		for(std::size_t i=0; i!=m; ++i)
+		{
+			transform_ids[i] = calc.BeginTransform(
+				signal.data()+i,
+				calc.InputSize(),
+				output.data()+i*spectrum_size,
+				spectrum_size
+			);
+		}
+		for(std::size_t i=0; i!=rows; ++i)
+		{
+			calc.FinishTransform(
+				transform_ids[i%m],
+				output.data()+i*spectrum_size,
+				spectrum_size
+			);
+			std::size_t j=i+m;
+			if(j<rows)
+			{
+				transform_ids[i%m] = calc.BeginTransform(
+					signal.data()+j,
+					calc.InputSize(),
+					output.data()+j*spectrum_size,
+					spectrum_size
+				);
+			}
+		}
+		calc.FinishBatch();
+		done += rows;
+
+		seconds = std::chrono::duration<double>(
+			std::chrono::steady_clock::now()-start
+		).count();
+	}
+	while(seconds < 0.5);
+
+	return done/seconds;
+}
+
+// compares the spectra calculated by calc for the first few rows
+// of a signal with a double precision DFT, returns the largest error
+// relative to the largest magnitude of the reference spectrum
+static double SpectraCheckCalculator(
+	SpectraCalculator& calc,
+	const std::vector<float>& signal,
+	std::size_t rows
+)
+{
+	const std::size_t n = calc.InputSize();
+	const std::size_t spectrum_size = calc.OutputSize();
+	const double twopi = oglplus::math::TwoPi();
+	std::vector<float> output(spectrum_size);
+	std::vector<double> reference(spectrum_size);
+	double max_error = 0.0;
+
+	for(std::size_t row=0; row!=rows; ++row)
+	{
+		const float* input = signal.data()+row;
+		calc.BeginBatch();
+		calc.FinishTransform(
+			calc.BeginTransform(
+				input,
+				n,
+				output.data(),
+				spectrum_size
+			),
+			output.data(),
+			spectrum_size
+		);
+		calc.FinishBatch();
+
+		double max_ref = 0.0;
+		for(std::size_t k=0; k!=spectrum_size; ++k)
+		{
+			std::complex<double> sum(0.0, 0.0);
+			for(std::size_t i=0; i!=n; ++i)
+			{
+				sum += std::polar(
+					double(input[i]),
+					-twopi*double((i*k)%n)/n
+				);
+			}
+			reference[k] = std::abs(sum)/std::sqrt(double(n));
+			max_ref = std::max(max_ref, reference[k]);
+		}
+		for(std::size_t k=0; k!=spectrum_size; ++k)
+		{
+			max_error = std::max(
+				max_error,
+				std::abs(output[k]-reference[k])/max_ref
+			);
+		}
+	}
+	return max_error;
+}
+
+int main(void)
+{
+	const std::size_t rows = 256;
+	const std::size_t sizes[] = {64, 100, 128, 256, 500, 512, 1024, 2048, 4096};
+	// the matrix of the bigger transforms does not fit into the memory
+	const std::size_t max_matrix_size = 1024;
+	// the single precision results differ from the reference
+	// by up to about 2e-7 of the largest magnitude
+	const std::size_t check_rows = 4;
+	const double max_error = 5e-7;
+	bool failed = false;
+
+	unsigned thread_count = std::thread::hardware_concurrency();
+	if(thread_count < 1) thread_count = 1;
+	if(thread_count > 8) thread_count = 8;
+
+	std::cout
+		<< std::setw(8) << "size"
+		<< std::setw(14) << "matrix"
+		<< std::setw(14) << "FFT"
+		<< std::setw(14) << "FFT x" << thread_count
+		<< "  [spectra/s]"
+		<< std::endl;
+
+	for(std::size_t spectrum_size: sizes)
+	{
+		std::vector<float> signal(spectrum_size*2+rows);
+		const double twopi = oglplus::math::TwoPi();
+		for(std::size_t i=0; i!=signal.size(); ++i)
+		{
+			double t = double(i)/signal.size();
+			signal[i] = float(
+				0.5*std::sin(twopi*t*440.0)+
+				0.3*std::sin(twopi*t*1250.0)+
+				0.2*std::sin(twopi*t*33.0)
+			);
+		}
+
+		std::shared_ptr<SpectraCalculator> calculators[3] = {
+			(spectrum_size <= max_matrix_size)?
+				SpectraMakeCPUFourierTransf(spectrum_size):
+				std::shared_ptr<SpectraCalculator>(),
+			SpectraMakeCPUFFTTransf(spectrum_size, 1),
+			SpectraMakeCPUFFTTransf(spectrum_size, thread_count)
+		};
+		for(auto& calc: calculators)
+		{
+			if(!calc) continue;
+			double error = SpectraCheckCalculator(
+				*calc,
+				signal,
+				check_rows
+			);
+			if(!(error <= max_error))
+			{
+				std::cerr
+					<< calc->Name()
+					<< " of size " << spectrum_size
+					<< " differs from the reference DFT by "
+					<< error
+					<< std::endl;
+				failed = true;
+			}
+		}
+
+		std::cout << std::setw(8) << spectrum_size;
+		std::cout << std::setw(14) << std::fixed << std::setprecision(0);
+		if(spectrum_size <= max_matrix_size)
+		{
+			std::cout << SpectraBenchCalculator(
+				*calculators[0],
+				signal,
+				rows
+			);
+		}
+		else std::cout << "-";
+
+		std::cout << std::setw(14) << SpectraBenchCalculator(
+			*calculators[1],
+			signal,
+			rows
+		);
+		std::cout << std::setw(14) << SpectraBenchCalculator(
+			*calculators[2],
+			signal,
+			rows
+		);
+		std::cout << std::endl;
+	}
+	return failed?1:0;
+}
@@ -4,16 +4,37 @@
  *
  *  @author Matus Chochlik
  *
- *  Copyright 2012-2013 Matus Chochlik. Distributed under the Boost
+ *  Copyright 2012-2015 Matus Chochlik. Distributed under the Boost
  *  Software License, Version 1.0. (See accompanying file
  *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
  */
 
+#include <oglplus/math/constants.hpp>
+
 #include "calculator.hpp"
 
 #include <vector>
+#include <cmath>
 #include <cassert>
 
+SpectraFourierMatrixGen::SpectraFourierMatrixGen(std::size_t n, std::size_t)
+ : inv_n(1.0/n)
+ , inv_sqrt_n(1.0/std::sqrt(double(n)), 0.0)
+{ }
+
+std::complex<double> SpectraFourierMatrixGen::operator()(
+	std::size_t i,
+	std::size_t k,
+	std::size_t /*n*/,
+	std::size_t /*m*/
+) const
+{
+	const double twopi = oglplus::math::TwoPi();
+	typedef std::complex<double> C;
+	C x(0.0, -twopi*i*k*inv_n);
+	return exp(x)*inv_sqrt_n;
+}
+
 // SpectraNoOpValueTransform
 struct SpectraNoOpValueTransform
 {
@@ -169,7 +190,7 @@ BeginTransform(
 	for(std::size_t row=0; row!=out_size; ++row)
 	{
 		const float* i = input;
-		auto m = mat.begin()+row*out_size;
+		auto m = mat.begin()+row*in_size;
 		ValueType sum = ValueType(0.0);
 		for(std::size_t col=0; col!=in_size; ++col)
 		{
@@ -192,10 +213,7 @@ FinishTransform(
 }
 
 std::shared_ptr<SpectraCalculator>
-SpectraGetDefaultCPUFourierTransf(
-	SpectraSharedObjects&,
-	std::size_t spectrum_size
-)
+SpectraMakeCPUFourierTransf(std::size_t spectrum_size)
 {
 	std::size_t frame_size = spectrum_size*2-1;
 	assert(spectrum_size > 2);
@@ -212,3 +230,11 @@ SpectraGetDefaultCPUFourierTransf(
 	);
 }
 
+std::shared_ptr<SpectraCalculator>
+SpectraGetDefaultCPUFourierTransf(
+	SpectraSharedObjects&,
+	std::size_t spectrum_size
+)
+{
+	return SpectraMakeCPUFourierTransf(spectrum_size);
+}
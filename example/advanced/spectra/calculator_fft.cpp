@@ -0,0 +1,634 @@
+/*
+ *  .file advanced/spectra/calculator_fft.cpp
+ *  .brief Implements the fast Fourier transform spectrum calculator
+ *
+ *  @author Matus Chochlik
+ *
+ *  Copyright 2012-2015 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#include <oglplus/config/simd.hpp>
+#include <oglplus/math/constants.hpp>
+
+#include "calculator.hpp"
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <deque>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <cmath>
+#include <cassert>
+
+#if OGLPLUS_USE_SSE2
+#include <emmintrin.h>
+#endif
+
+// SpectraFFTScalar
+// butterfly arithmetic on single values
+struct SpectraFFTScalar
+{
+	typedef float T;
+
+	static const std::size_t Width = 1;
+
+	static inline T Load(const float* p) { return *p; }
+	static inline void Store(float* p, T v) { *p = v; }
+	static inline T Splat(float v) { return v; }
+	static inline T Add(T a, T b) { return a+b; }
+	static inline T Sub(T a, T b) { return a-b; }
+	static inline T Mul(T a, T b) { return a*b; }
+};
+
+#if OGLPLUS_USE_SSE2
+// SpectraFFTSSE
+// butterfly arithmetic on four values at once
+struct SpectraFFTSSE
+{
+	typedef __m128 T;
+
+	static const std::size_t Width = 4;
+
+	static inline T Load(const float* p) { return _mm_loadu_ps(p); }
+	static inline void Store(float* p, T v) { _mm_storeu_ps(p, v); }
+	static inline T Splat(float v) { return _mm_set1_ps(v); }
+	static inline T Add(T a, T b) { return _mm_add_ps(a, b); }
+	static inline T Sub(T a, T b) { return _mm_sub_ps(a, b); }
+	static inline T Mul(T a, T b) { return _mm_mul_ps(a, b); }
+};
+#endif
+
+// SpectraFFTPass
+// the arguments of a single pass of the Stockham autosort FFT.
+// the pass reads the p inputs of a butterfly from x[q+s*(j+r*m)]
+// and writes its p outputs to y[q+s*(p*j+k)], q<s, j<m, r,k<p
+struct SpectraFFTPass
+{
+	const float *xr, *xi;
+	float *yr, *yi;
+	std::size_t s, m;
+	// twiddle factors W^(j*k) for k in [1, p)
+	const float *wr, *wi;
+};
+
+// (ar + i*ai)*(wr + i*wi)
+template <typename V>
+static inline void SpectraFFTTwiddle(
+	typename V::T& ar,
+	typename V::T& ai,
+	float wr,
+	float wi
+)
+{
+	const typename V::T r = V::Splat(wr);
+	const typename V::T i = V::Splat(wi);
+	const typename V::T t = V::Sub(V::Mul(ar, r), V::Mul(ai, i));
+	ai = V::Add(V::Mul(ar, i), V::Mul(ai, r));
+	ar = t;
+}
+
+template <typename V>
+static std::size_t SpectraFFTRadix2(
+	const SpectraFFTPass& p,
+	std::size_t j,
+	std::size_t q
+)
+{
+	const std::size_t i0 = p.s*j, i1 = p.s*(j+p.m);
+	const std::size_t o0 = p.s*(2*j), o1 = o0+p.s;
+	for(; q+V::Width <= p.s; q += V::Width)
+	{
+		typename V::T ar = V::Load(p.xr+q+i0), ai = V::Load(p.xi+q+i0);
+		typename V::T br = V::Load(p.xr+q+i1), bi = V::Load(p.xi+q+i1);
+
+		V::Store(p.yr+q+o0, V::Add(ar, br));
+		V::Store(p.yi+q+o0, V::Add(ai, bi));
+
+		typename V::T dr = V::Sub(ar, br), di = V::Sub(ai, bi);
+		SpectraFFTTwiddle<V>(dr, di, p.wr[0], p.wi[0]);
+		V::Store(p.yr+q+o1, dr);
+		V::Store(p.yi+q+o1, di);
+	}
+	return q;
+}
+
+template <typename V>
+static std::size_t SpectraFFTRadix4(
+	const SpectraFFTPass& p,
+	std::size_t j,
+	std::size_t q
+)
+{
+	const std::size_t i0 = p.s*j, sm = p.s*p.m;
+	const std::size_t o0 = p.s*(4*j);
+	for(; q+V::Width <= p.s; q += V::Width)
+	{
+		const float* xr = p.xr+q+i0;
+		const float* xi = p.xi+q+i0;
+		typename V::T a0r = V::Load(xr+0*sm), a0i = V::Load(xi+0*sm);
+		typename V::T a1r = V::Load(xr+1*sm), a1i = V::Load(xi+1*sm);
+		typename V::T a2r = V::Load(xr+2*sm), a2i = V::Load(xi+2*sm);
+		typename V::T a3r = V::Load(xr+3*sm), a3i = V::Load(xi+3*sm);
+
+		typename V::T t0r = V::Add(a0r, a2r), t0i = V::Add(a0i, a2i);
+		typename V::T t1r = V::Sub(a0r, a2r), t1i = V::Sub(a0i, a2i);
+		typename V::T t2r = V::Add(a1r, a3r), t2i = V::Add(a1i, a3i);
+		typename V::T t3r = V::Sub(a1r, a3r), t3i = V::Sub(a1i, a3i);
+
+		float* yr = p.yr+q+o0;
+		float* yi = p.yi+q+o0;
+
+		V::Store(yr+0*p.s, V::Add(t0r, t2r));
+		V::Store(yi+0*p.s, V::Add(t0i, t2i));
+
+		// t1 - i*t3
+		typename V::T br = V::Add(t1r, t3i), bi = V::Sub(t1i, t3r);
+		SpectraFFTTwiddle<V>(br, bi, p.wr[0], p.wi[0]);
+		V::Store(yr+1*p.s, br);
+		V::Store(yi+1*p.s, bi);
+
+		typename V::T cr = V::Sub(t0r, t2r), ci = V::Sub(t0i, t2i);
+		SpectraFFTTwiddle<V>(cr, ci, p.wr[1], p.wi[1]);
+		V::Store(yr+2*p.s, cr);
+		V::Store(yi+2*p.s, ci);
+
+		// t1 + i*t3
+		typename V::T dr = V::Sub(t1r, t3i), di = V::Add(t1i, t3r);
+		SpectraFFTTwiddle<V>(dr, di, p.wr[2], p.wi[2]);
+		V::Store(yr+3*p.s, dr);
+		V::Store(yi+3*p.s, di);
+	}
+	return q;
+}
+
+// a butterfly of any radix, computed as a direct DFT
+static void SpectraFFTRadixN(
+	const SpectraFFTPass& p,
+	std::size_t radix,
+	const float* rr,
+	const float* ri,
+	std::size_t j
+)
+{
+	for(std::size_t q=0; q!=p.s; ++q)
+	{
+		for(std::size_t k=0; k!=radix; ++k)
+		{
+			float sr = 0.0f, si = 0.0f;
+			for(std::size_t r=0, rk=0; r!=radix; ++r, rk=(rk+k)%radix)
+			{
+				const std::size_t i = q+p.s*(j+r*p.m);
+				sr += p.xr[i]*rr[rk]-p.xi[i]*ri[rk];
+				si += p.xr[i]*ri[rk]+p.xi[i]*rr[rk];
+			}
+			if(k != 0)
+			{
+				SpectraFFTTwiddle<SpectraFFTScalar>(
+					sr, si,
+					p.wr[k-1],
+					p.wi[k-1]
+				);
+			}
+			const std::size_t o = q+p.s*(radix*j+k);
+			p.yr[o] = sr;
+			p.yi[o] = si;
+		}
+	}
+}
+
+// SpectraFFTPlan
+// precomputed radices and twiddle factors of a complex FFT of given size
+class SpectraFFTPlan
+{
+private:
+	struct Stage
+	{
+		std::size_t radix;
+		std::size_t stride;
+		std::size_t count;
+		// offset of the twiddle factors of this stage
+		std::size_t twiddles;
+		// offset of the roots of unity used by the generic butterfly
+		std::size_t roots;
+	};
+	std::vector<Stage> stages;
+	std::vector<float> tw_r, tw_i;
+	std::vector<float> post_r, post_i;
+	const std::size_t size;
+public:
+	SpectraFFTPlan(std::size_t n);
+
+	std::size_t Size(void) const
+	{
+		return size;
+	}
+
+	// transforms size complex values stored in re and im;
+	// tmp_re and tmp_im are scratch buffers of the same size.
+	// returns true if the result ended up in the scratch buffers
+	bool Execute(float* re, float* im, float* tmp_re, float* tmp_im) const;
+
+	// computes the magnitudes of the spectrum of 2*size real values
+	void Real(const float* input, float* output, float scale, float* buf) const;
+};
+
+SpectraFFTPlan::SpectraFFTPlan(std::size_t n)
+ : size(n)
+{
+	assert(n > 0);
+	const double twopi = oglplus::math::TwoPi();
+
+	// the radix-4 passes go first so that the strides
+	// of the following passes are multiples of the SIMD width
+	std::vector<std::size_t> radices;
+	while(n % 4 == 0) { radices.push_back(4); n /= 4; }
+	while(n % 2 == 0) { radices.push_back(2); n /= 2; }
+	for(std::size_t f=3; n > 1; f += 2)
+	{
+		while(n % f == 0) { radices.push_back(f); n /= f; }
+	}
+
+	std::size_t stride = 1, span = size;
+	for(std::size_t radix: radices)
+	{
+		Stage stage;
+		stage.radix = radix;
+		stage.stride = stride;
+		stage.count = span/radix;
+		stage.twiddles = tw_r.size();
+		for(std::size_t j=0; j!=stage.count; ++j)
+		{
+			for(std::size_t k=1; k!=radix; ++k)
+			{
+				double a = -twopi*double(j*k)/double(span);
+				tw_r.push_back(float(std::cos(a)));
+				tw_i.push_back(float(std::sin(a)));
+			}
+		}
+		stage.roots = tw_r.size();
+		if((radix != 2) && (radix != 4))
+		{
+			for(std::size_t k=0; k!=radix; ++k)
+			{
+				double a = -twopi*double(k)/double(radix);
+				tw_r.push_back(float(std::cos(a)));
+				tw_i.push_back(float(std::sin(a)));
+			}
+		}
+		stages.push_back(stage);
+		stride *= radix;
+		span /= radix;
+	}
+
+	// W_2n^k splitting the spectrum of the packed real sequence
+	post_r.resize(size);
+	post_i.resize(size);
+	for(std::size_t k=0; k!=size; ++k)
+	{
+		double a = -twopi*double(k)/double(2*size);
+		post_r[k] = float(std::cos(a));
+		post_i[k] = float(std::sin(a));
+	}
+}
+
+bool SpectraFFTPlan::Execute(
+	float* re,
+	float* im,
+	float* tmp_re,
+	float* tmp_im
+) const
+{
+	bool swapped = false;
+	for(const Stage& stage: stages)
+	{
+		SpectraFFTPass pass;
+		pass.xr = re;
+		pass.xi = im;
+		pass.yr = tmp_re;
+		pass.yi = tmp_im;
+		pass.s = stage.stride;
+		pass.m = stage.count;
+
+		const std::size_t w = stage.radix-1;
+		for(std::size_t j=0; j!=stage.count; ++j)
+		{
+			pass.wr = tw_r.data()+stage.twiddles+j*w;
+			pass.wi = tw_i.data()+stage.twiddles+j*w;
+
+			std::size_t q = 0;
+			if(stage.radix == 4)
+			{
+#if OGLPLUS_USE_SSE2
+				q = SpectraFFTRadix4<SpectraFFTSSE>(pass, j, q);
+#endif
+				SpectraFFTRadix4<SpectraFFTScalar>(pass, j, q);
+			}
+			else if(stage.radix == 2)
+			{
+#if OGLPLUS_USE_SSE2
+				q = SpectraFFTRadix2<SpectraFFTSSE>(pass, j, q);
+#endif
+				SpectraFFTRadix2<SpectraFFTScalar>(pass, j, q);
+			}
+			else
+			{
+				SpectraFFTRadixN(
+					pass,
+					stage.radix,
+					tw_r.data()+stage.roots,
+					tw_i.data()+stage.roots,
+					j
+				);
+			}
+		}
+		std::swap(re, tmp_re);
+		std::swap(im, tmp_im);
+		swapped = !swapped;
+	}
+	return swapped;
+}
+
+void SpectraFFTPlan::Real(
+	const float* input,
+	float* output,
+	float scale,
+	float* buf
+) const
+{
+	// the even samples are packed into the real parts
+	// and the odd samples into the imaginary parts
+	float* zr = buf+0*size;
+	float* zi = buf+1*size;
+	for(std::size_t k=0; k!=size; ++k)
+	{
+		zr[k] = input[2*k+0];
+		zi[k] = input[2*k+1];
+	}
+	if(Execute(zr, zi, buf+2*size, buf+3*size))
+	{
+		zr = buf+2*size;
+		zi = buf+3*size;
+	}
+
+	// X[k] = E[k] + W_2n^k * O[k], where
+	// E[k] = (Z[k] + conj(Z[n-k]))/2 and
+	// O[k] = (Z[k] - conj(Z[n-k]))/2i
+	scale *= 0.5f;
+	for(std::size_t k=0; k!=size; ++k)
+	{
+		const std::size_t c = (size-k)%size;
+		const float evr = zr[k]+zr[c], evi = zi[k]-zi[c];
+		const float odr = zi[k]+zi[c], odi = zr[c]-zr[k];
+		const float xr = evr+post_r[k]*odr-post_i[k]*odi;
+		const float xi = evi+post_r[k]*odi+post_i[k]*odr;
+		output[k] = std::sqrt(xr*xr+xi*xi)*scale;
+	}
+}
+
+// SpectraFFTTransf
+class SpectraFFTTransf
+ : public SpectraCalculator
+{
+private:
+	const SpectraFFTPlan plan;
+	const std::size_t in_size, out_size;
+	const float scale;
+	std::string name;
+
+	struct Slot
+	{
+		const float* input;
+		float* output;
+		bool busy;
+		std::vector<float> buffer;
+	};
+	std::vector<Slot> slots;
+	unsigned next_slot;
+
+	std::vector<std::thread> workers;
+	std::deque<unsigned> queue;
+	std::mutex mutex;
+	std::condition_variable work_cond, done_cond;
+	bool stop;
+
+	void _work(void);
+	void _transform(Slot& slot) const;
+	void _wait(std::unique_lock<std::mutex>& lock, unsigned tid);
+public:
+	SpectraFFTTransf(
+		std::size_t spectrum_size,
+		const std::string& transf_name,
+		unsigned thread_count
+	);
+
+	~SpectraFFTTransf(void);
+
+	std::size_t InputSize(void) const;
+
+	std::size_t OutputSize(void) const;
+
+	const char* Name(void) const;
+
+	unsigned MaxConcurrentTransforms(void) const;
+
+	void BeginBatch(void);
+
+	void FinishBatch(void);
+
+	unsigned BeginTransform(
+		const float* input,
+		std::size_t inbufsize,
+		float* output,
+		std::size_t outbufsize
+	);
+
+	void FinishTransform(
+		unsigned tid,
+		float* output,
+		std::size_t outbufsize
+	);
+};
+
+SpectraFFTTransf::SpectraFFTTransf(
+	std::size_t spectrum_size,
+	const std::string& transf_name,
+	unsigned thread_count
+): plan(spectrum_size)
+ , in_size(spectrum_size*2)
+ , out_size(spectrum_size)
+ , scale(float(1.0/std::sqrt(double(in_size))))
+ , name(transf_name)
+ , slots(std::max(thread_count, 1u))
+ , next_slot(0)
+ , stop(false)
+{
+	for(Slot& slot: slots)
+	{
+		slot.input = nullptr;
+		slot.output = nullptr;
+		slot.busy = false;
+		slot.buffer.resize(out_size*4);
+	}
+	// with a single slot the transforms are done synchronously
+	if(slots.size() > 1)
+	{
+		for(std::size_t t=0; t!=slots.size(); ++t)
+		{
+			workers.push_back(std::thread(&SpectraFFTTransf::_work, this));
+		}
+	}
+}
+
+SpectraFFTTransf::~SpectraFFTTransf(void)
+{
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		stop = true;
+	}
+	work_cond.notify_all();
+	for(std::thread& worker: workers)
+	{
+		worker.join();
+	}
+}
+
+void SpectraFFTTransf::_transform(Slot& slot) const
+{
+	plan.Real(slot.input, slot.output, scale, slot.buffer.data());
+}
+
+void SpectraFFTTransf::_work(void)
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	while(true)
+	{
+		work_cond.wait(lock, [this](void) { return stop || !queue.empty(); });
+		if(stop) break;
+
+		unsigned tid = queue.front();
+		queue.pop_front();
+
+		lock.unlock();
+		_transform(slots[tid]);
+		lock.lock();
+
+		slots[tid].busy = false;
+		done_cond.notify_all();
+	}
+}
+
+void SpectraFFTTransf::_wait(std::unique_lock<std::mutex>& lock, unsigned tid)
+{
+	done_cond.wait(lock, [this, tid](void) { return !slots[tid].busy; });
+}
+
+std::size_t SpectraFFTTransf::InputSize(void) const
+{
+	return in_size;
+}
+
+std::size_t SpectraFFTTransf::OutputSize(void) const
+{
+	return out_size;
+}
+
+const char* SpectraFFTTransf::Name(void) const
+{
+	return name.c_str();
+}
+
+unsigned SpectraFFTTransf::MaxConcurrentTransforms(void) const
+{
+	return unsigned(slots.size());
+}
+
+void SpectraFFTTransf::BeginBatch(void)
+{
+}
+
+void SpectraFFTTransf::FinishBatch(void)
+{
+	// the inputs of the transforms may not outlive the batch
+	std::unique_lock<std::mutex> lock(mutex);
+	for(unsigned tid=0; tid!=slots.size(); ++tid)
+	{
+		_wait(lock, tid);
+	}
+}
+
+unsigned SpectraFFTTransf::BeginTransform(
+	const float* input,
+	std::size_t inbufsize,
+	float* output,
+	std::size_t outbufsize
+)
+{
+	assert(inbufsize >= in_size);
+	assert(outbufsize >= out_size);
+
+	unsigned tid = next_slot;
+	next_slot = (next_slot+1) % slots.size();
+
+	Slot& slot = slots[tid];
+	if(workers.empty())
+	{
+		slot.input = input;
+		slot.output = output;
+		_transform(slot);
+	}
+	else
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		_wait(lock, tid);
+		slot.input = input;
+		slot.output = output;
+		slot.busy = true;
+		queue.push_back(tid);
+		work_cond.notify_one();
+	}
+	return tid;
+}
+
+void SpectraFFTTransf::FinishTransform(
+	unsigned tid,
+	float* output,
+	std::size_t /*outbufsize*/
+)
+{
+	assert(tid < slots.size());
+	if(!workers.empty())
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		_wait(lock, tid);
+	}
+	assert(slots[tid].output == output);
+	(void)output;
+}
+
+std::shared_ptr<SpectraCalculator>
+SpectraMakeCPUFFTTransf(std::size_t spectrum_size, unsigned thread_count)
+{
+	assert(spectrum_size > 2);
+	return std::make_shared<SpectraFFTTransf>(
+		spectrum_size,
+		"Fast Fourier Transform (CPU)",
+		thread_count
+	);
+}
+
+std::shared_ptr<SpectraCalculator>
+SpectraGetDefaultCPUFFTTransf(
+	SpectraSharedObjects&,
+	std::size_t spectrum_size
+)
+{
+	unsigned thread_count = std::thread::hardware_concurrency();
+	return SpectraMakeCPUFFTTransf(
+		spectrum_size,
+		std::min(std::max(thread_count, 1u), 8u)
+	);
+}
@@ -0,0 +1,119 @@
+/**
+ *  @example standalone/028_gl_call_overhead.cpp
+ *  @brief Measures the CPU overhead of the OGLplus wrappers without a GPU
+ *
+ *  Uses the headless GL dispatch backend which records the GL calls made
+ *  by the wrappers without calling the GL, so this example does not need
+ *  a GL context and can run on machines without graphics.
+ *
+ *  Copyright 2008-2015 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ *
+ */
+#define OGLPLUS_USE_GL_DISPATCH 1
+
+#include <oglplus/gl.hpp>
+#include <oglplus/all.hpp>
+#include <oglplus/dispatch/recorder.hpp>
+
+#include <chrono>
+#include <iostream>
+
+template <typename Func>
+void measure(const char* name, std::size_t repeat, Func func)
+{
+	oglplus::GLHeadlessRecorder recorder;
+	oglplus::GLDispatchBackendScope scope(recorder);
+
+	// warm-up and count the calls per iteration
+	func();
+	std::size_t calls = recorder.CallCount();
+	recorder.Disable();
+
+	auto start = std::chrono::steady_clock::now();
+	for(std::size_t i=0; i!=repeat; ++i)
+	{
+		func();
+	}
+	auto end = std::chrono::steady_clock::now();
+	double ns = std::chrono::duration<double, std::nano>(end-start).count();
+
+	std::cout
+		<< name << ": "
+		<< ns/repeat << " [ns/iteration], "
+		<< calls << " GL calls/iteration, "
+		<< ns/(repeat*(calls?calls:1)) << " [ns/call]"
+		<< std::endl;
+}
+
+int main(void)
+{
+	using namespace oglplus;
+
+	const std::size_t repeat = 100000;
+
+	// the backend used while setting up the objects
+	GLHeadlessRecorder setup;
+	GLDispatchBackendScope setup_scope(setup);
+
+	Context gl;
+	VertexShader vs;
+	vs.Source("#version 150\nvoid main(void){ }").Compile();
+	Program prog;
+	prog.AttachShader(vs).Link().Use();
+	Buffer buf;
+	VertexArray vao;
+	Texture tex;
+
+	Uniform<Vec3f> u_vec(prog, "Vector");
+	Uniform<Mat4f> u_mat(prog, "Matrix");
+
+	GLfloat data[16] = { 0.0f };
+
+	measure("Buffer bind+data", repeat, [&](void) -> void
+	{
+		buf.Bind(Buffer::Target::Array);
+		Buffer::Data(Buffer::Target::Array, 16, data);
+	});
+	measure("VAO+program bind", repeat, [&](void) -> void
+	{
+		vao.Bind();
+		prog.Use();
+	});
+	measure("Texture bind+params", repeat, [&](void) -> void
+	{
+		Texture::Active(0);
+		tex.Bind(Texture::Target::_2D);
+		Texture::MinFilter(Texture::Target::_2D, TextureMinFilter::Linear);
+		Texture::MagFilter(Texture::Target::_2D, TextureMagFilter::Linear);
+	});
+	measure("Uniform setters", repeat, [&](void) -> void
+	{
+		u_vec.Set(Vec3f(1, 2, 3));
+		u_mat.Set(Mat4f());
+	});
+	measure("Capabilities", repeat, [&](void) -> void
+	{
+		gl.Enable(Capability::DepthTest);
+		gl.Disable(Capability::Blend);
+	});
+	measure("Draw", repeat, [&](void) -> void
+	{
+		gl.DrawArrays(PrimitiveType::Triangles, 0, 3);
+	});
+
+	GLHeadlessRecorder recorder;
+	{
+		GLDispatchBackendScope scope(recorder);
+		vao.Bind();
+		prog.Use();
+		u_mat.Set(Mat4f());
+		gl.DrawArrays(PrimitiveType::Triangles, 0, 3);
+	}
+	std::cout << std::endl << "Recorded frame:" << std::endl;
+	recorder.Dump(std::cout);
+	recorder.Report(std::cout);
+
+	return 0;
+}
@@ -0,0 +1,194 @@
+/**
+ *  @example standalone/031_program_binary_cache.cpp
+ *  @brief Measures the program build times with the program binary cache
+ *
+ *  Builds a set of programs twice, first compiling them from the sources
+ *  and storing their binaries, then loading the cached binaries.
+ *  Uses an off-screen EGL context and the current working directory
+ *  (or the directory specified on the command line) for the cache files.
+ *
+ *  Copyright 2008-2015 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+#include <oglplus/gl.hpp>
+#include <oglplus/all.hpp>
+#include <oglplus/program_binary_cache.hpp>
+
+#include <eglplus/egl.hpp>
+#include <eglplus/all.hpp>
+
+#include <chrono>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+static std::vector<oglplus::ProgramSources> make_sources(std::size_t count)
+{
+	using namespace oglplus;
+
+	std::vector<ProgramSources> result(count);
+	for(std::size_t i=0; i!=count; ++i)
+	{
+		std::ostringstream variant;
+		variant << i;
+
+		result[i].Add(ShaderType::Vertex,
+			"#version 330\n"
+			"uniform mat4 Matrix;\n"
+			"in vec4 Position;\n"
+			"out vec3 vertNormal;\n"
+			"void main(void)\n"
+			"{\n"
+			"	vertNormal = normalize(Position.xyz);\n"
+			"	gl_Position = Matrix * Position;\n"
+			"}\n"
+		);
+		result[i].Add(ShaderType::Fragment,
+			"#version 330\n"
+			"uniform vec3 LightDir;\n"
+			"in vec3 vertNormal;\n"
+			"out vec4 fragColor;\n"
+			"void main(void)\n"
+			"{\n"
+			"	float d = max(dot(vertNormal, LightDir), 0.0);\n"
+			"	vec3 c = vec3(0.0);\n"
+			"	for(int i=0; i!=VARIANT+4; ++i)\n"
+			"		c += sin(vertNormal*float(i))*d;\n"
+			"	fragColor = vec4(c, 1.0);\n"
+			"}\n"
+		);
+		result[i].Define("VARIANT", variant.str());
+	}
+	return result;
+}
+
+static double build_all(
+	oglplus::ProgramBinaryCache& cache,
+	const std::vector<oglplus::ProgramSources>& sources
+)
+{
+	auto start = std::chrono::steady_clock::now();
+	for(auto i=sources.begin(), e=sources.end(); i!=e; ++i)
+	{
+		cache.Build(*i);
+	}
+	auto end = std::chrono::steady_clock::now();
+	return std::chrono::duration<double, std::milli>(end-start).count();
+}
+
+static void run(const char* directory)
+{
+	using namespace eglplus;
+
+	eglplus::Display display;
+	LibEGL egl(display);
+
+	Configs configs(
+		display,
+		ConfigAttribs()
+			.Add(ConfigAttrib::RedSize, 8)
+			.Add(ConfigAttrib::GreenSize, 8)
+			.Add(ConfigAttrib::BlueSize, 8)
+			.Add(ColorBufferType::RGBBuffer)
+			.Add(RenderableTypeBit::OpenGL)
+			.Add(SurfaceTypeBit::Pbuffer)
+			.Get()
+	);
+	Config config = configs.First();
+
+	Surface surface = Surface::Pbuffer(
+		display,
+		config,
+		SurfaceAttribs()
+			.Add(SurfaceAttrib::Width, 16)
+			.Add(SurfaceAttrib::Height, 16)
+			.Get()
+	);
+
+	BindAPI(RenderingAPI::OpenGL);
+	Context context(
+		display,
+		config,
+		ContextAttribs()
+			.Add(ContextAttrib::MajorVersion, 3)
+			.Add(ContextAttrib::MinorVersion, 3)
+			.Add(OpenGLProfileBit::Core)
+			.Get()
+	);
+	context.MakeCurrent(surface);
+
+	oglplus::GLAPIInitializer api_init;
+
+	if(!oglplus::ProgramBinaryCache::IsSupported())
+	{
+		std::cout << "No program binary formats supported" << std::endl;
+		return;
+	}
+
+	const std::size_t count = 32;
+	std::vector<oglplus::ProgramSources> sources = make_sources(count);
+
+	oglplus::ProgramBinaryCache cache(directory);
+	for(auto i=sources.begin(), e=sources.end(); i!=e; ++i)
+	{
+		cache.Remove(*i);
+	}
+
+	double cold = build_all(cache, sources);
+	double warm = build_all(cache, sources);
+
+	std::cout
+		<< "compile and link: " << cold/count << " [ms/program]"
+		<< std::endl
+		<< "cached binary: " << warm/count << " [ms/program]"
+		<< std::endl
+		<< "hits: " << cache.Stats().hits
+		<< ", misses: " << cache.Stats().misses
+		<< ", rejected: " << cache.Stats().rejected
+		<< ", write failures: " << cache.Stats().write_failures
+		<< std::endl;
+
+	for(auto i=sources.begin(), e=sources.end(); i!=e; ++i)
+	{
+		cache.Remove(*i);
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	try
+	{
+		run((argc>1)?argv[1]:".");
+		return 0;
+	}
+	catch(oglplus::Error& oe)
+	{
+		std::cerr
+			<< "OGLplus error (in "
+			<< oe.GLFunc()
+			<< "'): "
+			<< oe.what()
+			<< " ["
+			<< oe.SourceFile()
+			<< ":"
+			<< oe.SourceLine()
+			<< "] "
+			<< std::endl;
+	}
+	catch(eglplus::Error& ee)
+	{
+		std::cerr
+			<< "EGLplus error (in "
+			<< ee.EGLFunc()
+			<< ") "
+			<< ee.what()
+			<< " ["
+			<< ee.SourceFile()
+			<< ":"
+			<< ee.SourceLine()
+			<< "] "
+			<< std::endl;
+	}
+	return 1;
+}
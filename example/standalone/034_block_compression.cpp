@@ -0,0 +1,109 @@
+/**
+ *  @example standalone/034_block_compression.cpp
+ *  @brief Measures the throughput and quality of the CPU block compression
+ *
+ *  Compresses procedurally generated textures into the BCn formats with
+ *  the different quality settings and prints the encoding speed and the
+ *  PSNR of the decoded images. This example does not need a GL context.
+ *
+ *  Copyright 2008-2015 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ *
+ */
+#include <oglplus/gl.hpp>
+#include <oglplus/images/brushed_metal.hpp>
+#include <oglplus/images/normal_map.hpp>
+#include <oglplus/images/compressed.hpp>
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+
+static double psnr(
+	const oglplus::images::Image& a,
+	const oglplus::images::Image& b,
+	GLsizei channels
+)
+{
+	double mse = 0.0;
+	for(GLsizei y=0; y!=a.Height(); ++y)
+	for(GLsizei x=0; x!=a.Width(); ++x)
+	for(GLsizei c=0; c!=channels; ++c)
+	{
+		double d = a.Component(x, y, 0, c)-b.Component(x, y, 0, c);
+		mse += d*d;
+	}
+	mse /= double(a.Width())*a.Height()*channels;
+	return (mse > 0.0)?-10.0*std::log10(mse):100.0;
+}
+
+static void measure(
+	const char* name,
+	const oglplus::images::Image& image,
+	oglplus::images::BlockCompressionParams params,
+	GLsizei channels
+)
+{
+	using namespace oglplus;
+
+	const char* qualities[3] = {"fast", "normal", "high"};
+	for(GLuint q=0; q!=3; ++q)
+	{
+		params.Quality(images::BlockQuality(q));
+
+		auto start = std::chrono::steady_clock::now();
+		images::CompressedImage compressed(image, params);
+		auto end = std::chrono::steady_clock::now();
+		double s = std::chrono::duration<double>(end-start).count();
+		double mpix = double(image.Width())*image.Height()/1e6;
+
+		std::cout
+			<< std::setw(12) << name
+			<< std::setw(8) << qualities[q] << ": "
+			<< std::setw(8) << std::fixed << std::setprecision(2)
+			<< mpix/s << " [Mpixel/s], "
+			<< std::setw(6)
+			<< psnr(image, compressed.Decompress(), channels)
+			<< " [dB], "
+			<< compressed.DataSize()/1024 << " [KiB]"
+			<< std::endl;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	using namespace oglplus;
+	using images::BlockFormat;
+	using images::BlockCompressionParams;
+
+	const GLsizei size = 1024;
+	unsigned threads = (argc>1)?unsigned(std::atoi(argv[1])):0;
+
+	images::BrushedMetalUByte metal(
+		size, size,
+		size*10,
+		-12, +12,
+		32, 64
+	);
+	images::NormalMap normals(metal);
+
+	std::cout
+		<< "source: " << size << "x" << size
+		<< ", " << metal.DataSize()/1024 << " [KiB]"
+		<< std::endl;
+
+	measure("BC1", metal, BlockCompressionParams(BlockFormat::BC1)
+		.Threads(threads), 3);
+	measure("BC3", metal, BlockCompressionParams(BlockFormat::BC3)
+		.Threads(threads), 3);
+	measure("BC4", metal, BlockCompressionParams(BlockFormat::BC4)
+		.Threads(threads), 1);
+	measure("BC5 signed", normals, BlockCompressionParams(BlockFormat::BC5)
+		.Signed().Threads(threads), 2);
+	measure("BC7", metal, BlockCompressionParams(BlockFormat::BC7)
+		.Threads(threads), 3);
+	return 0;
+}
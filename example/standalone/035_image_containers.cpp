@@ -0,0 +1,174 @@
+/**
+ *  @example standalone/035_image_containers.cpp
+ *  @brief Compares the load times of KTX and DDS containers and PNG images
+ *
+ *  Saves a mipmapped (uncompressed and block-compressed) texture into
+ *  KTX and DDS files in the current working directory and measures how
+ *  long it takes to load them compared to decoding a PNG image and
+ *  generating the mipmaps (and compressing them) at load time.
+ *  The PNG image can be specified on the command line, otherwise
+ *  a generated image is used. This example does not need a GL context.
+ *
+ *  Copyright 2008-2015 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ *
+ */
+#include <oglplus/gl.hpp>
+#include <oglplus/config/site.hpp>
+#include <oglplus/images/brushed_metal.hpp>
+#include <oglplus/images/container.hpp>
+#if OGLPLUS_PNG_FOUND
+#include <oglplus/images/png.hpp>
+#endif
+
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <iomanip>
+
+template <typename Func>
+static double measure(unsigned repeat, Func func)
+{
+	auto start = std::chrono::steady_clock::now();
+	for(unsigned r=0; r!=repeat; ++r)
+	{
+		func();
+	}
+	auto end = std::chrono::steady_clock::now();
+	return std::chrono::duration<double, std::milli>(end-start).count()/repeat;
+}
+
+static void print(const char* name, double ms)
+{
+	std::cout
+		<< std::setw(36) << name << ": "
+		<< std::setw(10) << std::fixed << std::setprecision(3)
+		<< ms << " [ms]"
+		<< std::endl;
+}
+
+// loads the container and touches every page of all its views
+static std::size_t load_container(const char* path)
+{
+	using namespace oglplus;
+
+	images::ImageContainer container(path);
+	std::size_t sum = 0;
+	for(GLuint l=0; l!=container.Levels(); ++l)
+	for(GLuint a=0; a!=container.Layers(); ++a)
+	for(GLuint f=0; f!=container.Faces(); ++f)
+	{
+		const images::ImageContainerView& view = container.View(l, a, f);
+		for(std::size_t i=0; i<view.DataSize(); i+=4096)
+		{
+			sum += view.Data()[i];
+		}
+	}
+	return sum;
+}
+
+int main(int argc, char* argv[])
+{
+	using namespace oglplus;
+	using images::BlockFormat;
+	using images::BlockCompressionParams;
+
+	const unsigned repeat = 10;
+	std::size_t sink = 0;
+
+#if OGLPLUS_PNG_FOUND
+	const char* png_path = (argc>1)?argv[1]:nullptr;
+#else
+	const char* png_path = nullptr;
+	if(argc>1)
+	{
+		std::cerr << "PNG support is not available" << std::endl;
+	}
+#endif
+
+	auto source = [png_path](void) -> images::Image
+	{
+#if OGLPLUS_PNG_FOUND
+		if(png_path) return images::PNGImage(png_path);
+#endif
+		return images::BrushedMetalUByte(
+			1024, 1024,
+			1024*10,
+			-12, +12,
+			32, 64
+		);
+	};
+
+	images::Image image = source();
+	std::cout
+		<< "source: " << image.Width() << "x" << image.Height()
+		<< (png_path?" PNG":" generated")
+		<< std::endl;
+
+	images::MipmapChain mipmaps(image);
+	images::CompressedMipmapChain bc1(
+		mipmaps,
+		BlockCompressionParams(BlockFormat::BC1)
+	);
+	images::CompressedMipmapChain bc7(
+		mipmaps,
+		BlockCompressionParams(BlockFormat::BC7)
+	);
+
+	const char* files[4] = {
+		"035_image_containers.ktx",
+		"035_image_containers_bc1.ktx",
+		"035_image_containers_bc7.dds",
+		"035_image_containers.dds"
+	};
+	images::SaveKTX(files[0], mipmaps);
+	images::SaveKTX(files[1], bc1);
+	images::SaveDDS(files[2], bc7);
+	if(image.Channels() == 4)
+	{
+		images::SaveDDS(files[3], mipmaps);
+	}
+	else files[3] = nullptr;
+
+	if(png_path)
+	{
+		print("PNG decode", measure(repeat, [&](void)
+		{
+			sink += std::size_t(source().Width());
+		}));
+		print("PNG decode + mipmaps", measure(repeat, [&](void)
+		{
+			sink += images::MipmapChain(source()).Levels();
+		}));
+	}
+	else
+	{
+		print("generate + mipmaps", measure(repeat, [&](void)
+		{
+			sink += images::MipmapChain(source()).Levels();
+		}));
+	}
+	print("mipmaps + BC1 compression", measure(1, [&](void)
+	{
+		sink += images::CompressedMipmapChain(
+			images::MipmapChain(image),
+			BlockCompressionParams(BlockFormat::BC1)
+		).Levels();
+	}));
+
+	for(std::size_t f=0; f!=4; ++f)
+	{
+		if(!files[f]) continue;
+		print(files[f], measure(repeat, [&](void)
+		{
+			sink += load_container(files[f]);
+		}));
+	}
+
+	for(std::size_t f=0; f!=4; ++f)
+	{
+		if(files[f]) std::remove(files[f]);
+	}
+	return (sink == 0)?1:0;
+}
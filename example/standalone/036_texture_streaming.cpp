@@ -0,0 +1,222 @@
+/**
+ *  @example standalone/036_texture_streaming.cpp
+ *  @brief Measures the throughput of the TextureStreamer
+ *
+ *  Uploads a number of generated tiles into the layers of an array
+ *  texture, first directly from the client memory and then through the
+ *  TextureStreamer and prints the throughput, the stall counters and
+ *  checks that the streamed texture contents are correct.
+ *  Uses an off-screen EGL context.
+ *
+ *  Copyright 2008-2015 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+#include <oglplus/gl.hpp>
+#include <oglplus/all.hpp>
+#include <oglplus/texture_streamer.hpp>
+
+#include <eglplus/egl.hpp>
+#include <eglplus/all.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+static oglplus::images::Image make_tile(GLsizei size, unsigned index)
+{
+	std::vector<GLubyte> data(std::size_t(size)*size*4);
+	for(std::size_t i=0; i!=data.size(); ++i)
+	{
+		data[i] = GLubyte((i*7+index*31+i/1024) & 0xFF);
+	}
+	return oglplus::images::Image(size, size, 1, 4, data.data());
+}
+
+static double seconds_since(std::chrono::steady_clock::time_point start)
+{
+	return std::chrono::duration<double>(
+		std::chrono::steady_clock::now()-start
+	).count();
+}
+
+static void run(std::size_t ring_size)
+{
+	using namespace eglplus;
+
+	eglplus::Display display;
+	LibEGL egl(display);
+
+	Configs configs(
+		display,
+		ConfigAttribs()
+			.Add(ConfigAttrib::RedSize, 8)
+			.Add(ConfigAttrib::GreenSize, 8)
+			.Add(ConfigAttrib::BlueSize, 8)
+			.Add(ColorBufferType::RGBBuffer)
+			.Add(RenderableTypeBit::OpenGL)
+			.Add(SurfaceTypeBit::Pbuffer)
+			.Get()
+	);
+	Config config = configs.First();
+
+	Surface surface = Surface::Pbuffer(
+		display,
+		config,
+		SurfaceAttribs()
+			.Add(SurfaceAttrib::Width, 16)
+			.Add(SurfaceAttrib::Height, 16)
+			.Get()
+	);
+
+	BindAPI(RenderingAPI::OpenGL);
+	Context context(
+		display,
+		config,
+		ContextAttribs()
+			.Add(ContextAttrib::MajorVersion, 4)
+			.Add(ContextAttrib::MinorVersion, 4)
+			.Add(OpenGLProfileBit::Core)
+			.Get()
+	);
+	context.MakeCurrent(surface);
+
+	oglplus::GLAPIInitializer api_init;
+
+	using namespace oglplus;
+
+	const GLsizei tile_size = 512;
+	const unsigned layers = 32;
+	const unsigned rounds = 4;
+	const double bytes = double(tile_size)*tile_size*4*layers*rounds;
+
+	std::vector<images::Image> tiles;
+	for(unsigned l=0; l!=layers; ++l)
+	{
+		tiles.push_back(make_tile(tile_size, l));
+	}
+
+	Texture::Target target = Texture::Target::_2DArray;
+	Texture texture;
+	Texture::Bind(target, texture);
+	Texture::Storage3D(
+		target,
+		1,
+		PixelDataInternalFormat::RGBA8,
+		tile_size,
+		tile_size,
+		GLsizei(layers)
+	);
+
+	auto start = std::chrono::steady_clock::now();
+	for(unsigned r=0; r!=rounds; ++r)
+	{
+		for(unsigned l=0; l!=layers; ++l)
+		{
+			Texture::SubImage3D(target, tiles[l], 0, 0, GLint(l));
+		}
+	}
+	oglplus::Context::Finish();
+	const double direct = seconds_since(start);
+
+	TextureStreamer streamer(ring_size);
+	start = std::chrono::steady_clock::now();
+	for(unsigned r=0; r!=rounds; ++r)
+	{
+		for(unsigned l=0; l!=layers; ++l)
+		{
+			// the streamer takes the ownership of the image
+			images::Image tile = tiles[l];
+			streamer.Upload(
+				texture,
+				target,
+				std::move(tile),
+				0, 0, 0, GLint(l)
+			);
+			streamer.Poll();
+		}
+	}
+	streamer.Finish();
+	oglplus::Context::Finish();
+	const double streamed = seconds_since(start);
+
+	std::vector<GLubyte> readback(std::size_t(tile_size)*tile_size*4*layers);
+	Texture::GetImage(
+		target,
+		0,
+		PixelDataFormat::RGBA,
+		PixelDataType::UnsignedByte,
+		GLsizei(readback.size()),
+		readback.data()
+	);
+	bool correct = true;
+	for(unsigned l=0; l!=layers; ++l)
+	{
+		correct &= std::equal(
+			tiles[l].Data<GLubyte>(),
+			tiles[l].Data<GLubyte>()+tiles[l].DataSize(),
+			readback.data()+l*tiles[l].DataSize()
+		);
+	}
+
+	const TextureStreamerStats& stats = streamer.Stats();
+	std::cout
+		<< "direct upload: "
+		<< bytes/direct/(1024*1024) << " [MB/s]"
+		<< std::endl
+		<< "streamed upload: "
+		<< bytes/streamed/(1024*1024) << " [MB/s]"
+		<< std::endl
+		<< "uploads: " << stats.uploads
+		<< ", direct: " << stats.direct_uploads
+		<< ", fences: " << stats.fences
+		<< std::endl
+		<< "stalls: " << stats.stalls
+		<< " (" << stats.stall_time*1000 << " [ms])"
+		<< ", copy time: " << stats.copy_time*1000 << " [ms]"
+		<< std::endl
+		<< "texture contents "
+		<< (correct?"match":"do not match")
+		<< std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+	try
+	{
+		// the ring size in MiB can be specified on the command line
+		run(std::size_t((argc>1)?std::atoi(argv[1]):8)*1024*1024);
+		return 0;
+	}
+	catch(oglplus::Error& oe)
+	{
+		std::cerr
+			<< "OGLplus error (in "
+			<< oe.GLFunc()
+			<< "'): "
+			<< oe.what()
+			<< " ["
+			<< oe.SourceFile()
+			<< ":"
+			<< oe.SourceLine()
+			<< "] "
+			<< std::endl;
+	}
+	catch(eglplus::Error& ee)
+	{
+		std::cerr
+			<< "EGLplus error (in "
+			<< ee.EGLFunc()
+			<< ") "
+			<< ee.what()
+			<< " ["
+			<< ee.SourceFile()
+			<< ":"
+			<< ee.SourceLine()
+			<< "] "
+			<< std::endl;
+	}
+	return 1;
+}
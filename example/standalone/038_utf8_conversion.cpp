@@ -0,0 +1,112 @@
+/**
+ *  @example standalone/038_utf8_conversion.cpp
+ *  @brief Measures the throughput of the UTF-8 conversions
+ *
+ *  Decodes, validates and encodes ASCII, Latin, CJK and emoji text
+ *  and compares the bulk conversion functions with converting
+ *  the text one code point at a time. This example does not need
+ *  a GL context.
+ *
+ *  Copyright 2008-2015 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+#include <oglplus/string/utf8.hpp>
+
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+
+template <typename Func>
+static double measure(unsigned repeat, Func func)
+{
+	auto start = std::chrono::steady_clock::now();
+	for(unsigned r=0; r!=repeat; ++r)
+	{
+		func();
+	}
+	auto end = std::chrono::steady_clock::now();
+	return std::chrono::duration<double>(end-start).count()/repeat;
+}
+
+static void print(const char* name, double bytes, double seconds)
+{
+	std::cout
+		<< std::setw(24) << name << ": "
+		<< std::setw(10) << std::fixed << std::setprecision(1)
+		<< bytes/seconds/(1024*1024) << " [MB/s]"
+		<< std::endl;
+}
+
+int main(void)
+{
+	using namespace oglplus::aux;
+
+	const char* names[4] = {"ASCII", "Latin", "CJK", "emoji"};
+	const char* samples[4] = {
+		"The quick brown fox jumps over the lazy dog. ",
+		u8"Příliš žluťoučký kůň úpěl ďábelské ódy. ",
+		u8"日本語のテキストを表示します。",
+		u8"\U0001F600\U0001F680\U0001F44D\U0001F30D "
+	};
+
+	const unsigned repeat = 10;
+	std::size_t sink = 0;
+
+	for(std::size_t s=0; s!=4; ++s)
+	{
+		std::string text;
+		while(text.size() < 1024*1024)
+		{
+			text.append(samples[s]);
+		}
+		const double bytes = double(text.size());
+		std::cout << names[s] << ":" << std::endl;
+
+		std::vector<UnicodeCP> cps;
+		print("decode per code point", bytes, measure(repeat, [&](void)
+		{
+			cps.clear();
+			const char* str = text.data();
+			std::size_t len = text.size(), cp_len = 0;
+			while(len)
+			{
+				cps.push_back(ConvertUTF8ToCodePoint(str, len, cp_len));
+				str += cp_len;
+				len -= cp_len;
+			}
+			sink += cps.size();
+		}));
+		print("decode", bytes, measure(repeat, [&](void)
+		{
+			ConvertUTF8ToCodePoints(text.data(), text.size(), cps);
+			sink += cps.size();
+		}));
+		print("validate", bytes, measure(repeat, [&](void)
+		{
+			sink += ValidUTF8(text.data(), text.data()+text.size())?1:0;
+		}));
+
+		std::vector<char> utf8;
+		print("encode per code point", bytes, measure(repeat, [&](void)
+		{
+			utf8.clear();
+			char buf[6];
+			std::size_t len = 0;
+			for(std::size_t i=0; i!=cps.size(); ++i)
+			{
+				ConvertCodePointToUTF8(cps[i], buf, len);
+				utf8.insert(utf8.end(), buf, buf+len);
+			}
+			sink += utf8.size();
+		}));
+		print("encode", bytes, measure(repeat, [&](void)
+		{
+			ConvertCodePointsToUTF8(cps.data(), cps.size(), utf8);
+			sink += utf8.size();
+		}));
+	}
+	return (sink == 0)?1:0;
+}
@@ -0,0 +1,125 @@
+/**
+ *  @example standalone/041_shape_multi_draw.cpp
+ *  @brief Compares the GL calls of plain and compiled shape instructions
+ *
+ *  Draws several shapes with the DrawingInstructions and with the
+ *  CompiledDrawingInstructions (with and without the indirect commands)
+ *  and prints the number of GL calls and the CPU time per draw.
+ *  Uses the headless GL dispatch backend, so this example does not need
+ *  a GL context.
+ *
+ *  Copyright 2008-2015 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ *
+ */
+#define OGLPLUS_USE_GL_DISPATCH 1
+
+#include <oglplus/gl.hpp>
+#include <oglplus/all.hpp>
+#include <oglplus/shapes/draw_compiled.hpp>
+#include <oglplus/shapes/cube.hpp>
+#include <oglplus/shapes/sphere.hpp>
+#include <oglplus/shapes/spiral_sphere.hpp>
+#include <oglplus/shapes/twisted_torus.hpp>
+#include <oglplus/shapes/wicker_torus.hpp>
+#include <oglplus/dispatch/recorder.hpp>
+
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+
+template <typename Func>
+static void measure(const char* name, std::size_t repeat, Func func)
+{
+	oglplus::GLHeadlessRecorder recorder;
+	oglplus::GLDispatchBackendScope scope(recorder);
+
+	// warm-up and count the calls per draw
+	func();
+	recorder.Clear();
+	func();
+	std::size_t calls = recorder.CallCount();
+	recorder.Disable();
+
+	auto start = std::chrono::steady_clock::now();
+	for(std::size_t i=0; i!=repeat; ++i)
+	{
+		func();
+	}
+	auto end = std::chrono::steady_clock::now();
+	double ns = std::chrono::duration<double, std::nano>(end-start).count();
+
+	std::cout
+		<< "  " << std::setw(16) << std::left << name << std::right
+		<< std::setw(6) << calls << " GL calls/draw, "
+		<< std::setw(10) << std::fixed << std::setprecision(1)
+		<< ns/repeat << " [ns/draw]"
+		<< std::endl;
+}
+
+template <typename Shape, typename Mode>
+static void compare(const char* name, const Shape& shape, Mode mode)
+{
+	using namespace oglplus;
+
+	const std::size_t repeat = 20000;
+
+	// the backend used while setting up the objects
+	GLHeadlessRecorder setup;
+	GLDispatchBackendScope setup_scope(setup);
+
+	shapes::DrawingInstructions instr = shape.Instructions(mode);
+	shapes::ElementIndexInfo index_info(shape);
+
+	shapes::CompiledDrawingInstructions indirect(instr, index_info, true);
+	shapes::CompiledDrawingInstructions direct(instr, index_info, false);
+
+	std::cout
+		<< name << ": "
+		<< indirect.OperationCount() << " operations, "
+		<< indirect.BatchCount() << " batches"
+		<< std::endl;
+
+	measure("plain", repeat, [&](void) -> void
+	{
+		instr.Draw(index_info);
+	});
+	measure("multi-draw", repeat, [&](void) -> void
+	{
+		direct.Draw();
+	});
+	if(indirect.Indirect())
+	{
+		measure("indirect", repeat, [&](void) -> void
+		{
+			indirect.Draw();
+		});
+	}
+	measure("plain x4", repeat, [&](void) -> void
+	{
+		instr.Draw(index_info, 4);
+	});
+	if(indirect.Indirect())
+	{
+		measure("indirect x4", repeat, [&](void) -> void
+		{
+			indirect.Draw(4);
+		});
+	}
+}
+
+int main(void)
+{
+	using namespace oglplus;
+
+	shapes::DrawMode::Default def;
+
+	compare("Cube (edges)", shapes::Cube(), shapes::DrawMode::Edges());
+	compare("Sphere", shapes::Sphere(), def);
+	compare("SpiralSphere", shapes::SpiralSphere(), def);
+	compare("TwistedTorus", shapes::TwistedTorus(), def);
+	compare("WickerTorus", shapes::WickerTorus(), def);
+
+	return 0;
+}
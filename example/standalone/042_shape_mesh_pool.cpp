@@ -0,0 +1,159 @@
+/**
+ *  @example standalone/042_shape_mesh_pool.cpp
+ *  @brief Compares drawing many shapes with ShapeWrappers and a ShapeMeshPool
+ *
+ *  Draws a scene consisting of many small shapes, first with a separate
+ *  ShapeWrapper for each shape and then from a ShapeMeshPool and prints
+ *  the number of GL calls and the CPU time per frame and the occupancy
+ *  of the pool. Uses the headless GL dispatch backend, so this example
+ *  does not need a GL context.
+ *
+ *  Copyright 2008-2015 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ *
+ */
+#define OGLPLUS_USE_GL_DISPATCH 1
+
+#include <oglplus/gl.hpp>
+#include <oglplus/all.hpp>
+#include <oglplus/shapes/wrapper.hpp>
+#include <oglplus/shapes/mesh_pool.hpp>
+#include <oglplus/shapes/cube.hpp>
+#include <oglplus/shapes/sphere.hpp>
+#include <oglplus/shapes/torus.hpp>
+#include <oglplus/shapes/twisted_torus.hpp>
+#include <oglplus/dispatch/recorder.hpp>
+
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <memory>
+#include <vector>
+
+template <typename Func>
+static void measure(const char* name, std::size_t repeat, Func func)
+{
+	oglplus::GLHeadlessRecorder recorder;
+	oglplus::GLDispatchBackendScope scope(recorder);
+
+	// warm-up and count the calls per frame
+	func();
+	recorder.Clear();
+	func();
+	std::size_t calls = recorder.CallCount();
+	recorder.Disable();
+
+	auto start = std::chrono::steady_clock::now();
+	for(std::size_t i=0; i!=repeat; ++i)
+	{
+		func();
+	}
+	auto end = std::chrono::steady_clock::now();
+	double us = std::chrono::duration<double, std::micro>(end-start).count();
+
+	std::cout
+		<< std::setw(20) << std::left << name << std::right
+		<< std::setw(8) << calls << " GL calls/frame, "
+		<< std::setw(10) << std::fixed << std::setprecision(1)
+		<< us/repeat << " [us/frame]"
+		<< std::endl;
+}
+
+int main(void)
+{
+	using namespace oglplus;
+
+	const std::size_t shape_count = 1000;
+	const std::size_t repeat = 50;
+
+	// the backend used while setting up the objects
+	GLHeadlessRecorder setup;
+	GLDispatchBackendScope setup_scope(setup);
+
+	Program prog;
+	prog.Link().Use();
+
+	shapes::Cube cube;
+	shapes::Sphere sphere(1.0, 12, 8);
+	shapes::Torus torus(1.0, 0.5, 12, 8);
+	shapes::TwistedTorus twisted;
+
+	const std::vector<String> names = {"Position", "Normal"};
+	const std::vector<GLuint> npvs = {3, 3};
+
+	std::vector<std::unique_ptr<shapes::ShapeWrapper>> wrappers;
+	shapes::ShapeMeshPool pool(names, npvs, 4*1024, 16*1024);
+	std::vector<shapes::ShapeMeshPool::MeshID> meshes;
+
+	for(std::size_t i=0; i!=shape_count; ++i)
+	{
+		switch(i % 4)
+		{
+			case 0:
+				wrappers.emplace_back(
+					new shapes::ShapeWrapper(names, cube, prog)
+				);
+				meshes.push_back(pool.Add(cube));
+				break;
+			case 1:
+				wrappers.emplace_back(
+					new shapes::ShapeWrapper(names, sphere, prog)
+				);
+				meshes.push_back(pool.Add(sphere));
+				break;
+			case 2:
+				wrappers.emplace_back(
+					new shapes::ShapeWrapper(names, torus, prog)
+				);
+				meshes.push_back(pool.Add(torus));
+				break;
+			default:
+				wrappers.emplace_back(
+					new shapes::ShapeWrapper(names, twisted, prog)
+				);
+				meshes.push_back(pool.Add(twisted));
+		}
+	}
+	pool.UseInProgram(prog);
+
+	// remove and re-add some of the shapes to fragment the pool
+	for(std::size_t i=0; i<shape_count; i+=3)
+	{
+		pool.Remove(meshes[i]);
+	}
+	for(std::size_t i=0; i<shape_count; i+=3)
+	{
+		meshes[i] = pool.Add(cube);
+	}
+
+	measure("ShapeWrappers", repeat, [&](void) -> void
+	{
+		for(auto i=wrappers.begin(), e=wrappers.end(); i!=e; ++i)
+		{
+			(*i)->Use();
+			(*i)->Draw();
+		}
+	});
+	measure("ShapeMeshPool", repeat, [&](void) -> void
+	{
+		pool.Draw(meshes);
+	});
+
+	shapes::ShapeMeshPoolStats stats = pool.Stats();
+	std::cout
+		<< std::endl
+		<< "meshes:           " << stats.meshes << std::endl
+		<< "vertices:         " << stats.vertices_used
+		<< "/" << stats.vertex_capacity
+		<< " (largest free " << stats.largest_free_vertices << ")"
+		<< std::endl
+		<< "indices:          " << stats.indices_used
+		<< "/" << stats.index_capacity
+		<< " (largest free " << stats.largest_free_indices << ")"
+		<< std::endl
+		<< "defragmentations: " << stats.defragmentations << std::endl
+		<< "growths:          " << stats.growths << std::endl;
+
+	return 0;
+}
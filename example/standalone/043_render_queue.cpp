@@ -0,0 +1,135 @@
+/**
+ *  @example standalone/043_render_queue.cpp
+ *  @brief Measures the sorting and state-change reduction of a RenderQueue
+ *
+ *  Submits a scene of many draw items using several programs, textures
+ *  vertex arrays and blending states in random order into a RenderQueue
+ *  and prints the time spent building the keys and sorting them, the
+ *  number of state changes in the submitted and the sorted order and
+ *  the GL calls issued by replaying the queue. Uses the headless GL
+ *  dispatch backend, so this example does not need a GL context.
+ *
+ *  Copyright 2008-2015 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ *
+ */
+#define OGLPLUS_USE_GL_DISPATCH 1
+
+#include <oglplus/gl.hpp>
+#include <oglplus/all.hpp>
+#include <oglplus/render_queue.hpp>
+#include <oglplus/dispatch/recorder.hpp>
+
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <vector>
+
+int main(void)
+{
+	using namespace oglplus;
+
+	const std::size_t counts[] = {1000, 10000, 100000};
+	const std::size_t repeat = 20;
+
+	GLHeadlessRecorder recorder;
+	GLDispatchBackendScope scope(recorder);
+	ClientContext gl;
+
+	std::mt19937 rng(42);
+
+	for(std::size_t count : counts)
+	{
+		std::vector<RenderQueueItem> items(count);
+		for(auto i=items.begin(), e=items.end(); i!=e; ++i)
+		{
+			i->program = ProgramName(1+rng()%8);
+			i->vertex_array = VertexArrayName(1+rng()%16);
+			i->BindTexture(
+				0,
+				TextureTarget::_2D,
+				TextureName(1+rng()%32)
+			);
+			if(rng()%4 == 0)
+			{
+				i->BindTexture(
+					1,
+					TextureTarget::CubeMap,
+					TextureName(100+rng()%4)
+				);
+			}
+			if(rng()%10 == 0)
+			{
+				i->state = RenderQueueState::Blended(
+					BlendFunction::SrcAlpha,
+					BlendFunction::OneMinusSrcAlpha
+				);
+			}
+			i->depth = GLfloat(rng()%10000)/10000;
+			i->DrawElements(
+				PrimitiveType::Triangles,
+				GLsizei(36+rng()%1000),
+				DataType::UnsignedShort
+			);
+		}
+
+		RenderQueue queue;
+		queue.Reserve(count);
+
+		auto start = std::chrono::steady_clock::now();
+		for(std::size_t r=0; r!=repeat; ++r)
+		{
+			queue.Clear();
+			for(auto i=items.begin(), e=items.end(); i!=e; ++i)
+			{
+				queue.Submit(*i);
+			}
+		}
+		auto mid = std::chrono::steady_clock::now();
+		for(std::size_t r=0; r!=repeat; ++r)
+		{
+			queue.Clear();
+			for(auto i=items.begin(), e=items.end(); i!=e; ++i)
+			{
+				queue.Submit(*i);
+			}
+			queue.Sort();
+		}
+		auto end = std::chrono::steady_clock::now();
+
+		double submit_us = std::chrono::duration<double, std::micro>(
+			mid-start
+		).count()/repeat;
+		double sort_us = std::chrono::duration<double, std::micro>(
+			end-mid
+		).count()/repeat-submit_us;
+
+		RenderQueueStats stats = queue.Stats();
+
+		recorder.Clear();
+		queue.Replay(gl);
+		std::size_t calls = recorder.CallCount();
+
+		std::cout
+			<< stats.items << " items:" << std::endl
+			<< std::fixed << std::setprecision(1)
+			<< "  submit (key building): " << submit_us << " [us]"
+			<< std::endl
+			<< "  radix sort:            " << sort_us << " [us]"
+			<< std::endl
+			<< "  state changes submitted/sorted/avoided: "
+			<< stats.submitted_changes << "/"
+			<< stats.sorted_changes << "/"
+			<< stats.Avoided()
+			<< std::endl
+			<< "  GL calls issued by replay: " << calls
+			<< " (" << recorder.CountOf("UseProgram") << " UseProgram, "
+			<< recorder.CountOf("BindTexture") << " BindTexture, "
+			<< recorder.CountOf("BindVertexArray") << " BindVertexArray)"
+			<< std::endl;
+	}
+
+	return 0;
+}
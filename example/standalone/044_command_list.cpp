@@ -0,0 +1,177 @@
+/**
+ *  @example standalone/044_command_list.cpp
+ *  @brief Measures the recording and replay of deferred CommandLists
+ *
+ *  Records the commands of a frame consisting of many draws into
+ *  CommandLists, first on a single thread then split between several
+ *  worker threads, each using its own list, and prints the recording
+ *  throughput. Then it compares the time spent executing the lists
+ *  by a CommandExecutor with the time spent issuing the same calls
+ *  directly. Uses the headless GL dispatch backend with the recording
+ *  disabled, so the measured times are the overhead of the commands
+ *  themselves and this example does not need a GL context.
+ *
+ *  Copyright 2008-2015 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ *
+ */
+#define OGLPLUS_USE_GL_DISPATCH 1
+
+#include <oglplus/gl.hpp>
+#include <oglplus/all.hpp>
+#include <oglplus/command_list.hpp>
+#include <oglplus/dispatch/recorder.hpp>
+
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <thread>
+#include <vector>
+
+namespace oglplus {
+
+static const std::size_t draw_count = 100000;
+static const std::size_t repeat = 10;
+
+// records the draws in the range [begin, end) into the list
+static void record_draws(CommandList& list, std::size_t begin, std::size_t end)
+{
+	for(std::size_t i=begin; i!=end; ++i)
+	{
+		list.UseProgram(ProgramName(GLuint(1+(i/1000)%8)))
+			.BindVertexArray(VertexArrayName(GLuint(1+(i/100)%16)))
+			.BindTexture(0, TextureTarget::_2D, TextureName(GLuint(1+i%32)))
+			.Uniform(0, Vec4f(GLfloat(i), 1, 2, 3))
+			.DrawElements(
+				PrimitiveType::Triangles,
+				36,
+				DataType::UnsignedShort
+			);
+	}
+}
+
+// issues the same calls as record_draws directly
+static void direct_draws(std::size_t begin, std::size_t end)
+{
+	for(std::size_t i=begin; i!=end; ++i)
+	{
+		Vec4f v(GLfloat(i), 1, 2, 3);
+		OGLPLUS_GLFUNC(UseProgram)(GLuint(1+(i/1000)%8));
+		OGLPLUS_GLFUNC(BindVertexArray)(GLuint(1+(i/100)%16));
+		OGLPLUS_GLFUNC(ActiveTexture)(GL_TEXTURE0);
+		OGLPLUS_GLFUNC(BindTexture)(GL_TEXTURE_2D, GLuint(1+i%32));
+		OGLPLUS_GLFUNC(Uniform4fv)(0, 1, v.Data());
+		OGLPLUS_GLFUNC(DrawElements)(
+			GL_TRIANGLES,
+			36,
+			GL_UNSIGNED_SHORT,
+			nullptr
+		);
+	}
+}
+
+static double record(std::vector<CommandList>& lists)
+{
+	const std::size_t n = lists.size();
+	auto start = std::chrono::steady_clock::now();
+	for(std::size_t r=0; r!=repeat; ++r)
+	{
+		std::vector<std::thread> threads;
+		for(std::size_t t=0; t!=n; ++t)
+		{
+			CommandList& list = lists[t];
+			list.Clear();
+			threads.push_back(std::thread([&list, t, n](void) -> void
+			{
+				record_draws(
+					list,
+					(draw_count*t)/n,
+					(draw_count*(t+1))/n
+				);
+			}));
+		}
+		for(auto i=threads.begin(), e=threads.end(); i!=e; ++i)
+		{
+			i->join();
+		}
+	}
+	auto end = std::chrono::steady_clock::now();
+	return std::chrono::duration<double, std::milli>(end-start).count()/repeat;
+}
+
+} // namespace oglplus
+
+int main(void)
+{
+	using namespace oglplus;
+
+	GLHeadlessRecorder recorder;
+	GLDispatchBackendScope scope(recorder);
+	recorder.Disable();
+
+	const std::size_t commands = draw_count*5;
+
+	std::cout << std::fixed << std::setprecision(2);
+
+	std::size_t thread_counts[] = {1, 2, 4, 8};
+	std::vector<CommandList> lists;
+	for(std::size_t n : thread_counts)
+	{
+		lists.clear();
+		lists.resize(n);
+		double ms = record(lists);
+		std::cout
+			<< "recording on " << n << " thread(s): "
+			<< ms << " [ms], "
+			<< commands/ms/1000.0 << " [Mcmd/s]"
+			<< std::endl;
+	}
+
+	std::size_t bytes = 0;
+	for(auto i=lists.begin(), e=lists.end(); i!=e; ++i)
+	{
+		bytes += i->UsedBytes();
+	}
+	std::cout
+		<< "recorded " << commands << " commands into "
+		<< bytes/1024 << " [KiB]"
+		<< std::endl;
+
+	CommandExecutor executor;
+	auto start = std::chrono::steady_clock::now();
+	for(std::size_t r=0; r!=repeat; ++r)
+	{
+		executor.Execute(lists);
+	}
+	auto mid = std::chrono::steady_clock::now();
+	for(std::size_t r=0; r!=repeat; ++r)
+	{
+		direct_draws(0, draw_count);
+	}
+	auto end = std::chrono::steady_clock::now();
+
+	double exec_ms = std::chrono::duration<double, std::milli>(
+		mid-start
+	).count()/repeat;
+	double direct_ms = std::chrono::duration<double, std::milli>(
+		end-mid
+	).count()/repeat;
+
+	executor.ResetStats();
+	executor.Execute(lists);
+
+	std::cout
+		<< "executing the lists: " << exec_ms << " [ms], "
+		<< exec_ms*1e6/commands << " [ns/cmd]"
+		<< std::endl
+		<< "issuing direct calls: " << direct_ms << " [ms], "
+		<< direct_ms*1e6/commands << " [ns/cmd]"
+		<< std::endl
+		<< "binds skipped by the executor: "
+		<< executor.Stats().skipped_binds
+		<< " of " << executor.Stats().commands << " commands"
+		<< std::endl;
+
+	return 0;
+}
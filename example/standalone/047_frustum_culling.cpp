@@ -0,0 +1,123 @@
+/**
+ *  @example standalone/047_frustum_culling.cpp
+ *  @brief Measures the culling of bounding spheres with a FrustumCuller
+ *
+ *  Generates arrays of 10 thousand to 10 million randomly placed bounding
+ *  spheres and prints the time spent culling them against a perspective
+ *  view frustum by testing the spheres one by one with Frustum::Intersects
+ *  and with a FrustumCuller, producing a visibility bitmask or a list
+ *  of visible indices, on a single thread and on all hardware threads.
+ *  This example does not need a GL context.
+ *
+ *  Copyright 2008-2015 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ *
+ */
+#include <oglplus/gl.hpp>
+#include <oglplus/frustum_culler.hpp>
+
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <vector>
+
+namespace oglplus {
+
+template <typename Func>
+static double measure(std::size_t repeat, Func func)
+{
+	auto start = std::chrono::steady_clock::now();
+	for(std::size_t r=0; r!=repeat; ++r)
+	{
+		func();
+	}
+	auto end = std::chrono::steady_clock::now();
+	return std::chrono::duration<double, std::milli>(end-start).count()/repeat;
+}
+
+} // namespace oglplus
+
+int main(void)
+{
+	using namespace oglplus;
+
+	const std::size_t counts[] = {10000, 100000, 1000000, 10000000};
+
+	Frustumf frustum(
+		CamMatrixf::PerspectiveX(Degrees(70), 16.0f/9.0f, 1.0f, 500.0f)*
+		CamMatrixf::LookingAt(Vec3f(0, 10, 0), Vec3f(100, 0, 100))
+	);
+	FrustumCuller culler(frustum);
+
+	std::mt19937 rng(42);
+	std::uniform_real_distribution<GLfloat> pos(-500.0f, 500.0f);
+	std::uniform_real_distribution<GLfloat> rad(0.1f, 10.0f);
+
+	std::vector<std::uint32_t> mask;
+	std::vector<GLuint> indices;
+
+	std::cout << std::fixed << std::setprecision(3);
+
+	for(std::size_t count : counts)
+	{
+		SphereArray spheres;
+		spheres.Reserve(count);
+		for(std::size_t i=0; i!=count; ++i)
+		{
+			spheres.Add(pos(rng), pos(rng), pos(rng), rad(rng));
+		}
+		const std::size_t repeat = std::max<std::size_t>(
+			10000000/count,
+			3
+		);
+
+		std::size_t scalar_visible = 0;
+		double scalar_ms = measure(repeat, [&](void)
+		{
+			scalar_visible = 0;
+			for(std::size_t i=0; i!=count; ++i)
+			{
+				if(frustum.Intersects(spheres.Get(i)))
+				{
+					++scalar_visible;
+				}
+			}
+		});
+		double mask_ms = measure(repeat, [&](void)
+		{
+			culler.CullToMask(spheres, mask, 1);
+		});
+		double mask_mt_ms = measure(repeat, [&](void)
+		{
+			culler.CullToMask(spheres, mask, 0);
+		});
+		double indices_ms = measure(repeat, [&](void)
+		{
+			culler.CullToIndices(spheres, indices, 1);
+		});
+		double indices_mt_ms = measure(repeat, [&](void)
+		{
+			culler.CullToIndices(spheres, indices, 0);
+		});
+
+		std::cout
+			<< count << " spheres, "
+			<< indices.size() << " visible"
+			<< (indices.size() == scalar_visible?"":" (MISMATCH)")
+			<< ":" << std::endl
+			<< "  one by one:             " << scalar_ms << " [ms]"
+			<< std::endl
+			<< "  mask, single thread:    " << mask_ms << " [ms]"
+			<< std::endl
+			<< "  mask, all threads:      " << mask_mt_ms << " [ms]"
+			<< std::endl
+			<< "  indices, single thread: " << indices_ms << " [ms]"
+			<< std::endl
+			<< "  indices, all threads:   " << indices_mt_ms << " [ms]"
+			<< std::endl;
+	}
+
+	return 0;
+}
@@ -0,0 +1,314 @@
+/**
+ *  @example standalone/048_shape_bvh.cpp
+ *  @brief Measures the building and the queries of bounding-volume hierarchies
+ *
+ *  Builds an InstanceBVH over 10 thousand to 1 million randomly placed
+ *  bounding spheres on a single thread and on all hardware threads, refits
+ *  it after moving the spheres and measures frustum culling and ray picking
+ *  against testing the spheres one by one. Then builds a TriangleBVH over
+ *  the faces of a torus and of finely subdivided spheres (with up to
+ *  1.3 million triangles) and measures ray picking against testing
+ *  all triangles. This example does not need a GL context.
+ *
+ *  Copyright 2008-2015 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ *
+ */
+#include <oglplus/gl.hpp>
+#include <oglplus/shapes/bvh.hpp>
+#include <oglplus/shapes/torus.hpp>
+#include <oglplus/shapes/subdiv_sphere.hpp>
+#include <oglplus/math/matrix.hpp>
+
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <vector>
+
+namespace oglplus {
+
+template <typename Func>
+static double measure(std::size_t repeat, Func func)
+{
+	auto start = std::chrono::steady_clock::now();
+	for(std::size_t r=0; r!=repeat; ++r)
+	{
+		func();
+	}
+	auto end = std::chrono::steady_clock::now();
+	return std::chrono::duration<double, std::milli>(end-start).count()/repeat;
+}
+
+static bool ray_sphere(
+	const Vec3f& o,
+	const Vec3f& d,
+	const Spheref& s,
+	GLfloat& t
+)
+{
+	Vec3f oc = o-s.Center();
+	GLfloat a = Dot(d, d);
+	GLfloat b = Dot(oc, d);
+	GLfloat c = Dot(oc, oc)-s.Radius()*s.Radius();
+	GLfloat disc = b*b-a*c;
+	if(disc < 0.0f) return false;
+	GLfloat r = (-b-std::sqrt(disc))/a;
+	if(r < 0.0f) r = (-b+std::sqrt(disc))/a;
+	if(r < 0.0f || r >= t) return false;
+	t = r;
+	return true;
+}
+
+static bool ray_triangle(
+	const Vec3f& o,
+	const Vec3f& d,
+	const Vec3f& v0,
+	const Vec3f& v1,
+	const Vec3f& v2,
+	GLfloat& t
+)
+{
+	Vec3f e1 = v1-v0, e2 = v2-v0;
+	Vec3f p = Cross(d, e2);
+	GLfloat det = Dot(e1, p);
+	if(det == 0.0f) return false;
+	Vec3f s = o-v0;
+	GLfloat u = Dot(s, p)/det;
+	if(u < 0.0f || u > 1.0f) return false;
+	Vec3f q = Cross(s, e1);
+	GLfloat v = Dot(d, q)/det;
+	if(v < 0.0f || u+v > 1.0f) return false;
+	GLfloat r = Dot(e2, q)/det;
+	if(r < 0.0f || r >= t) return false;
+	t = r;
+	return true;
+}
+
+static void instance_benchmark(std::size_t count)
+{
+	std::mt19937 rng(42);
+	std::uniform_real_distribution<GLfloat> pos(-500.0f, 500.0f);
+	std::uniform_real_distribution<GLfloat> rad(0.1f, 5.0f);
+	std::uniform_real_distribution<GLfloat> jitter(-2.0f, 2.0f);
+	std::uniform_real_distribution<GLfloat> dir(-1.0f, 1.0f);
+
+	std::vector<Spheref> spheres;
+	spheres.reserve(count);
+	for(std::size_t i=0; i!=count; ++i)
+	{
+		spheres.push_back(Spheref(pos(rng), pos(rng), pos(rng), rad(rng)));
+	}
+
+	shapes::InstanceBVH bvh;
+	bvh.Resize(GLuint(count));
+	for(std::size_t i=0; i!=count; ++i)
+	{
+		bvh.SetSphere(GLuint(i), spheres[i]);
+	}
+
+	const std::size_t repeat = std::max<std::size_t>(1000000/count, 3);
+
+	double build_ms = measure(repeat, [&](void) { bvh.Build(1); });
+	double build_mt_ms = measure(repeat, [&](void) { bvh.Build(0); });
+
+	for(std::size_t i=0; i!=count; ++i)
+	{
+		spheres[i] = Spheref(
+			spheres[i].Center()+Vec3f(jitter(rng), jitter(rng), jitter(rng)),
+			spheres[i].Radius()
+		);
+		bvh.SetSphere(GLuint(i), spheres[i]);
+	}
+	double refit_ms = measure(repeat, [&](void) { bvh.Refit(); });
+
+	Frustumf frustum(
+		CamMatrixf::PerspectiveX(Degrees(70), 16.0f/9.0f, 1.0f, 500.0f)*
+		CamMatrixf::LookingAt(Vec3f(0, 10, 0), Vec3f(100, 0, 100))
+	);
+
+	std::vector<GLuint> visible;
+	double cull_ms = measure(repeat, [&](void)
+	{
+		bvh.Cull(frustum, visible);
+	});
+	std::size_t brute_visible = 0;
+	double brute_cull_ms = measure(repeat, [&](void)
+	{
+		brute_visible = 0;
+		for(std::size_t i=0; i!=count; ++i)
+		{
+			if(frustum.Intersects(spheres[i])) ++brute_visible;
+		}
+	});
+
+	const std::size_t ray_count = 1000;
+	std::vector<Vec3f> rays;
+	for(std::size_t r=0; r!=ray_count; ++r)
+	{
+		rays.push_back(Vec3f(dir(rng), dir(rng), dir(rng)));
+	}
+	const Vec3f origin(0, 0, 0);
+
+	std::size_t mismatches = 0;
+	std::vector<GLuint> picked(ray_count);
+	double pick_ms = measure(1, [&](void)
+	{
+		for(std::size_t r=0; r!=ray_count; ++r)
+		{
+			GLfloat t = 1e30f;
+			picked[r] = bvh.Pick(
+				origin, rays[r],
+				[&](GLuint i, GLfloat& d) -> bool
+				{
+					return ray_sphere(origin, rays[r], spheres[i], d);
+				},
+				t
+			);
+		}
+	});
+	double brute_pick_ms = measure(1, [&](void)
+	{
+		for(std::size_t r=0; r!=ray_count; ++r)
+		{
+			GLfloat t = 1e30f;
+			GLuint nearest = shapes::InstanceBVH::NoInstance();
+			for(std::size_t i=0; i!=count; ++i)
+			{
+				if(ray_sphere(origin, rays[r], spheres[i], t))
+				{
+					nearest = GLuint(i);
+				}
+			}
+			if(nearest != picked[r]) ++mismatches;
+		}
+	});
+
+	std::cout
+		<< count << " instances, "
+		<< bvh.Nodes().size() << " nodes:" << std::endl
+		<< "  build, single thread:   " << build_ms << " [ms]" << std::endl
+		<< "  build, all threads:     " << build_mt_ms << " [ms]" << std::endl
+		<< "  refit:                  " << refit_ms << " [ms]" << std::endl
+		<< "  cull, BVH:              " << cull_ms << " [ms] ("
+		<< visible.size() << " candidates)" << std::endl
+		<< "  cull, one by one:       " << brute_cull_ms << " [ms] ("
+		<< brute_visible << " visible)" << std::endl
+		<< "  pick, BVH:              " << 1000.0*pick_ms/ray_count
+		<< " [us/ray]" << std::endl
+		<< "  pick, one by one:       " << 1000.0*brute_pick_ms/ray_count
+		<< " [us/ray]" << (mismatches?" (MISMATCH)":"") << std::endl;
+}
+
+template <typename ShapeBuilder>
+static void triangle_benchmark(const char* name, const ShapeBuilder& builder)
+{
+	std::vector<GLfloat> positions;
+	GLuint npv = builder.Positions(positions);
+	auto shape_indices = builder.Indices();
+	std::vector<GLuint> indices(shape_indices.begin(), shape_indices.end());
+	std::vector<GLuint> triangles;
+	shapes::TriangleBVH::Triangles(builder.Instructions(), indices, triangles);
+
+	shapes::TriangleBVH bvh;
+	double build_ms = measure(3, [&](void)
+	{
+		bvh = shapes::TriangleBVH(positions, npv, triangles, 1);
+	});
+	double build_mt_ms = measure(3, [&](void)
+	{
+		bvh = shapes::TriangleBVH(positions, npv, triangles, 0);
+	});
+
+	std::mt19937 rng(42);
+	std::uniform_real_distribution<GLfloat> coord(-1.6f, 1.6f);
+
+	const std::size_t ray_count = 10000;
+	std::vector<Vec3f> origins, directions;
+	for(std::size_t r=0; r!=ray_count; ++r)
+	{
+		origins.push_back(Vec3f(coord(rng), 3.0f, coord(rng)));
+		directions.push_back(
+			Vec3f(coord(rng), -3.0f, coord(rng))-origins.back()
+		);
+	}
+
+	std::size_t hits = 0;
+	std::vector<GLfloat> distances(ray_count, 1e30f);
+	double raycast_ms = measure(1, [&](void)
+	{
+		shapes::BVHRayHit hit;
+		for(std::size_t r=0; r!=ray_count; ++r)
+		{
+			if(bvh.Raycast(origins[r], directions[r], hit))
+			{
+				distances[r] = hit.distance;
+				++hits;
+			}
+		}
+	});
+
+	// testing all triangles is slow, so only a few rays are tested
+	const std::size_t brute_count = 20;
+	std::size_t mismatches = 0;
+	auto vertex = [&](GLuint i) -> Vec3f
+	{
+		return Vec3f(
+			positions[i*npv+0],
+			positions[i*npv+1],
+			positions[i*npv+2]
+		);
+	};
+	double brute_ms = measure(1, [&](void)
+	{
+		for(std::size_t r=0; r!=brute_count; ++r)
+		{
+			GLfloat t = 1e30f;
+			for(std::size_t i=0; i!=triangles.size(); i+=3)
+			{
+				ray_triangle(
+					origins[r], directions[r],
+					vertex(triangles[i+0]),
+					vertex(triangles[i+1]),
+					vertex(triangles[i+2]),
+					t
+				);
+			}
+			if(std::fabs(t-distances[r]) > 1e-3f*t) ++mismatches;
+		}
+	});
+
+	std::cout
+		<< name << ", "
+		<< bvh.TriangleCount() << " triangles, "
+		<< bvh.Nodes().size() << " nodes:" << std::endl
+		<< "  build, single thread:   " << build_ms << " [ms]" << std::endl
+		<< "  build, all threads:     " << build_mt_ms << " [ms]" << std::endl
+		<< "  raycast, BVH:           " << 1000.0*raycast_ms/ray_count
+		<< " [us/ray] (" << hits << " hits)" << std::endl
+		<< "  raycast, all triangles: " << 1000.0*brute_ms/brute_count
+		<< " [us/ray]" << (mismatches?" (MISMATCH)":"") << std::endl;
+}
+
+} // namespace oglplus
+
+int main(void)
+{
+	using namespace oglplus;
+
+	std::cout << std::fixed << std::setprecision(3);
+
+	const std::size_t counts[] = {10000, 100000, 1000000};
+	for(std::size_t count : counts)
+	{
+		instance_benchmark(count);
+	}
+
+	triangle_benchmark("torus", shapes::Torus(1.0, 0.5, 144, 72));
+	triangle_benchmark("sphere", shapes::SimpleSubdivSphere(6));
+	triangle_benchmark("sphere", shapes::SimpleSubdivSphere(8));
+
+	return 0;
+}
@@ -0,0 +1,155 @@
+/**
+ *  @example standalone/049_bezier_curves.cpp
+ *  @brief Measures the evaluation of points on Bezier curves
+ *
+ *  Samples a closed cubic Bezier loop with 10 thousand to 1 million points
+ *  and prints the time spent by evaluating the Bernstein polynomials
+ *  for each point, by calling Position01 and by the forward differencing
+ *  done by Approximate. Then prints the number of points and the time
+ *  of the adaptive tessellation with several tolerances and the time of
+ *  making an arc-length table and sampling the curve at constant speed.
+ *  This example does not need a GL context.
+ *
+ *  Copyright 2008-2015 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ *
+ */
+#include <oglplus/gl.hpp>
+#include <oglplus/math/vector.hpp>
+#include <oglplus/math/curve.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <vector>
+
+namespace oglplus {
+
+template <typename Func>
+static double measure(std::size_t repeat, Func func)
+{
+	auto start = std::chrono::steady_clock::now();
+	for(std::size_t r=0; r!=repeat; ++r)
+	{
+		func();
+	}
+	auto end = std::chrono::steady_clock::now();
+	return std::chrono::duration<double, std::milli>(end-start).count()/repeat;
+}
+
+} // namespace oglplus
+
+int main(void)
+{
+	using namespace oglplus;
+
+	typedef CubicBezierLoop<Vec3f, GLfloat> Loop;
+
+	std::mt19937 rng(42);
+	std::uniform_real_distribution<GLfloat> coord(-10.0f, 10.0f);
+
+	std::vector<Vec3f> path(100);
+	for(auto i=path.begin(), e=path.end(); i!=e; ++i)
+	{
+		*i = Vec3f(coord(rng), coord(rng), coord(rng));
+	}
+	Loop loop(path);
+	const unsigned segments = loop.SegmentCount();
+	const std::vector<Vec3f>& cp = loop.ControlPoints();
+
+	std::cout << std::fixed << std::setprecision(3);
+
+	const unsigned counts[] = {10000, 100000, 1000000};
+	for(unsigned count : counts)
+	{
+		const unsigned n = count/segments;
+		const std::size_t repeat = std::max<std::size_t>(10000000/count, 3);
+
+		std::vector<Vec3f> points(segments*n+1);
+
+		double bernstein_ms = measure(repeat, [&](void)
+		{
+			const GLfloat t_step = 1.0f/n;
+			auto p = points.begin();
+			for(unsigned i=0; i!=segments; ++i)
+			{
+				const std::size_t poffs = i*loop.SegmentStep();
+				for(unsigned j=0; j!=n; ++j)
+				{
+					*p++ = math::Bezier<Vec3f, GLfloat, 3>::Position(
+						cp.data()+poffs,
+						cp.size()-poffs,
+						j*t_step
+					);
+				}
+			}
+		});
+		double position_ms = measure(repeat, [&](void)
+		{
+			const GLfloat t_step = 1.0f/(segments*n);
+			for(unsigned k=0, e=segments*n; k!=e; ++k)
+			{
+				points[k] = loop.Position01(k*t_step);
+			}
+		});
+		double forward_ms = measure(repeat, [&](void)
+		{
+			loop.Approximate(points, n);
+		});
+
+		std::cout
+			<< segments*n << " points:" << std::endl
+			<< "  Bernstein polynomials: " << bernstein_ms << " [ms]"
+			<< std::endl
+			<< "  Position01 (Horner):   " << position_ms << " [ms]"
+			<< std::endl
+			<< "  Approximate (forward differences): "
+			<< forward_ms << " [ms]" << std::endl;
+	}
+
+	const GLfloat tolerances[] = {0.1f, 0.01f, 0.001f};
+	for(GLfloat tolerance : tolerances)
+	{
+		std::vector<Vec3f> points;
+		double tessellate_ms = measure(100, [&](void)
+		{
+			loop.Tessellate(points, tolerance);
+		});
+		std::cout
+			<< "Tessellation with tolerance " << tolerance << ": "
+			<< points.size() << " points, "
+			<< tessellate_ms << " [ms]" << std::endl;
+	}
+
+	BezierArcLengthTable<Vec3f, GLfloat, 3> table(loop);
+	double table_ms = measure(100, [&](void)
+	{
+		table = BezierArcLengthTable<Vec3f, GLfloat, 3>(loop);
+	});
+	std::vector<Vec3f> points;
+	double constant_ms = measure(100, [&](void)
+	{
+		loop.ApproximateConstantSpeed(points, 10000, table);
+	});
+
+	// the distances between the points are the lengths of the chords
+	// which are shorter than the arcs around the sharp bends of the curve
+	std::vector<GLfloat> steps;
+	for(std::size_t i=1; i!=points.size(); ++i)
+	{
+		steps.push_back(Distance(points[i-1], points[i]));
+	}
+	std::sort(steps.begin(), steps.end());
+	std::cout
+		<< "Arc-length table: " << table_ms << " [ms], "
+		<< "curve length " << table.Length() << std::endl
+		<< "10000 points at constant speed: " << constant_ms << " [ms], "
+		<< "step " << steps[steps.size()/100] << " - "
+		<< steps[steps.size()*99/100] << " (1st - 99th percentile)"
+		<< std::endl;
+
+	return 0;
+}
@@ -0,0 +1,218 @@
+/**
+ *  @example standalone/050_quaternion_batch.cpp
+ *  @brief Measures the batch quaternion operations
+ *
+ *  Generates 10 thousand to 1 million random pairs of unit quaternions
+ *  and prints the time spent by multiplying them, rotating vectors,
+ *  interpolating with NLERP and SLERP and by converting them to matrices,
+ *  one quaternion at a time with Quaternion, QuaternionSLERP and
+ *  ModelMatrix::RotationQ and with the QuaternionBatch functions working
+ *  on arrays in the structure-of-arrays layout. Then prints the maximal
+ *  error of the batch SLERP. This example does not need a GL context.
+ *
+ *  Copyright 2008-2015 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ *
+ */
+#include <oglplus/gl.hpp>
+#include <oglplus/quaternion_batch.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <vector>
+
+namespace oglplus {
+
+template <typename Func>
+static double measure(std::size_t repeat, Func func)
+{
+	auto start = std::chrono::steady_clock::now();
+	for(std::size_t r=0; r!=repeat; ++r)
+	{
+		func();
+	}
+	auto end = std::chrono::steady_clock::now();
+	return std::chrono::duration<double, std::milli>(end-start).count()/repeat;
+}
+
+static void print(const char* name, double single_ms, double batch_ms)
+{
+	std::cout
+		<< "  " << std::left << std::setw(11) << name << std::right
+		<< std::setw(9) << single_ms << " [ms] one by one, "
+		<< std::setw(9) << batch_ms << " [ms] batch ("
+		<< std::setprecision(1) << single_ms/batch_ms << "x)"
+		<< std::setprecision(3) << std::endl;
+}
+
+static void benchmark(std::size_t count)
+{
+	std::mt19937 rng(42);
+	std::uniform_real_distribution<GLfloat> comp(-1.0f, 1.0f);
+
+	std::vector<Quatf> q1, q2;
+	std::vector<Vec3f> v;
+	QuaternionArray bq1, bq2;
+	Vec3Array bv;
+	for(std::size_t i=0; i!=count; ++i)
+	{
+		Quatf a(comp(rng), comp(rng), comp(rng), comp(rng));
+		Quatf b(comp(rng), comp(rng), comp(rng), comp(rng));
+		// keep the pairs on the shorter arc, since QuaternionSLERP
+		// interpolates between the quaternions as they are
+		if(Dot(a, b) < 0.0f) b = b*-1.0f;
+		q1.push_back(a.Normalize());
+		q2.push_back(b.Normalize());
+		v.push_back(Vec3f(comp(rng), comp(rng), comp(rng)));
+		bq1.Add(q1.back());
+		bq2.Add(q2.back());
+		bv.Add(v.back());
+	}
+
+	const std::size_t repeat = std::max<std::size_t>(10000000/count, 3);
+	const GLfloat t = 0.3f;
+
+	std::vector<Quatf> qr(count, Quatf(1, 0, 0, 0));
+	std::vector<Vec3f> vr(count);
+	std::vector<Mat4f> mr(count);
+	QuaternionArray bqr;
+	Vec3Array bvr;
+	std::vector<Mat4f> bmr;
+	std::vector<Mat3x4f> bpr;
+
+	std::cout << count << " quaternions:" << std::endl;
+
+	print(
+		"multiply",
+		measure(repeat, [&](void)
+		{
+			for(std::size_t i=0; i!=count; ++i)
+			{
+				qr[i] = q1[i]*q2[i];
+			}
+		}),
+		measure(repeat, [&](void)
+		{
+			QuaternionBatch::Multiply(bq1, bq2, bqr);
+		})
+	);
+	print(
+		"rotate",
+		measure(repeat, [&](void)
+		{
+			for(std::size_t i=0; i!=count; ++i)
+			{
+				vr[i] = Rotate(q1[i], v[i]);
+			}
+		}),
+		measure(repeat, [&](void)
+		{
+			QuaternionBatch::Rotate(bq1, bv, bvr);
+		})
+	);
+	print(
+		"NLERP",
+		measure(repeat, [&](void)
+		{
+			for(std::size_t i=0; i!=count; ++i)
+			{
+				qr[i] = (q1[i]*(1.0f-t) + q2[i]*t).Normalize();
+			}
+		}),
+		measure(repeat, [&](void)
+		{
+			QuaternionBatch::NLERP(bq1, bq2, t, bqr);
+		})
+	);
+	print(
+		"SLERP",
+		measure(repeat, [&](void)
+		{
+			for(std::size_t i=0; i!=count; ++i)
+			{
+				qr[i] = QuatfSLERP(q1[i], q2[i])(t);
+			}
+		}),
+		measure(repeat, [&](void)
+		{
+			QuaternionBatch::SLERP(bq1, bq2, t, bqr);
+		})
+	);
+	print(
+		"Mat4f",
+		measure(repeat, [&](void)
+		{
+			for(std::size_t i=0; i!=count; ++i)
+			{
+				mr[i] = ModelMatrixf::RotationQ(q1[i]);
+			}
+		}),
+		measure(repeat, [&](void)
+		{
+			QuaternionBatch::ToMatrices(bq1, bmr);
+		})
+	);
+	print(
+		"Mat3x4f",
+		measure(repeat, [&](void)
+		{
+			for(std::size_t i=0; i!=count; ++i)
+			{
+				mr[i] = ModelMatrixf::RotationQ(q1[i]);
+			}
+		}),
+		measure(repeat, [&](void)
+		{
+			QuaternionBatch::ToMatrices(bq1, bpr);
+		})
+	);
+
+	// the error of SLERP against the exact formula in double precision
+	double max_error = 0.0;
+	const double ts[] = {0.0, 0.1, 0.3, 0.5, 0.7, 0.9, 1.0};
+	for(double f : ts)
+	{
+		QuaternionBatch::SLERP(bq1, bq2, GLfloat(f), bqr);
+		for(std::size_t i=0; i!=count; ++i)
+		{
+			double w = std::acos(std::min(double(Dot(q1[i], q2[i])), 1.0));
+			double c0 = 1-f, c1 = f;
+			if(w > 1e-6)
+			{
+				c0 = std::sin((1-f)*w)/std::sin(w);
+				c1 = std::sin(f*w)/std::sin(w);
+			}
+			Quatf r = bqr.Get(i);
+			for(std::size_t k=0; k!=4; ++k)
+			{
+				double e = c0*q1[i].At(k) + c1*q2[i].At(k);
+				max_error = std::max(max_error, std::fabs(r.At(k)-e));
+			}
+		}
+	}
+	std::cout
+		<< "  SLERP max. component error: "
+		<< std::scientific << max_error << std::fixed << std::endl;
+}
+
+} // namespace oglplus
+
+int main(void)
+{
+	using namespace oglplus;
+
+	std::cout << std::fixed << std::setprecision(3);
+
+	const std::size_t counts[] = {10000, 100000, 1000000};
+	for(std::size_t count : counts)
+	{
+		benchmark(count);
+	}
+
+	return 0;
+}
@@ -0,0 +1,199 @@
+/**
+ *  @file oglplus/async_builder.ipp
+ *  @brief Implementation of the asynchronous shader and program builder
+ *
+ *  @author Matus Chochlik
+ *
+ *  Copyright 2010-2015 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#include <oglplus/lib/incl_begin.ipp>
+#include <oglplus/extension.hpp>
+#include <oglplus/object/reference.hpp>
+#include <oglplus/lib/incl_end.ipp>
+
+#if !GL_KHR_parallel_shader_compile || !GL_ARB_parallel_shader_compile
+# if defined(_WIN32)
+#  include <Windows.h>
+# elif !defined(__APPLE__)
+// the GLX ABI requires libGL to export this function,
+// declared here to avoid pulling the X11 headers in
+extern "C" void (*glXGetProcAddressARB(const GLubyte*))(void);
+# endif
+#endif
+
+namespace oglplus {
+namespace aux {
+
+// the value of GL_COMPLETION_STATUS_{KHR,ARB}
+static const GLenum AsyncCompletionStatus = 0x91B1;
+
+#if !GL_KHR_parallel_shader_compile || !GL_ARB_parallel_shader_compile
+// calls glMaxShaderCompilerThreads{KHR,ARB} not declared by the GL
+// headers through the entry point resolved at run-time
+inline void AsyncMaxCompilerThreads(const char* name, GLuint count)
+{
+	typedef void (GLAPIENTRY *Func)(GLuint);
+# if defined(_WIN32)
+	Func func = reinterpret_cast<Func>(wglGetProcAddress(name));
+# elif !defined(__APPLE__)
+	Func func = reinterpret_cast<Func>(
+		glXGetProcAddressARB(reinterpret_cast<const GLubyte*>(name))
+	);
+# else
+	Func func = nullptr;
+	(void)name;
+# endif
+	if(func)
+	{
+		func(count);
+		OGLPLUS_VERIFY_SIMPLE(MaxShaderCompilerThreads);
+	}
+}
+#endif
+
+} // namespace aux
+
+OGLPLUS_LIB_FUNC
+AsyncBuilder::AsyncBuilder(void)
+ : _has_khr(false)
+ , _has_arb(false)
+{
+	// without GLEW the extensions are looked up by name
+	// even if the GL headers do not know them
+#if GL_KHR_parallel_shader_compile || !OGLPLUS_USE_GLEW
+	_has_khr = OGLPLUS_HAS_GL_EXT(KHR, parallel_shader_compile);
+#endif
+#if GL_ARB_parallel_shader_compile || !OGLPLUS_USE_GLEW
+	_has_arb = !_has_khr && OGLPLUS_HAS_GL_EXT(ARB, parallel_shader_compile);
+#endif
+}
+
+OGLPLUS_LIB_FUNC
+void AsyncBuilder::MaxCompilerThreads(GLuint count)
+{
+	if(_has_khr)
+	{
+#if GL_KHR_parallel_shader_compile
+		OGLPLUS_GLFUNC(MaxShaderCompilerThreadsKHR)(count);
+		OGLPLUS_VERIFY_SIMPLE(MaxShaderCompilerThreadsKHR);
+#else
+		aux::AsyncMaxCompilerThreads("glMaxShaderCompilerThreadsKHR", count);
+#endif
+	}
+	else if(_has_arb)
+	{
+#if GL_ARB_parallel_shader_compile
+		OGLPLUS_GLFUNC(MaxShaderCompilerThreadsARB)(count);
+		OGLPLUS_VERIFY_SIMPLE(MaxShaderCompilerThreadsARB);
+#else
+		aux::AsyncMaxCompilerThreads("glMaxShaderCompilerThreadsARB", count);
+#endif
+	}
+}
+
+OGLPLUS_LIB_FUNC
+AsyncBuilder& AsyncBuilder::Compile(ShaderName shader, Callback callback)
+{
+	Reference<ShaderOps>(shader).CompileAsync();
+	_entry entry = { GetGLName(shader), false, std::move(callback) };
+	_pending.push_back(std::move(entry));
+	return *this;
+}
+
+OGLPLUS_LIB_FUNC
+AsyncBuilder& AsyncBuilder::Link(ProgramName program, Callback callback)
+{
+	Reference<ProgramOps>(program).LinkAsync();
+	_entry entry = { GetGLName(program), true, std::move(callback) };
+	_pending.push_back(std::move(entry));
+	return *this;
+}
+
+OGLPLUS_LIB_FUNC
+bool AsyncBuilder::_is_complete(const _entry& entry) const
+{
+	const GLenum pname = aux::AsyncCompletionStatus;
+	if(CanPoll())
+	{
+		GLint status = GL_FALSE;
+		if(entry.is_program)
+		{
+			OGLPLUS_GLFUNC(GetProgramiv)(entry.name, pname, &status);
+			OGLPLUS_VERIFY(
+				GetProgramiv,
+				ObjectError,
+				Object(ProgramName(entry.name)).
+				EnumParam(pname)
+			);
+		}
+		else
+		{
+			OGLPLUS_GLFUNC(GetShaderiv)(entry.name, pname, &status);
+			OGLPLUS_VERIFY(
+				GetShaderiv,
+				ObjectError,
+				Object(ShaderName(entry.name)).
+				EnumParam(pname)
+			);
+		}
+		return status == GL_TRUE;
+	}
+	// without the extensions the status queries block anyway
+	(void)entry;
+	return true;
+}
+
+OGLPLUS_LIB_FUNC
+void AsyncBuilder::_finish(const _entry& entry)
+{
+	if(entry.is_program)
+	{
+		Reference<ProgramOps> program((ProgramName(entry.name)));
+		if(entry.callback) entry.callback(program.IsLinked());
+		else program.CheckLinked();
+	}
+	else
+	{
+		Reference<ShaderOps> shader((ShaderName(entry.name)));
+		if(entry.callback) entry.callback(shader.IsCompiled());
+		else shader.CheckCompiled();
+	}
+}
+
+OGLPLUS_LIB_FUNC
+std::size_t AsyncBuilder::Poll(void)
+{
+	std::size_t finished = 0;
+	std::size_t i = 0;
+	while(i != _pending.size())
+	{
+		if(_is_complete(_pending[i]))
+		{
+			// removed first, so that the others can be still
+			// polled if the build failed and an exception is thrown
+			_entry entry = std::move(_pending[i]);
+			_pending.erase(_pending.begin()+i);
+			++finished;
+			_finish(entry);
+		}
+		else ++i;
+	}
+	return finished;
+}
+
+OGLPLUS_LIB_FUNC
+void AsyncBuilder::Finish(void)
+{
+	while(!_pending.empty())
+	{
+		_entry entry = std::move(_pending.front());
+		_pending.erase(_pending.begin());
+		_finish(entry);
+	}
+}
+
+} // namespace oglplus
+
@@ -0,0 +1,160 @@
+/**
+ *  @file oglplus/buffer_ring.ipp
+ *  @brief Implementation of the persistently mapped buffer ring
+ *
+ *  @author Matus Chochlik
+ *
+ *  Copyright 2010-2015 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#include <oglplus/lib/incl_begin.ipp>
+#include <oglplus/error/object.hpp>
+#include <oglplus/lib/incl_end.ipp>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+#include <cassert>
+
+namespace oglplus {
+
+#if OGLPLUS_DOCUMENTATION_ONLY || GL_VERSION_4_4 || GL_ARB_buffer_storage
+
+OGLPLUS_LIB_FUNC
+BufferRing::BufferRing(BufferTarget target, std::size_t size)
+ : _target(target)
+ , _mapped(nullptr)
+ , _ring(size)
+ , _current(0)
+ , _uniform_alignment(16)
+{
+	ResetStats();
+
+	GLint alignment = 0;
+	OGLPLUS_GLFUNC(GetIntegerv)(
+		GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT,
+		&alignment
+	);
+	OGLPLUS_VERIFY_SIMPLE(GetIntegerv);
+	if(alignment > 0)
+	{
+		_uniform_alignment = std::size_t(alignment);
+	}
+
+	const BufferName previous = Buffer::Binding(_target);
+	Buffer::Bind(_target, _buffer);
+	Buffer::Storage(
+		_target,
+		BufferSize(size),
+		nullptr,
+		BufferStorageBit::MapWrite|
+		BufferStorageBit::MapPersistent|
+		BufferStorageBit::MapCoherent
+	);
+	_mapped = static_cast<GLubyte*>(OGLPLUS_GLFUNC(MapBufferRange)(
+		GLenum(_target),
+		0,
+		GLsizeiptr(size),
+		GL_MAP_WRITE_BIT|
+		GL_MAP_PERSISTENT_BIT|
+		GL_MAP_COHERENT_BIT
+	));
+	OGLPLUS_CHECK(
+		MapBufferRange,
+		Error,
+		EnumParam(_target)
+	);
+	Buffer::Bind(_target, previous);
+}
+
+OGLPLUS_LIB_FUNC
+BufferRingRange BufferRing::Allocate(std::size_t size, std::size_t alignment)
+{
+	assert(alignment > 0);
+
+	bool waited = false;
+	auto start = std::chrono::steady_clock::now();
+	std::size_t offset = 0, reserved = 0;
+	while(true)
+	{
+		const std::size_t head = _ring.Head();
+		offset = ((head+alignment-1)/alignment)*alignment;
+		if(offset+size > _ring.Size())
+		{
+			// the rest of the ring is skipped
+			offset = 0;
+		}
+		reserved = ((offset < head)?_ring.Size():offset)-head+size;
+		if(_ring.Free() >= reserved) break;
+
+		if(_ring.Pending() == 0)
+		{
+			throw std::runtime_error(
+				"The buffer ring is too small for the data of the frame"
+			);
+		}
+		if(!waited)
+		{
+			waited = true;
+			start = std::chrono::steady_clock::now();
+			++_stats.waits;
+		}
+		_ring.Recycle(true);
+	}
+	if(waited)
+	{
+		_stats.wait_time += std::chrono::duration<double>(
+			std::chrono::steady_clock::now()-start
+		).count();
+	}
+
+	_ring.Reserve(offset+size, reserved);
+	_current += reserved;
+
+	++_stats.allocations;
+	_stats.bytes += size;
+	_stats.peak_used = std::max(_stats.peak_used, _ring.Used());
+
+	return BufferRingRange(_mapped+offset, offset, size);
+}
+
+OGLPLUS_LIB_FUNC
+BufferRingRange BufferRing::Copy(
+	const void* data,
+	std::size_t size,
+	std::size_t alignment
+)
+{
+	BufferRingRange range = Allocate(size, alignment);
+	std::memcpy(range.Data(), data, size);
+	return range;
+}
+
+OGLPLUS_LIB_FUNC
+void BufferRing::EndFrame(void)
+{
+	if(_current != 0)
+	{
+		_ring.Fence(_current);
+		_current = 0;
+		++_stats.frames;
+	}
+	while(_ring.Recycle(false));
+}
+
+OGLPLUS_LIB_FUNC
+void BufferRing::ResetStats(void)
+{
+	_stats.allocations = 0;
+	_stats.bytes = 0;
+	_stats.frames = 0;
+	_stats.waits = 0;
+	_stats.wait_time = 0;
+	_stats.peak_used = _ring.Used();
+}
+
+#endif // buffer storage
+
+} // namespace oglplus
@@ -0,0 +1,742 @@
+/**
+ *  @file oglplus/command_list.ipp
+ *  @brief Implementation of the deferred command lists
+ *
+ *  @author Matus Chochlik
+ *
+ *  Copyright 2010-2015 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#include <oglplus/lib/incl_begin.ipp>
+#include <oglplus/error/basic.hpp>
+#include <oglplus/lib/incl_end.ipp>
+#include <algorithm>
+#include <cstring>
+#include <cassert>
+
+namespace oglplus {
+namespace aux {
+
+enum CommandListOpcode
+{
+	CommandListUseProgram,
+	CommandListBindVertexArray,
+	CommandListBindBuffer,
+	CommandListBindBufferBase,
+	CommandListBindTexture,
+	CommandListEnable,
+	CommandListDisable,
+	CommandListUniform,
+	CommandListBufferSubData,
+	CommandListDrawArrays,
+	CommandListDrawElements
+};
+
+struct CommandListHeader
+{
+	std::uint32_t opcode;
+	// the size of the command including the header and padding
+	std::uint32_t size;
+};
+
+struct CommandListBinding
+{
+	GLenum target;
+	GLuint index;
+	GLuint name;
+};
+
+struct CommandListUniformCmd
+{
+	GLint location;
+	GLuint kind;
+	GLuint components;
+	GLsizei count;
+	// followed by the values
+};
+
+struct CommandListBufferSubDataCmd
+{
+	GLenum target;
+	GLintptr offset;
+	GLsizeiptr size;
+	// followed by the data
+};
+
+struct CommandListDrawCmd
+{
+	GLenum mode;
+	GLint first;
+	GLsizei count;
+	GLsizei instances;
+	GLenum index_type;
+	const GLvoid* indices;
+};
+
+// the alignment of the commands in the blocks
+static const std::size_t CommandListAlign = 8;
+
+inline
+std::size_t CommandListAligned(std::size_t size)
+{
+	return (size+CommandListAlign-1) & ~(CommandListAlign-1);
+}
+
+} // namespace aux
+
+OGLPLUS_LIB_FUNC
+CommandList::CommandList(std::size_t block_size)
+ : _current(0)
+ , _block_size(aux::CommandListAligned(block_size))
+ , _command_count(0)
+{
+	assert(_block_size > 0);
+}
+
+OGLPLUS_LIB_FUNC
+CommandList::CommandList(CommandList&& temp)
+ : _blocks(std::move(temp._blocks))
+ , _current(temp._current)
+ , _block_size(temp._block_size)
+ , _command_count(temp._command_count)
+{
+	temp._current = 0;
+	temp._command_count = 0;
+}
+
+OGLPLUS_LIB_FUNC
+void CommandList::Clear(void)
+{
+	for(auto i=_blocks.begin(), e=_blocks.end(); i!=e; ++i)
+	{
+		i->used = 0;
+	}
+	_current = 0;
+	_command_count = 0;
+}
+
+OGLPLUS_LIB_FUNC
+std::size_t CommandList::UsedBytes(void) const
+{
+	std::size_t result = 0;
+	for(auto i=_blocks.begin(), e=_blocks.end(); i!=e; ++i)
+	{
+		result += i->used;
+	}
+	return result;
+}
+
+OGLPLUS_LIB_FUNC
+std::size_t CommandList::AllocatedBytes(void) const
+{
+	std::size_t result = 0;
+	for(auto i=_blocks.begin(), e=_blocks.end(); i!=e; ++i)
+	{
+		result += i->size;
+	}
+	return result;
+}
+
+OGLPLUS_LIB_FUNC
+unsigned char* CommandList::_alloc(std::size_t size)
+{
+	assert(size % aux::CommandListAlign == 0);
+
+	while(_current < _blocks.size())
+	{
+		_Block& block = _blocks[_current];
+		if(block.size-block.used >= size)
+		{
+			unsigned char* result = block.data.get()+block.used;
+			block.used += size;
+			return result;
+		}
+		if(block.used == 0)
+		{
+			// an unused block too small for the command, replace it
+			block.data.reset(new unsigned char[size]);
+			block.size = size;
+			continue;
+		}
+		++_current;
+	}
+
+	_Block block;
+	block.size = std::max(_block_size, size);
+	block.data.reset(new unsigned char[block.size]);
+	block.used = size;
+	_blocks.push_back(std::move(block));
+	_current = _blocks.size()-1;
+	return _blocks.back().data.get();
+}
+
+OGLPLUS_LIB_FUNC
+void* CommandList::_record(unsigned opcode, std::size_t size)
+{
+	const std::size_t total = aux::CommandListAligned(
+		sizeof(aux::CommandListHeader)+size
+	);
+	unsigned char* data = _alloc(total);
+
+	aux::CommandListHeader header;
+	header.opcode = std::uint32_t(opcode);
+	header.size = std::uint32_t(total);
+	std::memcpy(data, &header, sizeof(header));
+
+	++_command_count;
+	return data+sizeof(header);
+}
+
+OGLPLUS_LIB_FUNC
+CommandList& CommandList::UseProgram(ProgramName program)
+{
+	aux::CommandListBinding cmd = {0u, 0u, GetGLName(program)};
+	std::memcpy(
+		_record(aux::CommandListUseProgram, sizeof(cmd)),
+		&cmd,
+		sizeof(cmd)
+	);
+	return *this;
+}
+
+OGLPLUS_LIB_FUNC
+CommandList& CommandList::BindVertexArray(VertexArrayName vao)
+{
+	aux::CommandListBinding cmd = {0u, 0u, GetGLName(vao)};
+	std::memcpy(
+		_record(aux::CommandListBindVertexArray, sizeof(cmd)),
+		&cmd,
+		sizeof(cmd)
+	);
+	return *this;
+}
+
+OGLPLUS_LIB_FUNC
+CommandList& CommandList::BindBuffer(BufferTarget target, BufferName buffer)
+{
+	aux::CommandListBinding cmd = {
+		GLenum(target),
+		0u,
+		GetGLName(buffer)
+	};
+	std::memcpy(
+		_record(aux::CommandListBindBuffer, sizeof(cmd)),
+		&cmd,
+		sizeof(cmd)
+	);
+	return *this;
+}
+
+#if OGLPLUS_DOCUMENTATION_ONLY || GL_VERSION_3_0
+OGLPLUS_LIB_FUNC
+CommandList& CommandList::BindBufferBase(
+	BufferIndexedTarget target,
+	GLuint index,
+	BufferName buffer
+)
+{
+	aux::CommandListBinding cmd = {
+		GLenum(target),
+		index,
+		GetGLName(buffer)
+	};
+	std::memcpy(
+		_record(aux::CommandListBindBufferBase, sizeof(cmd)),
+		&cmd,
+		sizeof(cmd)
+	);
+	return *this;
+}
+#endif
+
+OGLPLUS_LIB_FUNC
+CommandList& CommandList::BindTexture(
+	GLuint unit,
+	TextureTarget target,
+	TextureName texture
+)
+{
+	aux::CommandListBinding cmd = {
+		GLenum(target),
+		unit,
+		GetGLName(texture)
+	};
+	std::memcpy(
+		_record(aux::CommandListBindTexture, sizeof(cmd)),
+		&cmd,
+		sizeof(cmd)
+	);
+	return *this;
+}
+
+OGLPLUS_LIB_FUNC
+CommandList& CommandList::Enable(Capability capability)
+{
+	aux::CommandListBinding cmd = {GLenum(capability), 0u, 0u};
+	std::memcpy(
+		_record(aux::CommandListEnable, sizeof(cmd)),
+		&cmd,
+		sizeof(cmd)
+	);
+	return *this;
+}
+
+OGLPLUS_LIB_FUNC
+CommandList& CommandList::Disable(Capability capability)
+{
+	aux::CommandListBinding cmd = {GLenum(capability), 0u, 0u};
+	std::memcpy(
+		_record(aux::CommandListDisable, sizeof(cmd)),
+		&cmd,
+		sizeof(cmd)
+	);
+	return *this;
+}
+
+OGLPLUS_LIB_FUNC
+void CommandList::_uniform(
+	GLint location,
+	_UniformKind kind,
+	GLuint components,
+	GLsizei count,
+	const void* values,
+	std::size_t value_size
+)
+{
+	assert(count >= 0);
+	const std::size_t n = (kind == _uniform_matrix)?
+		components*components:
+		components;
+	const std::size_t size = std::size_t(count)*n*value_size;
+
+	aux::CommandListUniformCmd cmd = {
+		location,
+		GLuint(kind),
+		components,
+		count
+	};
+	unsigned char* data = static_cast<unsigned char*>(_record(
+		aux::CommandListUniform,
+		sizeof(cmd)+size
+	));
+	std::memcpy(data, &cmd, sizeof(cmd));
+	std::memcpy(data+sizeof(cmd), values, size);
+}
+
+OGLPLUS_LIB_FUNC
+CommandList& CommandList::BufferSubData(
+	BufferTarget target,
+	GLintptr offset,
+	GLsizeiptr size,
+	const GLvoid* data
+)
+{
+	assert(size >= 0);
+	aux::CommandListBufferSubDataCmd cmd = {GLenum(target), offset, size};
+	unsigned char* dst = static_cast<unsigned char*>(_record(
+		aux::CommandListBufferSubData,
+		sizeof(cmd)+std::size_t(size)
+	));
+	std::memcpy(dst, &cmd, sizeof(cmd));
+	std::memcpy(dst+sizeof(cmd), data, std::size_t(size));
+	return *this;
+}
+
+OGLPLUS_LIB_FUNC
+CommandList& CommandList::DrawArrays(
+	PrimitiveType primitive,
+	GLint first,
+	GLsizei count,
+	GLsizei instances
+)
+{
+	aux::CommandListDrawCmd cmd = {
+		GLenum(primitive),
+		first,
+		count,
+		instances,
+		GLenum(0),
+		nullptr
+	};
+	std::memcpy(
+		_record(aux::CommandListDrawArrays, sizeof(cmd)),
+		&cmd,
+		sizeof(cmd)
+	);
+	return *this;
+}
+
+OGLPLUS_LIB_FUNC
+CommandList& CommandList::DrawElements(
+	PrimitiveType primitive,
+	GLsizei count,
+	DataType data_type,
+	const GLvoid* offset,
+	GLsizei instances
+)
+{
+	aux::CommandListDrawCmd cmd = {
+		GLenum(primitive),
+		0,
+		count,
+		instances,
+		GLenum(data_type),
+		offset
+	};
+	std::memcpy(
+		_record(aux::CommandListDrawElements, sizeof(cmd)),
+		&cmd,
+		sizeof(cmd)
+	);
+	return *this;
+}
+
+OGLPLUS_LIB_FUNC
+CommandExecutor::CommandExecutor(void)
+{
+	ResetStats();
+	_reset();
+}
+
+OGLPLUS_LIB_FUNC
+void CommandExecutor::ResetStats(void)
+{
+	_stats.lists = 0;
+	_stats.commands = 0;
+	_stats.skipped_binds = 0;
+}
+
+OGLPLUS_LIB_FUNC
+void CommandExecutor::_reset(void)
+{
+	// the bindings may have been changed since the last execution
+	_program = ~GLuint(0);
+	_vao = ~GLuint(0);
+	_active_unit = -1;
+	_textures.clear();
+}
+
+OGLPLUS_LIB_FUNC
+void CommandExecutor::_uniform(
+	const aux::CommandListUniformCmd& cmd,
+	const void* values
+)
+{
+	const GLint loc = cmd.location;
+	const GLsizei n = cmd.count;
+
+	if(cmd.kind == CommandList::_uniform_float)
+	{
+		const GLfloat* v = static_cast<const GLfloat*>(values);
+		switch(cmd.components)
+		{
+			case 1:
+				OGLPLUS_GLFUNC(Uniform1fv)(loc, n, v);
+				OGLPLUS_CHECK_SIMPLE(Uniform1fv);
+				break;
+			case 2:
+				OGLPLUS_GLFUNC(Uniform2fv)(loc, n, v);
+				OGLPLUS_CHECK_SIMPLE(Uniform2fv);
+				break;
+			case 3:
+				OGLPLUS_GLFUNC(Uniform3fv)(loc, n, v);
+				OGLPLUS_CHECK_SIMPLE(Uniform3fv);
+				break;
+			default:
+				OGLPLUS_GLFUNC(Uniform4fv)(loc, n, v);
+				OGLPLUS_CHECK_SIMPLE(Uniform4fv);
+		}
+	}
+	else if(cmd.kind == CommandList::_uniform_int)
+	{
+		const GLint* v = static_cast<const GLint*>(values);
+		switch(cmd.components)
+		{
+			case 1:
+				OGLPLUS_GLFUNC(Uniform1iv)(loc, n, v);
+				OGLPLUS_CHECK_SIMPLE(Uniform1iv);
+				break;
+			case 2:
+				OGLPLUS_GLFUNC(Uniform2iv)(loc, n, v);
+				OGLPLUS_CHECK_SIMPLE(Uniform2iv);
+				break;
+			case 3:
+				OGLPLUS_GLFUNC(Uniform3iv)(loc, n, v);
+				OGLPLUS_CHECK_SIMPLE(Uniform3iv);
+				break;
+			default:
+				OGLPLUS_GLFUNC(Uniform4iv)(loc, n, v);
+				OGLPLUS_CHECK_SIMPLE(Uniform4iv);
+		}
+	}
+#if GL_VERSION_3_0
+	else if(cmd.kind == CommandList::_uniform_uint)
+	{
+		const GLuint* v = static_cast<const GLuint*>(values);
+		switch(cmd.components)
+		{
+			case 1:
+				OGLPLUS_GLFUNC(Uniform1uiv)(loc, n, v);
+				OGLPLUS_CHECK_SIMPLE(Uniform1uiv);
+				break;
+			case 2:
+				OGLPLUS_GLFUNC(Uniform2uiv)(loc, n, v);
+				OGLPLUS_CHECK_SIMPLE(Uniform2uiv);
+				break;
+			case 3:
+				OGLPLUS_GLFUNC(Uniform3uiv)(loc, n, v);
+				OGLPLUS_CHECK_SIMPLE(Uniform3uiv);
+				break;
+			default:
+				OGLPLUS_GLFUNC(Uniform4uiv)(loc, n, v);
+				OGLPLUS_CHECK_SIMPLE(Uniform4uiv);
+		}
+	}
+#endif
+	else
+	{
+		assert(cmd.kind == CommandList::_uniform_matrix);
+		// the oglplus matrices are row-major
+		const GLfloat* v = static_cast<const GLfloat*>(values);
+		switch(cmd.components)
+		{
+			case 2:
+				OGLPLUS_GLFUNC(UniformMatrix2fv)(loc, n, GL_TRUE, v);
+				OGLPLUS_CHECK_SIMPLE(UniformMatrix2fv);
+				break;
+			case 3:
+				OGLPLUS_GLFUNC(UniformMatrix3fv)(loc, n, GL_TRUE, v);
+				OGLPLUS_CHECK_SIMPLE(UniformMatrix3fv);
+				break;
+			default:
+				OGLPLUS_GLFUNC(UniformMatrix4fv)(loc, n, GL_TRUE, v);
+				OGLPLUS_CHECK_SIMPLE(UniformMatrix4fv);
+		}
+	}
+}
+
+OGLPLUS_LIB_FUNC
+void CommandExecutor::_draw(
+	unsigned opcode,
+	const aux::CommandListDrawCmd& cmd
+)
+{
+	if(opcode == aux::CommandListDrawArrays)
+	{
+		if(cmd.instances == 1)
+		{
+			OGLPLUS_GLFUNC(DrawArrays)(cmd.mode, cmd.first, cmd.count);
+			OGLPLUS_CHECK_SIMPLE(DrawArrays);
+		}
+		else
+		{
+#if OGLPLUS_DOCUMENTATION_ONLY || GL_VERSION_3_1
+			OGLPLUS_GLFUNC(DrawArraysInstanced)(
+				cmd.mode,
+				cmd.first,
+				cmd.count,
+				cmd.instances
+			);
+			OGLPLUS_CHECK_SIMPLE(DrawArraysInstanced);
+#else
+			assert(!
+				"DrawArraysInstanced required, "
+				"but not supported by the used version of OpenGL!"
+			);
+#endif
+		}
+	}
+	else
+	{
+		if(cmd.instances == 1)
+		{
+			OGLPLUS_GLFUNC(DrawElements)(
+				cmd.mode,
+				cmd.count,
+				cmd.index_type,
+				cmd.indices
+			);
+			OGLPLUS_CHECK_SIMPLE(DrawElements);
+		}
+		else
+		{
+#if OGLPLUS_DOCUMENTATION_ONLY || GL_VERSION_3_1
+			OGLPLUS_GLFUNC(DrawElementsInstanced)(
+				cmd.mode,
+				cmd.count,
+				cmd.index_type,
+				cmd.indices,
+				cmd.instances
+			);
+			OGLPLUS_CHECK_SIMPLE(DrawElementsInstanced);
+#else
+			assert(!
+				"DrawElementsInstanced required, "
+				"but not supported by the used version of OpenGL!"
+			);
+#endif
+		}
+	}
+}
+
+OGLPLUS_LIB_FUNC
+void CommandExecutor::_execute(const CommandList& list)
+{
+	auto i = list._blocks.begin(), e = list._blocks.end();
+	for(; (i != e) && (i->used != 0); ++i)
+	{
+		const unsigned char* pos = i->data.get();
+		const unsigned char* end = pos+i->used;
+
+		while(pos != end)
+		{
+			aux::CommandListHeader header;
+			std::memcpy(&header, pos, sizeof(header));
+			const unsigned char* data = pos+sizeof(header);
+			pos += header.size;
+			assert(pos <= end);
+
+			aux::CommandListBinding bind;
+			switch(header.opcode)
+			{
+				case aux::CommandListUseProgram:
+					std::memcpy(&bind, data, sizeof(bind));
+					if(_program != bind.name)
+					{
+						OGLPLUS_GLFUNC(UseProgram)(bind.name);
+						OGLPLUS_VERIFY_SIMPLE(UseProgram);
+						_program = bind.name;
+					}
+					else ++_stats.skipped_binds;
+					break;
+				case aux::CommandListBindVertexArray:
+					std::memcpy(&bind, data, sizeof(bind));
+					if(_vao != bind.name)
+					{
+						OGLPLUS_GLFUNC(BindVertexArray)(bind.name);
+						OGLPLUS_VERIFY_SIMPLE(BindVertexArray);
+						_vao = bind.name;
+					}
+					else ++_stats.skipped_binds;
+					break;
+				case aux::CommandListBindBuffer:
+					std::memcpy(&bind, data, sizeof(bind));
+					OGLPLUS_GLFUNC(BindBuffer)(bind.target, bind.name);
+					OGLPLUS_VERIFY_SIMPLE(BindBuffer);
+					break;
+#if GL_VERSION_3_0
+				case aux::CommandListBindBufferBase:
+					std::memcpy(&bind, data, sizeof(bind));
+					OGLPLUS_GLFUNC(BindBufferBase)(
+						bind.target,
+						bind.index,
+						bind.name
+					);
+					OGLPLUS_VERIFY_SIMPLE(BindBufferBase);
+					break;
+#endif
+				case aux::CommandListBindTexture:
+				{
+					std::memcpy(&bind, data, sizeof(bind));
+					std::pair<GLenum, GLuint> tex(bind.target, bind.name);
+					if(_textures.size() <= bind.index)
+					{
+						_textures.resize(
+							bind.index+1,
+							std::make_pair(GLenum(0), 0u)
+						);
+					}
+					if(_textures[bind.index] != tex)
+					{
+						if(_active_unit != GLint(bind.index))
+						{
+							OGLPLUS_GLFUNC(ActiveTexture)(
+								GLenum(GL_TEXTURE0+bind.index)
+							);
+							OGLPLUS_VERIFY_SIMPLE(ActiveTexture);
+							_active_unit = GLint(bind.index);
+						}
+						OGLPLUS_GLFUNC(BindTexture)(bind.target, bind.name);
+						OGLPLUS_VERIFY_SIMPLE(BindTexture);
+						_textures[bind.index] = tex;
+					}
+					else ++_stats.skipped_binds;
+					break;
+				}
+				case aux::CommandListEnable:
+					std::memcpy(&bind, data, sizeof(bind));
+					OGLPLUS_GLFUNC(Enable)(bind.target);
+					OGLPLUS_VERIFY_SIMPLE(Enable);
+					break;
+				case aux::CommandListDisable:
+					std::memcpy(&bind, data, sizeof(bind));
+					OGLPLUS_GLFUNC(Disable)(bind.target);
+					OGLPLUS_VERIFY_SIMPLE(Disable);
+					break;
+				case aux::CommandListUniform:
+				{
+					aux::CommandListUniformCmd cmd;
+					std::memcpy(&cmd, data, sizeof(cmd));
+					_uniform(cmd, data+sizeof(cmd));
+					break;
+				}
+				case aux::CommandListBufferSubData:
+				{
+					aux::CommandListBufferSubDataCmd cmd;
+					std::memcpy(&cmd, data, sizeof(cmd));
+					OGLPLUS_GLFUNC(BufferSubData)(
+						cmd.target,
+						cmd.offset,
+						cmd.size,
+						data+sizeof(cmd)
+					);
+					OGLPLUS_CHECK_SIMPLE(BufferSubData);
+					break;
+				}
+				case aux::CommandListDrawArrays:
+				case aux::CommandListDrawElements:
+				{
+					aux::CommandListDrawCmd cmd;
+					std::memcpy(&cmd, data, sizeof(cmd));
+					_draw(header.opcode, cmd);
+					break;
+				}
+				default: assert(!"Invalid command list opcode!");
+			}
+			++_stats.commands;
+		}
+	}
+	++_stats.lists;
+}
+
+OGLPLUS_LIB_FUNC
+void CommandExecutor::Execute(const CommandList& list)
+{
+	_reset();
+	_execute(list);
+}
+
+OGLPLUS_LIB_FUNC
+void CommandExecutor::Execute(const std::vector<const CommandList*>& lists)
+{
+	_reset();
+	for(auto i=lists.begin(), e=lists.end(); i!=e; ++i)
+	{
+		assert(*i != nullptr);
+		_execute(**i);
+	}
+}
+
+OGLPLUS_LIB_FUNC
+void CommandExecutor::Execute(const std::vector<CommandList>& lists)
+{
+	_reset();
+	for(auto i=lists.begin(), e=lists.end(); i!=e; ++i)
+	{
+		_execute(*i);
+	}
+}
+
+} // namespace oglplus
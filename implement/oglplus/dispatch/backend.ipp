@@ -0,0 +1,27 @@
+/**
+ *  @file oglplus/dispatch/backend.ipp
+ *  @brief Implementation of GLDispatchBackend
+ *
+ *  @author Matus Chochlik
+ *
+ *  Copyright 2010-2015 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+namespace oglplus {
+
+OGLPLUS_LIB_FUNC
+GLDispatchBackend*& GLDispatchBackend::_current(void)
+{
+#if !OGLPLUS_NO_THREAD_LOCAL
+	static thread_local GLDispatchBackend* current = nullptr;
+#else
+	// without thread-local storage all threads share the backend
+	static GLDispatchBackend* current = nullptr;
+#endif
+	return current;
+}
+
+} // namespace oglplus
+
@@ -0,0 +1,376 @@
+/**
+ *  @file oglplus/dispatch/recorder.ipp
+ *  @brief Implementation of the recording GL dispatch backends
+ *
+ *  @author Matus Chochlik
+ *
+ *  Copyright 2010-2015 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <ostream>
+#include <string>
+#include <map>
+
+namespace oglplus {
+
+OGLPLUS_LIB_FUNC
+GLCallRecorder::GLCallRecorder(void)
+ : _epoch(_clock::now())
+ , _call_start(_epoch)
+ , _enabled(true)
+ , _forwarded(false)
+{ }
+
+OGLPLUS_LIB_FUNC
+bool GLCallRecorder::Forward(GLCallInfo&)
+{
+	return true;
+}
+
+OGLPLUS_LIB_FUNC
+bool GLCallRecorder::BeginCall(GLCallInfo& call)
+{
+	_forwarded = Forward(call);
+	_call_start = _clock::now();
+	return _forwarded;
+}
+
+OGLPLUS_LIB_FUNC
+void GLCallRecorder::EndCall(GLCallInfo& call)
+{
+	_clock::time_point call_end = _clock::now();
+	if(!_enabled) return;
+
+	GLCallRecord record;
+	record.name = call.name;
+	record.first_arg = _args.size();
+	record.arg_count = call.arg_count;
+	record.result = call.result;
+	record.function = call.function;
+	record.invoker = call.invoker;
+	record.start = _since_epoch(_call_start);
+	record.duration = std::chrono::duration<double>(
+		call_end - _call_start
+	).count();
+	record.forwarded = _forwarded;
+
+	_args.insert(_args.end(), call.args, call.args+call.arg_count);
+	_calls.push_back(record);
+}
+
+OGLPLUS_LIB_FUNC
+void GLCallRecorder::Clear(void)
+{
+	_calls.clear();
+	_args.clear();
+	_epoch = _clock::now();
+}
+
+OGLPLUS_LIB_FUNC
+std::size_t GLCallRecorder::CountOf(const char* name) const
+{
+	std::size_t result = 0;
+	for(auto i=_calls.begin(), e=_calls.end(); i!=e; ++i)
+	{
+		if(std::strcmp(i->name, name) == 0) ++result;
+	}
+	return result;
+}
+
+OGLPLUS_LIB_FUNC
+double GLCallRecorder::TimeSpan(void) const
+{
+	if(_calls.empty()) return 0.0;
+	return	_calls.back().start+
+		_calls.back().duration-
+		_calls.front().start;
+}
+
+OGLPLUS_LIB_FUNC
+std::vector<GLCallStats> GLCallRecorder::Statistics(void) const
+{
+	// the names are string literals, but the same literal
+	// may have different addresses in different translation units
+	std::map<std::string, GLCallStats> stats;
+	for(auto i=_calls.begin(), e=_calls.end(); i!=e; ++i)
+	{
+		auto p = stats.insert(
+			std::make_pair(i->name, GLCallStats())
+		);
+		GLCallStats& s = p.first->second;
+		if(p.second)
+		{
+			s.name = i->name;
+			s.count = 0;
+			s.time = 0.0;
+		}
+		s.count += 1;
+		s.time += i->duration;
+	}
+
+	std::vector<GLCallStats> result;
+	result.reserve(stats.size());
+	for(auto i=stats.begin(), e=stats.end(); i!=e; ++i)
+	{
+		result.push_back(i->second);
+	}
+	std::stable_sort(
+		result.begin(),
+		result.end(),
+		[](const GLCallStats& a, const GLCallStats& b) -> bool
+		{
+			return a.count > b.count;
+		}
+	);
+	return result;
+}
+
+OGLPLUS_LIB_FUNC
+std::ostream& GLCallRecorder::Report(std::ostream& out) const
+{
+	std::vector<GLCallStats> stats = Statistics();
+
+	out << "Calls: " << _calls.size() << std::endl;
+	out << "Time span: " << TimeSpan()*1e6 << " [us]" << std::endl;
+	for(auto i=stats.begin(), e=stats.end(); i!=e; ++i)
+	{
+		out	<< "gl" << i->name << ": "
+			<< i->count << " calls, "
+			<< i->time*1e6 << " [us]"
+			<< std::endl;
+	}
+	return out;
+}
+
+OGLPLUS_LIB_FUNC
+std::ostream& GLCallRecorder::Dump(std::ostream& out) const
+{
+	for(auto i=_calls.begin(), e=_calls.end(); i!=e; ++i)
+	{
+		out << i->start*1e6 << " gl" << i->name << "(";
+		for(std::size_t a=0; a!=i->arg_count; ++a)
+		{
+			if(a) out << ", ";
+			const GLCallArg& arg = _args[i->first_arg+a];
+			switch(arg.kind)
+			{
+				case GLCallArgKind::Integer:
+					out << arg.value.i;
+					break;
+				case GLCallArgKind::Float:
+					out << arg.value.f;
+					break;
+				case GLCallArgKind::ConstPointer:
+				case GLCallArgKind::Pointer:
+					out << arg.value.p;
+					break;
+				case GLCallArgKind::FuncPointer:
+					out << "<function>";
+					break;
+				case GLCallArgKind::None:
+					break;
+			}
+		}
+		out << ")";
+		if(i->result.kind == GLCallArgKind::Integer)
+		{
+			out << " = " << i->result.value.i;
+		}
+		else if(i->result.IsPointer())
+		{
+			out << " = " << i->result.value.p;
+		}
+		out << std::endl;
+	}
+	return out;
+}
+
+OGLPLUS_LIB_FUNC
+void GLCallRecorder::Replay(void)
+{
+	bool was_enabled = _enabled;
+	if(GLDispatchBackend::Current() == this)
+	{
+		_enabled = false;
+	}
+	// the list of calls cannot change during the replay
+	// but make a copy anyway in case recording was not disabled
+	std::vector<GLCallRecord> calls(_calls);
+	std::vector<GLCallArg> args(_args);
+
+	for(auto i=calls.begin(), e=calls.end(); i!=e; ++i)
+	{
+		GLCallArg result;
+		i->invoker(
+			i->function,
+			i->name,
+			args.data()+i->first_arg,
+			&result
+		);
+	}
+	_enabled = was_enabled;
+}
+
+OGLPLUS_LIB_FUNC
+GLHeadlessRecorder::GLHeadlessRecorder(void)
+ : _next_name(1)
+{
+	const GLint limit = 64;
+#ifdef GL_MAX_TEXTURE_IMAGE_UNITS
+	SetInteger(GL_MAX_TEXTURE_IMAGE_UNITS, limit);
+#endif
+#ifdef GL_MAX_COMBINED_TEXTURE_IMAGE_UNITS
+	SetInteger(GL_MAX_COMBINED_TEXTURE_IMAGE_UNITS, limit);
+#endif
+#ifdef GL_MAX_VERTEX_ATTRIBS
+	SetInteger(GL_MAX_VERTEX_ATTRIBS, limit);
+#endif
+#ifdef GL_MAX_DRAW_BUFFERS
+	SetInteger(GL_MAX_DRAW_BUFFERS, limit);
+#endif
+#ifdef GL_MAX_COLOR_ATTACHMENTS
+	SetInteger(GL_MAX_COLOR_ATTACHMENTS, limit);
+#endif
+#ifdef GL_MAX_UNIFORM_BUFFER_BINDINGS
+	SetInteger(GL_MAX_UNIFORM_BUFFER_BINDINGS, limit);
+#endif
+#ifdef GL_MAX_TRANSFORM_FEEDBACK_BUFFERS
+	SetInteger(GL_MAX_TRANSFORM_FEEDBACK_BUFFERS, limit);
+#endif
+#ifdef GL_MAX_SHADER_STORAGE_BUFFER_BINDINGS
+	SetInteger(GL_MAX_SHADER_STORAGE_BUFFER_BINDINGS, limit);
+#endif
+#ifdef GL_MAX_ATOMIC_COUNTER_BUFFER_BINDINGS
+	SetInteger(GL_MAX_ATOMIC_COUNTER_BUFFER_BINDINGS, limit);
+#endif
+#ifdef GL_MAX_IMAGE_UNITS
+	SetInteger(GL_MAX_IMAGE_UNITS, limit);
+#endif
+#ifdef GL_MAX_VIEWPORTS
+	SetInteger(GL_MAX_VIEWPORTS, 16);
+#endif
+#ifdef GL_MAX_CLIP_DISTANCES
+	SetInteger(GL_MAX_CLIP_DISTANCES, 8);
+#endif
+#ifdef GL_MAX_TEXTURE_SIZE
+	SetInteger(GL_MAX_TEXTURE_SIZE, 16384);
+#endif
+#ifdef GL_MAX_RENDERBUFFER_SIZE
+	SetInteger(GL_MAX_RENDERBUFFER_SIZE, 16384);
+#endif
+}
+
+OGLPLUS_LIB_FUNC
+bool GLHeadlessRecorder::Forward(GLCallInfo& call)
+{
+	Emulate(call);
+	return false;
+}
+
+OGLPLUS_LIB_FUNC
+void GLHeadlessRecorder::Emulate(GLCallInfo& call)
+{
+	const char* name = call.name;
+	GLCallArg* args = call.args;
+	const std::size_t n = call.arg_count;
+
+	const bool gen = (std::strncmp(name, "Gen", 3) == 0);
+	const bool create = (std::strncmp(name, "Create", 6) == 0);
+
+	// glGen*(n, names) / glCreate*([target,] n, names)
+	if((gen || create) && (n >= 2))
+	{
+		const GLCallArg& count = args[n-2];
+		const GLCallArg& names = args[n-1];
+		if(	(count.kind == GLCallArgKind::Integer) &&
+			(names.kind == GLCallArgKind::Pointer) &&
+			(names.pointee_size == sizeof(GLuint))
+		)
+		{
+			GLuint* out = static_cast<GLuint*>(names.value.p);
+			for(long long i=0; i<count.value.i; ++i)
+			{
+				out[i] = NextName();
+			}
+			return;
+		}
+	}
+	// glCreateProgram, glCreateShader, ...
+	if(create && (call.result.kind == GLCallArgKind::Integer))
+	{
+		call.result.value.i = NextName();
+		return;
+	}
+	if(std::strcmp(name, "FenceSync") == 0)
+	{
+		call.result.value.p = reinterpret_cast<void*>(
+			std::size_t(NextName())
+		);
+		return;
+	}
+	if(std::strcmp(name, "ClientWaitSync") == 0)
+	{
+		call.result.value.i = GL_ALREADY_SIGNALED;
+		return;
+	}
+	if(std::strcmp(name, "CheckFramebufferStatus") == 0)
+	{
+		call.result.value.i = GL_FRAMEBUFFER_COMPLETE;
+		return;
+	}
+	if(std::strncmp(name, "Get", 3) == 0)
+	{
+		// zero-initialize the (first element of) output parameters
+		for(std::size_t i=0; i!=n; ++i)
+		{
+			if(	(args[i].kind == GLCallArgKind::Pointer) &&
+				(args[i].pointee_size > 0) &&
+				(args[i].value.p != nullptr)
+			)
+			{
+				std::memset(
+					args[i].value.p,
+					0,
+					args[i].pointee_size
+				);
+			}
+		}
+		// the values of integer queries can be set by the user
+		if(	(n == 2) &&
+			(std::strcmp(name, "GetIntegerv") == 0) &&
+			(args[1].value.p != nullptr)
+		)
+		{
+			auto p = _integers.find(GLenum(args[0].value.i));
+			if(p != _integers.end())
+			{
+				*static_cast<GLint*>(args[1].value.p) = p->second;
+			}
+		}
+		// pretend that compilation, linking and validation succeeds
+		if(	(n == 3) && (
+			(std::strcmp(name, "GetShaderiv") == 0) ||
+			(std::strcmp(name, "GetProgramiv") == 0) ||
+			(std::strcmp(name, "GetProgramPipelineiv") == 0)
+		))
+		{
+			switch(GLenum(args[1].value.i))
+			{
+				case GL_COMPILE_STATUS:
+				case GL_LINK_STATUS:
+				case GL_VALIDATE_STATUS:
+					*static_cast<GLint*>(args[2].value.p) =
+						GL_TRUE;
+					break;
+				default:;
+			}
+		}
+	}
+}
+
+} // namespace oglplus
+
@@ -0,0 +1,334 @@
+/**
+ *  @file oglplus/error/deferred.ipp
+ *  @brief Implementation of the deferred GL error checks
+ *
+ *  @author Matus Chochlik
+ *
+ *  Copyright 2010-2015 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#include <cstring>
+#include <memory>
+
+namespace oglplus {
+
+OGLPLUS_LIB_FUNC
+const char* DeferredError::Message(GLenum code)
+{
+	return Error::Message(code);
+}
+
+namespace aux {
+
+// Per-thread handling of the errors detected at the end of a scope
+struct UnflushedErrorState
+{
+	UnflushedErrorHandler handler;
+	std::unique_ptr<DeferredError> error;
+
+	UnflushedErrorState(void)
+	 : handler(nullptr)
+	{ }
+
+	static UnflushedErrorState& Current(void);
+};
+
+OGLPLUS_LIB_FUNC
+UnflushedErrorState& UnflushedErrorState::Current(void)
+{
+#if !OGLPLUS_NO_THREAD_LOCAL
+	static thread_local UnflushedErrorState state;
+#else
+	static UnflushedErrorState state;
+#endif
+	return state;
+}
+
+// Queries the error of the calls checked since the previous check
+// and resets the state, returns nullptr if there is no error
+OGLPLUS_LIB_FUNC
+std::unique_ptr<DeferredError> FindDeferredError(ErrorCheckState& state)
+{
+	std::unique_ptr<DeferredError> result;
+	if(!state.HasDebugError() && (state.RecordedCount() == 0))
+	{
+		return result;
+	}
+	// this also clears the error flag set by the failed call
+	const GLenum code = OGLPLUS_GL_GET_ERROR();
+
+	std::vector<ErrorCallSite> sites;
+	if(state.HasDebugError() && state.DebugSite().gl_func)
+	{
+		// the call reported through the debug output
+		sites.push_back(state.DebugSite());
+		result.reset(new DeferredError(state.DebugMessage().c_str()));
+		(void)result->
+			GLFunc(sites.front().gl_func).
+			SourceFile(sites.front().file).
+			SourceFunc(sites.front().func).
+			SourceLine(sites.front().line);
+	}
+	else if(state.HasDebugError() || (code != GL_NO_ERROR))
+	{
+		// the failing call is one of the recorded ones (if any)
+		sites.reserve(state.SiteCount());
+		for(std::size_t i=0, n=state.SiteCount(); i!=n; ++i)
+		{
+			sites.push_back(state.Site(i));
+		}
+		result.reset(new DeferredError(
+			state.HasDebugError()?
+			state.DebugMessage().c_str():
+			DeferredError::Message(code)
+		));
+	}
+	if(result)
+	{
+		state.CountError();
+		(void)result->CallSites(sites, state.RecordedCount());
+		(void)result->Code(code);
+	}
+	state.Reset();
+	return result;
+}
+
+} // namespace aux
+
+OGLPLUS_LIB_FUNC
+void CheckDeferredErrors(void)
+{
+	aux::UnflushedErrorState& unflushed = aux::UnflushedErrorState::Current();
+	if(unflushed.error)
+	{
+		DeferredError error(*unflushed.error);
+		unflushed.error.reset();
+		HandleError(error);
+	}
+
+	std::unique_ptr<DeferredError> error =
+		aux::FindDeferredError(aux::ErrorCheckState::Current());
+	if(error)
+	{
+		HandleError(*error);
+	}
+}
+
+OGLPLUS_LIB_FUNC
+UnflushedErrorHandler SetUnflushedErrorHandler(UnflushedErrorHandler handler)
+{
+	aux::UnflushedErrorState& unflushed = aux::UnflushedErrorState::Current();
+	UnflushedErrorHandler prev = unflushed.handler;
+	unflushed.handler = handler;
+	return prev;
+}
+
+#if GL_VERSION_4_3 || GL_KHR_debug
+OGLPLUS_LIB_FUNC
+void GLAPIENTRY ErrorCheckScope::_gl_debug_proc(
+	GLenum source,
+	GLenum type,
+	GLuint id,
+	GLenum severity,
+	GLsizei length,
+	const GLchar* message,
+	GLvoid* user_param
+)
+{
+	ErrorCheckScope* self = static_cast<ErrorCheckScope*>(user_param);
+	assert(self);
+	if(type == GL_DEBUG_TYPE_ERROR)
+	{
+		aux::ErrorCheckState::Current().ReportDebugError(message);
+	}
+	if(self->_prev_callback)
+	{
+		self->_prev_callback(
+			source,
+			type,
+			id,
+			severity,
+			length,
+			message,
+			self->_prev_context
+		);
+	}
+}
+
+OGLPLUS_LIB_FUNC
+bool ErrorCheckScope::_has_debug_output(void)
+{
+	GLint major = 0, minor = 0;
+	OGLPLUS_GLFUNC(GetIntegerv)(GL_MAJOR_VERSION, &major);
+	OGLPLUS_GLFUNC(GetIntegerv)(GL_MINOR_VERSION, &minor);
+	// without a debug context the errors might not be reported
+	GLint flags = 0;
+	OGLPLUS_GLFUNC(GetIntegerv)(GL_CONTEXT_FLAGS, &flags);
+	if((flags & GL_CONTEXT_FLAG_DEBUG_BIT) == 0)
+	{
+		OGLPLUS_GL_GET_ERROR();
+		return false;
+	}
+	if((major > 4) || ((major == 4) && (minor >= 3)))
+	{
+		return true;
+	}
+	GLint count = 0;
+	OGLPLUS_GLFUNC(GetIntegerv)(GL_NUM_EXTENSIONS, &count);
+	for(GLint i=0; i<count; ++i)
+	{
+		const GLubyte* name =
+			OGLPLUS_GLFUNC(GetStringi)(GL_EXTENSIONS, GLuint(i));
+		if(name && std::strcmp(
+			reinterpret_cast<const char*>(name),
+			"GL_KHR_debug"
+		) == 0)
+		{
+			return true;
+		}
+	}
+	// the queries above are not checked, clear their possible errors
+	OGLPLUS_GL_GET_ERROR();
+	return false;
+}
+
+OGLPLUS_LIB_FUNC
+void ErrorCheckScope::_setup_debug_output(void)
+{
+	GLDEBUGPROC tmp_callback = nullptr;
+	OGLPLUS_GLFUNC(GetPointerv)(
+		GL_DEBUG_CALLBACK_FUNCTION,
+		reinterpret_cast<void**>(&tmp_callback)
+	);
+	OGLPLUS_VERIFY_SIMPLE(GetPointerv);
+	_prev_callback = tmp_callback;
+
+	OGLPLUS_GLFUNC(GetPointerv)(
+		GL_DEBUG_CALLBACK_USER_PARAM,
+		&_prev_context
+	);
+	OGLPLUS_VERIFY_SIMPLE(GetPointerv);
+
+	_prev_enabled = OGLPLUS_GLFUNC(IsEnabled)(GL_DEBUG_OUTPUT);
+	OGLPLUS_VERIFY_SIMPLE(IsEnabled);
+	_prev_sync = OGLPLUS_GLFUNC(IsEnabled)(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+	OGLPLUS_VERIFY_SIMPLE(IsEnabled);
+
+	OGLPLUS_GLFUNC(DebugMessageCallback)(
+		GLDEBUGPROC(&ErrorCheckScope::_gl_debug_proc),
+		static_cast<void*>(this)
+	);
+	OGLPLUS_VERIFY_SIMPLE(DebugMessageCallback);
+
+	// the callback must be called from within the failing function
+	OGLPLUS_GLFUNC(Enable)(GL_DEBUG_OUTPUT);
+	OGLPLUS_VERIFY_SIMPLE(Enable);
+	OGLPLUS_GLFUNC(Enable)(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+	OGLPLUS_VERIFY_SIMPLE(Enable);
+
+	_debug_output = true;
+}
+
+OGLPLUS_LIB_FUNC
+void ErrorCheckScope::_restore_debug_output(void)
+{
+	if(!_prev_sync)
+	{
+		OGLPLUS_GLFUNC(Disable)(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+	}
+	if(!_prev_enabled)
+	{
+		OGLPLUS_GLFUNC(Disable)(GL_DEBUG_OUTPUT);
+	}
+	OGLPLUS_GLFUNC(DebugMessageCallback)(
+		_prev_callback,
+		_prev_context
+	);
+	_debug_output = false;
+}
+#endif
+
+OGLPLUS_LIB_FUNC
+ErrorCheckScope::ErrorCheckScope(ErrorCheckPolicy policy)
+ : _prev_policy(ErrorCheckPolicy::Immediate)
+#if GL_VERSION_4_3 || GL_KHR_debug
+ , _debug_output(false)
+ , _prev_callback(nullptr)
+ , _prev_context(nullptr)
+ , _prev_enabled(GL_FALSE)
+ , _prev_sync(GL_FALSE)
+#endif
+ , _counted(false)
+{
+	aux::ErrorCheckState& state = aux::ErrorCheckState::Current();
+	_prev_policy = state.Policy();
+
+	if(policy == ErrorCheckPolicy::DebugOutput)
+	{
+#if GL_VERSION_4_3 || GL_KHR_debug
+		if(_has_debug_output())
+		{
+			_setup_debug_output();
+		}
+		else policy = ErrorCheckPolicy::Deferred;
+#else
+		policy = ErrorCheckPolicy::Deferred;
+#endif
+	}
+	if(_prev_policy == ErrorCheckPolicy::Immediate)
+	{
+		state.Reset();
+	}
+	state.Policy(policy);
+	if(policy != ErrorCheckPolicy::Immediate)
+	{
+		aux::ErrorCheckScopeCounter<void>::count.fetch_add(1u);
+		_counted = true;
+	}
+}
+
+OGLPLUS_LIB_FUNC
+ErrorCheckScope::~ErrorCheckScope(void) OGLPLUS_NOEXCEPT(true)
+{
+	aux::ErrorCheckState& state = aux::ErrorCheckState::Current();
+	// the errors of a nested scope are checked by the enclosing one,
+	// otherwise they must not be left for the next immediate check
+	if(_prev_policy == ErrorCheckPolicy::Immediate)
+	{
+		try
+		{
+			std::unique_ptr<DeferredError> error =
+				aux::FindDeferredError(state);
+			if(error)
+			{
+				aux::UnflushedErrorState& unflushed =
+					aux::UnflushedErrorState::Current();
+				if(unflushed.handler)
+				{
+					unflushed.handler(*error);
+				}
+				else if(!unflushed.error)
+				{
+					unflushed.error = std::move(error);
+				}
+			}
+		}
+		catch(...) { }
+	}
+#if GL_VERSION_4_3 || GL_KHR_debug
+	if(_debug_output)
+	{
+		_restore_debug_output();
+	}
+#endif
+	state.Policy(_prev_policy);
+	if(_counted)
+	{
+		aux::ErrorCheckScopeCounter<void>::count.fetch_sub(1u);
+	}
+}
+
+} // namespace oglplus
+
@@ -0,0 +1,70 @@
+/**
+ *  @file oglplus/error/policy.ipp
+ *  @brief Implementation of the GL error check policy state
+ *
+ *  @author Matus Chochlik
+ *
+ *  Copyright 2010-2015 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+namespace oglplus {
+namespace aux {
+
+OGLPLUS_LIB_FUNC
+ErrorCheckState::ErrorCheckState(void)
+ : _recorded(0)
+ , _policy(ErrorCheckPolicy::Immediate)
+ , _error_count(0)
+ , _debug_error(false)
+ , _debug_site_pending(false)
+{
+	_debug_site.gl_func = nullptr;
+	_debug_site.file = nullptr;
+	_debug_site.func = nullptr;
+	_debug_site.line = 0;
+}
+
+OGLPLUS_LIB_FUNC
+ErrorCheckState& ErrorCheckState::Current(void)
+{
+#if !OGLPLUS_NO_THREAD_LOCAL
+	static thread_local ErrorCheckState state;
+#else
+	static ErrorCheckState state;
+#endif
+	return state;
+}
+
+OGLPLUS_LIB_FUNC
+void ErrorCheckState::ReportDebugError(const char* message)
+{
+	// only the first error is kept, just like with glGetError
+	if(!_debug_error)
+	{
+		_debug_error = true;
+		_debug_message = message?message:"";
+		// with synchronous debug output the callback is invoked
+		// from within the failing GL function, before its check
+		// records the call site
+		_debug_site_pending = true;
+	}
+}
+
+OGLPLUS_LIB_FUNC
+void ErrorCheckState::Reset(void)
+{
+	_recorded = 0;
+	_debug_message.clear();
+	_debug_site.gl_func = nullptr;
+	_debug_site.file = nullptr;
+	_debug_site.func = nullptr;
+	_debug_site.line = 0;
+	_debug_error = false;
+	_debug_site_pending = false;
+}
+
+} // namespace aux
+} // namespace oglplus
+
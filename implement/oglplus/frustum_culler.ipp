@@ -0,0 +1,325 @@
+/**
+ *  @file oglplus/frustum_culler.ipp
+ *  @brief Implementation of the frustum culler
+ *
+ *  @author Matus Chochlik
+ *
+ *  Copyright 2010-2015 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#include <oglplus/config/simd.hpp>
+#include <oglplus/detail/parallel_for.hpp>
+#include <algorithm>
+#include <cassert>
+#if OGLPLUS_USE_AVX
+#include <immintrin.h>
+#elif OGLPLUS_USE_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace oglplus {
+
+OGLPLUS_LIB_FUNC
+void FrustumCuller::_init(const Frustum<GLfloat>& frustum)
+{
+	for(std::size_t p=0; p!=6; ++p)
+	{
+		for(std::size_t c=0; c!=4; ++c)
+		{
+			_planes[p][c] = frustum.Equation(p)[c];
+		}
+	}
+}
+
+OGLPLUS_LIB_FUNC
+void FrustumCuller::_cull_words(
+	const SphereArray& spheres,
+	std::size_t first_word,
+	std::size_t last_word,
+	std::uint32_t* mask
+) const
+{
+	const std::size_t n = spheres.Size();
+	const GLfloat* xs = spheres.X();
+	const GLfloat* ys = spheres.Y();
+	const GLfloat* zs = spheres.Z();
+	const GLfloat* rs = spheres.Radius();
+
+	for(std::size_t w=first_word; w!=last_word; ++w)
+	{
+		const std::size_t base = w*32;
+		assert(base < n);
+		std::uint32_t bits = 0;
+
+		if(n-base >= 32)
+		{
+#if OGLPLUS_USE_AVX
+			for(std::size_t k=0; k!=32; k+=8)
+			{
+				const __m256 x = _mm256_loadu_ps(xs+base+k);
+				const __m256 y = _mm256_loadu_ps(ys+base+k);
+				const __m256 z = _mm256_loadu_ps(zs+base+k);
+				const __m256 nr = _mm256_sub_ps(
+					_mm256_setzero_ps(),
+					_mm256_loadu_ps(rs+base+k)
+				);
+				__m256 vis = _mm256_castsi256_ps(
+					_mm256_set1_epi32(-1)
+				);
+				for(std::size_t p=0; p!=6; ++p)
+				{
+					__m256 d = _mm256_add_ps(
+						_mm256_mul_ps(
+							_mm256_set1_ps(_planes[p][0]),
+							x
+						),
+						_mm256_mul_ps(
+							_mm256_set1_ps(_planes[p][1]),
+							y
+						)
+					);
+					d = _mm256_add_ps(d, _mm256_mul_ps(
+						_mm256_set1_ps(_planes[p][2]),
+						z
+					));
+					d = _mm256_add_ps(
+						d,
+						_mm256_set1_ps(_planes[p][3])
+					);
+					vis = _mm256_and_ps(
+						vis,
+						_mm256_cmp_ps(d, nr, _CMP_GE_OQ)
+					);
+				}
+				bits |= std::uint32_t(_mm256_movemask_ps(vis)) << k;
+			}
+#elif OGLPLUS_USE_SSE2
+			for(std::size_t k=0; k!=32; k+=4)
+			{
+				const __m128 x = _mm_loadu_ps(xs+base+k);
+				const __m128 y = _mm_loadu_ps(ys+base+k);
+				const __m128 z = _mm_loadu_ps(zs+base+k);
+				const __m128 nr = _mm_sub_ps(
+					_mm_setzero_ps(),
+					_mm_loadu_ps(rs+base+k)
+				);
+				__m128 vis = _mm_castsi128_ps(_mm_set1_epi32(-1));
+				for(std::size_t p=0; p!=6; ++p)
+				{
+					__m128 d = _mm_add_ps(
+						_mm_mul_ps(_mm_set1_ps(_planes[p][0]), x),
+						_mm_mul_ps(_mm_set1_ps(_planes[p][1]), y)
+					);
+					d = _mm_add_ps(
+						d,
+						_mm_mul_ps(_mm_set1_ps(_planes[p][2]), z)
+					);
+					d = _mm_add_ps(d, _mm_set1_ps(_planes[p][3]));
+					vis = _mm_and_ps(vis, _mm_cmpge_ps(d, nr));
+				}
+				bits |= std::uint32_t(_mm_movemask_ps(vis)) << k;
+			}
+#else
+			for(std::size_t k=0; k!=32; ++k)
+			{
+				const std::size_t i = base+k;
+				bool vis = true;
+				for(std::size_t p=0; p!=6; ++p)
+				{
+					GLfloat d =
+						_planes[p][0]*xs[i]+
+						_planes[p][1]*ys[i]+
+						_planes[p][2]*zs[i]+
+						_planes[p][3];
+					vis &= (d >= -rs[i]);
+				}
+				bits |= std::uint32_t(vis?1:0) << k;
+			}
+#endif
+		}
+		else
+		{
+			// the last partial word
+			for(std::size_t k=0, e=n-base; k!=e; ++k)
+			{
+				const std::size_t i = base+k;
+				bool vis = true;
+				for(std::size_t p=0; p!=6; ++p)
+				{
+					GLfloat d =
+						_planes[p][0]*xs[i]+
+						_planes[p][1]*ys[i]+
+						_planes[p][2]*zs[i]+
+						_planes[p][3];
+					vis &= (d >= -rs[i]);
+				}
+				bits |= std::uint32_t(vis?1:0) << k;
+			}
+		}
+		mask[w] = bits;
+	}
+}
+
+OGLPLUS_LIB_FUNC
+std::size_t FrustumCuller::_count_bits(
+	const std::uint32_t* mask,
+	std::size_t first_word,
+	std::size_t last_word
+)
+{
+	std::size_t result = 0;
+	for(std::size_t w=first_word; w!=last_word; ++w)
+	{
+#if defined(__GNUC__) || defined(__clang__)
+		result += std::size_t(__builtin_popcount(mask[w]));
+#else
+		std::uint32_t bits = mask[w];
+		bits = bits - ((bits >> 1) & 0x55555555u);
+		bits = (bits & 0x33333333u) + ((bits >> 2) & 0x33333333u);
+		bits = (bits + (bits >> 4)) & 0x0F0F0F0Fu;
+		result += std::size_t((bits * 0x01010101u) >> 24);
+#endif
+	}
+	return result;
+}
+
+OGLPLUS_LIB_FUNC
+void FrustumCuller::_write_indices(
+	const std::uint32_t* mask,
+	std::size_t first_word,
+	std::size_t last_word,
+	GLuint* indices
+)
+{
+	for(std::size_t w=first_word; w!=last_word; ++w)
+	{
+		std::uint32_t bits = mask[w];
+		while(bits)
+		{
+#if defined(__GNUC__) || defined(__clang__)
+			unsigned k = unsigned(__builtin_ctz(bits));
+#else
+			unsigned k = 0;
+			while(((bits >> k) & 1u) == 0u) ++k;
+#endif
+			*indices++ = GLuint(w*32+k);
+			bits &= bits-1;
+		}
+	}
+}
+
+OGLPLUS_LIB_FUNC
+unsigned FrustumCuller::_thread_count(std::size_t words, unsigned threads)
+{
+	threads = aux::ParallelThreads(threads);
+	std::size_t max_threads = std::max<std::size_t>(
+		(words*32)/MinSpheresPerThread,
+		1
+	);
+	return unsigned(std::min<std::size_t>(threads, max_threads));
+}
+
+OGLPLUS_LIB_FUNC
+void FrustumCuller::_parallel(
+	unsigned threads,
+	std::size_t words,
+	const std::function<void (std::size_t, std::size_t, unsigned)>& func
+)
+{
+	assert(threads > 0);
+	// each of the ranges is processed by one thread and
+	// the thread index is passed to func along with the range
+	aux::ParallelFor(
+		threads,
+		words*32,
+		threads,
+		[&func, threads, words](std::size_t begin, std::size_t end)
+		{
+			for(std::size_t t=begin; t!=end; ++t)
+			{
+				func(
+					(words*t)/threads,
+					(words*(t+1))/threads,
+					unsigned(t)
+				);
+			}
+		}
+	);
+}
+
+OGLPLUS_LIB_FUNC
+std::size_t FrustumCuller::CountVisible(const std::vector<std::uint32_t>& mask)
+{
+	return _count_bits(mask.data(), 0, mask.size());
+}
+
+OGLPLUS_LIB_FUNC
+void FrustumCuller::CullToMask(
+	const SphereArray& spheres,
+	std::vector<std::uint32_t>& mask,
+	unsigned threads
+) const
+{
+	const std::size_t words = MaskSize(spheres.Size());
+	mask.resize(words);
+
+	std::uint32_t* out = mask.data();
+	_parallel(
+		_thread_count(words, threads),
+		words,
+		[this, &spheres, out](std::size_t b, std::size_t e, unsigned)
+		{
+			_cull_words(spheres, b, e, out);
+		}
+	);
+}
+
+OGLPLUS_LIB_FUNC
+std::size_t FrustumCuller::CullToIndices(
+	const SphereArray& spheres,
+	std::vector<GLuint>& indices,
+	unsigned threads
+) const
+{
+	const std::size_t words = MaskSize(spheres.Size());
+	const unsigned thread_count = _thread_count(words, threads);
+
+	// the threads first build the mask of their range of spheres
+	// and count the visible ones, then after the offsets of the ranges
+	// in the index list are known, they write the indices in parallel
+	std::vector<std::uint32_t> mask(words);
+	std::vector<std::size_t> offsets(thread_count+1, 0);
+
+	std::uint32_t* m = mask.data();
+	std::size_t* o = offsets.data();
+	_parallel(
+		thread_count,
+		words,
+		[this, &spheres, m, o](std::size_t b, std::size_t e, unsigned t)
+		{
+			_cull_words(spheres, b, e, m);
+			o[t+1] = _count_bits(m, b, e);
+		}
+	);
+	for(unsigned t=0; t!=thread_count; ++t)
+	{
+		offsets[t+1] += offsets[t];
+	}
+
+	indices.resize(offsets.back());
+
+	GLuint* out = indices.data();
+	_parallel(
+		thread_count,
+		words,
+		[m, o, out](std::size_t b, std::size_t e, unsigned t)
+		{
+			_write_indices(m, b, e, out+o[t]);
+		}
+	);
+	return indices.size();
+}
+
+} // namespace oglplus
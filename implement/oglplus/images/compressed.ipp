@@ -0,0 +1,1247 @@
+/**
+ *  @file oglplus/images/compressed.ipp
+ *  @brief Implementation of images::CompressedImage
+ *
+ *  @author Matus Chochlik
+ *
+ *  Copyright 2010-2015 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#include <oglplus/detail/parallel_for.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+namespace oglplus {
+namespace aux {
+
+// The 16 texels of a 4x4 block, one contiguous array per channel
+struct BlockTexels
+{
+	float v[4][16];
+};
+
+// Reads the texels of the source image into 4x4 blocks
+class BlockSource
+{
+private:
+	const images::Image& _image;
+	const GLubyte* _ubyte;
+	GLsizei _channels;
+	int _map[4];
+	float _lo, _hi;
+public:
+	BlockSource(
+		const images::Image& image,
+		images::BlockFormat format,
+		bool is_signed
+	): _image(image)
+	 , _ubyte(nullptr)
+	 , _channels(image.Channels())
+	 , _lo(is_signed?-127.0f:0.0f)
+	 , _hi(is_signed?127.0f:255.0f)
+	{
+		// negative values: -1 is zero, -2 is one
+		const int color[4][4] = {
+			{ 0,  0,  0, -2},
+			{ 0,  1, -1, -2},
+			{ 0,  1,  2, -2},
+			{ 0,  1,  2,  3}
+		};
+		const std::size_t ch = std::size_t(std::min(_channels, 4)-1);
+		for(std::size_t c=0; c!=4; ++c)
+		{
+			if(format == images::BlockFormat::BC4)
+			{
+				_map[c] = (c == 0)?0:-1;
+			}
+			else if(format == images::BlockFormat::BC5)
+			{
+				_map[c] = (int(c) < std::min(_channels, 2))?int(c):-1;
+			}
+			else _map[c] = color[ch][c];
+		}
+		if(!is_signed && (image.Type() == PixelDataType::UnsignedByte))
+		{
+			_ubyte = image.Data<GLubyte>();
+		}
+	}
+
+	void Gather(GLsizei bx, GLsizei by, GLsizei z, BlockTexels& t) const
+	{
+		const GLsizei w = _image.Width(), h = _image.Height();
+		for(GLsizei i=0; i!=16; ++i)
+		{
+			// clamp to edge for partial blocks
+			const GLsizei x = std::min(bx*4+i%4, w-1);
+			const GLsizei y = std::min(by*4+i/4, h-1);
+			const std::size_t pos = std::size_t((z*h+y)*w+x)*_channels;
+			for(std::size_t c=0; c!=4; ++c)
+			{
+				float v;
+				if(_map[c] == -1) v = 0.0f;
+				else if(_map[c] == -2) v = _hi;
+				else if(_ubyte) v = _ubyte[pos+_map[c]];
+				else
+				{
+					v = float(_image.Component(x, y, z, _map[c]))*_hi;
+					v = std::min(std::max(v, _lo), _hi);
+				}
+				t.v[c][i] = v;
+			}
+		}
+	}
+};
+
+// Writes bit fields into the 128-bit BC7 blocks
+class BlockBitWriter
+{
+private:
+	GLubyte* _data;
+	unsigned _pos;
+public:
+	BlockBitWriter(GLubyte* data)
+	 : _data(data)
+	 , _pos(0)
+	{ }
+
+	void Put(unsigned value, unsigned bits)
+	{
+		for(unsigned b=0; b!=bits; ++b, ++_pos)
+		{
+			if((value >> b) & 1u)
+			{
+				_data[_pos >> 3] |= GLubyte(1u << (_pos & 7u));
+			}
+		}
+	}
+};
+
+// Reads bit fields from the 128-bit BC7 blocks
+class BlockBitReader
+{
+private:
+	const GLubyte* _data;
+	unsigned _pos;
+public:
+	BlockBitReader(const GLubyte* data)
+	 : _data(data)
+	 , _pos(0)
+	{ }
+
+	unsigned Get(unsigned bits)
+	{
+		unsigned value = 0;
+		for(unsigned b=0; b!=bits; ++b, ++_pos)
+		{
+			value |= ((_data[_pos >> 3] >> (_pos & 7u)) & 1u) << b;
+		}
+		return value;
+	}
+};
+
+// Endpoints at the corners of the bounding box of the texels in mask
+// oriented along the channel with the largest extent
+template <std::size_t N>
+inline void BlockBoundsEndpoints(
+	const BlockTexels& t,
+	unsigned mask,
+	float* e0,
+	float* e1
+)
+{
+	float lo[N], hi[N], mean[N];
+	float count = 0.0f;
+	for(std::size_t c=0; c!=N; ++c)
+	{
+		lo[c] = 255.0f;
+		hi[c] = -255.0f;
+		mean[c] = 0.0f;
+	}
+	for(std::size_t i=0; i!=16; ++i)
+	{
+		if(!((mask >> i) & 1u)) continue;
+		for(std::size_t c=0; c!=N; ++c)
+		{
+			lo[c] = std::min(lo[c], t.v[c][i]);
+			hi[c] = std::max(hi[c], t.v[c][i]);
+			mean[c] += t.v[c][i];
+		}
+		count += 1.0f;
+	}
+	std::size_t major = 0;
+	for(std::size_t c=0; c!=N; ++c)
+	{
+		mean[c] /= count;
+		if(hi[c]-lo[c] > hi[major]-lo[major]) major = c;
+	}
+	for(std::size_t c=0; c!=N; ++c)
+	{
+		// flip the channels decreasing with the major one
+		float cov = 0.0f;
+		for(std::size_t i=0; i!=16; ++i)
+		{
+			if(!((mask >> i) & 1u)) continue;
+			cov +=	(t.v[c][i]-mean[c])*
+				(t.v[major][i]-mean[major]);
+		}
+		const float inset = (hi[c]-lo[c])/16.0f;
+		e0[c] = (cov < 0.0f)?lo[c]+inset:hi[c]-inset;
+		e1[c] = (cov < 0.0f)?hi[c]-inset:lo[c]+inset;
+	}
+}
+
+// Endpoints at the extremes of the texels in mask projected
+// on their principal axis
+template <std::size_t N>
+inline void BlockAxisEndpoints(
+	const BlockTexels& t,
+	unsigned mask,
+	float* e0,
+	float* e1
+)
+{
+	float mean[N], cov[N][N], axis[N];
+	float count = 0.0f;
+	for(std::size_t c=0; c!=N; ++c)
+	{
+		mean[c] = 0.0f;
+		for(std::size_t i=0; i!=16; ++i)
+		{
+			if((mask >> i) & 1u) mean[c] += t.v[c][i];
+		}
+	}
+	for(std::size_t i=0; i!=16; ++i)
+	{
+		if((mask >> i) & 1u) count += 1.0f;
+	}
+	for(std::size_t c=0; c!=N; ++c)
+	{
+		mean[c] /= count;
+	}
+	for(std::size_t a=0; a!=N; ++a)
+	for(std::size_t b=0; b!=N; ++b)
+	{
+		cov[a][b] = 0.0f;
+		for(std::size_t i=0; i!=16; ++i)
+		{
+			if(!((mask >> i) & 1u)) continue;
+			cov[a][b] += (t.v[a][i]-mean[a])*(t.v[b][i]-mean[b]);
+		}
+	}
+	// power iteration starting from the bounding box diagonal
+	BlockBoundsEndpoints<N>(t, mask, e0, e1);
+	for(std::size_t c=0; c!=N; ++c)
+	{
+		axis[c] = e0[c]-e1[c];
+	}
+	for(unsigned iter=0; iter!=8; ++iter)
+	{
+		float next[N], len = 0.0f;
+		for(std::size_t a=0; a!=N; ++a)
+		{
+			next[a] = 0.0f;
+			for(std::size_t b=0; b!=N; ++b)
+			{
+				next[a] += cov[a][b]*axis[b];
+			}
+			len = std::max(len, std::fabs(next[a]));
+		}
+		// all the texels are the same (or on the bounds diagonal)
+		if(len < 1e-6f) break;
+		for(std::size_t c=0; c!=N; ++c)
+		{
+			axis[c] = next[c]/len;
+		}
+	}
+	float len2 = 0.0f;
+	for(std::size_t c=0; c!=N; ++c)
+	{
+		len2 += axis[c]*axis[c];
+	}
+	if(len2 < 1e-12f)
+	{
+		for(std::size_t c=0; c!=N; ++c)
+		{
+			e0[c] = e1[c] = mean[c];
+		}
+		return;
+	}
+	float pmin = 1e30f, pmax = -1e30f;
+	for(std::size_t i=0; i!=16; ++i)
+	{
+		if(!((mask >> i) & 1u)) continue;
+		float p = 0.0f;
+		for(std::size_t c=0; c!=N; ++c)
+		{
+			p += (t.v[c][i]-mean[c])*axis[c];
+		}
+		pmin = std::min(pmin, p);
+		pmax = std::max(pmax, p);
+	}
+	for(std::size_t c=0; c!=N; ++c)
+	{
+		e0[c] = std::min(std::max(mean[c]+axis[c]*pmax/len2, 0.0f), 255.0f);
+		e1[c] = std::min(std::max(mean[c]+axis[c]*pmin/len2, 0.0f), 255.0f);
+	}
+}
+
+// Least-squares endpoints for the given texel indices and
+// the weights (of the second endpoint) of the indices
+template <std::size_t N>
+inline bool BlockLeastSquares(
+	const BlockTexels& t,
+	unsigned mask,
+	const GLubyte* idx,
+	const float* weight,
+	float* e0,
+	float* e1
+)
+{
+	float aa = 0.0f, ab = 0.0f, bb = 0.0f;
+	float ax[N], bx[N];
+	for(std::size_t c=0; c!=N; ++c)
+	{
+		ax[c] = bx[c] = 0.0f;
+	}
+	for(std::size_t i=0; i!=16; ++i)
+	{
+		if(!((mask >> i) & 1u)) continue;
+		const float b = weight[idx[i]];
+		const float a = 1.0f-b;
+		aa += a*a;
+		ab += a*b;
+		bb += b*b;
+		for(std::size_t c=0; c!=N; ++c)
+		{
+			ax[c] += a*t.v[c][i];
+			bx[c] += b*t.v[c][i];
+		}
+	}
+	const float det = aa*bb-ab*ab;
+	if(std::fabs(det) < 1e-6f) return false;
+	for(std::size_t c=0; c!=N; ++c)
+	{
+		e0[c] = (bb*ax[c]-ab*bx[c])/det;
+		e1[c] = (aa*bx[c]-ab*ax[c])/det;
+		e0[c] = std::min(std::max(e0[c], 0.0f), 255.0f);
+		e1[c] = std::min(std::max(e1[c], 0.0f), 255.0f);
+	}
+	return true;
+}
+
+inline GLushort BC1Quantize(const float* e)
+{
+	const unsigned r = unsigned(e[0]*31.0f/255.0f+0.5f);
+	const unsigned g = unsigned(e[1]*63.0f/255.0f+0.5f);
+	const unsigned b = unsigned(e[2]*31.0f/255.0f+0.5f);
+	return GLushort((r << 11) | (g << 5) | b);
+}
+
+inline void BC1Expand(GLushort c, int* rgb)
+{
+	const int r = (c >> 11) & 0x1F, g = (c >> 5) & 0x3F, b = c & 0x1F;
+	rgb[0] = (r << 3) | (r >> 2);
+	rgb[1] = (g << 2) | (g >> 4);
+	rgb[2] = (b << 3) | (b >> 2);
+}
+
+// The colors of a BC1 block, the fourth color of the three color
+// mode is transparent black
+inline void BC1Palette(GLushort c0, GLushort c1, bool three, int (*p)[3])
+{
+	BC1Expand(c0, p[0]);
+	BC1Expand(c1, p[1]);
+	for(std::size_t c=0; c!=3; ++c)
+	{
+		if(three)
+		{
+			p[2][c] = (p[0][c]+p[1][c])/2;
+			p[3][c] = 0;
+		}
+		else
+		{
+			p[2][c] = (2*p[0][c]+p[1][c])/3;
+			p[3][c] = (p[0][c]+2*p[1][c])/3;
+		}
+	}
+}
+
+// Finds the nearest colors, returns the squared error
+inline float BC1Fit(
+	const BlockTexels& t,
+	unsigned mask,
+	GLushort c0,
+	GLushort c1,
+	bool three,
+	GLubyte* idx
+)
+{
+	int p[4][3];
+	BC1Palette(c0, c1, three, p);
+	const std::size_t n = three?3:4;
+	float error = 0.0f;
+	for(std::size_t i=0; i!=16; ++i)
+	{
+		if(!((mask >> i) & 1u)) continue;
+		float best = 1e30f;
+		for(std::size_t k=0; k!=n; ++k)
+		{
+			const float dr = t.v[0][i]-float(p[k][0]);
+			const float dg = t.v[1][i]-float(p[k][1]);
+			const float db = t.v[2][i]-float(p[k][2]);
+			const float d = dr*dr+dg*dg+db*db;
+			if(best > d)
+			{
+				best = d;
+				idx[i] = GLubyte(k);
+			}
+		}
+		error += best;
+	}
+	return error;
+}
+
+// Encodes the color part of BC1 and BC3 blocks, the color part
+// of BC3 blocks always uses the four color mode
+inline void BC1EncodeBlock(
+	const BlockTexels& t,
+	bool four_colors,
+	bool punch_through,
+	images::BlockQuality quality,
+	GLubyte* out
+)
+{
+	unsigned mask = 0xFFFFu;
+	if(punch_through)
+	{
+		for(std::size_t i=0; i!=16; ++i)
+		{
+			if(t.v[3][i] < 127.5f) mask &= ~(1u << i);
+		}
+	}
+	// the transparent texels need the three color mode
+	bool three = (mask != 0xFFFFu);
+	GLushort c0 = 0, c1 = 0;
+	GLubyte idx[16] = { 0 };
+
+	if(mask != 0)
+	{
+		float e0[3], e1[3];
+		if(quality == images::BlockQuality::Fast)
+		{
+			BlockBoundsEndpoints<3>(t, mask, e0, e1);
+		}
+		else BlockAxisEndpoints<3>(t, mask, e0, e1);
+
+		const float weights[2][4] = {
+			{0.0f, 1.0f, 1.0f/3.0f, 2.0f/3.0f},
+			{0.0f, 1.0f, 0.5f, 0.0f}
+		};
+		unsigned iterations = 0;
+		if(quality == images::BlockQuality::Normal) iterations = 1;
+		if(quality == images::BlockQuality::High) iterations = 4;
+
+		// the three color mode is tried for opaque blocks only
+		// with the highest quality
+		const bool try_three = three || (!four_colors &&
+			(quality == images::BlockQuality::High));
+
+		float best = 1e30f;
+		for(unsigned mode=three?1:0; mode!=(try_three?2:1); ++mode)
+		{
+			GLubyte tidx[16] = { 0 };
+			GLushort t0 = BC1Quantize(e0), t1 = BC1Quantize(e1);
+			float error = BC1Fit(t, mask, t0, t1, mode == 1, tidx);
+			for(unsigned iter=0; iter!=iterations; ++iter)
+			{
+				float r0[3], r1[3];
+				if(!BlockLeastSquares<3>(
+					t, mask, tidx, weights[mode], r0, r1
+				)) break;
+				const GLushort n0 = BC1Quantize(r0);
+				const GLushort n1 = BC1Quantize(r1);
+				if((n0 == t0) && (n1 == t1)) break;
+				GLubyte nidx[16] = { 0 };
+				const float e = BC1Fit(t, mask, n0, n1, mode == 1, nidx);
+				if(e >= error) break;
+				error = e;
+				t0 = n0;
+				t1 = n1;
+				std::memcpy(tidx, nidx, 16);
+			}
+			if(best > error)
+			{
+				best = error;
+				three = (mode == 1);
+				c0 = t0;
+				c1 = t1;
+				std::memcpy(idx, tidx, 16);
+			}
+		}
+	}
+	// the order of the endpoints selects the mode
+	if(three ? (c0 > c1) : (c0 < c1))
+	{
+		std::swap(c0, c1);
+		for(std::size_t i=0; i!=16; ++i)
+		{
+			if(idx[i] < 2) idx[i] ^= 1;
+			else if(!three) idx[i] ^= 1;
+		}
+	}
+	else if(!three && (c0 == c1))
+	{
+		std::memset(idx, 0, 16);
+	}
+	out[0] = GLubyte(c0 & 0xFF);
+	out[1] = GLubyte(c0 >> 8);
+	out[2] = GLubyte(c1 & 0xFF);
+	out[3] = GLubyte(c1 >> 8);
+	for(std::size_t i=0; i!=16; ++i)
+	{
+		const unsigned k = ((mask >> i) & 1u)?idx[i]:3u;
+		out[4+i/4] |= GLubyte(k << (2*(i%4)));
+	}
+}
+
+inline void BC1DecodeBlock(const GLubyte* in, bool four_colors, GLubyte* rgba)
+{
+	const GLushort c0 = GLushort(in[0] | (in[1] << 8));
+	const GLushort c1 = GLushort(in[2] | (in[3] << 8));
+	const bool three = !four_colors && (c0 <= c1);
+	int p[4][3];
+	BC1Palette(c0, c1, three, p);
+	for(std::size_t i=0; i!=16; ++i)
+	{
+		const unsigned k = (in[4+i/4] >> (2*(i%4))) & 3u;
+		for(std::size_t c=0; c!=3; ++c)
+		{
+			rgba[i*4+c] = GLubyte(p[k][c]);
+		}
+		rgba[i*4+3] = (three && (k == 3))?0x00:0xFF;
+	}
+}
+
+// The values of a BC4 block
+inline void BC4Palette(int a0, int a1, bool is_signed, int* p)
+{
+	p[0] = a0;
+	p[1] = a1;
+	if(a0 > a1)
+	{
+		for(int k=2; k!=8; ++k)
+		{
+			p[k] = ((8-k)*a0+(k-1)*a1)/7;
+		}
+	}
+	else
+	{
+		for(int k=2; k!=6; ++k)
+		{
+			p[k] = ((6-k)*a0+(k-1)*a1)/5;
+		}
+		p[6] = is_signed?-127:0;
+		p[7] = is_signed?127:255;
+	}
+}
+
+// Finds the nearest values, returns the squared error
+inline float BC4Fit(
+	const float* v,
+	int a0,
+	int a1,
+	bool is_signed,
+	GLubyte* idx
+)
+{
+	int p[8];
+	BC4Palette(a0, a1, is_signed, p);
+	// the values of the eight value mode ordered from a0 to a1
+	static const GLubyte order[8] = {0, 2, 3, 4, 5, 6, 7, 1};
+	const float scale = (a0 > a1)?7.0f/float(a0-a1):0.0f;
+	float error = 0.0f;
+	for(std::size_t i=0; i!=16; ++i)
+	{
+		float best = 1e30f;
+		if(a0 > a1)
+		{
+			// only the neighbours of the projected position
+			int s = int(std::floor((float(a0)-v[i])*scale+0.5f));
+			s = std::min(std::max(s, 0), 7);
+			for(int j=std::max(s-1, 0); j<=std::min(s+1, 7); ++j)
+			{
+				const float d = v[i]-float(p[order[j]]);
+				if(best > d*d)
+				{
+					best = d*d;
+					idx[i] = order[j];
+				}
+			}
+		}
+		else
+		{
+			for(std::size_t k=0; k!=8; ++k)
+			{
+				const float d = v[i]-float(p[k]);
+				if(best > d*d)
+				{
+					best = d*d;
+					idx[i] = GLubyte(k);
+				}
+			}
+		}
+		error += best;
+	}
+	return error;
+}
+
+// Encodes BC4 blocks and the alpha part of BC3 blocks
+inline void BC4EncodeBlock(
+	const float* v,
+	bool is_signed,
+	images::BlockQuality quality,
+	GLubyte* out
+)
+{
+	const float lo = is_signed?-127.0f:0.0f, hi = is_signed?127.0f:255.0f;
+	float vmin = hi, vmax = lo;
+	// the range without the values representable by the six value mode
+	float imin = hi, imax = lo;
+	for(std::size_t i=0; i!=16; ++i)
+	{
+		vmin = std::min(vmin, v[i]);
+		vmax = std::max(vmax, v[i]);
+		if((v[i] > lo) && (v[i] < hi))
+		{
+			imin = std::min(imin, v[i]);
+			imax = std::max(imax, v[i]);
+		}
+	}
+	int a0 = int(std::floor(vmax+0.5f)), a1 = int(std::floor(vmin+0.5f));
+	GLubyte idx[16] = { 0 };
+	float best = BC4Fit(v, a0, a1, is_signed, idx);
+
+	if((quality != images::BlockQuality::Fast) && (imin <= imax))
+	{
+		const int b0 = int(std::floor(imin+0.5f));
+		const int b1 = int(std::floor(imax+0.5f));
+		GLubyte tidx[16];
+		const float error = BC4Fit(v, b0, b1, is_signed, tidx);
+		if(best > error)
+		{
+			best = error;
+			a0 = b0;
+			a1 = b1;
+			std::memcpy(idx, tidx, 16);
+		}
+	}
+	if(quality == images::BlockQuality::High)
+	{
+		const int m0 = int(std::floor(vmax+0.5f));
+		const int m1 = int(std::floor(vmin+0.5f));
+		for(int d0=0; d0!=4; ++d0)
+		for(int d1=0; d1!=4; ++d1)
+		{
+			if(m0-d0 <= m1+d1) continue;
+			GLubyte tidx[16];
+			const float error = BC4Fit(v, m0-d0, m1+d1, is_signed, tidx);
+			if(best > error)
+			{
+				best = error;
+				a0 = m0-d0;
+				a1 = m1+d1;
+				std::memcpy(idx, tidx, 16);
+			}
+		}
+	}
+	out[0] = GLubyte(a0 & 0xFF);
+	out[1] = GLubyte(a1 & 0xFF);
+	for(std::size_t i=0; i!=16; ++i)
+	{
+		const unsigned bit = 16+3*unsigned(i);
+		out[bit/8] |= GLubyte(idx[i] << (bit%8));
+		if(bit%8 > 5)
+		{
+			out[bit/8+1] |= GLubyte(idx[i] >> (8-bit%8));
+		}
+	}
+}
+
+inline void BC4DecodeBlock(
+	const GLubyte* in,
+	bool is_signed,
+	GLubyte* out,
+	std::size_t stride
+)
+{
+	int p[8];
+	if(is_signed)
+	{
+		// -128 is treated as -127
+		BC4Palette(
+			std::max(int(GLbyte(in[0])), -127),
+			std::max(int(GLbyte(in[1])), -127),
+			true, p
+		);
+	}
+	else BC4Palette(in[0], in[1], false, p);
+	for(std::size_t i=0; i!=16; ++i)
+	{
+		const unsigned bit = 16+3*unsigned(i);
+		unsigned k = in[bit/8] >> (bit%8);
+		if(bit%8 > 5) k |= unsigned(in[bit/8+1]) << (8-bit%8);
+		out[i*stride] = GLubyte(p[k & 7u] & 0xFF);
+	}
+}
+
+inline const int* BC7Weights(unsigned bits)
+{
+	static const int w2[4] = {0, 21, 43, 64};
+	static const int w3[8] = {0, 9, 18, 27, 37, 46, 55, 64};
+	static const int w4[16] = {
+		0, 4, 9, 13, 17, 21, 26, 30,
+		34, 38, 43, 47, 51, 55, 60, 64
+	};
+	return (bits == 2)?w2:(bits == 3)?w3:w4;
+}
+
+inline int BC7Interpolate(int e0, int e1, int w)
+{
+	return ((64-w)*e0+w*e1+32) >> 6;
+}
+
+// Quantizes an endpoint to the 7-bit values and a p-bit
+inline void BC7Quantize(const float* e, unsigned p, unsigned* q)
+{
+	for(std::size_t c=0; c!=4; ++c)
+	{
+		const float v = (e[c]-float(p))*0.5f+0.5f;
+		q[c] = unsigned(std::min(std::max(v, 0.0f), 127.0f));
+	}
+}
+
+inline float BC7QuantizeError(const float* e, unsigned p, unsigned* q)
+{
+	BC7Quantize(e, p, q);
+	float error = 0.0f;
+	for(std::size_t c=0; c!=4; ++c)
+	{
+		const float d = e[c]-float((q[c] << 1) | p);
+		error += d*d;
+	}
+	return error;
+}
+
+// BC7 mode 6 endpoints
+struct BC7Endpoints
+{
+	unsigned q[2][4];
+	unsigned p[2];
+};
+
+inline void BC7QuantizeBest(const float* e0, const float* e1, BC7Endpoints& ep)
+{
+	const float* e[2] = {e0, e1};
+	for(std::size_t j=0; j!=2; ++j)
+	{
+		unsigned q0[4], q1[4];
+		const float d0 = BC7QuantizeError(e[j], 0, q0);
+		const float d1 = BC7QuantizeError(e[j], 1, q1);
+		ep.p[j] = (d1 < d0)?1:0;
+		std::memcpy(ep.q[j], (d1 < d0)?q1:q0, sizeof(q0));
+	}
+}
+
+// Finds the nearest mode 6 indices, returns the squared error
+inline float BC7Fit(const BlockTexels& t, const BC7Endpoints& ep, GLubyte* idx)
+{
+	const int* weight = BC7Weights(4);
+	float a[4], d[4], pal[16][4], dd = 0.0f;
+	for(std::size_t c=0; c!=4; ++c)
+	{
+		const int e0 = int((ep.q[0][c] << 1) | ep.p[0]);
+		const int e1 = int((ep.q[1][c] << 1) | ep.p[1]);
+		for(std::size_t k=0; k!=16; ++k)
+		{
+			pal[k][c] = float(BC7Interpolate(e0, e1, weight[k]));
+		}
+		a[c] = float(e0);
+		d[c] = float(e1-e0);
+		dd += d[c]*d[c];
+	}
+	float error = 0.0f;
+	for(std::size_t i=0; i!=16; ++i)
+	{
+		// the projection on the endpoint line and its neighbours
+		float proj = 0.0f;
+		for(std::size_t c=0; c!=4; ++c)
+		{
+			proj += (t.v[c][i]-a[c])*d[c];
+		}
+		int k = (dd > 0.0f)?int(std::floor(proj/dd*15.0f+0.5f)):0;
+		k = std::min(std::max(k, 0), 15);
+		float best = 1e30f;
+		for(int j=std::max(k-1, 0); j<=std::min(k+1, 15); ++j)
+		{
+			float e = 0.0f;
+			for(std::size_t c=0; c!=4; ++c)
+			{
+				const float diff = t.v[c][i]-pal[j][c];
+				e += diff*diff;
+			}
+			if(best > e)
+			{
+				best = e;
+				idx[i] = GLubyte(j);
+			}
+		}
+		error += best;
+	}
+	return error;
+}
+
+inline void BC7EncodeBlock(
+	const BlockTexels& t,
+	images::BlockQuality quality,
+	GLubyte* out
+)
+{
+	float e0[4], e1[4];
+	if(quality == images::BlockQuality::Fast)
+	{
+		BlockBoundsEndpoints<4>(t, 0xFFFFu, e0, e1);
+	}
+	else BlockAxisEndpoints<4>(t, 0xFFFFu, e0, e1);
+
+	BC7Endpoints ep;
+	BC7QuantizeBest(e0, e1, ep);
+	GLubyte idx[16] = { 0 };
+	float best = BC7Fit(t, ep, idx);
+
+	unsigned iterations = 0;
+	if(quality == images::BlockQuality::Normal) iterations = 1;
+	if(quality == images::BlockQuality::High) iterations = 3;
+
+	float weights[16];
+	for(std::size_t k=0; k!=16; ++k)
+	{
+		weights[k] = float(BC7Weights(4)[k])/64.0f;
+	}
+	for(unsigned iter=0; iter!=iterations; ++iter)
+	{
+		if(!BlockLeastSquares<4>(t, 0xFFFFu, idx, weights, e0, e1)) break;
+		BC7Endpoints tep;
+		GLubyte tidx[16];
+		BC7QuantizeBest(e0, e1, tep);
+		float error = BC7Fit(t, tep, tidx);
+		if(quality == images::BlockQuality::High)
+		{
+			// try all the p-bit combinations
+			for(unsigned p=0; p!=4; ++p)
+			{
+				BC7Endpoints pep;
+				GLubyte pidx[16];
+				pep.p[0] = p & 1u;
+				pep.p[1] = p >> 1;
+				BC7Quantize(e0, pep.p[0], pep.q[0]);
+				BC7Quantize(e1, pep.p[1], pep.q[1]);
+				const float e = BC7Fit(t, pep, pidx);
+				if(error > e)
+				{
+					error = e;
+					tep = pep;
+					std::memcpy(tidx, pidx, 16);
+				}
+			}
+		}
+		if(error >= best) break;
+		best = error;
+		ep = tep;
+		std::memcpy(idx, tidx, 16);
+	}
+	// the most significant bit of the first (anchor) index is implicit
+	if(idx[0] & 8u)
+	{
+		std::swap(ep.q[0], ep.q[1]);
+		std::swap(ep.p[0], ep.p[1]);
+		for(std::size_t i=0; i!=16; ++i)
+		{
+			idx[i] = GLubyte(15-idx[i]);
+		}
+	}
+	BlockBitWriter bits(out);
+	bits.Put(1u << 6, 7);
+	for(std::size_t c=0; c!=4; ++c)
+	{
+		bits.Put(ep.q[0][c], 7);
+		bits.Put(ep.q[1][c], 7);
+	}
+	bits.Put(ep.p[0], 1);
+	bits.Put(ep.p[1], 1);
+	bits.Put(idx[0], 3);
+	for(std::size_t i=1; i!=16; ++i)
+	{
+		bits.Put(idx[i], 4);
+	}
+}
+
+// Decodes the single subset modes (4, 5 and 6) of BC7
+inline void BC7DecodeBlock(const GLubyte* in, GLubyte* rgba)
+{
+	unsigned mode = 0;
+	while((mode != 8) && !((in[0] >> mode) & 1u)) ++mode;
+
+	std::memset(rgba, 0, 64);
+	// the reserved mode decodes as transparent black
+	if(mode == 8) return;
+	if((mode < 4) || (mode > 6))
+	{
+		throw std::runtime_error(
+			"Decoding of the partitioned BC7 modes is not supported"
+		);
+	}
+
+	BlockBitReader bits(in);
+	bits.Get(mode+1);
+
+	const unsigned rotation = (mode == 6)?0:bits.Get(2);
+	const unsigned index_sel = (mode == 4)?bits.Get(1):0;
+	const unsigned cbits = (mode == 4)?5:7;
+	const unsigned abits = (mode == 4)?6:(mode == 5)?8:7;
+
+	int e[2][4];
+	for(std::size_t c=0; c!=3; ++c)
+	{
+		e[0][c] = int(bits.Get(cbits));
+		e[1][c] = int(bits.Get(cbits));
+	}
+	e[0][3] = int(bits.Get(abits));
+	e[1][3] = int(bits.Get(abits));
+	if(mode == 6)
+	{
+		const unsigned p0 = bits.Get(1), p1 = bits.Get(1);
+		for(std::size_t c=0; c!=4; ++c)
+		{
+			e[0][c] = (e[0][c] << 1) | int(p0);
+			e[1][c] = (e[1][c] << 1) | int(p1);
+		}
+	}
+	else
+	{
+		for(std::size_t j=0; j!=2; ++j)
+		{
+			for(std::size_t c=0; c!=3; ++c)
+			{
+				e[j][c] <<= (8-cbits);
+				e[j][c] |= e[j][c] >> cbits;
+			}
+			if(abits < 8)
+			{
+				e[j][3] <<= (8-abits);
+				e[j][3] |= e[j][3] >> abits;
+			}
+		}
+	}
+	// the primary (color) and secondary (alpha) indices
+	const unsigned ibits[2] = {
+		(mode == 6)?4u:2u,
+		(mode == 6)?0u:(mode == 4)?3u:2u
+	};
+
+	unsigned idx[2][16] = {{0}, {0}};
+	for(std::size_t s=0; s!=2; ++s)
+	{
+		if(!ibits[s]) continue;
+		for(std::size_t i=0; i!=16; ++i)
+		{
+			idx[s][i] = bits.Get((i == 0)?ibits[s]-1:ibits[s]);
+		}
+	}
+	const std::size_t cs = index_sel?1:0, as = (mode == 6)?0:1-cs;
+	const int* cw = BC7Weights(ibits[cs]);
+	const int* aw = BC7Weights(ibits[as]);
+	for(std::size_t i=0; i!=16; ++i)
+	{
+		int v[4];
+		for(std::size_t c=0; c!=3; ++c)
+		{
+			v[c] = BC7Interpolate(e[0][c], e[1][c], cw[idx[cs][i]]);
+		}
+		v[3] = BC7Interpolate(e[0][3], e[1][3], aw[idx[as][i]]);
+		if(rotation) std::swap(v[3], v[rotation-1]);
+		for(std::size_t c=0; c!=4; ++c)
+		{
+			rgba[i*4+c] = GLubyte(v[c]);
+		}
+	}
+}
+
+} // namespace aux
+namespace images {
+
+OGLPLUS_LIB_FUNC
+unsigned BlockCompressionParams::Threads(void) const
+{
+	return aux::ParallelThreads(_threads);
+}
+
+OGLPLUS_LIB_FUNC
+std::size_t CompressedImage::BlockSize(BlockFormat format)
+{
+	switch(format)
+	{
+		case BlockFormat::BC1:
+		case BlockFormat::BC4:
+			return 8;
+		default:;
+	}
+	return 16;
+}
+
+OGLPLUS_LIB_FUNC
+std::size_t CompressedImage::DataSize(
+	BlockFormat format,
+	GLsizei width,
+	GLsizei height,
+	GLsizei depth
+)
+{
+	return	std::size_t((width+3)/4)*
+		std::size_t((height+3)/4)*
+		std::size_t(depth)*
+		BlockSize(format);
+}
+
+OGLPLUS_LIB_FUNC
+CompressedImage::CompressedImage(
+	GLsizei width,
+	GLsizei height,
+	GLsizei depth,
+	const void* data,
+	const BlockCompressionParams& params
+): _width(width)
+ , _height(height)
+ , _depth(depth)
+ , _format(params.Format())
+ , _srgb(params.IsSRGB())
+ , _signed(params.IsSigned())
+ , _data(
+	static_cast<const GLubyte*>(data),
+	static_cast<const GLubyte*>(data)+
+	DataSize(params.Format(), width, height, depth)
+)
+{ }
+
+OGLPLUS_LIB_FUNC
+PixelDataInternalFormat CompressedImage::InternalFormat(void) const
+{
+	GLenum result = 0;
+	switch(_format)
+	{
+		case BlockFormat::BC1:
+			result = _srgb?
+				GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT:
+				GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+			break;
+		case BlockFormat::BC3:
+			result = _srgb?
+				GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT:
+				GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+			break;
+		case BlockFormat::BC4:
+			result = _signed?
+				GL_COMPRESSED_SIGNED_RED_RGTC1:
+				GL_COMPRESSED_RED_RGTC1;
+			break;
+		case BlockFormat::BC5:
+			result = _signed?
+				GL_COMPRESSED_SIGNED_RG_RGTC2:
+				GL_COMPRESSED_RG_RGTC2;
+			break;
+		case BlockFormat::BC7:
+			result = _srgb?
+				GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM:
+				GL_COMPRESSED_RGBA_BPTC_UNORM;
+			break;
+	}
+	return PixelDataInternalFormat(result);
+}
+
+OGLPLUS_LIB_FUNC
+void CompressedImage::_encode(
+	const Image& image,
+	const BlockCompressionParams& params
+)
+{
+	const BlockFormat format = _format;
+	const BlockQuality quality = params.Quality();
+	const bool is_signed = _signed;
+	const bool punch_through = (image.Channels() == 4);
+	const aux::BlockSource source(image, format, is_signed);
+
+	const GLsizei bw = (_width+3)/4, bh = (_height+3)/4;
+	const std::size_t block_size = BlockSize(format);
+	_data.assign(DataSize(format, _width, _height, _depth), 0x00);
+	GLubyte* const out = _data.data();
+
+	// block rows are encoded in parallel
+	aux::ParallelFor(
+		std::size_t(bh)*_depth,
+		std::size_t(bw)*bh*_depth*1024,
+		params.Threads(),
+		[=, &source](std::size_t begin, std::size_t end)
+		{
+			aux::BlockTexels t;
+			for(std::size_t row=begin; row!=end; ++row)
+			{
+				const GLsizei z = GLsizei(row/bh);
+				const GLsizei by = GLsizei(row%bh);
+				GLubyte* block = out+row*bw*block_size;
+				for(GLsizei bx=0; bx!=bw; ++bx)
+				{
+					source.Gather(bx, by, z, t);
+					switch(format)
+					{
+						case BlockFormat::BC1:
+							aux::BC1EncodeBlock(
+								t, false,
+								punch_through,
+								quality, block
+							);
+							break;
+						case BlockFormat::BC3:
+							aux::BC4EncodeBlock(
+								t.v[3], false,
+								quality, block
+							);
+							aux::BC1EncodeBlock(
+								t, true, false,
+								quality, block+8
+							);
+							break;
+						case BlockFormat::BC4:
+							aux::BC4EncodeBlock(
+								t.v[0], is_signed,
+								quality, block
+							);
+							break;
+						case BlockFormat::BC5:
+							aux::BC4EncodeBlock(
+								t.v[0], is_signed,
+								quality, block
+							);
+							aux::BC4EncodeBlock(
+								t.v[1], is_signed,
+								quality, block+8
+							);
+							break;
+						case BlockFormat::BC7:
+							aux::BC7EncodeBlock(
+								t, quality, block
+							);
+							break;
+					}
+					block += block_size;
+				}
+			}
+		}
+	);
+}
+
+OGLPLUS_LIB_FUNC
+Image CompressedImage::Decompress(void) const
+{
+	GLsizei ch = 4;
+	if(_format == BlockFormat::BC4) ch = 1;
+	if(_format == BlockFormat::BC5) ch = 2;
+
+	const GLsizei bw = (_width+3)/4, bh = (_height+3)/4;
+	const std::size_t block_size = BlockSize(_format);
+	std::vector<GLubyte> data(std::size_t(_width)*_height*_depth*ch);
+
+	const GLubyte* block = _data.data();
+	GLubyte texels[16*4];
+	for(GLsizei z=0; z!=_depth; ++z)
+	for(GLsizei by=0; by!=bh; ++by)
+	for(GLsizei bx=0; bx!=bw; ++bx)
+	{
+		switch(_format)
+		{
+			case BlockFormat::BC1:
+				aux::BC1DecodeBlock(block, false, texels);
+				break;
+			case BlockFormat::BC3:
+				aux::BC1DecodeBlock(block+8, true, texels);
+				aux::BC4DecodeBlock(block, false, texels+3, 4);
+				break;
+			case BlockFormat::BC4:
+				aux::BC4DecodeBlock(block, _signed, texels, 1);
+				break;
+			case BlockFormat::BC5:
+				aux::BC4DecodeBlock(block, _signed, texels, 2);
+				aux::BC4DecodeBlock(block+8, _signed, texels+1, 2);
+				break;
+			case BlockFormat::BC7:
+				aux::BC7DecodeBlock(block, texels);
+				break;
+		}
+		block += block_size;
+
+		for(GLsizei i=0; i!=16; ++i)
+		{
+			const GLsizei x = bx*4+i%4, y = by*4+i/4;
+			if((x >= _width) || (y >= _height)) continue;
+			std::memcpy(
+				data.data()+std::size_t((z*_height+y)*_width+x)*ch,
+				texels+i*ch,
+				std::size_t(ch)
+			);
+		}
+	}
+
+	if(_signed)
+	{
+		return Image(
+			_width, _height, _depth, ch,
+			reinterpret_cast<const GLbyte*>(data.data()),
+			(ch == 1)?PixelDataFormat::Red:PixelDataFormat::RG,
+			(ch == 1)?
+				PixelDataInternalFormat::R8SNorm:
+				PixelDataInternalFormat::RG8SNorm
+		);
+	}
+	if(_srgb)
+	{
+		return Image(
+			_width, _height, _depth, ch,
+			data.data(),
+			PixelDataFormat::RGBA,
+			PixelDataInternalFormat::SRGB8Alpha8
+		);
+	}
+	return Image(_width, _height, _depth, ch, data.data());
+}
+
+OGLPLUS_LIB_FUNC
+CompressedMipmapChain::CompressedMipmapChain(
+	const MipmapChain& mipmaps,
+	const BlockCompressionParams& params
+): _layered(mipmaps.IsLayered())
+{
+	_levels.reserve(mipmaps.Levels());
+	BlockCompressionParams level_params(params);
+	// all levels use the color space of the base level
+	level_params.SRGB(params.IsSRGB(mipmaps.Level(0)));
+	for(std::size_t l=0, n=mipmaps.Levels(); l!=n; ++l)
+	{
+		_levels.push_back(CompressedImage(mipmaps.Level(l), level_params));
+	}
+}
+
+} // namespace images
+} // namespace oglplus
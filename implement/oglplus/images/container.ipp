@@ -0,0 +1,1085 @@
+/**
+ *  @file oglplus/images/container.ipp
+ *  @brief Implementation of images::ImageContainer
+ *
+ *  @author Matus Chochlik
+ *
+ *  Copyright 2010-2015 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#include <algorithm>
+#include <fstream>
+#include <stdexcept>
+#include <cstring>
+
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT3_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT3_EXT 0x83F2
+#endif
+
+namespace oglplus {
+namespace aux {
+
+inline GLuint ContainerU32(const GLubyte* p)
+{
+	return	(GLuint(p[0]) <<  0) |
+		(GLuint(p[1]) <<  8) |
+		(GLuint(p[2]) << 16) |
+		(GLuint(p[3]) << 24);
+}
+
+inline void ContainerPutU32(std::vector<GLubyte>& out, GLuint v)
+{
+	out.push_back(GLubyte(v >>  0));
+	out.push_back(GLubyte(v >>  8));
+	out.push_back(GLubyte(v >> 16));
+	out.push_back(GLubyte(v >> 24));
+}
+
+inline GLuint ContainerFourCC(const char* code)
+{
+	return ContainerU32(reinterpret_cast<const GLubyte*>(code));
+}
+
+// The size of a single component of the specified type (0 if packed)
+inline GLuint ContainerTypeSize(GLenum type)
+{
+	switch(type)
+	{
+		case GL_UNSIGNED_BYTE:
+		case GL_BYTE:
+			return 1;
+		case GL_UNSIGNED_SHORT:
+		case GL_SHORT:
+		case GL_HALF_FLOAT:
+			return 2;
+		case GL_UNSIGNED_INT:
+		case GL_INT:
+		case GL_FLOAT:
+			return 4;
+		default:;
+	}
+	return 0;
+}
+
+inline GLuint ContainerChannels(GLenum format)
+{
+	switch(format)
+	{
+		case GL_RED:
+		case GL_GREEN:
+		case GL_BLUE:
+		case GL_ALPHA:
+		case GL_RED_INTEGER:
+		case GL_DEPTH_COMPONENT:
+			return 1;
+		case GL_RG:
+		case GL_RG_INTEGER:
+		case GL_DEPTH_STENCIL:
+			return 2;
+		case GL_RGB:
+		case GL_BGR:
+		case GL_RGB_INTEGER:
+			return 3;
+		case GL_RGBA:
+		case GL_BGRA:
+		case GL_RGBA_INTEGER:
+			return 4;
+		default:;
+	}
+	return 0;
+}
+
+// The base internal format for the specified pixel data format
+inline GLenum ContainerBaseFormat(GLenum format)
+{
+	switch(format)
+	{
+		case GL_RED_INTEGER: return GL_RED;
+		case GL_RG_INTEGER: return GL_RG;
+		case GL_BGR:
+		case GL_RGB_INTEGER: return GL_RGB;
+		case GL_BGRA:
+		case GL_RGBA_INTEGER: return GL_RGBA;
+		default:;
+	}
+	return format;
+}
+
+// The size of a 4x4 block of the specified format (0 if unknown)
+inline GLuint ContainerBlockSize(GLenum internal)
+{
+	switch(internal)
+	{
+		case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+		case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:
+		case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT:
+		case GL_COMPRESSED_RED_RGTC1:
+		case GL_COMPRESSED_SIGNED_RED_RGTC1:
+			return 8;
+		case GL_COMPRESSED_RGBA_S3TC_DXT3_EXT:
+		case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+		case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT:
+		case GL_COMPRESSED_RG_RGTC2:
+		case GL_COMPRESSED_SIGNED_RG_RGTC2:
+		case GL_COMPRESSED_RGBA_BPTC_UNORM:
+		case GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM:
+			return 16;
+		default:;
+	}
+	return 0;
+}
+
+// The block compression parameters for decoding the specified format
+inline bool ContainerBlockParams(
+	GLenum internal,
+	images::BlockCompressionParams& params
+)
+{
+	using images::BlockFormat;
+	switch(internal)
+	{
+		case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+		case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:
+			params.Format(BlockFormat::BC1).SRGB(false);
+			return true;
+		case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT:
+			params.Format(BlockFormat::BC1).SRGB(true);
+			return true;
+		case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+			params.Format(BlockFormat::BC3).SRGB(false);
+			return true;
+		case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT:
+			params.Format(BlockFormat::BC3).SRGB(true);
+			return true;
+		case GL_COMPRESSED_RED_RGTC1:
+			params.Format(BlockFormat::BC4).Signed(false);
+			return true;
+		case GL_COMPRESSED_SIGNED_RED_RGTC1:
+			params.Format(BlockFormat::BC4).Signed(true);
+			return true;
+		case GL_COMPRESSED_RG_RGTC2:
+			params.Format(BlockFormat::BC5).Signed(false);
+			return true;
+		case GL_COMPRESSED_SIGNED_RG_RGTC2:
+			params.Format(BlockFormat::BC5).Signed(true);
+			return true;
+		case GL_COMPRESSED_RGBA_BPTC_UNORM:
+			params.Format(BlockFormat::BC7).SRGB(false);
+			return true;
+		case GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM:
+			params.Format(BlockFormat::BC7).SRGB(true);
+			return true;
+		default:;
+	}
+	return false;
+}
+
+inline GLenum ContainerBlockBase(images::BlockFormat format)
+{
+	switch(format)
+	{
+		case images::BlockFormat::BC4: return GL_RED;
+		case images::BlockFormat::BC5: return GL_RG;
+		default:;
+	}
+	return GL_RGBA;
+}
+
+// A DXGI format and the equivalent GL pixel data description
+struct ContainerDXGIFormat
+{
+	GLuint dxgi;
+	GLenum type, format, internal;
+};
+
+inline const ContainerDXGIFormat* ContainerDXGIFormats(std::size_t& count)
+{
+	static const ContainerDXGIFormat formats[] = {
+		{ 2, GL_FLOAT, GL_RGBA, GL_RGBA32F},
+		{ 6, GL_FLOAT, GL_RGB, GL_RGB32F},
+		{10, GL_HALF_FLOAT, GL_RGBA, GL_RGBA16F},
+		{11, GL_UNSIGNED_SHORT, GL_RGBA, GL_RGBA16},
+		{16, GL_FLOAT, GL_RG, GL_RG32F},
+		{28, GL_UNSIGNED_BYTE, GL_RGBA, GL_RGBA8},
+		{29, GL_UNSIGNED_BYTE, GL_RGBA, GL_SRGB8_ALPHA8},
+		{31, GL_BYTE, GL_RGBA, GL_RGBA8_SNORM},
+		{34, GL_HALF_FLOAT, GL_RG, GL_RG16F},
+		{35, GL_UNSIGNED_SHORT, GL_RG, GL_RG16},
+		{41, GL_FLOAT, GL_RED, GL_R32F},
+		{49, GL_UNSIGNED_BYTE, GL_RG, GL_RG8},
+		{51, GL_BYTE, GL_RG, GL_RG8_SNORM},
+		{54, GL_HALF_FLOAT, GL_RED, GL_R16F},
+		{56, GL_UNSIGNED_SHORT, GL_RED, GL_R16},
+		{61, GL_UNSIGNED_BYTE, GL_RED, GL_R8},
+		{63, GL_BYTE, GL_RED, GL_R8_SNORM},
+		{71, 0, 0, GL_COMPRESSED_RGBA_S3TC_DXT1_EXT},
+		{72, 0, 0, GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT},
+		{74, 0, 0, GL_COMPRESSED_RGBA_S3TC_DXT3_EXT},
+		{77, 0, 0, GL_COMPRESSED_RGBA_S3TC_DXT5_EXT},
+		{78, 0, 0, GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT},
+		{80, 0, 0, GL_COMPRESSED_RED_RGTC1},
+		{81, 0, 0, GL_COMPRESSED_SIGNED_RED_RGTC1},
+		{83, 0, 0, GL_COMPRESSED_RG_RGTC2},
+		{84, 0, 0, GL_COMPRESSED_SIGNED_RG_RGTC2},
+		{87, GL_UNSIGNED_BYTE, GL_BGRA, GL_RGBA8},
+		{98, 0, 0, GL_COMPRESSED_RGBA_BPTC_UNORM},
+		{99, 0, 0, GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM}
+	};
+	count = sizeof(formats)/sizeof(formats[0]);
+	return formats;
+}
+
+inline const ContainerDXGIFormat* ContainerFindDXGI(GLuint dxgi)
+{
+	std::size_t count = 0;
+	const ContainerDXGIFormat* formats = ContainerDXGIFormats(count);
+	for(std::size_t i=0; i!=count; ++i)
+	{
+		if(formats[i].dxgi == dxgi) return formats+i;
+	}
+	return nullptr;
+}
+
+// A mipmap level of the images being saved into a container
+struct ContainerLevel
+{
+	GLsizei width, height, depth;
+	const GLubyte* data;
+	std::size_t size;
+};
+
+// The description of the images being saved into a container
+struct ContainerDesc
+{
+	GLenum type, format, internal, base;
+	GLuint type_size, pixel_size;
+	bool compressed, srgb;
+	GLuint layers, faces, array_size;
+	bool volume;
+	std::vector<ContainerLevel> levels;
+
+	ContainerDesc(GLsizei depth, bool layered, bool cube_map)
+	 : type(0)
+	 , format(0)
+	 , internal(0)
+	 , base(0)
+	 , type_size(1)
+	 , pixel_size(0)
+	 , compressed(false)
+	 , srgb(false)
+	 , layers(1)
+	 , faces(1)
+	 , array_size(0)
+	 , volume(false)
+	{
+		if(cube_map)
+		{
+			if((depth <= 0) || (depth % 6 != 0))
+			{
+				throw std::runtime_error(
+					"The depth of a cube map image "
+					"must be a multiple of six"
+				);
+			}
+			faces = 6;
+			layers = GLuint(depth/6);
+			array_size = (layers > 1)?layers:0;
+		}
+		else if(layered)
+		{
+			layers = GLuint(depth);
+			array_size = layers;
+		}
+		else volume = (depth > 1);
+	}
+
+	explicit ContainerDesc(
+		const images::MipmapChain& mipmaps,
+		bool cube_map
+	): ContainerDesc(
+		mipmaps.Level(0).Depth(),
+		mipmaps.IsLayered(),
+		cube_map
+	)
+	{
+		const images::Image& base_image = mipmaps.Level(0);
+		type = GLenum(base_image.Type());
+		format = GLenum(base_image.Format());
+		internal = GLenum(base_image.InternalFormat());
+		base = ContainerBaseFormat(format);
+		type_size = ContainerTypeSize(type);
+		pixel_size = type_size*GLuint(base_image.Channels());
+		srgb = base_image.IsSRGB();
+		for(std::size_t l=0, n=mipmaps.Levels(); l!=n; ++l)
+		{
+			const images::Image& image = mipmaps.Level(l);
+			ContainerLevel level = {
+				image.Width(),
+				image.Height(),
+				image.Depth(),
+				static_cast<const GLubyte*>(image.RawData()),
+				image.DataSize()
+			};
+			levels.push_back(level);
+		}
+	}
+
+	explicit ContainerDesc(
+		const images::CompressedMipmapChain& mipmaps,
+		bool cube_map
+	): ContainerDesc(
+		mipmaps.Level(0).Depth(),
+		mipmaps.IsLayered(),
+		cube_map
+	)
+	{
+		const images::CompressedImage& base_image = mipmaps.Level(0);
+		internal = GLenum(base_image.InternalFormat());
+		base = ContainerBlockBase(base_image.Format());
+		compressed = true;
+		for(std::size_t l=0, n=mipmaps.Levels(); l!=n; ++l)
+		{
+			const images::CompressedImage& image = mipmaps.Level(l);
+			ContainerLevel level = {
+				image.Width(),
+				image.Height(),
+				image.Depth(),
+				image.Data(),
+				image.DataSize()
+			};
+			levels.push_back(level);
+		}
+	}
+
+	// The size of the data of a single layer and face of a level
+	std::size_t SliceSize(const ContainerLevel& level) const
+	{
+		return level.size/(layers*faces);
+	}
+};
+
+inline std::ofstream& ContainerCreate(
+	std::ofstream& file,
+	const std::string& path
+)
+{
+	file.open(path.c_str(), std::ios::binary);
+	if(!file.good())
+	{
+		throw std::runtime_error("Unable to create file '"+path+"'");
+	}
+	return file;
+}
+
+inline void ContainerWrite(
+	std::ofstream& file,
+	const void* data,
+	std::size_t size
+)
+{
+	file.write(static_cast<const char*>(data), std::streamsize(size));
+}
+
+inline void ContainerPad(std::ofstream& file, std::size_t size)
+{
+	static const char zeros[4] = {0, 0, 0, 0};
+	file.write(zeros, std::streamsize((4-size%4)%4));
+}
+
+inline void ContainerSaveKTX(const std::string& path, const ContainerDesc& desc)
+{
+	const ContainerLevel& base = desc.levels.front();
+	std::vector<GLubyte> header;
+	static const GLubyte identifier[12] = {
+		0xAB, 0x4B, 0x54, 0x58, 0x20, 0x31,
+		0x31, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A
+	};
+	header.assign(identifier, identifier+12);
+	ContainerPutU32(header, 0x04030201);
+	ContainerPutU32(header, desc.type);
+	ContainerPutU32(header, desc.type_size);
+	ContainerPutU32(header, desc.format);
+	ContainerPutU32(header, desc.internal);
+	ContainerPutU32(header, desc.base);
+	ContainerPutU32(header, GLuint(base.width));
+	ContainerPutU32(header, GLuint(base.height));
+	ContainerPutU32(header, desc.volume?GLuint(base.depth):0);
+	ContainerPutU32(header, desc.array_size);
+	ContainerPutU32(header, desc.faces);
+	ContainerPutU32(header, GLuint(desc.levels.size()));
+	ContainerPutU32(header, 0);
+
+	std::ofstream file;
+	ContainerCreate(file, path);
+	ContainerWrite(file, header.data(), header.size());
+
+	// non-array cube maps have the size of a single face per level
+	const bool per_face = (desc.faces == 6) && (desc.array_size == 0);
+	for(auto i=desc.levels.begin(), e=desc.levels.end(); i!=e; ++i)
+	{
+		const std::size_t row = desc.compressed?
+			0:std::size_t(i->width)*desc.pixel_size;
+		const std::size_t stride = (row+3) & ~std::size_t(3);
+		const std::size_t rows = std::size_t(i->height)*i->depth;
+		const std::size_t size = (row == stride)?
+			i->size:
+			stride*rows;
+		std::vector<GLubyte> image_size;
+		ContainerPutU32(
+			image_size,
+			GLuint(per_face?size/desc.faces:size)
+		);
+		ContainerWrite(file, image_size.data(), image_size.size());
+
+		if(row == stride)
+		{
+			ContainerWrite(file, i->data, i->size);
+		}
+		else
+		{
+			// the rows of uncompressed images are 4-byte aligned
+			for(std::size_t r=0; r!=rows; ++r)
+			{
+				ContainerWrite(file, i->data+r*row, row);
+				ContainerPad(file, row);
+			}
+		}
+		ContainerPad(file, size);
+	}
+	if(!file.good())
+	{
+		throw std::runtime_error("Unable to write file '"+path+"'");
+	}
+}
+
+inline void ContainerSaveDDS(const std::string& path, const ContainerDesc& desc)
+{
+	GLuint dxgi = 0;
+	std::size_t count = 0;
+	const ContainerDXGIFormat* formats = ContainerDXGIFormats(count);
+	for(std::size_t f=0; f!=count; ++f)
+	{
+		if(desc.compressed)
+		{
+			if(formats[f].internal != desc.internal) continue;
+		}
+		else if(
+			(formats[f].type != desc.type) ||
+			(formats[f].format != desc.format)
+		) continue;
+		// the sRGB variant follows the non-sRGB one
+		else if(dxgi && !desc.srgb) continue;
+		dxgi = formats[f].dxgi;
+	}
+	if(dxgi == 0)
+	{
+		throw std::runtime_error(
+			"The image format cannot be saved into a DDS file"
+		);
+	}
+
+	const ContainerLevel& base = desc.levels.front();
+	const GLuint levels = GLuint(desc.levels.size());
+	GLuint flags = 0x1 | 0x2 | 0x4 | 0x1000 | 0x20000;
+	if(desc.volume) flags |= 0x800000;
+	flags |= desc.compressed?0x80000:0x8;
+	GLuint caps = 0x1000;
+	if(levels > 1) caps |= 0x400000 | 0x8;
+	if(desc.volume || (desc.faces == 6)) caps |= 0x8;
+	GLuint caps2 = 0;
+	if(desc.faces == 6) caps2 = 0x200 | 0xFC00;
+	else if(desc.volume) caps2 = 0x200000;
+
+	std::vector<GLubyte> header;
+	header.push_back('D');
+	header.push_back('D');
+	header.push_back('S');
+	header.push_back(' ');
+	ContainerPutU32(header, 124);
+	ContainerPutU32(header, flags);
+	ContainerPutU32(header, GLuint(base.height));
+	ContainerPutU32(header, GLuint(base.width));
+	ContainerPutU32(header, GLuint(desc.compressed?
+		desc.SliceSize(base):
+		std::size_t(base.width)*desc.pixel_size
+	));
+	ContainerPutU32(header, desc.volume?GLuint(base.depth):0);
+	ContainerPutU32(header, levels);
+	for(GLuint r=0; r!=11; ++r) ContainerPutU32(header, 0);
+	// the pixel format
+	ContainerPutU32(header, 32);
+	ContainerPutU32(header, 0x4);
+	ContainerPutU32(header, ContainerFourCC("DX10"));
+	for(GLuint r=0; r!=5; ++r) ContainerPutU32(header, 0);
+	ContainerPutU32(header, caps);
+	ContainerPutU32(header, caps2);
+	for(GLuint r=0; r!=3; ++r) ContainerPutU32(header, 0);
+	// the DX10 header extension
+	ContainerPutU32(header, dxgi);
+	ContainerPutU32(header, desc.volume?4:3);
+	ContainerPutU32(header, (desc.faces == 6)?0x4:0x0);
+	ContainerPutU32(header, desc.layers);
+	ContainerPutU32(header, 0);
+
+	std::ofstream file;
+	ContainerCreate(file, path);
+	ContainerWrite(file, header.data(), header.size());
+
+	// the mipmap levels of each layer and face are stored together
+	for(GLuint slice=0; slice!=desc.layers*desc.faces; ++slice)
+	{
+		for(GLuint l=0; l!=levels; ++l)
+		{
+			const ContainerLevel& level = desc.levels[l];
+			const std::size_t size = desc.SliceSize(level);
+			ContainerWrite(file, level.data+slice*size, size);
+		}
+	}
+	if(!file.good())
+	{
+		throw std::runtime_error("Unable to write file '"+path+"'");
+	}
+}
+
+// Copies the pixels mirroring the rows and/or the columns of each slice
+inline const GLubyte* ContainerReorient(
+	const GLubyte* src,
+	std::vector<GLubyte>& dst,
+	GLsizei width,
+	GLsizei height,
+	GLsizei depth,
+	std::size_t pixel_size,
+	bool flip_y,
+	bool flip_x
+)
+{
+	if(!flip_y && !flip_x) return src;
+
+	const std::size_t row = std::size_t(width)*pixel_size;
+	std::vector<GLubyte> result(row*std::size_t(height)*depth);
+	for(GLsizei z=0; z!=depth; ++z)
+	for(GLsizei y=0; y!=height; ++y)
+	{
+		const GLsizei sy = flip_y?height-y-1:y;
+		const GLubyte* s = src+(std::size_t(z)*height+sy)*row;
+		GLubyte* d = result.data()+(std::size_t(z)*height+y)*row;
+		if(flip_x)
+		{
+			for(GLsizei x=0; x!=width; ++x)
+			{
+				std::memcpy(
+					d+std::size_t(x)*pixel_size,
+					s+std::size_t(width-x-1)*pixel_size,
+					pixel_size
+				);
+			}
+		}
+		else std::memcpy(d, s, row);
+	}
+	dst.swap(result);
+	return dst.data();
+}
+
+} // namespace aux
+
+namespace images {
+
+OGLPLUS_LIB_FUNC
+void ImageContainer::_check(std::size_t offset, std::size_t size) const
+{
+	if((offset > _file.Size()) || (size > _file.Size()-offset))
+	{
+		throw std::runtime_error("Truncated image container file");
+	}
+}
+
+OGLPLUS_LIB_FUNC
+void ImageContainer::_add_view(
+	GLuint level,
+	GLuint layer,
+	GLuint face,
+	std::size_t offset,
+	std::size_t size
+)
+{
+	_check(offset, size);
+	_views.push_back(ImageContainerView(
+		std::max(_width >> level, 1),
+		std::max(_height >> level, 1),
+		std::max(_depth >> level, 1),
+		level,
+		layer,
+		face,
+		_file.Data()+offset,
+		size
+	));
+}
+
+OGLPLUS_LIB_FUNC
+void ImageContainer::_parse(void)
+{
+	static const GLubyte ktx_identifier[12] = {
+		0xAB, 0x4B, 0x54, 0x58, 0x20, 0x31,
+		0x31, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A
+	};
+	const GLubyte* data = _file.Data();
+	const std::size_t size = _file.Size();
+
+	if((size >= 12) && std::memcmp(data, ktx_identifier, 12) == 0)
+	{
+		_file_format = ImageContainerFormat::KTX;
+		_parse_ktx();
+	}
+	else if((size >= 4) && std::memcmp(data, "DDS ", 4) == 0)
+	{
+		_file_format = ImageContainerFormat::DDS;
+		_parse_dds();
+	}
+	else throw std::runtime_error("Unknown image container format");
+}
+
+OGLPLUS_LIB_FUNC
+void ImageContainer::_parse_ktx(void)
+{
+	using aux::ContainerU32;
+
+	_check(0, 64);
+	const GLubyte* header = _file.Data();
+	if(ContainerU32(header+12) != 0x04030201)
+	{
+		throw std::runtime_error("Unsupported KTX endianness");
+	}
+	_type = ContainerU32(header+16);
+	_format = ContainerU32(header+24);
+	_internal = ContainerU32(header+28);
+	_width = GLsizei(ContainerU32(header+36));
+	_height = std::max(GLsizei(ContainerU32(header+40)), 1);
+	_depth = std::max(GLsizei(ContainerU32(header+44)), 1);
+	const GLuint array_size = ContainerU32(header+48);
+	_layers = std::max(array_size, 1u);
+	_faces = ContainerU32(header+52);
+	_levels = std::max(ContainerU32(header+56), 1u);
+	if((_width <= 0) || ((_faces != 1) && (_faces != 6)))
+	{
+		throw std::runtime_error("Invalid KTX header");
+	}
+	_compressed = (_type == 0);
+	_pixel_size = _compressed?0:
+		aux::ContainerTypeSize(_type)*
+		aux::ContainerChannels(_format);
+	_alignment = 4;
+
+	std::size_t offset = 64+ContainerU32(header+60);
+	_views.reserve(_levels*_layers*_faces);
+	for(GLuint l=0; l!=_levels; ++l)
+	{
+		_check(offset, 4);
+		const std::size_t image_size = ContainerU32(_file.Data()+offset);
+		offset += 4;
+
+		if((_faces == 6) && (array_size == 0))
+		{
+			// non-array cube maps store the size of a single face
+			// and each face is padded to four bytes
+			for(GLuint f=0; f!=6; ++f)
+			{
+				_add_view(l, 0, f, offset, image_size);
+				offset += (image_size+3) & ~std::size_t(3);
+			}
+		}
+		else
+		{
+			const std::size_t slice_size = image_size/(_layers*_faces);
+			for(GLuint a=0; a!=_layers; ++a)
+			for(GLuint f=0; f!=_faces; ++f)
+			{
+				_add_view(l, a, f, offset, slice_size);
+				offset += slice_size;
+			}
+			offset = (offset+3) & ~std::size_t(3);
+		}
+	}
+}
+
+OGLPLUS_LIB_FUNC
+void ImageContainer::_parse_dds(void)
+{
+	using aux::ContainerU32;
+	using aux::ContainerFourCC;
+
+	_check(0, 128);
+	const GLubyte* header = _file.Data()+4;
+	_height = std::max(GLsizei(ContainerU32(header+8)), 1);
+	_width = GLsizei(ContainerU32(header+12));
+	_levels = std::max(ContainerU32(header+24), 1u);
+	const GLuint pf_flags = ContainerU32(header+76);
+	const GLuint fourcc = ContainerU32(header+80);
+	const GLuint bits = ContainerU32(header+84);
+	const GLuint red_mask = ContainerU32(header+88);
+	const GLuint caps2 = ContainerU32(header+108);
+
+	bool volume = (caps2 & 0x200000) != 0;
+	_faces = (caps2 & 0x200)?6:1;
+	_layers = 1;
+	_type = 0;
+	_format = 0;
+	_internal = 0;
+	_pixel_size = 0;
+	_alignment = 1;
+	std::size_t offset = 128;
+
+	const bool dx10 = (pf_flags & 0x4) && (fourcc == ContainerFourCC("DX10"));
+	if(dx10)
+	{
+		_check(offset, 20);
+		const GLubyte* ext = _file.Data()+offset;
+		const aux::ContainerDXGIFormat* format =
+			aux::ContainerFindDXGI(ContainerU32(ext));
+		if(!format)
+		{
+			throw std::runtime_error("Unsupported DXGI format");
+		}
+		_type = format->type;
+		_format = format->format;
+		_internal = format->internal;
+		volume = (ContainerU32(ext+4) == 4);
+		_faces = (ContainerU32(ext+8) & 0x4)?6:1;
+		_layers = std::max(ContainerU32(ext+12), 1u);
+		offset += 20;
+	}
+	else if(pf_flags & 0x4)
+	{
+		if(fourcc == ContainerFourCC("DXT1"))
+			_internal = GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+		else if(fourcc == ContainerFourCC("DXT3"))
+			_internal = GL_COMPRESSED_RGBA_S3TC_DXT3_EXT;
+		else if(fourcc == ContainerFourCC("DXT5"))
+			_internal = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+		else if(
+			(fourcc == ContainerFourCC("ATI1")) ||
+			(fourcc == ContainerFourCC("BC4U"))
+		) _internal = GL_COMPRESSED_RED_RGTC1;
+		else if(fourcc == ContainerFourCC("BC4S"))
+			_internal = GL_COMPRESSED_SIGNED_RED_RGTC1;
+		else if(
+			(fourcc == ContainerFourCC("ATI2")) ||
+			(fourcc == ContainerFourCC("BC5U"))
+		) _internal = GL_COMPRESSED_RG_RGTC2;
+		else if(fourcc == ContainerFourCC("BC5S"))
+			_internal = GL_COMPRESSED_SIGNED_RG_RGTC2;
+		// the D3DFORMAT codes of the floating-point formats
+		else if(fourcc == 36)
+		{
+			_type = GL_UNSIGNED_SHORT;
+			_format = GL_RGBA;
+			_internal = GL_RGBA16;
+		}
+		else if(fourcc == 111)
+		{
+			_type = GL_HALF_FLOAT;
+			_format = GL_RED;
+			_internal = GL_R16F;
+		}
+		else if(fourcc == 113)
+		{
+			_type = GL_HALF_FLOAT;
+			_format = GL_RGBA;
+			_internal = GL_RGBA16F;
+		}
+		else if(fourcc == 114)
+		{
+			_type = GL_FLOAT;
+			_format = GL_RED;
+			_internal = GL_R32F;
+		}
+		else if(fourcc == 116)
+		{
+			_type = GL_FLOAT;
+			_format = GL_RGBA;
+			_internal = GL_RGBA32F;
+		}
+	}
+	else if((pf_flags & 0x40) && ((bits == 32) || (bits == 24)))
+	{
+		_type = GL_UNSIGNED_BYTE;
+		if(red_mask == 0x000000FF)
+			_format = (bits == 32)?GL_RGBA:GL_RGB;
+		else if(red_mask == 0x00FF0000)
+			_format = (bits == 32)?GL_BGRA:GL_BGR;
+		_internal = (bits == 32)?GL_RGBA8:GL_RGB8;
+	}
+	else if((pf_flags & (0x20000 | 0x2)) && (bits == 8))
+	{
+		_type = GL_UNSIGNED_BYTE;
+		_format = GL_RED;
+		_internal = GL_R8;
+	}
+	else if((pf_flags & 0x20000) && (pf_flags & 0x1) && (bits == 16))
+	{
+		_type = GL_UNSIGNED_BYTE;
+		_format = GL_RG;
+		_internal = GL_RG8;
+	}
+
+	_compressed = (_type == 0);
+	const GLuint block_size = aux::ContainerBlockSize(_internal);
+	if(!_compressed)
+	{
+		_pixel_size =
+			aux::ContainerTypeSize(_type)*
+			aux::ContainerChannels(_format);
+	}
+	if((_compressed?block_size:_pixel_size) == 0)
+	{
+		throw std::runtime_error("Unsupported DDS pixel format");
+	}
+	if(!dx10 && (_faces == 6) && ((caps2 & 0xFC00) != 0xFC00))
+	{
+		throw std::runtime_error(
+			"Cube maps with missing faces are not supported"
+		);
+	}
+	_depth = volume?std::max(GLsizei(ContainerU32(header+20)), 1):1;
+	if(volume && ((_layers > 1) || (_faces > 1)))
+	{
+		throw std::runtime_error("Invalid DDS header");
+	}
+
+	// the file stores all levels of a layer/face before the next one
+	_views.resize(
+		_levels*_layers*_faces,
+		ImageContainerView(0, 0, 0, 0, 0, 0, nullptr, 0)
+	);
+	for(GLuint a=0; a!=_layers; ++a)
+	for(GLuint f=0; f!=_faces; ++f)
+	for(GLuint l=0; l!=_levels; ++l)
+	{
+		const std::size_t w = std::size_t(std::max(_width >> l, 1));
+		const std::size_t h = std::size_t(std::max(_height >> l, 1));
+		const std::size_t d = std::size_t(std::max(_depth >> l, 1));
+		const std::size_t size = _compressed?
+			((w+3)/4)*((h+3)/4)*d*block_size:
+			w*h*d*_pixel_size;
+		_check(offset, size);
+		_views[(l*_layers+a)*_faces+f] = ImageContainerView(
+			GLsizei(w), GLsizei(h), GLsizei(d),
+			l, a, f,
+			_file.Data()+offset,
+			size
+		);
+		offset += size;
+	}
+}
+
+OGLPLUS_LIB_FUNC
+std::size_t ImageContainer::LevelDataSize(GLuint level) const
+{
+	const GLuint n = _layers*_faces;
+	std::size_t size = 0;
+	for(GLuint i=0; i!=n; ++i)
+	{
+		size += _views[level*n+i].DataSize();
+	}
+	return size;
+}
+
+OGLPLUS_LIB_FUNC
+const GLubyte* ImageContainer::LevelData(
+	GLuint level,
+	std::vector<GLubyte>& buffer
+) const
+{
+	assert(level < _levels);
+	const GLuint n = _layers*_faces;
+	const ImageContainerView* views = _views.data()+level*n;
+	bool contiguous = true;
+	for(GLuint i=1; i<n; ++i)
+	{
+		if(views[i].Data() != views[i-1].Data()+views[i-1].DataSize())
+		{
+			contiguous = false;
+			break;
+		}
+	}
+	if(contiguous) return views[0].Data();
+
+	buffer.resize(LevelDataSize(level));
+	GLubyte* dest = buffer.data();
+	for(GLuint i=0; i!=n; ++i)
+	{
+		std::memcpy(dest, views[i].Data(), views[i].DataSize());
+		dest += views[i].DataSize();
+	}
+	return buffer.data();
+}
+
+OGLPLUS_LIB_FUNC
+Image ImageContainer::ToImage(
+	GLuint level,
+	bool y_is_up,
+	bool x_is_right
+) const
+{
+	std::vector<GLubyte> buffer;
+	const GLubyte* data = LevelData(level, buffer);
+	const ImageContainerView& view = View(level);
+	const GLsizei width = view.Width();
+	const GLsizei height = view.Height();
+	const GLsizei depth = view.Depth()*GLsizei(_layers*_faces);
+
+	if(_compressed)
+	{
+		BlockCompressionParams params;
+		if(!aux::ContainerBlockParams(_internal, params))
+		{
+			throw std::runtime_error(
+				"Unable to decompress this image format"
+			);
+		}
+		Image image = CompressedImage(
+			width, height, depth,
+			data,
+			params
+		).Decompress();
+		if(y_is_up && x_is_right) return image;
+
+		std::vector<GLubyte> pixels;
+		aux::ContainerReorient(
+			static_cast<const GLubyte*>(image.RawData()),
+			pixels,
+			width, height, depth,
+			std::size_t(image.Channels()),
+			!y_is_up,
+			!x_is_right
+		);
+		if(image.Type() == PixelDataType::Byte)
+		{
+			return Image(width, height, depth, image.Channels(),
+				reinterpret_cast<const GLbyte*>(pixels.data()),
+				image.Format(), image.InternalFormat()
+			);
+		}
+		return Image(width, height, depth, image.Channels(),
+			pixels.data(),
+			image.Format(), image.InternalFormat()
+		);
+	}
+
+	const GLuint type_size = aux::ContainerTypeSize(_type);
+	if((_pixel_size == 0) || (_type == GL_HALF_FLOAT))
+	{
+		throw std::runtime_error("Unsupported image pixel data type");
+	}
+	// remove the row padding
+	const std::size_t row = std::size_t(width)*_pixel_size;
+	const std::size_t stride = (row+_alignment-1)/_alignment*_alignment;
+	std::vector<GLubyte> pixels;
+	if(stride != row)
+	{
+		const std::size_t rows = std::size_t(height)*depth;
+		pixels.resize(row*rows);
+		for(std::size_t r=0; r!=rows; ++r)
+		{
+			std::memcpy(pixels.data()+r*row, data+r*stride, row);
+		}
+		data = pixels.data();
+	}
+	std::vector<GLubyte> reoriented;
+	data = aux::ContainerReorient(
+		data,
+		reoriented,
+		width, height, depth,
+		_pixel_size,
+		!y_is_up,
+		!x_is_right
+	);
+	const GLsizei channels = GLsizei(_pixel_size/type_size);
+	const PixelDataFormat format = Format();
+	const PixelDataInternalFormat internal = InternalFormat();
+	switch(_type)
+	{
+		case GL_UNSIGNED_BYTE:
+			return Image(width, height, depth, channels,
+				reinterpret_cast<const GLubyte*>(data),
+				format, internal
+			);
+		case GL_BYTE:
+			return Image(width, height, depth, channels,
+				reinterpret_cast<const GLbyte*>(data),
+				format, internal
+			);
+		case GL_UNSIGNED_SHORT:
+			return Image(width, height, depth, channels,
+				reinterpret_cast<const GLushort*>(data),
+				format, internal
+			);
+		case GL_SHORT:
+			return Image(width, height, depth, channels,
+				reinterpret_cast<const GLshort*>(data),
+				format, internal
+			);
+		case GL_UNSIGNED_INT:
+			return Image(width, height, depth, channels,
+				reinterpret_cast<const GLuint*>(data),
+				format, internal
+			);
+		case GL_INT:
+			return Image(width, height, depth, channels,
+				reinterpret_cast<const GLint*>(data),
+				format, internal
+			);
+		default:;
+	}
+	return Image(width, height, depth, channels,
+		reinterpret_cast<const GLfloat*>(data),
+		format, internal
+	);
+}
+
+OGLPLUS_LIB_FUNC
+void SaveKTX(
+	const std::string& path,
+	const MipmapChain& mipmaps,
+	bool cube_map
+)
+{
+	aux::ContainerSaveKTX(path, aux::ContainerDesc(mipmaps, cube_map));
+}
+
+OGLPLUS_LIB_FUNC
+void SaveKTX(
+	const std::string& path,
+	const CompressedMipmapChain& mipmaps,
+	bool cube_map
+)
+{
+	aux::ContainerSaveKTX(path, aux::ContainerDesc(mipmaps, cube_map));
+}
+
+OGLPLUS_LIB_FUNC
+void SaveDDS(
+	const std::string& path,
+	const MipmapChain& mipmaps,
+	bool cube_map
+)
+{
+	aux::ContainerSaveDDS(path, aux::ContainerDesc(mipmaps, cube_map));
+}
+
+OGLPLUS_LIB_FUNC
+void SaveDDS(
+	const std::string& path,
+	const CompressedMipmapChain& mipmaps,
+	bool cube_map
+)
+{
+	aux::ContainerSaveDDS(path, aux::ContainerDesc(mipmaps, cube_map));
+}
+
+} // namespace images
+} // namespace oglplus
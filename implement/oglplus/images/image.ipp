@@ -43,6 +43,36 @@ OGLPLUS_NOEXCEPT(true)
 	return PixelDataInternalFormat::Red;
 }
 
+OGLPLUS_LIB_FUNC
+bool Image::IsSRGB(void) const
+OGLPLUS_NOEXCEPT(true)
+{
+	switch(GLenum(InternalFormat()))
+	{
+#ifdef GL_SRGB
+		case GL_SRGB:
+#endif
+#ifdef GL_SRGB8
+		case GL_SRGB8:
+#endif
+#ifdef GL_SRGB_ALPHA
+		case GL_SRGB_ALPHA:
+#endif
+#ifdef GL_SRGB8_ALPHA8
+		case GL_SRGB8_ALPHA8:
+#endif
+#ifdef GL_COMPRESSED_SRGB
+		case GL_COMPRESSED_SRGB:
+#endif
+#ifdef GL_COMPRESSED_SRGB_ALPHA
+		case GL_COMPRESSED_SRGB_ALPHA:
+#endif
+			return true;
+		default:;
+	}
+	return false;
+}
+
 } // namespace images
 } // namespace oglplus
 
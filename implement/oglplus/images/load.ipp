@@ -4,7 +4,7 @@
  *
  *  @author Matus Chochlik
  *
- *  Copyright 2010-2014 Matus Chochlik. Distributed under the Boost
+ *  Copyright 2010-2015 Matus Chochlik. Distributed under the Boost
  *  Software License, Version 1.0. (See accompanying file
  *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
  */
@@ -17,6 +17,7 @@
 #include <oglplus/images/png.hpp>
 #endif
 #include <oglplus/images/xpm.hpp>
+#include <oglplus/images/container.hpp>
 #include <oglplus/lib/incl_end.ipp>
 
 #include <fstream>
@@ -33,17 +34,24 @@ Image LoadByName(
 	bool x_is_right
 )
 {
-	std::ifstream file;
-	const char* exts[] = {".png", ".xpm"};
+	std::string path;
+	const char* exts[] = {".png", ".xpm", ".ktx", ".dds"};
 	std::size_t nexts = sizeof(exts)/sizeof(exts[0]);
-	std::size_t iext = oglplus::FindResourceFile(
-		file,
+	std::size_t iext = oglplus::FindResourcePath(
+		path,
 		category,
 		name,
 		exts,
 		nexts
 	);
 
+	if(iext == nexts)
+		throw std::runtime_error("Unable to open image: "+name);
+	if(iext >= 2) //.ktx, .dds
+	{
+		return ImageContainer(path).ToImage(0, y_is_up, x_is_right);
+	}
+	std::ifstream file(path.c_str(), std::ios::binary);
 	if(!file.good())
 		throw std::runtime_error("Unable to open image: "+name);
 	if(iext == 0) //.png
@@ -62,6 +70,20 @@ Image LoadByName(
 	throw std::runtime_error("Unable to open this image type");
 }
 
+OGLPLUS_LIB_FUNC
+ImageContainer LoadContainerByName(
+	std::string category,
+	std::string name
+)
+{
+	std::string path;
+	const char* exts[] = {".ktx", ".dds"};
+	std::size_t nexts = sizeof(exts)/sizeof(exts[0]);
+	if(oglplus::FindResourcePath(path, category, name, exts, nexts) == nexts)
+		throw std::runtime_error("Unable to open image container: "+name);
+	return ImageContainer(path);
+}
+
 } // images
 } // oglplus
 
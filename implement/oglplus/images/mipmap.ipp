@@ -0,0 +1,441 @@
+/**
+ *  @file oglplus/images/mipmap.ipp
+ *  @brief Implementation of images::MipmapChain
+ *
+ *  @author Matus Chochlik
+ *
+ *  Copyright 2010-2015 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#include <oglplus/detail/parallel_for.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+namespace oglplus {
+namespace aux {
+
+inline double MipmapSinc(double x)
+{
+	if(std::fabs(x) < 1e-9) return 1.0;
+	x *= 3.14159265358979323846;
+	return std::sin(x)/x;
+}
+
+// the modified Bessel function of the first kind of order zero
+inline double MipmapBesselI0(double x)
+{
+	double sum = 1.0, term = 1.0;
+	const double q = x*x*0.25;
+	for(unsigned k=1; k!=32; ++k)
+	{
+		term *= q/(k*k);
+		sum += term;
+		if(term < sum*1e-12) break;
+	}
+	return sum;
+}
+
+inline double MipmapBox(double x)
+{
+	return ((x >= -0.5) && (x < 0.5))?1.0:0.0;
+}
+
+inline double MipmapKaiser(double x)
+{
+	const double width = 3.0, alpha = 4.0;
+	const double t = x/width;
+	if(t*t >= 1.0) return 0.0;
+	return	MipmapSinc(x)*
+		MipmapBesselI0(alpha*std::sqrt(1.0-t*t))/
+		MipmapBesselI0(alpha);
+}
+
+inline double MipmapLanczos(double x)
+{
+	if(std::fabs(x) >= 3.0) return 0.0;
+	return MipmapSinc(x)*MipmapSinc(x/3.0);
+}
+
+inline float MipmapSRGBToLinear(float v)
+{
+	if(v <= 0.04045f) return v/12.92f;
+	return float(std::pow((v+0.055)/1.055, 2.4));
+}
+
+inline float MipmapLinearToSRGB(float v)
+{
+	if(v <= 0.0f) return 0.0f;
+	if(v <= 0.0031308f) return v*12.92f;
+	if(v >= 1.0f) return 1.0f;
+	return float(1.055*std::pow(double(v), 1.0/2.4)-0.055);
+}
+
+// The source texels and their weights for each target texel
+class MipmapTaps
+{
+private:
+	std::size_t _taps;
+	std::vector<std::size_t> _index;
+	std::vector<float> _weight;
+public:
+	MipmapTaps(std::size_t src, std::size_t dst, images::MipmapFilter filter)
+	{
+		double (*kernel)(double) = &MipmapBox;
+		double support = 0.5;
+		switch(filter)
+		{
+			case images::MipmapFilter::Kaiser:
+				kernel = &MipmapKaiser;
+				support = 3.0;
+				break;
+			case images::MipmapFilter::Lanczos:
+				kernel = &MipmapLanczos;
+				support = 3.0;
+				break;
+			default:;
+		}
+		const double scale = double(src)/double(dst);
+		const double radius = support*scale;
+		_taps = std::size_t(std::ceil(2*radius))+2;
+		_index.resize(dst*_taps, 0);
+		_weight.resize(dst*_taps, 0.0f);
+
+		for(std::size_t i=0; i!=dst; ++i)
+		{
+			const double center = (i+0.5)*scale;
+			const long first = long(std::floor(center-radius));
+			std::size_t* index = _index.data()+i*_taps;
+			float* weight = _weight.data()+i*_taps;
+			double sum = 0.0;
+			for(std::size_t t=0; t!=_taps; ++t)
+			{
+				const long j = first+long(t);
+				const double w = kernel((j+0.5-center)/scale);
+				// clamp to edge
+				index[t] = std::size_t(std::min(
+					std::max(j, 0L),
+					long(src)-1
+				));
+				weight[t] = float(w);
+				sum += w;
+			}
+			if(sum != 0.0)
+			{
+				for(std::size_t t=0; t!=_taps; ++t)
+				{
+					weight[t] = float(weight[t]/sum);
+				}
+			}
+		}
+	}
+
+	std::size_t Taps(void) const
+	{
+		return _taps;
+	}
+
+	const std::size_t* Index(std::size_t i) const
+	{
+		return _index.data()+i*_taps;
+	}
+
+	const float* Weight(std::size_t i) const
+	{
+		return _weight.data()+i*_taps;
+	}
+};
+
+// Resamples the buffer viewed as [outer][src][inner] to [outer][dst][inner]
+inline void MipmapResample(
+	const std::vector<float>& input,
+	std::vector<float>& output,
+	std::size_t outer,
+	std::size_t src,
+	std::size_t dst,
+	std::size_t inner,
+	images::MipmapFilter filter,
+	unsigned threads
+)
+{
+	const MipmapTaps taps(src, dst, filter);
+	const std::size_t tap_count = taps.Taps();
+	output.assign(outer*dst*inner, 0.0f);
+
+	const float* in = input.data();
+	float* out = output.data();
+
+	ParallelFor(
+		outer*dst,
+		outer*dst*inner*tap_count,
+		threads,
+		[=, &taps](std::size_t begin, std::size_t end)
+		{
+			for(std::size_t item=begin; item!=end; ++item)
+			{
+				const std::size_t o = item / dst;
+				const std::size_t i = item % dst;
+				const std::size_t* index = taps.Index(i);
+				const float* weight = taps.Weight(i);
+				float* d = out+item*inner;
+				for(std::size_t t=0; t!=tap_count; ++t)
+				{
+					const float w = weight[t];
+					if(w == 0.0f) continue;
+					const float* s = in+(o*src+index[t])*inner;
+					// contiguous, vectorized by the compiler
+					for(std::size_t k=0; k!=inner; ++k)
+					{
+						d[k] += w*s[k];
+					}
+				}
+			}
+		}
+	);
+}
+
+template <typename T>
+inline void MipmapLoad(
+	const images::Image& image,
+	std::vector<float>& buffer,
+	const float* lut,
+	std::size_t srgb_channels
+)
+{
+	const T* data = image.Data<T>();
+	const float one = float(std::numeric_limits<T>::max());
+	const std::size_t ch = std::size_t(image.Channels());
+	if(!lut) srgb_channels = 0;
+	for(std::size_t p=0, n=buffer.size(); p!=n; p+=ch)
+	{
+		for(std::size_t c=0; c!=srgb_channels; ++c)
+		{
+			buffer[p+c] = lut[std::size_t(data[p+c])];
+		}
+		for(std::size_t c=srgb_channels; c!=ch; ++c)
+		{
+			buffer[p+c] = float(data[p+c])/one;
+		}
+	}
+}
+
+template <typename T>
+inline images::Image MipmapStore(
+	const images::Image& base,
+	const std::vector<float>& buffer,
+	GLsizei width,
+	GLsizei height,
+	GLsizei depth,
+	std::size_t srgb_channels,
+	float one,
+	const float* thresholds = nullptr
+)
+{
+	const std::size_t ch = std::size_t(base.Channels());
+	std::vector<T> data(buffer.size());
+	for(std::size_t p=0, n=buffer.size(); p!=n; p+=ch)
+	{
+		for(std::size_t c=0; c!=ch; ++c)
+		{
+			float v = buffer[p+c];
+			if(c < srgb_channels)
+			{
+				if(thresholds)
+				{
+					// the linear values halfway
+					// between the 8-bit codes
+					data[p+c] = T(std::upper_bound(
+						thresholds,
+						thresholds+255,
+						v
+					) - thresholds);
+					continue;
+				}
+				v = MipmapLinearToSRGB(v);
+			}
+			if(one != 0.0f)
+			{
+				v = std::min(std::max(v, 0.0f), 1.0f)*one+0.5f;
+			}
+			data[p+c] = T(v);
+		}
+	}
+	return images::Image(
+		width,
+		height,
+		depth,
+		base.Channels(),
+		data.data(),
+		base.Format(),
+		base.InternalFormat()
+	);
+}
+
+} // namespace aux
+namespace images {
+
+OGLPLUS_LIB_FUNC
+bool MipmapParams::IsSRGB(const Image& image) const
+{
+	if(_srgb >= 0) return _srgb > 0;
+	return image.IsSRGB();
+}
+
+OGLPLUS_LIB_FUNC
+unsigned MipmapParams::Threads(void) const
+{
+	return aux::ParallelThreads(_threads);
+}
+
+OGLPLUS_LIB_FUNC
+std::size_t MipmapChain::LevelCount(
+	GLsizei width,
+	GLsizei height,
+	GLsizei depth
+)
+{
+	GLsizei size = std::max(width, std::max(height, depth));
+	std::size_t levels = 1;
+	while(size > 1)
+	{
+		size /= 2;
+		++levels;
+	}
+	return levels;
+}
+
+OGLPLUS_LIB_FUNC
+void MipmapChain::_build(const Image& base, const MipmapParams& params)
+{
+	GLsizei w = base.Width(), h = base.Height(), d = base.Depth();
+	const std::size_t ch = std::size_t(base.Channels());
+	const bool layered = params.IsLayered();
+
+	std::size_t levels = LevelCount(w, h, layered?1:d);
+	if((params.MaxLevels() > 0) && (params.MaxLevels() < levels))
+	{
+		levels = params.MaxLevels();
+	}
+	_levels.reserve(levels);
+	_levels.push_back(Image(base));
+	if(levels == 1) return;
+
+	const std::size_t srgb = params.IsSRGB(base)?std::min(ch, std::size_t(3)):0;
+	const unsigned threads = params.Threads();
+
+	// the linear-space values of the current level
+	std::vector<float> current(std::size_t(w)*h*d*ch);
+	std::vector<float> temp;
+
+	float thresholds[255];
+	if(base.Type() == PixelDataType::UnsignedByte)
+	{
+		float lut[256];
+		for(unsigned i=0; i!=256; ++i)
+		{
+			lut[i] = aux::MipmapSRGBToLinear(i/255.0f);
+			if(i < 255)
+			{
+				thresholds[i] = aux::MipmapSRGBToLinear(
+					(i+0.5f)/255.0f
+				);
+			}
+		}
+		aux::MipmapLoad<GLubyte>(base, current, srgb?lut:nullptr, srgb);
+	}
+	else if(base.Type() == PixelDataType::UnsignedShort)
+	{
+		aux::MipmapLoad<GLushort>(base, current, nullptr, 0);
+	}
+	else if(base.Type() == PixelDataType::Float)
+	{
+		const GLfloat* data = base.Data<GLfloat>();
+		current.assign(data, data+current.size());
+	}
+	else
+	{
+		std::size_t i = 0;
+		for(GLsizei z=0; z!=d; ++z)
+		for(GLsizei y=0; y!=h; ++y)
+		for(GLsizei x=0; x!=w; ++x)
+		for(std::size_t c=0; c!=ch; ++c)
+		{
+			current[i++] = float(base.Component(x, y, z, GLsizei(c)));
+		}
+	}
+	if(srgb && (base.Type() != PixelDataType::UnsignedByte))
+	{
+		for(std::size_t p=0, n=current.size(); p!=n; p+=ch)
+		{
+			for(std::size_t c=0; c!=srgb; ++c)
+			{
+				current[p+c] = aux::MipmapSRGBToLinear(current[p+c]);
+			}
+		}
+	}
+
+	for(std::size_t level=1; level!=levels; ++level)
+	{
+		const GLsizei nw = std::max(w/2, 1);
+		const GLsizei nh = std::max(h/2, 1);
+		const GLsizei nd = layered?d:std::max(d/2, 1);
+
+		// separable filtering, one dimension at a time
+		if(nw != w)
+		{
+			aux::MipmapResample(
+				current, temp,
+				std::size_t(h)*d, w, nw, ch,
+				params.Filter(), threads
+			);
+			current.swap(temp);
+		}
+		if(nh != h)
+		{
+			aux::MipmapResample(
+				current, temp,
+				d, h, nh, std::size_t(nw)*ch,
+				params.Filter(), threads
+			);
+			current.swap(temp);
+		}
+		if(nd != d)
+		{
+			aux::MipmapResample(
+				current, temp,
+				1, d, nd, std::size_t(nw)*nh*ch,
+				params.Filter(), threads
+			);
+			current.swap(temp);
+		}
+		w = nw;
+		h = nh;
+		d = nd;
+
+		if(base.Type() == PixelDataType::UnsignedByte)
+		{
+			_levels.push_back(aux::MipmapStore<GLubyte>(
+				base, current, w, h, d, srgb, 255.0f,
+				thresholds
+			));
+		}
+		else if(base.Type() == PixelDataType::UnsignedShort)
+		{
+			_levels.push_back(aux::MipmapStore<GLushort>(
+				base, current, w, h, d, srgb, 65535.0f
+			));
+		}
+		else
+		{
+			_levels.push_back(aux::MipmapStore<GLfloat>(
+				base, current, w, h, d, srgb, 0.0f
+			));
+		}
+	}
+}
+
+} // namespace images
+} // namespace oglplus
+
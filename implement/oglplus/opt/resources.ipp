@@ -61,6 +61,35 @@ std::size_t FindResourceFile(
 	return nexts;
 }
 
+OGLPLUS_LIB_FUNC
+std::size_t FindResourcePath(
+	std::string& found,
+	const std::string& category,
+	const std::string& name,
+	const char** exts,
+	unsigned nexts
+)
+{
+	const std::string dirsep = aux::FilesysPathSep();
+	const std::string pardir(aux::FilesysPathParDir() + dirsep);
+	const std::string path = category+dirsep+name;
+	const std::string apppath = Application::RelativePath();
+	std::string prefix;
+
+	for(std::size_t i=0; i!=5; ++i)
+	{
+		for(unsigned e=0; e!=nexts; ++e)
+		{
+			found = apppath+prefix+path+exts[e];
+			std::ifstream file(found.c_str(), std::ios::binary);
+			if(file.good()) return e;
+		}
+		prefix = pardir + prefix;
+	}
+	found.clear();
+	return nexts;
+}
+
 OGLPLUS_LIB_FUNC
 ResourceFile::ResourceFile(
 	const std::string& category,
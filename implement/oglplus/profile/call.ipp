@@ -0,0 +1,320 @@
+/**
+ *  @file oglplus/profile/call.ipp
+ *  @brief Implementation of the GL call profiling
+ *
+ *  @author Matus Chochlik
+ *
+ *  Copyright 2010-2015 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+#include <ostream>
+#include <utility>
+
+namespace oglplus {
+namespace aux {
+
+// Registry of the profiled names and of the counters of the running threads
+struct GLCallProfileRegistry
+{
+	std::mutex mutex;
+	std::vector<std::pair<std::string, GLCallProfileKind>> names;
+	std::vector<GLCallCounters*> threads;
+	// the counts and times of the already finished threads
+	std::vector<unsigned long long> finished_counts;
+	std::vector<unsigned long long> finished_nanos;
+
+	// the first slots collect the functions and the classes
+	// which did not fit into the remaining ones
+	static const std::size_t FunctionOverflowSlot = 0;
+	static const std::size_t ClassOverflowSlot = 1;
+
+	GLCallProfileRegistry(void)
+	 : finished_counts(GLCallCounters::MaxSlots, 0)
+	 , finished_nanos(GLCallCounters::MaxSlots, 0)
+	{
+		names.push_back(
+			std::make_pair("(other)", GLCallProfileKind::Function)
+		);
+		names.push_back(
+			std::make_pair("(other)", GLCallProfileKind::Class)
+		);
+	}
+
+	static GLCallProfileRegistry& Get(void);
+};
+
+OGLPLUS_LIB_FUNC
+GLCallProfileRegistry& GLCallProfileRegistry::Get(void)
+{
+	static GLCallProfileRegistry registry;
+	return registry;
+}
+
+// Registers the counters of a thread for its lifetime
+class GLCallCountersHolder
+{
+private:
+	GLCallProfileRegistry& _registry;
+	GLCallCounters* _counters;
+
+	GLCallCountersHolder(const GLCallCountersHolder&);
+public:
+	GLCallCountersHolder(void)
+	 : _registry(GLCallProfileRegistry::Get())
+	 , _counters(new GLCallCounters())
+	{
+		std::lock_guard<std::mutex> lock(_registry.mutex);
+		_registry.threads.push_back(_counters);
+	}
+
+	~GLCallCountersHolder(void)
+	{
+		std::lock_guard<std::mutex> lock(_registry.mutex);
+		for(std::size_t s=0; s!=GLCallCounters::MaxSlots; ++s)
+		{
+			_registry.finished_counts[s] += _counters->Count(s);
+			_registry.finished_nanos[s] += _counters->Nanos(s);
+		}
+		_registry.threads.erase(std::remove(
+			_registry.threads.begin(),
+			_registry.threads.end(),
+			_counters
+		), _registry.threads.end());
+		delete _counters;
+	}
+
+	GLCallCounters& Counters(void)
+	{
+		return *_counters;
+	}
+};
+
+OGLPLUS_LIB_FUNC
+GLCallCounters::GLCallCounters(void)
+ : _last_nanos(0)
+{
+	for(std::size_t s=0; s!=MaxSlots; ++s)
+	{
+		_counts[s].store(0, std::memory_order_relaxed);
+		_nanos[s].store(0, std::memory_order_relaxed);
+	}
+}
+
+OGLPLUS_LIB_FUNC
+GLCallCounters& GLCallCounters::Local(void)
+{
+#if !OGLPLUS_NO_THREAD_LOCAL
+	static thread_local GLCallCountersHolder holder;
+#else
+	// without thread-local storage all threads share the counters
+	static GLCallCountersHolder holder;
+#endif
+	return holder.Counters();
+}
+
+OGLPLUS_LIB_FUNC
+std::size_t GLCallCounters::Slot(const char* name, GLCallProfileKind kind)
+{
+	GLCallProfileRegistry& registry = GLCallProfileRegistry::Get();
+	std::lock_guard<std::mutex> lock(registry.mutex);
+
+	const std::size_t n = registry.names.size();
+	for(std::size_t s=0; s!=n; ++s)
+	{
+		if(	(registry.names[s].second == kind) &&
+			(registry.names[s].first == name)
+		) return s;
+	}
+	if(n < MaxSlots)
+	{
+		registry.names.push_back(std::make_pair(name, kind));
+		return n;
+	}
+	// keep the overflowing functions and classes apart, so that
+	// the class times are not added to the GL call totals
+	return	(kind == GLCallProfileKind::Class)?
+		GLCallProfileRegistry::ClassOverflowSlot:
+		GLCallProfileRegistry::FunctionOverflowSlot;
+}
+
+} // namespace aux
+
+OGLPLUS_LIB_FUNC
+GLCallProfile GLCallProfile::Snapshot(void)
+{
+	aux::GLCallProfileRegistry& registry =
+		aux::GLCallProfileRegistry::Get();
+	std::lock_guard<std::mutex> lock(registry.mutex);
+
+	GLCallProfile result;
+	const std::size_t n = registry.names.size();
+	result._entries.resize(n);
+	for(std::size_t s=0; s!=n; ++s)
+	{
+		GLCallProfileEntry& entry = result._entries[s];
+		entry.name = registry.names[s].first;
+		entry.kind = registry.names[s].second;
+		entry.count = registry.finished_counts[s];
+		entry.nanoseconds = registry.finished_nanos[s];
+
+		for(auto i=registry.threads.begin(); i!=registry.threads.end(); ++i)
+		{
+			entry.count += (*i)->Count(s);
+			entry.nanoseconds += (*i)->Nanos(s);
+		}
+	}
+	return result;
+}
+
+OGLPLUS_LIB_FUNC
+GLCallProfile GLCallProfile::Since(const GLCallProfile& earlier) const
+{
+	// slots are never unregistered, so the earlier snapshot
+	// cannot have more entries and the indices are the same
+	assert(earlier._entries.size() <= _entries.size());
+	GLCallProfile result(*this);
+	for(std::size_t s=0, n=earlier._entries.size(); s!=n; ++s)
+	{
+		result._entries[s].count -= earlier._entries[s].count;
+		result._entries[s].nanoseconds -= earlier._entries[s].nanoseconds;
+	}
+	return result;
+}
+
+OGLPLUS_LIB_FUNC
+std::vector<GLCallProfileEntry>
+GLCallProfile::Sorted(GLCallProfileKind kind) const
+{
+	std::vector<GLCallProfileEntry> result;
+	for(auto i=_entries.begin(), e=_entries.end(); i!=e; ++i)
+	{
+		if((i->kind == kind) && (i->count > 0))
+		{
+			result.push_back(*i);
+		}
+	}
+	std::stable_sort(
+		result.begin(),
+		result.end(),
+		[](const GLCallProfileEntry& a, const GLCallProfileEntry& b)
+		{
+			return a.nanoseconds > b.nanoseconds;
+		}
+	);
+	return result;
+}
+
+OGLPLUS_LIB_FUNC
+const GLCallProfileEntry* GLCallProfile::Find(
+	const char* name,
+	GLCallProfileKind kind
+) const
+{
+	for(auto i=_entries.begin(), e=_entries.end(); i!=e; ++i)
+	{
+		if((i->kind == kind) && (i->name == name))
+		{
+			return &*i;
+		}
+	}
+	return nullptr;
+}
+
+OGLPLUS_LIB_FUNC
+unsigned long long GLCallProfile::CallCount(void) const
+{
+	unsigned long long result = 0;
+	for(auto i=_entries.begin(), e=_entries.end(); i!=e; ++i)
+	{
+		if(i->kind == GLCallProfileKind::Function)
+		{
+			result += i->count;
+		}
+	}
+	return result;
+}
+
+OGLPLUS_LIB_FUNC
+unsigned long long GLCallProfile::_total_nanos(void) const
+{
+	unsigned long long result = 0;
+	for(auto i=_entries.begin(), e=_entries.end(); i!=e; ++i)
+	{
+		if(i->kind == GLCallProfileKind::Function)
+		{
+			result += i->nanoseconds;
+		}
+	}
+	return result;
+}
+
+OGLPLUS_LIB_FUNC
+std::ostream& GLCallProfile::Report(std::ostream& out) const
+{
+	out	<< "GL calls: " << CallCount() << ", "
+		<< Time()*1e3 << " [ms]"
+		<< std::endl;
+
+	const char* headers[2] = {"Functions:", "Classes:"};
+	const char* prefixes[2] = {"gl", ""};
+	const GLCallProfileKind kinds[2] = {
+		GLCallProfileKind::Function,
+		GLCallProfileKind::Class
+	};
+	for(std::size_t k=0; k!=2; ++k)
+	{
+		std::vector<GLCallProfileEntry> entries = Sorted(kinds[k]);
+		if(entries.empty()) continue;
+
+		out << headers[k] << std::endl;
+		for(auto i=entries.begin(), e=entries.end(); i!=e; ++i)
+		{
+			out	<< "  " << prefixes[k] << i->name << ": "
+				<< i->count << " calls, "
+				<< i->Seconds()*1e6 << " [us], "
+				<< double(i->nanoseconds)/double(i->count)
+				<< " [ns/call]"
+				<< std::endl;
+		}
+	}
+	return out;
+}
+
+OGLPLUS_LIB_FUNC
+std::ostream& GLCallProfile::ReportJSON(std::ostream& out) const
+{
+	// the names are GL function and C++ class names
+	// so they do not need to be escaped
+	out << "{\"calls\":" << CallCount();
+	out << ",\"nanoseconds\":" << _total_nanos();
+
+	const char* keys[2] = {"functions", "classes"};
+	const GLCallProfileKind kinds[2] = {
+		GLCallProfileKind::Function,
+		GLCallProfileKind::Class
+	};
+	for(std::size_t k=0; k!=2; ++k)
+	{
+		std::vector<GLCallProfileEntry> entries = Sorted(kinds[k]);
+		out << ",\"" << keys[k] << "\":[";
+		for(auto i=entries.begin(), e=entries.end(); i!=e; ++i)
+		{
+			if(i != entries.begin()) out << ",";
+			out	<< "{\"name\":\"" << i->name << "\""
+				<< ",\"count\":" << i->count
+				<< ",\"nanoseconds\":" << i->nanoseconds
+				<< "}";
+		}
+		out << "]";
+	}
+	out << "}";
+	return out;
+}
+
+} // namespace oglplus
+
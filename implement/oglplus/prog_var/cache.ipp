@@ -0,0 +1,358 @@
+/**
+ *  @file oglplus/prog_var/cache.ipp
+ *  @brief Implementation of the program variable cache
+ *
+ *  @author Matus Chochlik
+ *
+ *  Copyright 2010-2015 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#include <oglplus/lib/incl_begin.ipp>
+#include <oglplus/glfunc.hpp>
+#include <oglplus/error/prog_var.hpp>
+#include <oglplus/lib/incl_end.ipp>
+#include <vector>
+#include <cstring>
+
+namespace oglplus {
+namespace aux {
+
+OGLPLUS_LIB_FUNC
+ProgVarCacheImpl::ProgVarCacheImpl(void)
+ : _generation(_shared().generation.load())
+{
+	_stats.hits = 0;
+	_stats.misses = 0;
+	_stats.fills = 0;
+	_stats.invalidations = 0;
+}
+
+OGLPLUS_LIB_FUNC
+ProgVarCacheImpl::_shared_t& ProgVarCacheImpl::_shared(void)
+{
+	static _shared_t shared;
+	return shared;
+}
+
+OGLPLUS_LIB_FUNC
+ProgVarCacheImpl& ProgVarCacheImpl::Local(void)
+{
+#if !OGLPLUS_NO_THREAD_LOCAL
+	static thread_local ProgVarCacheImpl cache;
+#else
+	// without thread-local storage all threads share the cache
+	static ProgVarCacheImpl cache;
+#endif
+	return cache;
+}
+
+OGLPLUS_LIB_FUNC
+void ProgVarCacheImpl::_sync(void)
+{
+	_shared_t& shared = _shared();
+	// a program has been invalidated (possibly in another thread)
+	if(_generation != shared.generation.load())
+	{
+		std::lock_guard<std::mutex> lock(shared.mutex);
+		for(auto i=_programs.begin(); i!=_programs.end(); )
+		{
+			auto p = shared.programs.find(i->first);
+			unsigned long generation =
+				(p != shared.programs.end())?p->second:0;
+			if(i->second.generation != generation)
+			{
+				i = _programs.erase(i);
+			}
+			else ++i;
+		}
+		_generation = shared.generation.load();
+	}
+}
+
+OGLPLUS_LIB_FUNC
+bool ProgVarCacheImpl::_fill(GLuint program, _program_t& cached)
+{
+	GLint linked = GL_FALSE;
+	OGLPLUS_GLFUNC(GetProgramiv)(program, GL_LINK_STATUS, &linked);
+	OGLPLUS_CHECK(
+		GetProgramiv,
+		ProgVarError,
+		Program(ProgramName(program))
+	);
+	// the uniforms of unlinked programs are not known yet
+	if(linked != GL_TRUE) return false;
+
+	GLint count = 0;
+	OGLPLUS_GLFUNC(GetProgramiv)(program, GL_ACTIVE_UNIFORMS, &count);
+	OGLPLUS_VERIFY(
+		GetProgramiv,
+		ProgVarError,
+		Program(ProgramName(program))
+	);
+
+	GLint max_length = 0;
+	OGLPLUS_GLFUNC(GetProgramiv)(
+		program,
+		GL_ACTIVE_UNIFORM_MAX_LENGTH,
+		&max_length
+	);
+	OGLPLUS_VERIFY(
+		GetProgramiv,
+		ProgVarError,
+		Program(ProgramName(program))
+	);
+
+	{
+		_shared_t& shared = _shared();
+		std::lock_guard<std::mutex> lock(shared.mutex);
+		auto p = shared.programs.find(program);
+		cached.generation = (p != shared.programs.end())?p->second:0;
+	}
+
+	std::vector<GLint> block_indices(count, -1);
+#if GL_VERSION_3_1 || GL_ARB_uniform_buffer_object
+	if(count > 0)
+	{
+		std::vector<GLuint> indices(count);
+		for(GLint i=0; i!=count; ++i)
+		{
+			indices[i] = GLuint(i);
+		}
+		OGLPLUS_GLFUNC(GetActiveUniformsiv)(
+			program,
+			count,
+			indices.data(),
+			GL_UNIFORM_BLOCK_INDEX,
+			block_indices.data()
+		);
+		OGLPLUS_VERIFY(
+			GetActiveUniformsiv,
+			ProgVarError,
+			Program(ProgramName(program))
+		);
+	}
+#endif
+
+	std::vector<GLchar> buffer(max_length>0?max_length:1, '\0');
+	for(GLint index=0; index!=count; ++index)
+	{
+		GLsizei length = 0;
+		ProgVarCacheEntry entry;
+		OGLPLUS_GLFUNC(GetActiveUniform)(
+			program,
+			GLuint(index),
+			GLsizei(buffer.size()),
+			&length,
+			&entry.size,
+			&entry.type,
+			buffer.data()
+		);
+		OGLPLUS_VERIFY(
+			GetActiveUniform,
+			ProgVarError,
+			Program(ProgramName(program))
+		);
+		std::string name(buffer.data(), length);
+
+		// the members of uniform blocks do not have locations
+		entry.block_index = block_indices[index];
+		if(entry.block_index < 0)
+		{
+			entry.location = OGLPLUS_GLFUNC(GetUniformLocation)(
+				program,
+				name.c_str()
+			);
+			OGLPLUS_VERIFY(
+				GetUniformLocation,
+				ProgVarError,
+				Program(ProgramName(program)).
+				Identifier(name)
+			);
+		}
+		else entry.location = -1;
+		entry.listed = true;
+
+		// arrays are listed with the [0] suffix but can be
+		// looked up also without it
+		const std::size_t sl = 3;
+		if(	(name.size() > sl) &&
+			(name.compare(name.size()-sl, sl, "[0]") == 0)
+		)
+		{
+			ProgVarCacheEntry alias = entry;
+			alias.listed = false;
+			cached.uniforms.insert(std::make_pair(
+				name.substr(0, name.size()-sl),
+				alias
+			));
+		}
+		cached.uniforms[name] = entry;
+	}
+	cached.filled = true;
+	++_stats.fills;
+	return true;
+}
+
+OGLPLUS_LIB_FUNC
+const ProgVarCacheEntry* ProgVarCacheImpl::FindUniform(
+	GLuint program,
+	StrCRef identifier,
+	bool query
+)
+{
+	_sync();
+
+	_key.assign(identifier.begin(), identifier.end());
+	auto pos = _programs.find(program);
+	if(pos == _programs.end())
+	{
+		pos = _programs.insert(std::make_pair(program, _program_t())).first;
+	}
+	_program_t& cached = pos->second;
+
+	if(!cached.filled)
+	{
+		if(!_fill(program, cached))
+		{
+			_programs.erase(pos);
+			++_stats.misses;
+			return nullptr;
+		}
+	}
+
+	auto var = cached.uniforms.find(_key);
+	if(var != cached.uniforms.end())
+	{
+		++_stats.hits;
+		return &var->second;
+	}
+	if(!query)
+	{
+		++_stats.hits;
+		return nullptr;
+	}
+	++_stats.misses;
+
+	// array elements, structure members given in a different
+	// way than listed, inactive uniforms, etc.
+	ProgVarCacheEntry entry;
+	entry.location = OGLPLUS_GLFUNC(GetUniformLocation)(
+		program,
+		_key.c_str()
+	);
+	OGLPLUS_CHECK(
+		GetUniformLocation,
+		ProgVarError,
+		Program(ProgramName(program)).
+		Identifier(identifier)
+	);
+	entry.type = GL_NONE;
+	entry.size = 1;
+	entry.block_index = -1;
+	entry.listed = false;
+
+	return &(cached.uniforms[_key] = entry);
+}
+
+OGLPLUS_LIB_FUNC
+void ProgVarCacheImpl::Invalidate(GLuint program)
+{
+	_shared_t& shared = _shared();
+	{
+		std::lock_guard<std::mutex> lock(shared.mutex);
+		++shared.programs[program];
+		++shared.generation;
+	}
+	_programs.erase(program);
+	++_stats.invalidations;
+}
+
+OGLPLUS_LIB_FUNC
+void ProgVarCacheImpl::Clear(void)
+{
+	_programs.clear();
+	++_stats.invalidations;
+}
+
+} // namespace aux
+
+OGLPLUS_LIB_FUNC
+GLint ProgVarCache::UniformLocation(ProgramName program, StrCRef identifier)
+{
+	aux::ProgVarCacheImpl& cache = aux::ProgVarCacheImpl::Local();
+	const ProgVarCacheEntry* entry = cache.FindUniform(
+		GetGLName(program),
+		identifier,
+		true
+	);
+	if(entry) return entry->location;
+
+	// the program is not linked, let the GL report the error
+	std::string name(identifier.begin(), identifier.end());
+	GLint result = OGLPLUS_GLFUNC(GetUniformLocation)(
+		GetGLName(program),
+		name.c_str()
+	);
+	OGLPLUS_CHECK(
+		GetUniformLocation,
+		ProgVarError,
+		Program(program).
+		Identifier(identifier)
+	);
+	return result;
+}
+
+OGLPLUS_LIB_FUNC
+GLenum ProgVarCache::UniformType(ProgramName program, StrCRef identifier)
+{
+	const ProgVarCacheEntry* entry = FindUniform(program, identifier);
+	return entry?entry->type:GLenum(GL_NONE);
+}
+
+OGLPLUS_LIB_FUNC
+const ProgVarCacheEntry* ProgVarCache::FindUniform(
+	ProgramName program,
+	StrCRef identifier
+)
+{
+	const ProgVarCacheEntry* entry =
+		aux::ProgVarCacheImpl::Local().FindUniform(
+			GetGLName(program),
+			identifier,
+			false
+		);
+	return (entry && entry->listed)?entry:nullptr;
+}
+
+OGLPLUS_LIB_FUNC
+void ProgVarCache::Invalidate(ProgramName program)
+{
+	aux::ProgVarCacheImpl::Local().Invalidate(GetGLName(program));
+}
+
+OGLPLUS_LIB_FUNC
+void ProgVarCache::Clear(void)
+{
+	aux::ProgVarCacheImpl::Local().Clear();
+}
+
+OGLPLUS_LIB_FUNC
+ProgVarCacheStats ProgVarCache::Stats(void)
+{
+	return aux::ProgVarCacheImpl::Local().Stats();
+}
+
+OGLPLUS_LIB_FUNC
+void ProgVarCache::ResetStats(void)
+{
+	ProgVarCacheStats& stats = aux::ProgVarCacheImpl::Local().Stats();
+	stats.hits = 0;
+	stats.misses = 0;
+	stats.fills = 0;
+	stats.invalidations = 0;
+}
+
+} // namespace oglplus
+
@@ -0,0 +1,325 @@
+/**
+ *  @file oglplus/prog_var/shadow.ipp
+ *  @brief Implementation of the uniform value shadowing
+ *
+ *  @author Matus Chochlik
+ *
+ *  Copyright 2010-2015 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#include <cstring>
+
+namespace oglplus {
+namespace aux {
+
+OGLPLUS_LIB_FUNC
+UniformShadowState::UniformShadowState(void)
+ : _last_name(0)
+ , _last_program(nullptr)
+ , _generation(_shared().generation.load())
+ , _error_count(ErrorCheckState::Current().ErrorCount())
+{
+	_stats.writes = 0;
+	_stats.skips = 0;
+}
+
+OGLPLUS_LIB_FUNC
+UniformShadowState::_shared_t& UniformShadowState::_shared(void)
+{
+	static _shared_t shared;
+	return shared;
+}
+
+OGLPLUS_LIB_FUNC
+UniformShadowState& UniformShadowState::Local(void)
+{
+#if !OGLPLUS_NO_THREAD_LOCAL
+	static thread_local UniformShadowState state;
+#else
+	// without thread-local storage all threads share the shadows
+	static UniformShadowState state;
+#endif
+	return state;
+}
+
+OGLPLUS_LIB_FUNC
+void UniformShadowState::_sync(void)
+{
+	// a deferred check reported an error, some of the shadowed
+	// writes might have failed
+	const unsigned long errors = ErrorCheckState::Current().ErrorCount();
+	if(_error_count != errors)
+	{
+		Clear();
+		_error_count = errors;
+	}
+
+	_shared_t& shared = _shared();
+	// a program has been invalidated (possibly in another thread)
+	if(_generation != shared.generation.load())
+	{
+		std::lock_guard<std::mutex> lock(shared.mutex);
+		for(auto i=_programs.begin(); i!=_programs.end(); )
+		{
+			auto p = shared.programs.find(i->first);
+			unsigned long generation =
+				(p != shared.programs.end())?p->second:0;
+			if(i->second.generation != generation)
+			{
+				i = _programs.erase(i);
+			}
+			else ++i;
+		}
+		_reset_last();
+		_generation = shared.generation.load();
+	}
+}
+
+OGLPLUS_LIB_FUNC
+bool UniformShadowState::_is_excluded(
+	GLuint program,
+	std::size_t location
+) const
+{
+	auto pos = _excluded.find(program);
+	if(pos == _excluded.end()) return false;
+	return (location < pos->second.size()) && pos->second[location];
+}
+
+OGLPLUS_LIB_FUNC
+UniformShadowState::_program_t*
+UniformShadowState::_find(GLuint program)
+{
+	_sync();
+	if(_last_name == program)
+	{
+		return _last_program;
+	}
+	auto pos = _programs.find(program);
+	if(pos == _programs.end())
+	{
+		return nullptr;
+	}
+	_last_name = program;
+	_last_program = &pos->second;
+	return _last_program;
+}
+
+OGLPLUS_LIB_FUNC
+UniformShadowState::_value_t*
+UniformShadowState::_values(GLuint program, GLint location, std::size_t count)
+{
+	_program_t* cached = _find(program);
+	if(!cached)
+	{
+		unsigned long generation = 0;
+		{
+			_shared_t& shared = _shared();
+			std::lock_guard<std::mutex> lock(shared.mutex);
+			auto p = shared.programs.find(program);
+			if(p != shared.programs.end()) generation = p->second;
+		}
+		cached = &_programs[program];
+		cached->generation = generation;
+		_last_name = program;
+		_last_program = cached;
+	}
+	const std::size_t end = std::size_t(location)+count;
+	if(cached->values.size() < end)
+	{
+		_value_t invalid;
+		invalid.signature = 0u;
+		invalid.size = 0u;
+		invalid.valid = false;
+		invalid.excluded = false;
+		std::size_t l = cached->values.size();
+		cached->values.resize(end, invalid);
+		// re-apply the exclusions to the new values
+		for(; l!=end; ++l)
+		{
+			cached->values[l].excluded = _is_excluded(program, l);
+		}
+	}
+	return cached->values.data()+location;
+}
+
+OGLPLUS_LIB_FUNC
+bool UniformShadowState::Unchanged(
+	GLuint program,
+	GLint location,
+	unsigned signature,
+	const void* data,
+	std::size_t size,
+	std::size_t count
+)
+{
+	if((program == 0) || (location < 0)) return false;
+
+	_program_t* cached = _find(program);
+	if(!cached) return false;
+	if(cached->values.size() < std::size_t(location)+count) return false;
+
+	const _value_t* values = cached->values.data()+location;
+	const unsigned char* bytes = static_cast<const unsigned char*>(data);
+	for(std::size_t i=0; i!=count; ++i)
+	{
+		const _value_t& value = values[i];
+		if(	!value.valid ||
+			(value.signature != signature) ||
+			(value.size != size) ||
+			(std::memcmp(value.bytes, bytes, size) != 0)
+		) return false;
+		bytes += size;
+	}
+	++_stats.skips;
+	return true;
+}
+
+OGLPLUS_LIB_FUNC
+void UniformShadowState::Store(
+	GLuint program,
+	GLint location,
+	unsigned signature,
+	const void* data,
+	std::size_t size,
+	std::size_t count
+)
+{
+	++_stats.writes;
+	if((program == 0) || (location < 0)) return;
+
+	if(size > MaxValueSize)
+	{
+		Forget(program, location, count);
+		return;
+	}
+
+	_value_t* values = _values(program, location, count);
+	const unsigned char* bytes = static_cast<const unsigned char*>(data);
+	for(std::size_t i=0; i!=count; ++i)
+	{
+		_value_t& value = values[i];
+		if(!value.excluded)
+		{
+			value.signature = signature;
+			value.size = (unsigned short)(size);
+			value.valid = true;
+			std::memcpy(value.bytes, bytes, size);
+		}
+		bytes += size;
+	}
+}
+
+OGLPLUS_LIB_FUNC
+void UniformShadowState::Exclude(GLuint program, GLint location, bool exclude)
+{
+	if((program == 0) || (location < 0)) return;
+
+	std::vector<bool>& excluded = _excluded[program];
+	if(excluded.size() <= std::size_t(location))
+	{
+		excluded.resize(std::size_t(location)+1, false);
+	}
+	excluded[std::size_t(location)] = exclude;
+
+	_value_t& value = *_values(program, location, 1);
+	value.excluded = exclude;
+	value.valid = false;
+}
+
+OGLPLUS_LIB_FUNC
+void UniformShadowState::Forget(
+	GLuint program,
+	GLint location,
+	std::size_t count
+)
+{
+	if((program == 0) || (location < 0)) return;
+
+	_program_t* cached = _find(program);
+	if(!cached) return;
+
+	const std::size_t end = std::size_t(location)+count;
+	for(std::size_t l=std::size_t(location); l<end; ++l)
+	{
+		if(l >= cached->values.size()) break;
+		cached->values[l].valid = false;
+	}
+}
+
+OGLPLUS_LIB_FUNC
+void UniformShadowState::Invalidate(GLuint program)
+{
+	_shared_t& shared = _shared();
+	{
+		std::lock_guard<std::mutex> lock(shared.mutex);
+		++shared.programs[program];
+		++shared.generation;
+	}
+	_programs.erase(program);
+	_reset_last();
+}
+
+OGLPLUS_LIB_FUNC
+void UniformShadowState::Clear(void)
+{
+	_programs.clear();
+	_reset_last();
+}
+
+} // namespace aux
+
+OGLPLUS_LIB_FUNC
+void UniformShadow::Exclude(ProgramName program, GLint location, bool exclude)
+{
+	aux::UniformShadowState::Local().Exclude(
+		GetGLName(program),
+		location,
+		exclude
+	);
+}
+
+OGLPLUS_LIB_FUNC
+void UniformShadow::Invalidate(
+	ProgramName program,
+	GLint location,
+	std::size_t count
+)
+{
+	aux::UniformShadowState::Local().Forget(
+		GetGLName(program),
+		location,
+		count
+	);
+}
+
+OGLPLUS_LIB_FUNC
+void UniformShadow::Invalidate(ProgramName program)
+{
+	aux::UniformShadowState::Local().Invalidate(GetGLName(program));
+}
+
+OGLPLUS_LIB_FUNC
+void UniformShadow::Clear(void)
+{
+	aux::UniformShadowState::Local().Clear();
+}
+
+OGLPLUS_LIB_FUNC
+UniformShadowStats UniformShadow::Stats(void)
+{
+	return aux::UniformShadowState::Local().Stats();
+}
+
+OGLPLUS_LIB_FUNC
+void UniformShadow::ResetStats(void)
+{
+	UniformShadowStats& stats = aux::UniformShadowState::Local().Stats();
+	stats.writes = 0;
+	stats.skips = 0;
+}
+
+} // namespace oglplus
+
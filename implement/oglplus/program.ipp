@@ -70,12 +70,34 @@ ObjectOps<tag::DirectState, tag::Program>&
 ObjectOps<tag::DirectState, tag::Program>::
 Link(void)
 {
+	return LinkAsync().CheckLinked();
+}
+
+OGLPLUS_LIB_FUNC
+ObjectOps<tag::DirectState, tag::Program>&
+ObjectOps<tag::DirectState, tag::Program>::
+LinkAsync(void)
+{
+#if OGLPLUS_CACHE_PROG_VARS
+	ProgVarCache::Invalidate(*this);
+#endif
+#if OGLPLUS_SHADOW_UNIFORM_VALUES
+	UniformShadow::Invalidate(*this);
+#endif
 	OGLPLUS_GLFUNC(LinkProgram)(_obj_name());
 	OGLPLUS_CHECK(
 		LinkProgram,
 		ObjectError,
 		Object(*this)
 	);
+	return *this;
+}
+
+OGLPLUS_LIB_FUNC
+ObjectOps<tag::DirectState, tag::Program>&
+ObjectOps<tag::DirectState, tag::Program>::
+CheckLinked(void)
+{
 	OGLPLUS_HANDLE_ERROR_IF(
 		!IsLinked(),
 		GL_INVALID_OPERATION,
@@ -288,6 +310,12 @@ OGLPLUS_LIB_FUNC
 void ObjectOps<tag::DirectState, tag::Program>::
 Binary(const std::vector<GLubyte>& binary, GLenum format)
 {
+#if OGLPLUS_CACHE_PROG_VARS
+	ProgVarCache::Invalidate(*this);
+#endif
+#if OGLPLUS_SHADOW_UNIFORM_VALUES
+	UniformShadow::Invalidate(*this);
+#endif
 	OGLPLUS_GLFUNC(ProgramBinary)(
 		_obj_name(),
 		format,
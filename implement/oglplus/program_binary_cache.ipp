@@ -0,0 +1,380 @@
+/**
+ *  @file oglplus/program_binary_cache.ipp
+ *  @brief Implementation of the program binary cache
+ *
+ *  @author Matus Chochlik
+ *
+ *  Copyright 2010-2015 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#include <oglplus/lib/incl_begin.ipp>
+#include <oglplus/error/program.hpp>
+#include <oglplus/lib/incl_end.ipp>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+namespace oglplus {
+
+#if OGLPLUS_DOCUMENTATION_ONLY || GL_VERSION_4_1 || GL_ARB_get_program_binary
+
+namespace aux {
+
+// FNV-1a
+inline std::uint64_t ProgBinHash(
+	std::uint64_t hash,
+	const void* data,
+	std::size_t size
+)
+{
+	const unsigned char* bytes = static_cast<const unsigned char*>(data);
+	for(std::size_t i=0; i!=size; ++i)
+	{
+		hash ^= bytes[i];
+		hash *= 0x100000001b3ull;
+	}
+	return hash;
+}
+
+// hashes also the size so that the concatenation is unambiguous
+inline std::uint64_t ProgBinHash(std::uint64_t hash, const String& str)
+{
+	std::uint64_t size = str.size();
+	hash = ProgBinHash(hash, &size, sizeof(size));
+	return ProgBinHash(hash, str.data(), str.size());
+}
+
+struct ProgBinHeader
+{
+	char magic[8];
+	std::uint64_t check;
+	std::uint32_t format;
+	std::uint32_t size;
+};
+
+inline const char* ProgBinMagic(void)
+{
+	// the last character is the version of the file layout
+	return "OGLPLBC1";
+}
+
+} // namespace aux
+
+OGLPLUS_LIB_FUNC
+ProgramSources& ProgramSources::Add(ShaderType type, const GLSLSource& source)
+{
+	String text;
+	const GLchar* const* parts = source.Parts();
+	const GLint* lengths = source.Lengths();
+	for(GLsizei i=0, n=source.Count(); i!=n; ++i)
+	{
+		if(lengths && (lengths[i] >= 0))
+		{
+			text.append(parts[i], std::size_t(lengths[i]));
+		}
+		else text.append(parts[i]);
+	}
+	_shaders.push_back(std::make_pair(type, std::move(text)));
+	return *this;
+}
+
+OGLPLUS_LIB_FUNC
+ProgramSources& ProgramSources::Define(StrCRef name, StrCRef value)
+{
+	_defines.push_back(std::make_pair(name.str(), value.str()));
+	return *this;
+}
+
+OGLPLUS_LIB_FUNC
+String ProgramSources::Source(std::size_t index) const
+{
+	const String& text = _shaders[index].second;
+	if(_defines.empty()) return text;
+
+	String defines;
+	for(auto i=_defines.begin(), e=_defines.end(); i!=e; ++i)
+	{
+		defines.append("#define ");
+		defines.append(i->first);
+		defines.append(" ");
+		defines.append(i->second);
+		defines.append("\n");
+	}
+
+	// the version directive must precede everything else
+	std::size_t pos = text.find_first_not_of(" \t\r\n");
+	if((pos != String::npos) && (text.compare(pos, 8, "#version") == 0))
+	{
+		pos = text.find('\n', pos);
+		if(pos == String::npos)
+		{
+			return text+"\n"+defines;
+		}
+		++pos;
+		std::size_t line = 1;
+		for(std::size_t i=0; i!=pos; ++i)
+		{
+			if(text[i] == '\n') ++line;
+		}
+		String result(text, 0, pos);
+		result.append(defines);
+		// keep the line numbers in the compiler messages
+		result.append("#line ");
+		result.append(std::to_string(line));
+		result.append("\n");
+		result.append(text, pos, String::npos);
+		return result;
+	}
+	return defines+"#line 1\n"+text;
+}
+
+OGLPLUS_LIB_FUNC
+std::uint64_t ProgramSources::Hash(std::uint64_t seed) const
+{
+	std::uint64_t hash = seed;
+	for(std::size_t i=0, n=_shaders.size(); i!=n; ++i)
+	{
+		std::uint32_t type = std::uint32_t(GLenum(_shaders[i].first));
+		hash = aux::ProgBinHash(hash, &type, sizeof(type));
+		hash = aux::ProgBinHash(hash, Source(i));
+	}
+	unsigned char separable = _separable?1:0;
+	return aux::ProgBinHash(hash, &separable, sizeof(separable));
+}
+
+OGLPLUS_LIB_FUNC
+ProgramBinaryCache::ProgramBinaryCache(String directory)
+ : _directory(std::move(directory))
+{
+	const GLenum queries[4] = {
+		GL_VENDOR,
+		GL_RENDERER,
+		GL_VERSION,
+		GL_SHADING_LANGUAGE_VERSION
+	};
+	for(std::size_t q=0; q!=4; ++q)
+	{
+		const GLubyte* str = OGLPLUS_GLFUNC(GetString)(queries[q]);
+		OGLPLUS_VERIFY(
+			GetString,
+			Error,
+			EnumParam(queries[q])
+		);
+		if(str) _driver.append((const char*)str);
+		_driver.append("\n");
+	}
+	if(!_directory.empty())
+	{
+		const char last = _directory[_directory.size()-1];
+		if((last != '/') && (last != '\\'))
+		{
+			_directory.append("/");
+		}
+	}
+	ResetStats();
+}
+
+OGLPLUS_LIB_FUNC
+bool ProgramBinaryCache::IsSupported(void)
+{
+	GLint count = 0;
+	OGLPLUS_GLFUNC(GetIntegerv)(GL_NUM_PROGRAM_BINARY_FORMATS, &count);
+	OGLPLUS_VERIFY(
+		GetIntegerv,
+		Error,
+		EnumParam(GLenum(GL_NUM_PROGRAM_BINARY_FORMATS))
+	);
+	return count > 0;
+}
+
+OGLPLUS_LIB_FUNC
+void ProgramBinaryCache::ResetStats(void)
+{
+	_stats.hits = 0;
+	_stats.misses = 0;
+	_stats.rejected = 0;
+	_stats.stored = 0;
+	_stats.write_failures = 0;
+}
+
+OGLPLUS_LIB_FUNC
+std::uint64_t ProgramBinaryCache::_hash(
+	const ProgramSources& sources,
+	std::uint64_t seed
+) const
+{
+	return sources.Hash(aux::ProgBinHash(seed, _driver));
+}
+
+OGLPLUS_LIB_FUNC
+String ProgramBinaryCache::Path(const ProgramSources& sources) const
+{
+	char name[24];
+	std::snprintf(
+		name, sizeof(name),
+		"%016llx.bin",
+		(unsigned long long)_hash(sources, 0xcbf29ce484222325ull)
+	);
+	return _directory+name;
+}
+
+OGLPLUS_LIB_FUNC
+bool ProgramBinaryCache::_load(Program& program, const ProgramSources& sources)
+{
+	const String path = Path(sources);
+	std::FILE* file = std::fopen(path.c_str(), "rb");
+	if(!file) return false;
+
+	aux::ProgBinHeader header;
+	std::vector<GLubyte> binary;
+	bool valid = std::fread(&header, sizeof(header), 1, file) == 1;
+	if(valid)
+	{
+		// a different seed makes collisions of the names detectable
+		valid =	(std::memcmp(header.magic, aux::ProgBinMagic(), 8) == 0) &&
+			(header.check == _hash(sources, 0x84222325cbf29ce4ull));
+	}
+	if(valid)
+	{
+		binary.resize(header.size);
+		valid = std::fread(binary.data(), 1, binary.size(), file) ==
+			binary.size();
+	}
+	std::fclose(file);
+
+	if(valid)
+	{
+		try
+		{
+			if(sources.IsSeparable()) program.MakeSeparable();
+			program.Binary(binary, GLenum(header.format));
+			if(program.IsLinked()) return true;
+		}
+		// the format is not supported (anymore)
+		catch(Error&) { }
+	}
+	// the file is corrupted or rejected by the GL
+	++_stats.rejected;
+	std::remove(path.c_str());
+	return false;
+}
+
+OGLPLUS_LIB_FUNC
+void ProgramBinaryCache::_compile(
+	Program& program,
+	const ProgramSources& sources
+)
+{
+	for(std::size_t i=0, n=sources.ShaderCount(); i!=n; ++i)
+	{
+		// the shaders are deleted when they are detached
+		Shader shader(sources.Type(i));
+		shader.Source(GLSLSource(sources.Source(i)));
+		shader.Compile();
+		program.AttachShader(shader);
+	}
+	if(sources.IsSeparable()) program.MakeSeparable();
+	program.MakeRetrievable();
+	program.Link();
+
+	Program::ShaderRange shaders = program.AttachedShaders();
+	while(!shaders.Empty())
+	{
+		program.DetachShader(shaders.Front());
+		shaders.Next();
+	}
+}
+
+OGLPLUS_LIB_FUNC
+void ProgramBinaryCache::_store(
+	const Program& program,
+	const ProgramSources& sources
+)
+{
+	std::vector<GLubyte> binary;
+	GLenum format = GL_NONE;
+	program.GetBinary(binary, format);
+	if(binary.empty())
+	{
+		++_stats.write_failures;
+		return;
+	}
+
+	aux::ProgBinHeader header;
+	std::memcpy(header.magic, aux::ProgBinMagic(), 8);
+	header.check = _hash(sources, 0x84222325cbf29ce4ull);
+	header.format = std::uint32_t(format);
+	header.size = std::uint32_t(binary.size());
+
+	// the binary is written into an uniquely named temporary file
+	// and then renamed so that the readers never see partial files
+	static std::atomic<unsigned long> counter(0);
+	const String path = Path(sources);
+	char suffix[64];
+	std::snprintf(
+		suffix, sizeof(suffix),
+		".%lx.%lx.tmp",
+		(unsigned long)(counter++),
+		(unsigned long)(std::chrono::steady_clock::now().
+			time_since_epoch().count())
+	);
+	const String temp_path = path+suffix;
+
+	std::FILE* file = std::fopen(temp_path.c_str(), "wb");
+	if(!file)
+	{
+		++_stats.write_failures;
+		return;
+	}
+	bool written =
+		(std::fwrite(&header, sizeof(header), 1, file) == 1) &&
+		(std::fwrite(binary.data(), 1, binary.size(), file) ==
+			binary.size());
+	written = (std::fclose(file) == 0) && written;
+
+	if(written && (std::rename(temp_path.c_str(), path.c_str()) != 0))
+	{
+		// some systems do not replace existing files
+		std::remove(path.c_str());
+		written = std::rename(temp_path.c_str(), path.c_str()) == 0;
+	}
+	if(written) ++_stats.stored;
+	else
+	{
+		std::remove(temp_path.c_str());
+		++_stats.write_failures;
+	}
+}
+
+OGLPLUS_LIB_FUNC
+Program ProgramBinaryCache::Build(const ProgramSources& sources)
+{
+	{
+		Program program;
+		if(_load(program, sources))
+		{
+			++_stats.hits;
+			return program;
+		}
+	}
+	++_stats.misses;
+	// a new program without the state of the rejected binary
+	Program program;
+	_compile(program, sources);
+	_store(program, sources);
+	return program;
+}
+
+OGLPLUS_LIB_FUNC
+bool ProgramBinaryCache::Remove(const ProgramSources& sources)
+{
+	return std::remove(Path(sources).c_str()) == 0;
+}
+
+#endif // get program binary
+
+} // namespace oglplus
+
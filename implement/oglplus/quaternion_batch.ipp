@@ -0,0 +1,670 @@
+/**
+ *  @file oglplus/quaternion_batch.ipp
+ *  @brief Implementation of the batch quaternion operations
+ *
+ *  @author Matus Chochlik
+ *
+ *  Copyright 2010-2015 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#include <oglplus/config/simd.hpp>
+#include <cmath>
+#include <cassert>
+#if OGLPLUS_USE_AVX
+#include <immintrin.h>
+#elif OGLPLUS_USE_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace oglplus {
+namespace aux {
+
+// The kernels below are written once for a "pack" of values, which is
+// a single float for the scalar path and a SIMD register otherwise
+
+struct QuatBatchScalar
+{
+	typedef GLfloat V;
+
+	static std::size_t Width(void) { return 1; }
+
+	static V Load(const GLfloat* p) { return *p; }
+	static void Store(GLfloat* p, V v) { *p = v; }
+	static V Set(GLfloat v) { return v; }
+
+	static V Add(V a, V b) { return a+b; }
+	static V Sub(V a, V b) { return a-b; }
+	static V Mul(V a, V b) { return a*b; }
+	static V Div(V a, V b) { return a/b; }
+
+	static V InvSqrt(V v) { return 1.0f/std::sqrt(v); }
+
+	// negates x where s is negative
+	static V FlipSign(V x, V s) { return (s < 0.0f)?-x:x; }
+
+	// stores the values of the l-th lane of c0-c3 to dst[l]+offs
+	static void StoreTransposed(
+		GLfloat* const* dst,
+		std::size_t offs,
+		V c0, V c1, V c2, V c3
+	)
+	{
+		GLfloat* p = dst[0]+offs;
+		p[0] = c0;
+		p[1] = c1;
+		p[2] = c2;
+		p[3] = c3;
+	}
+};
+
+#if OGLPLUS_USE_AVX
+struct QuatBatchSIMD
+{
+	typedef __m256 V;
+
+	static std::size_t Width(void) { return 8; }
+
+	static V Load(const GLfloat* p) { return _mm256_loadu_ps(p); }
+	static void Store(GLfloat* p, V v) { _mm256_storeu_ps(p, v); }
+	static V Set(GLfloat v) { return _mm256_set1_ps(v); }
+
+	static V Add(V a, V b) { return _mm256_add_ps(a, b); }
+	static V Sub(V a, V b) { return _mm256_sub_ps(a, b); }
+	static V Mul(V a, V b) { return _mm256_mul_ps(a, b); }
+	static V Div(V a, V b) { return _mm256_div_ps(a, b); }
+
+	static V InvSqrt(V v)
+	{
+		// one Newton-Raphson step: r*(1.5 - 0.5*v*r*r)
+		const V r = _mm256_rsqrt_ps(v);
+		return Mul(r, Sub(
+			Set(1.5f),
+			Mul(Mul(Set(0.5f), v), Mul(r, r))
+		));
+	}
+
+	static V FlipSign(V x, V s)
+	{
+		return _mm256_xor_ps(x, _mm256_and_ps(s, Set(-0.0f)));
+	}
+
+	static void StoreTransposed(
+		GLfloat* const* dst,
+		std::size_t offs,
+		V c0, V c1, V c2, V c3
+	)
+	{
+		// transposes the 4x4 blocks in both halves of the registers
+		const V t0 = _mm256_unpacklo_ps(c0, c1);
+		const V t1 = _mm256_unpackhi_ps(c0, c1);
+		const V t2 = _mm256_unpacklo_ps(c2, c3);
+		const V t3 = _mm256_unpackhi_ps(c2, c3);
+		const V r0 = _mm256_shuffle_ps(t0, t2, 0x44);
+		const V r1 = _mm256_shuffle_ps(t0, t2, 0xEE);
+		const V r2 = _mm256_shuffle_ps(t1, t3, 0x44);
+		const V r3 = _mm256_shuffle_ps(t1, t3, 0xEE);
+		_mm_storeu_ps(dst[0]+offs, _mm256_castps256_ps128(r0));
+		_mm_storeu_ps(dst[1]+offs, _mm256_castps256_ps128(r1));
+		_mm_storeu_ps(dst[2]+offs, _mm256_castps256_ps128(r2));
+		_mm_storeu_ps(dst[3]+offs, _mm256_castps256_ps128(r3));
+		_mm_storeu_ps(dst[4]+offs, _mm256_extractf128_ps(r0, 1));
+		_mm_storeu_ps(dst[5]+offs, _mm256_extractf128_ps(r1, 1));
+		_mm_storeu_ps(dst[6]+offs, _mm256_extractf128_ps(r2, 1));
+		_mm_storeu_ps(dst[7]+offs, _mm256_extractf128_ps(r3, 1));
+	}
+};
+#elif OGLPLUS_USE_SSE2
+struct QuatBatchSIMD
+{
+	typedef __m128 V;
+
+	static std::size_t Width(void) { return 4; }
+
+	static V Load(const GLfloat* p) { return _mm_loadu_ps(p); }
+	static void Store(GLfloat* p, V v) { _mm_storeu_ps(p, v); }
+	static V Set(GLfloat v) { return _mm_set1_ps(v); }
+
+	static V Add(V a, V b) { return _mm_add_ps(a, b); }
+	static V Sub(V a, V b) { return _mm_sub_ps(a, b); }
+	static V Mul(V a, V b) { return _mm_mul_ps(a, b); }
+	static V Div(V a, V b) { return _mm_div_ps(a, b); }
+
+	static V InvSqrt(V v)
+	{
+		const V r = _mm_rsqrt_ps(v);
+		return Mul(r, Sub(
+			Set(1.5f),
+			Mul(Mul(Set(0.5f), v), Mul(r, r))
+		));
+	}
+
+	static V FlipSign(V x, V s)
+	{
+		return _mm_xor_ps(x, _mm_and_ps(s, Set(-0.0f)));
+	}
+
+	static void StoreTransposed(
+		GLfloat* const* dst,
+		std::size_t offs,
+		V c0, V c1, V c2, V c3
+	)
+	{
+		_MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+		_mm_storeu_ps(dst[0]+offs, c0);
+		_mm_storeu_ps(dst[1]+offs, c1);
+		_mm_storeu_ps(dst[2]+offs, c2);
+		_mm_storeu_ps(dst[3]+offs, c3);
+	}
+};
+#endif
+
+// calls kernel(S(), i) for the packs of the SIMD width and then
+// for the remaining elements one by one
+template <typename Kernel>
+inline void QuatBatchRun(std::size_t n, const Kernel& kernel)
+{
+	std::size_t i = 0;
+#if OGLPLUS_USE_AVX || OGLPLUS_USE_SSE2
+	const std::size_t w = QuatBatchSIMD::Width();
+	for(; i+w <= n; i+=w)
+	{
+		kernel(QuatBatchSIMD(), i);
+	}
+#endif
+	for(; i!=n; ++i)
+	{
+		kernel(QuatBatchScalar(), i);
+	}
+}
+
+struct QuatBatchPtrs
+{
+	const GLfloat *a, *x, *y, *z;
+
+	QuatBatchPtrs(const QuaternionArray& q)
+	 : a(q.A())
+	 , x(q.X())
+	 , y(q.Y())
+	 , z(q.Z())
+	{ }
+};
+
+struct QuatBatchOutPtrs
+{
+	GLfloat *a, *x, *y, *z;
+
+	QuatBatchOutPtrs(QuaternionArray& q)
+	 : a(q.A())
+	 , x(q.X())
+	 , y(q.Y())
+	 , z(q.Z())
+	{ }
+
+	template <typename S>
+	void Store(
+		std::size_t i,
+		typename S::V va,
+		typename S::V vx,
+		typename S::V vy,
+		typename S::V vz
+	) const
+	{
+		S::Store(a+i, va);
+		S::Store(x+i, vx);
+		S::Store(y+i, vy);
+		S::Store(z+i, vz);
+	}
+};
+
+struct QuatBatchMultiply
+{
+	QuatBatchPtrs p, q;
+	QuatBatchOutPtrs r;
+
+	template <typename S>
+	void operator()(S, std::size_t i) const
+	{
+		typedef typename S::V V;
+		const V pa = S::Load(p.a+i), px = S::Load(p.x+i);
+		const V py = S::Load(p.y+i), pz = S::Load(p.z+i);
+		const V qa = S::Load(q.a+i), qx = S::Load(q.x+i);
+		const V qy = S::Load(q.y+i), qz = S::Load(q.z+i);
+
+		r.Store<S>(
+			i,
+			S::Sub(
+				S::Sub(S::Mul(pa, qa), S::Mul(px, qx)),
+				S::Add(S::Mul(py, qy), S::Mul(pz, qz))
+			),
+			S::Add(
+				S::Add(S::Mul(pa, qx), S::Mul(px, qa)),
+				S::Sub(S::Mul(py, qz), S::Mul(pz, qy))
+			),
+			S::Add(
+				S::Sub(S::Mul(pa, qy), S::Mul(px, qz)),
+				S::Add(S::Mul(py, qa), S::Mul(pz, qx))
+			),
+			S::Add(
+				S::Add(S::Mul(pa, qz), S::Mul(px, qy)),
+				S::Sub(S::Mul(pz, qa), S::Mul(py, qx))
+			)
+		);
+	}
+};
+
+struct QuatBatchNormalize
+{
+	QuatBatchOutPtrs q;
+
+	template <typename S>
+	void operator()(S, std::size_t i) const
+	{
+		typedef typename S::V V;
+		const V a = S::Load(q.a+i), x = S::Load(q.x+i);
+		const V y = S::Load(q.y+i), z = S::Load(q.z+i);
+		const V im = S::InvSqrt(S::Add(
+			S::Add(S::Mul(a, a), S::Mul(x, x)),
+			S::Add(S::Mul(y, y), S::Mul(z, z))
+		));
+		q.Store<S>(
+			i,
+			S::Mul(a, im),
+			S::Mul(x, im),
+			S::Mul(y, im),
+			S::Mul(z, im)
+		);
+	}
+};
+
+struct QuatBatchRotate
+{
+	QuatBatchPtrs q;
+	const GLfloat *vx, *vy, *vz;
+	GLfloat *rx, *ry, *rz;
+
+	template <typename S>
+	void operator()(S, std::size_t i) const
+	{
+		typedef typename S::V V;
+		const V a = S::Load(q.a+i), x = S::Load(q.x+i);
+		const V y = S::Load(q.y+i), z = S::Load(q.z+i);
+		const V px = S::Load(vx+i), py = S::Load(vy+i), pz = S::Load(vz+i);
+
+		// t = 2*cross(u, v), v' = v + a*t + cross(u, t)
+		const V two = S::Set(2.0f);
+		const V tx = S::Mul(two, S::Sub(S::Mul(y, pz), S::Mul(z, py)));
+		const V ty = S::Mul(two, S::Sub(S::Mul(z, px), S::Mul(x, pz)));
+		const V tz = S::Mul(two, S::Sub(S::Mul(x, py), S::Mul(y, px)));
+
+		S::Store(rx+i, S::Add(
+			S::Add(px, S::Mul(a, tx)),
+			S::Sub(S::Mul(y, tz), S::Mul(z, ty))
+		));
+		S::Store(ry+i, S::Add(
+			S::Add(py, S::Mul(a, ty)),
+			S::Sub(S::Mul(z, tx), S::Mul(x, tz))
+		));
+		S::Store(rz+i, S::Add(
+			S::Add(pz, S::Mul(a, tz)),
+			S::Sub(S::Mul(x, ty), S::Mul(y, tx))
+		));
+	}
+};
+
+struct QuatBatchInterpolate
+{
+	QuatBatchPtrs p, q;
+	const GLfloat* t;
+	bool per_element;
+	QuatBatchOutPtrs r;
+
+	QuatBatchInterpolate(
+		const QuaternionArray& q1,
+		const QuaternionArray& q2,
+		const GLfloat* factors,
+		bool factor_per_element,
+		QuaternionArray& result
+	): p(q1)
+	 , q(q2)
+	 , t(factors)
+	 , per_element(factor_per_element)
+	 , r(result)
+	{ }
+
+	template <typename S>
+	typename S::V Factor(std::size_t i) const
+	{
+		return per_element?S::Load(t+i):S::Set(*t);
+	}
+
+	// loads the pair, negates the second quaternion if the dot product
+	// is negative and returns the absolute value of the dot product
+	template <typename S>
+	typename S::V Prepare(
+		std::size_t i,
+		typename S::V& pa, typename S::V& px,
+		typename S::V& py, typename S::V& pz,
+		typename S::V& qa, typename S::V& qx,
+		typename S::V& qy, typename S::V& qz
+	) const
+	{
+		typedef typename S::V V;
+		pa = S::Load(p.a+i); px = S::Load(p.x+i);
+		py = S::Load(p.y+i); pz = S::Load(p.z+i);
+		qa = S::Load(q.a+i); qx = S::Load(q.x+i);
+		qy = S::Load(q.y+i); qz = S::Load(q.z+i);
+
+		const V d = S::Add(
+			S::Add(S::Mul(pa, qa), S::Mul(px, qx)),
+			S::Add(S::Mul(py, qy), S::Mul(pz, qz))
+		);
+		qa = S::FlipSign(qa, d);
+		qx = S::FlipSign(qx, d);
+		qy = S::FlipSign(qy, d);
+		qz = S::FlipSign(qz, d);
+		return S::FlipSign(d, d);
+	}
+};
+
+struct QuatBatchNLERP
+ : QuatBatchInterpolate
+{
+	QuatBatchNLERP(
+		const QuaternionArray& q1,
+		const QuaternionArray& q2,
+		const GLfloat* factors,
+		bool factor_per_element,
+		QuaternionArray& result
+	): QuatBatchInterpolate(q1, q2, factors, factor_per_element, result)
+	{ }
+
+	template <typename S>
+	void operator()(S, std::size_t i) const
+	{
+		typedef typename S::V V;
+		V pa, px, py, pz, qa, qx, qy, qz;
+		Prepare<S>(i, pa, px, py, pz, qa, qx, qy, qz);
+
+		const V c1 = Factor<S>(i);
+		const V c0 = S::Sub(S::Set(1.0f), c1);
+		const V a = S::Add(S::Mul(pa, c0), S::Mul(qa, c1));
+		const V x = S::Add(S::Mul(px, c0), S::Mul(qx, c1));
+		const V y = S::Add(S::Mul(py, c0), S::Mul(qy, c1));
+		const V z = S::Add(S::Mul(pz, c0), S::Mul(qz, c1));
+		const V im = S::InvSqrt(S::Add(
+			S::Add(S::Mul(a, a), S::Mul(x, x)),
+			S::Add(S::Mul(y, y), S::Mul(z, z))
+		));
+		r.Store<S>(
+			i,
+			S::Mul(a, im),
+			S::Mul(x, im),
+			S::Mul(y, im),
+			S::Mul(z, im)
+		);
+	}
+};
+
+struct QuatBatchSLERP
+ : QuatBatchInterpolate
+{
+	QuatBatchSLERP(
+		const QuaternionArray& q1,
+		const QuaternionArray& q2,
+		const GLfloat* factors,
+		bool factor_per_element,
+		QuaternionArray& result
+	): QuatBatchInterpolate(q1, q2, factors, factor_per_element, result)
+	{ }
+
+	// The number of terms of the series
+	//  sin(t*w)/sin(w) = t*(1 + b1*(1 + b2*(1 + ...)))
+	//  b[i] = (t*t - i*i)/(i*(2*i+1))*(cos(w) - 1)
+	// which is exact for infinitely many terms. The last term is scaled
+	// by 1+mu to compensate for the truncation, mu was fitted to minimize
+	// the maximal error for cos(w) in [0, 1] and t in [0, 1]
+	static std::size_t Terms(void) { return 12; }
+
+	static GLfloat TermU(std::size_t i)
+	{
+		const GLfloat mu = (i == Terms())?1.892f:1.0f;
+		return mu/GLfloat(i*(2*i+1));
+	}
+
+	static GLfloat TermV(std::size_t i)
+	{
+		const GLfloat mu = (i == Terms())?1.892f:1.0f;
+		return mu*GLfloat(i)/GLfloat(2*i+1);
+	}
+
+	template <typename S>
+	void operator()(S, std::size_t i) const
+	{
+		typedef typename S::V V;
+		V pa, px, py, pz, qa, qx, qy, qz;
+		const V d = Prepare<S>(i, pa, px, py, pz, qa, qx, qy, qz);
+
+		const V one = S::Set(1.0f);
+		const V t1 = Factor<S>(i);
+		const V t0 = S::Sub(one, t1);
+		const V tt0 = S::Mul(t0, t0);
+		const V tt1 = S::Mul(t1, t1);
+		const V dm1 = S::Sub(d, one);
+
+		V s0 = one, s1 = one;
+		for(std::size_t k=Terms(); k!=0; --k)
+		{
+			const V u = S::Set(TermU(k));
+			const V v = S::Set(TermV(k));
+			s0 = S::Add(one, S::Mul(
+				S::Mul(S::Sub(S::Mul(u, tt0), v), dm1),
+				s0
+			));
+			s1 = S::Add(one, S::Mul(
+				S::Mul(S::Sub(S::Mul(u, tt1), v), dm1),
+				s1
+			));
+		}
+		const V c0 = S::Mul(t0, s0);
+		const V c1 = S::Mul(t1, s1);
+
+		r.Store<S>(
+			i,
+			S::Add(S::Mul(pa, c0), S::Mul(qa, c1)),
+			S::Add(S::Mul(px, c0), S::Mul(qx, c1)),
+			S::Add(S::Mul(py, c0), S::Mul(qy, c1)),
+			S::Add(S::Mul(pz, c0), S::Mul(qz, c1))
+		);
+	}
+};
+
+template <std::size_t Rows>
+struct QuatBatchToMatrices
+{
+	QuatBatchPtrs q;
+	const GLfloat *tx, *ty, *tz;
+	Matrix<GLfloat, Rows, 4>* m;
+
+	template <typename S>
+	void operator()(S, std::size_t i) const
+	{
+		typedef typename S::V V;
+		const V a = S::Load(q.a+i), x = S::Load(q.x+i);
+		const V y = S::Load(q.y+i), z = S::Load(q.z+i);
+
+		// s = 2/|q|^2 makes the result independent of the magnitude
+		const V s = S::Div(S::Set(2.0f), S::Add(
+			S::Add(S::Mul(a, a), S::Mul(x, x)),
+			S::Add(S::Mul(y, y), S::Mul(z, z))
+		));
+		const V xs = S::Mul(x, s), ys = S::Mul(y, s), zs = S::Mul(z, s);
+		const V ax = S::Mul(a, xs), ay = S::Mul(a, ys), az = S::Mul(a, zs);
+		const V xx = S::Mul(x, xs), xy = S::Mul(x, ys), xz = S::Mul(x, zs);
+		const V yy = S::Mul(y, ys), yz = S::Mul(y, zs), zz = S::Mul(z, zs);
+		const V one = S::Set(1.0f);
+
+		const V zero = S::Set(0.0f);
+		const V ox = tx?S::Load(tx+i):zero;
+		const V oy = ty?S::Load(ty+i):zero;
+		const V oz = tz?S::Load(tz+i):zero;
+
+		// the matrices are not const, only Data is
+		GLfloat* dst[8];
+		for(std::size_t l=0, w=S::Width(); l!=w; ++l)
+		{
+			dst[l] = const_cast<GLfloat*>(m[i+l].Data());
+		}
+		S::StoreTransposed(dst, 0,
+			S::Sub(one, S::Add(yy, zz)),
+			S::Sub(xy, az),
+			S::Add(xz, ay),
+			ox
+		);
+		S::StoreTransposed(dst, 4,
+			S::Add(xy, az),
+			S::Sub(one, S::Add(xx, zz)),
+			S::Sub(yz, ax),
+			oy
+		);
+		S::StoreTransposed(dst, 8,
+			S::Sub(xz, ay),
+			S::Add(yz, ax),
+			S::Sub(one, S::Add(xx, yy)),
+			oz
+		);
+		if(Rows == 4)
+		{
+			S::StoreTransposed(dst, 12, zero, zero, zero, one);
+		}
+	}
+};
+
+} // namespace aux
+
+OGLPLUS_LIB_FUNC
+void QuaternionBatch::Multiply(
+	const QuaternionArray& q1,
+	const QuaternionArray& q2,
+	QuaternionArray& result
+)
+{
+	assert(q1.Size() == q2.Size());
+	result.Resize(q1.Size());
+	aux::QuatBatchMultiply kernel = {q1, q2, result};
+	aux::QuatBatchRun(q1.Size(), kernel);
+}
+
+OGLPLUS_LIB_FUNC
+void QuaternionBatch::Normalize(QuaternionArray& q)
+{
+	aux::QuatBatchNormalize kernel = {q};
+	aux::QuatBatchRun(q.Size(), kernel);
+}
+
+OGLPLUS_LIB_FUNC
+void QuaternionBatch::Rotate(
+	const QuaternionArray& q,
+	const Vec3Array& vectors,
+	Vec3Array& result
+)
+{
+	assert(q.Size() == vectors.Size());
+	result.Resize(q.Size());
+	aux::QuatBatchRotate kernel = {
+		q,
+		vectors.X(), vectors.Y(), vectors.Z(),
+		result.X(), result.Y(), result.Z()
+	};
+	aux::QuatBatchRun(q.Size(), kernel);
+}
+
+OGLPLUS_LIB_FUNC
+void QuaternionBatch::_nlerp(
+	const QuaternionArray& q1,
+	const QuaternionArray& q2,
+	const GLfloat* t,
+	bool per_element,
+	QuaternionArray& result
+)
+{
+	assert(q1.Size() == q2.Size());
+	result.Resize(q1.Size());
+	aux::QuatBatchNLERP kernel(q1, q2, t, per_element, result);
+	aux::QuatBatchRun(q1.Size(), kernel);
+}
+
+OGLPLUS_LIB_FUNC
+void QuaternionBatch::_slerp(
+	const QuaternionArray& q1,
+	const QuaternionArray& q2,
+	const GLfloat* t,
+	bool per_element,
+	QuaternionArray& result
+)
+{
+	assert(q1.Size() == q2.Size());
+	result.Resize(q1.Size());
+	aux::QuatBatchSLERP kernel(q1, q2, t, per_element, result);
+	aux::QuatBatchRun(q1.Size(), kernel);
+}
+
+template <std::size_t Rows>
+inline void QuaternionBatch::_to_matrices(
+	const QuaternionArray& rotations,
+	const Vec3Array* translations,
+	std::vector<Matrix<GLfloat, Rows, 4> >& matrices
+)
+{
+	assert(!translations || translations->Size() == rotations.Size());
+	matrices.resize(rotations.Size());
+	aux::QuatBatchToMatrices<Rows> kernel = {
+		rotations,
+		translations?translations->X():nullptr,
+		translations?translations->Y():nullptr,
+		translations?translations->Z():nullptr,
+		matrices.data()
+	};
+	aux::QuatBatchRun(rotations.Size(), kernel);
+}
+
+OGLPLUS_LIB_FUNC
+void QuaternionBatch::ToMatrices(
+	const QuaternionArray& rotations,
+	std::vector<Matrix<GLfloat, 4, 4> >& matrices
+)
+{
+	_to_matrices<4>(rotations, nullptr, matrices);
+}
+
+OGLPLUS_LIB_FUNC
+void QuaternionBatch::ToMatrices(
+	const QuaternionArray& rotations,
+	const Vec3Array& translations,
+	std::vector<Matrix<GLfloat, 4, 4> >& matrices
+)
+{
+	_to_matrices<4>(rotations, &translations, matrices);
+}
+
+OGLPLUS_LIB_FUNC
+void QuaternionBatch::ToMatrices(
+	const QuaternionArray& rotations,
+	std::vector<Matrix<GLfloat, 3, 4> >& matrices
+)
+{
+	_to_matrices<3>(rotations, nullptr, matrices);
+}
+
+OGLPLUS_LIB_FUNC
+void QuaternionBatch::ToMatrices(
+	const QuaternionArray& rotations,
+	const Vec3Array& translations,
+	std::vector<Matrix<GLfloat, 3, 4> >& matrices
+)
+{
+	_to_matrices<3>(rotations, &translations, matrices);
+}
+
+} // namespace oglplus
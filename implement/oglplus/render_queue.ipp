@@ -0,0 +1,458 @@
+/**
+ *  @file oglplus/render_queue.ipp
+ *  @brief Implementation of the render queue
+ *
+ *  @author Matus Chochlik
+ *
+ *  Copyright 2010-2015 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#include <oglplus/lib/incl_begin.ipp>
+#include <oglplus/texture.hpp>
+#include <oglplus/lib/incl_end.ipp>
+#include <algorithm>
+#include <cstring>
+#include <cassert>
+
+namespace oglplus {
+
+OGLPLUS_LIB_FUNC
+RenderQueue::RenderQueue(GLfloat depth_near, GLfloat depth_far)
+ : _sorted(true)
+ , _depth_near(depth_near)
+ , _depth_far(depth_far)
+{
+	assert(_depth_near != _depth_far);
+}
+
+OGLPLUS_LIB_FUNC
+GLuint RenderQueue::_intern(
+	std::unordered_map<std::uint64_t, GLuint>& ids,
+	std::uint64_t value
+)
+{
+	auto pos = ids.find(value);
+	if(pos == ids.end())
+	{
+		// the ids exceeding the width of the key field wrap around,
+		// this only makes the sorting less efficient
+		pos = ids.insert(pos, std::make_pair(value, GLuint(ids.size())));
+	}
+	return pos->second;
+}
+
+OGLPLUS_LIB_FUNC
+std::uint64_t RenderQueue::_hash(std::uint64_t hash, std::uint64_t value)
+{
+	// FNV-1a
+	hash ^= value;
+	hash *= 1099511628211ull;
+	return hash;
+}
+
+OGLPLUS_LIB_FUNC
+std::uint64_t RenderQueue::_state_hash(const RenderQueueState& state)
+{
+	std::uint64_t hash = 14695981039346656037ull;
+	hash = _hash(hash, state.blend?1:0);
+	if(state.blend)
+	{
+		const context::BlendFunctionSeparate& bf = state.blend_function;
+		hash = _hash(hash, GLenum(bf.SrcRGB()));
+		hash = _hash(hash, GLenum(bf.SrcAlpha()));
+		hash = _hash(hash, GLenum(bf.DstRGB()));
+		hash = _hash(hash, GLenum(bf.DstAlpha()));
+	}
+	hash = _hash(hash, state.depth_test?1:0);
+	if(state.depth_test)
+	{
+		hash = _hash(hash, GLenum(state.depth_function));
+	}
+	hash = _hash(hash, state.depth_mask?1:0);
+	return hash;
+}
+
+OGLPLUS_LIB_FUNC
+std::uint64_t RenderQueue::_texture_hash(const RenderQueueItem& item)
+{
+	std::uint64_t hash = 14695981039346656037ull;
+	for(std::size_t u=0; u!=item.texture_count; ++u)
+	{
+		hash = _hash(hash, GLenum(item.textures[u].target));
+		hash = _hash(hash, GetGLName(item.textures[u].texture));
+	}
+	return hash;
+}
+
+OGLPLUS_LIB_FUNC
+GLuint RenderQueue::QuantizeDepth(
+	GLfloat depth,
+	GLfloat depth_near,
+	GLfloat depth_far
+)
+{
+	const GLuint max = (GLuint(1) << DepthBits)-1;
+	GLfloat d = (depth-depth_near)/(depth_far-depth_near);
+	if(!(d > 0)) return 0;
+	if(!(d < 1)) return max;
+	return GLuint(d*max);
+}
+
+OGLPLUS_LIB_FUNC
+RenderQueue::Key RenderQueue::MakeKey(
+	bool translucent,
+	GLuint program_id,
+	GLuint state_id,
+	GLuint texture_id,
+	GLuint vertex_array_id,
+	GLuint depth
+)
+{
+	Key key = translucent?1:0;
+	if(translucent)
+	{
+		// back-to-front
+		const GLuint max = (GLuint(1) << DepthBits)-1;
+		key = (key << DepthBits) | (max-(depth & max));
+	}
+	key = (key << ProgramBits) | (program_id & ((1u<<ProgramBits)-1));
+	key = (key << StateBits) | (state_id & ((1u<<StateBits)-1));
+	key = (key << TextureBits) | (texture_id & ((1u<<TextureBits)-1));
+	key = (key << VertexArrayBits) |
+		(vertex_array_id & ((1u<<VertexArrayBits)-1));
+	if(!translucent)
+	{
+		// front-to-back
+		key = (key << DepthBits) | (depth & ((1u<<DepthBits)-1));
+	}
+	return key;
+}
+
+OGLPLUS_LIB_FUNC
+void RenderQueue::RadixSort(
+	std::vector<Entry>& entries,
+	std::vector<Entry>& scratch
+)
+{
+	const std::size_t n = entries.size();
+	if(n == 0) return;
+
+	const unsigned digits = sizeof(Key);
+
+	std::size_t counts[digits][256];
+	std::memset(counts, 0, sizeof(counts));
+
+	for(std::size_t i=0; i!=n; ++i)
+	{
+		Key key = entries[i].key;
+		for(unsigned d=0; d!=digits; ++d)
+		{
+			++counts[d][(key >> (d*8)) & 0xFF];
+		}
+	}
+
+	scratch.resize(n);
+	Entry* src = entries.data();
+	Entry* dst = scratch.data();
+
+	for(unsigned d=0; d!=digits; ++d)
+	{
+		std::size_t* count = counts[d];
+		const unsigned shift = d*8;
+
+		// all keys have the same digit, nothing to do
+		if(count[(src[0].key >> shift) & 0xFF] == n)
+		{
+			continue;
+		}
+
+		std::size_t offset = 0;
+		for(unsigned b=0; b!=256; ++b)
+		{
+			std::size_t c = count[b];
+			count[b] = offset;
+			offset += c;
+		}
+		for(std::size_t i=0; i!=n; ++i)
+		{
+			dst[count[(src[i].key >> shift) & 0xFF]++] = src[i];
+		}
+		std::swap(src, dst);
+	}
+
+	if(src != entries.data())
+	{
+		entries.swap(scratch);
+	}
+}
+
+OGLPLUS_LIB_FUNC
+void RenderQueue::Reserve(std::size_t count)
+{
+	_items.reserve(count);
+	_entries.reserve(count);
+	_scratch.reserve(count);
+}
+
+OGLPLUS_LIB_FUNC
+void RenderQueue::Submit(const RenderQueueItem& item)
+{
+	Entry entry;
+	entry.key = MakeKey(
+		item.state.blend,
+		_intern(_program_ids, GetGLName(item.program)),
+		_intern(_state_ids, _state_hash(item.state)),
+		_intern(_texture_ids, _texture_hash(item)),
+		_intern(_vertex_array_ids, GetGLName(item.vertex_array)),
+		QuantizeDepth(item.depth, _depth_near, _depth_far)
+	);
+	entry.index = GLuint(_items.size());
+
+	_items.push_back(item);
+	_entries.push_back(entry);
+	_sorted = false;
+}
+
+OGLPLUS_LIB_FUNC
+void RenderQueue::Sort(void)
+{
+	if(!_sorted)
+	{
+		if(!_entries.empty())
+		{
+			RadixSort(_entries, _scratch);
+		}
+		_sorted = true;
+	}
+}
+
+OGLPLUS_LIB_FUNC
+std::size_t RenderQueue::_count_changes(bool sorted) const
+{
+	// mirrors the changes done by Replay, starting with unknown state
+	std::size_t changes = 0;
+	const RenderQueueItem* prev = nullptr;
+	const context::BlendFunctionSeparate* blend_function = nullptr;
+	const CompareFunction* depth_function = nullptr;
+	std::vector<std::pair<GLenum, GLuint>> textures;
+
+	for(std::size_t i=0, n=_items.size(); i!=n; ++i)
+	{
+		const RenderQueueItem& item =
+			_items[sorted?_entries[i].index:i];
+		const RenderQueueState& state = item.state;
+
+		if(!prev || (prev->program != item.program)) ++changes;
+		if(!prev || (prev->state.blend != state.blend)) ++changes;
+		if(state.blend)
+		{
+			if(!blend_function ||
+				(*blend_function != state.blend_function))
+			{
+				blend_function = &state.blend_function;
+				++changes;
+			}
+		}
+		if(!prev || (prev->state.depth_test != state.depth_test))
+		{
+			++changes;
+		}
+		if(state.depth_test)
+		{
+			if(!depth_function ||
+				(*depth_function != state.depth_function))
+			{
+				depth_function = &state.depth_function;
+				++changes;
+			}
+		}
+		if(!prev || (prev->state.depth_mask != state.depth_mask))
+		{
+			++changes;
+		}
+		for(std::size_t u=0; u!=item.texture_count; ++u)
+		{
+			std::pair<GLenum, GLuint> tex(
+				GLenum(item.textures[u].target),
+				GetGLName(item.textures[u].texture)
+			);
+			if(textures.size() <= u)
+			{
+				textures.resize(u+1, std::make_pair(GLenum(0), 0u));
+			}
+			if(textures[u] != tex)
+			{
+				textures[u] = tex;
+				++changes;
+			}
+		}
+		if(!prev || (prev->vertex_array != item.vertex_array))
+		{
+			++changes;
+		}
+		prev = &item;
+	}
+	return changes;
+}
+
+OGLPLUS_LIB_FUNC
+RenderQueueStats RenderQueue::Stats(void) const
+{
+	RenderQueueStats result;
+	result.items = _items.size();
+	result.submitted_changes = _count_changes(false);
+	result.sorted_changes = _sorted?
+		_count_changes(true):
+		result.submitted_changes;
+	return result;
+}
+
+OGLPLUS_LIB_FUNC
+void RenderQueue::_bind_textures(
+	const RenderQueueItem& item,
+	GLint& active_unit
+)
+{
+	for(std::size_t u=0; u!=item.texture_count; ++u)
+	{
+		const RenderQueueTexture& t = item.textures[u];
+		std::pair<GLenum, GLuint> tex(
+			GLenum(t.target),
+			GetGLName(t.texture)
+		);
+		if(_bound_textures.size() <= u)
+		{
+			_bound_textures.resize(u+1, std::make_pair(GLenum(0), 0u));
+		}
+		if(_bound_textures[u] != tex)
+		{
+			if(active_unit != GLint(u))
+			{
+				Texture::Active(GLuint(u));
+				active_unit = GLint(u);
+			}
+			Texture::Bind(t.target, t.texture);
+			_bound_textures[u] = tex;
+		}
+	}
+}
+
+OGLPLUS_LIB_FUNC
+void RenderQueue::_draw(const RenderQueueItem& item)
+{
+	if(item.indexed)
+	{
+		if(item.instances == 1)
+		{
+			OGLPLUS_GLFUNC(DrawElements)(
+				GLenum(item.mode),
+				item.count,
+				GLenum(item.index_type),
+				item.indices
+			);
+			OGLPLUS_CHECK_SIMPLE(DrawElements);
+		}
+		else
+		{
+#if OGLPLUS_DOCUMENTATION_ONLY || GL_VERSION_3_1
+			OGLPLUS_GLFUNC(DrawElementsInstanced)(
+				GLenum(item.mode),
+				item.count,
+				GLenum(item.index_type),
+				item.indices,
+				item.instances
+			);
+			OGLPLUS_CHECK_SIMPLE(DrawElementsInstanced);
+#else
+			assert(!
+				"DrawElementsInstanced required, "
+				"but not supported by the used version of OpenGL!"
+			);
+#endif
+		}
+	}
+	else
+	{
+		if(item.instances == 1)
+		{
+			OGLPLUS_GLFUNC(DrawArrays)(
+				GLenum(item.mode),
+				item.first,
+				item.count
+			);
+			OGLPLUS_CHECK_SIMPLE(DrawArrays);
+		}
+		else
+		{
+#if OGLPLUS_DOCUMENTATION_ONLY || GL_VERSION_3_1
+			OGLPLUS_GLFUNC(DrawArraysInstanced)(
+				GLenum(item.mode),
+				item.first,
+				item.count,
+				item.instances
+			);
+			OGLPLUS_CHECK_SIMPLE(DrawArraysInstanced);
+#else
+			assert(!
+				"DrawArraysInstanced required, "
+				"but not supported by the used version of OpenGL!"
+			);
+#endif
+		}
+	}
+}
+
+OGLPLUS_LIB_FUNC
+void RenderQueue::Replay(
+	ClientContext& gl,
+	const std::function<void (const RenderQueueItem&)>& before_draw
+)
+{
+	Sort();
+
+	// the texture bindings may have been changed since the last replay
+	_bound_textures.clear();
+	GLint active_unit = -1;
+
+	for(auto i=_entries.begin(), e=_entries.end(); i!=e; ++i)
+	{
+		const RenderQueueItem& item = _items[i->index];
+		const RenderQueueState& state = item.state;
+
+		gl.Program.Bind(item.program);
+
+		gl.Caps.Blend.Enable(state.blend);
+		if(state.blend)
+		{
+			gl.BlendFunction.Set(state.blend_function);
+		}
+		gl.Caps.DepthTest.Enable(state.depth_test);
+		if(state.depth_test)
+		{
+			gl.DepthFunc.Set(state.depth_function);
+		}
+		gl.DepthMask.Set(Boolean(state.depth_mask));
+
+		_bind_textures(item, active_unit);
+
+		gl.VertexArray.Bind(item.vertex_array);
+
+		if(before_draw)
+		{
+			before_draw(item);
+		}
+		_draw(item);
+	}
+}
+
+OGLPLUS_LIB_FUNC
+void RenderQueue::Clear(void)
+{
+	_items.clear();
+	_entries.clear();
+	_sorted = true;
+}
+
+} // namespace oglplus
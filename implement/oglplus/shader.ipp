@@ -31,6 +31,14 @@ OGLPLUS_LIB_FUNC
 ObjectOps<tag::DirectState, tag::Shader>&
 ObjectOps<tag::DirectState, tag::Shader>::
 Compile(void)
+{
+	return CompileAsync().CheckCompiled();
+}
+
+OGLPLUS_LIB_FUNC
+ObjectOps<tag::DirectState, tag::Shader>&
+ObjectOps<tag::DirectState, tag::Shader>::
+CompileAsync(void)
 {
 	OGLPLUS_GLFUNC(CompileShader)(_obj_name());
 	OGLPLUS_CHECK(
@@ -39,6 +47,14 @@ Compile(void)
 		Object(*this).
 		EnumParam(Type())
 	);
+	return *this;
+}
+
+OGLPLUS_LIB_FUNC
+ObjectOps<tag::DirectState, tag::Shader>&
+ObjectOps<tag::DirectState, tag::Shader>::
+CheckCompiled(void)
+{
 	OGLPLUS_HANDLE_ERROR_IF(
 		!IsCompiled(),
 		GL_INVALID_OPERATION,
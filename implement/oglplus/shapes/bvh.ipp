@@ -0,0 +1,902 @@
+/**
+ *  @file oglplus/shapes/bvh.ipp
+ *  @brief Implementation of the bounding-volume hierarchies
+ *
+ *  @author Matus Chochlik
+ *
+ *  Copyright 2010-2015 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#include <oglplus/detail/parallel_for.hpp>
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <cassert>
+
+namespace oglplus {
+namespace aux {
+
+// the number of bins used to evaluate the surface area heuristic
+static const unsigned BVHBinCount = 16;
+
+// subtrees with fewer primitives are never built by a new thread
+static const GLuint BVHParallelThreshold = 4096;
+
+// below this depth the nodes are split by the median if SAH fails
+static const unsigned BVHMaxSAHDepth = 48;
+
+// the maximal depth of the traversal stack
+static const std::size_t BVHStackSize = 128;
+
+inline
+GLfloat BVHHalfArea(const GLfloat* min, const GLfloat* max)
+{
+	GLfloat dx = max[0]-min[0];
+	GLfloat dy = max[1]-min[1];
+	GLfloat dz = max[2]-min[2];
+	return dx*dy+dy*dz+dz*dx;
+}
+
+inline
+void BVHEmptyBox(GLfloat* min, GLfloat* max)
+{
+	const GLfloat inf = std::numeric_limits<GLfloat>::infinity();
+	for(std::size_t c=0; c!=3; ++c)
+	{
+		min[c] = +inf;
+		max[c] = -inf;
+	}
+}
+
+inline
+void BVHGrowBox(GLfloat* min, GLfloat* max, const GLfloat* box)
+{
+	for(std::size_t c=0; c!=3; ++c)
+	{
+		if(min[c] > box[c+0]) min[c] = box[c+0];
+		if(max[c] < box[c+3]) max[c] = box[c+3];
+	}
+}
+
+// slab test of a ray against the box of a node
+// returns the entry distance or infinity if the box is missed
+inline
+GLfloat BVHRayBox(
+	const BVHNode& node,
+	const GLfloat* origin,
+	const GLfloat* inv_dir,
+	GLfloat max_distance
+)
+{
+	GLfloat t_near = 0.0f;
+	GLfloat t_far = max_distance;
+	for(std::size_t c=0; c!=3; ++c)
+	{
+		GLfloat t0 = (node.min[c]-origin[c])*inv_dir[c];
+		GLfloat t1 = (node.max[c]-origin[c])*inv_dir[c];
+		if(t0 > t1) std::swap(t0, t1);
+		// written so that NaNs (0*inf) do not cull the box
+		if(t0 > t_near) t_near = t0;
+		if(t1 < t_far) t_far = t1;
+	}
+	if(t_near > t_far)
+	{
+		return std::numeric_limits<GLfloat>::infinity();
+	}
+	return t_near;
+}
+
+inline
+void BVHInverseDirection(const Vec3f& direction, GLfloat* inv_dir)
+{
+	for(std::size_t c=0; c!=3; ++c)
+	{
+		inv_dir[c] = 1.0f/direction[c];
+	}
+}
+
+OGLPLUS_LIB_FUNC
+BVHBuilder::BVHBuilder(
+	const GLfloat* boxes,
+	GLuint count,
+	GLuint max_leaf_size,
+	std::vector<GLuint>& order,
+	std::vector<BVHNode>& nodes
+): _prims(count)
+ , _order(order)
+ , _nodes(nodes)
+ , _node_count(0)
+ , _max_leaf_size(max_leaf_size)
+ , _spawn_depth(0)
+{
+	assert(_max_leaf_size > 0);
+
+	for(GLuint i=0; i!=count; ++i)
+	{
+		_prim& prim = _prims[i];
+		for(std::size_t c=0; c!=3; ++c)
+		{
+			prim.min[c] = boxes[i*6+c+0];
+			prim.max[c] = boxes[i*6+c+3];
+		}
+		prim.index = i;
+		prim.pad = 0.0f;
+	}
+}
+
+OGLPLUS_LIB_FUNC
+void BVHBuilder::_bounds(
+	GLuint begin,
+	GLuint end,
+	BVHNode& node,
+	GLfloat* cmin,
+	GLfloat* cmax
+) const
+{
+	BVHEmptyBox(node.min, node.max);
+	BVHEmptyBox(cmin, cmax);
+	for(GLuint i=begin; i!=end; ++i)
+	{
+		const _prim& prim = _prims[i];
+		for(std::size_t a=0; a!=3; ++a)
+		{
+			if(node.min[a] > prim.min[a]) node.min[a] = prim.min[a];
+			if(node.max[a] < prim.max[a]) node.max[a] = prim.max[a];
+			const GLfloat c = prim.Centroid(a);
+			if(cmin[a] > c) cmin[a] = c;
+			if(cmax[a] < c) cmax[a] = c;
+		}
+	}
+}
+
+OGLPLUS_LIB_FUNC
+GLuint BVHBuilder::_split(
+	GLuint begin,
+	GLuint end,
+	const BVHNode& node,
+	const GLfloat* cmin,
+	const GLfloat* cmax,
+	unsigned depth
+)
+{
+	const GLuint count = end-begin;
+	const GLfloat inf = std::numeric_limits<GLfloat>::infinity();
+
+	// small nodes use fewer bins, to lower the constant cost of a split
+	const unsigned bins = (count < BVHBinCount)?unsigned(count):BVHBinCount;
+
+	// the factors converting the centroids to bin indices,
+	// zero for the axes where all centroids are at the same position
+	GLfloat k[3];
+	for(std::size_t a=0; a!=3; ++a)
+	{
+		const GLfloat extent = cmax[a]-cmin[a];
+		k[a] = (extent > 0.0f)?GLfloat(bins)*(1.0f-1e-5f)/extent:0.0f;
+	}
+	auto bin_of = [&k, cmin, bins](const _prim& prim, std::size_t a)
+	-> unsigned
+	{
+		unsigned b = unsigned((prim.Centroid(a)-cmin[a])*k[a]);
+		return (b < bins)?b:bins-1;
+	};
+
+	// all three axes are binned in a single pass over the primitives
+	GLuint bin_count[3][BVHBinCount];
+	GLfloat bin_min[3][BVHBinCount][3], bin_max[3][BVHBinCount][3];
+	for(std::size_t a=0; a!=3; ++a)
+	{
+		for(unsigned b=0; b!=bins; ++b)
+		{
+			bin_count[a][b] = 0;
+			BVHEmptyBox(bin_min[a][b], bin_max[a][b]);
+		}
+	}
+	for(GLuint i=begin; i!=end; ++i)
+	{
+		const _prim& prim = _prims[i];
+		for(std::size_t a=0; a!=3; ++a)
+		{
+			const unsigned b = bin_of(prim, a);
+			++bin_count[a][b];
+			GLfloat* bmin = bin_min[a][b];
+			GLfloat* bmax = bin_max[a][b];
+			for(std::size_t c=0; c!=3; ++c)
+			{
+				if(bmin[c] > prim.min[c]) bmin[c] = prim.min[c];
+				if(bmax[c] < prim.max[c]) bmax[c] = prim.max[c];
+			}
+		}
+	}
+
+	GLfloat best_cost = inf;
+	unsigned best_axis = 3;
+	unsigned best_bin = 0;
+
+	for(unsigned a=0; a!=3; ++a)
+	{
+		if(k[a] == 0.0f) continue;
+
+		// the costs of the primitives right of the split planes
+		GLfloat right_cost[BVHBinCount];
+		GLfloat rmin[3], rmax[3];
+		BVHEmptyBox(rmin, rmax);
+		GLuint right_count = 0;
+		for(unsigned b=bins-1; b!=0; --b)
+		{
+			right_count += bin_count[a][b];
+			for(std::size_t c=0; c!=3; ++c)
+			{
+				rmin[c] = std::min(rmin[c], bin_min[a][b][c]);
+				rmax[c] = std::max(rmax[c], bin_max[a][b][c]);
+			}
+			right_cost[b] = right_count?
+				BVHHalfArea(rmin, rmax)*right_count:
+				0.0f;
+		}
+
+		GLfloat lmin[3], lmax[3];
+		BVHEmptyBox(lmin, lmax);
+		GLuint left_count = 0;
+		for(unsigned b=0; b+1!=bins; ++b)
+		{
+			left_count += bin_count[a][b];
+			for(std::size_t c=0; c!=3; ++c)
+			{
+				lmin[c] = std::min(lmin[c], bin_min[a][b][c]);
+				lmax[c] = std::max(lmax[c], bin_max[a][b][c]);
+			}
+			if(left_count == 0 || left_count == count) continue;
+
+			GLfloat cost =
+				BVHHalfArea(lmin, lmax)*left_count+
+				right_cost[b+1];
+			if(best_cost > cost)
+			{
+				best_cost = cost;
+				best_axis = a;
+				best_bin = b;
+			}
+		}
+	}
+
+	if(best_axis < 3)
+	{
+		// make a leaf if splitting is not cheaper than intersecting
+		// all primitives (the cost of traversal is 1)
+		const GLfloat area = BVHHalfArea(node.min, node.max);
+		if(area > 0.0f)
+		{
+			const GLfloat split_cost = 1.0f+best_cost/area;
+			if((split_cost >= count) && (count <= 4*_max_leaf_size))
+			{
+				return begin;
+			}
+		}
+
+		const unsigned a = best_axis;
+		_prim* mid = std::partition(
+			_prims.data()+begin,
+			_prims.data()+end,
+			[&bin_of, a, best_bin](const _prim& prim) -> bool
+			{
+				return bin_of(prim, a) <= best_bin;
+			}
+		);
+		GLuint m = GLuint(mid-_prims.data());
+		if((m != begin) && (m != end) && (depth < BVHMaxSAHDepth))
+		{
+			return m;
+		}
+	}
+	else if(count <= 4*_max_leaf_size)
+	{
+		// all centroids are at the same position
+		return begin;
+	}
+
+	// split by the median of the longest centroid axis
+	unsigned a = 0;
+	if(cmax[1]-cmin[1] > cmax[a]-cmin[a]) a = 1;
+	if(cmax[2]-cmin[2] > cmax[a]-cmin[a]) a = 2;
+
+	const GLuint m = begin+count/2;
+	std::nth_element(
+		_prims.data()+begin,
+		_prims.data()+m,
+		_prims.data()+end,
+		[a](const _prim& p, const _prim& q) -> bool
+		{
+			return p.Centroid(a) < q.Centroid(a);
+		}
+	);
+	return m;
+}
+
+OGLPLUS_LIB_FUNC
+void BVHBuilder::_build(GLuint n, GLuint begin, GLuint end, unsigned depth)
+{
+	// the node vector is not resized during the build
+	// so the reference to the node stays valid
+	BVHNode& node = _nodes[n];
+	GLfloat cmin[3], cmax[3];
+	_bounds(begin, end, node, cmin, cmax);
+
+	const GLuint count = end-begin;
+	GLuint mid = begin;
+	if(count > _max_leaf_size)
+	{
+		mid = _split(begin, end, node, cmin, cmax, depth);
+	}
+	if(mid == begin)
+	{
+		node.offset = begin;
+		node.count = count;
+		return;
+	}
+
+	const GLuint left = _node_count.fetch_add(2);
+	assert(left+1 < _nodes.size());
+	node.offset = left;
+	node.count = 0;
+
+	if((depth < _spawn_depth) && (count >= BVHParallelThreshold))
+	{
+		// the left subtree is built by a new thread
+		ParallelInvoke(
+			[this, left, begin, mid, depth](void)
+			{
+				_build(left+0, begin, mid, depth+1);
+			},
+			[this, left, mid, end, depth](void)
+			{
+				_build(left+1, mid, end, depth+1);
+			}
+		);
+	}
+	else
+	{
+		_build(left+0, begin, mid, depth+1);
+		_build(left+1, mid, end, depth+1);
+	}
+}
+
+OGLPLUS_LIB_FUNC
+void BVHBuilder::Build(unsigned threads)
+{
+	_nodes.clear();
+	_order.clear();
+	const GLuint count = GLuint(_prims.size());
+	if(count == 0)
+	{
+		return;
+	}
+
+	threads = ParallelThreads(threads);
+	_spawn_depth = 0;
+	while((1u << _spawn_depth) < threads)
+	{
+		++_spawn_depth;
+	}
+
+	_nodes.resize(std::size_t(count)*2);
+	_node_count = 1;
+	_build(0, 0, count, 0);
+	_nodes.resize(_node_count);
+
+	_order.resize(count);
+	for(GLuint i=0; i!=count; ++i)
+	{
+		_order[i] = _prims[i].index;
+	}
+}
+
+OGLPLUS_LIB_FUNC
+void BVHBuilder::Refit(
+	const GLfloat* boxes,
+	const std::vector<GLuint>& order,
+	std::vector<BVHNode>& nodes
+)
+{
+	// the children are always stored after their parents
+	for(std::size_t n=nodes.size(); n!=0; --n)
+	{
+		BVHNode& node = nodes[n-1];
+		BVHEmptyBox(node.min, node.max);
+		if(node.IsLeaf())
+		{
+			for(GLuint i=0; i!=node.count; ++i)
+			{
+				BVHGrowBox(
+					node.min,
+					node.max,
+					boxes+order[node.offset+i]*6
+				);
+			}
+		}
+		else
+		{
+			for(GLuint c=0; c!=2; ++c)
+			{
+				const BVHNode& child = nodes[node.offset+c];
+				assert(node.offset+c > n-1);
+				for(std::size_t a=0; a!=3; ++a)
+				{
+					node.min[a] = std::min(node.min[a], child.min[a]);
+					node.max[a] = std::max(node.max[a], child.max[a]);
+				}
+			}
+		}
+	}
+}
+
+} // namespace aux
+namespace shapes {
+
+OGLPLUS_LIB_FUNC
+void InstanceBVH::Build(unsigned threads)
+{
+	aux::BVHBuilder builder(_boxes.data(), Size(), 2, _order, _nodes);
+	builder.Build(threads);
+}
+
+OGLPLUS_LIB_FUNC
+void InstanceBVH::Refit(void)
+{
+	if(_order.size() != Size())
+	{
+		throw std::runtime_error(
+			"The instance BVH must be rebuilt after "
+			"the number of instances changed"
+		);
+	}
+	aux::BVHBuilder::Refit(_boxes.data(), _order, _nodes);
+}
+
+OGLPLUS_LIB_FUNC
+std::size_t InstanceBVH::Cull(
+	const Frustumf& frustum,
+	std::vector<GLuint>& visible
+) const
+{
+	visible.clear();
+	if(_nodes.empty())
+	{
+		return 0;
+	}
+
+	GLfloat planes[6][4];
+	for(std::size_t p=0; p!=6; ++p)
+	{
+		for(std::size_t c=0; c!=4; ++c)
+		{
+			planes[p][c] = frustum.Equation(p)[c];
+		}
+	}
+
+	// the second value tells if the node is known to be fully inside
+	std::pair<GLuint, bool> stack[aux::BVHStackSize];
+	std::size_t top = 0;
+	stack[top++] = std::make_pair(GLuint(0), false);
+
+	while(top != 0)
+	{
+		const std::pair<GLuint, bool> entry = stack[--top];
+		const BVHNode& node = _nodes[entry.first];
+		bool inside = entry.second;
+
+		if(!inside)
+		{
+			bool outside = false;
+			inside = true;
+			for(std::size_t p=0; p!=6; ++p)
+			{
+				const GLfloat* e = planes[p];
+				// the corners farthest along and against the normal
+				GLfloat far_d = e[3], near_d = e[3];
+				for(std::size_t c=0; c!=3; ++c)
+				{
+					if(e[c] >= 0.0f)
+					{
+						far_d += e[c]*node.max[c];
+						near_d += e[c]*node.min[c];
+					}
+					else
+					{
+						far_d += e[c]*node.min[c];
+						near_d += e[c]*node.max[c];
+					}
+				}
+				if(far_d < 0.0f)
+				{
+					outside = true;
+					break;
+				}
+				if(near_d < 0.0f)
+				{
+					inside = false;
+				}
+			}
+			if(outside) continue;
+		}
+
+		if(node.IsLeaf())
+		{
+			for(GLuint i=0; i!=node.count; ++i)
+			{
+				visible.push_back(_order[node.offset+i]);
+			}
+		}
+		else
+		{
+			assert(top+2 <= aux::BVHStackSize);
+			stack[top++] = std::make_pair(node.offset+1, inside);
+			stack[top++] = std::make_pair(node.offset+0, inside);
+		}
+	}
+	return visible.size();
+}
+
+OGLPLUS_LIB_FUNC
+std::size_t InstanceBVH::IntersectRay(
+	const Vec3f& origin,
+	const Vec3f& direction,
+	std::vector<GLuint>& hits
+) const
+{
+	hits.clear();
+	if(_nodes.empty())
+	{
+		return 0;
+	}
+
+	GLfloat inv_dir[3];
+	aux::BVHInverseDirection(direction, inv_dir);
+	const GLfloat inf = std::numeric_limits<GLfloat>::infinity();
+
+	GLuint stack[aux::BVHStackSize];
+	std::size_t top = 0;
+	stack[top++] = 0;
+
+	while(top != 0)
+	{
+		const BVHNode& node = _nodes[stack[--top]];
+		if(aux::BVHRayBox(node, origin.Data(), inv_dir, inf) == inf)
+		{
+			continue;
+		}
+		if(node.IsLeaf())
+		{
+			for(GLuint i=0; i!=node.count; ++i)
+			{
+				hits.push_back(_order[node.offset+i]);
+			}
+		}
+		else
+		{
+			assert(top+2 <= aux::BVHStackSize);
+			stack[top++] = node.offset+1;
+			stack[top++] = node.offset+0;
+		}
+	}
+	return hits.size();
+}
+
+OGLPLUS_LIB_FUNC
+GLuint InstanceBVH::Pick(
+	const Vec3f& origin,
+	const Vec3f& direction,
+	const std::function<bool (GLuint, GLfloat&)>& test,
+	GLfloat& distance
+) const
+{
+	GLuint result = NoInstance();
+	if(_nodes.empty())
+	{
+		return result;
+	}
+
+	GLfloat inv_dir[3];
+	aux::BVHInverseDirection(direction, inv_dir);
+	const GLfloat inf = std::numeric_limits<GLfloat>::infinity();
+
+	std::pair<GLuint, GLfloat> stack[aux::BVHStackSize];
+	std::size_t top = 0;
+
+	GLfloat t = aux::BVHRayBox(_nodes[0], origin.Data(), inv_dir, distance);
+	if(t != inf)
+	{
+		stack[top++] = std::make_pair(GLuint(0), t);
+	}
+
+	while(top != 0)
+	{
+		const std::pair<GLuint, GLfloat> entry = stack[--top];
+		if(entry.second > distance) continue;
+
+		const BVHNode& node = _nodes[entry.first];
+		if(node.IsLeaf())
+		{
+			for(GLuint i=0; i!=node.count; ++i)
+			{
+				const GLuint index = _order[node.offset+i];
+				GLfloat d = distance;
+				if(test(index, d) && (d < distance))
+				{
+					distance = d;
+					result = index;
+				}
+			}
+		}
+		else
+		{
+			const GLuint l = node.offset+0, r = node.offset+1;
+			const GLfloat* o = origin.Data();
+			GLfloat tl = aux::BVHRayBox(_nodes[l], o, inv_dir, distance);
+			GLfloat tr = aux::BVHRayBox(_nodes[r], o, inv_dir, distance);
+
+			// push the farther child first to visit the nearer first
+			assert(top+2 <= aux::BVHStackSize);
+			if(tl > tr)
+			{
+				if(tl != inf) stack[top++] = std::make_pair(l, tl);
+				if(tr != inf) stack[top++] = std::make_pair(r, tr);
+			}
+			else
+			{
+				if(tr != inf) stack[top++] = std::make_pair(r, tr);
+				if(tl != inf) stack[top++] = std::make_pair(l, tl);
+			}
+		}
+	}
+	return result;
+}
+
+OGLPLUS_LIB_FUNC
+TriangleBVH::TriangleBVH(
+	const std::vector<GLfloat>& positions,
+	GLuint values_per_vertex,
+	const std::vector<GLuint>& triangles,
+	unsigned threads
+)
+{
+	assert(values_per_vertex >= 3);
+	assert(triangles.size() % 3 == 0);
+
+	const GLuint count = GLuint(triangles.size()/3);
+	std::vector<GLfloat> boxes(std::size_t(count)*6);
+	for(GLuint t=0; t!=count; ++t)
+	{
+		GLfloat* box = boxes.data()+t*6;
+		aux::BVHEmptyBox(box+0, box+3);
+		for(GLuint v=0; v!=3; ++v)
+		{
+			const std::size_t i = triangles[t*3+v]*values_per_vertex;
+			assert(i+2 < positions.size());
+			GLfloat p[6] = {
+				positions[i+0], positions[i+1], positions[i+2],
+				positions[i+0], positions[i+1], positions[i+2]
+			};
+			aux::BVHGrowBox(box+0, box+3, p);
+		}
+	}
+
+	aux::BVHBuilder builder(boxes.data(), count, 4, _tri_index, _nodes);
+	builder.Build(threads);
+
+	// store the vertices in the order of the leaves
+	_verts.resize(std::size_t(count)*9);
+	for(GLuint s=0; s!=count; ++s)
+	{
+		const GLuint t = _tri_index[s];
+		for(GLuint v=0; v!=3; ++v)
+		{
+			const std::size_t i = triangles[t*3+v]*values_per_vertex;
+			for(GLuint c=0; c!=3; ++c)
+			{
+				_verts[s*9+v*3+c] = positions[i+c];
+			}
+		}
+	}
+}
+
+OGLPLUS_LIB_FUNC
+void TriangleBVH::Triangles(
+	const DrawingInstructions& instructions,
+	const std::vector<GLuint>& indices,
+	std::vector<GLuint>& triangles
+)
+{
+	typedef DrawOperation::Method Method;
+
+	const std::vector<DrawOperation>& ops = instructions.Operations();
+	for(auto op=ops.begin(), oe=ops.end(); op!=oe; ++op)
+	{
+		const bool elements = (op->method == Method::DrawElements);
+		auto vertex = [&](GLuint i) -> GLuint
+		{
+			return elements?indices[op->first+i]:op->first+i;
+		};
+		auto restart = [&](GLuint i) -> bool
+		{
+			return elements && (indices[op->first+i] == op->restart_index);
+		};
+
+		// the vertices of the current primitive (after the last restart)
+		GLuint v[3] = {0, 0, 0};
+		GLuint n = 0;
+		for(GLuint i=0; i!=op->count; ++i)
+		{
+			if(restart(i))
+			{
+				n = 0;
+				continue;
+			}
+			const GLuint x = vertex(i);
+			switch(op->mode)
+			{
+				case PrimitiveType::Triangles:
+				{
+					v[n++] = x;
+					if(n == 3)
+					{
+						triangles.insert(triangles.end(), v, v+3);
+						n = 0;
+					}
+					break;
+				}
+				case PrimitiveType::TriangleStrip:
+				{
+					// every other triangle of the strip
+					// is swapped to keep the winding
+					if(n >= 2)
+					{
+						const bool odd = (n % 2 != 0);
+						triangles.push_back(v[odd?1:0]);
+						triangles.push_back(v[odd?0:1]);
+						triangles.push_back(x);
+					}
+					v[0] = v[1];
+					v[1] = x;
+					++n;
+					break;
+				}
+				case PrimitiveType::TriangleFan:
+				{
+					if(n == 0)
+					{
+						v[0] = x;
+					}
+					else if(n >= 2)
+					{
+						triangles.push_back(v[0]);
+						triangles.push_back(v[1]);
+						triangles.push_back(x);
+					}
+					v[1] = x;
+					++n;
+					break;
+				}
+				default: break;
+			}
+		}
+	}
+}
+
+OGLPLUS_LIB_FUNC
+bool TriangleBVH::Raycast(
+	const Vec3f& origin,
+	const Vec3f& direction,
+	BVHRayHit& hit,
+	GLfloat max_distance
+) const
+{
+	if(_nodes.empty())
+	{
+		return false;
+	}
+
+	const GLfloat* o = origin.Data();
+	const GLfloat* d = direction.Data();
+	GLfloat inv_dir[3];
+	aux::BVHInverseDirection(direction, inv_dir);
+	const GLfloat inf = std::numeric_limits<GLfloat>::infinity();
+
+	GLfloat best = max_distance;
+	GLuint best_slot = ~GLuint(0);
+	GLfloat best_u = 0.0f, best_v = 0.0f;
+
+	std::pair<GLuint, GLfloat> stack[aux::BVHStackSize];
+	std::size_t top = 0;
+
+	GLfloat t = aux::BVHRayBox(_nodes[0], o, inv_dir, best);
+	if(t != inf)
+	{
+		stack[top++] = std::make_pair(GLuint(0), t);
+	}
+
+	while(top != 0)
+	{
+		const std::pair<GLuint, GLfloat> entry = stack[--top];
+		if(entry.second > best) continue;
+
+		const BVHNode& node = _nodes[entry.first];
+		if(node.IsLeaf())
+		{
+			for(GLuint s=node.offset, e=node.offset+node.count; s!=e; ++s)
+			{
+				// Moller-Trumbore ray/triangle intersection
+				const GLfloat* v0 = _verts.data()+s*9;
+				const GLfloat* v1 = v0+3;
+				const GLfloat* v2 = v0+6;
+				const GLfloat e1[3] = {
+					v1[0]-v0[0], v1[1]-v0[1], v1[2]-v0[2]
+				};
+				const GLfloat e2[3] = {
+					v2[0]-v0[0], v2[1]-v0[1], v2[2]-v0[2]
+				};
+				const GLfloat p[3] = {
+					d[1]*e2[2]-d[2]*e2[1],
+					d[2]*e2[0]-d[0]*e2[2],
+					d[0]*e2[1]-d[1]*e2[0]
+				};
+				const GLfloat det = e1[0]*p[0]+e1[1]*p[1]+e1[2]*p[2];
+				if(det == 0.0f) continue;
+				const GLfloat inv_det = 1.0f/det;
+				const GLfloat s0[3] = {
+					o[0]-v0[0], o[1]-v0[1], o[2]-v0[2]
+				};
+				const GLfloat u = (s0[0]*p[0]+s0[1]*p[1]+s0[2]*p[2])*inv_det;
+				if((u < 0.0f) || (u > 1.0f)) continue;
+				const GLfloat q[3] = {
+					s0[1]*e1[2]-s0[2]*e1[1],
+					s0[2]*e1[0]-s0[0]*e1[2],
+					s0[0]*e1[1]-s0[1]*e1[0]
+				};
+				const GLfloat v = (d[0]*q[0]+d[1]*q[1]+d[2]*q[2])*inv_det;
+				if((v < 0.0f) || (u+v > 1.0f)) continue;
+				const GLfloat dist =
+					(e2[0]*q[0]+e2[1]*q[1]+e2[2]*q[2])*inv_det;
+				if((dist >= 0.0f) && (dist < best))
+				{
+					best = dist;
+					best_slot = s;
+					best_u = u;
+					best_v = v;
+				}
+			}
+		}
+		else
+		{
+			const GLuint l = node.offset+0, r = node.offset+1;
+			GLfloat tl = aux::BVHRayBox(_nodes[l], o, inv_dir, best);
+			GLfloat tr = aux::BVHRayBox(_nodes[r], o, inv_dir, best);
+
+			assert(top+2 <= aux::BVHStackSize);
+			if(tl > tr)
+			{
+				if(tl != inf) stack[top++] = std::make_pair(l, tl);
+				if(tr != inf) stack[top++] = std::make_pair(r, tr);
+			}
+			else
+			{
+				if(tr != inf) stack[top++] = std::make_pair(r, tr);
+				if(tl != inf) stack[top++] = std::make_pair(l, tl);
+			}
+		}
+	}
+
+	if(best_slot == ~GLuint(0))
+	{
+		return false;
+	}
+	hit.triangle = _tri_index[best_slot];
+	hit.distance = best;
+	hit.u = best_u;
+	hit.v = best_v;
+	return true;
+}
+
+} // namespace shapes
+} // namespace oglplus
@@ -0,0 +1,312 @@
+/**
+ *  @file oglplus/shapes/draw_compiled.ipp
+ *  @brief Implementation of compiled shape draw instructions
+ *
+ *  @author Matus Chochlik
+ *
+ *  Copyright 2010-2015 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#include <oglplus/lib/incl_begin.ipp>
+#include <oglplus/glfunc.hpp>
+#include <oglplus/error/basic.hpp>
+#include <oglplus/lib/incl_end.ipp>
+
+namespace oglplus {
+namespace shapes {
+
+OGLPLUS_LIB_FUNC
+CompiledDrawingInstructions::CompiledDrawingInstructions(
+	const DrawingInstructions& instructions,
+	const ElementIndexInfo& index_info,
+	bool indirect
+): _ops(instructions.Operations())
+ , _index_info(index_info)
+#if GL_VERSION_4_3 || GL_ARB_multi_draw_indirect
+ , _indirect(indirect)
+ , _cmd_inst_count(1)
+ , _cmd_base_inst(0)
+#else
+ , _indirect(false)
+#endif
+{
+	(void)indirect;
+	_firsts.reserve(_ops.size());
+	_counts.reserve(_ops.size());
+	_offsets.reserve(_ops.size());
+
+	for(std::size_t i=0, n=_ops.size(); i!=n; ++i)
+	{
+		const DrawOperation& op = _ops[i];
+
+		_firsts.push_back(GLint(op.first));
+		_counts.push_back(GLsizei(op.count));
+		_offsets.push_back((const GLvoid*)(op.first*index_info.Size()));
+
+		if(_batches.empty() ||
+			(_batches.back().method != op.method) ||
+			(_batches.back().mode != op.mode) ||
+			(_batches.back().restart_index != op.restart_index) ||
+			(_batches.back().phase != op.phase)
+		)
+		{
+			Batch_ batch = {
+				op.method,
+				op.mode,
+				op.restart_index,
+				op.phase,
+				GLsizei(i), 0,
+#if GL_VERSION_4_3 || GL_ARB_multi_draw_indirect
+				GLsizei(_commands.size())
+#else
+				0
+#endif
+			};
+			_batches.push_back(batch);
+		}
+		++_batches.back().count;
+
+#if GL_VERSION_4_3 || GL_ARB_multi_draw_indirect
+		// DrawElementsIndirectCommand / DrawArraysIndirectCommand
+		if(op.method == ShapeDrawOperationMethod::DrawElements)
+		{
+			GLuint cmd[5] = {op.count, 1, op.first, 0, 0};
+			_commands.insert(_commands.end(), cmd, cmd+5);
+		}
+		else
+		{
+			GLuint cmd[4] = {op.count, 1, op.first, 0};
+			_commands.insert(_commands.end(), cmd, cmd+4);
+		}
+#endif
+	}
+
+#if GL_VERSION_4_3 || GL_ARB_multi_draw_indirect
+	if(_indirect && !_commands.empty())
+	{
+		_command_buf = Buffer();
+		const BufferName previous =
+			Buffer::Binding(BufferTarget::DrawIndirect);
+		_command_buf.Bind(BufferTarget::DrawIndirect);
+		Buffer::Data(
+			BufferTarget::DrawIndirect,
+			GLsizei(_commands.size()),
+			_commands.data(),
+			BufferUsage::DynamicDraw
+		);
+		Buffer::Bind(BufferTarget::DrawIndirect, previous);
+	}
+#endif
+}
+
+#if GL_VERSION_4_3 || GL_ARB_multi_draw_indirect
+OGLPLUS_LIB_FUNC
+void CompiledDrawingInstructions::_update_commands(
+	GLuint inst_count,
+	GLuint base_inst
+) const
+{
+	for(auto b=_batches.begin(), e=_batches.end(); b!=e; ++b)
+	{
+		const std::size_t stride =
+			(b->method == ShapeDrawOperationMethod::DrawElements)?5:4;
+		GLuint* cmd = _commands.data()+b->commands;
+		for(GLsizei i=0; i!=b->count; ++i)
+		{
+			cmd[1] = inst_count;
+			cmd[stride-1] = base_inst;
+			cmd += stride;
+		}
+	}
+	Buffer::SubData(
+		BufferTarget::DrawIndirect,
+		0,
+		GLsizei(_commands.size()),
+		_commands.data()
+	);
+	_cmd_inst_count = inst_count;
+	_cmd_base_inst = base_inst;
+}
+#endif
+
+OGLPLUS_LIB_FUNC
+BufferName CompiledDrawingInstructions::_begin(
+	GLuint inst_count,
+	GLuint base_inst
+) const
+{
+#if GL_VERSION_4_3 || GL_ARB_multi_draw_indirect
+	if(_indirect && !_commands.empty())
+	{
+		const BufferName previous =
+			Buffer::Binding(BufferTarget::DrawIndirect);
+		_command_buf.Bind(BufferTarget::DrawIndirect);
+		if((_cmd_inst_count != inst_count) || (_cmd_base_inst != base_inst))
+		{
+			_update_commands(inst_count, base_inst);
+		}
+		return previous;
+	}
+#else
+	(void)inst_count;
+	(void)base_inst;
+#endif
+	return BufferName();
+}
+
+OGLPLUS_LIB_FUNC
+void CompiledDrawingInstructions::_end(BufferName previous) const
+{
+#if GL_VERSION_4_3 || GL_ARB_multi_draw_indirect
+	if(_indirect && !_commands.empty())
+	{
+		Buffer::Bind(BufferTarget::DrawIndirect, previous);
+	}
+#else
+	(void)previous;
+#endif
+}
+
+OGLPLUS_LIB_FUNC
+void CompiledDrawingInstructions::_restart(
+	RestartState_& state,
+	GLuint restart_index
+) const
+{
+	if(state.known && (state.index == restart_index))
+	{
+		return;
+	}
+#if GL_VERSION_3_1
+	if(restart_index == DrawOperation::NoRestartIndex())
+	{
+		OGLPLUS_GLFUNC(Disable)(GL_PRIMITIVE_RESTART);
+		OGLPLUS_VERIFY_SIMPLE(Disable);
+	}
+	else
+	{
+		if(!state.known || (state.index == DrawOperation::NoRestartIndex()))
+		{
+			OGLPLUS_GLFUNC(Enable)(GL_PRIMITIVE_RESTART);
+			OGLPLUS_VERIFY_SIMPLE(Enable);
+		}
+		OGLPLUS_GLFUNC(PrimitiveRestartIndex)(restart_index);
+		OGLPLUS_VERIFY_SIMPLE(PrimitiveRestartIndex);
+	}
+#else
+	if(restart_index != DrawOperation::NoRestartIndex()) {
+		assert(!
+			"Primitive restarting required, "
+			"but not supported by the used version of OpenGL!"
+		);
+	}
+#endif
+	state.known = true;
+	state.index = restart_index;
+}
+
+OGLPLUS_LIB_FUNC
+void CompiledDrawingInstructions::_finish(RestartState_& state) const
+{
+	if(state.known && (state.index != DrawOperation::NoRestartIndex()))
+	{
+#if GL_VERSION_3_1
+		OGLPLUS_GLFUNC(Disable)(GL_PRIMITIVE_RESTART);
+		OGLPLUS_VERIFY_SIMPLE(Disable);
+#endif
+		state.index = DrawOperation::NoRestartIndex();
+	}
+}
+
+OGLPLUS_LIB_FUNC
+void CompiledDrawingInstructions::_draw(
+	const Batch_& batch,
+	GLuint inst_count,
+	GLuint base_inst,
+	RestartState_& state
+) const
+{
+	const bool elements =
+		(batch.method == ShapeDrawOperationMethod::DrawElements);
+	if(elements)
+	{
+		_restart(state, batch.restart_index);
+	}
+#if GL_VERSION_4_3 || GL_ARB_multi_draw_indirect
+	if(_indirect)
+	{
+		const GLvoid* indirect = (const GLvoid*)(
+			batch.commands*sizeof(GLuint)
+		);
+		if(elements)
+		{
+			OGLPLUS_GLFUNC(MultiDrawElementsIndirect)(
+				GLenum(batch.mode),
+				GLenum(_index_info.DataType()),
+				indirect,
+				batch.count,
+				0
+			);
+			OGLPLUS_CHECK_SIMPLE(MultiDrawElementsIndirect);
+		}
+		else
+		{
+			OGLPLUS_GLFUNC(MultiDrawArraysIndirect)(
+				GLenum(batch.mode),
+				indirect,
+				batch.count,
+				0
+			);
+			OGLPLUS_CHECK_SIMPLE(MultiDrawArraysIndirect);
+		}
+		return;
+	}
+#endif
+	if(inst_count == 1)
+	{
+		if(elements)
+		{
+			OGLPLUS_GLFUNC(MultiDrawElements)(
+				GLenum(batch.mode),
+				_counts.data()+batch.first,
+				GLenum(_index_info.DataType()),
+				_offsets.data()+batch.first,
+				batch.count
+			);
+			OGLPLUS_CHECK_SIMPLE(MultiDrawElements);
+		}
+		else
+		{
+			OGLPLUS_GLFUNC(MultiDrawArrays)(
+				GLenum(batch.mode),
+				_firsts.data()+batch.first,
+				_counts.data()+batch.first,
+				batch.count
+			);
+			OGLPLUS_CHECK_SIMPLE(MultiDrawArrays);
+		}
+	}
+	else
+	{
+		// there is no instanced multi-draw without the indirect commands
+		for(GLsizei i=0; i!=batch.count; ++i)
+		{
+			_ops[std::size_t(batch.first+i)].Draw(
+				_index_info,
+				inst_count,
+				base_inst
+			);
+		}
+		if(elements)
+		{
+			// DrawOperation::Draw leaves primitive restart disabled
+			state.known = true;
+			state.index = DrawOperation::NoRestartIndex();
+		}
+	}
+}
+
+} // shapes
+} // oglplus
@@ -0,0 +1,769 @@
+/**
+ *  @file oglplus/shapes/mesh_pool.ipp
+ *  @brief Implementation of the shape mesh pool
+ *
+ *  @author Matus Chochlik
+ *
+ *  Copyright 2010-2015 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#include <oglplus/lib/incl_begin.ipp>
+#include <oglplus/glfunc.hpp>
+#include <oglplus/error/basic.hpp>
+#include <algorithm>
+#include <cassert>
+#include <oglplus/lib/incl_end.ipp>
+
+namespace oglplus {
+namespace shapes {
+
+#if OGLPLUS_DOCUMENTATION_ONLY || ( \
+	(GL_VERSION_3_2 || GL_ARB_draw_elements_base_vertex) && \
+	(GL_VERSION_3_1 || GL_ARB_copy_buffer) \
+)
+
+OGLPLUS_LIB_FUNC
+void ShapeMeshPool::_Ranges::Reset(GLuint capacity, GLuint used)
+{
+	assert(used <= capacity);
+	_capacity = capacity;
+	_free.clear();
+	if(used < capacity)
+	{
+		_free.push_back(std::make_pair(used, capacity-used));
+	}
+}
+
+OGLPLUS_LIB_FUNC
+bool ShapeMeshPool::_Ranges::Allocate(GLuint size, GLuint& offset)
+{
+	if(size == 0)
+	{
+		offset = 0;
+		return true;
+	}
+	// first fit
+	for(auto i=_free.begin(), e=_free.end(); i!=e; ++i)
+	{
+		if(i->second >= size)
+		{
+			offset = i->first;
+			i->first += size;
+			i->second -= size;
+			if(i->second == 0)
+			{
+				_free.erase(i);
+			}
+			return true;
+		}
+	}
+	return false;
+}
+
+OGLPLUS_LIB_FUNC
+void ShapeMeshPool::_Ranges::Free(GLuint offset, GLuint size)
+{
+	if(size == 0) return;
+
+	auto i = std::lower_bound(
+		_free.begin(),
+		_free.end(),
+		std::make_pair(offset, GLuint(0))
+	);
+	// merge with the following free range
+	if((i != _free.end()) && (offset+size == i->first))
+	{
+		i->first = offset;
+		i->second += size;
+	}
+	else i = _free.insert(i, std::make_pair(offset, size));
+
+	// merge with the preceding free range
+	if(i != _free.begin())
+	{
+		auto p = i-1;
+		if(p->first+p->second == i->first)
+		{
+			p->second += i->second;
+			_free.erase(i);
+		}
+	}
+}
+
+OGLPLUS_LIB_FUNC
+GLuint ShapeMeshPool::_Ranges::FreeTotal(void) const
+{
+	GLuint result = 0;
+	for(auto i=_free.begin(), e=_free.end(); i!=e; ++i)
+	{
+		result += i->second;
+	}
+	return result;
+}
+
+OGLPLUS_LIB_FUNC
+GLuint ShapeMeshPool::_Ranges::LargestFree(void) const
+{
+	GLuint result = 0;
+	for(auto i=_free.begin(), e=_free.end(); i!=e; ++i)
+	{
+		if(result < i->second)
+		{
+			result = i->second;
+		}
+	}
+	return result;
+}
+
+OGLPLUS_LIB_FUNC
+ShapeMeshPool::ShapeMeshPool(
+	const std::vector<String>& names,
+	const std::vector<GLuint>& values_per_vertex,
+	GLuint vertex_capacity,
+	GLuint index_capacity,
+	bool indirect
+): _names(names)
+ , _npvs(values_per_vertex)
+ , _values_per_vertex(0)
+ , _mesh_count(0)
+#if GL_VERSION_4_3 || GL_ARB_multi_draw_indirect
+ , _indirect(indirect)
+#else
+ , _indirect(false)
+#endif
+ , _defragmentations(0)
+ , _growths(0)
+ , _staged_attribs(names.size())
+{
+	(void)indirect;
+	assert(_names.size() == _npvs.size());
+
+	for(auto i=_npvs.begin(), e=_npvs.end(); i!=e; ++i)
+	{
+		_values_per_vertex += *i;
+	}
+
+	_vertices.Reset(vertex_capacity, 0);
+	_indices.Reset(index_capacity, 0);
+	_alloc_buffers(_vbo, _ibo, vertex_capacity, index_capacity);
+	_setup_vao();
+
+#if GL_VERSION_4_3 || GL_ARB_multi_draw_indirect
+	if(_indirect)
+	{
+		_cmd_buf = Buffer();
+	}
+#endif
+}
+
+OGLPLUS_LIB_FUNC
+GLsizeiptr ShapeMeshPool::_attrib_offset(
+	std::size_t attrib,
+	GLuint vertex,
+	GLuint capacity
+) const
+{
+	// the values of each attribute are stored in a separate
+	// range of the vertex buffer with space for capacity vertices
+	GLsizeiptr result = 0;
+	for(std::size_t i=0; i!=attrib; ++i)
+	{
+		result += GLsizeiptr(capacity)*_npvs[i];
+	}
+	result += GLsizeiptr(vertex)*_npvs[attrib];
+	return result*GLsizeiptr(sizeof(GLfloat));
+}
+
+OGLPLUS_LIB_FUNC
+void ShapeMeshPool::_alloc_buffers(
+	Buffer& vbo,
+	Buffer& ibo,
+	GLuint vertex_capacity,
+	GLuint index_capacity
+)
+{
+	vbo.Bind(BufferTarget::CopyWrite);
+	Buffer::RawData(
+		BufferTarget::CopyWrite,
+		BufferSize(
+			GLsizeiptr(vertex_capacity)*
+			_values_per_vertex*
+			GLsizeiptr(sizeof(GLfloat))
+		),
+		nullptr
+	);
+	ibo.Bind(BufferTarget::CopyWrite);
+	Buffer::RawData(
+		BufferTarget::CopyWrite,
+		BufferSize(
+			GLsizeiptr(index_capacity)*
+			GLsizeiptr(sizeof(GLuint))
+		),
+		nullptr
+	);
+}
+
+OGLPLUS_LIB_FUNC
+void ShapeMeshPool::_setup_vao(void)
+{
+	_vao.Bind();
+	_vbo.Bind(BufferTarget::Array);
+
+	const GLuint capacity = _vertices.Capacity();
+	for(std::size_t i=0, n=_names.size(); i!=n; ++i)
+	{
+		if(_npvs[i] == 0) continue;
+
+		const GLvoid* pointer = (const GLvoid*)_attrib_offset(i,0,capacity);
+		if(_prog.HasValidName())
+		{
+			try
+			{
+				VertexArrayAttrib attr(_prog, _names[i]);
+				attr.Pointer(
+					GLint(_npvs[i]),
+					DataType::Float,
+					false,
+					0,
+					pointer
+				);
+				attr.Enable();
+			}
+			catch(Error&){ }
+		}
+		else
+		{
+			VertexArrayAttrib attr((VertexAttribSlot(GLuint(i))));
+			attr.Pointer(
+				GLint(_npvs[i]),
+				DataType::Float,
+				false,
+				0,
+				pointer
+			);
+			attr.Enable();
+		}
+	}
+	_ibo.Bind(BufferTarget::ElementArray);
+	NoVertexArray().Bind();
+}
+
+OGLPLUS_LIB_FUNC
+void ShapeMeshPool::_relocate(GLuint vertex_capacity, GLuint index_capacity)
+{
+	Buffer vbo, ibo;
+	_alloc_buffers(vbo, ibo, vertex_capacity, index_capacity);
+
+	// the live meshes keep their order in the buffers
+	std::vector<MeshID> ids;
+	ids.reserve(_mesh_count);
+	for(MeshID id=0, n=MeshID(_meshes.size()); id!=n; ++id)
+	{
+		if(_meshes[id].alive) ids.push_back(id);
+	}
+
+	std::sort(ids.begin(), ids.end(), [this](MeshID a, MeshID b) -> bool
+	{
+		return _meshes[a].base_vertex < _meshes[b].base_vertex;
+	});
+	_vbo.Bind(BufferTarget::CopyRead);
+	vbo.Bind(BufferTarget::CopyWrite);
+
+	const GLuint old_capacity = _vertices.Capacity();
+	GLuint vertex_pos = 0;
+	for(auto i=ids.begin(), e=ids.end(); i!=e; ++i)
+	{
+		_Mesh& mesh = _meshes[*i];
+		for(std::size_t a=0, n=_names.size(); a!=n; ++a)
+		{
+			if((_npvs[a] == 0) || (mesh.vertex_count == 0)) continue;
+			Buffer::CopySubData(
+				BufferTarget::CopyRead,
+				BufferTarget::CopyWrite,
+				BufferSize(_attrib_offset(
+					a,
+					mesh.base_vertex,
+					old_capacity
+				)),
+				BufferSize(_attrib_offset(
+					a,
+					vertex_pos,
+					vertex_capacity
+				)),
+				BufferSize(
+					GLsizeiptr(mesh.vertex_count)*
+					_npvs[a]*
+					GLsizeiptr(sizeof(GLfloat))
+				)
+			);
+		}
+		mesh.base_vertex = vertex_pos;
+		vertex_pos += mesh.vertex_count;
+	}
+
+	std::sort(ids.begin(), ids.end(), [this](MeshID a, MeshID b) -> bool
+	{
+		return _meshes[a].first_index < _meshes[b].first_index;
+	});
+	_ibo.Bind(BufferTarget::CopyRead);
+	ibo.Bind(BufferTarget::CopyWrite);
+
+	GLuint index_pos = 0;
+	for(auto i=ids.begin(), e=ids.end(); i!=e; ++i)
+	{
+		_Mesh& mesh = _meshes[*i];
+		if(mesh.index_count != 0)
+		{
+			Buffer::CopySubData(
+				BufferTarget::CopyRead,
+				BufferTarget::CopyWrite,
+				BufferSize(
+					GLsizeiptr(mesh.first_index)*
+					GLsizeiptr(sizeof(GLuint))
+				),
+				BufferSize(
+					GLsizeiptr(index_pos)*
+					GLsizeiptr(sizeof(GLuint))
+				),
+				BufferSize(
+					GLsizeiptr(mesh.index_count)*
+					GLsizeiptr(sizeof(GLuint))
+				)
+			);
+		}
+		mesh.first_index = index_pos;
+		index_pos += mesh.index_count;
+	}
+
+	_vbo = std::move(vbo);
+	_ibo = std::move(ibo);
+	_vertices.Reset(vertex_capacity, vertex_pos);
+	_indices.Reset(index_capacity, index_pos);
+	_setup_vao();
+}
+
+OGLPLUS_LIB_FUNC
+void ShapeMeshPool::_stage_attrib(
+	std::size_t attrib,
+	const std::vector<GLfloat>& data,
+	GLuint npv
+)
+{
+	std::vector<GLfloat>& staged = _staged_attribs[attrib];
+	staged.clear();
+
+	const GLuint pool_npv = _npvs[attrib];
+	if((npv == 0) || (pool_npv == 0)) return;
+
+	const std::size_t vertex_count = data.size()/npv;
+	if(npv == pool_npv)
+	{
+		staged.assign(data.begin(), data.begin()+vertex_count*npv);
+	}
+	else
+	{
+		const GLuint n = std::min(npv, pool_npv);
+		staged.resize(vertex_count*pool_npv, GLfloat(0));
+		for(std::size_t v=0; v!=vertex_count; ++v)
+		{
+			for(GLuint c=0; c!=n; ++c)
+			{
+				staged[v*pool_npv+c] = data[v*npv+c];
+			}
+		}
+	}
+}
+
+OGLPLUS_LIB_FUNC
+ShapeMeshPool::MeshID ShapeMeshPool::_add(
+	const std::vector<DrawOperation>& ops,
+	FaceOrientation winding,
+	const Spheref& bounding_sphere
+)
+{
+	GLuint vertex_count = 0;
+	for(std::size_t i=0, n=_names.size(); i!=n; ++i)
+	{
+		if(_npvs[i] == 0) continue;
+		GLuint count = GLuint(_staged_attribs[i].size()/_npvs[i]);
+		if(vertex_count < count) vertex_count = count;
+	}
+	// the attributes missing in the shape are zero-filled
+	for(std::size_t i=0, n=_names.size(); i!=n; ++i)
+	{
+		_staged_attribs[i].resize(
+			std::size_t(vertex_count)*_npvs[i],
+			GLfloat(0)
+		);
+	}
+
+	_Mesh mesh;
+	mesh.alive = true;
+	mesh.winding = winding;
+	mesh.vertex_count = vertex_count;
+	mesh.bounding_sphere = bounding_sphere;
+	mesh.ops.reserve(ops.size());
+
+	for(auto i=ops.begin(), e=ops.end(); i!=e; ++i)
+	{
+		_Op op = { i->mode, i->first, i->count, false };
+		if(i->method == ShapeDrawOperationMethod::DrawArrays)
+		{
+			op.first = GLuint(_staged_indices.size());
+			for(GLuint k=0; k!=i->count; ++k)
+			{
+				_staged_indices.push_back(i->first+k);
+			}
+		}
+		else if(i->restart_index != DrawOperation::NoRestartIndex())
+		{
+			const GLuint end = i->first+i->count;
+			assert(end <= _staged_indices.size());
+#if GL_VERSION_3_1
+			// use the pool-wide restart index
+			for(GLuint k=i->first; k!=end; ++k)
+			{
+				if(_staged_indices[k] == i->restart_index)
+				{
+					_staged_indices[k] = DrawOperation::NoRestartIndex();
+				}
+			}
+			op.restart = true;
+#else
+			// split the primitives at the restart indices
+			GLuint first = i->first;
+			for(GLuint k=i->first; k!=end+1; ++k)
+			{
+				if((k == end) || (_staged_indices[k] == i->restart_index))
+				{
+					if(k > first)
+					{
+						_Op part = { i->mode, first, k-first, false };
+						mesh.ops.push_back(part);
+					}
+					first = k+1;
+				}
+			}
+			continue;
+#endif
+		}
+		mesh.ops.push_back(op);
+	}
+	mesh.index_count = GLuint(_staged_indices.size());
+
+	bool vertices_ok = _vertices.Allocate(vertex_count, mesh.base_vertex);
+	bool indices_ok = vertices_ok &&
+		_indices.Allocate(mesh.index_count, mesh.first_index);
+
+	if(!indices_ok)
+	{
+		if(vertices_ok)
+		{
+			_vertices.Free(mesh.base_vertex, vertex_count);
+		}
+		GLuint vertex_capacity = _vertices.Capacity();
+		GLuint index_capacity = _indices.Capacity();
+
+		if(	(_vertices.FreeTotal() >= vertex_count) &&
+			(_indices.FreeTotal() >= mesh.index_count)
+		)
+		{
+			++_defragmentations;
+		}
+		else
+		{
+			const GLuint vertices_used =
+				vertex_capacity-_vertices.FreeTotal();
+			while(vertex_capacity-vertices_used < vertex_count)
+			{
+				vertex_capacity = std::max(vertex_capacity*2, 1u);
+			}
+			const GLuint indices_used =
+				index_capacity-_indices.FreeTotal();
+			while(index_capacity-indices_used < mesh.index_count)
+			{
+				index_capacity = std::max(index_capacity*2, 1u);
+			}
+			++_growths;
+		}
+		_relocate(vertex_capacity, index_capacity);
+
+		vertices_ok = _vertices.Allocate(vertex_count, mesh.base_vertex);
+		indices_ok = _indices.Allocate(mesh.index_count, mesh.first_index);
+		assert(vertices_ok && indices_ok);
+	}
+
+	if(vertex_count != 0)
+	{
+		_vbo.Bind(BufferTarget::CopyWrite);
+		for(std::size_t i=0, n=_names.size(); i!=n; ++i)
+		{
+			if(_npvs[i] == 0) continue;
+			Buffer::SubData(
+				BufferTarget::CopyWrite,
+				BufferSize(_attrib_offset(
+					i,
+					mesh.base_vertex,
+					_vertices.Capacity()
+				)),
+				GLsizei(_staged_attribs[i].size()),
+				_staged_attribs[i].data()
+			);
+		}
+	}
+	if(mesh.index_count != 0)
+	{
+		_ibo.Bind(BufferTarget::CopyWrite);
+		Buffer::SubData(
+			BufferTarget::CopyWrite,
+			BufferSize(
+				GLsizeiptr(mesh.first_index)*
+				GLsizeiptr(sizeof(GLuint))
+			),
+			GLsizei(_staged_indices.size()),
+			_staged_indices.data()
+		);
+	}
+
+	MeshID id;
+	if(_free_ids.empty())
+	{
+		id = MeshID(_meshes.size());
+		_meshes.push_back(std::move(mesh));
+	}
+	else
+	{
+		id = _free_ids.back();
+		_free_ids.pop_back();
+		_meshes[id] = std::move(mesh);
+	}
+	++_mesh_count;
+	return id;
+}
+
+OGLPLUS_LIB_FUNC
+void ShapeMeshPool::Remove(MeshID id)
+{
+	assert(id < _meshes.size());
+	_Mesh& mesh = _meshes[id];
+	assert(mesh.alive);
+
+	_vertices.Free(mesh.base_vertex, mesh.vertex_count);
+	_indices.Free(mesh.first_index, mesh.index_count);
+	mesh.alive = false;
+	mesh.ops.clear();
+	_free_ids.push_back(id);
+	--_mesh_count;
+}
+
+OGLPLUS_LIB_FUNC
+void ShapeMeshPool::Defragment(void)
+{
+	_relocate(_vertices.Capacity(), _indices.Capacity());
+	++_defragmentations;
+}
+
+OGLPLUS_LIB_FUNC
+void ShapeMeshPool::UseInProgram(ProgramName prog)
+{
+	_prog = prog;
+	// the attribute locations of the previous program are dropped
+	_vao = VertexArray();
+	_setup_vao();
+}
+
+OGLPLUS_LIB_FUNC
+ShapeMeshPool::_Bucket& ShapeMeshPool::_bucket(
+	FaceOrientation winding,
+	PrimitiveType mode
+) const
+{
+	for(auto i=_buckets.begin(), e=_buckets.end(); i!=e; ++i)
+	{
+		if((i->winding == winding) && (i->mode == mode))
+		{
+			return *i;
+		}
+	}
+	_Bucket bucket;
+	bucket.winding = winding;
+	bucket.mode = mode;
+	_buckets.push_back(std::move(bucket));
+	return _buckets.back();
+}
+
+OGLPLUS_LIB_FUNC
+void ShapeMeshPool::_draw(const MeshID* meshes, std::size_t count) const
+{
+	if(count == 0) return;
+
+	for(auto i=_buckets.begin(), e=_buckets.end(); i!=e; ++i)
+	{
+		i->counts.clear();
+		i->offsets.clear();
+		i->base_vertices.clear();
+		i->commands.clear();
+	}
+
+	bool restart = false;
+	for(std::size_t k=0; k!=count; ++k)
+	{
+		assert(meshes[k] < _meshes.size());
+		const _Mesh& mesh = _meshes[meshes[k]];
+		assert(mesh.alive);
+
+		for(auto i=mesh.ops.begin(), e=mesh.ops.end(); i!=e; ++i)
+		{
+			_Bucket& bucket = _bucket(mesh.winding, i->mode);
+			const GLuint first = mesh.first_index+i->first;
+			restart |= i->restart;
+			if(_indirect)
+			{
+				// DrawElementsIndirectCommand
+				GLuint cmd[5] = {
+					i->count,
+					1,
+					first,
+					mesh.base_vertex,
+					GLuint(k)
+				};
+				bucket.commands.insert(bucket.commands.end(), cmd, cmd+5);
+			}
+			else
+			{
+				bucket.counts.push_back(GLsizei(i->count));
+				bucket.offsets.push_back(
+					(const GLvoid*)(first*sizeof(GLuint))
+				);
+				bucket.base_vertices.push_back(GLint(mesh.base_vertex));
+			}
+		}
+	}
+
+	_vao.Bind();
+#if GL_VERSION_3_1
+	if(restart)
+	{
+		OGLPLUS_GLFUNC(Enable)(GL_PRIMITIVE_RESTART);
+		OGLPLUS_VERIFY_SIMPLE(Enable);
+		OGLPLUS_GLFUNC(PrimitiveRestartIndex)(
+			DrawOperation::NoRestartIndex()
+		);
+		OGLPLUS_VERIFY_SIMPLE(PrimitiveRestartIndex);
+	}
+#else
+	assert(!restart);
+#endif
+
+#if GL_VERSION_4_3 || GL_ARB_multi_draw_indirect
+	BufferName previous;
+	if(_indirect)
+	{
+		_commands.clear();
+		for(auto i=_buckets.begin(), e=_buckets.end(); i!=e; ++i)
+		{
+			_commands.insert(
+				_commands.end(),
+				i->commands.begin(),
+				i->commands.end()
+			);
+		}
+		previous = Buffer::Binding(BufferTarget::DrawIndirect);
+		_cmd_buf.Bind(BufferTarget::DrawIndirect);
+		Buffer::Data(
+			BufferTarget::DrawIndirect,
+			GLsizei(_commands.size()),
+			_commands.data(),
+			BufferUsage::StreamDraw
+		);
+	}
+	GLsizeiptr indirect = 0;
+#endif
+
+	bool first = true;
+	FaceOrientation winding = FaceOrientation::CCW;
+	for(auto i=_buckets.begin(), e=_buckets.end(); i!=e; ++i)
+	{
+		if(i->counts.empty() && i->commands.empty()) continue;
+
+		if(first || (winding != i->winding))
+		{
+			winding = i->winding;
+			OGLPLUS_GLFUNC(FrontFace)(GLenum(winding));
+			OGLPLUS_VERIFY_SIMPLE(FrontFace);
+			first = false;
+		}
+#if GL_VERSION_4_3 || GL_ARB_multi_draw_indirect
+		if(_indirect)
+		{
+			OGLPLUS_GLFUNC(MultiDrawElementsIndirect)(
+				GLenum(i->mode),
+				GL_UNSIGNED_INT,
+				(const GLvoid*)indirect,
+				GLsizei(i->commands.size()/5),
+				0
+			);
+			OGLPLUS_CHECK_SIMPLE(MultiDrawElementsIndirect);
+			indirect += GLsizeiptr(i->commands.size()*sizeof(GLuint));
+			continue;
+		}
+#endif
+		OGLPLUS_GLFUNC(MultiDrawElementsBaseVertex)(
+			GLenum(i->mode),
+			i->counts.data(),
+			GL_UNSIGNED_INT,
+			i->offsets.data(),
+			GLsizei(i->counts.size()),
+			i->base_vertices.data()
+		);
+		OGLPLUS_CHECK_SIMPLE(MultiDrawElementsBaseVertex);
+	}
+
+#if GL_VERSION_4_3 || GL_ARB_multi_draw_indirect
+	if(_indirect)
+	{
+		Buffer::Bind(BufferTarget::DrawIndirect, previous);
+	}
+#endif
+#if GL_VERSION_3_1
+	if(restart)
+	{
+		OGLPLUS_GLFUNC(Disable)(GL_PRIMITIVE_RESTART);
+		OGLPLUS_VERIFY_SIMPLE(Disable);
+	}
+#endif
+}
+
+OGLPLUS_LIB_FUNC
+void ShapeMeshPool::DrawAll(void) const
+{
+	_all_ids.clear();
+	for(MeshID id=0, n=MeshID(_meshes.size()); id!=n; ++id)
+	{
+		if(_meshes[id].alive) _all_ids.push_back(id);
+	}
+	_draw(_all_ids.data(), _all_ids.size());
+}
+
+OGLPLUS_LIB_FUNC
+ShapeMeshPoolStats ShapeMeshPool::Stats(void) const
+{
+	ShapeMeshPoolStats result;
+	result.meshes = _mesh_count;
+	result.vertex_capacity = _vertices.Capacity();
+	result.vertices_used = _vertices.Capacity()-_vertices.FreeTotal();
+	result.largest_free_vertices = _vertices.LargestFree();
+	result.index_capacity = _indices.Capacity();
+	result.indices_used = _indices.Capacity()-_indices.FreeTotal();
+	result.largest_free_indices = _indices.LargestFree();
+	result.defragmentations = _defragmentations;
+	result.growths = _growths;
+	return result;
+}
+
+#endif // base vertex && copy buffer
+
+} // shapes
+} // oglplus
@@ -9,17 +9,116 @@
  *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
  */
 #include <oglplus/config/basic.hpp>
+#include <oglplus/config/simd.hpp>
+#include <cstring>
+#include <cstdint>
+#if OGLPLUS_USE_SSE2
+#include <emmintrin.h>
+#endif
 
 namespace oglplus {
 namespace aux {
 
+inline unsigned UTF8PopCount(std::uint64_t bits)
+{
+#if defined(__POPCNT__)
+	return unsigned(__builtin_popcountll(bits));
+#else
+	bits = bits - ((bits >> 1) & 0x5555555555555555ull);
+	bits = (bits & 0x3333333333333333ull)+((bits >> 2) & 0x3333333333333333ull);
+	bits = (bits + (bits >> 4)) & 0x0F0F0F0F0F0F0F0Full;
+	return unsigned((bits * 0x0101010101010101ull) >> 56);
+#endif
+}
+
+inline unsigned UTF8LowestBit(unsigned bits)
+{
+	assert(bits != 0);
+#if defined(__GNUC__) || defined(__clang__)
+	return unsigned(__builtin_ctz(bits));
+#else
+	unsigned result = 0;
+	while(!(bits & 1u))
+	{
+		bits >>= 1;
+		++result;
+	}
+	return result;
+#endif
+}
+
+// Returns the number of leading ASCII characters in the string
+// (or the number of leading non-zero ASCII characters if no_nul)
+inline std::size_t UTF8ASCIIPrefix(
+	const unsigned char* str,
+	std::size_t len,
+	bool no_nul
+)
+{
+	std::size_t i = 0;
+#if OGLPLUS_USE_SSE2
+	const __m128i zero = _mm_setzero_si128();
+	while(i+16 <= len)
+	{
+		const __m128i v = _mm_loadu_si128(
+			reinterpret_cast<const __m128i*>(str+i)
+		);
+		int mask = _mm_movemask_epi8(v);
+		if(no_nul) mask |= _mm_movemask_epi8(_mm_cmpeq_epi8(v, zero));
+		if(mask != 0) return i+UTF8LowestBit(unsigned(mask));
+		i += 16;
+	}
+#else
+	const std::uint64_t high = 0x8080808080808080ull;
+	const std::uint64_t ones = 0x0101010101010101ull;
+	while(i+8 <= len)
+	{
+		std::uint64_t w;
+		std::memcpy(&w, str+i, sizeof(w));
+		// w-ones sets the high bit of the zero bytes of ASCII words
+		if((no_nul?(w | (w-ones)):w) & high) break;
+		i += 8;
+	}
+#endif
+	while((i != len) && (str[i] < 0x80) && (!no_nul || str[i]))
+	{
+		++i;
+	}
+	return i;
+}
+
 OGLPLUS_LIB_FUNC
 std::size_t UTF8BytesRequired(const UnicodeCP* cp_str, std::size_t len)
 {
 	std::size_t result = 0;
-	for(std::size_t i=0; i!=len; ++i)
+	std::size_t i = 0;
+#if OGLPLUS_USE_SSE2
+	// one byte plus one for each exceeded limit in the loop below
+	const __m128i l1 = _mm_set1_epi32(0x0000007F);
+	const __m128i l2 = _mm_set1_epi32(0x000007FF);
+	const __m128i l3 = _mm_set1_epi32(0x0000FFFF);
+	const __m128i l4 = _mm_set1_epi32(0x001FFFFF);
+	const __m128i l5 = _mm_set1_epi32(0x03FFFFFF);
+	__m128i sum = _mm_setzero_si128();
+	for(; i+4 <= len; i += 4)
+	{
+		const __m128i v = _mm_loadu_si128(
+			reinterpret_cast<const __m128i*>(cp_str+i)
+		);
+		assert(_mm_movemask_ps(_mm_castsi128_ps(v)) == 0);
+		sum = _mm_sub_epi32(sum, _mm_cmpgt_epi32(v, l1));
+		sum = _mm_sub_epi32(sum, _mm_cmpgt_epi32(v, l2));
+		sum = _mm_sub_epi32(sum, _mm_cmpgt_epi32(v, l3));
+		sum = _mm_sub_epi32(sum, _mm_cmpgt_epi32(v, l4));
+		sum = _mm_sub_epi32(sum, _mm_cmpgt_epi32(v, l5));
+	}
+	std::uint32_t lanes[4];
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), sum);
+	result = i+lanes[0]+lanes[1]+lanes[2]+lanes[3];
+#endif
+	for(; i!=len; ++i)
 	{
-		UnicodeCP cp = *cp_str++;
+		UnicodeCP cp = cp_str[i];
 		if((cp & ~0x0000007F) == 0)
 			result += 1;
 		else if((cp & ~0x000007FF) == 0)
@@ -101,21 +200,97 @@ void ConvertCodePointsToUTF8(
 	std::vector<char>& result
 )
 {
-	std::size_t u8len = UTF8BytesRequired(cps, len);
-	result.resize(u8len);
+	result.resize(UTF8BytesRequired(cps, len));
 	char* cptr = result.data();
+	char* const cend = cptr+result.size();
+#if OGLPLUS_USE_SSE2
+	const UnicodeCP* simd_from = cps;
+#endif
 	std::size_t clen = 0;
 	while(len)
 	{
-		assert(u8len >= clen);
-		ConvertCodePointToUTF8(*cps, cptr, clen);
+		// loaded once, the stores below may alias the code points
+		const UnicodeCP cp = *cps;
+		if(cp < 0x80)
+		{
+#if OGLPLUS_USE_SSE2
+			// a block of 16 code points is packed to bytes
+			// but only its leading ASCII characters are used
+			if((len >= 16) && (cend-cptr >= 16) && (cps >= simd_from))
+			{
+				const __m128i high = _mm_set1_epi32(~0x7F);
+				const __m128i zero = _mm_setzero_si128();
+				const __m128i* p = reinterpret_cast<const __m128i*>(cps);
+				const __m128i a = _mm_loadu_si128(p+0);
+				const __m128i b = _mm_loadu_si128(p+1);
+				const __m128i c = _mm_loadu_si128(p+2);
+				const __m128i d = _mm_loadu_si128(p+3);
+				// the bits of the lanes with ASCII code points are set
+				const unsigned ascii = unsigned(_mm_movemask_epi8(
+					_mm_packs_epi16(
+						_mm_packs_epi32(
+							_mm_cmpeq_epi32(_mm_and_si128(a, high), zero),
+							_mm_cmpeq_epi32(_mm_and_si128(b, high), zero)
+						),
+						_mm_packs_epi32(
+							_mm_cmpeq_epi32(_mm_and_si128(c, high), zero),
+							_mm_cmpeq_epi32(_mm_and_si128(d, high), zero)
+						)
+					)
+				));
+				const unsigned mask = ~ascii & 0xFFFFu;
+				const std::size_t n = mask?UTF8LowestBit(mask):16;
+				// the rest of a mixed block is encoded one by one
+				simd_from = cps+16;
+
+				_mm_storeu_si128(
+					reinterpret_cast<__m128i*>(cptr),
+					_mm_packus_epi16(
+						_mm_packs_epi32(a, b),
+						_mm_packs_epi32(c, d)
+					)
+				);
+				cptr += n;
+				len -= n;
+				cps += n;
+				continue;
+			}
+			assert(cptr < cend);
+			*cptr++ = char(cp);
+			cps += 1;
+			len -= 1;
+#else
+			// the whole run of ASCII characters is copied
+			do
+			{
+				assert(cptr < cend);
+				*cptr++ = char(*cps++);
+				len -= 1;
+			}
+			while(len && (*cps < 0x80));
+#endif
+			continue;
+		}
+		else if(cp < 0x800)
+		{
+			cptr[0] = char(((cp & 0x000007C0) >>  6) | 0xC0);
+			cptr[1] = char(((cp & 0x0000003F) >>  0) | 0x80);
+			clen = 2;
+		}
+		else if(cp < 0x10000)
+		{
+			cptr[0] = char(((cp & 0x0000F000) >> 12) | 0xE0);
+			cptr[1] = char(((cp & 0x00000FC0) >>  6) | 0x80);
+			cptr[2] = char(((cp & 0x0000003F) >>  0) | 0x80);
+			clen = 3;
+		}
+		else ConvertCodePointToUTF8(cp, cptr, clen);
 		assert(clen > 0);
-		u8len -= clen;
 		cptr += clen;
 		len -= 1;
 		cps += 1;
 	}
-	assert(u8len == 0);
+	assert(cptr == cend);
 }
 
 OGLPLUS_LIB_FUNC
@@ -126,26 +301,40 @@ std::size_t CodePointsRequired(const char* str, std::size_t len)
 
 	std::size_t result = 0;
 
-	while(len)
+	// in valid UTF-8 the code points are the bytes which are not
+	// continuation bytes (10xxxxxx) and sequences can be split freely
+	std::size_t i = 0;
+#if OGLPLUS_USE_SSE2
+	// the continuation bytes are less than -64 as signed chars
+	const __m128i limit = _mm_set1_epi8(-65);
+	const __m128i zero = _mm_setzero_si128();
+	while(i+16 <= len)
 	{
-		std::size_t skip = 0;
-		if(((*pb) & 0x80) == 0x00)
-			skip = 1;
-		else if(((*pb) & 0xE0) == 0xC0)
-			skip = 2;
-		else if(((*pb) & 0xF0) == 0xE0)
-			skip = 3;
-		else if(((*pb) & 0xF8) == 0xF0)
-			skip = 4;
-		else if(((*pb) & 0xFC) == 0xF8)
-			skip = 5;
-		else if(((*pb) & 0xFE) == 0xFC)
-			skip = 6;
-		else assert(!"Invalid UTF8 sequence");
-		assert(len >= skip);
-		len -= skip;
-		pb += skip;
-		++result;
+		// the per-byte counters are summed before they overflow
+		__m128i counts = zero;
+		for(unsigned b=0; (b != 255) && (i+16 <= len); ++b, i += 16)
+		{
+			const __m128i v = _mm_loadu_si128(
+				reinterpret_cast<const __m128i*>(pb+i)
+			);
+			counts = _mm_sub_epi8(counts, _mm_cmpgt_epi8(v, limit));
+		}
+		const __m128i sums = _mm_sad_epu8(counts, zero);
+		result += std::size_t(_mm_cvtsi128_si32(sums));
+		result += std::size_t(_mm_cvtsi128_si32(_mm_srli_si128(sums, 8)));
+	}
+#else
+	for(; i+8 <= len; i += 8)
+	{
+		std::uint64_t w;
+		std::memcpy(&w, pb+i, sizeof(w));
+		// the high bit is set only in the continuation bytes
+		result += 8-UTF8PopCount(w & ~(w << 1) & 0x8080808080808080ull);
+	}
+#endif
+	for(; i!=len; ++i)
+	{
+		if((pb[i] & 0xC0) != 0x80) ++result;
 	}
 	return result;
 }
@@ -177,8 +366,8 @@ UnicodeCP ConvertUTF8ToCodePoint(const char* str, std::size_t len, std::size_t&
 	// 1110xxxx
 	else if((bytes[0] & 0xF0) == 0xE0)
 	{
-		// but not 11100000
-		assert(bytes[0] != 0xE0);
+		// but not an overlong 11100000 100xxxxx
+		assert((bytes[0] != 0xE0) || (bytes[1] >= 0xA0));
 		assert(len >= 3);
 		cp_len = 3;
 		return UnicodeCP(
@@ -190,8 +379,8 @@ UnicodeCP ConvertUTF8ToCodePoint(const char* str, std::size_t len, std::size_t&
 	// 11110xxx
 	else if((bytes[0] & 0xF8) == 0xF0)
 	{
-		// but not 11110000
-		assert(bytes[0] != 0xF0);
+		// but not an overlong 11110000 1000xxxx
+		assert((bytes[0] != 0xF0) || (bytes[1] >= 0x90));
 		assert(len >= 4);
 		cp_len = 4;
 		return UnicodeCP(
@@ -204,8 +393,8 @@ UnicodeCP ConvertUTF8ToCodePoint(const char* str, std::size_t len, std::size_t&
 	// 111110xx
 	else if((bytes[0] & 0xFC) == 0xF8)
 	{
-		// but not 11111000
-		assert(bytes[0] != 0xF8);
+		// but not an overlong 11111000 10000xxx
+		assert((bytes[0] != 0xF8) || (bytes[1] >= 0x88));
 		assert(len >= 5);
 		cp_len = 5;
 		return UnicodeCP(
@@ -219,8 +408,8 @@ UnicodeCP ConvertUTF8ToCodePoint(const char* str, std::size_t len, std::size_t&
 	// 1111110x
 	else if((bytes[0] & 0xFE) == 0xFC)
 	{
-		// but not 11111100
-		assert(bytes[0] != 0xFC);
+		// but not an overlong 11111100 100000xx
+		assert((bytes[0] != 0xFC) || (bytes[1] >= 0x84));
 		assert(len >= 6);
 		cp_len = 6;
 		return UnicodeCP(
@@ -246,20 +435,108 @@ void ConvertUTF8ToCodePoints(
 	std::size_t ulen = CodePointsRequired(str, len);
 	result.resize(ulen);
 	UnicodeCP* cpptr = result.data();
+	const unsigned char* pb=reinterpret_cast<const unsigned char*>(str);
+#if OGLPLUS_USE_SSE2
+	const unsigned char* simd_from = pb;
+#endif
 	std::size_t cplen = 0;
 	while(len)
 	{
-		*cpptr = ConvertUTF8ToCodePoint(str, len, cplen);
+		if(pb[0] < 0x80)
+		{
+#if OGLPLUS_USE_SSE2
+			// a block of 16 bytes is widened to code points
+			// but only its leading ASCII characters are used
+			if((len >= 16) && (ulen >= 16) && (pb >= simd_from))
+			{
+				const __m128i zero = _mm_setzero_si128();
+				const __m128i v = _mm_loadu_si128(
+					reinterpret_cast<const __m128i*>(pb)
+				);
+				const unsigned mask = unsigned(_mm_movemask_epi8(v));
+				const std::size_t n = mask?UTF8LowestBit(mask):16;
+				// the rest of a mixed block is decoded one by one
+				simd_from = pb+16;
+
+				const __m128i lo = _mm_unpacklo_epi8(v, zero);
+				const __m128i hi = _mm_unpackhi_epi8(v, zero);
+				__m128i* p = reinterpret_cast<__m128i*>(cpptr);
+				_mm_storeu_si128(p+0, _mm_unpacklo_epi16(lo, zero));
+				_mm_storeu_si128(p+1, _mm_unpackhi_epi16(lo, zero));
+				_mm_storeu_si128(p+2, _mm_unpacklo_epi16(hi, zero));
+				_mm_storeu_si128(p+3, _mm_unpackhi_epi16(hi, zero));
+
+				cpptr += n;
+				ulen -= n;
+				pb += n;
+				len -= n;
+				continue;
+			}
+#endif
+			cplen = 1;
+			*cpptr = UnicodeCP(pb[0]);
+		}
+		// 110xxxxx 10xxxxxx
+		else if(((pb[0] & 0xE0) == 0xC0) && (len >= 2))
+		{
+			cplen = 2;
+			*cpptr = UnicodeCP(
+				((pb[0] & 0x1F) <<  6)|
+				((pb[1] & 0x3F) <<  0)
+			);
+		}
+		// 1110xxxx 10xxxxxx 10xxxxxx
+		else if(((pb[0] & 0xF0) == 0xE0) && (len >= 3))
+		{
+			cplen = 3;
+			*cpptr = UnicodeCP(
+				((pb[0] & 0x0F) << 12)|
+				((pb[1] & 0x3F) <<  6)|
+				((pb[2] & 0x3F) <<  0)
+			);
+		}
+		// 11110xxx 10xxxxxx 10xxxxxx 10xxxxxx
+		else if(((pb[0] & 0xF8) == 0xF0) && (len >= 4))
+		{
+			cplen = 4;
+			*cpptr = UnicodeCP(
+				((pb[0] & 0x07) << 18)|
+				((pb[1] & 0x3F) << 12)|
+				((pb[2] & 0x3F) <<  6)|
+				((pb[3] & 0x3F) <<  0)
+			);
+		}
+		else
+		{
+			*cpptr = ConvertUTF8ToCodePoint(
+				reinterpret_cast<const char*>(pb),
+				len,
+				cplen
+			);
+		}
 		++cpptr;
 		assert(cplen > 0);
 		assert(len >= cplen);
 		len -= cplen;
-		str += cplen;
+		pb += cplen;
 		ulen -= 1;
 	}
 	assert(ulen == 0);
 }
 
+// checks if the sequence starting with the specified lead byte
+// encodes a code point that would fit into a shorter sequence
+inline bool UTF8Overlong(
+	const char* s,
+	const char* end,
+	unsigned char lead,
+	unsigned char min
+)
+{
+	if(static_cast<unsigned char>(s[0]) != lead) return false;
+	return (s+1 != end) && (static_cast<unsigned char>(s[1]) < min);
+}
+
 OGLPLUS_LIB_FUNC
 bool UTF8Validator::_is_valid_ptr(const char* _s)
 {
@@ -280,6 +557,16 @@ const char* UTF8Validator::_validate(const char* _s, const char* _end)
 	assert(_is_valid_ptr(_s));
 	while((_s != _end) && (byte(_s) != 0x00))
 	{
+		// skip the runs of ASCII characters
+		if(!bytes && !(byte(_s) & 0x80))
+		{
+			_s += UTF8ASCIIPrefix(
+				reinterpret_cast<const unsigned char*>(_s),
+				std::size_t(_end-_s),
+				true
+			);
+			if((_s == _end) || (byte(_s) == 0x00)) break;
+		}
 		// there are remaining bytes in the sequence
 		if(bytes)
 		{
@@ -302,32 +589,32 @@ const char* UTF8Validator::_validate(const char* _s, const char* _end)
 			// 1110xxxx
 			else if((byte(_s) & 0xF0) == 0xE0)
 			{
-				// but not 11100000
-				if(byte(_s) == 0xE0)
+				// but not an overlong 11100000 100xxxxx
+				if(UTF8Overlong(_s, _end, 0xE0, 0xA0))
 					return nullptr;
 				bytes = 2;
 			}
 			// 11110xxx
 			else if((byte(_s) & 0xF8) == 0xF0)
 			{
-				// but not 11110000
-				if(byte(_s) == 0xF0)
+				// but not an overlong 11110000 1000xxxx
+				if(UTF8Overlong(_s, _end, 0xF0, 0x90))
 					return nullptr;
 				bytes = 3;
 			}
 			// 111110xx
 			else if((byte(_s) & 0xFC) == 0xF8)
 			{
-				// but not 11111000
-				if(byte(_s) == 0xF8)
+				// but not an overlong 11111000 10000xxx
+				if(UTF8Overlong(_s, _end, 0xF8, 0x88))
 					return nullptr;
 				bytes = 4;
 			}
 			// 1111110x
 			else if((byte(_s) & 0xFE) == 0xFC)
 			{
-				// but not 11111100
-				if(byte(_s) == 0xFC)
+				// but not an overlong 11111100 100000xx
+				if(UTF8Overlong(_s, _end, 0xFC, 0x84))
 					return nullptr;
 				bytes = 5;
 			}
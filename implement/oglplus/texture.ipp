@@ -12,7 +12,11 @@
 #include <oglplus/lib/incl_begin.ipp>
 #include <oglplus/images/image_spec.hpp>
 #include <oglplus/images/image.hpp>
+#include <oglplus/images/mipmap.hpp>
+#include <oglplus/images/compressed.hpp>
+#include <oglplus/images/container.hpp>
 #include <oglplus/lib/incl_end.ipp>
+#include <stdexcept>
 
 namespace oglplus {
 
@@ -525,6 +529,274 @@ Image(
 	}
 }
 
+OGLPLUS_LIB_FUNC
+void ObjZeroOps<tag::ExplicitSel, tag::Texture>::
+Image(
+	Target target,
+	const images::MipmapChain& mipmaps
+)
+{
+#ifdef GL_TEXTURE_CUBE_MAP
+	if(target == Target::CubeMap)
+	{
+		// the faces are stored as the layers of the images
+		if(	!mipmaps.IsLayered() ||
+			(mipmaps.Levels() == 0) ||
+			(mipmaps.Level(0).Depth() != 6)
+		)
+		{
+			throw std::runtime_error(
+				"Cube map textures require a layered mipmap "
+				"chain with six faces"
+			);
+		}
+	}
+#endif
+	for(std::size_t l=0, n=mipmaps.Levels(); l!=n; ++l)
+	{
+		const images::Image& image = mipmaps.Level(l);
+#ifdef GL_TEXTURE_CUBE_MAP
+		if(target == Target::CubeMap)
+		{
+			assert(image.Depth() == 6);
+			const std::size_t face_size = image.DataSize()/6;
+			for(GLuint face=0; face!=6; ++face)
+			{
+				Image2D(
+					Target(GL_TEXTURE_CUBE_MAP_POSITIVE_X+face),
+					GLint(l),
+					image.InternalFormat(),
+					image.Width(),
+					image.Height(),
+					0,
+					image.Format(),
+					image.Type(),
+					static_cast<const GLubyte*>(image.RawData())+
+					face*face_size
+				);
+			}
+			continue;
+		}
+#endif
+		Image(target, image, GLint(l));
+	}
+	MaxLevel(target, GLint(mipmaps.Levels())-1);
+}
+
+OGLPLUS_LIB_FUNC
+void ObjZeroOps<tag::ExplicitSel, tag::Texture>::
+Image(
+	Target target,
+	const images::ImageContainer& container
+)
+{
+#ifdef GL_TEXTURE_CUBE_MAP
+	if((target == Target::CubeMap) && (container.Faces() != 6))
+	{
+		throw std::runtime_error(
+			"Cube map textures require a container with six faces"
+		);
+	}
+#endif
+	OGLPLUS_GLFUNC(PixelStorei)(
+		GL_UNPACK_ALIGNMENT,
+		GLint(container.RowAlignment())
+	);
+	OGLPLUS_CHECK_SIMPLE(PixelStorei);
+
+	const bool compressed = container.IsCompressed();
+	std::vector<GLubyte> buffer;
+	for(GLuint l=0, n=container.Levels(); l!=n; ++l)
+	{
+		const images::ImageContainerView& base = container.View(l);
+#ifdef GL_TEXTURE_CUBE_MAP
+		if(target == Target::CubeMap)
+		{
+			assert(container.Faces() == 6);
+			for(GLuint face=0; face!=6; ++face)
+			{
+				const images::ImageContainerView& view =
+					container.View(l, 0, face);
+				const Target face_target =
+					Target(GL_TEXTURE_CUBE_MAP_POSITIVE_X+face);
+				if(compressed)
+				{
+					CompressedImage2D(
+						face_target,
+						GLint(l),
+						container.InternalFormat(),
+						view.Width(),
+						view.Height(),
+						0,
+						GLsizei(view.DataSize()),
+						view.Data()
+					);
+				}
+				else
+				{
+					Image2D(
+						face_target,
+						GLint(l),
+						container.InternalFormat(),
+						view.Width(),
+						view.Height(),
+						0,
+						container.Format(),
+						container.Type(),
+						view.Data()
+					);
+				}
+			}
+			continue;
+		}
+#endif
+		if(TextureTargetDimensions(target) == 3)
+		{
+			// the layers (and faces) of arrays are the depth
+			const GLsizei depth = base.Depth()*GLsizei(
+				container.Layers()*container.Faces()
+			);
+			const GLubyte* data = container.LevelData(l, buffer);
+			if(compressed)
+			{
+				CompressedImage3D(
+					target,
+					GLint(l),
+					container.InternalFormat(),
+					base.Width(),
+					base.Height(),
+					depth,
+					0,
+					GLsizei(container.LevelDataSize(l)),
+					data
+				);
+			}
+			else
+			{
+				Image3D(
+					target,
+					GLint(l),
+					container.InternalFormat(),
+					base.Width(),
+					base.Height(),
+					depth,
+					0,
+					container.Format(),
+					container.Type(),
+					data
+				);
+			}
+		}
+		else
+		{
+			assert(TextureTargetDimensions(target) == 2);
+			if(compressed)
+			{
+				CompressedImage2D(
+					target,
+					GLint(l),
+					container.InternalFormat(),
+					base.Width(),
+					base.Height(),
+					0,
+					GLsizei(base.DataSize()),
+					base.Data()
+				);
+			}
+			else
+			{
+				Image2D(
+					target,
+					GLint(l),
+					container.InternalFormat(),
+					base.Width(),
+					base.Height(),
+					0,
+					container.Format(),
+					container.Type(),
+					base.Data()
+				);
+			}
+		}
+	}
+	MaxLevel(target, GLint(container.Levels())-1);
+}
+
+OGLPLUS_LIB_FUNC
+void ObjZeroOps<tag::ExplicitSel, tag::Texture>::
+CompressedImage(
+	Target target,
+	const images::CompressedImage& image,
+	GLint level,
+	GLint border
+)
+{
+#ifdef GL_TEXTURE_CUBE_MAP
+	if(target == Target::CubeMap)
+	{
+		// the faces are stored as the layers of the image
+		assert(image.Depth() == 6);
+		const std::size_t face_size = image.DataSize()/6;
+		for(GLuint face=0; face!=6; ++face)
+		{
+			CompressedImage2D(
+				Target(GL_TEXTURE_CUBE_MAP_POSITIVE_X+face),
+				level,
+				image.InternalFormat(),
+				image.Width(),
+				image.Height(),
+				border,
+				GLsizei(face_size),
+				image.Data()+face*face_size
+			);
+		}
+		return;
+	}
+#endif
+	if(TextureTargetDimensions(target) == 3)
+	{
+		CompressedImage3D(
+			target,
+			level,
+			image.InternalFormat(),
+			image.Width(),
+			image.Height(),
+			image.Depth(),
+			border,
+			GLsizei(image.DataSize()),
+			image.Data()
+		);
+	}
+	else
+	{
+		assert(TextureTargetDimensions(target) == 2);
+		CompressedImage2D(
+			target,
+			level,
+			image.InternalFormat(),
+			image.Width(),
+			image.Height(),
+			border,
+			GLsizei(image.DataSize()),
+			image.Data()
+		);
+	}
+}
+
+OGLPLUS_LIB_FUNC
+void ObjZeroOps<tag::ExplicitSel, tag::Texture>::
+CompressedImage(
+	Target target,
+	const images::CompressedMipmapChain& mipmaps
+)
+{
+	for(std::size_t l=0, n=mipmaps.Levels(); l!=n; ++l)
+	{
+		CompressedImage(target, mipmaps.Level(l), GLint(l));
+	}
+	MaxLevel(target, GLint(mipmaps.Levels())-1);
+}
+
 OGLPLUS_LIB_FUNC
 void ObjZeroOps<tag::ExplicitSel, tag::Texture>::
 Image(
@@ -0,0 +1,476 @@
+/**
+ *  @file oglplus/texture_streamer.ipp
+ *  @brief Implementation of the texture streamer
+ *
+ *  @author Matus Chochlik
+ *
+ *  Copyright 2010-2015 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#include <oglplus/lib/incl_begin.ipp>
+#include <oglplus/error/object.hpp>
+#include <oglplus/lib/incl_end.ipp>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <vector>
+#include <stdexcept>
+#include <cassert>
+
+namespace oglplus {
+
+#if OGLPLUS_DOCUMENTATION_ONLY || GL_VERSION_4_4 || GL_ARB_buffer_storage
+
+namespace aux {
+
+inline double StreamerSeconds(
+	std::chrono::steady_clock::time_point start
+)
+{
+	return std::chrono::duration<double>(
+		std::chrono::steady_clock::now()-start
+	).count();
+}
+
+// the target to which textures updated through a target are bound
+inline TextureTarget StreamerBindTarget(TextureTarget target)
+{
+#if defined(GL_TEXTURE_CUBE_MAP_POSITIVE_X)
+	if(
+		(GLenum(target) >= GL_TEXTURE_CUBE_MAP_POSITIVE_X) &&
+		(GLenum(target) <= GL_TEXTURE_CUBE_MAP_NEGATIVE_Z)
+	) return TextureTarget::CubeMap;
+#endif
+	return target;
+}
+
+// saves and restores the unpack state around the uploads
+class StreamerUnpackState
+{
+private:
+	BufferName _buffer;
+	GLint _alignment;
+	GLint _new_alignment;
+
+	struct _texture
+	{
+		TextureTarget target;
+		TextureName previous;
+		GLuint current;
+	};
+	std::vector<_texture> _textures;
+
+	StreamerUnpackState(const StreamerUnpackState&);
+public:
+	StreamerUnpackState(BufferName buffer, GLint alignment)
+	 : _buffer(Buffer::Binding(BufferTarget::PixelUnpack))
+	 , _alignment(4)
+	 , _new_alignment(alignment)
+	{
+		OGLPLUS_GLFUNC(GetIntegerv)(GL_UNPACK_ALIGNMENT, &_alignment);
+		OGLPLUS_VERIFY_SIMPLE(GetIntegerv);
+
+		Buffer::Bind(BufferTarget::PixelUnpack, buffer);
+		if(_alignment != _new_alignment)
+		{
+			OGLPLUS_GLFUNC(PixelStorei)(
+				GL_UNPACK_ALIGNMENT,
+				_new_alignment
+			);
+			OGLPLUS_CHECK_SIMPLE(PixelStorei);
+		}
+	}
+
+	void BindTexture(TextureTarget target, GLuint texture)
+	{
+		target = StreamerBindTarget(target);
+		auto i = _textures.begin();
+		while((i != _textures.end()) && (i->target != target)) ++i;
+		if(i == _textures.end())
+		{
+			_texture entry = {target, Texture::Binding(target), 0};
+			i = _textures.insert(i, entry);
+		}
+		else if(i->current == texture) return;
+
+		Texture::Bind(target, ObjectName<tag::Texture>(texture));
+		i->current = texture;
+	}
+
+	~StreamerUnpackState(void)
+	{
+		for(auto i=_textures.begin(); i!=_textures.end(); ++i)
+		{
+			Texture::Bind(i->target, i->previous);
+		}
+		if(_alignment != _new_alignment)
+		{
+			OGLPLUS_GLFUNC(PixelStorei)(
+				GL_UNPACK_ALIGNMENT,
+				_alignment
+			);
+		}
+		Buffer::Bind(BufferTarget::PixelUnpack, _buffer);
+	}
+};
+
+} // namespace aux
+
+OGLPLUS_LIB_FUNC
+TextureStreamer::TextureStreamer(std::size_t ring_size)
+ : _mapped(nullptr)
+ , _ring(ring_size)
+#if !OGLPLUS_NO_THREADS
+ , _stop(false)
+#endif
+{
+	ResetStats();
+
+	const BufferName previous = Buffer::Binding(BufferTarget::PixelUnpack);
+	Buffer::Bind(BufferTarget::PixelUnpack, _buffer);
+	Buffer::Storage(
+		BufferTarget::PixelUnpack,
+		BufferSize(ring_size),
+		nullptr,
+		BufferStorageBit::MapWrite|
+		BufferStorageBit::MapPersistent|
+		BufferStorageBit::MapCoherent
+	);
+	// BufferRawMap unmaps on destruction, the ring stays mapped
+	// until the buffer is deleted
+	_mapped = static_cast<GLubyte*>(OGLPLUS_GLFUNC(MapBufferRange)(
+		GL_PIXEL_UNPACK_BUFFER,
+		0,
+		GLsizeiptr(ring_size),
+		GL_MAP_WRITE_BIT|
+		GL_MAP_PERSISTENT_BIT|
+		GL_MAP_COHERENT_BIT
+	));
+	OGLPLUS_CHECK(
+		MapBufferRange,
+		Error,
+		EnumParam(BufferTarget::PixelUnpack)
+	);
+	Buffer::Bind(BufferTarget::PixelUnpack, previous);
+
+#if !OGLPLUS_NO_THREADS
+	_worker = std::thread(&TextureStreamer::_work, this);
+#endif
+}
+
+OGLPLUS_LIB_FUNC
+TextureStreamer::~TextureStreamer(void)
+{
+#if !OGLPLUS_NO_THREADS
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_stop = true;
+	}
+	_copy_cv.notify_all();
+	_worker.join();
+#endif
+}
+
+#if !OGLPLUS_NO_THREADS
+OGLPLUS_LIB_FUNC
+void TextureStreamer::_work(void)
+{
+	while(true)
+	{
+		_upload* upload = nullptr;
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+			while(!_stop && _copy_queue.empty())
+			{
+				_copy_cv.wait(lock);
+			}
+			if(_stop) return;
+			upload = _copy_queue.front();
+			_copy_queue.pop_front();
+		}
+		// the reserved segment is not touched by the GL thread
+		// until the upload is marked as copied
+		const double copy_time = _copy(_mapped+upload->offset, *upload);
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			upload->copy_time = copy_time;
+			upload->copied = true;
+		}
+		_done_cv.notify_all();
+	}
+}
+#endif
+
+OGLPLUS_LIB_FUNC
+double TextureStreamer::_copy(GLubyte* dest, _upload& upload)
+{
+	const auto start = std::chrono::steady_clock::now();
+	const images::Image& image = upload.image;
+	const GLubyte* src = static_cast<const GLubyte*>(image.RawData());
+	const std::size_t rows = std::size_t(image.Height())*image.Depth();
+	const std::size_t row = image.DataSize()/rows;
+
+	if(row == upload.stride)
+	{
+		std::memcpy(dest, src, image.DataSize());
+	}
+	else
+	{
+		for(std::size_t r=0; r!=rows; ++r)
+		{
+			std::memcpy(dest, src, row);
+			dest += upload.stride;
+			src += row;
+		}
+	}
+	return aux::StreamerSeconds(start);
+}
+
+OGLPLUS_LIB_FUNC
+void TextureStreamer::_reserve(_upload& upload)
+{
+	const std::size_t size = (upload.stride*(
+		std::size_t(upload.image.Height())*
+		upload.image.Depth()
+	)+15) & ~std::size_t(15);
+	assert(size <= _ring.Size());
+
+	bool stalled = false;
+	auto start = std::chrono::steady_clock::now();
+	while(true)
+	{
+		// the rest of the ring is skipped if the image does not fit
+		const std::size_t head = _ring.Head();
+		const std::size_t waste =
+			(head+size > _ring.Size())?_ring.Size()-head:0;
+		if(_ring.Free() >= waste+size)
+		{
+			upload.offset = waste?0:head;
+			upload.reserved = waste+size;
+			break;
+		}
+		if(_ring.Recycle(false)) continue;
+
+		if(_ring.Pending() == 0)
+		{
+			// the space is held by the uploads not issued yet
+			_issue(true);
+		}
+		else
+		{
+			if(!stalled)
+			{
+				stalled = true;
+				start = std::chrono::steady_clock::now();
+				++_stats.stalls;
+			}
+			_ring.Recycle(true);
+		}
+	}
+	if(stalled)
+	{
+		_stats.stall_time += aux::StreamerSeconds(start);
+	}
+	_ring.Reserve(upload.offset+size, upload.reserved);
+}
+
+OGLPLUS_LIB_FUNC
+GLuint TextureStreamer::_dimensions(TextureTarget target)
+{
+	const GLuint dims = TextureTargetDimensions(target);
+	if((dims != 2) && (dims != 3))
+	{
+		throw std::runtime_error(
+			"The texture streamer supports only two and "
+			"three dimensional texture targets"
+		);
+	}
+	return dims;
+}
+
+OGLPLUS_LIB_FUNC
+void TextureStreamer::_sub_image(const _upload& upload, const void* data)
+{
+	const images::Image& image = upload.image;
+	switch(_dimensions(upload.target))
+	{
+		case 3:
+		{
+			Texture::SubImage3D(
+				upload.target,
+				upload.level,
+				upload.xoffs,
+				upload.yoffs,
+				upload.zoffs,
+				image.Width(),
+				image.Height(),
+				image.Depth(),
+				image.Format(),
+				image.Type(),
+				data
+			);
+			break;
+		}
+		case 2:
+		{
+			assert(image.Depth() == 1);
+			Texture::SubImage2D(
+				upload.target,
+				upload.level,
+				upload.xoffs,
+				upload.yoffs,
+				image.Width(),
+				image.Height(),
+				image.Format(),
+				image.Type(),
+				data
+			);
+			break;
+		}
+	}
+}
+
+OGLPLUS_LIB_FUNC
+std::size_t TextureStreamer::_issue(bool wait)
+{
+	std::size_t count = 0;
+	{
+#if !OGLPLUS_NO_THREADS
+		std::unique_lock<std::mutex> lock(_mutex);
+		if(wait)
+		{
+			while(!_copy_queue.empty() || (
+				!_uploads.empty() &&
+				!_uploads.back().copied
+			)) _done_cv.wait(lock);
+		}
+#else
+		(void)wait;
+#endif
+		while((count != _uploads.size()) && _uploads[count].copied)
+		{
+			++count;
+		}
+	}
+	if(count == 0) return 0;
+
+	std::size_t reserved = 0;
+	{
+		aux::StreamerUnpackState state(_buffer, 4);
+		for(std::size_t i=0; i!=count; ++i)
+		{
+			const _upload& upload = _uploads[i];
+			state.BindTexture(upload.target, upload.texture);
+			_sub_image(upload, reinterpret_cast<const void*>(
+				upload.offset
+			));
+			reserved += upload.reserved;
+
+			++_stats.uploads;
+			_stats.bytes += upload.image.DataSize();
+			_stats.copy_time += upload.copy_time;
+		}
+	}
+	_ring.Fence(reserved);
+	++_stats.fences;
+
+	{
+#if !OGLPLUS_NO_THREADS
+		std::lock_guard<std::mutex> lock(_mutex);
+#endif
+		_uploads.erase(_uploads.begin(), _uploads.begin()+count);
+	}
+	return count;
+}
+
+OGLPLUS_LIB_FUNC
+void TextureStreamer::_direct(const _upload& upload)
+{
+	aux::StreamerUnpackState state(BufferName(), 1);
+	state.BindTexture(upload.target, upload.texture);
+	_sub_image(upload, upload.image.RawData());
+}
+
+OGLPLUS_LIB_FUNC
+void TextureStreamer::Upload(
+	TextureName texture,
+	TextureTarget target,
+	images::Image image,
+	GLint level,
+	GLint xoffs,
+	GLint yoffs,
+	GLint zoffs
+)
+{
+	// nothing is queued if the target is not supported
+	_dimensions(target);
+
+	_upload upload(std::move(image), target, GetGLName(texture));
+	upload.level = level;
+	upload.xoffs = xoffs;
+	upload.yoffs = yoffs;
+	upload.zoffs = zoffs;
+
+	const std::size_t rows =
+		std::size_t(upload.image.Height())*
+		upload.image.Depth();
+	const std::size_t row = upload.image.DataSize()/rows;
+	upload.stride = (row+3) & ~std::size_t(3);
+
+	if(((upload.stride*rows+15) & ~std::size_t(15)) > _ring.Size())
+	{
+		// keep the order of the updates of the same texture
+		_issue(true);
+		_direct(upload);
+		++_stats.direct_uploads;
+		_stats.bytes += upload.image.DataSize();
+		return;
+	}
+	_reserve(upload);
+
+#if !OGLPLUS_NO_THREADS
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_uploads.push_back(std::move(upload));
+		_copy_queue.push_back(&_uploads.back());
+	}
+	_copy_cv.notify_one();
+#else
+	upload.copy_time = _copy(_mapped+upload.offset, upload);
+	upload.copied = true;
+	_uploads.push_back(std::move(upload));
+#endif
+}
+
+OGLPLUS_LIB_FUNC
+std::size_t TextureStreamer::Poll(void)
+{
+	const std::size_t count = _issue(false);
+	while(_ring.Recycle(false));
+	return count;
+}
+
+OGLPLUS_LIB_FUNC
+void TextureStreamer::Finish(void)
+{
+	_issue(true);
+	while(_ring.Recycle(false));
+}
+
+OGLPLUS_LIB_FUNC
+void TextureStreamer::ResetStats(void)
+{
+	_stats.uploads = 0;
+	_stats.direct_uploads = 0;
+	_stats.bytes = 0;
+	_stats.fences = 0;
+	_stats.stalls = 0;
+	_stats.stall_time = 0;
+	_stats.copy_time = 0;
+}
+
+#endif // buffer storage
+
+} // namespace oglplus
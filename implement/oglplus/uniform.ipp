@@ -36,6 +36,9 @@ OGLPLUS_LIB_FUNC
 GLenum ProgVarTypeOps<tag::Uniform>::
 GetType(ProgramName program, GLint /*location*/, StrCRef identifier)
 {
+#if OGLPLUS_CACHE_PROG_VARS
+	return ProgVarCache::UniformType(program, identifier);
+#else
 
 	GLenum type, result = GL_NONE;
 	GLint size;
@@ -90,6 +93,7 @@ GetType(ProgramName program, GLint /*location*/, StrCRef identifier)
 		}
 	}
 	return result;
+#endif
 }
 
 } // namespace oglplus
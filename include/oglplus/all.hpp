@@ -28,6 +28,7 @@
 #include <oglplus/error/object.hpp>
 #include <oglplus/error/prog_var.hpp>
 #include <oglplus/error/program.hpp>
+#include <oglplus/error/deferred.hpp>
 
 #include <oglplus/context.hpp>
 
@@ -0,0 +1,155 @@
+/**
+ *  @file oglplus/async_builder.hpp
+ *  @brief Asynchronous compilation of shaders and linking of programs
+ *
+ *  @author Matus Chochlik
+ *
+ *  Copyright 2010-2015 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#pragma once
+#ifndef OGLPLUS_ASYNC_BUILDER_1509261200_HPP
+#define OGLPLUS_ASYNC_BUILDER_1509261200_HPP
+
+#include <oglplus/config/compiler.hpp>
+#include <oglplus/shader.hpp>
+#include <oglplus/program.hpp>
+
+#include <functional>
+#include <vector>
+#include <cstddef>
+
+namespace oglplus {
+
+/// Compiles shaders and links programs without waiting for each of them
+/** The AsyncBuilder starts the compilation of the submitted shaders
+ *  and linking of the submitted programs immediately, but postpones
+ *  querying of their status until the application polls for the results.
+ *  This allows the GL implementation to compile and link many programs
+ *  concurrently, for example in several driver threads.
+ *
+ *  If the @c KHR_parallel_shader_compile or @c ARB_parallel_shader_compile
+ *  extension is available, then Poll does not block and reports only
+ *  the shaders and programs that have finished. Otherwise Poll waits
+ *  for all pending builds.
+ *
+ *  For the finished shaders and programs with a callback, the callback
+ *  is called with a value indicating if the compilation or linking
+ *  succeeded. For those without a callback, Poll throws CompileError
+ *  or LinkError if the build failed, as Shader::Compile
+ *  and Program::Link do.
+ *
+ *  @note The submitted shader and program objects must not be destroyed
+ *  while their builds are pending.
+ *
+ *  @code
+ *  AsyncBuilder builder;
+ *  for(auto& shader: shaders)
+ *  {
+ *    builder.Compile(shader);
+ *  }
+ *  for(auto& program: programs)
+ *  {
+ *    builder.Link(program, [](bool linked) { ... });
+ *  }
+ *  while(builder.Pending())
+ *  {
+ *    builder.Poll();
+ *    // do something else
+ *  }
+ *  @endcode
+ *
+ *  @see Shader::CompileAsync
+ *  @see Program::LinkAsync
+ */
+class AsyncBuilder
+{
+public:
+	/// The callback called when a build finishes
+	typedef std::function<void (bool)> Callback;
+private:
+	struct _entry
+	{
+		GLuint name;
+		bool is_program;
+		Callback callback;
+	};
+	std::vector<_entry> _pending;
+
+	bool _has_khr;
+	bool _has_arb;
+
+	bool _is_complete(const _entry& entry) const;
+	static void _finish(const _entry& entry);
+public:
+	/// Checks the availability of the parallel shader compile extensions
+	/**
+	 *  @glsymbols
+	 *  @glfunref{GetStringi}
+	 */
+	AsyncBuilder(void);
+
+	/// Returns true if the builds can be polled without blocking
+	bool CanPoll(void) const
+	{
+		return _has_khr || _has_arb;
+	}
+
+	/// Sets the number of threads that the GL uses for compilation
+	/** Does nothing if the parallel shader compile extensions
+	 *  are not available.
+	 *
+	 *  @glsymbols
+	 *  @glfunref{MaxShaderCompilerThreadsKHR}
+	 *  @glfunref{MaxShaderCompilerThreadsARB}
+	 */
+	void MaxCompilerThreads(GLuint count);
+
+	/// Starts the compilation of the @p shader
+	/**
+	 *  @see Shader::CompileAsync
+	 */
+	AsyncBuilder& Compile(ShaderName shader, Callback callback = Callback());
+
+	/// Starts the linking of the @p program
+	/** The shaders attached to the program can be still compiling.
+	 *
+	 *  @see Program::LinkAsync
+	 */
+	AsyncBuilder& Link(ProgramName program, Callback callback = Callback());
+
+	/// Returns the number of pending shader and program builds
+	std::size_t Pending(void) const
+	{
+		return _pending.size();
+	}
+
+	/// Handles the finished builds and returns their count
+	/**
+	 *  @throws Error CompileError
+	 *  @throws Error LinkError
+	 *
+	 *  @glsymbols
+	 *  @glfunref{GetShader}
+	 *  @glfunref{GetProgram}
+	 *  @gldefref{COMPLETION_STATUS_KHR}
+	 */
+	std::size_t Poll(void);
+
+	/// Waits for and handles all pending builds
+	/**
+	 *  @throws Error CompileError
+	 *  @throws Error LinkError
+	 */
+	void Finish(void);
+};
+
+} // namespace oglplus
+
+#if !OGLPLUS_LINK_LIBRARY || defined(OGLPLUS_IMPLEMENTING_LIBRARY)
+#include <oglplus/async_builder.ipp>
+#endif // OGLPLUS_LINK_LIBRARY
+
+#endif // include guard
@@ -152,6 +152,7 @@ public:
 #endif // GL_VERSION_3_2
 
 
+#if OGLPLUS_DOCUMENTATION_ONLY || GL_VERSION_3_2
 	/** Wrapper for Framebuffer::AttachColorTexture()
 	 *  @see Framebuffer::AttachColorTexture()
 	 */
@@ -169,6 +170,7 @@ public:
 		);
 		return *this;
 	}
+#endif // GL_VERSION_3_2
 
 
 	/** Wrapper for Framebuffer::AttachTexture1D()
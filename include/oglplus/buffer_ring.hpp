@@ -0,0 +1,244 @@
+/**
+ *  @file oglplus/buffer_ring.hpp
+ *  @brief Persistently mapped ring buffer for per-frame dynamic data
+ *
+ *  @author Matus Chochlik
+ *
+ *  Copyright 2010-2015 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#pragma once
+#ifndef OGLPLUS_BUFFER_RING_1510051000_HPP
+#define OGLPLUS_BUFFER_RING_1510051000_HPP
+
+#include <oglplus/config/compiler.hpp>
+#include <oglplus/buffer.hpp>
+#include <oglplus/detail/fence_ring.hpp>
+
+#include <cstddef>
+
+namespace oglplus {
+
+#if OGLPLUS_DOCUMENTATION_ONLY || GL_VERSION_4_4 || GL_ARB_buffer_storage
+
+/// Statistics of a BufferRing
+struct BufferRingStats
+{
+	/// The number of sub-allocations
+	unsigned long allocations;
+
+	/// The number of requested bytes (without the alignment padding)
+	unsigned long long bytes;
+
+	/// The number of fenced frames
+	unsigned long frames;
+
+	/// The number of times that Allocate waited for an in-flight frame
+	unsigned long waits;
+
+	/// The time (in seconds) spent waiting for in-flight frames
+	double wait_time;
+
+	/// The highest number of bytes of the ring in use
+	std::size_t peak_used;
+};
+
+/// A sub-allocated range of a BufferRing
+/** The range is valid until the frame in which it was allocated
+ *  is ended by BufferRing::EndFrame and the GL finishes using it.
+ */
+class BufferRingRange
+{
+private:
+	GLubyte* _data;
+	std::size_t _offset;
+	std::size_t _size;
+public:
+	BufferRingRange(GLubyte* data, std::size_t offset, std::size_t size)
+	 : _data(data)
+	 , _offset(offset)
+	 , _size(size)
+	{ }
+
+	/// Returns a pointer to the mapped memory of the range
+	void* Data(void) const
+	{
+		return _data;
+	}
+
+	/// Returns a typed pointer to the mapped memory of the range
+	template <typename T>
+	T* As(void) const
+	{
+		return reinterpret_cast<T*>(_data);
+	}
+
+	/// Returns the offset of the range in the buffer
+	BufferSize Offset(void) const
+	{
+		return BufferSize(_offset);
+	}
+
+	/// Returns the size of the range in bytes
+	BufferSize Size(void) const
+	{
+		return BufferSize(_size);
+	}
+};
+
+/// Ring allocator of per-frame vertex, index and uniform data
+/** The BufferRing owns a buffer with immutable storage which stays
+ *  persistently and coherently mapped. Allocate hands out aligned
+ *  sub-ranges of the mapped memory which can be written directly and
+ *  then sourced by the GL at the range offsets (as vertex attributes,
+ *  indices or uniform blocks) without implicit synchronization or
+ *  additional driver copies. EndFrame places a Sync fence after the
+ *  commands using the ranges of the current frame. The ranges of
+ *  a frame are recycled once its fence signals and Allocate blocks
+ *  only if the ring wraps onto a frame which is still in-flight.
+ *
+ *  @code
+ *  BufferRing ring(BufferTarget::Uniform, 4*1024*1024);
+ *  while(running)
+ *  {
+ *    BufferRingRange range = ring.AllocateUniform(sizeof(FrameData));
+ *    *range.As<FrameData>() = frame_data;
+ *    Buffer::BindRange(
+ *      BufferIndexedTarget::Uniform, 0,
+ *      ring, range.Offset(), range.Size()
+ *    );
+ *    DrawScene();
+ *    ring.EndFrame();
+ *  }
+ *  @endcode
+ *
+ *  @glvoereq{4,4,ARB,buffer_storage}
+ */
+class BufferRing
+{
+private:
+	Buffer _buffer;
+	BufferTarget _target;
+	GLubyte* _mapped;
+	aux::FenceRing _ring;
+	std::size_t _current;
+	std::size_t _uniform_alignment;
+
+	BufferRingStats _stats;
+public:
+	/// Creates a ring of the specified @p size bound to @p target
+	/**
+	 *  @glsymbols
+	 *  @glfunref{BufferStorage}
+	 *  @glfunref{MapBufferRange}
+	 */
+	BufferRing(BufferTarget target, std::size_t size);
+
+#if !OGLPLUS_NO_DELETED_FUNCTIONS
+	BufferRing(const BufferRing&) = delete;
+#else
+private:
+	BufferRing(const BufferRing&);
+public:
+#endif
+
+	/// Returns the name of the ring buffer
+	operator BufferName(void) const
+	{
+		return _buffer;
+	}
+
+	/// Binds the ring buffer to its target
+	void Bind(void) const
+	{
+		Buffer::Bind(_target, _buffer);
+	}
+
+	/// Returns the size of the ring in bytes
+	std::size_t Size(void) const
+	{
+		return _ring.Size();
+	}
+
+	/// Returns the number of bytes of the ring in use
+	/** This includes the ranges of the current frame and of the
+	 *  in-flight frames and the alignment and wrap-around padding.
+	 */
+	std::size_t Used(void) const
+	{
+		return _ring.Used();
+	}
+
+	/// Returns the fraction of the ring that is in use
+	double Utilization(void) const
+	{
+		return double(_ring.Used())/double(_ring.Size());
+	}
+
+	/// Returns the number of ended frames which were not recycled yet
+	std::size_t InFlightFrames(void) const
+	{
+		return _ring.Pending();
+	}
+
+	/// The alignment of uniform buffer ranges required by the GL
+	std::size_t UniformAlignment(void) const
+	{
+		return _uniform_alignment;
+	}
+
+	/// Allocates @p size bytes aligned to @p alignment in the current frame
+	/** If there is not enough free space then the oldest in-flight
+	 *  frames are waited for.
+	 *
+	 *  @throws std::runtime_error if the range does not fit into the ring
+	 *  together with the other ranges of the current frame.
+	 *
+	 *  @glsymbols
+	 *  @glfunref{GetSync}
+	 *  @glfunref{ClientWaitSync}
+	 */
+	BufferRingRange Allocate(std::size_t size, std::size_t alignment = 16);
+
+	/// Allocates a range for an uniform block
+	BufferRingRange AllocateUniform(std::size_t size)
+	{
+		return Allocate(size, _uniform_alignment);
+	}
+
+	/// Allocates a range and copies the specified @p data into it
+	BufferRingRange Copy(
+		const void* data,
+		std::size_t size,
+		std::size_t alignment = 16
+	);
+
+	/// Fences the current frame and recycles the signaled frames
+	/**
+	 *  @glsymbols
+	 *  @glfunref{FenceSync}
+	 *  @glfunref{Flush}
+	 */
+	void EndFrame(void);
+
+	/// Returns the allocation statistics
+	const BufferRingStats& Stats(void) const
+	{
+		return _stats;
+	}
+
+	/// Resets the statistics
+	void ResetStats(void);
+};
+
+#endif // buffer storage
+
+} // namespace oglplus
+
+#if !OGLPLUS_LINK_LIBRARY || defined(OGLPLUS_IMPLEMENTING_LIBRARY)
+#include <oglplus/buffer_ring.ipp>
+#endif // OGLPLUS_LINK_LIBRARY
+
+#endif // include guard
@@ -14,7 +14,7 @@
 #define OGLPLUS_CLIENT_COMPUTING_1412071213_HPP
 
 #include <oglplus/client/setting.hpp>
-#include <oglplus/context/drawing.hpp>
+#include <oglplus/context/computing.hpp>
 
 namespace oglplus {
 namespace client {
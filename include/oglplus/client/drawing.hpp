@@ -48,7 +48,9 @@ public:
 class DrawingState
 {
 public:
+#if GL_VERSION_3_1
 	aux::PrimitiveRestartIndex PrimitiveRestartIndex;
+#endif
 };
 
 using oglplus::context::DrawingOps;
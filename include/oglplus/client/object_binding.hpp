@@ -16,6 +16,12 @@
 #include <oglplus/glfunc.hpp>
 #include <oglplus/client/setting.hpp>
 #include <oglplus/utils/nothing.hpp>
+#include <oglplus/buffer.hpp>
+#include <oglplus/sampler.hpp>
+#include <oglplus/transform_feedback.hpp>
+#include <oglplus/program.hpp>
+#include <oglplus/program_pipeline.hpp>
+#include <oglplus/vertex_array.hpp>
 #include <oglplus/bound/buffer.hpp>
 #include <oglplus/bound/framebuffer.hpp>
 #include <oglplus/bound/renderbuffer.hpp>
@@ -59,7 +65,7 @@ struct CurrentObject
 		ObjectName<ObjTag> Get(void) const
 		OGLPLUS_NOEXCEPT(true)
 		{
-			return ObjectName<ObjTag>(this->_top());
+			return ObjectName<ObjTag>(this->_get());
 		}
 
 		operator ObjectName<ObjTag> (void) const
@@ -77,7 +83,7 @@ struct CurrentObject
 
 		void Bind(ObjectName<ObjTag> obj)
 		{
-			return this->_set(GetName(obj));
+			this->_set(GetName(obj));
 		}
 	};
 };
@@ -122,7 +128,7 @@ public:
 	ObjectName<ObjTag> Get(void) const
 	OGLPLUS_NOEXCEPT(true)
 	{
-		return ObjectName<ObjTag>(this->_top());
+		return ObjectName<ObjTag>(this->_get());
 	}
 
 	operator ObjectName<ObjTag> (void) const
@@ -190,7 +196,7 @@ public:
 	ObjectName<ObjTag> Get(void) const
 	OGLPLUS_NOEXCEPT(true)
 	{
-		return ObjectName<ObjTag>(this->_top());
+		return ObjectName<ObjTag>(this->_get());
 	}
 
 	operator ObjectName<ObjTag> (void) const
@@ -208,7 +214,7 @@ public:
 
 	void Bind(ObjectName<ObjTag> obj)
 	{
-		return this->_set(GetName(obj));
+		this->_set(GetName(obj));
 	}
 };
 
@@ -4,7 +4,7 @@
  *
  *  @author Matus Chochlik
  *
- *  Copyright 2010-2014 Matus Chochlik. Distributed under the Boost
+ *  Copyright 2010-2015 Matus Chochlik. Distributed under the Boost
  *  Software License, Version 1.0. (See accompanying file
  *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
  */
@@ -16,6 +16,7 @@
 #include <oglplus/config/compiler.hpp>
 #include <oglplus/fwd.hpp>
 #include <vector>
+#include <atomic>
 #include <cassert>
 
 namespace oglplus {
@@ -79,20 +80,67 @@ public:
 	}
 };
 
+namespace aux {
+
+inline
+std::atomic<std::size_t>& SettingQueryCounter(void)
+{
+	static std::atomic<std::size_t> counter(0);
+	return counter;
+}
+
+} // namespace aux
+
+/// Returns the number of GL state queries done by the setting stacks
+/** The setting stacks query the current value of their setting lazily,
+ *  when it is needed for the first time, so for example constructing
+ *  a ClientContext does not query any GL state.
+ */
+inline
+std::size_t SettingQueryCount(void)
+OGLPLUS_NOEXCEPT(true)
+{
+	return aux::SettingQueryCounter().load();
+}
+
 template <typename T, typename P>
 class SettingStack
 {
 private:
+	T (*_query)(P);
 	void (*_apply)(T, P);
 	P _param;
-	T _curr;
+	mutable T _curr;
+	mutable bool _known;
 
 	friend class SettingHolder<T, P>;
+
+	void _do_query(void) const
+	OGLPLUS_NOEXCEPT(true)
+	{
+		assert(_query);
+		++aux::SettingQueryCounter();
+		// if the query fails the value stays unknown and
+		// it is queried again the next time it is needed
+		try
+		{
+			_curr = _query(_param);
+			_known = true;
+		}
+		catch(...)
+		{
+			_curr = T();
+		}
+	}
 protected:
 	inline
-	T _get(void) const
+	const T& _get(void) const
 	OGLPLUS_NOEXCEPT(true)
 	{
+		if(!_known)
+		{
+			_do_query();
+		}
 		return _curr;
 	}
 
@@ -100,15 +148,20 @@ protected:
 	{
 		assert(_apply);
 
-		if(_curr != value)
+		// if the current value is not known yet then it is not
+		// queried just to be compared, the value is applied
+		if(!_known || _curr != value)
 		{
 			T prev = _curr;
+			bool was_known = _known;
 			_curr = value;
+			_known = true;
 
 			try { _apply(_curr, _param); }
 			catch(...)
 			{
 				_curr = prev;
+				_known = was_known;
 				throw;
 			}
 			return true;
@@ -118,7 +171,7 @@ protected:
 
 	SettingHolder<T, P> _push(T value)
 	{
-		T prev = _curr;
+		T prev = _get();
 		if(_set(value))
 		{
 			return SettingHolder<T, P>(*this, prev);
@@ -127,12 +180,12 @@ protected:
 	}
 protected:
 	SettingStack(T (*query)(P), void(*apply)(T, P), P param = P())
-	 : _apply(apply)
+	 : _query(query)
+	 , _apply(apply)
 	 , _param(param)
-	{
-		try { _curr = query(_param); }
-		catch(Error&){ }
-	}
+	 , _curr()
+	 , _known(false)
+	{ }
 public:
 	typedef SettingHolder<T, P> Holder;
 
@@ -154,7 +207,7 @@ public:
 	Get(void) const
 	OGLPLUS_NOEXCEPT(true)
 	{
-		return _curr;
+		return _get();
 	}
 
 	inline
@@ -169,6 +222,37 @@ public:
 	{
 		_set(T(std::forward<A>(a)...));
 	}
+
+	/// Sets the known current @p value without querying or applying it
+	/** This can be used to seed the stack from a known state, for example
+	 *  from the initial state of a newly created GL context, instead
+	 *  of querying the value from GL.
+	 */
+	inline
+	void Seed(T value)
+	{
+		_curr = value;
+		_known = true;
+	}
+
+	/// Forgets the current value, it is queried again when needed
+	/** This should be used when the setting was changed by code
+	 *  not using this stack.
+	 */
+	inline
+	void Invalidate(void)
+	OGLPLUS_NOEXCEPT(true)
+	{
+		_known = false;
+	}
+
+	/// Returns true if the current value is known without a query
+	inline
+	bool Known(void) const
+	OGLPLUS_NOEXCEPT(true)
+	{
+		return _known;
+	}
 };
 
 
@@ -223,7 +307,7 @@ public:
 	inline
 	Holder Push(A&& ... a)
 	{
-		_zero().Push(std::forward<A>(a)...);
+		return _zero().Push(std::forward<A>(a)...);
 	}
 
 	inline
@@ -246,6 +330,23 @@ public:
 	{
 		_zero().Set(std::forward<A>(a)...);
 	}
+
+	inline
+	void Seed(T value)
+	{
+		_zero().Seed(value);
+	}
+
+	/// Forgets the current values of all indices
+	inline
+	void Invalidate(void)
+	OGLPLUS_NOEXCEPT(true)
+	{
+		for(auto i=_indexed.begin(), e=_indexed.end(); i!=e; ++i)
+		{
+			i->Invalidate();
+		}
+	}
 };
 
 } // namespace client
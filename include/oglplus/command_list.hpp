@@ -0,0 +1,345 @@
+/**
+ *  @file oglplus/command_list.hpp
+ *  @brief Deferred lists of GL commands recorded without a GL context
+ *
+ *  @author Matus Chochlik
+ *
+ *  Copyright 2010-2015 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#pragma once
+#ifndef OGLPLUS_COMMAND_LIST_1510151000_HPP
+#define OGLPLUS_COMMAND_LIST_1510151000_HPP
+
+#include <oglplus/config/compiler.hpp>
+#include <oglplus/glfunc.hpp>
+#include <oglplus/object/name.hpp>
+#include <oglplus/buffer_target.hpp>
+#include <oglplus/texture_target.hpp>
+#include <oglplus/capability.hpp>
+#include <oglplus/primitive_type.hpp>
+#include <oglplus/data_type.hpp>
+#include <oglplus/math/vector.hpp>
+#include <oglplus/math/matrix.hpp>
+
+#include <memory>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace oglplus {
+namespace aux {
+
+struct CommandListUniformCmd;
+struct CommandListDrawCmd;
+
+} // namespace aux
+
+class CommandExecutor;
+
+/// A list of GL commands recorded for later execution
+/** The commands are encoded into linearly allocated memory blocks owned
+ *  by the list, data passed by pointer (uniform values, buffer data)
+ *  is copied. Recording does not call any GL functions, so lists can be
+ *  built concurrently by worker threads (each using its own list)
+ *  and executed later, in the intended order, by a CommandExecutor
+ *  on the thread owning the GL context.
+ *
+ *  Clear rewinds the list without releasing its memory, so a list
+ *  re-recorded every frame does not allocate after the first frames.
+ *
+ *  @ingroup utility_classes
+ */
+class CommandList
+{
+public:
+	/// The default size (in bytes) of the memory blocks
+	static const std::size_t DefaultBlockSize = 64*1024;
+private:
+	friend class CommandExecutor;
+
+	struct _Block
+	{
+		std::unique_ptr<unsigned char[]> data;
+		std::size_t size;
+		std::size_t used;
+	};
+
+	std::vector<_Block> _blocks;
+	std::size_t _current;
+	std::size_t _block_size;
+	std::size_t _command_count;
+
+	// the kinds of the values of uniforms
+	enum _UniformKind
+	{
+		_uniform_float,
+		_uniform_int,
+		_uniform_uint,
+		_uniform_matrix
+	};
+
+	unsigned char* _alloc(std::size_t size);
+	void* _record(unsigned opcode, std::size_t size);
+
+	void _uniform(
+		GLint location,
+		_UniformKind kind,
+		GLuint components,
+		GLsizei count,
+		const void* values,
+		std::size_t value_size
+	);
+public:
+	/// Creates an empty list using blocks of the specified size
+	CommandList(std::size_t block_size = DefaultBlockSize);
+
+	CommandList(CommandList&& temp);
+
+#if !OGLPLUS_NO_DELETED_FUNCTIONS
+	CommandList(const CommandList&) = delete;
+#else
+private:
+	CommandList(const CommandList&);
+public:
+#endif
+
+	/// Removes all recorded commands, keeping the allocated memory
+	void Clear(void);
+
+	/// Returns true if there are no recorded commands
+	bool Empty(void) const
+	{
+		return _command_count == 0;
+	}
+
+	/// Returns the number of recorded commands
+	std::size_t CommandCount(void) const
+	{
+		return _command_count;
+	}
+
+	/// Returns the number of bytes used by the recorded commands
+	std::size_t UsedBytes(void) const;
+
+	/// Returns the number of bytes allocated by the list
+	std::size_t AllocatedBytes(void) const;
+
+	/// Records a glUseProgram command
+	CommandList& UseProgram(ProgramName program);
+
+	/// Records a glBindVertexArray command
+	CommandList& BindVertexArray(VertexArrayName vao);
+
+	/// Records a glBindBuffer command
+	CommandList& BindBuffer(BufferTarget target, BufferName buffer);
+
+#if OGLPLUS_DOCUMENTATION_ONLY || GL_VERSION_3_0
+	/// Records a glBindBufferBase command
+	CommandList& BindBufferBase(
+		BufferIndexedTarget target,
+		GLuint index,
+		BufferName buffer
+	);
+#endif
+
+	/// Records the activation of a texture unit and a glBindTexture
+	CommandList& BindTexture(
+		GLuint unit,
+		TextureTarget target,
+		TextureName texture
+	);
+
+	/// Records a glEnable command
+	CommandList& Enable(Capability capability);
+
+	/// Records a glDisable command
+	CommandList& Disable(Capability capability);
+
+	/// Records the setting of @p count uniform floats of the current program
+	CommandList& Uniform(GLint location, GLsizei count, const GLfloat* v)
+	{
+		_uniform(location, _uniform_float, 1, count, v, sizeof(*v));
+		return *this;
+	}
+
+	/// Records the setting of @p count uniform ints of the current program
+	CommandList& Uniform(GLint location, GLsizei count, const GLint* v)
+	{
+		_uniform(location, _uniform_int, 1, count, v, sizeof(*v));
+		return *this;
+	}
+
+#if OGLPLUS_DOCUMENTATION_ONLY || GL_VERSION_3_0
+	/// Records the setting of @p count uniform uints of the current program
+	CommandList& Uniform(GLint location, GLsizei count, const GLuint* v)
+	{
+		_uniform(location, _uniform_uint, 1, count, v, sizeof(*v));
+		return *this;
+	}
+#endif
+
+	/// Records the setting of a scalar uniform of the current program
+	template <typename T>
+	CommandList& Uniform(GLint location, T value)
+	{
+		return Uniform(location, 1, &value);
+	}
+
+	/// Records the setting of a vector uniform of the current program
+	template <typename T, std::size_t N>
+	CommandList& Uniform(GLint location, const Vector<T, N>& value)
+	{
+		static_assert(N >= 1 && N <= 4, "Invalid vector size");
+		_uniform(
+			location,
+			_kind(TypeTag<T>()),
+			GLuint(N),
+			1,
+			value.Data(),
+			sizeof(T)
+		);
+		return *this;
+	}
+
+	/// Records the setting of a square matrix uniform of the current program
+	template <std::size_t N>
+	CommandList& Uniform(GLint location, const Matrix<GLfloat, N, N>& value)
+	{
+		static_assert(N >= 2 && N <= 4, "Invalid matrix size");
+		_uniform(
+			location,
+			_uniform_matrix,
+			GLuint(N),
+			1,
+			Data(value),
+			sizeof(GLfloat)
+		);
+		return *this;
+	}
+
+	/// Records a glBufferSubData command, the @p data is copied
+	CommandList& BufferSubData(
+		BufferTarget target,
+		GLintptr offset,
+		GLsizeiptr size,
+		const GLvoid* data
+	);
+
+	/// Records a glBufferSubData command, the @p data is copied
+	template <typename T>
+	CommandList& BufferSubData(
+		BufferTarget target,
+		GLintptr offset,
+		const std::vector<T>& data
+	)
+	{
+		return BufferSubData(
+			target,
+			offset,
+			GLsizeiptr(data.size()*sizeof(T)),
+			data.data()
+		);
+	}
+
+	/// Records a glDrawArrays(Instanced) command
+	CommandList& DrawArrays(
+		PrimitiveType primitive,
+		GLint first,
+		GLsizei count,
+		GLsizei instances = 1
+	);
+
+	/// Records a glDrawElements(Instanced) command
+	CommandList& DrawElements(
+		PrimitiveType primitive,
+		GLsizei count,
+		DataType data_type,
+		const GLvoid* offset = nullptr,
+		GLsizei instances = 1
+	);
+private:
+	static _UniformKind _kind(TypeTag<GLfloat>)
+	{
+		return _uniform_float;
+	}
+
+	static _UniformKind _kind(TypeTag<GLint>)
+	{
+		return _uniform_int;
+	}
+
+	static _UniformKind _kind(TypeTag<GLuint>)
+	{
+		return _uniform_uint;
+	}
+};
+
+/// Statistics of a CommandExecutor
+struct CommandExecutorStats
+{
+	/// The number of executed lists
+	std::size_t lists;
+
+	/// The number of executed commands
+	std::size_t commands;
+
+	/// The number of binds skipped because the object was already bound
+	std::size_t skipped_binds;
+};
+
+/// Executes CommandLists on the thread owning the GL context
+/** Within a single call to Execute the executor tracks the bound
+ *  program, vertex array and textures and skips redundant binds,
+ *  also across the boundaries of the executed lists.
+ *
+ *  @ingroup utility_classes
+ */
+class CommandExecutor
+{
+private:
+	CommandExecutorStats _stats;
+
+	GLuint _program, _vao;
+	GLint _active_unit;
+	std::vector<std::pair<GLenum, GLuint>> _textures;
+
+	void _reset(void);
+	void _execute(const CommandList& list);
+
+	static void _uniform(
+		const aux::CommandListUniformCmd& cmd,
+		const void* values
+	);
+	static void _draw(unsigned opcode, const aux::CommandListDrawCmd& cmd);
+public:
+	CommandExecutor(void);
+
+	/// Executes the commands of the specified @p list
+	void Execute(const CommandList& list);
+
+	/// Executes the lists in the order in which they are specified
+	void Execute(const std::vector<const CommandList*>& lists);
+
+	/// Executes the lists in the order in which they are specified
+	void Execute(const std::vector<CommandList>& lists);
+
+	/// Returns the execution statistics
+	const CommandExecutorStats& Stats(void) const
+	{
+		return _stats;
+	}
+
+	/// Resets the execution statistics
+	void ResetStats(void);
+};
+
+} // namespace oglplus
+
+#if !OGLPLUS_LINK_LIBRARY || defined(OGLPLUS_IMPLEMENTING_LIBRARY)
+#include <oglplus/command_list.ipp>
+#endif // OGLPLUS_LINK_LIBRARY
+
+#endif // include guard
@@ -186,6 +186,23 @@
 #endif
 #endif
 
+#ifndef OGLPLUS_NO_THREAD_LOCAL
+#if	defined(BOOST_NO_CXX11_THREAD_LOCAL) ||\
+	defined(BOOST_NO_THREAD_LOCAL)
+#define OGLPLUS_NO_THREAD_LOCAL 1
+#else
+#define OGLPLUS_NO_THREAD_LOCAL 0
+#endif
+#endif
+
+#ifndef OGLPLUS_NO_THREADS
+#if	defined(BOOST_NO_CXX11_HDR_THREAD)
+#define OGLPLUS_NO_THREADS 1
+#else
+#define OGLPLUS_NO_THREADS 0
+#endif
+#endif
+
 #ifndef OGLPLUS_NO_SCOPED_ENUM_TEMPLATE_PARAMS
 #ifdef _MSC_VER // TODO < specific version
 #define OGLPLUS_NO_SCOPED_ENUM_TEMPLATE_PARAMS 1
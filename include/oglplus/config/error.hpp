@@ -155,4 +155,41 @@
 # endif
 #endif
 
+#if OGLPLUS_DOCUMENTATION_ONLY
+/// Compile-time switch disabling the run-time selectable error check policies
+/** If set to a nonzero value, then the errors are always checked
+ *  immediately after every GL function call and ErrorCheckScope
+ *  has no effect.
+ *
+ *  @see ErrorCheckPolicy
+ *
+ *  By default this option is set to 0, i.e. the error check policy
+ *  can be selected at run-time.
+ *
+ *  @ingroup compile_time_config
+ */
+#define OGLPLUS_NO_ERROR_CHECK_POLICY
+#else
+# ifndef OGLPLUS_NO_ERROR_CHECK_POLICY
+#  define OGLPLUS_NO_ERROR_CHECK_POLICY 0
+# endif
+#endif
+
+#if OGLPLUS_DOCUMENTATION_ONLY
+/// The number of call sites remembered by the deferred error checks
+/**
+ *  @see ErrorCheckPolicy
+ *  @see DeferredError
+ *
+ *  By default this option is set to 16.
+ *
+ *  @ingroup compile_time_config
+ */
+#define OGLPLUS_ERROR_CALL_SITE_COUNT
+#else
+# ifndef OGLPLUS_ERROR_CALL_SITE_COUNT
+#  define OGLPLUS_ERROR_CALL_SITE_COUNT 16
+# endif
+#endif
+
 #endif // include guard
@@ -62,6 +62,52 @@
 # endif
 #endif
 
+#if OGLPLUS_DOCUMENTATION_ONLY
+/// Compile-time switch enabling the pluggable GL function dispatch layer
+/** Setting this preprocessor symbol to a nonzero value causes that
+ *  all GL functions called through the @c OGLPLUS_GLFUNC macro are routed
+ *  through the currently installed GLDispatchBackend (if any). Backends
+ *  can record, time, mock or forward the calls. If no backend is installed
+ *  the calls go directly to the GL.
+ *
+ *  The dispatch layer requires variadic templates.
+ *
+ *  By default this option is set to 0, i.e. GL functions are called directly.
+ *
+ *  @see GLDispatchBackend
+ *
+ *  @ingroup compile_time_config
+ */
+#define OGLPLUS_USE_GL_DISPATCH
+#else
+# ifndef OGLPLUS_USE_GL_DISPATCH
+#  define OGLPLUS_USE_GL_DISPATCH 0
+# endif
+#endif
+
+#if OGLPLUS_DOCUMENTATION_ONLY
+/// Compile-time switch enabling the GL call profiling instrumentation
+/** Setting this preprocessor symbol to a nonzero value causes that
+ *  the calls of GL functions made through the @c OGLPLUS_GLFUNC macro
+ *  are counted and timed, per GL function and per @OGLplus class.
+ *  The collected data can be obtained with GLCallProfile::Snapshot.
+ *
+ *  The instrumentation requires variadic templates.
+ *
+ *  By default this option is set to 0, i.e. the GL calls are not
+ *  instrumented and there is no run-time overhead.
+ *
+ *  @see GLCallProfile
+ *
+ *  @ingroup compile_time_config
+ */
+#define OGLPLUS_PROFILE_GL_CALLS
+#else
+# ifndef OGLPLUS_PROFILE_GL_CALLS
+#  define OGLPLUS_PROFILE_GL_CALLS 0
+# endif
+#endif
+
 #if OGLPLUS_DOCUMENTATION_ONLY
 /// Compile-time switch entirely disabling typechecking of uniforms.
 /** Setting this preprocessor symbol to a nonzero value causes that
@@ -81,4 +127,49 @@
 # endif
 #endif
 
+#if OGLPLUS_DOCUMENTATION_ONLY
+/// Compile-time switch enabling the per-program variable cache
+/** Setting this preprocessor symbol to a nonzero value causes that
+ *  the locations and types of uniforms are looked up in the ProgVarCache
+ *  when a Uniform is constructed, instead of being queried from the GL.
+ *
+ *  The cache is keyed by the program names, so it should be enabled only
+ *  if the application does not use several non-shared GL contexts
+ *  in the same thread and does not re-link or re-create programs
+ *  by direct GL calls (or invalidates them explicitly).
+ *
+ *  By default this option is set to 0, i.e. the GL is always queried.
+ *
+ *  @see ProgVarCache
+ *
+ *  @ingroup compile_time_config
+ */
+#define OGLPLUS_CACHE_PROG_VARS
+#else
+# ifndef OGLPLUS_CACHE_PROG_VARS
+#  define OGLPLUS_CACHE_PROG_VARS 0
+# endif
+#endif
+
+#if OGLPLUS_DOCUMENTATION_ONLY
+/// Compile-time switch enabling the shadowing of uniform values
+/** Setting this preprocessor symbol to a nonzero value causes that
+ *  the values written through the Uniform wrappers are remembered
+ *  and that writes of the values which the uniforms already have
+ *  are skipped.
+ *
+ *  By default this option is set to 0, i.e. all writes are passed
+ *  to the GL.
+ *
+ *  @see UniformShadow
+ *
+ *  @ingroup compile_time_config
+ */
+#define OGLPLUS_SHADOW_UNIFORM_VALUES
+#else
+# ifndef OGLPLUS_SHADOW_UNIFORM_VALUES
+#  define OGLPLUS_SHADOW_UNIFORM_VALUES 0
+# endif
+#endif
+
 #endif // include guard
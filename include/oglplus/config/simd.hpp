@@ -0,0 +1,56 @@
+/**
+ *  @file oglplus/config/simd.hpp
+ *  @brief SIMD-related compile-time configuration options
+ *
+ *  @author Matus Chochlik
+ *
+ *  Copyright 2010-2015 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#pragma once
+#ifndef OGLPLUS_CONFIG_SIMD_1510061000_HPP
+#define OGLPLUS_CONFIG_SIMD_1510061000_HPP
+
+#include <oglplus/config/basic.hpp>
+
+#if OGLPLUS_DOCUMENTATION_ONLY
+/// Compile-time switch disabling the use of SIMD instructions
+/** Setting this preprocessor symbol to a nonzero value causes that
+ *  the portable scalar implementations are used in the functions having
+ *  a SIMD-optimized variant (for example the UTF-8 conversions).
+ *
+ *  By default this option is set to 0, i.e. the SIMD instructions
+ *  are used if the target architecture supports them.
+ *
+ *  @ingroup compile_time_config
+ */
+#define OGLPLUS_NO_SIMD
+#else
+# ifndef OGLPLUS_NO_SIMD
+#  define OGLPLUS_NO_SIMD 0
+# endif
+#endif
+
+#ifndef OGLPLUS_USE_SSE2
+# if !OGLPLUS_NO_SIMD && ( \
+	defined(__SSE2__) || \
+	defined(_M_X64) || \
+	(defined(_M_IX86_FP) && (_M_IX86_FP >= 2)) \
+)
+#  define OGLPLUS_USE_SSE2 1
+# else
+#  define OGLPLUS_USE_SSE2 0
+# endif
+#endif
+
+#ifndef OGLPLUS_USE_AVX
+# if !OGLPLUS_NO_SIMD && defined(__AVX__)
+#  define OGLPLUS_USE_AVX 1
+# else
+#  define OGLPLUS_USE_AVX 0
+# endif
+#endif
+
+#endif // include guard
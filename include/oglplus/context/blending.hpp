@@ -125,7 +125,7 @@ struct BlendFunctionSeparate
 	bool Separate(void) const
 	OGLPLUS_NOEXCEPT(true)
 	{
-		return (_v[0] != _v[1]) || (_v[2] == _v[3]);
+		return (_v[0] != _v[1]) || (_v[2] != _v[3]);
 	}
 
 	friend
@@ -0,0 +1,131 @@
+/**
+ *  @file oglplus/detail/fence_ring.hpp
+ *  @brief Bookkeeping of a ring buffer whose space is released by fences
+ *
+ *  @author Matus Chochlik
+ *
+ *  Copyright 2010-2015 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#pragma once
+#ifndef OGLPLUS_DETAIL_FENCE_RING_1510191000_HPP
+#define OGLPLUS_DETAIL_FENCE_RING_1510191000_HPP
+
+#include <oglplus/config/compiler.hpp>
+#include <oglplus/sync.hpp>
+
+#include <deque>
+#include <cstddef>
+#include <cassert>
+
+namespace oglplus {
+namespace aux {
+
+#if GL_VERSION_3_2 || GL_ARB_sync
+
+// Tracks the head and the used space of a ring buffer, the reserved
+// space is split into segments each guarded by a fence and released
+// in order once the GL has signaled the fence
+class FenceRing
+{
+private:
+	struct _segment
+	{
+		std::size_t reserved;
+		Sync fence;
+
+		_segment(std::size_t size)
+		 : reserved(size)
+		{ }
+
+		_segment(_segment&& tmp)
+		 : reserved(tmp.reserved)
+		 , fence(std::move(tmp.fence))
+		{ }
+	};
+
+	std::size_t _size, _head, _used;
+	std::deque<_segment> _segments;
+public:
+	FenceRing(std::size_t size)
+	 : _size(size)
+	 , _head(0)
+	 , _used(0)
+	{
+		assert(_size > 0);
+	}
+
+	std::size_t Size(void) const
+	{
+		return _size;
+	}
+
+	std::size_t Head(void) const
+	{
+		return _head;
+	}
+
+	std::size_t Used(void) const
+	{
+		return _used;
+	}
+
+	std::size_t Free(void) const
+	{
+		return _size-_used;
+	}
+
+	// the number of fenced segments not released yet
+	std::size_t Pending(void) const
+	{
+		return _segments.size();
+	}
+
+	// moves the head to the specified end of a range
+	// and adds the @p reserved bytes to the used space
+	void Reserve(std::size_t end, std::size_t reserved)
+	{
+		assert(end <= _size);
+		assert(_used+reserved <= _size);
+		_head = (end == _size)?0:end;
+		_used += reserved;
+	}
+
+	// guards the @p reserved bytes by a new fence
+	void Fence(std::size_t reserved)
+	{
+		_segments.emplace_back(reserved);
+		// ClientWait does not flush the fence
+		OGLPLUS_GLFUNC(Flush)();
+	}
+
+	// releases the oldest segment if its fence is signaled,
+	// or waits for it if @p wait is true
+	bool Recycle(bool wait)
+	{
+		if(_segments.empty()) return false;
+
+		const Sync& fence = _segments.front().fence;
+		if(wait)
+		{
+			while(fence.ClientWait(1000000) ==
+				SyncWaitResult::TimeoutExpired
+			);
+		}
+		else if(!fence.Signaled()) return false;
+
+		_used -= _segments.front().reserved;
+		_segments.pop_front();
+		if(_used == 0) _head = 0;
+		return true;
+	}
+};
+
+#endif // sync
+
+} // namespace aux
+} // namespace oglplus
+
+#endif // include guard
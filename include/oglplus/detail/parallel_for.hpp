@@ -0,0 +1,124 @@
+/**
+ *  @file oglplus/detail/parallel_for.hpp
+ *  @brief Helper splitting CPU-side work between several threads
+ *
+ *  @author Matus Chochlik
+ *
+ *  Copyright 2010-2015 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#pragma once
+#ifndef OGLPLUS_DETAIL_PARALLEL_FOR_1510021415_HPP
+#define OGLPLUS_DETAIL_PARALLEL_FOR_1510021415_HPP
+
+#include <oglplus/config/compiler.hpp>
+#include <algorithm>
+#include <vector>
+#include <cstddef>
+#if !OGLPLUS_NO_THREADS
+#include <thread>
+#include <system_error>
+#endif
+
+namespace oglplus {
+namespace aux {
+
+// Returns the number of threads to be used (zero means all hw threads)
+inline unsigned ParallelThreads(unsigned requested)
+{
+	if(requested > 0) return requested;
+#if !OGLPLUS_NO_THREADS
+	unsigned threads = std::thread::hardware_concurrency();
+	return (threads > 0)?threads:1;
+#else
+	return 1;
+#endif
+}
+
+// Calls func(begin, end) for consecutive sub-ranges of [0, count)
+// from up to the specified number of threads
+template <typename Func>
+inline void ParallelFor(
+	std::size_t count,
+	std::size_t cost,
+	unsigned threads,
+	const Func& func
+)
+{
+	// not worth starting threads for small amounts of work
+	if(cost < (std::size_t(1) << 16)) threads = 1;
+	if(threads > count) threads = unsigned(count);
+#if !OGLPLUS_NO_THREADS
+	if(threads > 1)
+	{
+		std::vector<std::thread> workers;
+		workers.reserve(threads-1);
+		const std::size_t chunk = (count+threads-1)/threads;
+		// the ranges for which no thread could be started
+		// are processed by the calling thread
+		std::size_t rest = count;
+		try
+		{
+			for(unsigned t=1; t!=threads; ++t)
+			{
+				const std::size_t begin = std::min(t*chunk, count);
+				const std::size_t end = std::min(begin+chunk, count);
+				try { workers.push_back(std::thread(func, begin, end)); }
+				catch(std::system_error&)
+				{
+					rest = begin;
+					break;
+				}
+			}
+			func(std::size_t(0), std::min(chunk, count));
+			if(rest < count) func(rest, count);
+		}
+		catch(...)
+		{
+			for(auto i=workers.begin(), e=workers.end(); i!=e; ++i)
+			{
+				i->join();
+			}
+			throw;
+		}
+		for(auto i=workers.begin(), e=workers.end(); i!=e; ++i)
+		{
+			i->join();
+		}
+		return;
+	}
+#endif
+	func(std::size_t(0), count);
+}
+
+// Calls first() on a new thread if possible and second() on the calling
+// thread and waits for both
+template <typename First, typename Second>
+inline void ParallelInvoke(const First& first, const Second& second)
+{
+#if !OGLPLUS_NO_THREADS
+	std::thread worker;
+	try { worker = std::thread(first); }
+	catch(std::system_error&)
+	{
+		first();
+	}
+	try { second(); }
+	catch(...)
+	{
+		if(worker.joinable()) worker.join();
+		throw;
+	}
+	if(worker.joinable()) worker.join();
+#else
+	first();
+	second();
+#endif
+}
+
+} // namespace aux
+} // namespace oglplus
+
+#endif // include guard
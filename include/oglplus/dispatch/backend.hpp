@@ -0,0 +1,106 @@
+/**
+ *  @file oglplus/dispatch/backend.hpp
+ *  @brief Interface of the pluggable GL function dispatch backends
+ *
+ *  @author Matus Chochlik
+ *
+ *  Copyright 2010-2015 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#pragma once
+#ifndef OGLPLUS_DISPATCH_BACKEND_1509101200_HPP
+#define OGLPLUS_DISPATCH_BACKEND_1509101200_HPP
+
+#include <oglplus/dispatch/call.hpp>
+
+namespace oglplus {
+
+/** @defgroup gl_dispatch GL function dispatch
+ *
+ *  If the #OGLPLUS_USE_GL_DISPATCH compile-time switch is set to a nonzero
+ *  value, then all GL functions called by @OGLplus through
+ *  the @c OGLPLUS_GLFUNC macro are routed through the currently installed
+ *  dispatch backend. Backends may forward the calls to the GL, record them,
+ *  measure their timing or emulate them without any GL context at all.
+ */
+
+/// Base class for GL function dispatch backends
+/** Each thread has its own installed backend (unless the compiler lacks
+ *  thread-local storage, see #OGLPLUS_NO_THREAD_LOCAL, in which case
+ *  a single backend is shared by all threads and must be installed
+ *  while no other thread calls the GL). If no backend is installed,
+ *  then the GL functions are called directly.
+ *
+ *  @see GLDispatchBackendScope
+ *
+ *  @ingroup gl_dispatch
+ */
+class GLDispatchBackend
+{
+private:
+	static GLDispatchBackend*& _current(void);
+
+	GLDispatchBackend(const GLDispatchBackend&);
+public:
+	GLDispatchBackend(void) { }
+
+	virtual ~GLDispatchBackend(void) { }
+
+	/// Returns the backend installed on the calling thread or nullptr
+	static GLDispatchBackend* Current(void)
+	{
+		return _current();
+	}
+
+	/// Installs the backend on the calling thread, returns the previous one
+	static GLDispatchBackend* Install(GLDispatchBackend* backend)
+	{
+		GLDispatchBackend* prev = _current();
+		_current() = backend;
+		return prev;
+	}
+
+	/// Called before a GL function is invoked
+	/** If this function returns true, then the real GL function is called
+	 *  and its return value is stored in @c call.result. Otherwise
+	 *  the GL function is not called and the backend is responsible
+	 *  for setting the result (and any output parameters) of the call.
+	 */
+	virtual bool BeginCall(GLCallInfo& call) = 0;
+
+	/// Called after the GL function was (or was not) invoked
+	virtual void EndCall(GLCallInfo& call) = 0;
+};
+
+/// Installs a GL dispatch backend for the lifetime of an instance
+/**
+ *  @ingroup gl_dispatch
+ */
+class GLDispatchBackendScope
+{
+private:
+	GLDispatchBackend* _prev;
+
+	GLDispatchBackendScope(const GLDispatchBackendScope&);
+public:
+	/// Installs the specified @p backend
+	GLDispatchBackendScope(GLDispatchBackend& backend)
+	 : _prev(GLDispatchBackend::Install(&backend))
+	{ }
+
+	/// Re-installs the previously used backend
+	~GLDispatchBackendScope(void)
+	{
+		GLDispatchBackend::Install(_prev);
+	}
+};
+
+} // namespace oglplus
+
+#if !OGLPLUS_LINK_LIBRARY || defined(OGLPLUS_IMPLEMENTING_LIBRARY)
+#include <oglplus/dispatch/backend.ipp>
+#endif
+
+#endif // include guard
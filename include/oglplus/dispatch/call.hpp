@@ -0,0 +1,273 @@
+/**
+ *  @file oglplus/dispatch/call.hpp
+ *  @brief Type-erased description of a dispatched GL function call
+ *
+ *  @author Matus Chochlik
+ *
+ *  Copyright 2010-2015 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#pragma once
+#ifndef OGLPLUS_DISPATCH_CALL_1509101200_HPP
+#define OGLPLUS_DISPATCH_CALL_1509101200_HPP
+
+#include <oglplus/config/compiler.hpp>
+#include <oglplus/config/gl.hpp>
+#include <oglplus/detail/enum_class.hpp>
+
+#include <type_traits>
+#include <cstddef>
+
+namespace oglplus {
+
+/// The kind of value stored in a GLCallArg
+OGLPLUS_ENUM_CLASS_BEGIN(GLCallArgKind, unsigned char)
+	OGLPLUS_ENUM_CLASS_VALUE(None, 0)
+	OGLPLUS_ENUM_CLASS_COMMA
+	OGLPLUS_ENUM_CLASS_VALUE(Integer, 1)
+	OGLPLUS_ENUM_CLASS_COMMA
+	OGLPLUS_ENUM_CLASS_VALUE(Float, 2)
+	OGLPLUS_ENUM_CLASS_COMMA
+	OGLPLUS_ENUM_CLASS_VALUE(ConstPointer, 3)
+	OGLPLUS_ENUM_CLASS_COMMA
+	OGLPLUS_ENUM_CLASS_VALUE(Pointer, 4)
+	OGLPLUS_ENUM_CLASS_COMMA
+	OGLPLUS_ENUM_CLASS_VALUE(FuncPointer, 5)
+OGLPLUS_ENUM_CLASS_END(GLCallArgKind)
+
+/// Type-erased argument or return value of a dispatched GL function
+/**
+ *  @ingroup gl_dispatch
+ */
+struct GLCallArg
+{
+	union {
+		long long i;
+		double f;
+		void* p;
+		void (*fp)(void);
+	} value;
+
+	/// The kind of the stored value
+	GLCallArgKind kind;
+
+	/// The size of the pointee if this is an object pointer (or zero)
+	unsigned short pointee_size;
+
+	GLCallArg(void)
+	 : kind(GLCallArgKind::None)
+	 , pointee_size(0)
+	{
+		value.i = 0;
+	}
+
+	/// Returns true if this is a data pointer
+	bool IsPointer(void) const
+	{
+		return	(kind == GLCallArgKind::Pointer) ||
+			(kind == GLCallArgKind::ConstPointer);
+	}
+
+	/// Returns the stored value as an integer
+	long long Int(void) const
+	{
+		if(kind == GLCallArgKind::Float) return (long long)(value.f);
+		return value.i;
+	}
+
+	/// Returns the stored value as a floating-point number
+	double Float(void) const
+	{
+		if(kind == GLCallArgKind::Float) return value.f;
+		return double(value.i);
+	}
+
+	/// Returns the stored value as a pointer
+	void* Ptr(void) const
+	{
+		return IsPointer()?value.p:nullptr;
+	}
+};
+
+namespace aux {
+
+template <typename T, bool IsIntegral, bool IsFloat, bool IsPtr>
+struct GLCallArgConv;
+
+template <typename T>
+struct GLCallArgConv<T, true, false, false>
+{
+	static void Put(GLCallArg& a, T v)
+	{
+		a.kind = GLCallArgKind::Integer;
+		a.value.i = (long long)(v);
+	}
+
+	static T Get(const GLCallArg& a)
+	{
+		return T(a.Int());
+	}
+};
+
+template <typename T>
+struct GLCallArgConv<T, false, true, false>
+{
+	static void Put(GLCallArg& a, T v)
+	{
+		a.kind = GLCallArgKind::Float;
+		a.value.f = double(v);
+	}
+
+	static T Get(const GLCallArg& a)
+	{
+		return T(a.Float());
+	}
+};
+
+// the size of incomplete types (and void) is zero
+template <typename P, typename = void>
+struct GLCallArgPointeeSize
+{
+	static const std::size_t value = 0;
+};
+
+template <typename P>
+struct GLCallArgPointeeSize<
+	P,
+	typename std::enable_if<(sizeof(P) > 0)>::type
+>
+{
+	static const std::size_t value = sizeof(P);
+};
+
+template <typename T>
+struct GLCallArgPtrConv
+{
+	typedef typename std::remove_pointer<T>::type Pointee;
+
+	static void Put(GLCallArg& a, T v)
+	{
+		a.kind = std::is_const<Pointee>::value?
+			GLCallArgKind::ConstPointer:
+			GLCallArgKind::Pointer;
+		a.pointee_size = (unsigned short)(GLCallArgPointeeSize<
+			typename std::remove_cv<Pointee>::type
+		>::value);
+		a.value.p = const_cast<void*>((const volatile void*)(v));
+	}
+
+	static T Get(const GLCallArg& a)
+	{
+		return static_cast<T>(a.value.p);
+	}
+};
+
+template <typename T>
+struct GLCallArgFnConv
+{
+	static void Put(GLCallArg& a, T v)
+	{
+		a.kind = GLCallArgKind::FuncPointer;
+		a.value.fp = reinterpret_cast<void(*)(void)>(v);
+	}
+
+	static T Get(const GLCallArg& a)
+	{
+		return reinterpret_cast<T>(a.value.fp);
+	}
+};
+
+template <typename T>
+struct GLCallArgConv<T, false, false, true>
+ : std::conditional<
+	std::is_function<typename std::remove_pointer<T>::type>::value,
+	GLCallArgFnConv<T>,
+	GLCallArgPtrConv<T>
+>::type
+{ };
+
+template <typename T>
+struct GLCallArgConvFor
+ : GLCallArgConv<
+	T,
+	std::is_integral<T>::value || std::is_enum<T>::value,
+	std::is_floating_point<T>::value,
+	std::is_pointer<T>::value
+>
+{ };
+
+} // namespace aux
+
+/// Stores the value @p v into the type-erased call argument
+/**
+ *  @ingroup gl_dispatch
+ */
+template <typename T>
+inline GLCallArg MakeGLCallArg(T v)
+{
+	GLCallArg result;
+	aux::GLCallArgConvFor<T>::Put(result, v);
+	return result;
+}
+
+/// Gets the value of type @p T from the type-erased call argument
+/**
+ *  @ingroup gl_dispatch
+ */
+template <typename T>
+inline T GLCallArgValue(const GLCallArg& arg)
+{
+	return aux::GLCallArgConvFor<T>::Get(arg);
+}
+
+/// Function re-invoking an erased GL function with type-erased arguments
+typedef void (*GLCallInvoker)(
+	void (*)(void),
+	const char*,
+	const GLCallArg*,
+	GLCallArg*
+);
+
+/// Description of a GL function call passed to the dispatch backends
+/**
+ *  @ingroup gl_dispatch
+ */
+struct GLCallInfo
+{
+	/// The name of the GL function (without the gl prefix)
+	const char* name;
+
+	/// Pointer to the array of arguments
+	GLCallArg* args;
+
+	/// The number of arguments
+	std::size_t arg_count;
+
+	/// The result of the call (kind None for void functions)
+	GLCallArg result;
+
+	/// The type-erased pointer to the GL function
+	void (*function)(void);
+
+	/// The function that can be used to re-invoke the call
+	GLCallInvoker invoker;
+
+	GLCallInfo(
+		const char* fn_name,
+		GLCallArg* fn_args,
+		std::size_t fn_arg_count,
+		void (*fn)(void),
+		GLCallInvoker inv
+	): name(fn_name)
+	 , args(fn_args)
+	 , arg_count(fn_arg_count)
+	 , function(fn)
+	 , invoker(inv)
+	{ }
+};
+
+} // namespace oglplus
+
+#endif // include guard
@@ -0,0 +1,318 @@
+/**
+ *  @file oglplus/dispatch/func.hpp
+ *  @brief Wrappers routing GL function calls through dispatch backends
+ *
+ *  @author Matus Chochlik
+ *
+ *  Copyright 2010-2015 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#pragma once
+#ifndef OGLPLUS_DISPATCH_FUNC_1509101200_HPP
+#define OGLPLUS_DISPATCH_FUNC_1509101200_HPP
+
+#include <oglplus/dispatch/backend.hpp>
+
+#if OGLPLUS_NO_VARIADIC_TEMPLATES
+#error "The GL dispatch layer requires variadic templates"
+#endif
+
+#if !OGLPLUS_NO_GLFUNC_CHECKS
+#include <oglplus/error/glfunc.hpp>
+#endif
+
+namespace oglplus {
+namespace aux {
+
+template <std::size_t ... I>
+struct GLDispatchIdx { };
+
+template <std::size_t N, std::size_t ... I>
+struct GLDispatchMakeIdx
+ : GLDispatchMakeIdx<N-1, N-1, I...>
+{ };
+
+template <std::size_t ... I>
+struct GLDispatchMakeIdx<0, I...>
+{
+	typedef GLDispatchIdx<I...> type;
+};
+
+inline void GLDispatchCapture(GLCallArg*) { }
+
+template <typename P, typename ... Pn>
+inline void GLDispatchCapture(GLCallArg* args, P p, Pn ... pn)
+{
+	*args = MakeGLCallArg<P>(p);
+	GLDispatchCapture(args+1, pn...);
+}
+
+template <typename RV, typename ... P>
+struct GLDispatchInvoke
+{
+	template <std::size_t ... I>
+	static void _call(
+		RV (GLAPIENTRY *pfn)(P...),
+		const GLCallArg* args,
+		GLCallArg* result,
+		GLDispatchIdx<I...>
+	)
+	{
+		*result = MakeGLCallArg<RV>(pfn(GLCallArgValue<P>(args[I])...));
+		(void)args;
+	}
+};
+
+template <typename ... P>
+struct GLDispatchInvoke<void, P...>
+{
+	template <std::size_t ... I>
+	static void _call(
+		void (GLAPIENTRY *pfn)(P...),
+		const GLCallArg* args,
+		GLCallArg*,
+		GLDispatchIdx<I...>
+	)
+	{
+		pfn(GLCallArgValue<P>(args[I])...);
+		(void)args;
+	}
+};
+
+template <typename RV>
+struct GLDispatchResult
+{
+	static RV Get(const GLCallArg& result)
+	{
+		return GLCallArgValue<RV>(result);
+	}
+};
+
+template <>
+struct GLDispatchResult<void>
+{
+	static void Get(const GLCallArg&) { }
+};
+
+template <typename RV>
+struct GLDispatchResultKind
+{
+	static GLCallArg Make(void)
+	{
+		return MakeGLCallArg<RV>(RV());
+	}
+};
+
+template <>
+struct GLDispatchResultKind<void>
+{
+	static GLCallArg Make(void)
+	{
+		return GLCallArg();
+	}
+};
+
+} // namespace aux
+
+/// Callable object routing a call to a GL function through the dispatch layer
+/**
+ *  @note Do not use this class directly, use the @c OGLPLUS_GLFUNC macro.
+ *
+ *  @ingroup gl_dispatch
+ */
+template <typename RV, typename ... P>
+class GLDispatchedFunc
+{
+private:
+	typedef RV (GLAPIENTRY *_pfn_t)(P...);
+	_pfn_t _pfn;
+	const char* _name;
+
+	typedef typename aux::GLDispatchMakeIdx<sizeof...(P)>::type _idx_t;
+
+	static void _invoke(
+		void (*fn)(void),
+		const char*,
+		const GLCallArg* args,
+		GLCallArg* result
+	)
+	{
+		aux::GLDispatchInvoke<RV, P...>::_call(
+			reinterpret_cast<_pfn_t>(fn),
+			args,
+			result,
+			_idx_t()
+		);
+	}
+
+	/// Re-dispatches a previously recorded call
+	static void _redispatch(
+		void (*fn)(void),
+		const char* name,
+		const GLCallArg* args,
+		GLCallArg* result
+	)
+	{
+		GLDispatchedFunc disp(reinterpret_cast<_pfn_t>(fn), name);
+		disp._dispatch(args, result);
+	}
+
+	void _dispatch(const GLCallArg* args, GLCallArg* result) const
+	{
+		GLCallArg args_copy[sizeof...(P)+1];
+		for(std::size_t i=0; i!=sizeof...(P); ++i)
+		{
+			args_copy[i] = args[i];
+		}
+		GLDispatchBackend* backend = GLDispatchBackend::Current();
+		if(backend)
+		{
+			_dispatch(*backend, args_copy, *result);
+		}
+		else _invoke(
+			reinterpret_cast<void(*)(void)>(_pfn),
+			_name,
+			args_copy,
+			result
+		);
+	}
+
+	void _dispatch(
+		GLDispatchBackend& backend,
+		GLCallArg* args,
+		GLCallArg& result
+	) const
+	{
+		GLCallInfo call(
+			_name,
+			args,
+			sizeof...(P),
+			reinterpret_cast<void(*)(void)>(_pfn),
+			&_redispatch
+		);
+		call.result = aux::GLDispatchResultKind<RV>::Make();
+		if(backend.BeginCall(call))
+		{
+			_invoke(call.function, _name, args, &call.result);
+		}
+		backend.EndCall(call);
+		result = call.result;
+	}
+public:
+	GLDispatchedFunc(_pfn_t pfn, const char* name)
+	 : _pfn(pfn)
+	 , _name(name)
+	{ }
+
+	/// Calls the GL function through the current backend
+	RV operator()(P ... p) const
+	{
+		GLDispatchBackend* backend = GLDispatchBackend::Current();
+		if(!backend) return _pfn(p...);
+
+		GLCallArg args[sizeof...(P)+1];
+		aux::GLDispatchCapture(args, p...);
+		GLCallArg result;
+		_dispatch(*backend, args, result);
+		return aux::GLDispatchResult<RV>::Get(result);
+	}
+};
+
+namespace aux {
+
+// Trampolines having the same signature as the wrapped GL functions
+// so that they can be used everywhere where a pointer to a GL function
+// is expected (for example when it is passed to another function)
+template <typename RV, typename ... P>
+struct GLDispatchDirect
+{
+	typedef RV (GLAPIENTRY *_pfn_t)(P...);
+
+	template <_pfn_t PFN>
+	struct Fn
+	{
+		static const char* _name(const char* name = nullptr)
+		{
+			static const char* fn_name = name;
+			return fn_name;
+		}
+
+		static RV GLAPIENTRY _call(P ... p)
+		{
+			return GLDispatchedFunc<RV, P...>(PFN, _name())(p...);
+		}
+
+		static _pfn_t Get(const char* name)
+		{
+			_name(name);
+			return &_call;
+		}
+	};
+};
+
+template <typename RV, typename ... P>
+struct GLDispatchIndirect
+{
+	typedef RV (GLAPIENTRY *_pfn_t)(P...);
+
+	template <_pfn_t* PPFN>
+	struct Fn
+	{
+		static const char* _name(const char* name = nullptr)
+		{
+			static const char* fn_name = name;
+			return fn_name;
+		}
+
+		static RV GLAPIENTRY _call(P ... p)
+		{
+			return GLDispatchedFunc<RV, P...>(*PPFN, _name())(p...);
+		}
+
+		static _pfn_t Get(const char* name)
+		{
+			_name(name);
+#if !OGLPLUS_NO_GLFUNC_CHECKS
+			OGLPLUS_HANDLE_ERROR_IF(
+				(!*PPFN),
+				GL_INVALID_OPERATION,
+				MissingFunction::Message(),
+				MissingFunction,
+				GLFunc(name)
+			);
+#endif
+			return &_call;
+		}
+	};
+};
+
+template <typename RV, typename ... P>
+GLDispatchDirect<RV, P...> GLDispatchKind(RV (GLAPIENTRY *)(P...));
+
+template <typename RV, typename ... P>
+GLDispatchIndirect<RV, P...> GLDispatchKind(RV (* GLAPIENTRY *)(P...));
+
+} // namespace aux
+
+/// Returns a callable object calling the specified function through a backend
+/**
+ *  @ingroup gl_dispatch
+ */
+template <typename RV, typename ... P>
+inline GLDispatchedFunc<RV, P...> DispatchedGLFunc(
+	RV (GLAPIENTRY *pfn)(P...),
+	const char* func_name
+)
+{
+	return GLDispatchedFunc<RV, P...>(pfn, func_name);
+}
+
+#define OGLPLUS_DISPATCHED_FUNC(PREFIX, FUNCNAME) \
+	decltype(::oglplus::aux::GLDispatchKind(&::PREFIX##FUNCNAME))::\
+		Fn<&::PREFIX##FUNCNAME>::Get(#FUNCNAME)
+
+} // namespace oglplus
+
+#endif // include guard
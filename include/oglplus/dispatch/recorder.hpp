@@ -0,0 +1,216 @@
+/**
+ *  @file oglplus/dispatch/recorder.hpp
+ *  @brief GL dispatch backends recording the GL function calls
+ *
+ *  @author Matus Chochlik
+ *
+ *  Copyright 2010-2015 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#pragma once
+#ifndef OGLPLUS_DISPATCH_RECORDER_1509101200_HPP
+#define OGLPLUS_DISPATCH_RECORDER_1509101200_HPP
+
+#include <oglplus/dispatch/backend.hpp>
+
+#include <chrono>
+#include <vector>
+#include <map>
+#include <iosfwd>
+#include <cassert>
+
+namespace oglplus {
+
+/// Record of a single GL function call made through a GLCallRecorder
+/**
+ *  @ingroup gl_dispatch
+ */
+struct GLCallRecord
+{
+	/// The name of the called function (without the gl prefix)
+	const char* name;
+
+	/// Index of the first argument in the recorder's argument list
+	std::size_t first_arg;
+
+	/// The number of arguments
+	std::size_t arg_count;
+
+	/// The result of the call
+	GLCallArg result;
+
+	/// The type-erased pointer to the GL function
+	void (*function)(void);
+
+	/// The function re-dispatching the call
+	GLCallInvoker invoker;
+
+	/// Time (in seconds) since the start of recording when the call started
+	double start;
+
+	/// The time (in seconds) spent in the GL function (or its emulation)
+	double duration;
+
+	/// Indicates if the call was forwarded to the GL
+	bool forwarded;
+};
+
+/// Aggregated statistics of calls to a single GL function
+/**
+ *  @ingroup gl_dispatch
+ */
+struct GLCallStats
+{
+	/// The name of the GL function
+	const char* name;
+
+	/// The number of calls
+	std::size_t count;
+
+	/// The total time (in seconds) spent in the calls
+	double time;
+};
+
+/// GL dispatch backend which records all calls, their arguments and timing
+/** The recorded calls are forwarded to the GL. The call stream
+ *  can later be inspected, summarized or replayed.
+ *
+ *  @note Pointer arguments are recorded verbatim (the pointed-to data
+ *  is not copied), so the data must be kept alive if the recorded
+ *  calls are to be replayed.
+ *
+ *  @ingroup gl_dispatch
+ */
+class GLCallRecorder
+ : public GLDispatchBackend
+{
+private:
+	typedef std::chrono::steady_clock _clock;
+	_clock::time_point _epoch;
+	_clock::time_point _call_start;
+
+	std::vector<GLCallRecord> _calls;
+	std::vector<GLCallArg> _args;
+
+	bool _enabled;
+	bool _forwarded;
+
+	double _since_epoch(_clock::time_point tp) const
+	{
+		return std::chrono::duration<double>(tp - _epoch).count();
+	}
+protected:
+	/// Called by BeginCall, returns true if the call should go to the GL
+	virtual bool Forward(GLCallInfo& call);
+public:
+	GLCallRecorder(void);
+
+	bool BeginCall(GLCallInfo& call);
+	void EndCall(GLCallInfo& call);
+
+	/// Enables or disables the recording (the calls are still dispatched)
+	void Enable(bool enable = true)
+	{
+		_enabled = enable;
+	}
+
+	/// Disables the recording
+	void Disable(void)
+	{
+		Enable(false);
+	}
+
+	/// Removes all recorded calls and restarts the timer
+	void Clear(void);
+
+	/// Returns the number of recorded calls
+	std::size_t CallCount(void) const
+	{
+		return _calls.size();
+	}
+
+	/// Returns the i-th recorded call
+	const GLCallRecord& Call(std::size_t index) const
+	{
+		assert(index < _calls.size());
+		return _calls[index];
+	}
+
+	/// Returns the i-th argument of the specified call
+	const GLCallArg& Arg(const GLCallRecord& call, std::size_t index) const
+	{
+		assert(index < call.arg_count);
+		return _args[call.first_arg+index];
+	}
+
+	/// Returns the number of recorded calls of the function @p name
+	std::size_t CountOf(const char* name) const;
+
+	/// Returns the time span (in seconds) of the recorded call stream
+	double TimeSpan(void) const;
+
+	/// Returns per-function statistics ordered by descending call count
+	std::vector<GLCallStats> Statistics(void) const;
+
+	/// Writes a textual summary of the recorded calls to @p out
+	std::ostream& Report(std::ostream& out) const;
+
+	/// Writes the recorded call stream to @p out (one call per line)
+	std::ostream& Dump(std::ostream& out) const;
+
+	/// Re-issues the recorded calls through the current dispatch backend
+	/** The recording is disabled during the replay if this recorder
+	 *  is the currently installed backend.
+	 */
+	void Replay(void);
+};
+
+/// GL dispatch backend which records all calls without calling the GL
+/** This backend does not require a GL context. Object name generation
+ *  (@c Gen*, @c Create*), sync objects, status and framebuffer completeness
+ *  queries are emulated so that the @OGLplus wrappers run
+ *  without errors; other output parameters are zero-initialized.
+ *  Derived classes can override the Emulate function to emulate
+ *  additional functions.
+ *
+ *  @ingroup gl_dispatch
+ */
+class GLHeadlessRecorder
+ : public GLCallRecorder
+{
+private:
+	GLuint _next_name;
+	std::map<GLenum, GLint> _integers;
+protected:
+	bool Forward(GLCallInfo& call);
+
+	/// Emulates the effects of the specified @p call
+	virtual void Emulate(GLCallInfo& call);
+
+	/// Generates a new unique object name
+	GLuint NextName(void)
+	{
+		return _next_name++;
+	}
+public:
+	/// Constructs the recorder and sets generous implementation limits
+	GLHeadlessRecorder(void);
+
+	/// Sets the value returned by the emulated @c glGetIntegerv(pname, ...)
+	/** The values of the queried parameters that were not set are zero.
+	 */
+	void SetInteger(GLenum pname, GLint value)
+	{
+		_integers[pname] = value;
+	}
+};
+
+} // namespace oglplus
+
+#if !OGLPLUS_LINK_LIBRARY || defined(OGLPLUS_IMPLEMENTING_LIBRARY)
+#include <oglplus/dispatch/recorder.ipp>
+#endif
+
+#endif // include guard
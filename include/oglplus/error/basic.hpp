@@ -14,10 +14,17 @@
 #define OGLPLUS_ERROR_BASIC_1107121317_HPP
 
 #include <oglplus/config/error.hpp>
+#include <oglplus/config/gl.hpp>
 #include <oglplus/error/code.hpp>
 #include <oglplus/string/def.hpp>
 #include <oglplus/string/ref.hpp>
 #include <oglplus/string/empty.hpp>
+#if !OGLPLUS_NO_ERROR_CHECK_POLICY
+#include <oglplus/error/policy.hpp>
+#endif
+#if OGLPLUS_PROFILE_GL_CALLS
+#include <oglplus/profile/call.hpp>
+#endif
 #include <stdexcept>
 #include <cassert>
 
@@ -372,20 +379,52 @@ inline void HandleError(ErrorType& error)
 	}\
 }
 
+#if OGLPLUS_USE_GL_DISPATCH || OGLPLUS_PROFILE_GL_CALLS
+#define OGLPLUS_GL_GET_ERROR() OGLPLUS_GLFUNC(GetError)()
+#else
+#define OGLPLUS_GL_GET_ERROR() ::glGetError()
+#endif
+
+#if !OGLPLUS_NO_ERROR_CHECK_POLICY
+#define OGLPLUS_GLFUNC_CHECK(FUNC_NAME, ERROR, ERROR_INFO)\
+{\
+	if(::oglplus::aux::ErrorCheckState::IsImmediateHere())\
+	OGLPLUS_HANDLE_ERROR_IF(\
+		error_code != GL_NO_ERROR,\
+		OGLPLUS_GL_GET_ERROR(),\
+		ERROR::Message(error_code),\
+		ERROR,\
+		ERROR_INFO.GLFunc(FUNC_NAME)\
+	)\
+	else ::oglplus::aux::ErrorCheckState::Current().Record(\
+		FUNC_NAME, __FILE__, __FUNCTION__, __LINE__\
+	);\
+}
+#else
 #define OGLPLUS_GLFUNC_CHECK(FUNC_NAME, ERROR, ERROR_INFO)\
 	OGLPLUS_HANDLE_ERROR_IF(\
 		error_code != GL_NO_ERROR,\
-		glGetError(),\
+		OGLPLUS_GL_GET_ERROR(),\
 		ERROR::Message(error_code),\
 		ERROR,\
 		ERROR_INFO.GLFunc(FUNC_NAME)\
 	)
+#endif
 
 #define OGLPLUS_CHECK(GLFUNC, ERROR, ERROR_INFO) \
 	OGLPLUS_GLFUNC_CHECK(#GLFUNC, ERROR, ERROR_INFO)
 
+#if OGLPLUS_PROFILE_GL_CALLS
+// a single statement, even in an unbraced if
+#define OGLPLUS_CHECK_CTXT(ERROR, ERROR_INFO) \
+	do { \
+		OGLPLUS_PROFILE_GL_CLASS(_errinf_cls()) \
+		OGLPLUS_GLFUNC_CHECK(_errinf_glfn(), ERROR, ERROR_INFO) \
+	} while(0)
+#else
 #define OGLPLUS_CHECK_CTXT(ERROR, ERROR_INFO) \
 	OGLPLUS_GLFUNC_CHECK(_errinf_glfn(), ERROR, ERROR_INFO)
+#endif
 
 #define OGLPLUS_CHECK_SIMPLE(GLFUNC) \
 	OGLPLUS_CHECK(GLFUNC, Error, NoInfo())
@@ -400,7 +439,17 @@ inline void HandleError(ErrorType& error)
 #define OGLPLUS_VERIFY_SIMPLE(GLFUNC) \
 	OGLPLUS_CHECK(GLFUNC, Error, NoInfo())
 
-#define OGLPLUS_IGNORE(PARAM) ::glGetError();
+#if !OGLPLUS_NO_ERROR_CHECK_POLICY
+// with the non-immediate policies the pending error of a preceding call
+// must not be cleared, errors of ignored calls are reported by the check
+#define OGLPLUS_IGNORE(PARAM) \
+	do { \
+		if(::oglplus::aux::ErrorCheckState::IsImmediateHere()) \
+			OGLPLUS_GL_GET_ERROR(); \
+	} while(0)
+#else
+#define OGLPLUS_IGNORE(PARAM) do { OGLPLUS_GL_GET_ERROR(); } while(0)
+#endif
 
 } // namespace oglplus
 
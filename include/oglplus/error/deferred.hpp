@@ -0,0 +1,200 @@
+/**
+ *  @file oglplus/error/deferred.hpp
+ *  @brief Deferred and debug output-based GL error checks
+ *
+ *  @author Matus Chochlik
+ *
+ *  Copyright 2010-2015 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#pragma once
+#ifndef OGLPLUS_ERROR_DEFERRED_1509121040_HPP
+#define OGLPLUS_ERROR_DEFERRED_1509121040_HPP
+
+#include <oglplus/config/compiler.hpp>
+#include <oglplus/error/basic.hpp>
+#include <oglplus/error/policy.hpp>
+#include <oglplus/glfunc.hpp>
+#include <vector>
+#include <memory>
+
+namespace oglplus {
+
+/// Exception indicating a GL error detected by a deferred error check
+/** With the ErrorCheckPolicy::Deferred policy the GL error is queried
+ *  only once for a whole sequence of GL function calls, so the failing call
+ *  cannot be identified. CallSites() lists the candidates, which are
+ *  the most recent (up to #OGLPLUS_ERROR_CALL_SITE_COUNT) calls made
+ *  since the previous check. If CallCount() is greater than the number
+ *  of the candidates then the failing call may not be among them,
+ *  since GL keeps only the first error. The GLFunc, SourceFile,
+ *  SourceFunc and SourceLine attributes are not set in this case.
+ *
+ *  With the ErrorCheckPolicy::DebugOutput policy the failing call is known
+ *  if it was checked; it is then the only one listed by CallSites()
+ *  and the GLFunc and source attributes refer to it.
+ *
+ *  @ingroup error_handling
+ */
+class DeferredError
+ : public Error
+{
+private:
+	std::vector<ErrorCallSite> _call_sites;
+	std::size_t _call_count;
+public:
+	static const char* Message(GLenum code);
+
+	DeferredError(const char* message)
+	 : Error(message)
+	 , _call_count(0)
+	{ }
+
+	~DeferredError(void) throw() { }
+
+	DeferredError& CallSites(
+		const std::vector<ErrorCallSite>& call_sites,
+		std::size_t call_count
+	)
+	{
+		_call_sites = call_sites;
+		_call_count = call_count;
+		return *this;
+	}
+
+	/// The call sites of the GL functions which could have caused the error
+	const std::vector<ErrorCallSite>& CallSites(void) const
+	{
+		return _call_sites;
+	}
+
+	/// The number of checked GL calls since the previous check
+	/** This may be greater than the number of CallSites().
+	 */
+	std::size_t CallCount(void) const
+	{
+		return _call_count;
+	}
+};
+
+/// Checks the errors of GL calls made with a non-immediate policy
+/** Throws DeferredError if an error was detected since the previous check.
+ *  This queries the GL error if any GL calls were checked since
+ *  the previous check, or if an error message was received through
+ *  the debug output. An error stored at the end of an ErrorCheckScope
+ *  which was not flushed is thrown first.
+ *
+ *  @ingroup error_handling
+ */
+void CheckDeferredErrors(void);
+
+/// Type of the functions handling the errors detected at the end of a scope
+/**
+ *  @see SetUnflushedErrorHandler
+ *
+ *  @ingroup error_handling
+ */
+typedef void (*UnflushedErrorHandler)(const DeferredError&);
+
+/// Sets the handler of the errors which were not flushed in a scope
+/** The outermost ErrorCheckScope checks the GL error when it ends,
+ *  so that an error of its calls is not reported by an unrelated
+ *  immediate check later. Since the destructor must not throw,
+ *  the error is passed to the @p handler installed for the current
+ *  thread, which must not throw either. Without a handler (the default)
+ *  the error is stored and thrown by the next CheckDeferredErrors call.
+ *  Returns the previously installed handler.
+ *
+ *  @ingroup error_handling
+ */
+UnflushedErrorHandler SetUnflushedErrorHandler(UnflushedErrorHandler handler);
+
+/// Selects the GL error check policy for the current thread and a scope
+/** Instances of this class set the specified ErrorCheckPolicy in
+ *  the constructor and restore the previous policy in the destructor.
+ *  This allows hot rendering loops to avoid the synchronous @c glGetError
+ *  queries after every GL call. The deferred errors are reported
+ *  by Flush, which should be called before the scope ends. The destructor
+ *  does not throw; if the scope is not nested in another non-immediate
+ *  scope then it checks the error which was not flushed and passes it to
+ *  the handler set by SetUnflushedErrorHandler.
+ *
+ *  The ErrorCheckPolicy::DebugOutput policy requires GL 4.3 or
+ *  the KHR_debug extension and a debug GL context; it enables synchronous
+ *  debug output for the lifetime of the scope and chains to the previously
+ *  installed debug message callback. If it is not available at compile-time
+ *  or at run-time, or if the context is not a debug context, then it
+ *  behaves like ErrorCheckPolicy::Deferred. The GL error is queried by
+ *  the checks with both policies, so the errors which do not generate
+ *  a debug message are not lost.
+ *
+ *  @note Errors generated by calls whose errors are normally ignored
+ *  are also reported by the deferred checks.
+ *
+ *  @see CheckDeferredErrors
+ *  @see #OGLPLUS_NO_ERROR_CHECK_POLICY
+ *
+ *  @ingroup error_handling
+ */
+class ErrorCheckScope
+{
+private:
+	ErrorCheckPolicy _prev_policy;
+#if GL_VERSION_4_3 || GL_KHR_debug
+	bool _debug_output;
+	GLDEBUGPROC _prev_callback;
+	void* _prev_context;
+	GLboolean _prev_enabled;
+	GLboolean _prev_sync;
+
+	static void GLAPIENTRY _gl_debug_proc(
+		GLenum source,
+		GLenum type,
+		GLuint id,
+		GLenum severity,
+		GLsizei length,
+		const GLchar* message,
+		GLvoid* user_param
+	);
+
+	static bool _has_debug_output(void);
+	void _setup_debug_output(void);
+	void _restore_debug_output(void);
+#endif
+	bool _counted;
+
+	ErrorCheckScope(const ErrorCheckScope&);
+public:
+	/// Sets the specified @p policy for the current thread
+	ErrorCheckScope(ErrorCheckPolicy policy);
+
+	/// Checks the errors which were not flushed and restores the previous policy
+	~ErrorCheckScope(void) OGLPLUS_NOEXCEPT(true);
+
+	/// Returns the policy actually used by this scope
+	/** This is ErrorCheckPolicy::Deferred if ErrorCheckPolicy::DebugOutput
+	 *  was requested but the debug output is not available.
+	 */
+	ErrorCheckPolicy Policy(void) const
+	{
+		return aux::ErrorCheckState::Current().Policy();
+	}
+
+	/// Checks the errors of the GL calls made so far
+	/** Throws DeferredError if any of the calls failed.
+	 */
+	void Flush(void)
+	{
+		CheckDeferredErrors();
+	}
+};
+
+} // namespace oglplus
+
+#if !OGLPLUS_LINK_LIBRARY || defined(OGLPLUS_IMPLEMENTING_LIBRARY)
+#include <oglplus/error/deferred.ipp>
+#endif
+
+#endif // include guard
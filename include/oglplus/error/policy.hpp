@@ -0,0 +1,206 @@
+/**
+ *  @file oglplus/error/policy.hpp
+ *  @brief Run-time selectable GL error check policies
+ *
+ *  @author Matus Chochlik
+ *
+ *  Copyright 2010-2015 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#pragma once
+#ifndef OGLPLUS_ERROR_POLICY_1509121040_HPP
+#define OGLPLUS_ERROR_POLICY_1509121040_HPP
+
+#include <oglplus/config/error.hpp>
+#include <oglplus/config/compiler.hpp>
+#include <oglplus/detail/enum_class.hpp>
+#include <string>
+#include <atomic>
+#include <cstddef>
+
+namespace oglplus {
+
+/// Enumeration of the GL error check policies
+/**
+ *  @see ErrorCheckScope
+ *
+ *  @ingroup error_handling
+ */
+OGLPLUS_ENUM_CLASS_BEGIN(ErrorCheckPolicy, unsigned char)
+#if OGLPLUS_DOCUMENTATION_ONLY
+	/// The GL error is queried right after every GL function call
+	Immediate,
+	/// The GL error is queried once when the ErrorCheckScope ends
+	Deferred,
+	/// Errors are reported through the debug output (KHR_debug)
+	DebugOutput
+#else
+	OGLPLUS_ENUM_CLASS_VALUE(Immediate, 0)
+	OGLPLUS_ENUM_CLASS_COMMA
+	OGLPLUS_ENUM_CLASS_VALUE(Deferred, 1)
+	OGLPLUS_ENUM_CLASS_COMMA
+	OGLPLUS_ENUM_CLASS_VALUE(DebugOutput, 2)
+#endif
+OGLPLUS_ENUM_CLASS_END(ErrorCheckPolicy)
+
+/// Information about the location of a checked GL function call
+/**
+ *  @ingroup error_handling
+ */
+struct ErrorCallSite
+{
+	/// The name of the GL function (without the gl prefix)
+	const char* gl_func;
+	/// The source file where the function was called
+	const char* file;
+	/// The (C++) function where the GL function was called
+	const char* func;
+	/// The source line where the GL function was called
+	unsigned line;
+};
+
+namespace aux {
+
+// The number of the ErrorCheckScopes with a non-immediate policy
+// alive in all threads. While it is zero the error checks do not need
+// to look up the thread-local state
+template <typename Dummy>
+struct ErrorCheckScopeCounter
+{
+	static std::atomic<unsigned> count;
+};
+
+template <typename Dummy>
+std::atomic<unsigned> ErrorCheckScopeCounter<Dummy>::count(0u);
+
+// Per-thread state of the GL error checks
+class ErrorCheckState
+{
+private:
+	static const std::size_t _capacity = OGLPLUS_ERROR_CALL_SITE_COUNT;
+
+	ErrorCallSite _sites[_capacity];
+	std::size_t _recorded;
+
+	ErrorCheckPolicy _policy;
+
+	// the number of errors found by the deferred checks
+	unsigned long _error_count;
+
+	// the error reported through the debug output
+	std::string _debug_message;
+	ErrorCallSite _debug_site;
+	bool _debug_error;
+	bool _debug_site_pending;
+public:
+	ErrorCheckState(void);
+
+	static ErrorCheckState& Current(void);
+
+	ErrorCheckPolicy Policy(void) const
+	{
+		return _policy;
+	}
+
+	ErrorCheckPolicy Policy(ErrorCheckPolicy policy)
+	{
+		ErrorCheckPolicy prev = _policy;
+		_policy = policy;
+		return prev;
+	}
+
+	bool IsImmediate(void) const
+	{
+		return _policy == ErrorCheckPolicy::Immediate;
+	}
+
+	// returns true if the current thread uses the immediate policy.
+	// A thread sees its own updates of the counter, so a zero means that
+	// no non-immediate scope is alive in this thread
+	static bool IsImmediateHere(void)
+	{
+		return	(ErrorCheckScopeCounter<void>::count.load(
+				std::memory_order_relaxed
+			) == 0u) || Current().IsImmediate();
+	}
+
+	void Record(
+		const char* gl_func,
+		const char* file,
+		const char* func,
+		unsigned line
+	)
+	{
+		ErrorCallSite& site = _sites[_recorded % _capacity];
+		site.gl_func = gl_func;
+		site.file = file;
+		site.func = func;
+		site.line = line;
+		++_recorded;
+		if(_debug_site_pending)
+		{
+			_debug_site = site;
+			_debug_site_pending = false;
+		}
+	}
+
+	// the number of calls recorded since the last reset
+	std::size_t RecordedCount(void) const
+	{
+		return _recorded;
+	}
+
+	// the number of call sites still available
+	std::size_t SiteCount(void) const
+	{
+		return (_recorded < _capacity)?_recorded:std::size_t(_capacity);
+	}
+
+	// the i-th call site still available, oldest first
+	const ErrorCallSite& Site(std::size_t index) const
+	{
+		return _sites[(_recorded-SiteCount()+index) % _capacity];
+	}
+
+	// the number of errors found by the deferred checks so far,
+	// it is not reset by Reset
+	unsigned long ErrorCount(void) const
+	{
+		return _error_count;
+	}
+
+	void CountError(void)
+	{
+		++_error_count;
+	}
+
+	void ReportDebugError(const char* message);
+
+	bool HasDebugError(void) const
+	{
+		return _debug_error;
+	}
+
+	const std::string& DebugMessage(void) const
+	{
+		return _debug_message;
+	}
+
+	const ErrorCallSite& DebugSite(void) const
+	{
+		return _debug_site;
+	}
+
+	void Reset(void);
+};
+
+} // namespace aux
+} // namespace oglplus
+
+#if !OGLPLUS_LINK_LIBRARY || defined(OGLPLUS_IMPLEMENTING_LIBRARY)
+#include <oglplus/error/policy.ipp>
+#endif
+
+#endif // include guard
@@ -0,0 +1,226 @@
+/**
+ *  @file oglplus/frustum_culler.hpp
+ *  @brief Culling of large arrays of bounding spheres against a frustum
+ *
+ *  @author Matus Chochlik
+ *
+ *  Copyright 2010-2015 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#pragma once
+#ifndef OGLPLUS_FRUSTUM_CULLER_1510181400_HPP
+#define OGLPLUS_FRUSTUM_CULLER_1510181400_HPP
+
+#include <oglplus/config/compiler.hpp>
+#include <oglplus/math/frustum.hpp>
+
+#include <vector>
+#include <functional>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+
+namespace oglplus {
+
+/// An array of bounding spheres in the structure-of-arrays layout
+/** The coordinates of the centers and the radii are stored in separate
+ *  contiguous arrays, which allows to test several spheres at once
+ *  with SIMD instructions.
+ *
+ *  @ingroup math_utils
+ */
+class SphereArray
+{
+private:
+	std::vector<GLfloat> _x, _y, _z, _r;
+public:
+	/// Reserves space for @p count spheres
+	void Reserve(std::size_t count)
+	{
+		_x.reserve(count);
+		_y.reserve(count);
+		_z.reserve(count);
+		_r.reserve(count);
+	}
+
+	/// Removes all spheres
+	void Clear(void)
+	{
+		_x.clear();
+		_y.clear();
+		_z.clear();
+		_r.clear();
+	}
+
+	/// Returns the number of spheres
+	std::size_t Size(void) const
+	{
+		return _x.size();
+	}
+
+	/// Returns true if the array is empty
+	bool Empty(void) const
+	{
+		return _x.empty();
+	}
+
+	/// Appends a sphere with the specified center and radius
+	void Add(GLfloat x, GLfloat y, GLfloat z, GLfloat r)
+	{
+		assert(r >= 0.0f);
+		_x.push_back(x);
+		_y.push_back(y);
+		_z.push_back(z);
+		_r.push_back(r);
+	}
+
+	/// Appends the specified @p sphere
+	void Add(const Sphere<GLfloat>& sphere)
+	{
+		const Vector<GLfloat, 3>& c = sphere.Center();
+		Add(c.x(), c.y(), c.z(), sphere.Radius());
+	}
+
+	/// Returns the sphere at the specified @p index
+	Sphere<GLfloat> Get(std::size_t index) const
+	{
+		assert(index < Size());
+		return Sphere<GLfloat>(_x[index], _y[index], _z[index], _r[index]);
+	}
+
+	/// Changes the sphere at the specified @p index
+	void Set(std::size_t index, const Sphere<GLfloat>& sphere)
+	{
+		assert(index < Size());
+		const Vector<GLfloat, 3>& c = sphere.Center();
+		_x[index] = c.x();
+		_y[index] = c.y();
+		_z[index] = c.z();
+		_r[index] = sphere.Radius();
+	}
+
+	/// Returns the array of the x-coordinates of the centers
+	const GLfloat* X(void) const { return _x.data(); }
+
+	/// Returns the array of the y-coordinates of the centers
+	const GLfloat* Y(void) const { return _y.data(); }
+
+	/// Returns the array of the z-coordinates of the centers
+	const GLfloat* Z(void) const { return _z.data(); }
+
+	/// Returns the array of the radii
+	const GLfloat* Radius(void) const { return _r.data(); }
+};
+
+/// Tests arrays of bounding spheres against the planes of a view frustum
+/** The spheres are tested several at once using SSE2 or AVX instructions
+ *  when available (see OGLPLUS_NO_SIMD), and large arrays can be split
+ *  between several threads. The result is either a bitmask with a bit
+ *  for each sphere, set if the sphere is (at least partially) inside
+ *  of the frustum, or a compacted list of the indices of such spheres.
+ *
+ *  Like Frustum::Intersects, the test is conservative.
+ *
+ *  @ingroup math_utils
+ */
+class FrustumCuller
+{
+private:
+	GLfloat _planes[6][4];
+
+	void _init(const Frustum<GLfloat>& frustum);
+
+	void _cull_words(
+		const SphereArray& spheres,
+		std::size_t first_word,
+		std::size_t last_word,
+		std::uint32_t* mask
+	) const;
+
+	static std::size_t _count_bits(
+		const std::uint32_t* mask,
+		std::size_t first_word,
+		std::size_t last_word
+	);
+
+	static void _write_indices(
+		const std::uint32_t* mask,
+		std::size_t first_word,
+		std::size_t last_word,
+		GLuint* indices
+	);
+
+	static unsigned _thread_count(std::size_t words, unsigned threads);
+
+	static void _parallel(
+		unsigned threads,
+		std::size_t words,
+		const std::function<void (std::size_t, std::size_t, unsigned)>& func
+	);
+public:
+	/// The minimal number of spheres tested by a single thread
+	static const std::size_t MinSpheresPerThread = 64*1024;
+
+	/// Culls against the specified @p frustum
+	FrustumCuller(const Frustum<GLfloat>& frustum)
+	{
+		_init(frustum);
+	}
+
+	/// Culls against the frustum of the specified (camera) @p matrix
+	FrustumCuller(const Matrix<GLfloat, 4, 4>& matrix)
+	{
+		_init(Frustum<GLfloat>(matrix));
+	}
+
+	/// Returns the number of words of a mask for @p count spheres
+	static std::size_t MaskSize(std::size_t count)
+	{
+		return (count+31)/32;
+	}
+
+	/// Returns true if the bit for the sphere at @p index is set
+	static bool IsVisible(
+		const std::vector<std::uint32_t>& mask,
+		std::size_t i
+	)
+	{
+		assert(i/32 < mask.size());
+		return ((mask[i/32] >> (i%32)) & 1u) != 0u;
+	}
+
+	/// Returns the number of bits set in the @p mask
+	static std::size_t CountVisible(const std::vector<std::uint32_t>& mask);
+
+	/// Tests the @p spheres and stores the results into a bit @p mask
+	/** The bit @c i%32 of the word @c i/32 of the @p mask is set if the
+	 *  i-th sphere is visible. The unused bits of the last word are zero.
+	 *  If @p threads is zero then the number of hardware threads is used.
+	 */
+	void CullToMask(
+		const SphereArray& spheres,
+		std::vector<std::uint32_t>& mask,
+		unsigned threads = 1
+	) const;
+
+	/// Stores the indices of the visible @p spheres into @p indices
+	/** The indices are stored in ascending order. Returns the number
+	 *  of visible spheres. If @p threads is zero then the number
+	 *  of hardware threads is used.
+	 */
+	std::size_t CullToIndices(
+		const SphereArray& spheres,
+		std::vector<GLuint>& indices,
+		unsigned threads = 1
+	) const;
+};
+
+} // namespace oglplus
+
+#if !OGLPLUS_LINK_LIBRARY || defined(OGLPLUS_IMPLEMENTING_LIBRARY)
+#include <oglplus/frustum_culler.ipp>
+#endif // OGLPLUS_LINK_LIBRARY
+
+#endif // include guard
@@ -20,9 +20,39 @@
 #include <oglplus/error/glfunc.hpp>
 #endif
 
+#if OGLPLUS_PROFILE_GL_CALLS
+#include <oglplus/profile/func.hpp>
+#elif OGLPLUS_USE_GL_DISPATCH
+#include <oglplus/dispatch/func.hpp>
+#endif
+
 namespace oglplus {
 
-#if !OGLPLUS_NO_VARIADIC_TEMPLATES && !OGLPLUS_NO_GLFUNC_CHECKS
+#if OGLPLUS_PROFILE_GL_CALLS
+
+#ifndef OGLPLUS_GLFUNC
+#define OGLPLUS_GLFUNC(FUNCNAME) OGLPLUS_PROFILED_FUNC(gl, FUNCNAME)
+#endif
+#ifndef OGLPLUS_GLXFUNC
+#define OGLPLUS_GLXFUNC(FUNCNAME) OGLPLUS_PROFILED_FUNC(glX, FUNCNAME)
+#endif
+#ifndef OGLPLUS_WGLFUNC
+#define OGLPLUS_WGLFUNC(FUNCNAME) OGLPLUS_PROFILED_FUNC(wgl, FUNCNAME)
+#endif
+
+#elif OGLPLUS_USE_GL_DISPATCH
+
+#ifndef OGLPLUS_GLFUNC
+#define OGLPLUS_GLFUNC(FUNCNAME) OGLPLUS_DISPATCHED_FUNC(gl, FUNCNAME)
+#endif
+#ifndef OGLPLUS_GLXFUNC
+#define OGLPLUS_GLXFUNC(FUNCNAME) OGLPLUS_DISPATCHED_FUNC(glX, FUNCNAME)
+#endif
+#ifndef OGLPLUS_WGLFUNC
+#define OGLPLUS_WGLFUNC(FUNCNAME) OGLPLUS_DISPATCHED_FUNC(wgl, FUNCNAME)
+#endif
+
+#elif !OGLPLUS_NO_VARIADIC_TEMPLATES && !OGLPLUS_NO_GLFUNC_CHECKS
 template <typename RV, typename ... Params>
 inline auto _checked_glfunc(
 	RV (GLAPIENTRY *pfn)(Params...),
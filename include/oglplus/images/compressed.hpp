@@ -0,0 +1,377 @@
+/**
+ *  @file oglplus/images/compressed.hpp
+ *  @brief Block-compressed (BCn) images encoded on the CPU
+ *
+ *  @author Matus Chochlik
+ *
+ *  Copyright 2010-2015 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#pragma once
+#ifndef OGLPLUS_IMAGES_COMPRESSED_1510021430_HPP
+#define OGLPLUS_IMAGES_COMPRESSED_1510021430_HPP
+
+#include <oglplus/config/compiler.hpp>
+#include <oglplus/detail/enum_class.hpp>
+#include <oglplus/pixel_data.hpp>
+#include <oglplus/images/image.hpp>
+#include <oglplus/images/mipmap.hpp>
+
+#include <vector>
+#include <cstddef>
+
+// the S3TC tokens are not a part of the core GL headers
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT1_EXT 0x83F1
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+#ifndef GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT
+#define GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT 0x8C4D
+#endif
+#ifndef GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT 0x8C4F
+#endif
+
+namespace oglplus {
+namespace images {
+
+/// The block compression formats
+/**
+ *  @ingroup image_load_gen
+ */
+OGLPLUS_ENUM_CLASS_BEGIN(BlockFormat, GLuint)
+	/// RGB with optional 1-bit alpha, 8 bytes per 4x4 block (DXT1)
+	OGLPLUS_ENUM_CLASS_VALUE(BC1, 1)
+	OGLPLUS_ENUM_CLASS_COMMA
+	/// RGB with interpolated alpha, 16 bytes per 4x4 block (DXT5)
+	OGLPLUS_ENUM_CLASS_VALUE(BC3, 3)
+	OGLPLUS_ENUM_CLASS_COMMA
+	/// Single channel, 8 bytes per 4x4 block (RGTC1)
+	OGLPLUS_ENUM_CLASS_VALUE(BC4, 4)
+	OGLPLUS_ENUM_CLASS_COMMA
+	/// Two channels, 16 bytes per 4x4 block (RGTC2)
+	OGLPLUS_ENUM_CLASS_VALUE(BC5, 5)
+	OGLPLUS_ENUM_CLASS_COMMA
+	/// RGBA, 16 bytes per 4x4 block (BPTC)
+	OGLPLUS_ENUM_CLASS_VALUE(BC7, 7)
+OGLPLUS_ENUM_CLASS_END(BlockFormat)
+
+/// The trade-off between the speed and the quality of block compression
+/**
+ *  @ingroup image_load_gen
+ */
+OGLPLUS_ENUM_CLASS_BEGIN(BlockQuality, GLuint)
+	/// Endpoints from the bounding box of the block
+	OGLPLUS_ENUM_CLASS_VALUE(Fast, 0)
+	OGLPLUS_ENUM_CLASS_COMMA
+	/// Endpoints from the principal axis, refined once
+	OGLPLUS_ENUM_CLASS_VALUE(Normal, 1)
+	OGLPLUS_ENUM_CLASS_COMMA
+	/// Iterative refinement and search of the encoding modes
+	OGLPLUS_ENUM_CLASS_VALUE(High, 2)
+OGLPLUS_ENUM_CLASS_END(BlockQuality)
+
+/// Parameters of the block compression of images
+/**
+ *  @ingroup image_load_gen
+ */
+class BlockCompressionParams
+{
+private:
+	BlockFormat _format;
+	BlockQuality _quality;
+	int _srgb;
+	bool _signed;
+	unsigned _threads;
+public:
+	BlockCompressionParams(BlockFormat format = BlockFormat::BC1)
+	 : _format(format)
+	 , _quality(BlockQuality::Normal)
+	 , _srgb(-1)
+	 , _signed(false)
+	 , _threads(0)
+	{ }
+
+	/// Sets the block compression format (BC1 by default)
+	BlockCompressionParams& Format(BlockFormat format)
+	{
+		_format = format;
+		return *this;
+	}
+
+	/// Returns the block compression format
+	BlockFormat Format(void) const
+	{
+		return _format;
+	}
+
+	/// Sets the quality of the compression (Normal by default)
+	BlockCompressionParams& Quality(BlockQuality quality)
+	{
+		_quality = quality;
+		return *this;
+	}
+
+	/// Returns the quality of the compression
+	BlockQuality Quality(void) const
+	{
+		return _quality;
+	}
+
+	/// Specifies if the color channels are sRGB-encoded
+	/** If not specified, then the color space is determined from
+	 *  the internal format of the source image. The encoded values
+	 *  are compressed as they are, this only selects the sRGB variant
+	 *  of the compressed internal format (for BC1, BC3 and BC7).
+	 */
+	BlockCompressionParams& SRGB(bool srgb = true)
+	{
+		_srgb = srgb?1:0;
+		return *this;
+	}
+
+	/// Returns true if the color channels were specified as sRGB-encoded
+	bool IsSRGB(void) const
+	{
+		return _srgb > 0;
+	}
+
+	/// Returns true if the color channels of the @p image are sRGB-encoded
+	bool IsSRGB(const Image& image) const
+	{
+		if(_srgb >= 0) return _srgb > 0;
+		return image.IsSRGB();
+	}
+
+	/// Specifies that the values are signed (BC4 and BC5 only)
+	/** The source values in the [-1, 1] range (for example those
+	 *  of a NormalMap) are compressed into the signed variant
+	 *  of the BC4 and BC5 formats. Ignored by the other formats.
+	 */
+	BlockCompressionParams& Signed(bool is_signed = true)
+	{
+		_signed = is_signed;
+		return *this;
+	}
+
+	/// Returns true if the values are compressed as signed
+	bool IsSigned(void) const
+	{
+		return _signed && (
+			(_format == BlockFormat::BC4) ||
+			(_format == BlockFormat::BC5)
+		);
+	}
+
+	/// Sets the number of threads used for the compression
+	/** Zero means the number of hardware threads. Small images
+	 *  are always compressed by the calling thread.
+	 */
+	BlockCompressionParams& Threads(unsigned threads)
+	{
+		_threads = threads;
+		return *this;
+	}
+
+	/// Returns the number of threads used for the compression
+	unsigned Threads(void) const;
+};
+
+/// An image compressed into 4x4 texel blocks
+/** The CompressedImage is either encoded from an uncompressed Image
+ *  or wraps already compressed data. The channels of the source image
+ *  are used as follows:
+ *  - BC1, BC3, BC7: red, green, blue and alpha; single-channel images
+ *    are compressed as grayscale and a missing alpha is opaque,
+ *  - BC4: the first channel,
+ *  - BC5: the first two channels.
+ *
+ *  BC1 blocks with texels having alpha below one half use the 1-bit
+ *  alpha (punch-through) mode. BC7 blocks are encoded in mode 6 (single
+ *  subset with 4-bit indices). The layers of 3D and array images are
+ *  compressed separately.
+ *
+ *  @code
+ *  images::CompressedImage compressed(
+ *    images::NormalMap(images::LoadTexture("stones_hmap")),
+ *    images::BlockCompressionParams(images::BlockFormat::BC5)
+ *  );
+ *  Texture::CompressedImage(Texture::Target::_2D, compressed);
+ *  @endcode
+ *
+ *  @ingroup image_load_gen
+ */
+class CompressedImage
+{
+private:
+	GLsizei _width, _height, _depth;
+	BlockFormat _format;
+	bool _srgb;
+	bool _signed;
+	std::vector<GLubyte> _data;
+
+	void _encode(const Image& image, const BlockCompressionParams& params);
+public:
+	/// Compresses the specified @p image
+	explicit CompressedImage(
+		const Image& image,
+		const BlockCompressionParams& params = BlockCompressionParams()
+	): _width(image.Width())
+	 , _height(image.Height())
+	 , _depth(image.Depth())
+	 , _format(params.Format())
+	 , _srgb(params.IsSRGB(image))
+	 , _signed(params.IsSigned())
+	{
+		_encode(image, params);
+	}
+
+	/// Wraps already compressed blocks
+	/** The format of the blocks is specified by the @p params and
+	 *  the @p data must contain DataSize(format, width, height, depth)
+	 *  bytes. The blocks are stored row by row and layer by layer.
+	 */
+	CompressedImage(
+		GLsizei width,
+		GLsizei height,
+		GLsizei depth,
+		const void* data,
+		const BlockCompressionParams& params
+	);
+
+	CompressedImage(CompressedImage&& tmp)
+	 : _width(tmp._width)
+	 , _height(tmp._height)
+	 , _depth(tmp._depth)
+	 , _format(tmp._format)
+	 , _srgb(tmp._srgb)
+	 , _signed(tmp._signed)
+	 , _data(std::move(tmp._data))
+	{ }
+
+	/// Returns the width of the image in texels
+	GLsizei Width(void) const
+	{
+		return _width;
+	}
+
+	/// Returns the height of the image in texels
+	GLsizei Height(void) const
+	{
+		return _height;
+	}
+
+	/// Returns the depth (number of layers) of the image
+	GLsizei Depth(void) const
+	{
+		return _depth;
+	}
+
+	/// Returns the block compression format
+	BlockFormat Format(void) const
+	{
+		return _format;
+	}
+
+	/// Returns true if the color channels are sRGB-encoded
+	bool IsSRGB(void) const
+	{
+		return _srgb;
+	}
+
+	/// Returns true if the values are signed (BC4 and BC5 only)
+	bool IsSigned(void) const
+	{
+		return _signed;
+	}
+
+	/// Returns the compressed internal format for the texture upload
+	PixelDataInternalFormat InternalFormat(void) const;
+
+	/// Returns a pointer to the compressed blocks
+	const GLubyte* Data(void) const
+	{
+		return _data.data();
+	}
+
+	/// Returns the size of the compressed data in bytes
+	std::size_t DataSize(void) const
+	{
+		return _data.size();
+	}
+
+	/// Returns the size of a single 4x4 block of @p format in bytes
+	static std::size_t BlockSize(BlockFormat format);
+
+	/// Returns the size of the compressed data of an image in bytes
+	static std::size_t DataSize(
+		BlockFormat format,
+		GLsizei width,
+		GLsizei height,
+		GLsizei depth
+	);
+
+	/// Decodes the blocks into an unsigned (or signed) byte image
+	/** The decompressed image has four channels for BC1, BC3 and BC7,
+	 *  one for BC4 and two for BC5. Signed BC4 and BC5 images decode
+	 *  into signed bytes. Only the single-subset modes
+	 *  (4, 5 and 6) of BC7 are decoded, std::runtime_error is thrown
+	 *  for blocks using the partitioned modes (which are not produced
+	 *  by the encoder).
+	 */
+	Image Decompress(void) const;
+};
+
+/// The levels of a mipmap chain compressed into 4x4 texel blocks
+/**
+ *  @ingroup image_load_gen
+ */
+class CompressedMipmapChain
+{
+private:
+	std::vector<CompressedImage> _levels;
+	bool _layered;
+public:
+	/// Compresses all levels of the specified mipmap chain
+	explicit CompressedMipmapChain(
+		const MipmapChain& mipmaps,
+		const BlockCompressionParams& params = BlockCompressionParams()
+	);
+
+	CompressedMipmapChain(CompressedMipmapChain&& tmp)
+	 : _levels(std::move(tmp._levels))
+	 , _layered(tmp._layered)
+	{ }
+
+	/// Returns the number of levels including the base level
+	std::size_t Levels(void) const
+	{
+		return _levels.size();
+	}
+
+	/// Returns the compressed image of the specified mipmap @p level
+	const CompressedImage& Level(std::size_t level) const
+	{
+		assert(level < _levels.size());
+		return _levels[level];
+	}
+
+	/// Returns true if the depth of the images are layers
+	bool IsLayered(void) const
+	{
+		return _layered;
+	}
+};
+
+} // namespace images
+} // namespace oglplus
+
+#if !OGLPLUS_LINK_LIBRARY || defined(OGLPLUS_IMPLEMENTING_LIBRARY)
+#include <oglplus/images/compressed.ipp>
+#endif
+
+#endif // include guard
@@ -0,0 +1,394 @@
+/**
+ *  @file oglplus/images/container.hpp
+ *  @brief KTX and DDS texture container files
+ *
+ *  @author Matus Chochlik
+ *
+ *  Copyright 2010-2015 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#pragma once
+#ifndef OGLPLUS_IMAGES_CONTAINER_1510031130_HPP
+#define OGLPLUS_IMAGES_CONTAINER_1510031130_HPP
+
+#include <oglplus/config/compiler.hpp>
+#include <oglplus/detail/enum_class.hpp>
+#include <oglplus/pixel_data.hpp>
+#include <oglplus/images/image.hpp>
+#include <oglplus/images/mipmap.hpp>
+#include <oglplus/images/compressed.hpp>
+#include <oglplus/utils/mapped_file.hpp>
+
+#include <istream>
+#include <string>
+#include <vector>
+#include <cassert>
+#include <cstddef>
+
+namespace oglplus {
+namespace images {
+
+/// The file formats of image containers
+/**
+ *  @ingroup image_load_gen
+ */
+OGLPLUS_ENUM_CLASS_BEGIN(ImageContainerFormat, GLuint)
+	/// Khronos KTX (version 1.1)
+	OGLPLUS_ENUM_CLASS_VALUE(KTX, 1)
+	OGLPLUS_ENUM_CLASS_COMMA
+	/// DirectDraw Surface (with or without the DX10 header)
+	OGLPLUS_ENUM_CLASS_VALUE(DDS, 2)
+OGLPLUS_ENUM_CLASS_END(ImageContainerFormat)
+
+/// A single mipmap level of a single layer and face in an ImageContainer
+/** The view points directly into the memory of the container file
+ *  and is valid as long as the container exists.
+ *
+ *  @ingroup image_load_gen
+ */
+class ImageContainerView
+{
+private:
+	GLsizei _width, _height, _depth;
+	GLuint _level, _layer, _face;
+	const GLubyte* _data;
+	std::size_t _size;
+public:
+	ImageContainerView(
+		GLsizei width,
+		GLsizei height,
+		GLsizei depth,
+		GLuint level,
+		GLuint layer,
+		GLuint face,
+		const GLubyte* data,
+		std::size_t size
+	): _width(width)
+	 , _height(height)
+	 , _depth(depth)
+	 , _level(level)
+	 , _layer(layer)
+	 , _face(face)
+	 , _data(data)
+	 , _size(size)
+	{ }
+
+	/// Returns the width of the image in texels
+	GLsizei Width(void) const
+	{
+		return _width;
+	}
+
+	/// Returns the height of the image in texels
+	GLsizei Height(void) const
+	{
+		return _height;
+	}
+
+	/// Returns the depth of the (3D) image in texels
+	GLsizei Depth(void) const
+	{
+		return _depth;
+	}
+
+	/// Returns the mipmap level of the view
+	GLuint Level(void) const
+	{
+		return _level;
+	}
+
+	/// Returns the array layer of the view
+	GLuint Layer(void) const
+	{
+		return _layer;
+	}
+
+	/// Returns the cube map face of the view
+	GLuint Face(void) const
+	{
+		return _face;
+	}
+
+	/// Returns a pointer to the (possibly compressed) image data
+	const GLubyte* Data(void) const
+	{
+		return _data;
+	}
+
+	/// Returns the size of the image data in bytes
+	std::size_t DataSize(void) const
+	{
+		return _size;
+	}
+};
+
+/// A KTX or DDS file with all the mipmap levels, array layers and faces
+/** The file is memory-mapped (if possible) and the images are accessed
+ *  through ImageContainerView%s pointing into the mapped memory without
+ *  copying. Block-compressed formats are kept compressed and can be
+ *  passed directly to the compressed texture image functions. The rows
+ *  of uncompressed images are aligned as specified by RowAlignment
+ *  (four bytes in KTX files, one byte in DDS files).
+ *
+ *  The images are used as they are stored in the file, the orientation
+ *  of the rows is not changed (except by ToImage if requested).
+ *
+ *  @code
+ *  images::ImageContainer container("textures/stones.ktx");
+ *  Texture::Image(Texture::Target::_2D, container);
+ *  @endcode
+ *
+ *  @see SaveKTX
+ *  @see SaveDDS
+ *
+ *  @ingroup image_load_gen
+ */
+class ImageContainer
+{
+private:
+	aux::MappedFile _file;
+	ImageContainerFormat _file_format;
+	GLsizei _width, _height, _depth;
+	GLuint _levels, _layers, _faces;
+	GLenum _type, _format, _internal;
+	bool _compressed;
+	GLuint _pixel_size;
+	GLuint _alignment;
+	std::vector<ImageContainerView> _views;
+
+	void _check(std::size_t offset, std::size_t size) const;
+	void _add_view(
+		GLuint level,
+		GLuint layer,
+		GLuint face,
+		std::size_t offset,
+		std::size_t size
+	);
+	void _parse(void);
+	void _parse_ktx(void);
+	void _parse_dds(void);
+
+	ImageContainer(const ImageContainer&);
+public:
+	/// Maps and parses the KTX or DDS file at the specified path
+	/**
+	 *  @throws std::runtime_error if the file cannot be opened,
+	 *  it is not a valid KTX or DDS file or its format is not supported.
+	 */
+	explicit ImageContainer(const std::string& path)
+	 : _file(path)
+	{
+		_parse();
+	}
+
+	/// Reads and parses a KTX or DDS file from the @p input stream
+	explicit ImageContainer(std::istream& input)
+	 : _file(input)
+	{
+		_parse();
+	}
+
+	ImageContainer(ImageContainer&& tmp)
+	 : _file(std::move(tmp._file))
+	 , _file_format(tmp._file_format)
+	 , _width(tmp._width)
+	 , _height(tmp._height)
+	 , _depth(tmp._depth)
+	 , _levels(tmp._levels)
+	 , _layers(tmp._layers)
+	 , _faces(tmp._faces)
+	 , _type(tmp._type)
+	 , _format(tmp._format)
+	 , _internal(tmp._internal)
+	 , _compressed(tmp._compressed)
+	 , _pixel_size(tmp._pixel_size)
+	 , _alignment(tmp._alignment)
+	 , _views(std::move(tmp._views))
+	{ }
+
+	/// Returns the format of the container file
+	ImageContainerFormat FileFormat(void) const
+	{
+		return _file_format;
+	}
+
+	/// Returns true if the file is memory-mapped
+	bool IsMapped(void) const
+	{
+		return _file.IsMapped();
+	}
+
+	/// Returns the width of the base level in texels
+	GLsizei Width(void) const
+	{
+		return _width;
+	}
+
+	/// Returns the height of the base level in texels
+	GLsizei Height(void) const
+	{
+		return _height;
+	}
+
+	/// Returns the depth of the base level (1 if not a 3D image)
+	GLsizei Depth(void) const
+	{
+		return _depth;
+	}
+
+	/// Returns the number of mipmap levels
+	GLuint Levels(void) const
+	{
+		return _levels;
+	}
+
+	/// Returns the number of array layers (1 if not an array)
+	GLuint Layers(void) const
+	{
+		return _layers;
+	}
+
+	/// Returns the number of faces (6 for cube maps, 1 otherwise)
+	GLuint Faces(void) const
+	{
+		return _faces;
+	}
+
+	/// Returns true if the images are block-compressed
+	bool IsCompressed(void) const
+	{
+		return _compressed;
+	}
+
+	/// Returns the pixel data type (of uncompressed images)
+	PixelDataType Type(void) const
+	{
+		return PixelDataType(_type);
+	}
+
+	/// Returns the pixel data format (of uncompressed images)
+	PixelDataFormat Format(void) const
+	{
+		return PixelDataFormat(_format);
+	}
+
+	/// Returns the (possibly compressed) internal format
+	PixelDataInternalFormat InternalFormat(void) const
+	{
+		return PixelDataInternalFormat(_internal);
+	}
+
+	/// Returns the alignment of the rows of uncompressed images
+	GLuint RowAlignment(void) const
+	{
+		return _alignment;
+	}
+
+	/// Returns the view of the specified level, layer and face
+	const ImageContainerView& View(
+		GLuint level,
+		GLuint layer = 0,
+		GLuint face = 0
+	) const
+	{
+		assert(level < _levels);
+		assert(layer < _layers);
+		assert(face < _faces);
+		return _views[(level*_layers+layer)*_faces+face];
+	}
+
+	/// Returns the size of all layers and faces of a @p level in bytes
+	std::size_t LevelDataSize(GLuint level) const;
+
+	/// Returns all layers and faces of a @p level as contiguous data
+	/** If the layers and faces of the level are stored contiguously
+	 *  in the file (as in KTX array textures) then a pointer into
+	 *  the mapped file is returned. Otherwise the data is copied
+	 *  into the @p buffer.
+	 */
+	const GLubyte* LevelData(
+		GLuint level,
+		std::vector<GLubyte>& buffer
+	) const;
+
+	/// Returns the specified @p level as an (uncompressed) Image
+	/** The layers and faces are stored as the depth of the image
+	 *  (face-major within each layer). Compressed images in the BCn
+	 *  formats are decompressed, other compressed formats are not
+	 *  supported.
+	 *
+	 *  The rows in the container are taken to be in the GL order,
+	 *  (as uploaded by Texture::Image and written by SaveKTX and SaveDDS)
+	 *  i.e. with the y axis pointing up and the x axis pointing right.
+	 *  If @p y_is_up is false, then the order of the rows is reversed,
+	 *  if @p x_is_right is false, the order of the pixels in the rows
+	 *  is reversed.
+	 */
+	Image ToImage(
+		GLuint level = 0,
+		bool y_is_up = true,
+		bool x_is_right = true
+	) const;
+};
+
+/// Saves the levels of the @p mipmaps into a KTX file
+/** If @p cube_map is true, then the depth of the images must be
+ *  a multiple of six and the layers are stored as the faces of
+ *  (an array of) cube maps.
+ *
+ *  @throws std::runtime_error if the file cannot be written.
+ *
+ *  @ingroup image_load_gen
+ */
+void SaveKTX(
+	const std::string& path,
+	const MipmapChain& mipmaps,
+	bool cube_map = false
+);
+
+/// Saves the levels of the compressed @p mipmaps into a KTX file
+/**
+ *  @ingroup image_load_gen
+ */
+void SaveKTX(
+	const std::string& path,
+	const CompressedMipmapChain& mipmaps,
+	bool cube_map = false
+);
+
+/// Saves the levels of the @p mipmaps into a DDS file
+/** The file always has the DX10 header extension. Only the formats
+ *  having a DXGI equivalent can be saved (for example 8-bit RGB
+ *  images without alpha cannot).
+ *
+ *  @throws std::runtime_error if the format of the images is not
+ *  supported or the file cannot be written.
+ *
+ *  @ingroup image_load_gen
+ */
+void SaveDDS(
+	const std::string& path,
+	const MipmapChain& mipmaps,
+	bool cube_map = false
+);
+
+/// Saves the levels of the compressed @p mipmaps into a DDS file
+/**
+ *  @ingroup image_load_gen
+ */
+void SaveDDS(
+	const std::string& path,
+	const CompressedMipmapChain& mipmaps,
+	bool cube_map = false
+);
+
+} // namespace images
+} // namespace oglplus
+
+#if !OGLPLUS_LINK_LIBRARY || defined(OGLPLUS_IMPLEMENTING_LIBRARY)
+#include <oglplus/images/container.ipp>
+#endif
+
+#endif // include guard
@@ -18,6 +18,10 @@ namespace images {
 
 class Image;
 struct ImageSpec;
+class MipmapChain;
+class CompressedImage;
+class CompressedMipmapChain;
+class ImageContainer;
 
 } // namespace images
 } // namespace oglplus
@@ -303,6 +303,10 @@ public:
 		return _internal;
 	}
 
+	/// Returns true if the internal format is an sRGB format
+	bool IsSRGB(void) const
+	OGLPLUS_NOEXCEPT(true);
+
 	/// Returns a pointer to the data
 	template <typename T>
 	const T* Data(void) const
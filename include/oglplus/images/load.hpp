@@ -4,7 +4,7 @@
  *
  *  @author Matus Chochlik
  *
- *  Copyright 2010-2013 Matus Chochlik. Distributed under the Boost
+ *  Copyright 2010-2015 Matus Chochlik. Distributed under the Boost
  *  Software License, Version 1.0. (See accompanying file
  *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
  */
@@ -14,6 +14,7 @@
 #define OGLPLUS_IMAGES_LOAD_1107121519_HPP
 
 #include <oglplus/images/image.hpp>
+#include <oglplus/images/container.hpp>
 
 #include <string>
 
@@ -40,6 +41,24 @@ inline Image LoadTexture(
 	return LoadByName("textures", name, y_is_up, x_is_right);
 }
 
+/// Finds and maps a KTX or DDS image container file by its name
+/**
+ *  @ingroup image_load_gen
+ */
+ImageContainer LoadContainerByName(
+	std::string category,
+	std::string name
+);
+
+/// Helper function for loading texture containers in the examples
+/**
+ *  @ingroup image_load_gen
+ */
+inline ImageContainer LoadTextureContainer(std::string name)
+{
+	return LoadContainerByName("textures", name);
+}
+
 } // images
 } // oglplus
 
@@ -0,0 +1,213 @@
+/**
+ *  @file oglplus/images/mipmap.hpp
+ *  @brief Generation of mipmap level images on the CPU
+ *
+ *  @author Matus Chochlik
+ *
+ *  Copyright 2010-2015 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#pragma once
+#ifndef OGLPLUS_IMAGES_MIPMAP_1509271200_HPP
+#define OGLPLUS_IMAGES_MIPMAP_1509271200_HPP
+
+#include <oglplus/config/compiler.hpp>
+#include <oglplus/detail/enum_class.hpp>
+#include <oglplus/images/image.hpp>
+
+#include <vector>
+#include <cstddef>
+
+namespace oglplus {
+namespace images {
+
+/// The filters used for the downsampling of mipmap levels
+/**
+ *  @ingroup image_load_gen
+ */
+OGLPLUS_ENUM_CLASS_BEGIN(MipmapFilter, GLuint)
+	/// Averages the source texels covered by the target texel
+	OGLPLUS_ENUM_CLASS_VALUE(Box, 0)
+	OGLPLUS_ENUM_CLASS_COMMA
+	/// Kaiser-windowed sinc filter (width 3, alpha 4)
+	OGLPLUS_ENUM_CLASS_VALUE(Kaiser, 1)
+	OGLPLUS_ENUM_CLASS_COMMA
+	/// Lanczos filter with three lobes
+	OGLPLUS_ENUM_CLASS_VALUE(Lanczos, 2)
+OGLPLUS_ENUM_CLASS_END(MipmapFilter)
+
+/// Parameters of the MipmapChain generation
+/**
+ *  @ingroup image_load_gen
+ */
+class MipmapParams
+{
+private:
+	MipmapFilter _filter;
+	int _srgb;
+	bool _layered;
+	unsigned _max_levels;
+	unsigned _threads;
+public:
+	MipmapParams(void)
+	 : _filter(MipmapFilter::Box)
+	 , _srgb(-1)
+	 , _layered(false)
+	 , _max_levels(0)
+	 , _threads(0)
+	{ }
+
+	/// Sets the downsampling filter (Box by default)
+	MipmapParams& Filter(MipmapFilter filter)
+	{
+		_filter = filter;
+		return *this;
+	}
+
+	/// Returns the downsampling filter
+	MipmapFilter Filter(void) const
+	{
+		return _filter;
+	}
+
+	/// Specifies if the RGB channels are sRGB-encoded
+	/** If not specified, then the color space is determined from
+	 *  the internal format of the base image. The sRGB-encoded values
+	 *  are converted to linear space before filtering and back after it.
+	 *  The alpha channel is always filtered as linear.
+	 */
+	MipmapParams& SRGB(bool srgb = true)
+	{
+		_srgb = srgb?1:0;
+		return *this;
+	}
+
+	/// Returns true if the color channels of the @p image are sRGB-encoded
+	bool IsSRGB(const Image& image) const;
+
+	/// Specifies that the depth of the image are layers (or cube faces)
+	/** The layers of 2D array and cube-map (array) images are downsampled
+	 *  separately and the depth of the levels is not reduced.
+	 */
+	MipmapParams& Layered(bool layered = true)
+	{
+		_layered = layered;
+		return *this;
+	}
+
+	/// Returns true if the depth of the image are layers
+	bool IsLayered(void) const
+	{
+		return _layered;
+	}
+
+	/// Limits the number of levels (including the base level)
+	/** Zero means a complete chain down to the 1x1(x1) level.
+	 */
+	MipmapParams& MaxLevels(unsigned max_levels)
+	{
+		_max_levels = max_levels;
+		return *this;
+	}
+
+	/// Returns the maximum number of levels (zero for unlimited)
+	unsigned MaxLevels(void) const
+	{
+		return _max_levels;
+	}
+
+	/// Sets the number of threads used for the filtering
+	/** Zero means the number of hardware threads. Small levels
+	 *  are always filtered by the calling thread.
+	 */
+	MipmapParams& Threads(unsigned threads)
+	{
+		_threads = threads;
+		return *this;
+	}
+
+	/// Returns the number of threads used for the filtering
+	unsigned Threads(void) const;
+};
+
+/// A chain of mipmap level images built from a base image
+/** The MipmapChain halves the dimensions of the base image (except for
+ *  the depth of layered images) with the specified filter until all
+ *  of them are one. Each level is filtered from the full-precision
+ *  linear-space result of the previous level and then converted to the
+ *  data type of the base image; unsigned byte, unsigned short and float
+ *  images keep their type, images with other data types produce float
+ *  levels. The format and the internal format are kept.
+ *
+ *  The whole chain can be uploaded into a texture in one call
+ *  of Texture::Image.
+ *
+ *  @code
+ *  images::MipmapChain mipmaps(
+ *    images::LoadTexture("stones"),
+ *    images::MipmapParams().Filter(images::MipmapFilter::Kaiser)
+ *  );
+ *  Texture::Image(Texture::Target::_2D, mipmaps);
+ *  @endcode
+ *
+ *  @ingroup image_load_gen
+ */
+class MipmapChain
+{
+private:
+	std::vector<Image> _levels;
+	bool _layered;
+
+	void _build(const Image& base, const MipmapParams& params);
+public:
+	/// Builds the mipmap chain of the specified @p base image
+	explicit MipmapChain(
+		const Image& base,
+		const MipmapParams& params = MipmapParams()
+	): _layered(params.IsLayered())
+	{
+		_build(base, params);
+	}
+
+	MipmapChain(MipmapChain&& tmp)
+	 : _levels(std::move(tmp._levels))
+	 , _layered(tmp._layered)
+	{ }
+
+	/// Returns the number of levels including the base level
+	std::size_t Levels(void) const
+	{
+		return _levels.size();
+	}
+
+	/// Returns the image of the specified mipmap @p level
+	const Image& Level(std::size_t level) const
+	{
+		assert(level < _levels.size());
+		return _levels[level];
+	}
+
+	/// Returns true if the depth of the images are layers
+	bool IsLayered(void) const
+	{
+		return _layered;
+	}
+
+	/// Returns the number of levels of a complete chain for a base image
+	static std::size_t LevelCount(
+		GLsizei width,
+		GLsizei height,
+		GLsizei depth
+	);
+};
+
+} // namespace images
+} // namespace oglplus
+
+#if !OGLPLUS_LINK_LIBRARY || defined(OGLPLUS_IMPLEMENTING_LIBRARY)
+#include <oglplus/images/mipmap.ipp>
+#endif
+
+#endif // include guard
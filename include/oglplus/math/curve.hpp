@@ -4,7 +4,7 @@
  *
  *  @author Matus Chochlik
  *
- *  Copyright 2010-2014 Matus Chochlik. Distributed under the Boost
+ *  Copyright 2010-2015 Matus Chochlik. Distributed under the Boost
  *  Software License, Version 1.0. (See accompanying file
  *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
  */
@@ -18,10 +18,31 @@
 
 #include <vector>
 #include <array>
+#include <algorithm>
+#include <type_traits>
 #include <cmath>
 #include <cassert>
 
 namespace oglplus {
+namespace aux {
+
+template <typename T, std::size_t N>
+inline T CurvePointDistance(const Vector<T, N>& a, const Vector<T, N>& b)
+{
+	return Distance(a, b);
+}
+
+template <typename T>
+inline typename std::enable_if<std::is_arithmetic<T>::value, T>::type
+CurvePointDistance(T a, T b)
+{
+	return std::fabs(a-b);
+}
+
+} // namespace aux
+
+template <typename Type, typename Parameter, unsigned Order>
+class BezierArcLengthTable;
 
 /// A sequence of Bezier curves, possibly connected at end points
 /** This class stores the data for a sequence of connected Bezier curves
@@ -42,6 +63,195 @@ class BezierCurves
 private:
 	::std::vector<Type> _points;
 	bool _connected;
+
+	// the coefficients of the polynomials of the individual segments
+	// in the power basis, (Order+1) values per segment
+	::std::vector<Type> _coefs;
+
+	typedef ::std::array<Type, Order+1> _segment_points;
+
+	void _init_coefs(void)
+	{
+		const unsigned sstep = SegmentStep();
+		const unsigned s = SegmentCount();
+		_coefs.resize(s*(Order+1));
+
+		for(unsigned i=0; i!=s; ++i)
+		{
+			// the j-th coefficient is Binomial(Order, j) times
+			// the j-th forward difference of the control points
+			_segment_points d;
+			for(unsigned k=0; k<=Order; ++k)
+			{
+				d[k] = _points[i*sstep+k];
+			}
+			Parameter binomial(1);
+			for(unsigned j=0; j<=Order; ++j)
+			{
+				_coefs[i*(Order+1)+j] = Type(d[0]*binomial);
+				for(unsigned k=0; k+j<Order; ++k)
+				{
+					d[k] = Type(d[k+1]-d[k]);
+				}
+				binomial = binomial*Parameter(Order-j)/Parameter(j+1);
+			}
+		}
+	}
+
+	// evaluates the polynomial with the coefficients c at t
+	static Type _horner(
+		const Type* c,
+		Parameter,
+		std::integral_constant<unsigned, Order>
+	)
+	{
+		return c[Order];
+	}
+
+	template <unsigned K>
+	static Type _horner(
+		const Type* c,
+		Parameter t,
+		std::integral_constant<unsigned, K>
+	)
+	{
+		std::integral_constant<unsigned, K+1> k1;
+		return Type(_horner(c, t, k1)*t+c[K]);
+	}
+
+	static Type _horner(const Type* c, Parameter t)
+	{
+		return _horner(c, t, std::integral_constant<unsigned, 0>());
+	}
+
+	// adds the (K+1)-th forward difference to the K-th one, unrolled
+	// at compile-time so that the differences can be kept in registers
+	static void _advance(
+		_segment_points&,
+		std::integral_constant<unsigned, Order>
+	)
+	{ }
+
+	template <unsigned K>
+	static void _advance(
+		_segment_points& d,
+		std::integral_constant<unsigned, K>
+	)
+	{
+		d[K] = Type(d[K]+d[K+1]);
+		_advance(d, std::integral_constant<unsigned, K+1>());
+	}
+
+	// writes n points uniformly sampling the i-th segment in [0, 1)
+	template <typename Iter>
+	Iter _forward_differences(unsigned i, unsigned n, Iter p) const
+	{
+		const Type* c = _coefs.data()+i*(Order+1);
+		const Parameter t_step = Parameter(1)/n;
+
+		// m! * S(k, m) where S are the Stirling numbers of the second kind
+		// (the m-th forward difference of x^k at zero with unit step)
+		Parameter st[Order+1][Order+1] = {};
+		st[0][0] = Parameter(1);
+		for(unsigned k=1; k<=Order; ++k)
+		{
+			for(unsigned m=1; m<=k; ++m)
+			{
+				st[k][m] = Parameter(m)*(st[k-1][m]+st[k-1][m-1]);
+			}
+		}
+
+		_segment_points a, d;
+		// the differences are recalculated every few points
+		// to limit the accumulation of rounding errors
+		for(unsigned j=0; j<n; j+=64)
+		{
+			// shift the polynomial to the current point and scale
+			// it by the step, the differences are calculated from
+			// its coefficients, subtracting the nearly equal values
+			// of the polynomial would lose the precision of higher
+			// differences
+			const Parameter t0 = Parameter(j)*t_step;
+			for(unsigned k=0; k<=Order; ++k)
+			{
+				a[k] = c[k];
+			}
+			for(unsigned l=0; l!=Order; ++l)
+			{
+				for(unsigned k=Order; k>l; --k)
+				{
+					a[k-1] = Type(a[k-1]+a[k]*t0);
+				}
+			}
+			Parameter h(1);
+			for(unsigned k=0; k<=Order; ++k)
+			{
+				a[k] = Type(a[k]*h);
+				h = h*t_step;
+			}
+			for(unsigned m=0; m<=Order; ++m)
+			{
+				d[m] = Type(a[m]*st[m][m]);
+				for(unsigned k=m+1; k<=Order; ++k)
+				{
+					d[m] = Type(d[m]+a[k]*st[k][m]);
+				}
+			}
+
+			for(unsigned b=j, e=std::min(j+64, n); b!=e; ++b)
+			{
+				*p = d[0];
+				++p;
+				_advance(d, std::integral_constant<unsigned, 0>());
+			}
+		}
+		return p;
+	}
+
+	static bool _flat(const _segment_points& cp, Parameter tolerance)
+	{
+		// the distance of the curve from its chord is not greater
+		// than the distance of the control points from the points
+		// uniformly distributed on the chord
+		for(unsigned k=1; k<Order; ++k)
+		{
+			const Parameter f = Parameter(k)/Parameter(Order);
+			const Type c = Type(cp[0]+(cp[Order]-cp[0])*f);
+			if(Parameter(aux::CurvePointDistance(cp[k], c)) > tolerance)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	static void _tessellate(
+		const _segment_points& cp,
+		Parameter tolerance,
+		unsigned max_depth,
+		::std::vector<Type>& dest
+	)
+	{
+		if((max_depth == 0) || _flat(cp, tolerance))
+		{
+			dest.push_back(cp[Order]);
+			return;
+		}
+
+		// split the curve in half with de Casteljau's algorithm
+		_segment_points d = cp, l, r;
+		for(unsigned j=0; j<=Order; ++j)
+		{
+			l[j] = d[0];
+			r[Order-j] = d[Order-j];
+			for(unsigned k=0; k+j<Order; ++k)
+			{
+				d[k] = Type((d[k]+d[k+1])*Parameter(0.5));
+			}
+		}
+		_tessellate(l, tolerance, max_depth-1, dest);
+		_tessellate(r, tolerance, max_depth-1, dest);
+	}
 public:
 	static bool Connected(const ::std::vector<Type>& points)
 	{
@@ -83,6 +293,7 @@ public:
 	 , _connected(Connected(_points))
 	{
 		assert(PointsOk(_points));
+		_init_coefs();
 	}
 
 	/// Creates the bezier curves from the control @c points
@@ -96,6 +307,7 @@ public:
 	{
 		assert(PointsOk(_points));
 		assert(Connected(_points) == _connected);
+		_init_coefs();
 	}
 
 	/// Creates the bezier curves from the control @c points
@@ -109,6 +321,7 @@ public:
 	 , _connected(Connected(_points))
 	{
 		assert(PointsOk(_points));
+		_init_coefs();
 	}
 
 	/// Creates the bezier curves from the control @c points
@@ -122,6 +335,7 @@ public:
 	{
 		assert(PointsOk(_points));
 		assert(Connected(_points) == _connected);
+		_init_coefs();
 	}
 
 	template <std::size_t N>
@@ -130,6 +344,7 @@ public:
 	 , _connected(Connected(_points))
 	{
 		assert(PointsOk(_points));
+		_init_coefs();
 	}
 
 	template <std::size_t N>
@@ -139,6 +354,7 @@ public:
 	{
 		assert(PointsOk(_points));
 		assert(Connected(_points) == _connected);
+		_init_coefs();
 	}
 
 	unsigned SegmentStep(void) const
@@ -186,15 +402,17 @@ public:
 
 		Parameter toffs = t*SegmentCount();
 
-		unsigned poffs = unsigned(toffs) * SegmentStep();
-
-		assert(poffs < _points.size() - Order);
+		unsigned seg = unsigned(toffs);
 		Parameter t_sub = toffs - ::std::floor(toffs);
-		return math::Bezier<Type, Parameter, Order>::Position(
-			_points.data() + poffs,
-			_points.size() - poffs,
-			t_sub
-		);
+
+		// t slightly less than one may be rounded up
+		if(seg == SegmentCount())
+		{
+			--seg;
+			t_sub = one;
+		}
+		assert(seg < SegmentCount());
+		return _horner(_coefs.data() + seg*(Order+1), t_sub);
 	}
 
 	/// Gets the point on the curve at position t wrapped to [0.0, 1.0]
@@ -204,31 +422,20 @@ public:
 	}
 
 	/// Makes a sequence of points on the curve (n points per segment)
+	/** The points are calculated by forward differencing which needs
+	 *  only Order additions per point.
+	 */
 	void Approximate(std::vector<Type>& dest, unsigned n) const
 	{
-		unsigned sstep = SegmentStep();
 		unsigned s = SegmentCount();
 
 		dest.resize(s*n+1);
 
 		auto p = dest.begin();
-		const Parameter t_step = Parameter(1)/n;
 
 		for(unsigned i=0; i!=s; ++i)
 		{
-			unsigned poffs = i*sstep;
-			Parameter t_sub = Parameter(0);
-			const Type* data = _points.data() + poffs;
-			unsigned size = _points.size() - poffs;
-			for(unsigned j=0; j!=n; ++j)
-			{
-				typedef math::Bezier<Type, Parameter, Order> b;
-				assert(p != dest.end());
-				*p = Type(b::Position(data, size, t_sub));
-				++p;
-
-				t_sub += t_step;
-			}
+			p = _forward_differences(i, n, p);
 		}
 		assert(p != dest.end());
 		*p = _points.back();
@@ -244,6 +451,67 @@ public:
 		return result;
 	}
 
+	/// Makes a sequence of points approximating the curve adaptively
+	/** The segments are recursively subdivided until no point on the curve
+	 *  is farther than @p tolerance from the polyline connecting the points
+	 *  (or until @p max_depth subdivisions), so flat parts of the curve
+	 *  get fewer points than the sharply bent ones.
+	 */
+	void Tessellate(
+		std::vector<Type>& dest,
+		Parameter tolerance,
+		unsigned max_depth = 16
+	) const
+	{
+		unsigned sstep = SegmentStep();
+		unsigned s = SegmentCount();
+
+		dest.clear();
+		for(unsigned i=0; i!=s; ++i)
+		{
+			_segment_points cp;
+			for(unsigned k=0; k<=Order; ++k)
+			{
+				cp[k] = _points[i*sstep+k];
+			}
+			if((i == 0) || !_connected)
+			{
+				dest.push_back(cp[0]);
+			}
+			_tessellate(cp, tolerance, max_depth, dest);
+		}
+	}
+
+	/// Returns a sequence of points approximating the curve adaptively
+	::std::vector<Type> Tessellate(
+		Parameter tolerance,
+		unsigned max_depth = 16
+	) const
+	{
+		::std::vector<Type> result;
+		Tessellate(result, tolerance, max_depth);
+		return result;
+	}
+
+	/// Makes a sequence of n+1 points uniformly spaced along the curve
+	/** The @p table must be made for this curve.
+	 */
+	void ApproximateConstantSpeed(
+		std::vector<Type>& dest,
+		unsigned n,
+		const BezierArcLengthTable<Type, Parameter, Order>& table
+	) const
+	{
+		dest.resize(n+1);
+		for(unsigned i=0; i!=n; ++i)
+		{
+			Parameter f = Parameter(i)/Parameter(n);
+			Parameter t = table.ParameterAtFraction(f);
+			dest[i] = (t < Parameter(1))?Position01(t):_points.back();
+		}
+		dest[n] = _points.back();
+	}
+
 	/// Returns a derivative of this curve
 	BezierCurves<Type, Parameter, Order-1> Derivative(void) const
 	{
@@ -272,6 +540,87 @@ public:
 	}
 };
 
+/// Table mapping the arc length of BezierCurves to their parameter
+/** The curve parameter does not change uniformly with the distance
+ *  travelled along the curve. This table stores the lengths of the curve
+ *  at uniformly distributed parameter values and allows to find the value
+ *  of the parameter for a specified length of the curve, which can be
+ *  used to move along the curve at a constant speed.
+ *
+ *  @see BezierCurves
+ *
+ *  @ingroup math_utils
+ */
+template <typename Type, typename Parameter, unsigned Order>
+class BezierArcLengthTable
+{
+private:
+	::std::vector<Parameter> _lengths;
+public:
+	/// Makes the table for the specified @p curves
+	/** The lengths are approximated by the lengths of polylines
+	 *  with @p samples_per_segment points per curve segment.
+	 */
+	BezierArcLengthTable(
+		const BezierCurves<Type, Parameter, Order>& curves,
+		unsigned samples_per_segment = 32
+	)
+	{
+		assert(samples_per_segment > 0);
+
+		::std::vector<Type> points;
+		curves.Approximate(points, samples_per_segment);
+
+		_lengths.resize(points.size());
+		_lengths[0] = Parameter(0);
+		for(std::size_t i=1; i!=points.size(); ++i)
+		{
+			_lengths[i] = _lengths[i-1] + Parameter(
+				aux::CurvePointDistance(points[i-1], points[i])
+			);
+		}
+	}
+
+	/// Returns the length of the whole curve
+	Parameter Length(void) const
+	{
+		return _lengths.back();
+	}
+
+	/// Returns the parameter value at the specified @p distance on the curve
+	/** The distance is measured from the start of the curve and clamped
+	 *  to [0, Length()], the returned value is in the range [0, 1].
+	 */
+	Parameter ParameterAt(Parameter distance) const
+	{
+		const Parameter zero(0);
+		const Parameter one(1);
+
+		if(!(distance > zero)) return zero;
+		if(distance >= Length()) return one;
+
+		auto i = ::std::upper_bound(
+			_lengths.begin(),
+			_lengths.end(),
+			distance
+		);
+		assert(i != _lengths.begin());
+		assert(i != _lengths.end());
+		const std::size_t k = std::size_t(i - _lengths.begin());
+
+		const Parameter l0 = _lengths[k-1];
+		const Parameter l1 = _lengths[k];
+		const Parameter f = (l1 > l0)?(distance-l0)/(l1-l0):zero;
+		return (Parameter(k-1)+f)/Parameter(_lengths.size()-1);
+	}
+
+	/// Returns the parameter value at the specified fraction of the length
+	Parameter ParameterAtFraction(Parameter fraction) const
+	{
+		return ParameterAt(fraction*Length());
+	}
+};
+
 /// A closed smooth cubic Bezier spline passing through all input points
 /** This class constructs a closed sequence of Bezier curves that are smooth
  *  at the curve connection points. The control points between the begin
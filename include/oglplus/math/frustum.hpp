@@ -0,0 +1,140 @@
+/**
+ *  @file oglplus/math/frustum.hpp
+ *  @brief View frustum utility class
+ *
+ *  @author Matus Chochlik
+ *
+ *  Copyright 2010-2015 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#pragma once
+#ifndef OGLPLUS_MATH_FRUSTUM_1510181400_HPP
+#define OGLPLUS_MATH_FRUSTUM_1510181400_HPP
+
+#include <oglplus/math/vector.hpp>
+#include <oglplus/math/matrix.hpp>
+#include <oglplus/math/sphere.hpp>
+#include <oglplus/math/plane.hpp>
+
+#include <cassert>
+#include <cmath>
+
+namespace oglplus {
+
+/// Class implementing view frustum-related functionality
+/** @c Frustum stores the six planes bounding the volume which is mapped
+ *  by a projection (or projection times camera) matrix into the clip-space
+ *  cube. The normals of the planes are normalized and point inside
+ *  of the frustum.
+ *
+ *  @ingroup math_utils
+ */
+template <typename T>
+class Frustum
+{
+private:
+	Vector<T, 4> _planes[6];
+
+	static Vector<T, 4> _normalized(const Vector<T, 4>& p)
+	{
+		T l = std::sqrt(p[0]*p[0]+p[1]*p[1]+p[2]*p[2]);
+		assert(l > T(0));
+		return p / l;
+	}
+public:
+	/// The indices of the planes of the frustum
+	enum PlaneIndex
+	{
+		Left = 0,
+		Right,
+		Bottom,
+		Top,
+		Near,
+		Far
+	};
+
+	/// Extracts the frustum planes from the specified @p matrix
+	/** The matrix is usually the product of a projection matrix
+	 *  and a camera matrix. Then the planes are in world space.
+	 */
+	Frustum(const Matrix<T, 4, 4>& matrix)
+	{
+		const Vector<T, 4> r0 = matrix.Row(0);
+		const Vector<T, 4> r1 = matrix.Row(1);
+		const Vector<T, 4> r2 = matrix.Row(2);
+		const Vector<T, 4> r3 = matrix.Row(3);
+
+		_planes[Left]   = _normalized(r3 + r0);
+		_planes[Right]  = _normalized(r3 - r0);
+		_planes[Bottom] = _normalized(r3 + r1);
+		_planes[Top]    = _normalized(r3 - r1);
+		_planes[Near]   = _normalized(r3 + r2);
+		_planes[Far]    = _normalized(r3 - r2);
+	}
+
+	/// Returns the equation of the plane with the specified @p index
+	/**
+	 *  @pre index < 6
+	 */
+	const Vector<T, 4>& Equation(std::size_t index) const
+	{
+		assert(index < 6);
+		return _planes[index];
+	}
+
+	/// Returns the plane with the specified @p index
+	/**
+	 *  @pre index < 6
+	 */
+	Plane<T> GetPlane(std::size_t index) const
+	{
+		return Plane<T>(Equation(index));
+	}
+
+	/// Returns the signed distance of @p point from the specified plane
+	T Distance(std::size_t index, const Vector<T, 3>& point) const
+	{
+		const Vector<T, 4>& p = Equation(index);
+		return p[0]*point[0]+p[1]*point[1]+p[2]*point[2]+p[3];
+	}
+
+	/// Returns true if the @p point is inside of the frustum
+	bool Contains(const Vector<T, 3>& point) const
+	{
+		for(std::size_t i=0; i!=6; ++i)
+		{
+			if(Distance(i, point) < T(0))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	/// Returns true if the @p sphere is at least partially inside
+	/** This test is conservative, i.e. it can return true for some
+	 *  spheres near the edges of the frustum which are outside.
+	 */
+	bool Intersects(const Sphere<T>& sphere) const
+	{
+		for(std::size_t i=0; i!=6; ++i)
+		{
+			if(Distance(i, sphere.Center()) < -sphere.Radius())
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+};
+
+#if OGLPLUS_DOCUMENTATION_ONLY || defined(GL_FLOAT)
+/// Instantiation of Frustum using GL floating-point as underlying type
+typedef Frustum<GLfloat> Frustumf;
+#endif
+
+} // namespace oglplus
+
+#endif // include guard
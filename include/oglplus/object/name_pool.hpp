@@ -0,0 +1,313 @@
+/**
+ *  @file oglplus/object/name_pool.hpp
+ *  @brief Pools of object names generated and deleted in batches
+ *
+ *  @author Matus Chochlik
+ *
+ *  Copyright 2010-2015 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#pragma once
+#ifndef OGLPLUS_OBJECT_NAME_POOL_1510181200_HPP
+#define OGLPLUS_OBJECT_NAME_POOL_1510181200_HPP
+
+#include <oglplus/config/compiler.hpp>
+#include <oglplus/object/tags.hpp>
+#include <unordered_set>
+#include <vector>
+#include <cassert>
+#include <cstddef>
+
+namespace oglplus {
+
+template <typename ObjTag>
+class ObjGenDelOps;
+
+/// Statistics of an ObjectNamePool
+struct ObjectNamePoolStats
+{
+	/// The number of calls to glGen*
+	std::size_t gen_calls;
+
+	/// The number of names generated by glGen*
+	std::size_t generated;
+
+	/// The number of names handed out again after being returned
+	std::size_t recycled;
+
+	/// The number of calls to glDelete*
+	std::size_t delete_calls;
+
+	/// The number of names deleted by glDelete*
+	std::size_t deleted;
+};
+
+/// A pool of names of objects of the type specified by @p ObjTag
+/** While a pool is installed (see ObjectNamePoolScope) the Objects
+ *  of the type specified by @p ObjTag, constructed with @c tag::Generate
+ *  (the default for objects without direct state access), take their
+ *  names from the pool instead of calling glGen* for each instance
+ *  and return their names to the pool instead of calling glDelete*.
+ *  The code creating the objects does not have to be changed.
+ *
+ *  The pool generates the names in batches and deletes the returned
+ *  names in batches. If recycling is enabled then the returned names
+ *  are handed out again without being deleted. The recycled objects
+ *  keep their previous state, so recycling should be enabled only for
+ *  objects that are always respecified before use, for example query
+ *  objects (which are reset by glBeginQuery) or buffers which are
+ *  always (re)initialized with glBufferData. Textures with immutable
+ *  storage must not be recycled.
+ *
+ *  Since the returned names are not deleted, the GL does not unbind
+ *  them either. A recycled name may still be bound to a target,
+ *  attached to a framebuffer or used as the source of a vertex array
+ *  attribute, so the objects must be unbound and detached before they
+ *  are destroyed, or the pool must not recycle them.
+ *
+ *  The pool does not track the use of the objects by the GL; a query
+ *  is recycled as soon as its Query object is destroyed, even if its
+ *  result is still pending (the next glBeginQuery then waits for it),
+ *  so the results should be read before. Sync objects do not have
+ *  names generated by glGen* and cannot be pooled.
+ *
+ *  Only the names taken from the pool are returned to it, the names
+ *  of objects created before the pool was installed, or created with
+ *  @c tag::Create, are deleted by glDelete* as usual. The same applies
+ *  to the names of objects outliving the pool.
+ *
+ *  The pool is installed only for the calling thread (unless the
+ *  compiler lacks thread-local storage, see OGLPLUS_NO_THREAD_LOCAL).
+ *  It must be used only on the thread with the current GL context
+ *  which generated the names, and it must be destroyed while the context
+ *  is still current; the names remaining in the pool are deleted then.
+ *
+ *  @ingroup oglplus_objects
+ */
+template <typename ObjTag>
+class ObjectNamePool
+ : protected ObjGenDelOps<ObjTag>
+{
+private:
+	typedef typename ObjTag::NameType NameT;
+
+	GLsizei _batch_size;
+	bool _recycle;
+
+	std::vector<NameT> _fresh;
+	std::vector<NameT> _returned;
+	std::vector<NameT> _unused;
+	std::unordered_set<NameT> _taken;
+
+	ObjectNamePoolStats _stats;
+
+	ObjectNamePool(const ObjectNamePool&);
+
+	static ObjectNamePool*& _current(void)
+	{
+#if !OGLPLUS_NO_THREAD_LOCAL
+		static thread_local ObjectNamePool* current = nullptr;
+#else
+		static ObjectNamePool* current = nullptr;
+#endif
+		return current;
+	}
+
+	void _gen_batch(void)
+	{
+		assert(_fresh.empty());
+		_fresh.resize(std::size_t(_batch_size));
+		try
+		{
+			ObjGenDelOps<ObjTag>::Gen(
+				tag::Generate(),
+				_batch_size,
+				_fresh.data()
+			);
+		}
+		catch(...)
+		{
+			_fresh.clear();
+			throw;
+		}
+		++_stats.gen_calls;
+		_stats.generated += _fresh.size();
+	}
+
+	void _delete(std::vector<NameT>& names)
+	{
+		if(!names.empty())
+		{
+			ObjGenDelOps<ObjTag>::Delete(
+				GLsizei(names.size()),
+				names.data()
+			);
+			++_stats.delete_calls;
+			_stats.deleted += names.size();
+			names.clear();
+		}
+	}
+public:
+	/// The default number of names generated by a single glGen* call
+	static const GLsizei DefaultBatchSize = 64;
+
+	/// Creates a pool generating and deleting @p batch_size names at once
+	ObjectNamePool(
+		GLsizei batch_size = DefaultBatchSize,
+		bool recycle = false
+	): _batch_size(batch_size)
+	 , _recycle(recycle)
+	{
+		assert(_batch_size > 0);
+		_fresh.reserve(std::size_t(_batch_size));
+		_returned.reserve(std::size_t(_batch_size));
+		_unused.reserve(std::size_t(_batch_size));
+		ResetStats();
+	}
+
+	/// Deletes all names remaining in the pool
+	~ObjectNamePool(void)
+	{
+		if(_current() == this)
+		{
+			_current() = nullptr;
+		}
+		try { Clear(); }
+		catch(...) { }
+	}
+
+	/// Returns the pool installed on the calling thread or nullptr
+	static ObjectNamePool* Current(void)
+	OGLPLUS_NOEXCEPT(true)
+	{
+		return _current();
+	}
+
+	/// Installs the @p pool on the calling thread, returns the previous one
+	static ObjectNamePool* Install(ObjectNamePool* pool)
+	OGLPLUS_NOEXCEPT(true)
+	{
+		ObjectNamePool* prev = _current();
+		_current() = pool;
+		return prev;
+	}
+
+	/// Takes a name from the pool, generating a new batch if necessary
+	NameT Take(void)
+	{
+		if(!_unused.empty())
+		{
+			NameT name = _unused.back();
+			_taken.insert(name);
+			_unused.pop_back();
+			++_stats.recycled;
+			return name;
+		}
+		if(_fresh.empty())
+		{
+			_gen_batch();
+		}
+		NameT name = _fresh.back();
+		_taken.insert(name);
+		_fresh.pop_back();
+		return name;
+	}
+
+	/// Returns a name which is no longer used to the pool
+	/** Returns false if the @p name was not taken from this pool,
+	 *  in which case it is left to the caller to delete it.
+	 */
+	bool Return(NameT name)
+	{
+		if(_taken.erase(name) == 0)
+		{
+			return false;
+		}
+		if(_recycle && (_unused.size() < std::size_t(_batch_size)))
+		{
+			_unused.push_back(name);
+		}
+		else
+		{
+			_returned.push_back(name);
+			if(_returned.size() >= std::size_t(_batch_size))
+			{
+				_delete(_returned);
+			}
+		}
+		return true;
+	}
+
+	/// Deletes the returned names which are not deleted yet
+	void Flush(void)
+	{
+		_delete(_returned);
+	}
+
+	/// Deletes all names held by the pool
+	void Clear(void)
+	{
+		_delete(_returned);
+		_delete(_unused);
+		_delete(_fresh);
+	}
+
+	/// Returns the number of names which can be taken without glGen*
+	std::size_t Available(void) const
+	OGLPLUS_NOEXCEPT(true)
+	{
+		return _fresh.size()+_unused.size();
+	}
+
+	/// Returns the number of returned names waiting to be deleted
+	std::size_t Pending(void) const
+	OGLPLUS_NOEXCEPT(true)
+	{
+		return _returned.size();
+	}
+
+	/// Returns the statistics of this pool
+	const ObjectNamePoolStats& Stats(void) const
+	OGLPLUS_NOEXCEPT(true)
+	{
+		return _stats;
+	}
+
+	/// Resets the statistics of this pool
+	void ResetStats(void)
+	OGLPLUS_NOEXCEPT(true)
+	{
+		_stats.gen_calls = 0;
+		_stats.generated = 0;
+		_stats.recycled = 0;
+		_stats.delete_calls = 0;
+		_stats.deleted = 0;
+	}
+};
+
+/// Installs an ObjectNamePool for the lifetime of the scope object
+template <typename ObjTag>
+class ObjectNamePoolScope
+{
+private:
+	ObjectNamePool<ObjTag>* _prev;
+
+	ObjectNamePoolScope(const ObjectNamePoolScope&);
+public:
+	/// Installs the specified @p pool
+	ObjectNamePoolScope(ObjectNamePool<ObjTag>& pool)
+	 : _prev(ObjectNamePool<ObjTag>::Install(&pool))
+	{ }
+
+	/// Re-installs the previously used pool
+	~ObjectNamePoolScope(void)
+	{
+		ObjectNamePool<ObjTag>::Install(_prev);
+	}
+};
+
+} // namespace oglplus
+
+#endif // include guard
@@ -16,6 +16,7 @@
 #include <oglplus/object/desc.hpp>
 #include <oglplus/object/name_tpl.hpp>
 #include <oglplus/object/seq_tpl.hpp>
+#include <oglplus/object/name_pool.hpp>
 #include <oglplus/utils/nothing.hpp>
 #include <type_traits>
 #include <cassert>
@@ -239,6 +240,19 @@ private:
 		ObjGenDelOps<ObjTag>::Gen(gen_tag, 1, this->_name_ptr());
 	}
 
+	void _init(tag::Generate gen_tag, Nothing)
+	{
+		ObjectNamePool<ObjTag>* pool = ObjectNamePool<ObjTag>::Current();
+		if(pool)
+		{
+			*this->_name_ptr() = pool->Take();
+		}
+		else
+		{
+			ObjGenDelOps<ObjTag>::Gen(gen_tag, 1, this->_name_ptr());
+		}
+	}
+
 	template <typename GenTag, typename ObjectSubtype>
 	void _init(GenTag gen_tag, ObjectSubtype type)
 	{
@@ -251,7 +265,13 @@ private:
 		if(this->_has_deletable_name())
 		{
 			_undescribe();
-			ObjGenDelOps<ObjTag>::Delete(1, this->_name_ptr());
+			ObjectNamePool<ObjTag>* pool =
+				ObjectNamePool<ObjTag>::Current();
+			// names not taken from the pool are deleted directly
+			if(!(pool && pool->Return(*this->_name_ptr())))
+			{
+				ObjGenDelOps<ObjTag>::Delete(1, this->_name_ptr());
+			}
 		}
 	}
 protected:
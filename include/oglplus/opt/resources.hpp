@@ -39,6 +39,18 @@ std::size_t FindResourceFile(
 	unsigned nexts
 );
 
+/// Finds the path of a resource file with one of the extensions
+/** Returns the index of the extension of the found file and stores
+ *  its path into @p found, or returns @p nexts if no file is found.
+ */
+std::size_t FindResourcePath(
+	std::string& found,
+	const std::string& category,
+	const std::string& name,
+	const char** exts,
+	unsigned nexts
+);
+
 inline bool OpenResourceFile(
 	std::ifstream& file,
 	const std::string& category,
@@ -0,0 +1,238 @@
+/**
+ *  @file oglplus/profile/call.hpp
+ *  @brief Counting and timing of the GL function calls
+ *
+ *  @author Matus Chochlik
+ *
+ *  Copyright 2010-2015 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#pragma once
+#ifndef OGLPLUS_PROFILE_CALL_1509141100_HPP
+#define OGLPLUS_PROFILE_CALL_1509141100_HPP
+
+#include <oglplus/config/compiler.hpp>
+#include <oglplus/detail/enum_class.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <iosfwd>
+#include <cstddef>
+#include <cassert>
+
+namespace oglplus {
+
+/** @defgroup gl_call_profiling GL call profiling
+ *
+ *  If the #OGLPLUS_PROFILE_GL_CALLS compile-time switch is set to a nonzero
+ *  value, then all calls to GL functions made through the @c OGLPLUS_GLFUNC
+ *  macro are counted and timed. The time is accumulated per GL function
+ *  and per @OGLplus class (for the classes providing an error context)
+ *  in per-thread counters without any locking, and can be collected
+ *  from all threads by GLCallProfile::Snapshot.
+ */
+
+/// The kind of the items profiled by GLCallProfile
+/**
+ *  @ingroup gl_call_profiling
+ */
+OGLPLUS_ENUM_CLASS_BEGIN(GLCallProfileKind, unsigned char)
+#if OGLPLUS_DOCUMENTATION_ONLY
+	/// A GL function
+	Function,
+	/// An @OGLplus class calling GL functions
+	Class
+#else
+	OGLPLUS_ENUM_CLASS_VALUE(Function, 0)
+	OGLPLUS_ENUM_CLASS_COMMA
+	OGLPLUS_ENUM_CLASS_VALUE(Class, 1)
+#endif
+OGLPLUS_ENUM_CLASS_END(GLCallProfileKind)
+
+/// The number of calls and the time spent in a GL function or class
+/**
+ *  @ingroup gl_call_profiling
+ */
+struct GLCallProfileEntry
+{
+	/// The name of the GL function (without the gl prefix) or class
+	std::string name;
+
+	/// The kind of the profiled item
+	GLCallProfileKind kind;
+
+	/// The number of calls
+	unsigned long long count;
+
+	/// The total time spent in the calls in nanoseconds
+	unsigned long long nanoseconds;
+
+	/// The total time spent in the calls in seconds
+	double Seconds(void) const
+	{
+		return double(nanoseconds)*1e-9;
+	}
+};
+
+/// A snapshot of the GL call counters of all threads
+/** Snapshots can be taken periodically and the difference between two
+ *  snapshots (see Since) gives the statistics for the period between them.
+ *
+ *  @ingroup gl_call_profiling
+ */
+class GLCallProfile
+{
+private:
+	// indexed by the profiling slots
+	std::vector<GLCallProfileEntry> _entries;
+
+	unsigned long long _total_nanos(void) const;
+public:
+	/// Collects the current values of the counters of all threads
+	static GLCallProfile Snapshot(void);
+
+	/// Returns the difference between this and an @p earlier snapshot
+	GLCallProfile Since(const GLCallProfile& earlier) const;
+
+	/// Returns all the entries (including the not called ones)
+	const std::vector<GLCallProfileEntry>& Entries(void) const
+	{
+		return _entries;
+	}
+
+	/// Returns the called entries of @p kind ordered by descending time
+	std::vector<GLCallProfileEntry> Sorted(GLCallProfileKind kind) const;
+
+	/// Finds the entry with the specified @p name and @p kind
+	/** Returns nullptr if no such function or class was ever called.
+	 */
+	const GLCallProfileEntry* Find(
+		const char* name,
+		GLCallProfileKind kind = GLCallProfileKind::Function
+	) const;
+
+	/// Returns the total number of GL function calls
+	unsigned long long CallCount(void) const;
+
+	/// Returns the total time (in seconds) spent in the GL functions
+	double Time(void) const
+	{
+		return double(_total_nanos())*1e-9;
+	}
+
+	/// Writes a human-readable report to @p out
+	std::ostream& Report(std::ostream& out) const;
+
+	/// Writes the profile in JSON format to @p out
+	std::ostream& ReportJSON(std::ostream& out) const;
+};
+
+namespace aux {
+
+// The per-thread GL call counters, written only by the owning thread
+class GLCallCounters
+{
+public:
+	static const std::size_t MaxSlots = 1024;
+private:
+	typedef unsigned long long _ull;
+	std::atomic<_ull> _counts[MaxSlots];
+	std::atomic<_ull> _nanos[MaxSlots];
+	_ull _last_nanos;
+
+	static void _add(std::atomic<_ull>& counter, _ull value)
+	{
+		// there is only a single writer, so no read-modify-write
+		// operation is necessary, the readers just need to see
+		// a consistent value
+		counter.store(
+			counter.load(std::memory_order_relaxed)+value,
+			std::memory_order_relaxed
+		);
+	}
+
+	GLCallCounters(const GLCallCounters&);
+public:
+	GLCallCounters(void);
+
+	// the counters of the current thread
+	static GLCallCounters& Local(void);
+
+	// returns the slot for the function or class with the specified name
+	static std::size_t Slot(const char* name, GLCallProfileKind kind);
+
+	void Add(std::size_t slot, _ull nanos)
+	{
+		assert(slot < MaxSlots);
+		_add(_counts[slot], 1);
+		_add(_nanos[slot], nanos);
+		_last_nanos = nanos;
+	}
+
+	// attributes the time of the last call to another slot
+	void AddLast(std::size_t slot)
+	{
+		assert(slot < MaxSlots);
+		_add(_counts[slot], 1);
+		_add(_nanos[slot], _last_nanos);
+	}
+
+	_ull Count(std::size_t slot) const
+	{
+		return _counts[slot].load(std::memory_order_relaxed);
+	}
+
+	_ull Nanos(std::size_t slot) const
+	{
+		return _nanos[slot].load(std::memory_order_relaxed);
+	}
+};
+
+// Measures the time spent in a GL function call
+class GLCallTimer
+{
+private:
+	typedef std::chrono::steady_clock _clock;
+	typedef unsigned long long _ull;
+	std::size_t _slot;
+	_clock::time_point _start;
+public:
+	GLCallTimer(std::size_t slot)
+	 : _slot(slot)
+	 , _start(_clock::now())
+	{ }
+
+	~GLCallTimer(void)
+	{
+		GLCallCounters::Local().Add(
+			_slot,
+			_ull(std::chrono::duration_cast<std::chrono::nanoseconds>(
+				_clock::now()-_start
+			).count())
+		);
+	}
+};
+
+} // namespace aux
+
+#define OGLPLUS_PROFILE_GL_CLASS(CLASS_NAME) \
+{ \
+	static const std::size_t profile_slot = \
+		::oglplus::aux::GLCallCounters::Slot( \
+			CLASS_NAME, \
+			::oglplus::GLCallProfileKind::Class \
+		); \
+	::oglplus::aux::GLCallCounters::Local().AddLast(profile_slot); \
+}
+
+} // namespace oglplus
+
+#if !OGLPLUS_LINK_LIBRARY || defined(OGLPLUS_IMPLEMENTING_LIBRARY)
+#include <oglplus/profile/call.ipp>
+#endif
+
+#endif // include guard
@@ -0,0 +1,147 @@
+/**
+ *  @file oglplus/profile/func.hpp
+ *  @brief Wrappers counting and timing the GL function calls
+ *
+ *  @author Matus Chochlik
+ *
+ *  Copyright 2010-2015 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#pragma once
+#ifndef OGLPLUS_PROFILE_FUNC_1509141100_HPP
+#define OGLPLUS_PROFILE_FUNC_1509141100_HPP
+
+#include <oglplus/config/gl.hpp>
+#include <oglplus/profile/call.hpp>
+
+#if OGLPLUS_NO_VARIADIC_TEMPLATES
+#error "The GL call profiling requires variadic templates"
+#endif
+
+#if OGLPLUS_USE_GL_DISPATCH
+#include <oglplus/dispatch/func.hpp>
+#endif
+
+#if !OGLPLUS_NO_GLFUNC_CHECKS
+#include <oglplus/error/glfunc.hpp>
+#endif
+
+namespace oglplus {
+namespace aux {
+
+template <typename RV, typename ... P>
+struct GLProfiledCall
+{
+	static RV Call(RV (GLAPIENTRY *pfn)(P...), const char* name, P ... p)
+	{
+#if OGLPLUS_USE_GL_DISPATCH
+		return GLDispatchedFunc<RV, P...>(pfn, name)(p...);
+#else
+		(void)name;
+		return pfn(p...);
+#endif
+	}
+};
+
+// Trampolines having the same signature as the wrapped GL functions,
+// each of them has its own profiling slot
+template <typename RV, typename ... P>
+struct GLProfiledDirect
+{
+	typedef RV (GLAPIENTRY *_pfn_t)(P...);
+
+	template <_pfn_t PFN>
+	struct Fn
+	{
+		static const char* _name(const char* name = nullptr)
+		{
+			static const char* fn_name = name;
+			return fn_name;
+		}
+
+		static std::size_t _slot(void)
+		{
+			static const std::size_t slot = GLCallCounters::Slot(
+				_name(),
+				GLCallProfileKind::Function
+			);
+			return slot;
+		}
+
+		static RV GLAPIENTRY _call(P ... p)
+		{
+			GLCallTimer timer(_slot());
+			return GLProfiledCall<RV, P...>::Call(PFN, _name(), p...);
+		}
+
+		static _pfn_t Get(const char* name)
+		{
+			_name(name);
+			return &_call;
+		}
+	};
+};
+
+template <typename RV, typename ... P>
+struct GLProfiledIndirect
+{
+	typedef RV (GLAPIENTRY *_pfn_t)(P...);
+
+	template <_pfn_t* PPFN>
+	struct Fn
+	{
+		static const char* _name(const char* name = nullptr)
+		{
+			static const char* fn_name = name;
+			return fn_name;
+		}
+
+		static std::size_t _slot(void)
+		{
+			static const std::size_t slot = GLCallCounters::Slot(
+				_name(),
+				GLCallProfileKind::Function
+			);
+			return slot;
+		}
+
+		static RV GLAPIENTRY _call(P ... p)
+		{
+			GLCallTimer timer(_slot());
+			return GLProfiledCall<RV, P...>::Call(*PPFN, _name(), p...);
+		}
+
+		static _pfn_t Get(const char* name)
+		{
+			_name(name);
+#if !OGLPLUS_NO_GLFUNC_CHECKS
+			OGLPLUS_HANDLE_ERROR_IF(
+				(!*PPFN),
+				GL_INVALID_OPERATION,
+				MissingFunction::Message(),
+				MissingFunction,
+				GLFunc(name)
+			);
+#endif
+			return &_call;
+		}
+	};
+};
+
+template <typename RV, typename ... P>
+GLProfiledDirect<RV, P...> GLProfiledKind(RV (GLAPIENTRY *)(P...));
+
+template <typename RV, typename ... P>
+GLProfiledIndirect<RV, P...> GLProfiledKind(RV (* GLAPIENTRY *)(P...));
+
+} // namespace aux
+
+#define OGLPLUS_PROFILED_FUNC(PREFIX, FUNCNAME) \
+	decltype(::oglplus::aux::GLProfiledKind(&::PREFIX##FUNCNAME))::\
+		Fn<&::PREFIX##FUNCNAME>::Get(#FUNCNAME)
+
+} // namespace oglplus
+
+#endif // include guard
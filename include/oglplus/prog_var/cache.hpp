@@ -0,0 +1,218 @@
+/**
+ *  @file oglplus/prog_var/cache.hpp
+ *  @brief Cache of program variable locations and types
+ *
+ *  @author Matus Chochlik
+ *
+ *  Copyright 2010-2015 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#pragma once
+#ifndef OGLPLUS_PROG_VAR_CACHE_1509181200_HPP
+#define OGLPLUS_PROG_VAR_CACHE_1509181200_HPP
+
+#include <oglplus/config/compiler.hpp>
+#include <oglplus/fwd.hpp>
+#include <oglplus/string/ref.hpp>
+#include <oglplus/object/name.hpp>
+
+#include <atomic>
+#include <string>
+#include <unordered_map>
+#include <map>
+#include <mutex>
+
+namespace oglplus {
+
+/// Cached information about a single program variable
+/**
+ *  @ingroup shader_variables
+ */
+struct ProgVarCacheEntry
+{
+	/// The location of the variable (negative if inactive)
+	GLint location;
+
+	/// The GLSL type of the variable (GL_NONE if unknown)
+	GLenum type;
+
+	/// The number of array elements (1 for non-arrays)
+	GLint size;
+
+	/// The index of the uniform block containing the variable (or -1)
+	GLint block_index;
+
+	/// Indicates if the identifier was listed by GetActiveUniform
+	/** Entries which are not listed were added on a cache miss,
+	 *  (for example array elements or inactive variables).
+	 */
+	bool listed;
+};
+
+/// Statistics of the ProgVarCache of the current thread
+/**
+ *  @ingroup shader_variables
+ */
+struct ProgVarCacheStats
+{
+	/// The number of lookups answered from the cache
+	unsigned long hits;
+
+	/// The number of lookups which had to query the GL
+	unsigned long misses;
+
+	/// The number of times a program's active uniforms were enumerated
+	unsigned long fills;
+
+	/// The number of times the cached data was discarded
+	unsigned long invalidations;
+};
+
+/// Per-program cache of uniform locations and types
+/** The first time that a uniform of a linked program is looked up,
+ *  all active uniforms of that program are enumerated and their locations,
+ *  types, array sizes and block indices are stored. Later constructions
+ *  of Uniforms (and their type checks) are then answered without any
+ *  GL queries. Identifiers which are not listed as active uniforms
+ *  (for example individual array elements) are queried and cached
+ *  on the first lookup.
+ *
+ *  The cached data of a program is discarded when it is linked,
+ *  its binary is loaded or when it is deleted through @OGLplus.
+ *  Programs re-linked or re-created by direct GL calls must be invalidated
+ *  explicitly.
+ *
+ *  The cache is kept per-thread (if the compiler supports thread-local
+ *  storage) since program names are only meaningful in the GL context
+ *  which is current in the calling thread. The invalidation of a program
+ *  is propagated to the caches of all threads and discards only
+ *  the data of that program. The entries are keyed by the program name
+ *  only; applications making several non-shared contexts current
+ *  in the same thread must call Clear when switching between them.
+ *
+ *  This cache is used by the Uniform wrappers if the
+ *  #OGLPLUS_CACHE_PROG_VARS compile-time switch is set to a nonzero value.
+ *  The locations of vertex attributes and the indices of uniform blocks
+ *  are not cached; they are usually looked up only once, when the vertex
+ *  arrays and the block bindings are set up.
+ *
+ *  @ingroup shader_variables
+ */
+class ProgVarCache
+{
+public:
+	/// Returns the location of the uniform @p identifier in @p program
+	/**
+	 *  @glsymbols
+	 *  @glfunref{GetUniformLocation}
+	 *  @glfunref{GetActiveUniform}
+	 */
+	static GLint UniformLocation(ProgramName program, StrCRef identifier);
+
+	/// Returns the type of the active uniform @p identifier in @p program
+	/** Returns GL_NONE if @p identifier does not exactly match
+	 *  the name of an active uniform of the @p program.
+	 *
+	 *  @glsymbols
+	 *  @glfunref{GetActiveUniform}
+	 */
+	static GLenum UniformType(ProgramName program, StrCRef identifier);
+
+	/// Finds the cached entry for the uniform @p identifier in @p program
+	/** Returns nullptr if the program does not have such active uniform.
+	 *  The returned pointer is valid until the next call to any
+	 *  of the functions of ProgVarCache.
+	 */
+	static const ProgVarCacheEntry* FindUniform(
+		ProgramName program,
+		StrCRef identifier
+	);
+
+	/// Discards the cached data of the specified @p program
+	/** The data is discarded in the caches of all threads.
+	 */
+	static void Invalidate(ProgramName program);
+
+	/// Discards all cached data of the current thread
+	static void Clear(void);
+
+	/// Returns the statistics of the cache of the current thread
+	static ProgVarCacheStats Stats(void);
+
+	/// Resets the statistics of the cache of the current thread
+	static void ResetStats(void);
+};
+
+namespace aux {
+
+class ProgVarCacheImpl
+{
+private:
+	typedef std::unordered_map<std::string, ProgVarCacheEntry> _vars_t;
+
+	struct _program_t
+	{
+		_vars_t uniforms;
+		// the invalidation count of the program when filled
+		unsigned long generation;
+		bool filled;
+
+		_program_t(void)
+		 : generation(0)
+		 , filled(false)
+		{ }
+	};
+
+	std::map<GLuint, _program_t> _programs;
+	ProgVarCacheStats _stats;
+	unsigned long _generation;
+	// reused lookup key avoiding allocations on the cache hits
+	std::string _key;
+
+	// The invalidations shared by the caches of all threads
+	struct _shared_t
+	{
+		std::mutex mutex;
+		// incremented on every invalidation in any thread
+		std::atomic<unsigned long> generation;
+		// the number of invalidations of the individual programs
+		std::unordered_map<GLuint, unsigned long> programs;
+
+		_shared_t(void)
+		 : generation(0)
+		{ }
+	};
+	static _shared_t& _shared(void);
+
+	void _sync(void);
+	bool _fill(GLuint program, _program_t& cached);
+public:
+	ProgVarCacheImpl(void);
+
+	static ProgVarCacheImpl& Local(void);
+
+	const ProgVarCacheEntry* FindUniform(
+		GLuint program,
+		StrCRef identifier,
+		bool query
+	);
+
+	void Invalidate(GLuint program);
+	void Clear(void);
+
+	ProgVarCacheStats& Stats(void)
+	{
+		return _stats;
+	}
+};
+
+} // namespace aux
+} // namespace oglplus
+
+#if !OGLPLUS_LINK_LIBRARY || defined(OGLPLUS_IMPLEMENTING_LIBRARY)
+#include <oglplus/prog_var/cache.ipp>
+#endif
+
+#endif // include guard
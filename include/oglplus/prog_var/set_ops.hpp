@@ -18,6 +18,7 @@
 #include <oglplus/boolean.hpp>
 #include <oglplus/error/basic.hpp>
 #include <oglplus/prog_var/callers.hpp>
+#include <oglplus/prog_var/shadow.hpp>
 
 #include <type_traits>
 #include <cstddef>
@@ -35,6 +36,7 @@ class ProgVarBaseSetOps<OpsTag, VarTag, tag::NativeTypes, T, M>
 private:
 	typedef ProgVarSetters<OpsTag, VarTag, tag::NativeTypes> Setters;
 	typedef ProgVarCallers<OpsTag, T> Callers;
+	typedef aux::ProgVarShadow<VarTag> Shadow;
 
 	OGLPLUS_ERROR_REUSE_CONTEXT(Setters)
 
@@ -192,6 +194,21 @@ protected:
 			(sizeof...(V) > 0) && (sizeof...(V) <= M),
 			"Set requires 1 to M arguments"
 		);
+		typedef typename std::common_type<V...>::type S;
+		const S values[] = {S(v)...};
+		const unsigned sig =
+			Shadow::template Signature<S>(sizeof...(V), 1, false);
+		if(sizeof...(V) <= 4)
+		{
+			if(Shadow::Unchanged(
+				program,
+				location,
+				sig,
+				values,
+				sizeof(values),
+				1
+			)) return;
+		}
 		_do_set_t(
 			_set_mode<sizeof...(V)>(),
 			program,
@@ -199,11 +216,18 @@ protected:
 			location,
 			v...
 		);
-		OGLPLUS_CHECK_CTXT(
-			ProgVarError,
-			Program(ProgramName(program)).
-			Index(location)
-		);
+		if(sizeof...(V) <= 4)
+		{
+			Shadow::Store(
+				program,
+				location,
+				sig,
+				values,
+				sizeof(values),
+				1
+			);
+		}
+		else Shadow::Forget(program, location, (sizeof...(V)+3)/4);
 	}
 #else
 	template <typename V>
@@ -282,6 +306,18 @@ protected:
 			(Cols > 0) && (Cols <= M),
 			"The number of elements must be between 1 and M"
 		);
+		const unsigned sig = Shadow::template Signature<V>(Cols, 1, false);
+		if(Cols <= 4)
+		{
+			if(Shadow::Unchanged(
+				program,
+				location,
+				sig,
+				v,
+				Cols*sizeof(V),
+				1
+			)) return;
+		}
 		_do_set_v<Cols, V>(
 			_set_mode<Cols>(),
 			program,
@@ -289,6 +325,11 @@ protected:
 			location,
 			v
 		);
+		if(Cols <= 4)
+		{
+			Shadow::Store(program, location, sig, v, Cols*sizeof(V), 1);
+		}
+		else Shadow::Forget(program, location, (Cols+3)/4);
 	}
 
 	template <std::size_t Cols, typename V>
@@ -298,6 +339,15 @@ protected:
 			(Cols > 0) && (Cols <= M),
 			"The number of elements must be between 1 and M"
 		);
+		const unsigned sig = Shadow::template Signature<V>(Cols, 1, false);
+		if(Shadow::Unchanged(
+			prog,
+			location,
+			sig,
+			v,
+			Cols*sizeof(V),
+			std::size_t(n)
+		)) return;
 		_do_set_n<Cols, V>(
 			_set_mode<Cols>(),
 			prog,
@@ -306,6 +356,14 @@ protected:
 			n,
 			v
 		);
+		Shadow::Store(
+			prog,
+			location,
+			sig,
+			v,
+			Cols*sizeof(V),
+			std::size_t(n)
+		);
 	}
 };
 
@@ -317,6 +375,7 @@ class ProgVarBaseSetOps<OpsTag, VarTag, tag::MatrixTypes, T, M>
 private:
 	typedef ProgVarSetters<OpsTag, VarTag, tag::MatrixTypes> Setters;
 	typedef ProgVarCallers<OpsTag, T> Callers;
+	typedef aux::ProgVarShadow<VarTag> Shadow;
 
 	OGLPLUS_ERROR_REUSE_CONTEXT(Setters)
 protected:
@@ -337,6 +396,19 @@ protected:
 			(Rows > 0) && (Rows <= 4),
 			"The number of rows must be between 1 and 4"
 		);
+		const unsigned sig = Shadow::template Signature<V>(
+			Cols,
+			Rows,
+			transpose._get() == GL_TRUE
+		);
+		if(Shadow::Unchanged(
+			program,
+			location,
+			sig,
+			v,
+			Cols*Rows*sizeof(V),
+			std::size_t(count)
+		)) return;
 		std::integral_constant<std::size_t, Rows> rows;
 		std::integral_constant<std::size_t, Cols> cols;
 		Callers::_call_set_m(
@@ -352,6 +424,14 @@ protected:
 			Program(ProgramName(program)).
 			Index(location)
 		);
+		Shadow::Store(
+			program,
+			location,
+			sig,
+			v,
+			Cols*Rows*sizeof(V),
+			std::size_t(count)
+		);
 	}
 
 #if !OGLPLUS_NO_VARIADIC_TEMPLATES
@@ -0,0 +1,335 @@
+/**
+ *  @file oglplus/prog_var/shadow.hpp
+ *  @brief Shadow copies of uniform values eliminating redundant updates
+ *
+ *  @author Matus Chochlik
+ *
+ *  Copyright 2010-2015 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#pragma once
+#ifndef OGLPLUS_PROG_VAR_SHADOW_1509211200_HPP
+#define OGLPLUS_PROG_VAR_SHADOW_1509211200_HPP
+
+#include <oglplus/config/compiler.hpp>
+#include <oglplus/config/gl.hpp>
+#include <oglplus/fwd.hpp>
+#include <oglplus/object/name.hpp>
+#include <oglplus/error/policy.hpp>
+
+#include <atomic>
+#include <vector>
+#include <map>
+#include <mutex>
+#include <unordered_map>
+#include <type_traits>
+#include <cstddef>
+
+namespace oglplus {
+
+/// Statistics of the UniformShadow of the current thread
+/**
+ *  @ingroup shader_variables
+ */
+struct UniformShadowStats
+{
+	/// The number of uniform updates passed to the GL
+	unsigned long writes;
+
+	/// The number of uniform updates skipped as redundant
+	unsigned long skips;
+};
+
+/// Shadow copies of the uniform values eliminating redundant updates
+/** If the #OGLPLUS_SHADOW_UNIFORM_VALUES compile-time switch is set to
+ *  a nonzero value, then the values last written through the Uniform
+ *  wrappers are remembered for each program and location and setting
+ *  a uniform to the value that it already has does not call the GL.
+ *  Uniform arrays and matrices are compared element-by-element
+ *  and the update is skipped only if none of the elements changed.
+ *
+ *  The shadow values of a program are discarded when it is linked,
+ *  its binary is loaded or when it is deleted through @OGLplus.
+ *  Uniforms which are also written by direct GL calls must be either
+ *  invalidated after such writes or excluded from the shadowing.
+ *
+ *  The shadow values are kept per-thread (if the compiler supports
+ *  thread-local storage), programs whose uniforms are written from
+ *  several threads should have these uniforms excluded. The invalidation
+ *  of a program is propagated to all threads and discards only the values
+ *  of that program.
+ *
+ *  With the non-immediate ErrorCheckPolicy a failed write is not known
+ *  when its value is shadowed, so all shadow values of the thread are
+ *  discarded when a deferred check reports an error.
+ *
+ *  @note With the implicit program selection (glUniform*) the program
+ *  of the Uniform must be the currently used program, as required
+ *  by the GL anyway.
+ *
+ *  @ingroup shader_variables
+ */
+class UniformShadow
+{
+public:
+	/// Excludes (or re-includes) the uniform at @p location from shadowing
+	/** Excluded uniforms are always written to the GL. The exclusion
+	 *  is kept when the shadow values are invalidated or cleared and lasts
+	 *  until the uniform is re-included.
+	 */
+	static void Exclude(
+		ProgramName program,
+		GLint location,
+		bool exclude = true
+	);
+
+	/// Excludes (or re-includes) a @p uniform from the shadowing
+	template <typename VarTag>
+	static void Exclude(ProgVarLoc<VarTag> uniform, bool exclude = true)
+	{
+		static_assert(
+			std::is_same<VarTag, tag::Uniform>::value,
+			"Only uniforms can be shadowed"
+		);
+		Exclude(uniform.Program(), uniform.Location(), exclude);
+	}
+
+	/// Discards the shadow values of @p count uniforms at @p location
+	static void Invalidate(
+		ProgramName program,
+		GLint location,
+		std::size_t count
+	);
+
+	/// Discards the shadow values of a @p uniform (or @p count elements)
+	template <typename VarTag>
+	static void Invalidate(
+		ProgVarLoc<VarTag> uniform,
+		std::size_t count = 1
+	)
+	{
+		static_assert(
+			std::is_same<VarTag, tag::Uniform>::value,
+			"Only uniforms can be shadowed"
+		);
+		Invalidate(uniform.Program(), uniform.Location(), count);
+	}
+
+	/// Discards the shadow values of all uniforms of a @p program
+	static void Invalidate(ProgramName program);
+
+	/// Discards all shadow values of the current thread
+	static void Clear(void);
+
+	/// Returns the statistics of the current thread
+	static UniformShadowStats Stats(void);
+
+	/// Resets the statistics of the current thread
+	static void ResetStats(void);
+};
+
+namespace aux {
+
+class UniformShadowState
+{
+public:
+	// the largest shadowed value (dmat4)
+	static const std::size_t MaxValueSize = 16*sizeof(GLdouble);
+private:
+	struct _value_t
+	{
+		unsigned signature;
+		unsigned short size;
+		bool valid;
+		bool excluded;
+		unsigned char bytes[MaxValueSize];
+	};
+
+	struct _program_t
+	{
+		std::vector<_value_t> values;
+		// the invalidation count of the program when created
+		unsigned long generation;
+	};
+
+	std::map<GLuint, _program_t> _programs;
+	// the excluded locations, kept apart from the values
+	// so that they survive the invalidations
+	std::map<GLuint, std::vector<bool> > _excluded;
+	GLuint _last_name;
+	_program_t* _last_program;
+	UniformShadowStats _stats;
+	unsigned long _generation;
+	// the number of deferred GL errors when last synchronized
+	unsigned long _error_count;
+
+	// The invalidations shared by the shadows of all threads
+	struct _shared_t
+	{
+		std::mutex mutex;
+		// incremented on every invalidation in any thread
+		std::atomic<unsigned long> generation;
+		// the number of invalidations of the individual programs
+		std::unordered_map<GLuint, unsigned long> programs;
+
+		_shared_t(void)
+		 : generation(0)
+		{ }
+	};
+	static _shared_t& _shared(void);
+
+	void _sync(void);
+	bool _is_excluded(GLuint program, std::size_t location) const;
+
+	void _reset_last(void)
+	{
+		_last_name = 0;
+		_last_program = nullptr;
+	}
+
+	_program_t* _find(GLuint program);
+	_value_t* _values(GLuint program, GLint location, std::size_t count);
+public:
+	UniformShadowState(void);
+
+	static UniformShadowState& Local(void);
+
+	// returns true if all count values at consecutive locations
+	// starting with the specified location are equal to the shadows
+	bool Unchanged(
+		GLuint program,
+		GLint location,
+		unsigned signature,
+		const void* data,
+		std::size_t size,
+		std::size_t count
+	);
+
+	void Store(
+		GLuint program,
+		GLint location,
+		unsigned signature,
+		const void* data,
+		std::size_t size,
+		std::size_t count
+	);
+
+	void Exclude(GLuint program, GLint location, bool exclude);
+	void Forget(GLuint program, GLint location, std::size_t count);
+	void Invalidate(GLuint program);
+	void Clear(void);
+
+	UniformShadowStats& Stats(void)
+	{
+		return _stats;
+	}
+};
+
+// No shadowing for anything but uniforms
+template <typename VarTag>
+struct ProgVarShadow
+{
+	template <typename V>
+	static unsigned Signature(std::size_t, std::size_t, bool)
+	{
+		return 0u;
+	}
+
+	static bool Unchanged(
+		GLuint,
+		GLuint,
+		unsigned,
+		const void*,
+		std::size_t,
+		std::size_t
+	)
+	{
+		return false;
+	}
+
+	static void Store(
+		GLuint,
+		GLuint,
+		unsigned,
+		const void*,
+		std::size_t,
+		std::size_t
+	){ }
+
+	static void Forget(GLuint, GLuint, std::size_t) { }
+};
+
+#if OGLPLUS_SHADOW_UNIFORM_VALUES
+template <>
+struct ProgVarShadow<tag::Uniform>
+{
+	// distinguishes the values written by different glUniform* functions
+	template <typename V>
+	static unsigned Signature(std::size_t cols, std::size_t rows, bool tr)
+	{
+		return	unsigned(sizeof(V)) |
+			(std::is_floating_point<V>::value?0x10u:0x00u) |
+			(unsigned(cols) << 5) |
+			(unsigned(rows) << 9) |
+			(tr?0x2000u:0x0000u);
+	}
+
+	static bool Unchanged(
+		GLuint program,
+		GLuint location,
+		unsigned signature,
+		const void* data,
+		std::size_t size,
+		std::size_t count
+	)
+	{
+		return UniformShadowState::Local().Unchanged(
+			program,
+			GLint(location),
+			signature,
+			data,
+			size,
+			count
+		);
+	}
+
+	static void Store(
+		GLuint program,
+		GLuint location,
+		unsigned signature,
+		const void* data,
+		std::size_t size,
+		std::size_t count
+	)
+	{
+		UniformShadowState::Local().Store(
+			program,
+			GLint(location),
+			signature,
+			data,
+			size,
+			count
+		);
+	}
+
+	static void Forget(GLuint program, GLuint location, std::size_t count)
+	{
+		UniformShadowState::Local().Forget(
+			program,
+			GLint(location),
+			count
+		);
+	}
+};
+#endif // OGLPLUS_SHADOW_UNIFORM_VALUES
+
+} // namespace aux
+} // namespace oglplus
+
+#if !OGLPLUS_LINK_LIBRARY || defined(OGLPLUS_IMPLEMENTING_LIBRARY)
+#include <oglplus/prog_var/shadow.ipp>
+#endif
+
+#endif // include guard
@@ -18,6 +18,8 @@
 #include <oglplus/object/sequence.hpp>
 #include <oglplus/error/program.hpp>
 #include <oglplus/error/prog_var.hpp>
+#include <oglplus/prog_var/cache.hpp>
+#include <oglplus/prog_var/shadow.hpp>
 #include <oglplus/boolean.hpp>
 #include <oglplus/data_type.hpp>
 #include <oglplus/transform_feedback_mode.hpp>
@@ -65,6 +67,12 @@ protected:
 		{
 			OGLPLUS_GLFUNC(DeleteProgram)(names[i]);
 			OGLPLUS_VERIFY_SIMPLE(DeleteProgram);
+#if OGLPLUS_CACHE_PROG_VARS
+			ProgVarCache::Invalidate(ProgramName(names[i]));
+#endif
+#if OGLPLUS_SHADOW_UNIFORM_VALUES
+			UniformShadow::Invalidate(ProgramName(names[i]));
+#endif
 		}
 	}
 
@@ -343,6 +351,31 @@ public:
 	 */
 	ObjectOps& Link(void);
 
+	/// Starts linking of the program without waiting for its result
+	/** The link status is not queried, so the GL implementation
+	 *  can link several programs concurrently. Use CheckLinked
+	 *  or the AsyncBuilder to wait for the result.
+	 *
+	 *  @see CheckLinked
+	 *  @see AsyncBuilder
+	 *
+	 *  @glsymbols
+	 *  @glfunref{LinkProgram}
+	 */
+	ObjectOps& LinkAsync(void);
+
+	/// Waits for the linking of the program and checks its status
+	/**
+	 *  @post IsLinked()
+	 *  @throws Error LinkError
+	 *  @see LinkAsync
+	 *
+	 *  @glsymbols
+	 *  @glfunref{GetProgram}
+	 *  @glfunref{GetProgramInfoLog}
+	 */
+	ObjectOps& CheckLinked(void);
+
 	/// builds this shading language program
 	/** This function checks if all attached shaders are compiled
 	 *  and if they are not the it compiles them and then links
@@ -0,0 +1,194 @@
+/**
+ *  @file oglplus/program_binary_cache.hpp
+ *  @brief On-disk cache of program binaries
+ *
+ *  @author Matus Chochlik
+ *
+ *  Copyright 2010-2015 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#pragma once
+#ifndef OGLPLUS_PROGRAM_BINARY_CACHE_1509241200_HPP
+#define OGLPLUS_PROGRAM_BINARY_CACHE_1509241200_HPP
+
+#include <oglplus/config/compiler.hpp>
+#include <oglplus/program.hpp>
+#include <oglplus/shader.hpp>
+#include <oglplus/shader_type.hpp>
+#include <oglplus/glsl_source.hpp>
+#include <oglplus/string/def.hpp>
+#include <oglplus/string/ref.hpp>
+
+#include <vector>
+#include <utility>
+#include <cstdint>
+
+namespace oglplus {
+
+#if OGLPLUS_DOCUMENTATION_ONLY || GL_VERSION_4_1 || GL_ARB_get_program_binary
+
+/// The sources and options from which a program is built
+/** Instances of this class are used as keys of the ProgramBinaryCache.
+ *  The stored source texts of the shaders, their types, the preprocessor
+ *  symbol definitions and the separability of the program determine
+ *  the resulting binary.
+ *
+ *  @see ProgramBinaryCache
+ */
+class ProgramSources
+{
+private:
+	std::vector<std::pair<ShaderType, String>> _shaders;
+	std::vector<std::pair<String, String>> _defines;
+	bool _separable;
+public:
+	ProgramSources(void)
+	 : _separable(false)
+	{ }
+
+	/// Adds a shader with the specified @p type and @p source
+	ProgramSources& Add(ShaderType type, const GLSLSource& source);
+
+	/// Adds a shader with the specified @p type and @p source
+	ProgramSources& Add(ShaderType type, StrCRef source)
+	{
+		return Add(type, GLSLSource(source));
+	}
+
+	/// Defines a preprocessor symbol in all shaders
+	/** The definitions are inserted after the version directive
+	 *  of each shader, or at the beginning of shaders without one.
+	 */
+	ProgramSources& Define(StrCRef name, StrCRef value = StrCRef("1"));
+
+	/// Makes the built program separable
+	ProgramSources& MakeSeparable(bool separable = true)
+	{
+		_separable = separable;
+		return *this;
+	}
+
+	/// Returns the number of shaders
+	std::size_t ShaderCount(void) const
+	{
+		return _shaders.size();
+	}
+
+	/// Returns the type of the i-th shader
+	ShaderType Type(std::size_t index) const
+	{
+		return _shaders[index].first;
+	}
+
+	/// Returns the source of the i-th shader including the definitions
+	String Source(std::size_t index) const;
+
+	/// Returns true if the program should be separable
+	bool IsSeparable(void) const
+	{
+		return _separable;
+	}
+
+	/// Returns a hash of the sources, types, definitions and options
+	std::uint64_t Hash(std::uint64_t seed) const;
+};
+
+/// Statistics of a ProgramBinaryCache
+struct ProgramBinaryCacheStats
+{
+	/// The number of programs loaded from the cached binaries
+	unsigned long hits;
+
+	/// The number of programs which were not in the cache
+	unsigned long misses;
+
+	/// The number of cached binaries rejected by the GL
+	unsigned long rejected;
+
+	/// The number of binaries stored into the cache
+	unsigned long stored;
+
+	/// The number of binaries that could not be written
+	unsigned long write_failures;
+};
+
+/// Caches program binaries in files in a directory
+/** The Build function looks for a file containing the binary of
+ *  a program built from the specified ProgramSources for the current GL
+ *  implementation (identified by the vendor, renderer and version strings).
+ *  If such file exists, the binary is loaded into a new program.
+ *  Otherwise, or if the binary is rejected by the GL, the shaders are
+ *  compiled, the program is linked and its binary is retrieved and written
+ *  to the cache directory.
+ *
+ *  The cache files are written into temporary files which are then
+ *  renamed, so that concurrently running applications never see
+ *  incomplete files. The cache directory must exist.
+ *
+ *  @note A GL context must be current when the cache is constructed
+ *  and used.
+ *
+ *  @glvoereq{4,1,ARB,get_program_binary}
+ */
+class ProgramBinaryCache
+{
+private:
+	String _directory;
+	String _driver;
+	ProgramBinaryCacheStats _stats;
+
+	std::uint64_t _hash(const ProgramSources& sources, std::uint64_t s) const;
+
+	bool _load(Program& program, const ProgramSources& sources);
+	void _store(const Program& program, const ProgramSources& sources);
+	static void _compile(Program& program, const ProgramSources& sources);
+public:
+	/// Creates a cache storing the binaries in the specified @p directory
+	/**
+	 *  @glsymbols
+	 *  @glfunref{GetString}
+	 */
+	explicit ProgramBinaryCache(String directory);
+
+	/// Returns true if the GL supports at least one binary format
+	/**
+	 *  @glsymbols
+	 *  @glfunref{GetIntegerv}
+	 *  @gldefref{NUM_PROGRAM_BINARY_FORMATS}
+	 */
+	static bool IsSupported(void);
+
+	/// Returns the path of the cache file for the specified @p sources
+	String Path(const ProgramSources& sources) const;
+
+	/// Loads a cached or builds and caches a program from @p sources
+	/**
+	 *  @throws CompileError
+	 *  @throws LinkError
+	 */
+	Program Build(const ProgramSources& sources);
+
+	/// Removes the cached binary built from the specified @p sources
+	bool Remove(const ProgramSources& sources);
+
+	/// Returns the hit/miss statistics
+	const ProgramBinaryCacheStats& Stats(void) const
+	{
+		return _stats;
+	}
+
+	/// Resets the statistics
+	void ResetStats(void);
+};
+
+#endif // get program binary
+
+} // namespace oglplus
+
+#if !OGLPLUS_LINK_LIBRARY || defined(OGLPLUS_IMPLEMENTING_LIBRARY)
+#include <oglplus/program_binary_cache.ipp>
+#endif // OGLPLUS_LINK_LIBRARY
+
+#endif // include guard
@@ -0,0 +1,402 @@
+/**
+ *  @file oglplus/quaternion_batch.hpp
+ *  @brief Batch operations on arrays of quaternions
+ *
+ *  @author Matus Chochlik
+ *
+ *  Copyright 2010-2015 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#pragma once
+#ifndef OGLPLUS_QUATERNION_BATCH_1510182200_HPP
+#define OGLPLUS_QUATERNION_BATCH_1510182200_HPP
+
+#include <oglplus/config/compiler.hpp>
+#include <oglplus/math/quaternion.hpp>
+#include <oglplus/math/matrix.hpp>
+
+#include <vector>
+#include <cassert>
+#include <cstddef>
+
+namespace oglplus {
+
+/// An array of quaternions in the structure-of-arrays layout
+/** The real parts and the three components of the imaginary parts
+ *  are stored in separate contiguous arrays, which allows to process
+ *  several quaternions at once with SIMD instructions.
+ *
+ *  @ingroup math_utils
+ */
+class QuaternionArray
+{
+private:
+	std::vector<GLfloat> _a, _x, _y, _z;
+public:
+	/// Reserves space for @p count quaternions
+	void Reserve(std::size_t count)
+	{
+		_a.reserve(count);
+		_x.reserve(count);
+		_y.reserve(count);
+		_z.reserve(count);
+	}
+
+	/// Changes the number of quaternions, new ones are identities
+	void Resize(std::size_t count)
+	{
+		_a.resize(count, 1.0f);
+		_x.resize(count, 0.0f);
+		_y.resize(count, 0.0f);
+		_z.resize(count, 0.0f);
+	}
+
+	/// Removes all quaternions
+	void Clear(void)
+	{
+		_a.clear();
+		_x.clear();
+		_y.clear();
+		_z.clear();
+	}
+
+	/// Returns the number of quaternions
+	std::size_t Size(void) const
+	{
+		return _a.size();
+	}
+
+	/// Returns true if the array is empty
+	bool Empty(void) const
+	{
+		return _a.empty();
+	}
+
+	/// Appends a quaternion with the specified components
+	void Add(GLfloat a, GLfloat x, GLfloat y, GLfloat z)
+	{
+		_a.push_back(a);
+		_x.push_back(x);
+		_y.push_back(y);
+		_z.push_back(z);
+	}
+
+	/// Appends the specified quaternion @p q
+	void Add(const Quaternion<GLfloat>& q)
+	{
+		Add(q.At(0), q.At(1), q.At(2), q.At(3));
+	}
+
+	/// Returns the quaternion at the specified @p index
+	Quaternion<GLfloat> Get(std::size_t index) const
+	{
+		assert(index < Size());
+		return Quaternion<GLfloat>(
+			_a[index],
+			_x[index],
+			_y[index],
+			_z[index]
+		);
+	}
+
+	/// Changes the quaternion at the specified @p index
+	void Set(std::size_t index, const Quaternion<GLfloat>& q)
+	{
+		assert(index < Size());
+		_a[index] = q.At(0);
+		_x[index] = q.At(1);
+		_y[index] = q.At(2);
+		_z[index] = q.At(3);
+	}
+
+	/// Returns the array of the real parts
+	const GLfloat* A(void) const { return _a.data(); }
+	/// Returns the array of the real parts
+	GLfloat* A(void) { return _a.data(); }
+
+	/// Returns the array of the x-components of the imaginary parts
+	const GLfloat* X(void) const { return _x.data(); }
+	/// Returns the array of the x-components of the imaginary parts
+	GLfloat* X(void) { return _x.data(); }
+
+	/// Returns the array of the y-components of the imaginary parts
+	const GLfloat* Y(void) const { return _y.data(); }
+	/// Returns the array of the y-components of the imaginary parts
+	GLfloat* Y(void) { return _y.data(); }
+
+	/// Returns the array of the z-components of the imaginary parts
+	const GLfloat* Z(void) const { return _z.data(); }
+	/// Returns the array of the z-components of the imaginary parts
+	GLfloat* Z(void) { return _z.data(); }
+};
+
+/// An array of 3D vectors in the structure-of-arrays layout
+/**
+ *  @ingroup math_utils
+ */
+class Vec3Array
+{
+private:
+	std::vector<GLfloat> _x, _y, _z;
+public:
+	/// Reserves space for @p count vectors
+	void Reserve(std::size_t count)
+	{
+		_x.reserve(count);
+		_y.reserve(count);
+		_z.reserve(count);
+	}
+
+	/// Changes the number of vectors, new ones are zero vectors
+	void Resize(std::size_t count)
+	{
+		_x.resize(count, 0.0f);
+		_y.resize(count, 0.0f);
+		_z.resize(count, 0.0f);
+	}
+
+	/// Removes all vectors
+	void Clear(void)
+	{
+		_x.clear();
+		_y.clear();
+		_z.clear();
+	}
+
+	/// Returns the number of vectors
+	std::size_t Size(void) const
+	{
+		return _x.size();
+	}
+
+	/// Returns true if the array is empty
+	bool Empty(void) const
+	{
+		return _x.empty();
+	}
+
+	/// Appends a vector with the specified coordinates
+	void Add(GLfloat x, GLfloat y, GLfloat z)
+	{
+		_x.push_back(x);
+		_y.push_back(y);
+		_z.push_back(z);
+	}
+
+	/// Appends the specified vector @p v
+	void Add(const Vector<GLfloat, 3>& v)
+	{
+		Add(v.x(), v.y(), v.z());
+	}
+
+	/// Returns the vector at the specified @p index
+	Vector<GLfloat, 3> Get(std::size_t index) const
+	{
+		assert(index < Size());
+		return Vector<GLfloat, 3>(_x[index], _y[index], _z[index]);
+	}
+
+	/// Changes the vector at the specified @p index
+	void Set(std::size_t index, const Vector<GLfloat, 3>& v)
+	{
+		assert(index < Size());
+		_x[index] = v.x();
+		_y[index] = v.y();
+		_z[index] = v.z();
+	}
+
+	/// Returns the array of the x-coordinates
+	const GLfloat* X(void) const { return _x.data(); }
+	/// Returns the array of the x-coordinates
+	GLfloat* X(void) { return _x.data(); }
+
+	/// Returns the array of the y-coordinates
+	const GLfloat* Y(void) const { return _y.data(); }
+	/// Returns the array of the y-coordinates
+	GLfloat* Y(void) { return _y.data(); }
+
+	/// Returns the array of the z-coordinates
+	const GLfloat* Z(void) const { return _z.data(); }
+	/// Returns the array of the z-coordinates
+	GLfloat* Z(void) { return _z.data(); }
+};
+
+/// Operations on whole arrays of quaternions
+/** The quaternions are processed several at once using SSE2 or AVX
+ *  instructions when available (see OGLPLUS_NO_SIMD). The arrays
+ *  passed as arguments must have the same size and the result is
+ *  resized to that size. The result may be one of the arguments.
+ *
+ *  Unlike QuaternionSLERP, NLERP and SLERP interpolate along
+ *  the shorter arc, i.e. the second quaternion is negated if the dot
+ *  product of the pair is negative, as is usual for animation.
+ *
+ *  @ingroup math_utils
+ */
+class QuaternionBatch
+{
+private:
+	static void _nlerp(
+		const QuaternionArray& q1,
+		const QuaternionArray& q2,
+		const GLfloat* t,
+		bool per_element,
+		QuaternionArray& result
+	);
+
+	static void _slerp(
+		const QuaternionArray& q1,
+		const QuaternionArray& q2,
+		const GLfloat* t,
+		bool per_element,
+		QuaternionArray& result
+	);
+
+	template <std::size_t Rows>
+	static void _to_matrices(
+		const QuaternionArray& rotations,
+		const Vec3Array* translations,
+		std::vector<Matrix<GLfloat, Rows, 4> >& matrices
+	);
+public:
+	/// The maximal error of the components of the results of SLERP
+	static GLfloat SLERPMaxError(void)
+	{
+		return 2e-6f;
+	}
+
+	/// Multiplies the quaternions of @p q1 and @p q2 pairwise
+	static void Multiply(
+		const QuaternionArray& q1,
+		const QuaternionArray& q2,
+		QuaternionArray& result
+	);
+
+	/// Normalizes all quaternions in the array @p q
+	/** The reciprocal square root is approximated and refined with
+	 *  a Newton-Raphson step, the relative error is below 1e-6.
+	 *
+	 *  @pre none of the quaternions is degenerate
+	 */
+	static void Normalize(QuaternionArray& q);
+
+	/// Rotates the @p vectors by the corresponding unit quaternions @p q
+	/** Equivalent to the Rotate function for single quaternions.
+	 *
+	 *  @pre all quaternions in @p q are normal
+	 */
+	static void Rotate(
+		const QuaternionArray& q,
+		const Vec3Array& vectors,
+		Vec3Array& result
+	);
+
+	/// Normalized linear interpolation of unit quaternions with factor @p t
+	/** Cheaper than SLERP, but the angular velocity is not constant.
+	 *
+	 *  @pre (t >= 0) && (t <= 1)
+	 */
+	static void NLERP(
+		const QuaternionArray& q1,
+		const QuaternionArray& q2,
+		GLfloat t,
+		QuaternionArray& result
+	)
+	{
+		_nlerp(q1, q2, &t, false, result);
+	}
+
+	/// Normalized linear interpolation with a factor for each pair
+	/**
+	 *  @pre t.size() == q1.Size()
+	 */
+	static void NLERP(
+		const QuaternionArray& q1,
+		const QuaternionArray& q2,
+		const std::vector<GLfloat>& t,
+		QuaternionArray& result
+	)
+	{
+		assert(t.size() == q1.Size());
+		_nlerp(q1, q2, t.data(), true, result);
+	}
+
+	/// Spherical-linear interpolation of unit quaternions with factor @p t
+	/** The ratios of sines weighting the quaternions are approximated
+	 *  by a polynomial in the cosine of the angle between them and in
+	 *  the factor @p t (D. Eberly, A Fast and Accurate Algorithm for
+	 *  Computing SLERP), which needs no trigonometric functions and
+	 *  no division. The error of the coefficients is below 1e-6
+	 *  and the error of the components of the result is below
+	 *  SLERPMaxError() for all angles.
+	 *
+	 *  @pre (t >= 0) && (t <= 1)
+	 *  @pre all quaternions in @p q1 and @p q2 are normal
+	 */
+	static void SLERP(
+		const QuaternionArray& q1,
+		const QuaternionArray& q2,
+		GLfloat t,
+		QuaternionArray& result
+	)
+	{
+		_slerp(q1, q2, &t, false, result);
+	}
+
+	/// Spherical-linear interpolation with a factor for each pair
+	/**
+	 *  @pre t.size() == q1.Size()
+	 */
+	static void SLERP(
+		const QuaternionArray& q1,
+		const QuaternionArray& q2,
+		const std::vector<GLfloat>& t,
+		QuaternionArray& result
+	)
+	{
+		assert(t.size() == q1.Size());
+		_slerp(q1, q2, t.data(), true, result);
+	}
+
+	/// Converts the @p rotations to rotation matrices
+	/** Equivalent to ModelMatrix::RotationQ, the quaternions do not
+	 *  have to be normal.
+	 */
+	static void ToMatrices(
+		const QuaternionArray& rotations,
+		std::vector<Matrix<GLfloat, 4, 4> >& matrices
+	);
+
+	/// Converts the @p rotations and @p translations to model matrices
+	static void ToMatrices(
+		const QuaternionArray& rotations,
+		const Vec3Array& translations,
+		std::vector<Matrix<GLfloat, 4, 4> >& matrices
+	);
+
+	/// Converts the @p rotations to the top three rows of rotation matrices
+	/** The 3x4 matrices are suitable for a skinning palette, since
+	 *  they omit the constant last row of the 4x4 matrices.
+	 */
+	static void ToMatrices(
+		const QuaternionArray& rotations,
+		std::vector<Matrix<GLfloat, 3, 4> >& matrices
+	);
+
+	/// Converts the @p rotations and @p translations to 3x4 model matrices
+	static void ToMatrices(
+		const QuaternionArray& rotations,
+		const Vec3Array& translations,
+		std::vector<Matrix<GLfloat, 3, 4> >& matrices
+	);
+};
+
+} // namespace oglplus
+
+#if !OGLPLUS_LINK_LIBRARY || defined(OGLPLUS_IMPLEMENTING_LIBRARY)
+#include <oglplus/quaternion_batch.ipp>
+#endif // OGLPLUS_LINK_LIBRARY
+
+#endif // include guard
@@ -0,0 +1,380 @@
+/**
+ *  @file oglplus/render_queue.hpp
+ *  @brief Render queue sorting draw items to minimize state changes
+ *
+ *  @author Matus Chochlik
+ *
+ *  Copyright 2010-2015 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#pragma once
+#ifndef OGLPLUS_RENDER_QUEUE_1510141000_HPP
+#define OGLPLUS_RENDER_QUEUE_1510141000_HPP
+
+#include <oglplus/config/compiler.hpp>
+#include <oglplus/client_context.hpp>
+#include <oglplus/object/name.hpp>
+#include <oglplus/primitive_type.hpp>
+#include <oglplus/data_type.hpp>
+#include <oglplus/texture_target.hpp>
+#include <oglplus/compare_function.hpp>
+#include <oglplus/blend_function.hpp>
+
+#include <unordered_map>
+#include <functional>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <cassert>
+
+namespace oglplus {
+
+/// The blending and depth state of a RenderQueueItem
+struct RenderQueueState
+{
+	/// Indicates that blending is enabled (the item is translucent)
+	bool blend;
+
+	/// The blending function used if blending is enabled
+	context::BlendFunctionSeparate blend_function;
+
+	/// Indicates that depth testing is enabled
+	bool depth_test;
+
+	/// Indicates that depth values are written
+	bool depth_mask;
+
+	/// The depth function used if depth testing is enabled
+	CompareFunction depth_function;
+
+	/// Opaque state with depth testing and depth writes
+	RenderQueueState(void)
+	 : blend(false)
+	 , blend_function(
+		BlendFunction::One,
+		BlendFunction::One,
+		BlendFunction::Zero,
+		BlendFunction::Zero
+	), depth_test(true)
+	 , depth_mask(true)
+	 , depth_function(CompareFunction::Less)
+	{ }
+
+	/// Translucent state with depth testing and without depth writes
+	static RenderQueueState Blended(BlendFunction src, BlendFunction dst)
+	{
+		RenderQueueState result;
+		result.blend = true;
+		result.blend_function = context::BlendFunctionSeparate(
+			src, src,
+			dst, dst
+		);
+		result.depth_mask = false;
+		return result;
+	}
+};
+
+/// A texture bound to a texture unit by a RenderQueueItem
+struct RenderQueueTexture
+{
+	TextureTarget target;
+	TextureName texture;
+};
+
+/// A single draw call submitted to a RenderQueue
+struct RenderQueueItem
+{
+	/// The maximal number of texture units used by a single item
+	static const std::size_t MaxTextures = 4;
+
+	/// The program used by the draw call
+	ProgramName program;
+
+	/// The vertex array object used by the draw call
+	VertexArrayName vertex_array;
+
+	/// The textures bound to the units [0, texture_count)
+	RenderQueueTexture textures[MaxTextures];
+
+	/// The number of used texture units
+	std::size_t texture_count;
+
+	/// The blending and depth state
+	RenderQueueState state;
+
+	/// The depth of the item (in the range set in the RenderQueue)
+	GLfloat depth;
+
+	/// The drawn primitive type
+	PrimitiveType mode;
+
+	/// The first vertex used by array draw calls
+	GLint first;
+
+	/// The number of vertices or indices to be drawn
+	GLsizei count;
+
+	/// Indicates that the draw call uses the bound element buffer
+	bool indexed;
+
+	/// The type of the indices used by indexed draw calls
+	DataType index_type;
+
+	/// The offset of the indices in the bound element buffer
+	const GLvoid* indices;
+
+	/// The number of drawn instances
+	GLsizei instances;
+
+	/// Arbitrary value passed back to the application during Replay
+	std::size_t user_data;
+
+	RenderQueueItem(void)
+	 : texture_count(0)
+	 , depth(0)
+	 , mode(PrimitiveType::Triangles)
+	 , first(0)
+	 , count(0)
+	 , indexed(false)
+	 , index_type(DataType::UnsignedInt)
+	 , indices(nullptr)
+	 , instances(1)
+	 , user_data(0)
+	{ }
+
+	/// Binds a @p texture to the specified @p target of the @p unit
+	RenderQueueItem& BindTexture(
+		std::size_t unit,
+		TextureTarget target,
+		TextureName texture
+	)
+	{
+		assert(unit < MaxTextures);
+		textures[unit].target = target;
+		textures[unit].texture = texture;
+		if(texture_count <= unit)
+		{
+			texture_count = unit+1;
+		}
+		return *this;
+	}
+
+	/// Makes this item draw vertices from the bound arrays
+	RenderQueueItem& DrawArrays(
+		PrimitiveType primitive,
+		GLint first_vertex,
+		GLsizei vertex_count,
+		GLsizei instance_count = 1
+	)
+	{
+		mode = primitive;
+		first = first_vertex;
+		count = vertex_count;
+		indexed = false;
+		instances = instance_count;
+		return *this;
+	}
+
+	/// Makes this item draw elements from the bound element buffer
+	RenderQueueItem& DrawElements(
+		PrimitiveType primitive,
+		GLsizei index_count,
+		DataType data_type,
+		const GLvoid* offset = nullptr,
+		GLsizei instance_count = 1
+	)
+	{
+		mode = primitive;
+		count = index_count;
+		indexed = true;
+		index_type = data_type;
+		indices = offset;
+		instances = instance_count;
+		return *this;
+	}
+};
+
+/// Statistics of the state changes of a RenderQueue
+struct RenderQueueStats
+{
+	/// The number of items in the queue
+	std::size_t items;
+
+	/// The number of state changes in the order of submission
+	std::size_t submitted_changes;
+
+	/// The number of state changes in the sorted order
+	std::size_t sorted_changes;
+
+	/// The number of state changes avoided by sorting
+	std::size_t Avoided(void) const
+	{
+		return (submitted_changes > sorted_changes)?
+			submitted_changes-sorted_changes:0;
+	}
+};
+
+/// Sorts submitted draw items to minimize the state changes between them
+/** Each submitted item gets a 64-bit sort key built from small ids
+ *  of its program, state, set of textures and vertex array and from
+ *  its quantized depth. Opaque items are sorted by program, state,
+ *  textures, vertex array and front-to-back, translucent (blended)
+ *  items are drawn after all opaque items back-to-front.
+ *  The keys are sorted with a radix sort and the items are replayed
+ *  through a ClientContext, which skips redundant program, vertex array
+ *  and state changes, and through the texture binders.
+ *
+ *  Submit and Sort do not call any GL functions.
+ *
+ *  @ingroup utility_classes
+ */
+class RenderQueue
+{
+public:
+	/// The type of the sort key
+	typedef std::uint64_t Key;
+
+	/// A sort key and the index of the item it belongs to
+	struct Entry
+	{
+		Key key;
+		GLuint index;
+	};
+
+	/// The number of bits of the individual parts of the sort key
+	enum KeyBits
+	{
+		ProgramBits = 10,
+		StateBits = 8,
+		TextureBits = 12,
+		VertexArrayBits = 10,
+		DepthBits = 23
+	};
+private:
+	std::vector<RenderQueueItem> _items;
+	std::vector<Entry> _entries, _scratch;
+	bool _sorted;
+
+	GLfloat _depth_near, _depth_far;
+
+	std::unordered_map<std::uint64_t, GLuint> _program_ids;
+	std::unordered_map<std::uint64_t, GLuint> _state_ids;
+	std::unordered_map<std::uint64_t, GLuint> _texture_ids;
+	std::unordered_map<std::uint64_t, GLuint> _vertex_array_ids;
+
+	// the textures bound to the units by Replay
+	std::vector<std::pair<GLenum, GLuint>> _bound_textures;
+
+	static GLuint _intern(
+		std::unordered_map<std::uint64_t, GLuint>& ids,
+		std::uint64_t value
+	);
+
+	static std::uint64_t _hash(std::uint64_t hash, std::uint64_t value);
+	static std::uint64_t _state_hash(const RenderQueueState& state);
+	static std::uint64_t _texture_hash(const RenderQueueItem& item);
+
+	std::size_t _count_changes(bool sorted) const;
+
+	void _bind_textures(const RenderQueueItem& item, GLint& active_unit);
+	static void _draw(const RenderQueueItem& item);
+public:
+	/// Creates an empty queue with the specified depth range
+	/** The depth values of the items are clamped to the
+	 *  [@p depth_near, @p depth_far] range for sorting.
+	 */
+	RenderQueue(GLfloat depth_near = 0, GLfloat depth_far = 1);
+
+	/// Quantizes a depth value into an integer with DepthBits bits
+	static GLuint QuantizeDepth(
+		GLfloat depth,
+		GLfloat depth_near,
+		GLfloat depth_far
+	);
+
+	/// Builds a sort key from the ids of the parts and quantized depth
+	static Key MakeKey(
+		bool translucent,
+		GLuint program_id,
+		GLuint state_id,
+		GLuint texture_id,
+		GLuint vertex_array_id,
+		GLuint depth
+	);
+
+	/// Stable radix sort of the @p entries by their keys
+	/** The @p scratch vector is used as temporary storage.
+	 */
+	static void RadixSort(
+		std::vector<Entry>& entries,
+		std::vector<Entry>& scratch
+	);
+
+	/// Reserves space for @p count items
+	void Reserve(std::size_t count);
+
+	/// Submits an item into the queue
+	void Submit(const RenderQueueItem& item);
+
+	/// Returns the number of submitted items
+	std::size_t Size(void) const
+	{
+		return _items.size();
+	}
+
+	/// Returns the i-th submitted item
+	const RenderQueueItem& Item(std::size_t i) const
+	{
+		return _items[i];
+	}
+
+	/// Returns the sort keys of the items and their indices
+	/** The entries are in the order of submission until Sort is called.
+	 */
+	const std::vector<Entry>& Entries(void) const
+	{
+		return _entries;
+	}
+
+	/// Sorts the submitted items
+	void Sort(void);
+
+	/// Counts the state changes in the submitted and in the sorted order
+	/** If the queue is not sorted the sorted_changes are equal to
+	 *  the submitted_changes.
+	 */
+	RenderQueueStats Stats(void) const;
+
+	/// Draws the items in the sorted order
+	/** If necessary the items are sorted first. The @p before_draw
+	 *  function is called for each item after its state is applied
+	 *  and before it is drawn (to set uniforms for example).
+	 *  The state of the @p gl context is left as set by the last item.
+	 */
+	void Replay(
+		ClientContext& gl,
+		const std::function<void (const RenderQueueItem&)>& before_draw
+	);
+
+	/// Draws the items in the sorted order
+	void Replay(ClientContext& gl)
+	{
+		Replay(gl, std::function<void (const RenderQueueItem&)>());
+	}
+
+	/// Removes all submitted items
+	/** The ids assigned to programs, states, textures and vertex arrays
+	 *  are kept so that the keys are stable between frames.
+	 */
+	void Clear(void);
+};
+
+} // namespace oglplus
+
+#if !OGLPLUS_LINK_LIBRARY || defined(OGLPLUS_IMPLEMENTING_LIBRARY)
+#include <oglplus/render_queue.ipp>
+#endif // OGLPLUS_LINK_LIBRARY
+
+#endif // include guard
@@ -341,6 +341,31 @@ public:
 	 */
 	ObjectOps& Compile(void);
 
+	/// Starts the compilation of the shader without waiting for its result
+	/** The compilation status is not queried, so the GL implementation
+	 *  can compile several shaders concurrently. Use CheckCompiled
+	 *  or the AsyncBuilder to wait for the result.
+	 *
+	 *  @see CheckCompiled
+	 *  @see AsyncBuilder
+	 *
+	 *  @glsymbols
+	 *  @glfunref{CompileShader}
+	 */
+	ObjectOps& CompileAsync(void);
+
+	/// Waits for the compilation of the shader and checks its status
+	/**
+	 *  @post IsCompiled()
+	 *  @throws Error CompileError
+	 *  @see CompileAsync
+	 *
+	 *  @glsymbols
+	 *  @glfunref{GetShader}
+	 *  @gldefref{COMPILE_STATUS}
+	 */
+	ObjectOps& CheckCompiled(void);
+
 
 #if OGLPLUS_DOCUMENTATION_ONLY || \
 	GL_ARB_shading_language_include
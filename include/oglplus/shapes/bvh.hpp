@@ -0,0 +1,366 @@
+/**
+ *  @file oglplus/shapes/bvh.hpp
+ *  @brief Bounding-volume hierarchies over shape instances and triangles
+ *
+ *  @author Matus Chochlik
+ *
+ *  Copyright 2010-2015 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#pragma once
+#ifndef OGLPLUS_SHAPES_BVH_1510181600_HPP
+#define OGLPLUS_SHAPES_BVH_1510181600_HPP
+
+#include <oglplus/config/compiler.hpp>
+#include <oglplus/shapes/draw.hpp>
+#include <oglplus/math/vector.hpp>
+#include <oglplus/math/sphere.hpp>
+#include <oglplus/math/frustum.hpp>
+
+#include <atomic>
+#include <functional>
+#include <vector>
+#include <cassert>
+
+namespace oglplus {
+namespace shapes {
+
+/// A node of a bounding-volume hierarchy
+/** The nodes are stored in a flat array, the children of an inner node
+ *  are stored next to each other and always after their parent.
+ */
+struct BVHNode
+{
+	/// The minimal corner of the bounding box of the node
+	GLfloat min[3];
+
+	/// The index of the first primitive (leaf) or of the first child
+	GLuint offset;
+
+	/// The maximal corner of the bounding box of the node
+	GLfloat max[3];
+
+	/// The number of primitives of a leaf node, zero for inner nodes
+	GLuint count;
+
+	/// Returns true if this is a leaf node
+	bool IsLeaf(void) const
+	{
+		return count != 0;
+	}
+};
+
+} // namespace shapes
+namespace aux {
+
+using shapes::BVHNode;
+
+// Builds a BVH over boxes using the binned surface area heuristic
+class BVHBuilder
+{
+private:
+	// the primitives are reordered in place during the build
+	// so that the splitting passes access the memory sequentially
+	struct _prim
+	{
+		GLfloat min[3];
+		GLuint index;
+		GLfloat max[3];
+		GLfloat pad;
+
+		GLfloat Centroid(std::size_t axis) const
+		{
+			// twice the center, the scale does not matter
+			return min[axis]+max[axis];
+		}
+	};
+
+	std::vector<_prim> _prims;
+	std::vector<GLuint>& _order;
+	std::vector<BVHNode>& _nodes;
+	std::atomic<GLuint> _node_count;
+	GLuint _max_leaf_size;
+	unsigned _spawn_depth;
+
+	void _bounds(
+		GLuint begin,
+		GLuint end,
+		BVHNode& node,
+		GLfloat* cmin,
+		GLfloat* cmax
+	) const;
+
+	GLuint _split(
+		GLuint begin,
+		GLuint end,
+		const BVHNode& node,
+		const GLfloat* cmin,
+		const GLfloat* cmax,
+		unsigned depth
+	);
+
+	void _build(GLuint node, GLuint begin, GLuint end, unsigned depth);
+public:
+	// the boxes are stored as six values (min xyz, max xyz) per primitive
+	BVHBuilder(
+		const GLfloat* boxes,
+		GLuint count,
+		GLuint max_leaf_size,
+		std::vector<GLuint>& order,
+		std::vector<BVHNode>& nodes
+	);
+
+	void Build(unsigned threads);
+
+	static void Refit(
+		const GLfloat* boxes,
+		const std::vector<GLuint>& order,
+		std::vector<BVHNode>& nodes
+	);
+};
+
+} // namespace aux
+namespace shapes {
+
+/// Bounding-volume hierarchy over the bounding volumes of shape instances
+/** The instances are identified by their index and are bounded by
+ *  axis-aligned boxes (bounding spheres are converted to boxes).
+ *  The hierarchy is built with the binned surface area heuristic,
+ *  optionally on several threads. When the instances move, their
+ *  bounding volumes can be updated and the hierarchy refitted, which
+ *  is much faster than rebuilding it (but the quality of the hierarchy
+ *  degrades when the instances move far from their original positions).
+ *
+ *  The hierarchy can be used for frustum culling and for ray picking.
+ *
+ *  @ingroup shapes
+ */
+class InstanceBVH
+{
+private:
+	std::vector<GLfloat> _boxes;
+	std::vector<GLuint> _order;
+	std::vector<BVHNode> _nodes;
+public:
+	/// Value returned by Pick if no instance was hit
+	static GLuint NoInstance(void)
+	{
+		return ~GLuint(0);
+	}
+
+	/// Sets the number of instances
+	/** The bounding volumes of new instances are empty. The hierarchy
+	 *  must be rebuilt after changing the number of instances.
+	 */
+	void Resize(GLuint count)
+	{
+		_boxes.resize(count*6, 0.0f);
+		_nodes.clear();
+		_order.clear();
+	}
+
+	/// Returns the number of instances
+	GLuint Size(void) const
+	{
+		return GLuint(_boxes.size()/6);
+	}
+
+	/// Sets the bounding box of the instance with the specified index
+	void SetBox(GLuint index, const Vec3f& min, const Vec3f& max)
+	{
+		assert(index < Size());
+		GLfloat* b = _boxes.data()+index*6;
+		for(std::size_t c=0; c!=3; ++c)
+		{
+			assert(min[c] <= max[c]);
+			b[c+0] = min[c];
+			b[c+3] = max[c];
+		}
+	}
+
+	/// Sets the bounding sphere of the instance with the specified index
+	void SetSphere(GLuint index, const Spheref& sphere)
+	{
+		const Vec3f r(sphere.Radius());
+		SetBox(index, sphere.Center()-r, sphere.Center()+r);
+	}
+
+	/// Builds the hierarchy from the current bounding volumes
+	/** If @p threads is zero then the number of hardware threads is used.
+	 */
+	void Build(unsigned threads = 1);
+
+	/// Updates the bounding boxes of the nodes after the instances moved
+	/**
+	 *  @throws std::runtime_error if the hierarchy was not built for
+	 *  the current number of instances.
+	 */
+	void Refit(void);
+
+	/// Returns true if the hierarchy is not built
+	bool Empty(void) const
+	{
+		return _nodes.empty();
+	}
+
+	/// Returns the nodes of the hierarchy
+	const std::vector<BVHNode>& Nodes(void) const
+	{
+		return _nodes;
+	}
+
+	/// Stores the indices of the instances intersecting the @p frustum
+	/** The test uses the bounding boxes and is conservative.
+	 *  Returns the number of the found instances.
+	 */
+	std::size_t Cull(
+		const Frustumf& frustum,
+		std::vector<GLuint>& visible
+	) const;
+
+	/// Stores the indices of the instances whose boxes are hit by a ray
+	/** Returns the number of the found instances.
+	 */
+	std::size_t IntersectRay(
+		const Vec3f& origin,
+		const Vec3f& direction,
+		std::vector<GLuint>& hits
+	) const;
+
+	/// Finds the nearest instance hit by a ray
+	/** The nodes are visited front-to-back and the @p test function
+	 *  is called for the instances whose bounding box is hit by the ray
+	 *  closer than @p distance. The function should test the instance
+	 *  precisely and if it is hit closer than the passed distance,
+	 *  update the distance and return true.
+	 *  Returns the index of the nearest instance and its distance
+	 *  in @p distance, or NoInstance() if nothing was hit.
+	 */
+	GLuint Pick(
+		const Vec3f& origin,
+		const Vec3f& direction,
+		const std::function<bool (GLuint, GLfloat&)>& test,
+		GLfloat& distance
+	) const;
+};
+
+/// The result of a ray query against a TriangleBVH
+struct BVHRayHit
+{
+	/// The index of the hit triangle
+	GLuint triangle;
+
+	/// The distance along the ray (in the units of the ray direction)
+	GLfloat distance;
+
+	/// The barycentric coordinates of the hit point
+	GLfloat u, v;
+};
+
+/// Bounding-volume hierarchy over the triangles of a mesh
+/** This class allows fast CPU ray picking on large meshes, like the ones
+ *  loaded by ObjMesh or BlenderMesh or generated by the shape builders.
+ *
+ *  @ingroup shapes
+ */
+class TriangleBVH
+{
+private:
+	std::vector<GLfloat> _verts;
+	std::vector<GLuint> _tri_index;
+	std::vector<BVHNode> _nodes;
+public:
+	/// Creates an empty hierarchy
+	TriangleBVH(void)
+	{ }
+
+	/// Builds the hierarchy over the specified triangles
+	/**
+	 *  @param positions the vertex positions
+	 *  @param values_per_vertex the number of values per vertex (>= 3)
+	 *  @param triangles three vertex indices per triangle
+	 *  @param threads the number of threads building the hierarchy
+	 *    (zero means the number of hardware threads)
+	 */
+	TriangleBVH(
+		const std::vector<GLfloat>& positions,
+		GLuint values_per_vertex,
+		const std::vector<GLuint>& triangles,
+		unsigned threads = 1
+	);
+
+	/// Appends the triangles drawn by the @p instructions to @p triangles
+	/** Triangles, TriangleStrip and TriangleFan draw operations
+	 *  (with DrawArrays or DrawElements and primitive restart) are
+	 *  supported, other operations are ignored. The triangles of strips
+	 *  and fans have the same winding as when drawn by the GL.
+	 */
+	static void Triangles(
+		const DrawingInstructions& instructions,
+		const std::vector<GLuint>& indices,
+		std::vector<GLuint>& triangles
+	);
+
+	/// Builds the hierarchy over the faces of the specified shape
+	/** The @p builder can be any shape builder, including ObjMesh
+	 *  and BlenderMesh.
+	 */
+	template <class ShapeBuilder>
+	static TriangleBVH FromShape(
+		const ShapeBuilder& builder,
+		unsigned threads = 1
+	)
+	{
+		std::vector<GLfloat> positions;
+		GLuint values_per_vertex = builder.Positions(positions);
+
+		auto shape_indices = builder.Indices();
+		std::vector<GLuint> indices(
+			shape_indices.begin(),
+			shape_indices.end()
+		);
+		std::vector<GLuint> triangles;
+		Triangles(builder.Instructions(), indices, triangles);
+
+		return TriangleBVH(
+			positions,
+			values_per_vertex,
+			triangles,
+			threads
+		);
+	}
+
+	/// Returns the number of triangles
+	GLuint TriangleCount(void) const
+	{
+		return GLuint(_tri_index.size());
+	}
+
+	/// Returns the nodes of the hierarchy
+	const std::vector<BVHNode>& Nodes(void) const
+	{
+		return _nodes;
+	}
+
+	/// Finds the nearest triangle hit by a ray
+	/** Both sides of the triangles are hit. Returns false if there is
+	 *  no triangle hit closer than @p max_distance.
+	 */
+	bool Raycast(
+		const Vec3f& origin,
+		const Vec3f& direction,
+		BVHRayHit& hit,
+		GLfloat max_distance = 1e30f
+	) const;
+};
+
+} // namespace shapes
+} // namespace oglplus
+
+#if !OGLPLUS_LINK_LIBRARY || defined(OGLPLUS_IMPLEMENTING_LIBRARY)
+#include <oglplus/shapes/bvh.ipp>
+#endif // OGLPLUS_LINK_LIBRARY
+
+#endif // include guard
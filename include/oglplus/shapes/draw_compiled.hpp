@@ -0,0 +1,169 @@
+/**
+ *  @file oglplus/shapes/draw_compiled.hpp
+ *  @brief Shape draw instructions compiled into multi-draw commands
+ *
+ *  @author Matus Chochlik
+ *
+ *  Copyright 2010-2015 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#pragma once
+#ifndef OGLPLUS_SHAPES_DRAW_COMPILED_1510111200_HPP
+#define OGLPLUS_SHAPES_DRAW_COMPILED_1510111200_HPP
+
+#include <oglplus/shapes/draw.hpp>
+#include <oglplus/buffer.hpp>
+#include <oglplus/object/optional.hpp>
+
+#include <vector>
+
+namespace oglplus {
+namespace shapes {
+
+/// DrawingInstructions compiled into multi-draw command batches
+/** The consecutive draw operations of DrawingInstructions which have
+ *  the same drawing method, primitive type, primitive restart index
+ *  and phase are grouped into batches. Each batch is drawn by a single
+ *  call to @c MultiDrawElementsIndirect or @c MultiDrawArraysIndirect
+ *  with the commands stored in a buffer (if supported and enabled)
+ *  or to @c MultiDrawElements or @c MultiDrawArrays otherwise.
+ *  The primitive restart state is changed only between batches having
+ *  a different restart index and the drawing driver is called on phase
+ *  changes just like with DrawingInstructions.
+ *
+ *  The element indices must be stored in the currently bound
+ *  element array buffer.
+ *  The draw-indirect buffer binding is restored after the commands
+ *  are uploaded and after each Draw.
+ *
+ *  @see DrawingInstructions
+ *
+ *  @ingroup shapes
+ */
+class CompiledDrawingInstructions
+{
+private:
+	struct Batch_
+	{
+		ShapeDrawOperationMethod method;
+		PrimitiveType mode;
+		GLuint restart_index;
+		GLuint phase;
+		// the first operation and the number of operations
+		GLsizei first, count;
+		// the offset of the indirect commands (in GLuints)
+		GLsizei commands;
+	};
+	std::vector<Batch_> _batches;
+	std::vector<DrawOperation> _ops;
+
+	// the parameters for MultiDrawArrays/MultiDrawElements
+	std::vector<GLint> _firsts;
+	std::vector<GLsizei> _counts;
+	std::vector<const GLvoid*> _offsets;
+
+	ElementIndexInfo _index_info;
+
+	bool _indirect;
+#if OGLPLUS_DOCUMENTATION_ONLY || GL_VERSION_4_3 || GL_ARB_multi_draw_indirect
+	mutable std::vector<GLuint> _commands;
+	Optional<Buffer> _command_buf;
+	mutable GLuint _cmd_inst_count, _cmd_base_inst;
+
+	void _update_commands(GLuint inst_count, GLuint base_inst) const;
+#endif
+
+	// the current primitive restart state while drawing
+	struct RestartState_
+	{
+		bool known;
+		GLuint index;
+	};
+
+	void _restart(RestartState_& state, GLuint restart_index) const;
+	void _finish(RestartState_& state) const;
+
+	void _draw(
+		const Batch_& batch,
+		GLuint inst_count,
+		GLuint base_inst,
+		RestartState_& state
+	) const;
+
+	// binds the command buffer, returns the previous binding
+	BufferName _begin(GLuint inst_count, GLuint base_inst) const;
+	void _end(BufferName previous) const;
+public:
+	/// Compiles the specified drawing @p instructions
+	/**
+	 *  @param instructions the instructions to be compiled
+	 *  @param index_info the type of the indices in the element buffer
+	 *  @param indirect use the indirect multi-draw commands if
+	 *    supported by the used version of GL.
+	 */
+	CompiledDrawingInstructions(
+		const DrawingInstructions& instructions,
+		const ElementIndexInfo& index_info,
+		bool indirect = true
+	);
+
+	/// Returns true if the indirect multi-draw commands are used
+	bool Indirect(void) const
+	{
+		return _indirect;
+	}
+
+	/// Returns the number of the compiled draw operations
+	std::size_t OperationCount(void) const
+	{
+		return _ops.size();
+	}
+
+	/// Returns the number of batches (GL draw calls per non-instanced draw)
+	std::size_t BatchCount(void) const
+	{
+		return _batches.size();
+	}
+
+	/// Draws the shape, calls the @p driver on phase changes
+	template <typename Driver>
+	void Draw(
+		GLuint inst_count,
+		GLuint base_inst,
+		Driver driver
+	) const
+	{
+		const BufferName previous = _begin(inst_count, base_inst);
+		RestartState_ state = { false, DrawOperation::NoRestartIndex() };
+
+		auto i=_batches.begin(), e=_batches.end();
+		bool do_draw = false;
+		for(bool first=true; i!=e; ++i, first=false)
+		{
+			if(first || (i->phase != (i-1)->phase))
+			{
+				do_draw = driver(i->phase);
+			}
+			if(do_draw) _draw(*i, inst_count, base_inst, state);
+		}
+		_finish(state);
+		_end(previous);
+	}
+
+	/// Draws the shape
+	void Draw(GLuint inst_count = 1, GLuint base_inst = 0) const
+	{
+		Draw(inst_count, base_inst, DrawingInstructions::DefaultDriver());
+	}
+};
+
+} // shapes
+} // oglplus
+
+#if !OGLPLUS_LINK_LIBRARY || defined(OGLPLUS_IMPLEMENTING_LIBRARY)
+#include <oglplus/shapes/draw_compiled.ipp>
+#endif // OGLPLUS_LINK_LIBRARY
+
+#endif // include guard
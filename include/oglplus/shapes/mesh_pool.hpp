@@ -0,0 +1,379 @@
+/**
+ *  @file oglplus/shapes/mesh_pool.hpp
+ *  @brief Pool packing the vertex and index data of many shapes into shared buffers
+ *
+ *  @author Matus Chochlik
+ *
+ *  Copyright 2010-2015 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#pragma once
+#ifndef OGLPLUS_SHAPES_MESH_POOL_1510121200_HPP
+#define OGLPLUS_SHAPES_MESH_POOL_1510121200_HPP
+
+#include <oglplus/config/compiler.hpp>
+#include <oglplus/config/basic.hpp>
+#include <oglplus/string/def.hpp>
+#include <oglplus/object/optional.hpp>
+#include <oglplus/vertex_array.hpp>
+#include <oglplus/vertex_attrib.hpp>
+#include <oglplus/buffer.hpp>
+#include <oglplus/program.hpp>
+#include <oglplus/face_mode.hpp>
+
+#include <oglplus/math/sphere.hpp>
+
+#include <oglplus/shapes/draw.hpp>
+#include <oglplus/shapes/vert_attr_info.hpp>
+
+#include <vector>
+#include <utility>
+
+namespace oglplus {
+namespace shapes {
+
+#if OGLPLUS_DOCUMENTATION_ONLY || ( \
+	(GL_VERSION_3_2 || GL_ARB_draw_elements_base_vertex) && \
+	(GL_VERSION_3_1 || GL_ARB_copy_buffer) \
+)
+
+/// Occupancy statistics of a ShapeMeshPool
+struct ShapeMeshPoolStats
+{
+	/// The number of meshes stored in the pool
+	std::size_t meshes;
+
+	/// The number of vertices that fit into the vertex buffer
+	GLuint vertex_capacity;
+	/// The number of vertices used by the meshes
+	GLuint vertices_used;
+	/// The size of the largest contiguous free range of vertices
+	GLuint largest_free_vertices;
+
+	/// The number of indices that fit into the index buffer
+	GLuint index_capacity;
+	/// The number of indices used by the meshes
+	GLuint indices_used;
+	/// The size of the largest contiguous free range of indices
+	GLuint largest_free_indices;
+
+	/// The number of times the meshes were compacted in place
+	unsigned long defragmentations;
+	/// The number of times the buffers had to be enlarged
+	unsigned long growths;
+};
+
+/// Stores the vertex and index data of many shapes in shared buffers
+/** The pool stores the values of the vertex attributes specified by
+ *  their names and values-per-vertex counts in a single vertex buffer
+ *  and the indices of all added meshes in a single element buffer
+ *  referenced by a single VAO. Each mesh added from a shape builder
+ *  gets a range of vertices and a range of indices, the indices are
+ *  relative to the first vertex of the mesh which is passed as the base
+ *  vertex when drawing. This allows to draw many meshes without
+ *  re-binding the VAO, with a single @c MultiDrawElementsBaseVertex
+ *  call or @c MultiDrawElementsIndirect call per primitive type
+ *  and face winding.
+ *
+ *  The draw operations using arrays are converted to indexed draws
+ *  and the primitive restart indices of the individual shapes are
+ *  replaced by a single pool-wide restart index, so the drawing phases
+ *  of the shapes are ignored.
+ *  When an added mesh does not fit into the free space the pool either
+ *  compacts the remaining meshes or moves them into larger buffers.
+ *
+ *  @glvoereq{3,2,ARB,draw_elements_base_vertex}
+ *
+ *  @ingroup shapes
+ */
+class ShapeMeshPool
+{
+public:
+	/// The identifier of a mesh stored in the pool
+	typedef GLuint MeshID;
+private:
+	// a sorted list of free ranges of vertices or indices
+	class _Ranges
+	{
+	private:
+		std::vector<std::pair<GLuint, GLuint>> _free;
+		GLuint _capacity;
+	public:
+		void Reset(GLuint capacity, GLuint used);
+		bool Allocate(GLuint size, GLuint& offset);
+		void Free(GLuint offset, GLuint size);
+
+		GLuint Capacity(void) const
+		{
+			return _capacity;
+		}
+
+		GLuint FreeTotal(void) const;
+		GLuint LargestFree(void) const;
+	};
+
+	struct _Op
+	{
+		PrimitiveType mode;
+		// relative to the first index of the mesh
+		GLuint first, count;
+		bool restart;
+	};
+
+	struct _Mesh
+	{
+		bool alive;
+		FaceOrientation winding;
+		GLuint base_vertex, vertex_count;
+		GLuint first_index, index_count;
+		std::vector<_Op> ops;
+		Spheref bounding_sphere;
+	};
+
+	// draw calls grouped by face winding and primitive type
+	struct _Bucket
+	{
+		FaceOrientation winding;
+		PrimitiveType mode;
+		std::vector<GLsizei> counts;
+		std::vector<const GLvoid*> offsets;
+		std::vector<GLint> base_vertices;
+		std::vector<GLuint> commands;
+	};
+
+	std::vector<String> _names;
+	std::vector<GLuint> _npvs;
+	GLuint _values_per_vertex;
+
+	std::vector<_Mesh> _meshes;
+	std::vector<MeshID> _free_ids;
+	std::size_t _mesh_count;
+
+	_Ranges _vertices, _indices;
+
+	Buffer _vbo, _ibo;
+	VertexArray _vao;
+	ProgramName _prog;
+
+	bool _indirect;
+#if OGLPLUS_DOCUMENTATION_ONLY || GL_VERSION_4_3 || GL_ARB_multi_draw_indirect
+	Optional<Buffer> _cmd_buf;
+#endif
+	unsigned long _defragmentations, _growths;
+
+	// data of the mesh being added
+	std::vector<std::vector<GLfloat>> _staged_attribs;
+	std::vector<GLuint> _staged_indices;
+
+	mutable std::vector<_Bucket> _buckets;
+	mutable std::vector<GLuint> _commands;
+	mutable std::vector<MeshID> _all_ids;
+
+	GLsizeiptr _attrib_offset(
+		std::size_t attrib,
+		GLuint vertex,
+		GLuint capacity
+	) const;
+
+	void _alloc_buffers(
+		Buffer& vbo,
+		Buffer& ibo,
+		GLuint vertex_capacity,
+		GLuint index_capacity
+	);
+	void _setup_vao(void);
+	void _relocate(GLuint vertex_capacity, GLuint index_capacity);
+
+	void _stage_attrib(
+		std::size_t attrib,
+		const std::vector<GLfloat>& data,
+		GLuint npv
+	);
+
+	MeshID _add(
+		const std::vector<DrawOperation>& ops,
+		FaceOrientation winding,
+		const Spheref& bounding_sphere
+	);
+
+	_Bucket& _bucket(FaceOrientation winding, PrimitiveType mode) const;
+	void _draw(const MeshID* meshes, std::size_t count) const;
+public:
+	/// Creates a pool for the specified vertex attributes
+	/**
+	 *  @param names the names of the vertex attributes
+	 *  @param values_per_vertex the number of values per vertex for
+	 *    each of the attributes in @p names. Shape attributes with
+	 *    more values are truncated, those with fewer are zero-padded.
+	 *  @param vertex_capacity the initial number of vertices
+	 *  @param index_capacity the initial number of indices
+	 *  @param indirect use indirect draws if supported by the used
+	 *    version of GL.
+	 */
+	ShapeMeshPool(
+		const std::vector<String>& names,
+		const std::vector<GLuint>& values_per_vertex,
+		GLuint vertex_capacity = 64*1024,
+		GLuint index_capacity = 256*1024,
+		bool indirect = true
+	);
+
+#if !OGLPLUS_NO_DELETED_FUNCTIONS
+	ShapeMeshPool(const ShapeMeshPool&) = delete;
+#else
+private:
+	ShapeMeshPool(const ShapeMeshPool&);
+public:
+#endif
+
+	/// Adds the mesh built by the @p builder using the @p selector
+	template <class ShapeBuilder, class Selector>
+	MeshID Add(const ShapeBuilder& builder, Selector selector)
+	{
+		typename ShapeBuilder::VertexAttribs vert_attr_info;
+		OGLPLUS_FAKE_USE(vert_attr_info);
+
+		std::vector<GLfloat> data;
+		for(std::size_t i=0, n=_names.size(); i!=n; ++i)
+		{
+			auto getter = vert_attr_info.VertexAttribGetter(
+				data,
+				_names[i]
+			);
+			GLuint npv = 0;
+			if(getter != nullptr)
+			{
+				npv = getter(builder, data);
+			}
+			else data.clear();
+			_stage_attrib(i, data, npv);
+		}
+
+		auto indices = builder.Indices(selector);
+		_staged_indices.assign(indices.begin(), indices.end());
+
+		Spheref bounding_sphere;
+		builder.BoundingSphere(bounding_sphere);
+
+		return _add(
+			builder.Instructions(selector).Operations(),
+			builder.FaceWinding(),
+			bounding_sphere
+		);
+	}
+
+	/// Adds the mesh built by the @p builder
+	template <class ShapeBuilder>
+	MeshID Add(const ShapeBuilder& builder)
+	{
+		return Add(builder, DrawMode::Default());
+	}
+
+	/// Removes the specified mesh from the pool
+	void Remove(MeshID mesh);
+
+	/// Moves all meshes to the beginning of the buffers
+	void Defragment(void);
+
+	/// Sets up the VAO of the pool for use with the specified program
+	/** Until this function is called the i-th attribute is bound
+	 *  to the i-th vertex attribute location.
+	 */
+	void UseInProgram(ProgramName prog);
+
+	/// Returns true if the indirect draw commands are used
+	bool Indirect(void) const
+	{
+		return _indirect;
+	}
+
+	/// Returns the number of meshes in the pool
+	std::size_t MeshCount(void) const
+	{
+		return _mesh_count;
+	}
+
+	/// Returns the base vertex of the specified mesh
+	GLuint BaseVertex(MeshID mesh) const
+	{
+		return _meshes[mesh].base_vertex;
+	}
+
+	/// Returns the number of vertices of the specified mesh
+	GLuint VertexCount(MeshID mesh) const
+	{
+		return _meshes[mesh].vertex_count;
+	}
+
+	/// Returns the position of the first index of the specified mesh
+	GLuint FirstIndex(MeshID mesh) const
+	{
+		return _meshes[mesh].first_index;
+	}
+
+	/// Returns the number of indices of the specified mesh
+	GLuint IndexCount(MeshID mesh) const
+	{
+		return _meshes[mesh].index_count;
+	}
+
+	/// Returns the bounding sphere of the specified mesh
+	const Spheref& BoundingSphere(MeshID mesh) const
+	{
+		return _meshes[mesh].bounding_sphere;
+	}
+
+	/// Returns the vertex buffer of the pool
+	const Buffer& VertexBuffer(void) const
+	{
+		return _vbo;
+	}
+
+	/// Returns the element index buffer of the pool
+	const Buffer& IndexBuffer(void) const
+	{
+		return _ibo;
+	}
+
+	/// Returns the offset (in bytes) of an attribute in the vertex buffer
+	GLsizeiptr AttribOffset(std::size_t attrib) const
+	{
+		return _attrib_offset(attrib, 0, _vertices.Capacity());
+	}
+
+	/// Draws the specified meshes
+	/** If the indirect draw commands are used, the base instance
+	 *  of each mesh is set to its position in the @p meshes list.
+	 *  The VAO of the pool stays bound after the call, the previous
+	 *  draw-indirect buffer binding is restored.
+	 */
+	void Draw(const std::vector<MeshID>& meshes) const
+	{
+		_draw(meshes.data(), meshes.size());
+	}
+
+	/// Draws the specified mesh
+	void Draw(MeshID mesh) const
+	{
+		_draw(&mesh, 1);
+	}
+
+	/// Draws all meshes in the pool
+	void DrawAll(void) const;
+
+	/// Returns the current occupancy statistics
+	ShapeMeshPoolStats Stats(void) const;
+};
+
+#endif // base vertex && copy buffer
+
+} // shapes
+} // oglplus
+
+#if !OGLPLUS_LINK_LIBRARY || defined(OGLPLUS_IMPLEMENTING_LIBRARY)
+#include <oglplus/shapes/mesh_pool.ipp>
+#endif // OGLPLUS_LINK_LIBRARY
+
+#endif // include guard
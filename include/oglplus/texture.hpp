@@ -1470,6 +1470,46 @@ public:
 		GLint border = 0
 	);
 
+	/// Specifies all levels of a texture image
+	/** Uploads the levels of the mipmap chain and sets the texture
+	 *  max level accordingly. For the cube map target the chain
+	 *  must be layered and the depth of the images must be 6,
+	 *  the layers are uploaded as the faces of the cube map.
+	 *  Otherwise std::runtime_error is thrown.
+	 *
+	 *  @glsymbols
+	 *  @glfunref{TexImage3D}
+	 *  @glfunref{TexImage2D}
+	 *  @glfunref{TexImage1D}
+	 *  @glfunref{TexParameter}
+	 *  @gldefref{TEXTURE_MAX_LEVEL}
+	 */
+	static void Image(
+		Target target,
+		const images::MipmapChain& mipmaps
+	);
+
+	/// Specifies all levels, layers and faces of a texture image
+	/** Uploads the (compressed or uncompressed) images stored in a KTX
+	 *  or DDS container and sets the texture max level accordingly.
+	 *  The data is passed to GL directly from the mapped file when
+	 *  the layers of a level are contiguous. The unpack alignment
+	 *  is set to the row alignment of the container.
+	 *
+	 *  @glsymbols
+	 *  @glfunref{TexImage3D}
+	 *  @glfunref{TexImage2D}
+	 *  @glfunref{CompressedTexImage3D}
+	 *  @glfunref{CompressedTexImage2D}
+	 *  @glfunref{PixelStore}
+	 *  @glfunref{TexParameter}
+	 *  @gldefref{TEXTURE_MAX_LEVEL}
+	 */
+	static void Image(
+		Target target,
+		const images::ImageContainer& container
+	);
+
 	/// Copies a two dimensional texture image from the framebuffer
 	/**
 	 *  @glsymbols
@@ -1642,6 +1682,36 @@ public:
 	}
 #endif // GL_VERSION_3_0
 
+	/// Specifies a block-compressed texture image
+	/** For the cube map target the depth of the image must be 6
+	 *  and the layers are uploaded as the faces of the cube map.
+	 *
+	 *  @glsymbols
+	 *  @glfunref{CompressedTexImage3D}
+	 *  @glfunref{CompressedTexImage2D}
+	 */
+	static void CompressedImage(
+		Target target,
+		const images::CompressedImage& image,
+		GLint level = 0,
+		GLint border = 0
+	);
+
+	/// Specifies all levels of a block-compressed texture image
+	/** Uploads the levels of the compressed mipmap chain and sets
+	 *  the texture max level accordingly.
+	 *
+	 *  @glsymbols
+	 *  @glfunref{CompressedTexImage3D}
+	 *  @glfunref{CompressedTexImage2D}
+	 *  @glfunref{TexParameter}
+	 *  @gldefref{TEXTURE_MAX_LEVEL}
+	 */
+	static void CompressedImage(
+		Target target,
+		const images::CompressedMipmapChain& mipmaps
+	);
+
 	/// Specifies a three dimensional compressed texture image
 	/**
 	 *  @glsymbols
@@ -3247,6 +3317,46 @@ inline TextureTarget operator << (
 	return target;
 }
 
+// Mipmap chain
+inline TextureTarget operator << (
+	TextureTarget target,
+	const images::MipmapChain& mipmaps
+)
+{
+	DefaultTextureOps::Image(target, mipmaps);
+	return target;
+}
+
+// Image container
+inline TextureTarget operator << (
+	TextureTarget target,
+	const images::ImageContainer& container
+)
+{
+	DefaultTextureOps::Image(target, container);
+	return target;
+}
+
+// Compressed image
+inline TextureTarget operator << (
+	TextureTarget target,
+	const images::CompressedImage& image
+)
+{
+	DefaultTextureOps::CompressedImage(target, image);
+	return target;
+}
+
+// Compressed mipmap chain
+inline TextureTarget operator << (
+	TextureTarget target,
+	const images::CompressedMipmapChain& mipmaps
+)
+{
+	DefaultTextureOps::CompressedImage(target, mipmaps);
+	return target;
+}
+
 // Image + Level
 inline TextureTarget operator << (
 	TextureTargetAndSlot tas,
@@ -0,0 +1,238 @@
+/**
+ *  @file oglplus/texture_streamer.hpp
+ *  @brief Streaming of texture images through a pixel unpack buffer ring
+ *
+ *  @author Matus Chochlik
+ *
+ *  Copyright 2010-2015 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#pragma once
+#ifndef OGLPLUS_TEXTURE_STREAMER_1510041000_HPP
+#define OGLPLUS_TEXTURE_STREAMER_1510041000_HPP
+
+#include <oglplus/config/compiler.hpp>
+#include <oglplus/buffer.hpp>
+#include <oglplus/texture.hpp>
+#include <oglplus/detail/fence_ring.hpp>
+#include <oglplus/images/image.hpp>
+
+#include <deque>
+#include <cstddef>
+#if !OGLPLUS_NO_THREADS
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#endif
+
+namespace oglplus {
+
+#if OGLPLUS_DOCUMENTATION_ONLY || GL_VERSION_4_4 || GL_ARB_buffer_storage
+
+/// Statistics of a TextureStreamer
+struct TextureStreamerStats
+{
+	/// The number of images uploaded from the ring buffer
+	unsigned long uploads;
+
+	/// The number of images too large for the ring uploaded directly
+	unsigned long direct_uploads;
+
+	/// The number of bytes copied into the ring buffer
+	unsigned long long bytes;
+
+	/// The number of fences placed after batches of uploads
+	unsigned long fences;
+
+	/// The number of times that Upload waited for free ring space
+	unsigned long stalls;
+
+	/// The time (in seconds) spent waiting for free ring space
+	double stall_time;
+
+	/// The time (in seconds) spent copying the images into the ring
+	double copy_time;
+};
+
+/// Streams texture images through a persistently mapped buffer ring
+/** The TextureStreamer owns a pixel unpack buffer with immutable storage
+ *  which is mapped persistently and used as a ring. Upload reserves
+ *  a segment of the ring for an image and a worker thread copies the
+ *  rows of the image into the mapped memory. Poll issues the texture
+ *  sub-image updates for the images that were already copied, sourcing
+ *  the pixels from the buffer offsets, and places a Sync fence after
+ *  each batch. The segments are recycled once their fences signal.
+ *  If the ring is full, Upload waits for the oldest fence (a stall).
+ *
+ *  The rows are copied with four byte alignment. The unpack alignment,
+ *  texture and pixel unpack buffer bindings are restored after each
+ *  batch, the other pixel unpack parameters must have the default values.
+ *
+ *  @code
+ *  TextureStreamer streamer(64*1024*1024);
+ *  for(auto& tile: tiles)
+ *  {
+ *    streamer.Upload(tile.texture, Texture::Target::_2D, tile.LoadImage());
+ *    streamer.Poll();
+ *  }
+ *  streamer.Finish();
+ *  @endcode
+ *
+ *  @note The streamer must be used and destroyed in the thread
+ *  where the GL context is current. Pending uploads which were not
+ *  issued by Poll or Finish are discarded on destruction.
+ *
+ *  @glvoereq{4,4,ARB,buffer_storage}
+ */
+class TextureStreamer
+{
+private:
+	struct _upload
+	{
+		images::Image image;
+		TextureTarget target;
+		GLuint texture;
+		GLint level, xoffs, yoffs, zoffs;
+		std::size_t offset, stride, reserved;
+		double copy_time;
+		bool copied;
+
+		_upload(
+			images::Image&& img,
+			TextureTarget tgt,
+			GLuint tex
+		): image(std::move(img))
+		 , target(tgt)
+		 , texture(tex)
+		 , level(0)
+		 , xoffs(0)
+		 , yoffs(0)
+		 , zoffs(0)
+		 , offset(0)
+		 , stride(0)
+		 , reserved(0)
+		 , copy_time(0)
+		 , copied(false)
+		{ }
+	};
+
+	Buffer _buffer;
+	GLubyte* _mapped;
+	aux::FenceRing _ring;
+
+	std::deque<_upload> _uploads;
+	TextureStreamerStats _stats;
+
+#if !OGLPLUS_NO_THREADS
+	std::mutex _mutex;
+	std::condition_variable _copy_cv, _done_cv;
+	std::deque<_upload*> _copy_queue;
+	bool _stop;
+	std::thread _worker;
+
+	void _work(void);
+#endif
+	static double _copy(GLubyte* dest, _upload& upload);
+
+	void _reserve(_upload& upload);
+	std::size_t _issue(bool wait);
+	static GLuint _dimensions(TextureTarget target);
+	static void _sub_image(const _upload& upload, const void* data);
+	static void _direct(const _upload& upload);
+public:
+	/// Creates a streamer with a ring buffer of the specified size
+	/**
+	 *  @glsymbols
+	 *  @glfunref{BufferStorage}
+	 *  @glfunref{MapBufferRange}
+	 */
+	explicit TextureStreamer(std::size_t ring_size = 16*1024*1024);
+
+#if !OGLPLUS_NO_DELETED_FUNCTIONS
+	TextureStreamer(const TextureStreamer&) = delete;
+#else
+private:
+	TextureStreamer(const TextureStreamer&);
+public:
+#endif
+
+	/// Stops the worker thread
+	~TextureStreamer(void);
+
+	/// Returns the size of the ring buffer in bytes
+	std::size_t RingSize(void) const
+	{
+		return _ring.Size();
+	}
+
+	/// Returns the number of bytes of the ring currently in use
+	std::size_t RingUsed(void) const
+	{
+		return _ring.Used();
+	}
+
+	/// Queues the upload of an @p image into a @p texture
+	/** The image is copied into the ring asynchronously, pass
+	 *  a temporary (or moved) image to avoid copying it here.
+	 *  The texture target determines if the image is uploaded
+	 *  by SubImage2D or SubImage3D (the @p zoffs is ignored
+	 *  by two dimensional targets). Images larger than the ring
+	 *  are uploaded directly from the client memory.
+	 *
+	 *  @throws std::runtime_error if the @p target is one dimensional.
+	 *
+	 *  @glsymbols
+	 *  @glfunref{ClientWaitSync}
+	 */
+	void Upload(
+		TextureName texture,
+		TextureTarget target,
+		images::Image image,
+		GLint level = 0,
+		GLint xoffs = 0,
+		GLint yoffs = 0,
+		GLint zoffs = 0
+	);
+
+	/// Returns the number of queued uploads that were not issued yet
+	std::size_t Pending(void) const
+	{
+		return _uploads.size();
+	}
+
+	/// Issues the copied uploads and recycles the signaled segments
+	/** Returns the number of issued uploads. Does not wait for
+	 *  the copies that are still in progress.
+	 *
+	 *  @glsymbols
+	 *  @glfunref{TexSubImage2D}
+	 *  @glfunref{TexSubImage3D}
+	 *  @glfunref{FenceSync}
+	 *  @glfunref{GetSync}
+	 */
+	std::size_t Poll(void);
+
+	/// Waits for all copies and issues all queued uploads
+	void Finish(void);
+
+	/// Returns the streaming statistics
+	const TextureStreamerStats& Stats(void) const
+	{
+		return _stats;
+	}
+
+	/// Resets the statistics
+	void ResetStats(void);
+};
+
+#endif // buffer storage
+
+} // namespace oglplus
+
+#if !OGLPLUS_LINK_LIBRARY || defined(OGLPLUS_IMPLEMENTING_LIBRARY)
+#include <oglplus/texture_streamer.ipp>
+#endif // OGLPLUS_LINK_LIBRARY
+
+#endif // include guard
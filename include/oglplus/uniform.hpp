@@ -17,6 +17,7 @@
 #include <oglplus/string/ref.hpp>
 #include <oglplus/error/prog_var.hpp>
 #include <oglplus/prog_var/location.hpp>
+#include <oglplus/prog_var/cache.hpp>
 #include <oglplus/prog_var/varpara_fns.hpp>
 #include <oglplus/prog_var/set_ops.hpp>
 #include <oglplus/prog_var/wrapper.hpp>
@@ -46,6 +47,12 @@ public:
 		bool active_only
 	)
 	{
+#if OGLPLUS_CACHE_PROG_VARS
+		GLint result = ProgVarCache::UniformLocation(
+			program,
+			identifier
+		);
+#else
 		GLint result = OGLPLUS_GLFUNC(GetUniformLocation)(
 			GetGLName(program),
 			identifier.c_str()
@@ -56,6 +63,7 @@ public:
 			Program(program).
 			Identifier(identifier)
 		);
+#endif
 		OGLPLUS_HANDLE_ERROR_IF(
 			active_only && (result < 0),
 			GL_INVALID_OPERATION,
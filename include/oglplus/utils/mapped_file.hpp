@@ -0,0 +1,203 @@
+/**
+ *  .file oglplus/utils/mapped_file.hpp
+ *  .brief Helper read-only memory-mapped file
+ *
+ *  @author Matus Chochlik
+ *
+ *  Copyright 2010-2015 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#pragma once
+#ifndef OGLPLUS_UTILS_MAPPED_FILE_1510031120_HPP
+#define OGLPLUS_UTILS_MAPPED_FILE_1510031120_HPP
+
+#include <oglplus/config/compiler.hpp>
+
+#include <fstream>
+#include <istream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <cstddef>
+
+#if defined(WIN32) || defined(_WIN32) || defined(WIN64) || defined(_WIN64)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#define OGLPLUS_MAPPED_FILE_WIN32 1
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#define OGLPLUS_MAPPED_FILE_WIN32 0
+#endif
+
+namespace oglplus {
+namespace aux {
+
+// The contents of a file mapped read-only into memory,
+// or read into a buffer if the file cannot be mapped
+class MappedFile
+{
+private:
+	const unsigned char* _data;
+	std::size_t _size;
+	bool _mapped;
+	std::vector<unsigned char> _buffer;
+
+	void _read(std::istream& input)
+	{
+		_buffer.assign(
+			std::istreambuf_iterator<char>(input),
+			std::istreambuf_iterator<char>()
+		);
+		_data = _buffer.data();
+		_size = _buffer.size();
+	}
+
+	bool _map(const std::string& path)
+	{
+#if OGLPLUS_MAPPED_FILE_WIN32
+		HANDLE file = ::CreateFileA(
+			path.c_str(),
+			GENERIC_READ,
+			FILE_SHARE_READ,
+			NULL,
+			OPEN_EXISTING,
+			FILE_ATTRIBUTE_NORMAL,
+			NULL
+		);
+		if(file == INVALID_HANDLE_VALUE) return false;
+		LARGE_INTEGER size;
+		HANDLE mapping = NULL;
+		if(::GetFileSizeEx(file, &size) && (size.QuadPart > 0))
+		{
+			mapping = ::CreateFileMappingA(
+				file,
+				NULL,
+				PAGE_READONLY,
+				0, 0,
+				NULL
+			);
+		}
+		::CloseHandle(file);
+		if(mapping == NULL) return false;
+		void* view = ::MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+		::CloseHandle(mapping);
+		if(view == NULL) return false;
+		_size = std::size_t(size.QuadPart);
+#else
+		int fd = ::open(path.c_str(), O_RDONLY);
+		if(fd < 0) return false;
+		struct stat st;
+		void* view = MAP_FAILED;
+		if((::fstat(fd, &st) == 0) && (st.st_size > 0))
+		{
+			view = ::mmap(
+				nullptr,
+				std::size_t(st.st_size),
+				PROT_READ,
+				MAP_PRIVATE,
+				fd, 0
+			);
+		}
+		::close(fd);
+		if(view == MAP_FAILED) return false;
+		_size = std::size_t(st.st_size);
+#endif
+		_data = static_cast<const unsigned char*>(view);
+		_mapped = true;
+		return true;
+	}
+
+	void _unmap(void)
+	{
+		if(_mapped)
+		{
+#if OGLPLUS_MAPPED_FILE_WIN32
+			::UnmapViewOfFile(_data);
+#else
+			::munmap(const_cast<unsigned char*>(_data), _size);
+#endif
+			_mapped = false;
+		}
+	}
+
+	MappedFile(const MappedFile&);
+	MappedFile& operator = (const MappedFile&);
+public:
+	// Maps the file at the specified path
+	explicit MappedFile(const std::string& path)
+	 : _data(nullptr)
+	 , _size(0)
+	 , _mapped(false)
+	{
+		if(!_map(path))
+		{
+			// empty files, pipes, etc. cannot be mapped
+			std::ifstream input(path.c_str(), std::ios::binary);
+			if(!input.good())
+			{
+				throw std::runtime_error(
+					"Unable to open file '"+path+"'"
+				);
+			}
+			_read(input);
+		}
+	}
+
+	// Reads the rest of the specified input stream
+	explicit MappedFile(std::istream& input)
+	 : _data(nullptr)
+	 , _size(0)
+	 , _mapped(false)
+	{
+		_read(input);
+	}
+
+	MappedFile(MappedFile&& tmp)
+	 : _data(tmp._data)
+	 , _size(tmp._size)
+	 , _mapped(tmp._mapped)
+	 , _buffer(std::move(tmp._buffer))
+	{
+		if(!_mapped) _data = _buffer.data();
+		tmp._data = nullptr;
+		tmp._size = 0;
+		tmp._mapped = false;
+	}
+
+	~MappedFile(void)
+	{
+		_unmap();
+	}
+
+	// Returns true if the file is mapped rather than read into a buffer
+	bool IsMapped(void) const
+	{
+		return _mapped;
+	}
+
+	const unsigned char* Data(void) const
+	{
+		return _data;
+	}
+
+	std::size_t Size(void) const
+	{
+		return _size;
+	}
+};
+
+} // namespace aux
+} // namespace oglplus
+
+#endif // include guard
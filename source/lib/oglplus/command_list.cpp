@@ -0,0 +1,21 @@
+/**
+ *  .file lib/oglplus/command_list.cpp
+ *  .brief Deferred command lists
+ *
+ *  @author Matus Chochlik
+ *
+ *  Copyright 2010-2015 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#include "prologue.ipp"
+#include <oglplus/glfunc.hpp>
+#include <oglplus/buffer_target.hpp>
+#include <oglplus/texture_target.hpp>
+#include <oglplus/capability.hpp>
+#include <oglplus/primitive_type.hpp>
+#include <oglplus/data_type.hpp>
+#include "implement.ipp"
+#include <oglplus/command_list.hpp>
+#include "epilogue.ipp"
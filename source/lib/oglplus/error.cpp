@@ -19,6 +19,7 @@
 
 #include "implement.ipp"
 
+#include <oglplus/error/policy.hpp>
 #include <oglplus/error/basic.hpp>
 #include <oglplus/error/glfunc.hpp>
 #include <oglplus/error/limit.hpp>
@@ -26,4 +27,5 @@
 #include <oglplus/error/program.hpp>
 #include <oglplus/error/prog_var.hpp>
 #include <oglplus/error/framebuffer.hpp>
+#include <oglplus/error/deferred.hpp>
 #include "epilogue.ipp"
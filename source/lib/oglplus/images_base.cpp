@@ -19,6 +19,8 @@
 #include "implement.ipp"
 
 #include <oglplus/images/image.hpp>
+#include <oglplus/images/mipmap.hpp>
+#include <oglplus/images/compressed.hpp>
 #include <oglplus/images/brushed_metal.hpp>
 #include <oglplus/images/checker.hpp>
 #include <oglplus/images/metaballs.hpp>
@@ -19,6 +19,7 @@
 
 #include "implement.ipp"
 
+#include <oglplus/images/container.hpp>
 #include <oglplus/images/xpm.hpp>
 #if OGLPLUS_PNG_FOUND
 #include <oglplus/images/png.hpp>
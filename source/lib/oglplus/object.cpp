@@ -49,6 +49,8 @@
 #include <oglplus/framebuffer.hpp>
 #include <oglplus/renderbuffer.hpp>
 #include <oglplus/transform_feedback.hpp>
+#include <oglplus/buffer_ring.hpp>
+#include <oglplus/texture_streamer.hpp>
 #include <oglplus/dsa/ext/buffer.hpp>
 #include <oglplus/dsa/ext/framebuffer.hpp>
 #include <oglplus/dsa/ext/renderbuffer.hpp>
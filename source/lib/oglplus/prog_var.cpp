@@ -23,6 +23,8 @@
 
 #include "implement.ipp"
 
+#include <oglplus/prog_var/cache.hpp>
+#include <oglplus/prog_var/shadow.hpp>
 #include <oglplus/prog_var/typecheck.hpp>
 #include <oglplus/uniform.hpp>
 #include <oglplus/uniform_block.hpp>
@@ -36,4 +36,6 @@
 #include <oglplus/program.hpp>
 #include <oglplus/program_resource.hpp>
 #include <oglplus/program_pipeline.hpp>
+#include <oglplus/program_binary_cache.hpp>
+#include <oglplus/async_builder.hpp>
 #include "epilogue.ipp"
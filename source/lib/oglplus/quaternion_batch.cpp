@@ -0,0 +1,15 @@
+/**
+ *  .file lib/oglplus/quaternion_batch.cpp
+ *  .brief Batch operations on arrays of quaternions
+ *
+ *  @author Matus Chochlik
+ *
+ *  Copyright 2010-2015 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#include "prologue.ipp"
+#include "implement.ipp"
+#include <oglplus/quaternion_batch.hpp>
+#include "epilogue.ipp"
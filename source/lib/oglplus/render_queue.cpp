@@ -0,0 +1,16 @@
+/**
+ *  .file lib/oglplus/render_queue.cpp
+ *  .brief Render queue
+ *
+ *  @author Matus Chochlik
+ *
+ *  Copyright 2010-2015 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#include "prologue.ipp"
+#include <oglplus/client_context.hpp>
+#include "implement.ipp"
+#include <oglplus/render_queue.hpp>
+#include "epilogue.ipp"
@@ -28,7 +28,10 @@
 #include "implement.ipp"
 
 #include <oglplus/shapes/draw.hpp>
+#include <oglplus/shapes/draw_compiled.hpp>
 #include <oglplus/shapes/wrapper.hpp>
+#include <oglplus/shapes/mesh_pool.hpp>
+#include <oglplus/shapes/bvh.hpp>
 #include <oglplus/shapes/analyzer.hpp>
 #include <oglplus/shapes/analyzer_data.hpp>
 #include "epilogue.ipp"
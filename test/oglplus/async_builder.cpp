@@ -0,0 +1,204 @@
+/**
+ *  .file test/oglplus/async_builder.cpp
+ *  .brief Test case for the asynchronous shader and program builder.
+ *
+ *  .author Matus Chochlik
+ *
+ *  Copyright 2011-2015 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE OGLPLUS_AsyncBuilding
+#include <boost/test/unit_test.hpp>
+
+#define OGLPLUS_USE_GL_DISPATCH 1
+
+#include <oglplus/gl.hpp>
+#include <oglplus/config/fix_gl_version.hpp>
+#include <oglplus/shader.hpp>
+#include <oglplus/program.hpp>
+#include <oglplus/async_builder.hpp>
+#include <oglplus/dispatch/recorder.hpp>
+
+#include <cstring>
+#include <map>
+
+// GL_COMPLETION_STATUS_{KHR,ARB}
+static const GLenum completion_status = 0x91B1;
+
+// headless recorder emulating a GL compiling the shaders in the background
+class ParallelRecorder
+ : public oglplus::GLHeadlessRecorder
+{
+private:
+	bool _parallel;
+	std::map<GLuint, int> _remaining;
+	GLuint _failing;
+	int _polls;
+
+	template <typename T>
+	static T* _out(oglplus::GLCallInfo& call, std::size_t i)
+	{
+		return static_cast<T*>(call.args[i].value.p);
+	}
+protected:
+	void Emulate(oglplus::GLCallInfo& call)
+	{
+		oglplus::GLHeadlessRecorder::Emulate(call);
+		const GLuint name = GLuint(call.args[0].value.i);
+		if(std::strcmp(call.name, "GetStringi") == 0)
+		{
+			call.result.value.p = const_cast<char*>(
+				"GL_KHR_parallel_shader_compile"
+			);
+		}
+		else if(
+			(std::strcmp(call.name, "CompileShader") == 0) ||
+			(std::strcmp(call.name, "LinkProgram") == 0)
+		)
+		{
+			_remaining[name] = _polls;
+		}
+		else if(
+			(std::strcmp(call.name, "GetShaderiv") == 0) ||
+			(std::strcmp(call.name, "GetProgramiv") == 0)
+		)
+		{
+			switch(GLenum(call.args[1].value.i))
+			{
+				case completion_status:
+					*_out<GLint>(call, 2) =
+						(_remaining[name]-- <= 0)?
+						GL_TRUE:GL_FALSE;
+					break;
+				case GL_COMPILE_STATUS:
+				case GL_LINK_STATUS:
+					*_out<GLint>(call, 2) =
+						(name == _failing)?
+						GL_FALSE:GL_TRUE;
+					break;
+				default:;
+			}
+		}
+	}
+public:
+	ParallelRecorder(bool parallel)
+	 : _parallel(parallel)
+	 , _failing(0)
+	 , _polls(0)
+	{
+		SetInteger(GL_NUM_EXTENSIONS, _parallel?1:0);
+	}
+
+	// the number of completion queries returning false after a build
+	void SetPolls(int polls)
+	{
+		_polls = polls;
+	}
+
+	void SetFailing(GLuint name)
+	{
+		_failing = name;
+	}
+};
+
+BOOST_AUTO_TEST_SUITE(AsyncBuilding)
+
+BOOST_AUTO_TEST_CASE(AsyncBuilding_deferred_status)
+{
+	using namespace oglplus;
+
+	ParallelRecorder recorder(true);
+	GLDispatchBackendScope scope(recorder);
+
+	VertexShader vs;
+	FragmentShader fs;
+	Program prog;
+	prog.AttachShader(vs).AttachShader(fs);
+
+	AsyncBuilder builder;
+	BOOST_CHECK(builder.CanPoll());
+
+	recorder.SetPolls(2);
+	recorder.Clear();
+
+	bool linked = false;
+	builder.Compile(vs).Compile(fs);
+	builder.Link(prog, [&linked](bool status) { linked = status; });
+
+	// nothing waits for the results when the builds are submitted
+	BOOST_CHECK_EQUAL(recorder.CountOf("CompileShader"), 2u);
+	BOOST_CHECK_EQUAL(recorder.CountOf("LinkProgram"), 1u);
+	BOOST_CHECK_EQUAL(recorder.CountOf("GetShaderiv"), 0u);
+	BOOST_CHECK_EQUAL(recorder.CountOf("GetProgramiv"), 0u);
+	BOOST_CHECK_EQUAL(builder.Pending(), 3u);
+
+	BOOST_CHECK_EQUAL(builder.Poll(), 0u);
+	BOOST_CHECK_EQUAL(builder.Poll(), 0u);
+	BOOST_CHECK(!linked);
+	BOOST_CHECK_EQUAL(builder.Poll(), 3u);
+	BOOST_CHECK_EQUAL(builder.Pending(), 0u);
+	BOOST_CHECK(linked);
+}
+
+BOOST_AUTO_TEST_CASE(AsyncBuilding_failure)
+{
+	using namespace oglplus;
+
+	ParallelRecorder recorder(true);
+	GLDispatchBackendScope scope(recorder);
+
+	VertexShader vs;
+	FragmentShader fs;
+	Program prog;
+
+	AsyncBuilder builder;
+	recorder.SetFailing(GetGLName(fs));
+
+	bool compiled = true;
+	builder.Compile(vs);
+	builder.Compile(fs, [&compiled](bool status) { compiled = status; });
+	builder.Poll();
+	BOOST_CHECK(!compiled);
+
+	// without a callback the failure is reported by an exception
+	builder.Compile(vs).Compile(fs).Link(prog);
+	BOOST_CHECK_THROW(builder.Poll(), CompileError);
+	// and the remaining builds can be still polled
+	BOOST_CHECK_EQUAL(builder.Pending(), 1u);
+	BOOST_CHECK_EQUAL(builder.Poll(), 1u);
+
+	recorder.SetFailing(GetGLName(prog));
+	builder.Link(prog);
+	BOOST_CHECK_THROW(builder.Finish(), LinkError);
+	BOOST_CHECK_EQUAL(builder.Pending(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(AsyncBuilding_no_extension)
+{
+	using namespace oglplus;
+
+	ParallelRecorder recorder(false);
+	GLDispatchBackendScope scope(recorder);
+
+	VertexShader vs;
+	Program prog;
+
+	AsyncBuilder builder;
+	BOOST_CHECK(!builder.CanPoll());
+
+	recorder.SetPolls(5);
+	builder.Compile(vs).Link(prog);
+	BOOST_CHECK_EQUAL(builder.Poll(), 2u);
+	BOOST_CHECK_EQUAL(builder.Pending(), 0u);
+
+	// the synchronous functions query the status immediately
+	recorder.Clear();
+	vs.Compile();
+	prog.Link();
+	BOOST_CHECK_EQUAL(recorder.CountOf("GetShaderiv"), 1u);
+	BOOST_CHECK_EQUAL(recorder.CountOf("GetProgramiv"), 1u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
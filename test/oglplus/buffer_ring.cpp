@@ -0,0 +1,150 @@
+/**
+ *  .file test/oglplus/buffer_ring.cpp
+ *  .brief Test case for the persistently mapped buffer ring.
+ *
+ *  .author Matus Chochlik
+ *
+ *  Copyright 2011-2015 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE OGLPLUS_BufferRing
+#include <boost/test/unit_test.hpp>
+
+#define OGLPLUS_USE_GL_DISPATCH 1
+
+#include <oglplus/gl.hpp>
+#include <oglplus/config/fix_gl_version.hpp>
+#include <oglplus/buffer_ring.hpp>
+#include <oglplus/dispatch/recorder.hpp>
+
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+// headless recorder emulating the persistent mapping and the fences
+class MappingRecorder
+ : public oglplus::GLHeadlessRecorder
+{
+private:
+	std::vector<GLubyte> _mapped;
+public:
+	bool signaled;
+
+	MappingRecorder(void)
+	 : signaled(true)
+	{ }
+
+	const GLubyte* Mapped(void) const
+	{
+		return _mapped.data();
+	}
+protected:
+	void Emulate(oglplus::GLCallInfo& call)
+	{
+		oglplus::GLHeadlessRecorder::Emulate(call);
+		if(std::strcmp(call.name, "MapBufferRange") == 0)
+		{
+			_mapped.resize(std::size_t(call.args[2].value.i));
+			call.result.value.p = _mapped.data();
+		}
+		else if(std::strcmp(call.name, "GetSynciv") == 0)
+		{
+			*static_cast<GLint*>(call.args[4].value.p) =
+				signaled?GL_SIGNALED:GL_UNSIGNALED;
+		}
+	}
+};
+
+BOOST_AUTO_TEST_SUITE(BufferRing)
+
+BOOST_AUTO_TEST_CASE(BufferRing_allocate)
+{
+	using namespace oglplus;
+
+	MappingRecorder recorder;
+	GLDispatchBackendScope scope(recorder);
+	recorder.SetInteger(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, 256);
+
+	oglplus::BufferRing ring(BufferTarget::Array, 4096);
+	BOOST_CHECK_EQUAL(ring.Size(), 4096u);
+	BOOST_CHECK_EQUAL(ring.UniformAlignment(), 256u);
+	BOOST_CHECK_EQUAL(recorder.CountOf("BufferStorage"), 1u);
+	BOOST_CHECK_EQUAL(recorder.CountOf("MapBufferRange"), 1u);
+
+	const GLfloat vertices[3] = {1.0f, 2.0f, 3.0f};
+	BufferRingRange a = ring.Copy(vertices, sizeof(vertices));
+	BufferRingRange b = ring.Allocate(10, 4);
+	BufferRingRange c = ring.AllocateUniform(64);
+
+	BOOST_CHECK_EQUAL(a.Offset().Get(), 0);
+	BOOST_CHECK_EQUAL(b.Offset().Get(), 12);
+	BOOST_CHECK_EQUAL(c.Offset().Get(), 256);
+	BOOST_CHECK_EQUAL(c.Size().Get(), 64);
+	BOOST_CHECK(b.Data() == recorder.Mapped()+12);
+	BOOST_CHECK(std::memcmp(
+		recorder.Mapped(),
+		vertices,
+		sizeof(vertices)
+	) == 0);
+	BOOST_CHECK_EQUAL(ring.Used(), 320u);
+
+	ring.EndFrame();
+	BOOST_CHECK_EQUAL(recorder.CountOf("FenceSync"), 1u);
+	BOOST_CHECK_EQUAL(ring.Used(), 0u);
+	BOOST_CHECK_EQUAL(ring.InFlightFrames(), 0u);
+
+	// empty frames are not fenced
+	ring.EndFrame();
+	BOOST_CHECK_EQUAL(recorder.CountOf("FenceSync"), 1u);
+
+	const BufferRingStats& stats = ring.Stats();
+	BOOST_CHECK_EQUAL(stats.allocations, 3u);
+	BOOST_CHECK_EQUAL(stats.bytes, 12u+10u+64u);
+	BOOST_CHECK_EQUAL(stats.frames, 1u);
+	BOOST_CHECK_EQUAL(stats.waits, 0u);
+	BOOST_CHECK_EQUAL(stats.peak_used, 320u);
+}
+
+BOOST_AUTO_TEST_CASE(BufferRing_wrap_and_wait)
+{
+	using namespace oglplus;
+
+	MappingRecorder recorder;
+	GLDispatchBackendScope scope(recorder);
+	recorder.signaled = false;
+
+	oglplus::BufferRing ring(BufferTarget::Uniform, 1000);
+
+	// the frames stay in-flight
+	BOOST_CHECK_EQUAL(ring.Allocate(400).Offset().Get(), 0);
+	ring.EndFrame();
+	BOOST_CHECK_EQUAL(ring.Allocate(400).Offset().Get(), 400);
+	ring.EndFrame();
+	BOOST_CHECK_EQUAL(ring.InFlightFrames(), 2u);
+	BOOST_CHECK_EQUAL(recorder.CountOf("ClientWaitSync"), 0u);
+
+	// does not fit at the end of the ring, waits for the first frame
+	BOOST_CHECK_EQUAL(ring.Allocate(300).Offset().Get(), 0);
+	BOOST_CHECK_EQUAL(recorder.CountOf("ClientWaitSync"), 1u);
+	BOOST_CHECK_EQUAL(ring.InFlightFrames(), 1u);
+	BOOST_CHECK_EQUAL(ring.Used(), 400u+200u+300u);
+	BOOST_CHECK_EQUAL(ring.Stats().waits, 1u);
+
+	// waits for the second frame
+	BOOST_CHECK_EQUAL(ring.Allocate(100).Offset().Get(), 304);
+	BOOST_CHECK_EQUAL(recorder.CountOf("ClientWaitSync"), 2u);
+	BOOST_CHECK_EQUAL(ring.Stats().waits, 2u);
+	BOOST_CHECK_EQUAL(ring.Stats().peak_used, 900u);
+
+	// the data of a single frame must fit into the ring
+	BOOST_CHECK_THROW(ring.Allocate(800), std::runtime_error);
+
+	recorder.signaled = true;
+	ring.EndFrame();
+	BOOST_CHECK_EQUAL(ring.Used(), 0u);
+	BOOST_CHECK_CLOSE(ring.Utilization(), 0.0, 0.001);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,175 @@
+/**
+ *  .file test/oglplus/client_context.cpp
+ *  .brief Test case for the lazy state queries of the client context.
+ *
+ *  .author Matus Chochlik
+ *
+ *  Copyright 2011-2015 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE OGLPLUS_ClientContext
+#include <boost/test/unit_test.hpp>
+
+#define OGLPLUS_USE_GL_DISPATCH 1
+
+#include <oglplus/gl.hpp>
+#include <oglplus/config/fix_gl_version.hpp>
+#include <oglplus/client_context.hpp>
+#include <oglplus/dispatch/recorder.hpp>
+
+#include <cstring>
+
+// headless recorder failing the IsEnabled queries when requested
+class FailingQueryRecorder
+ : public oglplus::GLHeadlessRecorder
+{
+private:
+	GLenum _error;
+protected:
+	void Emulate(oglplus::GLCallInfo& call)
+	{
+		oglplus::GLHeadlessRecorder::Emulate(call);
+		if(std::strcmp(call.name, "GetError") == 0)
+		{
+			call.result.value.i = _error;
+			_error = GL_NO_ERROR;
+		}
+		else if(fail && std::strcmp(call.name, "IsEnabled") == 0)
+		{
+			_error = GL_INVALID_ENUM;
+		}
+	}
+public:
+	bool fail;
+
+	FailingQueryRecorder(void)
+	 : _error(GL_NO_ERROR)
+	 , fail(false)
+	{ }
+};
+
+BOOST_AUTO_TEST_SUITE(ClientContextSettings)
+
+BOOST_AUTO_TEST_CASE(ClientContext_construction)
+{
+	using namespace oglplus;
+
+	GLHeadlessRecorder recorder;
+	GLDispatchBackendScope scope(recorder);
+
+	std::size_t queries = client::SettingQueryCount();
+	ClientContext gl;
+	BOOST_CHECK_EQUAL(recorder.CallCount(), 0u);
+	BOOST_CHECK_EQUAL(client::SettingQueryCount(), queries);
+	BOOST_CHECK(!gl.Caps.DepthTest.Indexed(0).Known());
+}
+
+BOOST_AUTO_TEST_CASE(ClientContext_lazy_get)
+{
+	using namespace oglplus;
+
+	GLHeadlessRecorder recorder;
+	GLDispatchBackendScope scope(recorder);
+
+	ClientContext gl;
+	std::size_t queries = client::SettingQueryCount();
+
+	BOOST_CHECK(!gl.Caps.DepthTest.IsEnabled());
+	BOOST_CHECK(!gl.Caps.DepthTest.IsEnabled());
+	BOOST_CHECK_EQUAL(recorder.CountOf("IsEnabled"), 1u);
+	BOOST_CHECK_EQUAL(client::SettingQueryCount(), queries+1);
+
+	// the value is queried again after invalidation
+	gl.Caps.DepthTest.Invalidate();
+	BOOST_CHECK(!gl.Caps.DepthTest.IsEnabled());
+	BOOST_CHECK_EQUAL(recorder.CountOf("IsEnabled"), 2u);
+	BOOST_CHECK_EQUAL(client::SettingQueryCount(), queries+2);
+}
+
+BOOST_AUTO_TEST_CASE(ClientContext_lazy_set)
+{
+	using namespace oglplus;
+
+	GLHeadlessRecorder recorder;
+	GLDispatchBackendScope scope(recorder);
+
+	ClientContext gl;
+
+	// setting an unknown value does not query it
+	gl.Caps.Blend.Enable();
+	BOOST_CHECK_EQUAL(recorder.CountOf("IsEnabled"), 0u);
+	BOOST_CHECK_EQUAL(recorder.CountOf("Enable"), 1u);
+
+	gl.Caps.Blend.Enable();
+	BOOST_CHECK_EQUAL(recorder.CountOf("Enable"), 1u);
+	gl.Caps.Blend.Disable();
+	BOOST_CHECK_EQUAL(recorder.CountOf("Disable"), 1u);
+	BOOST_CHECK_EQUAL(recorder.CountOf("IsEnabled"), 0u);
+
+	// pushing needs the previous value
+	recorder.Clear();
+	{
+		auto holder = gl.Caps.CullFace.Push(true);
+		BOOST_CHECK_EQUAL(recorder.CountOf("IsEnabled"), 1u);
+		BOOST_CHECK_EQUAL(recorder.CountOf("Enable"), 1u);
+	}
+	BOOST_CHECK_EQUAL(recorder.CountOf("Disable"), 1u);
+	BOOST_CHECK(!gl.Caps.CullFace.IsEnabled());
+	BOOST_CHECK_EQUAL(recorder.CountOf("IsEnabled"), 1u);
+}
+
+BOOST_AUTO_TEST_CASE(ClientContext_seed)
+{
+	using namespace oglplus;
+
+	GLHeadlessRecorder recorder;
+	GLDispatchBackendScope scope(recorder);
+
+	ClientContext gl;
+	std::size_t queries = client::SettingQueryCount();
+
+	// the initial state of a new context
+	gl.Caps.Dither.Seed(true);
+	gl.Caps.ScissorTest.Seed(false);
+
+	BOOST_CHECK(gl.Caps.Dither.IsEnabled());
+	gl.Caps.Dither.Enable();
+	gl.Caps.ScissorTest.Disable();
+	BOOST_CHECK_EQUAL(recorder.CallCount(), 0u);
+
+	{
+		auto holder = gl.Caps.ScissorTest.Push(true);
+		BOOST_CHECK_EQUAL(recorder.CountOf("Enable"), 1u);
+	}
+	BOOST_CHECK_EQUAL(recorder.CountOf("Disable"), 1u);
+	BOOST_CHECK_EQUAL(recorder.CountOf("IsEnabled"), 0u);
+	BOOST_CHECK_EQUAL(client::SettingQueryCount(), queries);
+}
+
+BOOST_AUTO_TEST_CASE(ClientContext_failed_query)
+{
+	using namespace oglplus;
+
+	FailingQueryRecorder recorder;
+	GLDispatchBackendScope scope(recorder);
+
+	ClientContext gl;
+	gl.Caps.Dither.Seed(true);
+	gl.Caps.Dither.Invalidate();
+
+	// a failed query does not make the value known
+	// and does not leave the previous value
+	recorder.fail = true;
+	BOOST_CHECK(!gl.Caps.Dither.IsEnabled());
+	BOOST_CHECK(!gl.Caps.Dither.Indexed(0).Known());
+	BOOST_CHECK_EQUAL(recorder.CountOf("IsEnabled"), 1u);
+
+	recorder.fail = false;
+	BOOST_CHECK(!gl.Caps.Dither.IsEnabled());
+	BOOST_CHECK(gl.Caps.Dither.Indexed(0).Known());
+	BOOST_CHECK_EQUAL(recorder.CountOf("IsEnabled"), 2u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,243 @@
+/**
+ *  .file test/oglplus/command_list.cpp
+ *  .brief Test case for the deferred command lists.
+ *
+ *  .author Matus Chochlik
+ *
+ *  Copyright 2011-2015 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE OGLPLUS_CommandList
+#include <boost/test/unit_test.hpp>
+
+#define OGLPLUS_USE_GL_DISPATCH 1
+
+#include <oglplus/gl.hpp>
+#include <oglplus/config/fix_gl_version.hpp>
+#include <oglplus/command_list.hpp>
+#include <oglplus/dispatch/recorder.hpp>
+
+#include <cstring>
+#include <thread>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(CommandListRecording)
+
+BOOST_AUTO_TEST_CASE(CommandList_recording)
+{
+	using namespace oglplus;
+
+	GLHeadlessRecorder recorder;
+	GLDispatchBackendScope scope(recorder);
+
+	CommandList list(256);
+	BOOST_CHECK(list.Empty());
+
+	for(GLuint i=0; i!=100; ++i)
+	{
+		list.UseProgram(ProgramName(1+i%2))
+			.BindVertexArray(VertexArrayName(3))
+			.Uniform(0, Vec4f(1, 2, 3, 4))
+			.DrawArrays(PrimitiveType::Triangles, 0, 3);
+	}
+	BOOST_CHECK_EQUAL(recorder.CallCount(), 0u);
+	BOOST_CHECK_EQUAL(list.CommandCount(), 400u);
+	BOOST_CHECK(list.UsedBytes() > 0u);
+	BOOST_CHECK(list.AllocatedBytes() >= list.UsedBytes());
+
+	// the memory is kept and reused
+	std::size_t allocated = list.AllocatedBytes();
+	list.Clear();
+	BOOST_CHECK(list.Empty());
+	BOOST_CHECK_EQUAL(list.UsedBytes(), 0u);
+	BOOST_CHECK_EQUAL(list.AllocatedBytes(), allocated);
+
+	list.DrawArrays(PrimitiveType::Points, 0, 1);
+	BOOST_CHECK_EQUAL(list.AllocatedBytes(), allocated);
+
+	CommandList moved(std::move(list));
+	BOOST_CHECK_EQUAL(moved.CommandCount(), 1u);
+	BOOST_CHECK(list.Empty());
+}
+
+BOOST_AUTO_TEST_CASE(CommandList_execution)
+{
+	using namespace oglplus;
+
+	GLHeadlessRecorder recorder;
+	GLDispatchBackendScope scope(recorder);
+
+	std::vector<GLfloat> data(1000);
+	for(std::size_t i=0; i!=data.size(); ++i)
+	{
+		data[i] = GLfloat(i);
+	}
+
+	// smaller blocks than the buffer data
+	CommandList list(512);
+	list.UseProgram(ProgramName(5))
+		.BindBuffer(BufferTarget::Array, BufferName(7))
+		.BufferSubData(BufferTarget::Array, 16, data)
+		.BindTexture(2, TextureTarget::_2D, TextureName(9))
+		.Uniform(3, 0.5f)
+		.Uniform(4, 2)
+		.Uniform(5, Mat4f())
+		.Enable(Capability::DepthTest)
+		.DrawElements(
+			PrimitiveType::TriangleStrip,
+			24,
+			DataType::UnsignedShort
+		)
+		.Disable(Capability::DepthTest);
+
+	// the recorded data is a copy
+	std::fill(data.begin(), data.end(), 0.0f);
+
+	CommandExecutor executor;
+	recorder.Clear();
+	executor.Execute(list);
+
+	const char* expected[] = {
+		"UseProgram",
+		"BindBuffer",
+		"BufferSubData",
+		"ActiveTexture",
+		"BindTexture",
+		"Uniform1fv",
+		"Uniform1iv",
+		"UniformMatrix4fv",
+		"Enable",
+		"DrawElements",
+		"Disable"
+	};
+	std::size_t c = 0;
+	for(std::size_t i=0; i!=recorder.CallCount(); ++i)
+	{
+		const GLCallRecord& call = recorder.Call(i);
+		if(std::strcmp(call.name, "GetError") == 0) continue;
+		BOOST_REQUIRE(c < sizeof(expected)/sizeof(expected[0]));
+		BOOST_CHECK_EQUAL(call.name, expected[c]);
+
+		if(std::strcmp(call.name, "BufferSubData") == 0)
+		{
+			BOOST_CHECK_EQUAL(recorder.Arg(call, 1).Int(), 16);
+			BOOST_CHECK_EQUAL(
+				recorder.Arg(call, 2).Int(),
+				1000*sizeof(GLfloat)
+			);
+			const GLfloat* v = static_cast<const GLfloat*>(
+				recorder.Arg(call, 3).Ptr()
+			);
+			BOOST_REQUIRE(v != nullptr);
+			BOOST_CHECK_EQUAL(v[0], 0.0f);
+			BOOST_CHECK_EQUAL(v[999], 999.0f);
+		}
+		if(std::strcmp(call.name, "ActiveTexture") == 0)
+		{
+			BOOST_CHECK_EQUAL(
+				recorder.Arg(call, 0).Int(),
+				GL_TEXTURE0+2
+			);
+		}
+		if(std::strcmp(call.name, "UniformMatrix4fv") == 0)
+		{
+			BOOST_CHECK_EQUAL(recorder.Arg(call, 0).Int(), 5);
+			BOOST_CHECK_EQUAL(recorder.Arg(call, 2).Int(), GL_TRUE);
+		}
+		++c;
+	}
+	BOOST_CHECK_EQUAL(c, sizeof(expected)/sizeof(expected[0]));
+	BOOST_CHECK_EQUAL(executor.Stats().commands, 10u);
+	BOOST_CHECK_EQUAL(executor.Stats().lists, 1u);
+}
+
+BOOST_AUTO_TEST_CASE(CommandList_redundant_binds)
+{
+	using namespace oglplus;
+
+	GLHeadlessRecorder recorder;
+	GLDispatchBackendScope scope(recorder);
+
+	std::vector<CommandList> lists;
+	for(int l=0; l!=3; ++l)
+	{
+		lists.push_back(CommandList());
+		for(int i=0; i!=10; ++i)
+		{
+			lists.back()
+				.UseProgram(ProgramName(1))
+				.BindVertexArray(VertexArrayName(2))
+				.BindTexture(0, TextureTarget::_2D, TextureName(3))
+				.DrawArrays(PrimitiveType::Triangles, 0, 3);
+		}
+	}
+
+	CommandExecutor executor;
+	recorder.Clear();
+	executor.Execute(lists);
+	BOOST_CHECK_EQUAL(recorder.CountOf("UseProgram"), 1u);
+	BOOST_CHECK_EQUAL(recorder.CountOf("BindVertexArray"), 1u);
+	BOOST_CHECK_EQUAL(recorder.CountOf("BindTexture"), 1u);
+	BOOST_CHECK_EQUAL(recorder.CountOf("DrawArrays"), 30u);
+	BOOST_CHECK_EQUAL(executor.Stats().skipped_binds, 87u);
+	BOOST_CHECK_EQUAL(executor.Stats().lists, 3u);
+
+	// the tracked bindings are reset by each Execute
+	recorder.Clear();
+	executor.Execute(lists.front());
+	BOOST_CHECK_EQUAL(recorder.CountOf("UseProgram"), 1u);
+}
+
+BOOST_AUTO_TEST_CASE(CommandList_threads)
+{
+	using namespace oglplus;
+
+	GLHeadlessRecorder recorder;
+	GLDispatchBackendScope scope(recorder);
+
+	const std::size_t thread_count = 4;
+	std::vector<CommandList> lists(thread_count);
+	std::vector<std::thread> threads;
+
+	for(std::size_t t=0; t!=thread_count; ++t)
+	{
+		CommandList& list = lists[t];
+		threads.push_back(std::thread([&list, t](void) -> void
+		{
+			for(GLint i=0; i!=1000; ++i)
+			{
+				list.UseProgram(ProgramName(GLuint(1+t)))
+					.Uniform(0, Vec2f(GLfloat(t), GLfloat(i)))
+					.DrawArrays(PrimitiveType::Points, i, 1);
+			}
+		}));
+	}
+	for(auto i=threads.begin(), e=threads.end(); i!=e; ++i)
+	{
+		i->join();
+	}
+	BOOST_CHECK_EQUAL(recorder.CallCount(), 0u);
+
+	CommandExecutor executor;
+	executor.Execute(lists);
+	BOOST_CHECK_EQUAL(recorder.CountOf("DrawArrays"), thread_count*1000);
+	BOOST_CHECK_EQUAL(recorder.CountOf("Uniform2fv"), thread_count*1000);
+	BOOST_CHECK_EQUAL(recorder.CountOf("UseProgram"), thread_count);
+
+	// the lists are executed in order
+	GLint prev = -1;
+	for(std::size_t i=0; i!=recorder.CallCount(); ++i)
+	{
+		const GLCallRecord& call = recorder.Call(i);
+		if(std::strcmp(call.name, "UseProgram") == 0)
+		{
+			GLint prog = GLint(recorder.Arg(call, 0).Int());
+			BOOST_CHECK_EQUAL(prog, prev+(prev<0?2:1));
+			prev = prog;
+		}
+	}
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,215 @@
+/**
+ *  .file test/oglplus/curve.cpp
+ *  .brief Test case for the Bezier curves.
+ *
+ *  .author Matus Chochlik
+ *
+ *  Copyright 2011-2015 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE OGLPLUS_curve
+#include <boost/test/unit_test.hpp>
+
+#include <oglplus/gl.hpp>
+#include <oglplus/math/vector.hpp>
+#include <oglplus/math/curve.hpp>
+#include <oglplus/math/constants.hpp>
+
+#include <vector>
+#include <cmath>
+
+BOOST_AUTO_TEST_SUITE(curve)
+
+static oglplus::CubicBezierLoop<oglplus::Vec3f, GLfloat> test_loop(void)
+{
+	using namespace oglplus;
+
+	return CubicBezierLoop<Vec3f, GLfloat>({
+		Vec3f( 0.0f, 0.0f, 0.0f),
+		Vec3f( 4.0f, 1.0f,-2.0f),
+		Vec3f( 5.0f, 6.0f, 1.0f),
+		Vec3f(-1.0f, 3.0f, 2.0f),
+		Vec3f(-3.0f,-2.0f, 0.5f)
+	});
+}
+
+// evaluates the curve at t with the Bernstein polynomials
+template <typename Type, typename Parameter, unsigned Order>
+static Type reference_position(
+	const oglplus::BezierCurves<Type, Parameter, Order>& curve,
+	unsigned segment,
+	Parameter t
+)
+{
+	const std::vector<Type>& points = curve.ControlPoints();
+	unsigned poffs = segment*curve.SegmentStep();
+	return oglplus::math::Bezier<Type, Parameter, Order>::Position(
+		points.data()+poffs,
+		points.size()-poffs,
+		t
+	);
+}
+
+static GLfloat segment_distance(
+	const oglplus::Vec3f& p,
+	const oglplus::Vec3f& a,
+	const oglplus::Vec3f& b
+)
+{
+	using namespace oglplus;
+
+	Vec3f ab = b-a;
+	GLfloat l = Dot(ab, ab);
+	GLfloat t = (l > 0.0f)?Dot(p-a, ab)/l:0.0f;
+	t = std::min(std::max(t, 0.0f), 1.0f);
+	return Distance(p, a+ab*t);
+}
+
+BOOST_AUTO_TEST_CASE(curve_position)
+{
+	using namespace oglplus;
+
+	auto loop = test_loop();
+	const unsigned s = loop.SegmentCount();
+	BOOST_CHECK_EQUAL(s, 5u);
+
+	for(unsigned i=0; i!=1000; ++i)
+	{
+		GLfloat t = GLfloat(i)/1000.0f;
+		GLfloat toffs = t*s;
+		unsigned seg = unsigned(toffs);
+		Vec3f expected = reference_position(loop, seg, toffs-seg);
+		BOOST_CHECK_SMALL(Distance(loop.Position01(t), expected), 1e-4f);
+	}
+	BOOST_CHECK_SMALL(
+		Distance(loop.Position(1.25f), loop.Position01(0.25f)),
+		1e-5f
+	);
+}
+
+BOOST_AUTO_TEST_CASE(curve_approximate)
+{
+	using namespace oglplus;
+
+	auto loop = test_loop();
+	const unsigned s = loop.SegmentCount();
+
+	const unsigned counts[] = {1, 3, 25, 1000};
+	for(unsigned n : counts)
+	{
+		std::vector<Vec3f> points = loop.Approximate(n);
+		BOOST_REQUIRE_EQUAL(points.size(), s*n+1);
+
+		for(unsigned i=0; i!=s; ++i)
+		{
+			for(unsigned j=0; j!=n; ++j)
+			{
+				Vec3f expected = reference_position(
+					loop, i,
+					GLfloat(j)/GLfloat(n)
+				);
+				BOOST_CHECK_SMALL(
+					Distance(points[i*n+j], expected),
+					1e-4f
+				);
+			}
+		}
+		BOOST_CHECK(points.back() == loop.ControlPoints().back());
+	}
+
+	// separated quadratic curves with double precision parameter
+	BezierCurves<Vec2f, double, 2> quad({
+		Vec2f(0.0f, 0.0f), Vec2f(1.0f, 2.0f), Vec2f(2.0f, 0.0f),
+		Vec2f(3.0f, 3.0f), Vec2f(4.0f, 1.0f), Vec2f(5.0f, 5.0f)
+	});
+	BOOST_CHECK(quad.Separated());
+	std::vector<Vec2f> points = quad.Approximate(10);
+	BOOST_REQUIRE_EQUAL(points.size(), 21u);
+	for(unsigned j=0; j!=10; ++j)
+	{
+		Vec2f expected = reference_position(quad, 1, j/10.0);
+		BOOST_CHECK_SMALL(Distance(points[10+j], expected), 1e-5f);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(curve_tessellate)
+{
+	using namespace oglplus;
+
+	auto loop = test_loop();
+
+	std::vector<Vec3f> fine = loop.Tessellate(0.001f);
+	std::vector<Vec3f> coarse = loop.Tessellate(0.1f);
+	BOOST_CHECK(coarse.size() < fine.size());
+	BOOST_CHECK(coarse.front() == loop.ControlPoints().front());
+	BOOST_CHECK(coarse.back() == loop.ControlPoints().back());
+
+	// every point of the curve is close to the polyline
+	std::vector<Vec3f> dense = loop.Approximate(200);
+	for(auto p=dense.begin(); p!=dense.end(); ++p)
+	{
+		GLfloat d = 1e30f;
+		for(std::size_t i=1; i!=coarse.size(); ++i)
+		{
+			d = std::min(d, segment_distance(*p, coarse[i-1], coarse[i]));
+		}
+		BOOST_CHECK(d <= 0.1f+1e-5f);
+	}
+
+	// a straight line needs no subdivision
+	BezierCurves<Vec3f, GLfloat, 3> line({
+		Vec3f(0, 0, 0), Vec3f(1, 1, 1), Vec3f(2, 2, 2), Vec3f(3, 3, 3)
+	});
+	BOOST_CHECK_EQUAL(line.Tessellate(0.001f).size(), 2u);
+
+	// scalar curves
+	BezierCurves<GLfloat, GLfloat, 2> scalar({0.0f, 4.0f, 1.0f});
+	std::vector<GLfloat> values = scalar.Tessellate(0.01f);
+	BOOST_CHECK(values.size() > 2u);
+	BOOST_CHECK_EQUAL(values.back(), 1.0f);
+}
+
+BOOST_AUTO_TEST_CASE(curve_arc_length)
+{
+	using namespace oglplus;
+
+	// a quarter of the unit circle
+	const GLfloat k = 0.5522847f;
+	BezierCurves<Vec2f, GLfloat, 3> arc({
+		Vec2f(1.0f, 0.0f), Vec2f(1.0f, k), Vec2f(k, 1.0f), Vec2f(0.0f, 1.0f)
+	});
+	BezierArcLengthTable<Vec2f, GLfloat, 3> arc_table(arc, 64);
+	BOOST_CHECK_CLOSE(arc_table.Length(), math::HalfPi(), 0.05);
+
+	// a straight line with non-uniformly spaced control points
+	BezierCurves<Vec2f, GLfloat, 3> line({
+		Vec2f(0.0f, 0.0f), Vec2f(0.1f, 0.0f),
+		Vec2f(0.2f, 0.0f), Vec2f(4.0f, 0.0f)
+	});
+	BezierArcLengthTable<Vec2f, GLfloat, 3> table(line);
+	BOOST_CHECK_CLOSE(table.Length(), 4.0f, 0.001);
+	BOOST_CHECK_EQUAL(table.ParameterAt(-1.0f), 0.0f);
+	BOOST_CHECK_EQUAL(table.ParameterAt(5.0f), 1.0f);
+
+	// half of the length is not at half of the parameter range
+	BOOST_CHECK(std::fabs(line.Position01(0.5f)[0]-2.0f) > 0.5f);
+
+	for(unsigned i=1; i!=20; ++i)
+	{
+		GLfloat f = GLfloat(i)/20.0f;
+		Vec2f p = line.Position01(table.ParameterAtFraction(f));
+		BOOST_CHECK_SMALL(p[0]-4.0f*f, 0.01f);
+	}
+
+	std::vector<Vec2f> points;
+	line.ApproximateConstantSpeed(points, 16, table);
+	BOOST_REQUIRE_EQUAL(points.size(), 17u);
+	for(unsigned i=1; i!=points.size(); ++i)
+	{
+		BOOST_CHECK_SMALL(Distance(points[i-1], points[i])-0.25f, 0.01f);
+	}
+}
+
+BOOST_AUTO_TEST_SUITE_END()
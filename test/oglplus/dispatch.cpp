@@ -0,0 +1,136 @@
+/**
+ *  .file test/oglplus/dispatch.cpp
+ *  .brief Test case for the GL dispatch layer and the headless backend.
+ *
+ *  .author Matus Chochlik
+ *
+ *  Copyright 2011-2015 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE OGLPLUS_Dispatch
+#include <boost/test/unit_test.hpp>
+
+#define OGLPLUS_USE_GL_DISPATCH 1
+
+#include <oglplus/gl.hpp>
+#include <oglplus/config/fix_gl_version.hpp>
+#include <oglplus/buffer.hpp>
+#include <oglplus/dispatch/recorder.hpp>
+
+#include <sstream>
+#include <thread>
+
+BOOST_AUTO_TEST_SUITE(Dispatch)
+
+BOOST_AUTO_TEST_CASE(Dispatch_call_arg)
+{
+	using namespace oglplus;
+
+	GLCallArg a = MakeGLCallArg<GLenum>(GL_ARRAY_BUFFER);
+	BOOST_CHECK(a.kind == GLCallArgKind::Integer);
+	BOOST_CHECK(GLCallArgValue<GLenum>(a) == GL_ARRAY_BUFFER);
+
+	GLCallArg f = MakeGLCallArg<GLfloat>(0.5f);
+	BOOST_CHECK(f.kind == GLCallArgKind::Float);
+	BOOST_CHECK(GLCallArgValue<GLfloat>(f) == 0.5f);
+
+	GLuint name = 0;
+	GLCallArg p = MakeGLCallArg<GLuint*>(&name);
+	BOOST_CHECK(p.kind == GLCallArgKind::Pointer);
+	BOOST_CHECK(p.pointee_size == sizeof(GLuint));
+	BOOST_CHECK(GLCallArgValue<GLuint*>(p) == &name);
+
+	GLCallArg cp = MakeGLCallArg<const void*>(&name);
+	BOOST_CHECK(cp.kind == GLCallArgKind::ConstPointer);
+	BOOST_CHECK(cp.pointee_size == 0);
+}
+
+BOOST_AUTO_TEST_CASE(Dispatch_headless_buffer)
+{
+	using namespace oglplus;
+
+	GLHeadlessRecorder recorder;
+	GLDispatchBackendScope scope(recorder);
+
+	{
+		Buffer buffer;
+		BOOST_CHECK(GetGLName(buffer) != 0u);
+		buffer.Bind(Buffer::Target::Array);
+		GLfloat data[4] = {0.0f, 1.0f, 2.0f, 3.0f};
+		Buffer::Data(Buffer::Target::Array, 4, data);
+	}
+
+	BOOST_CHECK_EQUAL(recorder.CountOf("GenBuffers"), 1u);
+	BOOST_CHECK_EQUAL(recorder.CountOf("BindBuffer"), 1u);
+	BOOST_CHECK_EQUAL(recorder.CountOf("BufferData"), 1u);
+	BOOST_CHECK_EQUAL(recorder.CountOf("DeleteBuffers"), 1u);
+	BOOST_CHECK(recorder.CountOf("GetError") >= 3u);
+
+	for(std::size_t i=0; i!=recorder.CallCount(); ++i)
+	{
+		BOOST_CHECK(!recorder.Call(i).forwarded);
+	}
+
+	std::size_t bind = 0;
+	while(std::string(recorder.Call(bind).name) != "BindBuffer") ++bind;
+	const GLCallRecord& call = recorder.Call(bind);
+	BOOST_CHECK_EQUAL(call.arg_count, 2u);
+	BOOST_CHECK_EQUAL(recorder.Arg(call, 0).Int(), GL_ARRAY_BUFFER);
+
+	std::stringstream report;
+	recorder.Report(report);
+	BOOST_CHECK(report.str().find("glBindBuffer") != std::string::npos);
+}
+
+BOOST_AUTO_TEST_CASE(Dispatch_replay)
+{
+	using namespace oglplus;
+
+	GLHeadlessRecorder recorder;
+	{
+		GLDispatchBackendScope scope(recorder);
+		Buffer buffer;
+		buffer.Bind(Buffer::Target::Array);
+	}
+
+	GLHeadlessRecorder replayed;
+	{
+		GLDispatchBackendScope scope(replayed);
+		recorder.Replay();
+	}
+	BOOST_CHECK_EQUAL(replayed.CallCount(), recorder.CallCount());
+	for(std::size_t i=0; i!=recorder.CallCount(); ++i)
+	{
+		BOOST_CHECK_EQUAL(
+			std::string(replayed.Call(i).name),
+			std::string(recorder.Call(i).name)
+		);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(Dispatch_per_thread)
+{
+	using namespace oglplus;
+
+	GLHeadlessRecorder recorder, other;
+	GLDispatchBackendScope scope(recorder);
+
+	GLDispatchBackend* seen = &recorder;
+	std::thread thread([&seen, &other](void)
+	{
+		seen = GLDispatchBackend::Current();
+		GLDispatchBackendScope other_scope(other);
+		Buffer buffer;
+	});
+	thread.join();
+#if !OGLPLUS_NO_THREAD_LOCAL
+	BOOST_CHECK(seen == nullptr);
+	BOOST_CHECK_EQUAL(recorder.CountOf("GenBuffers"), 0u);
+	BOOST_CHECK_EQUAL(other.CountOf("GenBuffers"), 1u);
+#endif
+	BOOST_CHECK(GLDispatchBackend::Current() == &recorder);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
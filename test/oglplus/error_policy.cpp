@@ -0,0 +1,254 @@
+/**
+ *  .file test/oglplus/error_policy.cpp
+ *  .brief Test case for the deferred GL error check policies.
+ *
+ *  .author Matus Chochlik
+ *
+ *  Copyright 2011-2015 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE OGLPLUS_ErrorPolicy
+#include <boost/test/unit_test.hpp>
+
+#define OGLPLUS_USE_GL_DISPATCH 1
+
+#include <oglplus/gl.hpp>
+#include <oglplus/config/fix_gl_version.hpp>
+#include <oglplus/buffer.hpp>
+#include <oglplus/error/deferred.hpp>
+#include <oglplus/dispatch/recorder.hpp>
+
+#include <cstring>
+
+// headless recorder failing the calls of the specified function
+class FailingRecorder
+ : public oglplus::GLHeadlessRecorder
+{
+private:
+	const char* _fail_func;
+	GLenum _error;
+protected:
+	void Emulate(oglplus::GLCallInfo& call)
+	{
+		oglplus::GLHeadlessRecorder::Emulate(call);
+		if(std::strcmp(call.name, "GetError") == 0)
+		{
+			call.result.value.i = _error;
+			_error = GL_NO_ERROR;
+		}
+		else if(_fail_func && std::strcmp(call.name, _fail_func) == 0)
+		{
+			if(_error == GL_NO_ERROR)
+			{
+				_error = GL_INVALID_OPERATION;
+			}
+		}
+	}
+public:
+	FailingRecorder(const char* fail_func = nullptr)
+	 : _fail_func(fail_func)
+	 , _error(GL_NO_ERROR)
+	{ }
+};
+
+BOOST_AUTO_TEST_SUITE(ErrorPolicy)
+
+BOOST_AUTO_TEST_CASE(ErrorPolicy_immediate)
+{
+	using namespace oglplus;
+
+	FailingRecorder recorder;
+	GLDispatchBackendScope scope(recorder);
+
+	Buffer buffer;
+	buffer.Bind(Buffer::Target::Array);
+	buffer.Bind(Buffer::Target::ElementArray);
+
+	BOOST_CHECK(recorder.CountOf("GetError") >= 3u);
+}
+
+BOOST_AUTO_TEST_CASE(ErrorPolicy_deferred)
+{
+	using namespace oglplus;
+
+	FailingRecorder recorder;
+	GLDispatchBackendScope scope(recorder);
+
+	Buffer buffer;
+	recorder.Clear();
+	{
+		ErrorCheckScope deferred(ErrorCheckPolicy::Deferred);
+		for(int i=0; i!=10; ++i)
+		{
+			buffer.Bind(Buffer::Target::Array);
+		}
+		BOOST_CHECK_EQUAL(recorder.CountOf("GetError"), 0u);
+		deferred.Flush();
+	}
+	BOOST_CHECK_EQUAL(recorder.CountOf("BindBuffer"), 10u);
+	BOOST_CHECK_EQUAL(recorder.CountOf("GetError"), 1u);
+
+	// the immediate policy is restored
+	buffer.Bind(Buffer::Target::Array);
+	BOOST_CHECK_EQUAL(recorder.CountOf("GetError"), 2u);
+}
+
+BOOST_AUTO_TEST_CASE(ErrorPolicy_deferred_error)
+{
+	using namespace oglplus;
+
+	FailingRecorder recorder("BufferData");
+	GLDispatchBackendScope scope(recorder);
+
+	Buffer buffer;
+	bool thrown = false;
+	try
+	{
+		ErrorCheckScope deferred(ErrorCheckPolicy::Deferred);
+		buffer.Bind(Buffer::Target::Array);
+		GLfloat data[2] = {0.0f, 1.0f};
+		Buffer::Data(Buffer::Target::Array, 2, data);
+		buffer.Bind(Buffer::Target::ElementArray);
+		deferred.Flush();
+	}
+	catch(DeferredError& error)
+	{
+		thrown = true;
+		BOOST_CHECK(error.Code() == ErrorCode::InvalidOperation);
+		BOOST_CHECK_EQUAL(error.CallCount(), 3u);
+		BOOST_CHECK_EQUAL(error.CallSites().size(), 3u);
+		BOOST_CHECK_EQUAL(
+			std::string(error.CallSites()[1].gl_func),
+			std::string("BufferData")
+		);
+		BOOST_CHECK(error.CallSites()[1].line > 0);
+		// the failing call is not known
+		BOOST_CHECK(error.GLFunc() == nullptr);
+	}
+	BOOST_CHECK(thrown);
+
+	// the pending error was consumed by the deferred check
+	buffer.Bind(Buffer::Target::Array);
+}
+
+BOOST_AUTO_TEST_CASE(ErrorPolicy_explicit_check)
+{
+	using namespace oglplus;
+
+	FailingRecorder recorder("BindBuffer");
+	GLDispatchBackendScope scope(recorder);
+
+	Buffer buffer;
+	ErrorCheckScope deferred(ErrorCheckPolicy::Deferred);
+	buffer.Bind(Buffer::Target::Array);
+	BOOST_CHECK_THROW(deferred.Flush(), DeferredError);
+	BOOST_CHECK_NO_THROW(deferred.Flush());
+}
+
+BOOST_AUTO_TEST_CASE(ErrorPolicy_unflushed_error)
+{
+	using namespace oglplus;
+
+	FailingRecorder recorder("BufferData");
+	GLDispatchBackendScope scope(recorder);
+
+	Buffer buffer;
+	buffer.Bind(Buffer::Target::Array);
+	GLfloat data[2] = {0.0f, 1.0f};
+	{
+		// the destructor checks the error but does not throw
+		ErrorCheckScope deferred(ErrorCheckPolicy::Deferred);
+		Buffer::Data(Buffer::Target::Array, 2, data);
+	}
+	// the error is not left for the next immediate check
+	BOOST_CHECK_NO_THROW(buffer.Bind(Buffer::Target::Array));
+
+	// but it is thrown by the next deferred check
+	try
+	{
+		CheckDeferredErrors();
+		BOOST_ERROR("The unflushed error was not stored");
+	}
+	catch(DeferredError& error)
+	{
+		BOOST_CHECK(error.Code() == ErrorCode::InvalidOperation);
+		BOOST_REQUIRE_EQUAL(error.CallSites().size(), 1u);
+		BOOST_CHECK_EQUAL(
+			std::string(error.CallSites()[0].gl_func),
+			std::string("BufferData")
+		);
+	}
+	BOOST_CHECK_NO_THROW(CheckDeferredErrors());
+
+	// the errors of nested scopes are checked by the outer one
+	{
+		ErrorCheckScope outer(ErrorCheckPolicy::Deferred);
+		{
+			ErrorCheckScope inner(ErrorCheckPolicy::Deferred);
+			Buffer::Data(Buffer::Target::Array, 2, data);
+		}
+		BOOST_CHECK_THROW(outer.Flush(), DeferredError);
+	}
+}
+
+static std::size_t unflushed_count = 0;
+
+static void count_unflushed(const oglplus::DeferredError&)
+{
+	++unflushed_count;
+}
+
+BOOST_AUTO_TEST_CASE(ErrorPolicy_unflushed_handler)
+{
+	using namespace oglplus;
+
+	FailingRecorder recorder("BufferData");
+	GLDispatchBackendScope scope(recorder);
+
+	UnflushedErrorHandler prev = SetUnflushedErrorHandler(&count_unflushed);
+	Buffer buffer;
+	buffer.Bind(Buffer::Target::Array);
+	{
+		ErrorCheckScope deferred(ErrorCheckPolicy::Deferred);
+		GLfloat data[2] = {0.0f, 1.0f};
+		Buffer::Data(Buffer::Target::Array, 2, data);
+	}
+	BOOST_CHECK_EQUAL(unflushed_count, 1u);
+	BOOST_CHECK_NO_THROW(CheckDeferredErrors());
+	SetUnflushedErrorHandler(prev);
+}
+
+BOOST_AUTO_TEST_CASE(ErrorPolicy_debug_output_fallback)
+{
+	using namespace oglplus;
+
+	FailingRecorder recorder;
+	GLDispatchBackendScope scope(recorder);
+
+	{
+		// neither GL 4.3 nor KHR_debug is reported
+		ErrorCheckScope debug(ErrorCheckPolicy::DebugOutput);
+		BOOST_CHECK(debug.Policy() == ErrorCheckPolicy::Deferred);
+	}
+	BOOST_CHECK_EQUAL(recorder.CountOf("DebugMessageCallback"), 0u);
+
+	recorder.SetInteger(GL_MAJOR_VERSION, 4);
+	recorder.SetInteger(GL_MINOR_VERSION, 3);
+	{
+		// not a debug context
+		ErrorCheckScope debug(ErrorCheckPolicy::DebugOutput);
+		BOOST_CHECK(debug.Policy() == ErrorCheckPolicy::Deferred);
+	}
+	BOOST_CHECK_EQUAL(recorder.CountOf("DebugMessageCallback"), 0u);
+
+	recorder.SetInteger(GL_CONTEXT_FLAGS, GL_CONTEXT_FLAG_DEBUG_BIT);
+	{
+		ErrorCheckScope debug(ErrorCheckPolicy::DebugOutput);
+		BOOST_CHECK(debug.Policy() == ErrorCheckPolicy::DebugOutput);
+	}
+	BOOST_CHECK(recorder.CountOf("DebugMessageCallback") > 0u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,141 @@
+/**
+ *  .file test/oglplus/frustum_culler.cpp
+ *  .brief Test case for the frustum culling of bounding spheres.
+ *
+ *  .author Matus Chochlik
+ *
+ *  Copyright 2011-2015 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE OGLPLUS_FrustumCuller
+#include <boost/test/unit_test.hpp>
+
+#include <oglplus/gl.hpp>
+#include <oglplus/frustum_culler.hpp>
+
+#include <random>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(FrustumCulling)
+
+static oglplus::Mat4f test_camera(void)
+{
+	using namespace oglplus;
+
+	return	CamMatrixf::PerspectiveX(Degrees(60), 1.5f, 1.0f, 100.0f)*
+		CamMatrixf::LookingAt(Vec3f(0, 0, 0), Vec3f(0, 0, -1));
+}
+
+static oglplus::SphereArray test_spheres(std::size_t count)
+{
+	using namespace oglplus;
+
+	std::mt19937 rng(count);
+	std::uniform_real_distribution<GLfloat> pos(-120.0f, 120.0f);
+	std::uniform_real_distribution<GLfloat> rad(0.0f, 5.0f);
+
+	SphereArray spheres;
+	spheres.Reserve(count);
+	for(std::size_t i=0; i!=count; ++i)
+	{
+		spheres.Add(pos(rng), pos(rng), pos(rng), rad(rng));
+	}
+	return spheres;
+}
+
+BOOST_AUTO_TEST_CASE(Frustum_planes)
+{
+	using namespace oglplus;
+
+	Frustumf frustum(test_camera());
+
+	BOOST_CHECK(frustum.Contains(Vec3f(0, 0, -10)));
+	BOOST_CHECK(!frustum.Contains(Vec3f(0, 0, 10)));
+	BOOST_CHECK(!frustum.Contains(Vec3f(0, 0, -0.5f)));
+	BOOST_CHECK(!frustum.Contains(Vec3f(0, 0, -101)));
+	BOOST_CHECK(!frustum.Contains(Vec3f(100, 0, -10)));
+	BOOST_CHECK(!frustum.Contains(Vec3f(0, -100, -10)));
+
+	BOOST_CHECK_CLOSE(frustum.Distance(Frustumf::Near, Vec3f(0,0,-5)), 4, 1);
+	BOOST_CHECK_CLOSE(frustum.Distance(Frustumf::Far, Vec3f(0,0,-5)), 95, 1);
+
+	BOOST_CHECK(frustum.Intersects(Spheref(0, 0, 0, 1.5f)));
+	BOOST_CHECK(!frustum.Intersects(Spheref(0, 0, 0, 0.5f)));
+	BOOST_CHECK(frustum.Intersects(Spheref(0, 0, -102, 3)));
+	BOOST_CHECK(!frustum.Intersects(Spheref(0, 0, -102, 1)));
+}
+
+BOOST_AUTO_TEST_CASE(FrustumCuller_mask)
+{
+	using namespace oglplus;
+
+	Frustumf frustum(test_camera());
+	FrustumCuller culler(frustum);
+
+	// not a multiple of the SIMD width nor of the mask word size
+	SphereArray spheres = test_spheres(10007);
+
+	std::vector<std::uint32_t> mask;
+	culler.CullToMask(spheres, mask);
+	BOOST_REQUIRE_EQUAL(mask.size(), FrustumCuller::MaskSize(10007));
+	BOOST_CHECK_EQUAL(mask.back() >> (10007%32), 0u);
+
+	std::size_t visible = 0;
+	for(std::size_t i=0; i!=spheres.Size(); ++i)
+	{
+		bool expected = frustum.Intersects(spheres.Get(i));
+		BOOST_CHECK_EQUAL(FrustumCuller::IsVisible(mask, i), expected);
+		if(expected) ++visible;
+	}
+	BOOST_CHECK(visible > 0u);
+	BOOST_CHECK(visible < spheres.Size());
+	BOOST_CHECK_EQUAL(FrustumCuller::CountVisible(mask), visible);
+
+	std::vector<GLuint> indices;
+	BOOST_CHECK_EQUAL(culler.CullToIndices(spheres, indices), visible);
+	BOOST_REQUIRE_EQUAL(indices.size(), visible);
+	for(std::size_t i=0; i!=indices.size(); ++i)
+	{
+		BOOST_CHECK(FrustumCuller::IsVisible(mask, indices[i]));
+		if(i > 0) BOOST_CHECK(indices[i-1] < indices[i]);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(FrustumCuller_threads)
+{
+	using namespace oglplus;
+
+	FrustumCuller culler(test_camera());
+	SphereArray spheres = test_spheres(4*FrustumCuller::MinSpheresPerThread+5);
+
+	std::vector<std::uint32_t> mask1, mask4;
+	culler.CullToMask(spheres, mask1, 1);
+	culler.CullToMask(spheres, mask4, 4);
+	BOOST_CHECK(mask1 == mask4);
+
+	std::vector<GLuint> indices1, indices4;
+	culler.CullToIndices(spheres, indices1, 1);
+	culler.CullToIndices(spheres, indices4, 0);
+	BOOST_CHECK(indices1 == indices4);
+	BOOST_CHECK_EQUAL(indices1.size(), FrustumCuller::CountVisible(mask1));
+}
+
+BOOST_AUTO_TEST_CASE(FrustumCuller_empty)
+{
+	using namespace oglplus;
+
+	FrustumCuller culler(test_camera());
+	SphereArray spheres;
+
+	std::vector<std::uint32_t> mask(3, 1u);
+	culler.CullToMask(spheres, mask, 4);
+	BOOST_CHECK(mask.empty());
+
+	std::vector<GLuint> indices(3, 1u);
+	BOOST_CHECK_EQUAL(culler.CullToIndices(spheres, indices, 4), 0u);
+	BOOST_CHECK(indices.empty());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
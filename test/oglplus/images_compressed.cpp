@@ -0,0 +1,331 @@
+/**
+ *  .file test/oglplus/images_compressed.cpp
+ *  .brief Test case for the CPU block compression of images.
+ *
+ *  .author Matus Chochlik
+ *
+ *  Copyright 2011-2015 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE OGLPLUS_ImagesCompressed
+#include <boost/test/unit_test.hpp>
+
+#define OGLPLUS_USE_GL_DISPATCH 1
+
+#include <oglplus/gl.hpp>
+#include <oglplus/config/fix_gl_version.hpp>
+#include <oglplus/texture.hpp>
+#include <oglplus/images/compressed.hpp>
+#include <oglplus/dispatch/recorder.hpp>
+
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+// a smooth RGBA image with some noise and optionally an alpha cut-out
+static oglplus::images::Image make_image(
+	GLsizei w,
+	GLsizei h,
+	bool cut_out = false
+)
+{
+	std::vector<GLubyte> data(std::size_t(w)*h*4);
+	unsigned seed = 12345;
+	for(GLsizei y=0; y!=h; ++y)
+	for(GLsizei x=0; x!=w; ++x)
+	{
+		seed = seed*1103515245u+12345u;
+		const int noise = int((seed >> 16) % 9)-4;
+		GLubyte* p = data.data()+std::size_t(y*w+x)*4;
+		const double s = std::sin(x*0.1)*std::cos(y*0.07);
+		p[0] = GLubyte(std::min(std::max(128+int(100*s)+noise, 0), 255));
+		p[1] = GLubyte((x*255)/w);
+		p[2] = GLubyte((y*255)/h);
+		if(cut_out)
+		{
+			const int dx = x-w/2, dy = y-h/2;
+			p[3] = (dx*dx+dy*dy < w*h/8)?0xFF:0x00;
+		}
+		else p[3] = GLubyte(std::max(255-(x+y), 128));
+	}
+	return oglplus::images::Image(w, h, 1, 4, data.data());
+}
+
+// the peak signal to noise ratio of the specified channels
+static double psnr(
+	const oglplus::images::Image& a,
+	const oglplus::images::Image& b,
+	GLsizei first,
+	GLsizei count
+)
+{
+	double mse = 0.0;
+	std::size_t n = 0;
+	for(GLsizei y=0; y!=a.Height(); ++y)
+	for(GLsizei x=0; x!=a.Width(); ++x)
+	for(GLsizei c=first; c!=first+count; ++c)
+	{
+		const double d = 255.0*(
+			a.Component(x, y, 0, c)-
+			b.Component(x, y, 0, c)
+		);
+		mse += d*d;
+		++n;
+	}
+	mse /= double(n);
+	return (mse > 0.0)?10.0*std::log10(255.0*255.0/mse):100.0;
+}
+
+BOOST_AUTO_TEST_SUITE(ImagesCompressed)
+
+BOOST_AUTO_TEST_CASE(ImagesCompressed_sizes)
+{
+	using namespace oglplus;
+	using images::BlockFormat;
+	using images::CompressedImage;
+
+	BOOST_CHECK_EQUAL(CompressedImage::BlockSize(BlockFormat::BC1), 8u);
+	BOOST_CHECK_EQUAL(CompressedImage::BlockSize(BlockFormat::BC4), 8u);
+	BOOST_CHECK_EQUAL(CompressedImage::BlockSize(BlockFormat::BC3), 16u);
+	BOOST_CHECK_EQUAL(CompressedImage::BlockSize(BlockFormat::BC7), 16u);
+	BOOST_CHECK_EQUAL(
+		CompressedImage::DataSize(BlockFormat::BC1, 10, 5, 3),
+		3u*2u*3u*8u
+	);
+
+	images::Image image = make_image(10, 6);
+	CompressedImage bc7(
+		image,
+		images::BlockCompressionParams(BlockFormat::BC7)
+	);
+	BOOST_CHECK_EQUAL(bc7.Width(), 10);
+	BOOST_CHECK_EQUAL(bc7.Height(), 6);
+	BOOST_CHECK_EQUAL(bc7.DataSize(), 3u*2u*16u);
+	BOOST_CHECK(
+		bc7.InternalFormat() ==
+		PixelDataInternalFormat::CompressedRGBABPTCUNorm
+	);
+
+	CompressedImage bc5(
+		image,
+		images::BlockCompressionParams(BlockFormat::BC5).Signed()
+	);
+	BOOST_CHECK(bc5.IsSigned());
+	BOOST_CHECK(
+		bc5.InternalFormat() ==
+		PixelDataInternalFormat::CompressedSignedRGRGTC2
+	);
+
+	// the wrapped blocks decode the same way
+	CompressedImage copy(
+		bc7.Width(), bc7.Height(), bc7.Depth(), bc7.Data(),
+		images::BlockCompressionParams(BlockFormat::BC7)
+	);
+	images::Image d1 = bc7.Decompress(), d2 = copy.Decompress();
+	BOOST_CHECK(std::equal(
+		d1.Data<GLubyte>(),
+		d1.Data<GLubyte>()+d1.DataSize(),
+		d2.Data<GLubyte>()
+	));
+}
+
+BOOST_AUTO_TEST_CASE(ImagesCompressed_round_trip)
+{
+	using namespace oglplus;
+	using images::BlockFormat;
+	using images::BlockQuality;
+
+	images::Image image = make_image(64, 48);
+
+	const BlockFormat formats[5] = {
+		BlockFormat::BC1,
+		BlockFormat::BC3,
+		BlockFormat::BC4,
+		BlockFormat::BC5,
+		BlockFormat::BC7
+	};
+	// the channels compared, the minimal PSNR for Fast and High quality
+	const GLsizei channels[5] = {3, 4, 1, 2, 4};
+	const double min_psnr[5][2] = {
+		{34.0, 35.0},
+		{34.0, 35.0},
+		{45.0, 46.0},
+		{45.0, 46.0},
+		{36.0, 38.0}
+	};
+	for(std::size_t f=0; f!=5; ++f)
+	{
+		double last = 0.0;
+		const BlockQuality qualities[3] = {
+			BlockQuality::Fast,
+			BlockQuality::Normal,
+			BlockQuality::High
+		};
+		for(std::size_t q=0; q!=3; ++q)
+		{
+			images::CompressedImage compressed(
+				image,
+				images::BlockCompressionParams(formats[f]).
+					Quality(qualities[q])
+			);
+			images::Image decoded = compressed.Decompress();
+			BOOST_CHECK_EQUAL(decoded.Width(), image.Width());
+			BOOST_CHECK_EQUAL(decoded.Channels(), (f < 2)?4:channels[f]);
+
+			const double p = psnr(image, decoded, 0, channels[f]);
+			BOOST_TEST_MESSAGE(
+				"BC" << GLuint(formats[f]) <<
+				" quality " << q << ": " << p << " dB"
+			);
+			if(q != 1) BOOST_CHECK_GE(p, min_psnr[f][q/2]);
+			// higher quality must not be worse
+			BOOST_CHECK_GE(p, last-0.01);
+			last = p;
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE(ImagesCompressed_alpha)
+{
+	using namespace oglplus;
+
+	images::Image image = make_image(32, 32, true);
+	images::Image decoded = images::CompressedImage(image).Decompress();
+
+	// BC1 keeps the cut-out in the 1-bit alpha
+	const GLubyte* a = image.Data<GLubyte>();
+	const GLubyte* b = decoded.Data<GLubyte>();
+	std::size_t mismatch = 0;
+	for(std::size_t i=3; i<image.DataSize(); i+=4)
+	{
+		if(a[i] != b[i]) ++mismatch;
+	}
+	BOOST_CHECK_EQUAL(mismatch, 0u);
+
+	// BC3 has smooth alpha
+	images::Image bc3 = images::CompressedImage(
+		make_image(32, 32),
+		images::BlockCompressionParams(images::BlockFormat::BC3)
+	).Decompress();
+	BOOST_CHECK_GE(psnr(make_image(32, 32), bc3, 3, 1), 45.0);
+}
+
+BOOST_AUTO_TEST_CASE(ImagesCompressed_signed)
+{
+	using namespace oglplus;
+
+	// unit vectors in the xy plane
+	const GLsizei size = 32;
+	std::vector<GLfloat> data(size*size*2);
+	for(GLsizei y=0; y!=size; ++y)
+	for(GLsizei x=0; x!=size; ++x)
+	{
+		const double angle = x*0.1+y*0.15;
+		data[(y*size+x)*2+0] = GLfloat(std::cos(angle));
+		data[(y*size+x)*2+1] = GLfloat(std::sin(angle));
+	}
+	images::Image image(size, size, 1, 2, data.data());
+	images::Image decoded = images::CompressedImage(
+		image,
+		images::BlockCompressionParams(images::BlockFormat::BC5).
+			Signed()
+	).Decompress();
+
+	BOOST_CHECK(decoded.Type() == PixelDataType::Byte);
+	double max_error = 0.0;
+	for(GLsizei y=0; y!=size; ++y)
+	for(GLsizei x=0; x!=size; ++x)
+	for(GLsizei c=0; c!=2; ++c)
+	{
+		const double d =
+			image.Component(x, y, 0, c)-
+			decoded.Component(x, y, 0, c);
+		max_error = std::max(max_error, std::fabs(d));
+	}
+	BOOST_CHECK_LT(max_error, 0.06);
+}
+
+BOOST_AUTO_TEST_CASE(ImagesCompressed_bc7_modes)
+{
+	using namespace oglplus;
+
+	const images::BlockCompressionParams params(images::BlockFormat::BC7);
+	GLubyte block[16] = {0};
+
+	// the reserved mode decodes as transparent black
+	images::Image reserved =
+		images::CompressedImage(4, 4, 1, block, params).Decompress();
+	BOOST_CHECK_EQUAL(reserved.ComponentAs<GLubyte>(1, 2, 0, 3), 0);
+
+	// the partitioned modes are not supported
+	const unsigned modes[5] = {0, 1, 2, 3, 7};
+	for(std::size_t m=0; m!=5; ++m)
+	{
+		block[0] = GLubyte(1u << modes[m]);
+		BOOST_CHECK_THROW(
+			images::CompressedImage(4, 4, 1, block, params).Decompress(),
+			std::runtime_error
+		);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(ImagesCompressed_threads)
+{
+	using namespace oglplus;
+
+	images::Image image = make_image(256, 64);
+	const images::BlockFormat formats[3] = {
+		images::BlockFormat::BC1,
+		images::BlockFormat::BC5,
+		images::BlockFormat::BC7
+	};
+	for(std::size_t f=0; f!=3; ++f)
+	{
+		images::CompressedImage single(
+			image,
+			images::BlockCompressionParams(formats[f]).Threads(1)
+		);
+		images::CompressedImage parallel(
+			image,
+			images::BlockCompressionParams(formats[f]).Threads(4)
+		);
+		BOOST_REQUIRE_EQUAL(single.DataSize(), parallel.DataSize());
+		BOOST_CHECK(std::equal(
+			single.Data(),
+			single.Data()+single.DataSize(),
+			parallel.Data()
+		));
+	}
+}
+
+BOOST_AUTO_TEST_CASE(ImagesCompressed_upload)
+{
+	using namespace oglplus;
+
+	GLHeadlessRecorder recorder;
+	GLDispatchBackendScope scope(recorder);
+
+	images::CompressedMipmapChain mipmaps(
+		images::MipmapChain(make_image(16, 16)),
+		images::BlockCompressionParams(images::BlockFormat::BC7)
+	);
+	BOOST_CHECK_EQUAL(mipmaps.Levels(), 5u);
+	BOOST_CHECK_EQUAL(mipmaps.Level(4).DataSize(), 16u);
+
+	Texture::CompressedImage(Texture::Target::_2D, mipmaps);
+	BOOST_CHECK_EQUAL(recorder.CountOf("CompressedTexImage2D"), 5u);
+	BOOST_CHECK_EQUAL(recorder.CountOf("TexParameteri"), 1u);
+
+	recorder.Clear();
+	std::vector<GLubyte> faces(8*8*6*4, 0x80);
+	images::CompressedImage cube(
+		images::Image(8, 8, 6, 4, faces.data()),
+		images::BlockCompressionParams(images::BlockFormat::BC1)
+	);
+	Texture::CompressedImage(Texture::Target::CubeMap, cube);
+	BOOST_CHECK_EQUAL(recorder.CountOf("CompressedTexImage2D"), 6u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
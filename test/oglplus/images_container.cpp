@@ -0,0 +1,334 @@
+/**
+ *  .file test/oglplus/images_container.cpp
+ *  .brief Test case for the KTX and DDS image containers.
+ *
+ *  .author Matus Chochlik
+ *
+ *  Copyright 2011-2015 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE OGLPLUS_ImagesContainer
+#include <boost/test/unit_test.hpp>
+
+#define OGLPLUS_USE_GL_DISPATCH 1
+
+#include <oglplus/gl.hpp>
+#include <oglplus/config/fix_gl_version.hpp>
+#include <oglplus/texture.hpp>
+#include <oglplus/images/container.hpp>
+#include <oglplus/dispatch/recorder.hpp>
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <vector>
+
+static oglplus::images::Image make_image(
+	GLsizei w,
+	GLsizei h,
+	GLsizei d,
+	GLsizei c
+)
+{
+	std::vector<GLubyte> data(std::size_t(w)*h*d*c);
+	for(std::size_t i=0; i!=data.size(); ++i)
+	{
+		data[i] = GLubyte((i*37+i/7) & 0xFF);
+	}
+	return oglplus::images::Image(w, h, d, c, data.data());
+}
+
+static bool same_data(
+	const oglplus::images::Image& a,
+	const oglplus::images::Image& b
+)
+{
+	return	(a.Width() == b.Width()) &&
+		(a.Height() == b.Height()) &&
+		(a.Depth() == b.Depth()) &&
+		(a.Channels() == b.Channels()) &&
+		(a.DataSize() == b.DataSize()) &&
+		std::equal(
+			a.Data<GLubyte>(),
+			a.Data<GLubyte>()+a.DataSize(),
+			b.Data<GLubyte>()
+		);
+}
+
+BOOST_AUTO_TEST_SUITE(ImagesContainer)
+
+BOOST_AUTO_TEST_CASE(ImagesContainer_ktx_uncompressed)
+{
+	using namespace oglplus;
+	const char* path = "oglplus_test_container.ktx";
+
+	// the rows of the odd-sized RGB levels are padded in the file
+	images::MipmapChain mipmaps(make_image(5, 3, 1, 3));
+	images::SaveKTX(path, mipmaps);
+	{
+		images::ImageContainer container(path);
+		BOOST_CHECK(container.FileFormat()==images::ImageContainerFormat::KTX);
+		BOOST_CHECK_EQUAL(container.Width(), 5);
+		BOOST_CHECK_EQUAL(container.Height(), 3);
+		BOOST_CHECK_EQUAL(container.Levels(), mipmaps.Levels());
+		BOOST_CHECK_EQUAL(container.Layers(), 1u);
+		BOOST_CHECK_EQUAL(container.Faces(), 1u);
+		BOOST_CHECK(!container.IsCompressed());
+		BOOST_CHECK(container.Format() == PixelDataFormat::RGB);
+		BOOST_CHECK_EQUAL(container.RowAlignment(), 4u);
+		BOOST_CHECK_EQUAL(container.View(0).DataSize(), 16u*3u);
+
+		for(GLuint l=0; l!=container.Levels(); ++l)
+		{
+			BOOST_CHECK(same_data(
+				container.ToImage(l),
+				mipmaps.Level(l)
+			));
+		}
+
+		// the rows and columns can be mirrored
+		const images::Image& base = mipmaps.Level(0);
+		images::Image flipped = container.ToImage(0, false, false);
+		BOOST_REQUIRE_EQUAL(flipped.DataSize(), base.DataSize());
+		bool mirrored = true;
+		for(GLsizei y=0; y!=3; ++y)
+		for(GLsizei x=0; x!=5; ++x)
+		for(GLsizei c=0; c!=3; ++c)
+		{
+			mirrored &= (
+				flipped.ComponentAs<GLubyte>(x, y, 0, c) ==
+				base.ComponentAs<GLubyte>(4-x, 2-y, 0, c)
+			);
+		}
+		BOOST_CHECK(mirrored);
+	}
+	std::remove(path);
+}
+
+BOOST_AUTO_TEST_CASE(ImagesContainer_dds_uncompressed)
+{
+	using namespace oglplus;
+	const char* path = "oglplus_test_container.dds";
+
+	images::MipmapChain mipmaps(make_image(6, 4, 1, 4));
+	images::SaveDDS(path, mipmaps);
+	{
+		images::ImageContainer container(path);
+		BOOST_CHECK(container.FileFormat()==images::ImageContainerFormat::DDS);
+		BOOST_CHECK_EQUAL(container.Levels(), mipmaps.Levels());
+		BOOST_CHECK_EQUAL(container.RowAlignment(), 1u);
+		BOOST_CHECK(container.Type() == PixelDataType::UnsignedByte);
+		BOOST_CHECK(container.Format() == PixelDataFormat::RGBA);
+		for(GLuint l=0; l!=container.Levels(); ++l)
+		{
+			BOOST_CHECK(same_data(
+				container.ToImage(l),
+				mipmaps.Level(l)
+			));
+		}
+	}
+	std::remove(path);
+
+	// DDS has no 8-bit RGB format
+	BOOST_CHECK_THROW(
+		images::SaveDDS(path, images::MipmapChain(make_image(4, 4, 1, 3))),
+		std::runtime_error
+	);
+	std::remove(path);
+}
+
+BOOST_AUTO_TEST_CASE(ImagesContainer_compressed_cube_map)
+{
+	using namespace oglplus;
+	const char* paths[2] = {
+		"oglplus_test_cube_map.ktx",
+		"oglplus_test_cube_map.dds"
+	};
+
+	images::CompressedMipmapChain mipmaps(
+		images::MipmapChain(
+			make_image(8, 8, 6, 4),
+			images::MipmapParams().Layered()
+		),
+		images::BlockCompressionParams(images::BlockFormat::BC1)
+	);
+	images::SaveKTX(paths[0], mipmaps, true);
+	images::SaveDDS(paths[1], mipmaps, true);
+
+	GLHeadlessRecorder recorder;
+	GLDispatchBackendScope scope(recorder);
+
+	for(std::size_t p=0; p!=2; ++p)
+	{
+		images::ImageContainer container(paths[p]);
+		BOOST_CHECK(container.IsCompressed());
+		BOOST_CHECK_EQUAL(container.Faces(), 6u);
+		BOOST_CHECK_EQUAL(container.Layers(), 1u);
+		BOOST_REQUIRE_EQUAL(container.Levels(), mipmaps.Levels());
+		BOOST_CHECK(
+			container.InternalFormat() ==
+			mipmaps.Level(0).InternalFormat()
+		);
+
+		std::vector<GLubyte> buffer;
+		for(GLuint l=0; l!=container.Levels(); ++l)
+		{
+			const images::CompressedImage& level = mipmaps.Level(l);
+			const std::size_t face_size = level.DataSize()/6;
+			for(GLuint f=0; f!=6; ++f)
+			{
+				const images::ImageContainerView& view =
+					container.View(l, 0, f);
+				BOOST_CHECK_EQUAL(view.Width(), level.Width());
+				BOOST_REQUIRE_EQUAL(view.DataSize(), face_size);
+				BOOST_CHECK(std::equal(
+					view.Data(),
+					view.Data()+face_size,
+					level.Data()+f*face_size
+				));
+			}
+			const GLubyte* data = container.LevelData(l, buffer);
+			BOOST_CHECK(std::equal(
+				data,
+				data+level.DataSize(),
+				level.Data()
+			));
+		}
+		BOOST_CHECK_EQUAL(container.ToImage(0).Depth(), 6);
+
+		// the decompressed rows can be reversed too
+		images::Image upright = container.ToImage(0);
+		images::Image flipped = container.ToImage(0, false);
+		bool mirrored = true;
+		for(GLsizei z=0; z!=6; ++z)
+		for(GLsizei y=0; y!=8; ++y)
+		{
+			mirrored &= (
+				flipped.ComponentAs<GLubyte>(3, y, z, 0) ==
+				upright.ComponentAs<GLubyte>(3, 7-y, z, 0)
+			);
+		}
+		BOOST_CHECK(mirrored);
+
+		recorder.Clear();
+		Texture::Image(Texture::Target::CubeMap, container);
+		BOOST_CHECK_EQUAL(
+			recorder.CountOf("CompressedTexImage2D"),
+			6u*container.Levels()
+		);
+		BOOST_CHECK_EQUAL(recorder.CountOf("PixelStorei"), 1u);
+		BOOST_CHECK_EQUAL(recorder.CountOf("TexParameteri"), 1u);
+	}
+
+	// a container without six faces is not a cube map
+	images::SaveKTX(paths[0], images::MipmapChain(make_image(4, 4, 1, 4)));
+	BOOST_CHECK_THROW(
+		Texture::Image(
+			Texture::Target::CubeMap,
+			images::ImageContainer(paths[0])
+		),
+		std::runtime_error
+	);
+	std::remove(paths[0]);
+	std::remove(paths[1]);
+}
+
+BOOST_AUTO_TEST_CASE(ImagesContainer_compressed_array)
+{
+	using namespace oglplus;
+	const char* path = "oglplus_test_array.ktx";
+
+	images::CompressedMipmapChain mipmaps(
+		images::MipmapChain(
+			make_image(16, 8, 3, 4),
+			images::MipmapParams().Layered()
+		),
+		images::BlockCompressionParams(images::BlockFormat::BC7)
+	);
+	images::SaveKTX(path, mipmaps);
+	{
+		images::ImageContainer container(path);
+		BOOST_CHECK(container.IsMapped());
+		BOOST_CHECK_EQUAL(container.Layers(), 3u);
+		BOOST_CHECK_EQUAL(container.Depth(), 1);
+
+		// the layers of a level are contiguous in the mapped file
+		std::vector<GLubyte> buffer;
+		for(GLuint l=0; l!=container.Levels(); ++l)
+		{
+			BOOST_CHECK(
+				container.LevelData(l, buffer) ==
+				container.View(l).Data()
+			);
+			BOOST_CHECK_EQUAL(
+				container.LevelDataSize(l),
+				mipmaps.Level(l).DataSize()
+			);
+		}
+		BOOST_CHECK(buffer.empty());
+
+		GLHeadlessRecorder recorder;
+		GLDispatchBackendScope scope(recorder);
+		Texture::Image(Texture::Target::_2DArray, container);
+		BOOST_CHECK_EQUAL(
+			recorder.CountOf("CompressedTexImage3D"),
+			std::size_t(container.Levels())
+		);
+	}
+	std::remove(path);
+}
+
+BOOST_AUTO_TEST_CASE(ImagesContainer_invalid)
+{
+	using namespace oglplus;
+	const char* path = "oglplus_test_invalid.ktx";
+
+	BOOST_CHECK_THROW(
+		images::ImageContainer("oglplus_test_missing.ktx"),
+		std::runtime_error
+	);
+
+	{
+		std::ofstream file(path, std::ios::binary);
+		file << "not an image container";
+	}
+	BOOST_CHECK_THROW(
+		images::ImageContainer(std::string(path)),
+		std::runtime_error
+	);
+
+	// a truncated file
+	images::SaveKTX(path, images::MipmapChain(make_image(8, 8, 1, 4)));
+	std::vector<char> data;
+	{
+		std::ifstream file(path, std::ios::binary);
+		data.assign(
+			std::istreambuf_iterator<char>(file),
+			std::istreambuf_iterator<char>()
+		);
+	}
+	{
+		std::ofstream file(path, std::ios::binary);
+		file.write(data.data(), std::streamsize(data.size()-5));
+	}
+	BOOST_CHECK_THROW(
+		images::ImageContainer(std::string(path)),
+		std::runtime_error
+	);
+
+	// reading from a stream
+	{
+		std::ofstream file(path, std::ios::binary);
+		file.write(data.data(), std::streamsize(data.size()));
+	}
+	std::ifstream file(path, std::ios::binary);
+	images::ImageContainer container(file);
+	BOOST_CHECK(!container.IsMapped());
+	BOOST_CHECK_EQUAL(container.Width(), 8);
+	std::remove(path);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,173 @@
+/**
+ *  .file test/oglplus/images_mipmap.cpp
+ *  .brief Test case for the CPU mipmap chain generation.
+ *
+ *  .author Matus Chochlik
+ *
+ *  Copyright 2011-2015 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE OGLPLUS_ImagesMipmap
+#include <boost/test/unit_test.hpp>
+
+#define OGLPLUS_USE_GL_DISPATCH 1
+
+#include <oglplus/gl.hpp>
+#include <oglplus/config/fix_gl_version.hpp>
+#include <oglplus/texture.hpp>
+#include <oglplus/images/mipmap.hpp>
+#include <oglplus/dispatch/recorder.hpp>
+
+#include <vector>
+#include <stdexcept>
+
+BOOST_AUTO_TEST_SUITE(ImagesMipmap)
+
+BOOST_AUTO_TEST_CASE(ImagesMipmap_dimensions)
+{
+	using namespace oglplus;
+
+	std::vector<GLubyte> data(16*4*3*4, 0x80);
+	images::Image base(16, 4, 3, 4, data.data());
+
+	images::MipmapChain volume(base);
+	BOOST_CHECK_EQUAL(volume.Levels(), 5u);
+	BOOST_CHECK_EQUAL(volume.Level(1).Width(), 8);
+	BOOST_CHECK_EQUAL(volume.Level(1).Height(), 2);
+	BOOST_CHECK_EQUAL(volume.Level(1).Depth(), 1);
+	BOOST_CHECK_EQUAL(volume.Level(4).Width(), 1);
+	BOOST_CHECK_EQUAL(volume.Level(4).Height(), 1);
+	BOOST_CHECK(volume.Level(4).Type() == PixelDataType::UnsignedByte);
+
+	images::MipmapChain layered(base, images::MipmapParams().Layered());
+	BOOST_CHECK_EQUAL(layered.Levels(), 5u);
+	BOOST_CHECK_EQUAL(layered.Level(4).Depth(), 3);
+
+	images::MipmapChain limited(base, images::MipmapParams().MaxLevels(2));
+	BOOST_CHECK_EQUAL(limited.Levels(), 2u);
+}
+
+BOOST_AUTO_TEST_CASE(ImagesMipmap_box)
+{
+	using namespace oglplus;
+
+	const GLfloat data[4*2] = {
+		0.0f, 1.0f, 2.0f, 3.0f,
+		4.0f, 5.0f, 6.0f, 7.0f
+	};
+	images::Image base(4, 2, 1, 1, data);
+	images::MipmapChain mipmaps(base);
+
+	BOOST_REQUIRE_EQUAL(mipmaps.Levels(), 3u);
+	const GLfloat* level1 = mipmaps.Level(1).Data<GLfloat>();
+	BOOST_CHECK_CLOSE(level1[0], 2.5f, 0.001f);
+	BOOST_CHECK_CLOSE(level1[1], 4.5f, 0.001f);
+	BOOST_CHECK_CLOSE(mipmaps.Level(2).Data<GLfloat>()[0], 3.5f, 0.001f);
+}
+
+BOOST_AUTO_TEST_CASE(ImagesMipmap_srgb)
+{
+	using namespace oglplus;
+
+	const GLubyte data[2*4] = {
+		0x00, 0x00, 0x00, 0x00,
+		0xFF, 0xFF, 0xFF, 0xFF
+	};
+	images::Image base(2, 1, 1, 4, data);
+
+	images::MipmapChain linear(base);
+	const GLubyte* l = linear.Level(1).Data<GLubyte>();
+	BOOST_CHECK_EQUAL(int(l[0]), 0x80);
+	BOOST_CHECK_EQUAL(int(l[3]), 0x80);
+
+	images::MipmapChain srgb(base, images::MipmapParams().SRGB());
+	const GLubyte* s = srgb.Level(1).Data<GLubyte>();
+	// 0.5 in linear space is 0.735 in sRGB
+	BOOST_CHECK_EQUAL(int(s[0]), 188);
+	BOOST_CHECK_EQUAL(int(s[2]), 188);
+	// alpha is always linear
+	BOOST_CHECK_EQUAL(int(s[3]), 0x80);
+}
+
+BOOST_AUTO_TEST_CASE(ImagesMipmap_filters)
+{
+	using namespace oglplus;
+
+	const std::size_t size = 256;
+	std::vector<GLfloat> data(size*size);
+	for(std::size_t i=0; i!=data.size(); ++i)
+	{
+		data[i] = ((i/7)%2)?0.25f:0.75f;
+	}
+	images::Image base(size, size, 1, 1, data.data());
+
+	const images::MipmapFilter filters[3] = {
+		images::MipmapFilter::Box,
+		images::MipmapFilter::Kaiser,
+		images::MipmapFilter::Lanczos
+	};
+	for(std::size_t f=0; f!=3; ++f)
+	{
+		images::MipmapChain single(
+			base,
+			images::MipmapParams().Filter(filters[f]).Threads(1)
+		);
+		images::MipmapChain parallel(
+			base,
+			images::MipmapParams().Filter(filters[f]).Threads(4)
+		);
+		BOOST_REQUIRE_EQUAL(single.Levels(), parallel.Levels());
+
+		for(std::size_t l=0; l!=single.Levels(); ++l)
+		{
+			const images::Image& a = single.Level(l);
+			const images::Image& b = parallel.Level(l);
+			BOOST_CHECK(std::equal(
+				a.Data<GLfloat>(),
+				a.Data<GLfloat>()+a.Width()*a.Height(),
+				b.Data<GLfloat>()
+			));
+		}
+		// the filters preserve the average intensity
+		GLfloat last = single.Level(single.Levels()-1).Data<GLfloat>()[0];
+		BOOST_CHECK_CLOSE(last, 0.5f, 2.0f);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(ImagesMipmap_upload)
+{
+	using namespace oglplus;
+
+	GLHeadlessRecorder recorder;
+	GLDispatchBackendScope scope(recorder);
+
+	std::vector<GLubyte> data(8*8*6*3, 0x40);
+	images::Image base(8, 8, 6, 3, data.data());
+
+	images::MipmapChain planar(images::Image(8, 8, 1, 3, data.data()));
+	Texture::Image(Texture::Target::_2D, planar);
+	BOOST_CHECK_EQUAL(recorder.CountOf("TexImage2D"), 4u);
+	BOOST_CHECK_EQUAL(recorder.CountOf("TexParameteri"), 1u);
+
+	recorder.Clear();
+	images::MipmapChain cube(base, images::MipmapParams().Layered());
+	Texture::Image(Texture::Target::CubeMap, cube);
+	BOOST_CHECK_EQUAL(recorder.CountOf("TexImage2D"), 6u*4u);
+
+	// the faces of a cube map must be the layers of the images
+	recorder.Clear();
+	images::MipmapChain volume(base);
+	BOOST_CHECK_THROW(
+		Texture::Image(Texture::Target::CubeMap, volume),
+		std::runtime_error
+	);
+	BOOST_CHECK_THROW(
+		Texture::Image(Texture::Target::CubeMap, planar),
+		std::runtime_error
+	);
+	BOOST_CHECK_EQUAL(recorder.CountOf("TexImage2D"), 0u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
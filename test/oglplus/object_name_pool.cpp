@@ -0,0 +1,184 @@
+/**
+ *  .file test/oglplus/object_name_pool.cpp
+ *  .brief Test case for the pools of object names.
+ *
+ *  .author Matus Chochlik
+ *
+ *  Copyright 2011-2015 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE OGLPLUS_ObjectNamePool
+#include <boost/test/unit_test.hpp>
+
+#define OGLPLUS_USE_GL_DISPATCH 1
+
+#include <oglplus/gl.hpp>
+#include <oglplus/config/fix_gl_version.hpp>
+#include <oglplus/buffer.hpp>
+#include <oglplus/query.hpp>
+#include <oglplus/dispatch/recorder.hpp>
+
+#include <set>
+#include <thread>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(ObjectNamePooling)
+
+BOOST_AUTO_TEST_CASE(ObjectNamePool_batches)
+{
+	using namespace oglplus;
+
+	GLHeadlessRecorder recorder;
+	GLDispatchBackendScope scope(recorder);
+
+	{
+		ObjectNamePool<tag::Buffer> pool(16);
+		ObjectNamePoolScope<tag::Buffer> pool_scope(pool);
+
+		std::set<GLuint> names;
+		{
+			std::vector<Buffer> buffers(40);
+			for(auto i=buffers.begin(), e=buffers.end(); i!=e; ++i)
+			{
+				names.insert(GetGLName(*i));
+			}
+		}
+		BOOST_CHECK_EQUAL(names.size(), 40u);
+		BOOST_CHECK(names.find(0) == names.end());
+		BOOST_CHECK_EQUAL(recorder.CountOf("GenBuffers"), 3u);
+		BOOST_CHECK_EQUAL(pool.Stats().generated, 48u);
+		BOOST_CHECK_EQUAL(pool.Available(), 8u);
+
+		// the returned names are deleted in batches
+		BOOST_CHECK_EQUAL(recorder.CountOf("DeleteBuffers"), 2u);
+		BOOST_CHECK_EQUAL(pool.Stats().deleted, 32u);
+		BOOST_CHECK_EQUAL(pool.Pending(), 8u);
+
+		pool.Flush();
+		BOOST_CHECK_EQUAL(recorder.CountOf("DeleteBuffers"), 3u);
+		BOOST_CHECK_EQUAL(pool.Pending(), 0u);
+		BOOST_CHECK_EQUAL(pool.Stats().recycled, 0u);
+	}
+	// the remaining fresh names are deleted with the pool
+	BOOST_CHECK_EQUAL(recorder.CountOf("DeleteBuffers"), 4u);
+
+	// without an installed pool the names are generated one by one
+	recorder.Clear();
+	{
+		Buffer a, b;
+	}
+	BOOST_CHECK_EQUAL(recorder.CountOf("GenBuffers"), 2u);
+	BOOST_CHECK_EQUAL(recorder.CountOf("DeleteBuffers"), 2u);
+}
+
+BOOST_AUTO_TEST_CASE(ObjectNamePool_recycling)
+{
+	using namespace oglplus;
+
+	GLHeadlessRecorder recorder;
+	GLDispatchBackendScope scope(recorder);
+
+	ObjectNamePool<tag::Query> pool(8, true);
+	ObjectNamePoolScope<tag::Query> pool_scope(pool);
+
+	std::set<GLuint> names;
+	for(int frame=0; frame!=100; ++frame)
+	{
+		std::vector<Query> queries(4);
+		for(auto i=queries.begin(), e=queries.end(); i!=e; ++i)
+		{
+			names.insert(GetGLName(*i));
+		}
+	}
+	// the same four names are used in each frame
+	BOOST_CHECK_EQUAL(names.size(), 4u);
+	BOOST_CHECK_EQUAL(recorder.CountOf("GenQueries"), 1u);
+	BOOST_CHECK_EQUAL(recorder.CountOf("DeleteQueries"), 0u);
+	BOOST_CHECK_EQUAL(pool.Stats().recycled, 99u*4u);
+
+	// the names beyond the capacity of the pool are deleted
+	{
+		std::vector<Query> queries(20);
+	}
+	BOOST_CHECK_EQUAL(recorder.CountOf("GenQueries"), 3u);
+	BOOST_CHECK_EQUAL(pool.Available(), 12u);
+	BOOST_CHECK_EQUAL(pool.Pending(), 4u);
+	BOOST_CHECK_EQUAL(recorder.CountOf("DeleteQueries"), 1u);
+
+	pool.Clear();
+	BOOST_CHECK_EQUAL(pool.Available(), 0u);
+	BOOST_CHECK_EQUAL(pool.Pending(), 0u);
+	BOOST_CHECK_EQUAL(pool.Stats().deleted, 24u);
+}
+
+BOOST_AUTO_TEST_CASE(ObjectNamePool_foreign_names)
+{
+	using namespace oglplus;
+
+	GLHeadlessRecorder recorder;
+	GLDispatchBackendScope scope(recorder);
+
+	ObjectNamePool<tag::Query> pool(8, true);
+	{
+		// created before the pool was installed
+		Query before;
+		ObjectNamePoolScope<tag::Query> pool_scope(pool);
+		Query pooled;
+#if GL_VERSION_4_5 || GL_ARB_direct_state_access
+		// created with DSA, not taken from the pool
+		Query created(tag::Create(), QueryTarget::TimeElapsed);
+		BOOST_CHECK_EQUAL(recorder.CountOf("CreateQueries"), 1u);
+#endif
+		BOOST_CHECK_EQUAL(recorder.CountOf("GenQueries"), 2u);
+		recorder.Clear();
+	}
+	// only the pooled name is kept by the pool for recycling
+	BOOST_CHECK_EQUAL(pool.Available(), 8u);
+#if GL_VERSION_4_5 || GL_ARB_direct_state_access
+	BOOST_CHECK_EQUAL(recorder.CountOf("DeleteQueries"), 2u);
+#else
+	BOOST_CHECK_EQUAL(recorder.CountOf("DeleteQueries"), 1u);
+#endif
+
+	// the names of objects outliving the pool are deleted directly
+	recorder.Clear();
+	{
+		ObjectNamePool<tag::Buffer> buffer_pool(4);
+		std::vector<Buffer> buffers;
+		{
+			ObjectNamePoolScope<tag::Buffer> pool_scope(buffer_pool);
+			buffers.resize(2);
+		}
+		ObjectNamePool<tag::Buffer> other_pool(4);
+		ObjectNamePoolScope<tag::Buffer> pool_scope(other_pool);
+		buffers.clear();
+		BOOST_CHECK_EQUAL(recorder.CountOf("DeleteBuffers"), 2u);
+		BOOST_CHECK_EQUAL(other_pool.Pending(), 0u);
+		BOOST_CHECK_EQUAL(other_pool.Stats().generated, 0u);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(ObjectNamePool_per_thread)
+{
+	using namespace oglplus;
+
+	ObjectNamePool<tag::Buffer> pool;
+	ObjectNamePoolScope<tag::Buffer> pool_scope(pool);
+	BOOST_CHECK(ObjectNamePool<tag::Buffer>::Current() == &pool);
+
+	ObjectNamePool<tag::Buffer>* other = &pool;
+	std::thread thread([&other](void)
+	{
+		other = ObjectNamePool<tag::Buffer>::Current();
+	});
+	thread.join();
+#if !OGLPLUS_NO_THREAD_LOCAL
+	BOOST_CHECK(other == nullptr);
+#else
+	BOOST_CHECK(other == &pool);
+#endif
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -107,3 +107,18 @@ endfunction()
 function(oglplus_exec_test_no_fixture TEST_NAME)
 	add_oglplus_test(${TEST_NAME} "" FALSE)
 endfunction()
+
+function(oglplus_exec_test_headless TEST_NAME)
+	add_oglplus_test(${TEST_NAME} "${OGLPLUS_GL_LIBRARIES}" FALSE)
+endfunction()
+
+# links a test using std::thread with the threading library
+function(oglplus_test_use_threads TEST_NAME)
+	if(THREADS_FOUND)
+		set_property(
+			TARGET ${TEST_NAME}
+			APPEND_STRING PROPERTY COMPILE_FLAGS " ${THREADS_CXXFLAGS}"
+		)
+		target_link_libraries(${TEST_NAME} ${THREADS_LIBRARIES})
+	endif()
+endfunction()
@@ -0,0 +1,190 @@
+/**
+ *  .file test/oglplus/profile.cpp
+ *  .brief Test case for the GL call profiling instrumentation.
+ *
+ *  .author Matus Chochlik
+ *
+ *  Copyright 2011-2015 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE OGLPLUS_Profile
+#include <boost/test/unit_test.hpp>
+
+#define OGLPLUS_USE_GL_DISPATCH 1
+#define OGLPLUS_PROFILE_GL_CALLS 1
+
+#include <oglplus/gl.hpp>
+#include <oglplus/config/fix_gl_version.hpp>
+#include <oglplus/buffer.hpp>
+#include <oglplus/program.hpp>
+#include <oglplus/uniform.hpp>
+#include <oglplus/profile/call.hpp>
+#include <oglplus/dispatch/recorder.hpp>
+
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// backend swallowing all calls, usable from any thread
+class NullBackend
+ : public oglplus::GLDispatchBackend
+{
+public:
+	bool BeginCall(oglplus::GLCallInfo&) { return false; }
+	void EndCall(oglplus::GLCallInfo&) { }
+};
+
+// uses the checks of the wrapper classes in an unbraced if
+struct CheckInIf
+{
+	OGLPLUS_ERROR_CONTEXT(BindBuffer, Buffer)
+
+	static bool Check(bool check)
+	{
+		if(check)
+			OGLPLUS_CHECK_CTXT(oglplus::Error, NoInfo());
+		else return false;
+		return true;
+	}
+};
+
+BOOST_AUTO_TEST_SUITE(Profile)
+
+BOOST_AUTO_TEST_CASE(Profile_functions_and_classes)
+{
+	using namespace oglplus;
+
+	GLHeadlessRecorder recorder;
+	GLDispatchBackendScope scope(recorder);
+
+	Buffer buffer;
+	Program prog;
+	Uniform<GLfloat> scale(prog, "Scale");
+	recorder.Clear();
+
+	GLCallProfile before = GLCallProfile::Snapshot();
+
+	for(int i=0; i!=5; ++i)
+	{
+		buffer.Bind(Buffer::Target::Array);
+	}
+	scale.Set(1.0f);
+	scale.Set(2.0f);
+
+	GLCallProfile profile = GLCallProfile::Snapshot().Since(before);
+
+	const GLCallProfileEntry* bind = profile.Find("BindBuffer");
+	BOOST_REQUIRE(bind != nullptr);
+	BOOST_CHECK_EQUAL(bind->count, 5u);
+
+	const GLCallProfileEntry* uniform = profile.Find(
+		"Uniform",
+		GLCallProfileKind::Class
+	);
+	BOOST_REQUIRE(uniform != nullptr);
+	BOOST_CHECK_EQUAL(uniform->count, 2u);
+
+	BOOST_CHECK(profile.Find("GetError") != nullptr);
+	BOOST_CHECK(profile.Find("NoSuchFunction") == nullptr);
+	BOOST_CHECK_EQUAL(profile.CallCount(), recorder.CallCount());
+
+	std::stringstream text, json;
+	profile.Report(text);
+	profile.ReportJSON(json);
+	BOOST_CHECK(text.str().find("glBindBuffer: 5 calls") != std::string::npos);
+	BOOST_CHECK(json.str().find("{\"name\":\"BindBuffer\",\"count\":5,") !=
+		std::string::npos
+	);
+	BOOST_CHECK(json.str().find("\"classes\":[{\"name\":\"Uniform\"") !=
+		std::string::npos
+	);
+}
+
+BOOST_AUTO_TEST_CASE(Profile_threads)
+{
+	using namespace oglplus;
+
+	NullBackend backend;
+	GLDispatchBackendScope scope(backend);
+
+	GLCallProfile before = GLCallProfile::Snapshot();
+
+	auto work = [](void)
+	{
+		for(int i=0; i!=1000; ++i)
+		{
+			OGLPLUS_GLFUNC(Flush)();
+		}
+	};
+	std::thread t1(work), t2(work);
+	t1.join();
+	t2.join();
+	work();
+
+	GLCallProfile profile = GLCallProfile::Snapshot().Since(before);
+	const GLCallProfileEntry* flush = profile.Find("Flush");
+	BOOST_REQUIRE(flush != nullptr);
+	BOOST_CHECK_EQUAL(flush->count, 3000u);
+}
+
+BOOST_AUTO_TEST_CASE(Profile_check_statement)
+{
+	using namespace oglplus;
+
+	GLHeadlessRecorder recorder;
+	GLDispatchBackendScope scope(recorder);
+
+	BOOST_CHECK(!CheckInIf::Check(false));
+	BOOST_CHECK_EQUAL(recorder.CountOf("GetError"), 0u);
+	BOOST_CHECK(CheckInIf::Check(true));
+	BOOST_CHECK_EQUAL(recorder.CountOf("GetError"), 1u);
+}
+
+BOOST_AUTO_TEST_CASE(Profile_overflow)
+{
+	using namespace oglplus;
+
+	// exhaust the slots with functions and then register a class
+	std::vector<std::string> names;
+	for(std::size_t i=0; i!=aux::GLCallCounters::MaxSlots; ++i)
+	{
+		std::stringstream name;
+		name << "Overflow" << i;
+		names.push_back(name.str());
+	}
+	std::size_t func_slot = 0;
+	for(auto i=names.begin(), e=names.end(); i!=e; ++i)
+	{
+		func_slot = aux::GLCallCounters::Slot(
+			i->c_str(),
+			GLCallProfileKind::Function
+		);
+	}
+	std::size_t class_slot = aux::GLCallCounters::Slot(
+		"OverflowClass",
+		GLCallProfileKind::Class
+	);
+	BOOST_CHECK(func_slot != class_slot);
+
+	GLCallProfile before = GLCallProfile::Snapshot();
+	aux::GLCallCounters::Local().Add(func_slot, 10);
+	aux::GLCallCounters::Local().AddLast(class_slot);
+	GLCallProfile profile = GLCallProfile::Snapshot().Since(before);
+
+	const GLCallProfileEntry* other_func = profile.Find("(other)");
+	const GLCallProfileEntry* other_class = profile.Find(
+		"(other)",
+		GLCallProfileKind::Class
+	);
+	BOOST_REQUIRE(other_func != nullptr);
+	BOOST_REQUIRE(other_class != nullptr);
+	BOOST_CHECK_EQUAL(other_func->count, 1u);
+	BOOST_CHECK_EQUAL(other_class->count, 1u);
+	// the overflowing class is not counted as a GL call
+	BOOST_CHECK_EQUAL(profile.CallCount(), 1u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,277 @@
+/**
+ *  .file test/oglplus/prog_var_cache.cpp
+ *  .brief Test case for the program variable location and type cache.
+ *
+ *  .author Matus Chochlik
+ *
+ *  Copyright 2011-2015 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE OGLPLUS_ProgVarCaching
+#include <boost/test/unit_test.hpp>
+
+#define OGLPLUS_USE_GL_DISPATCH 1
+#define OGLPLUS_CACHE_PROG_VARS 1
+
+#include <oglplus/gl.hpp>
+#include <oglplus/config/fix_gl_version.hpp>
+#include <oglplus/math/vector.hpp>
+#include <oglplus/program.hpp>
+#include <oglplus/uniform.hpp>
+#include <oglplus/prog_var/cache.hpp>
+#include <oglplus/dispatch/recorder.hpp>
+
+#include <cstring>
+#include <thread>
+
+// headless recorder emulating a program with a few active uniforms
+class UniformRecorder
+ : public oglplus::GLHeadlessRecorder
+{
+private:
+	struct _uniform
+	{
+		const char* name;
+		GLenum type;
+		GLint size;
+		GLint location;
+	};
+
+	static const _uniform* _uniforms(void)
+	{
+		static const _uniform uniforms[3] = {
+			{"Scale", GL_FLOAT, 1, 7},
+			{"Color", GL_FLOAT_VEC4, 1, 9},
+			{"Offsets[0]", GL_FLOAT, 4, 11}
+		};
+		return uniforms;
+	}
+
+	template <typename T>
+	static T* _out(oglplus::GLCallInfo& call, std::size_t i)
+	{
+		return static_cast<T*>(call.args[i].value.p);
+	}
+protected:
+	void Emulate(oglplus::GLCallInfo& call)
+	{
+		oglplus::GLHeadlessRecorder::Emulate(call);
+		if(std::strcmp(call.name, "GetProgramiv") == 0)
+		{
+			switch(GLenum(call.args[1].value.i))
+			{
+				case GL_ACTIVE_UNIFORMS:
+					*_out<GLint>(call, 2) = 3;
+					break;
+				case GL_ACTIVE_UNIFORM_MAX_LENGTH:
+					*_out<GLint>(call, 2) = 16;
+					break;
+				default:;
+			}
+		}
+		else if(std::strcmp(call.name, "GetActiveUniform") == 0)
+		{
+			const _uniform& u = _uniforms()[call.args[1].value.i];
+			GLsizei len = GLsizei(std::strlen(u.name));
+			GLsizei max = GLsizei(call.args[2].value.i)-1;
+			if(len > max) len = max;
+			*_out<GLsizei>(call, 3) = len;
+			*_out<GLint>(call, 4) = u.size;
+			*_out<GLenum>(call, 5) = u.type;
+			std::strncpy(_out<GLchar>(call, 6), u.name, len);
+			_out<GLchar>(call, 6)[len] = '\0';
+		}
+		else if(std::strcmp(call.name, "GetActiveUniformsiv") == 0)
+		{
+			for(long long i=0; i!=call.args[1].value.i; ++i)
+			{
+				_out<GLint>(call, 4)[i] = -1;
+			}
+		}
+		else if(std::strcmp(call.name, "GetUniformLocation") == 0)
+		{
+			const char* name = static_cast<const char*>(
+				call.args[1].value.p
+			);
+			call.result.value.i = -1;
+			for(std::size_t i=0; i!=3; ++i)
+			{
+				if(std::strcmp(_uniforms()[i].name, name) == 0)
+				{
+					call.result.value.i = _uniforms()[i].location;
+				}
+			}
+			if(std::strcmp(name, "Offsets[2]") == 0)
+			{
+				call.result.value.i = 13;
+			}
+		}
+	}
+};
+
+template <typename T>
+using CheckedUniform = oglplus::ProgVar<
+	oglplus::tag::ImplicitSel,
+	oglplus::tag::Uniform,
+	oglplus::tag::Typecheck,
+	T
+>;
+
+BOOST_AUTO_TEST_SUITE(ProgVarCaching)
+
+BOOST_AUTO_TEST_CASE(ProgVarCaching_fill_once)
+{
+	using namespace oglplus;
+
+	UniformRecorder recorder;
+	GLDispatchBackendScope scope(recorder);
+
+	Program prog;
+	prog.Link();
+	ProgVarCache::ResetStats();
+	recorder.Clear();
+
+	CheckedUniform<GLfloat> scale(prog, "Scale");
+	BOOST_CHECK_EQUAL(scale.Location(), 7);
+	BOOST_CHECK_EQUAL(recorder.CountOf("GetActiveUniform"), 3u);
+	BOOST_CHECK_EQUAL(ProgVarCache::Stats().fills, 1u);
+
+	recorder.Clear();
+	CheckedUniform<Vec4f> color(prog, "Color");
+	CheckedUniform<GLfloat> scale2(prog, "Scale");
+	BOOST_CHECK_EQUAL(color.Location(), 9);
+	BOOST_CHECK_EQUAL(scale2.Location(), 7);
+	BOOST_CHECK_EQUAL(recorder.CountOf("GetUniformLocation"), 0u);
+	BOOST_CHECK_EQUAL(recorder.CountOf("GetActiveUniform"), 0u);
+	BOOST_CHECK_EQUAL(recorder.CountOf("GetProgramiv"), 0u);
+	BOOST_CHECK_EQUAL(ProgVarCache::Stats().fills, 1u);
+	BOOST_CHECK_EQUAL(ProgVarCache::Stats().misses, 0u);
+}
+
+BOOST_AUTO_TEST_CASE(ProgVarCaching_entries)
+{
+	using namespace oglplus;
+
+	UniformRecorder recorder;
+	GLDispatchBackendScope scope(recorder);
+
+	Program prog;
+	prog.Link();
+
+	const ProgVarCacheEntry* entry =
+		ProgVarCache::FindUniform(prog, "Offsets[0]");
+	BOOST_REQUIRE(entry != nullptr);
+	BOOST_CHECK_EQUAL(entry->location, 11);
+	BOOST_CHECK_EQUAL(entry->size, 4);
+	BOOST_CHECK_EQUAL(entry->type, GLenum(GL_FLOAT));
+	BOOST_CHECK_EQUAL(entry->block_index, -1);
+	BOOST_CHECK(entry->listed);
+
+	BOOST_CHECK(ProgVarCache::FindUniform(prog, "Missing") == nullptr);
+	BOOST_CHECK_EQUAL(
+		ProgVarCache::UniformType(prog, "Scale"),
+		GLenum(GL_FLOAT)
+	);
+	BOOST_CHECK_EQUAL(
+		ProgVarCache::UniformType(prog, "Scal"),
+		GLenum(GL_NONE)
+	);
+
+	// arrays can be looked up with and without the [0] suffix
+	BOOST_CHECK_EQUAL(ProgVarCache::UniformLocation(prog, "Offsets"), 11);
+
+	// unlisted identifiers are queried once
+	recorder.Clear();
+	BOOST_CHECK_EQUAL(ProgVarCache::UniformLocation(prog, "Offsets[2]"), 13);
+	BOOST_CHECK_EQUAL(ProgVarCache::UniformLocation(prog, "Offsets[2]"), 13);
+	BOOST_CHECK_EQUAL(recorder.CountOf("GetUniformLocation"), 1u);
+}
+
+BOOST_AUTO_TEST_CASE(ProgVarCaching_type_mismatch)
+{
+	using namespace oglplus;
+
+	UniformRecorder recorder;
+	GLDispatchBackendScope scope(recorder);
+
+	Program prog;
+	prog.Link();
+
+	CheckedUniform<Vec4f> color(prog, "Color");
+	BOOST_CHECK_EQUAL(color.Location(), 9);
+	BOOST_CHECK_THROW(
+		CheckedUniform<GLfloat>(prog, "Color"),
+		ProgVarError
+	);
+	BOOST_CHECK_THROW(
+		CheckedUniform<GLfloat>(prog, "Missing"),
+		ProgVarError
+	);
+}
+
+BOOST_AUTO_TEST_CASE(ProgVarCaching_invalidation)
+{
+	using namespace oglplus;
+
+	UniformRecorder recorder;
+	GLDispatchBackendScope scope(recorder);
+
+	Program prog;
+	prog.Link();
+	ProgVarCache::ResetStats();
+
+	Uniform<GLfloat>(prog, "Scale");
+	Uniform<GLfloat>(prog, "Scale");
+	BOOST_CHECK_EQUAL(ProgVarCache::Stats().fills, 1u);
+
+	prog.Link();
+	BOOST_CHECK_EQUAL(ProgVarCache::Stats().invalidations, 1u);
+
+	recorder.Clear();
+	Uniform<GLfloat>(prog, "Scale");
+	BOOST_CHECK_EQUAL(ProgVarCache::Stats().fills, 2u);
+	BOOST_CHECK_EQUAL(recorder.CountOf("GetActiveUniform"), 3u);
+
+	ProgVarCache::Clear();
+	Uniform<GLfloat>(prog, "Scale");
+	BOOST_CHECK_EQUAL(ProgVarCache::Stats().fills, 3u);
+}
+
+BOOST_AUTO_TEST_CASE(ProgVarCaching_per_program_invalidation)
+{
+	using namespace oglplus;
+
+	UniformRecorder recorder;
+	GLDispatchBackendScope scope(recorder);
+
+	Program prog1, prog2;
+	prog1.Link();
+	prog2.Link();
+	BOOST_REQUIRE(GetGLName(prog1) != GetGLName(prog2));
+	ProgVarCache::ResetStats();
+
+	Uniform<GLfloat>(prog1, "Scale");
+	Uniform<GLfloat>(prog2, "Scale");
+	BOOST_CHECK_EQUAL(ProgVarCache::Stats().fills, 2u);
+
+	// only the data of the re-linked program is discarded
+	prog1.Link();
+	Uniform<GLfloat>(prog2, "Scale");
+	BOOST_CHECK_EQUAL(ProgVarCache::Stats().fills, 2u);
+	Uniform<GLfloat>(prog1, "Scale");
+	BOOST_CHECK_EQUAL(ProgVarCache::Stats().fills, 3u);
+
+	// also if invalidated by another thread
+	std::thread([&prog2](void)
+	{
+		ProgVarCache::Invalidate(prog2);
+	}).join();
+	Uniform<GLfloat>(prog1, "Scale");
+	BOOST_CHECK_EQUAL(ProgVarCache::Stats().fills, 3u);
+	Uniform<GLfloat>(prog2, "Scale");
+	BOOST_CHECK_EQUAL(ProgVarCache::Stats().fills, 4u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,240 @@
+/**
+ *  .file test/oglplus/program_binary_cache.cpp
+ *  .brief Test case for the on-disk program binary cache.
+ *
+ *  .author Matus Chochlik
+ *
+ *  Copyright 2011-2015 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE OGLPLUS_ProgramBinaryCaching
+#include <boost/test/unit_test.hpp>
+
+#define OGLPLUS_USE_GL_DISPATCH 1
+
+#include <oglplus/gl.hpp>
+#include <oglplus/config/fix_gl_version.hpp>
+#include <oglplus/program.hpp>
+#include <oglplus/program_binary_cache.hpp>
+#include <oglplus/dispatch/recorder.hpp>
+
+#include <cstdio>
+#include <cstring>
+#include <set>
+
+// headless recorder emulating a GL with a single program binary format
+class BinaryRecorder
+ : public oglplus::GLHeadlessRecorder
+{
+private:
+	std::set<GLuint> _rejected;
+	const char* _renderer;
+
+	static GLenum _format(void)
+	{
+		return 0x1234;
+	}
+
+	static const char* _binary(void)
+	{
+		return "binary01";
+	}
+
+	template <typename T>
+	static T* _out(oglplus::GLCallInfo& call, std::size_t i)
+	{
+		return static_cast<T*>(call.args[i].value.p);
+	}
+protected:
+	void Emulate(oglplus::GLCallInfo& call)
+	{
+		oglplus::GLHeadlessRecorder::Emulate(call);
+		const GLuint program = GLuint(call.args[0].value.i);
+		if(std::strcmp(call.name, "GetString") == 0)
+		{
+			call.result.value.p = const_cast<char*>(_renderer);
+		}
+		else if(std::strcmp(call.name, "GetProgramiv") == 0)
+		{
+			switch(GLenum(call.args[1].value.i))
+			{
+				case GL_PROGRAM_BINARY_LENGTH:
+					*_out<GLint>(call, 2) = 8;
+					break;
+				case GL_LINK_STATUS:
+					*_out<GLint>(call, 2) =
+						_rejected.count(program)?
+						GL_FALSE:GL_TRUE;
+					break;
+				default:;
+			}
+		}
+		else if(std::strcmp(call.name, "GetProgramBinary") == 0)
+		{
+			*_out<GLsizei>(call, 2) = 8;
+			*_out<GLenum>(call, 3) = _format();
+			std::memcpy(_out<void>(call, 4), _binary(), 8);
+		}
+		else if(std::strcmp(call.name, "ProgramBinary") == 0)
+		{
+			const void* data = call.args[2].value.p;
+			if(	(GLenum(call.args[1].value.i) != _format()) ||
+				(call.args[3].value.i != 8) ||
+				(std::memcmp(data, _binary(), 8) != 0)
+			) _rejected.insert(program);
+			else _rejected.erase(program);
+		}
+		else if(std::strcmp(call.name, "LinkProgram") == 0)
+		{
+			_rejected.erase(program);
+		}
+	}
+public:
+	BinaryRecorder(void)
+	 : _renderer("Headless")
+	{ }
+
+	void SetRenderer(const char* renderer)
+	{
+		_renderer = renderer;
+	}
+};
+
+static oglplus::ProgramSources TestSources(void)
+{
+	using namespace oglplus;
+
+	ProgramSources sources;
+	sources.Add(ShaderType::Vertex,
+		"#version 330\n"
+		"void main(void) { gl_Position = vec4(0.0); }\n"
+	);
+	sources.Add(ShaderType::Fragment,
+		"#version 330\n"
+		"out vec4 fragColor;\n"
+		"void main(void) { fragColor = vec4(COLOR); }\n"
+	);
+	sources.Define("COLOR", "1.0");
+	return sources;
+}
+
+BOOST_AUTO_TEST_SUITE(ProgramBinaryCaching)
+
+BOOST_AUTO_TEST_CASE(ProgramBinaryCaching_sources)
+{
+	using namespace oglplus;
+
+	ProgramSources sources = TestSources();
+
+	BOOST_CHECK_EQUAL(sources.ShaderCount(), 2u);
+	BOOST_CHECK(
+		sources.Source(1) ==
+		"#version 330\n"
+		"#define COLOR 1.0\n"
+		"#line 2\n"
+		"out vec4 fragColor;\n"
+		"void main(void) { fragColor = vec4(COLOR); }\n"
+	);
+
+	ProgramSources other = TestSources();
+	BOOST_CHECK_EQUAL(sources.Hash(1), other.Hash(1));
+	BOOST_CHECK(sources.Hash(1) != sources.Hash(2));
+
+	other.Define("EXTRA");
+	BOOST_CHECK(sources.Hash(1) != other.Hash(1));
+
+	other = TestSources();
+	other.MakeSeparable();
+	BOOST_CHECK(sources.Hash(1) != other.Hash(1));
+}
+
+BOOST_AUTO_TEST_CASE(ProgramBinaryCaching_miss_store_hit)
+{
+	using namespace oglplus;
+
+	BinaryRecorder recorder;
+	GLDispatchBackendScope scope(recorder);
+
+	ProgramBinaryCache cache(".");
+	ProgramSources sources = TestSources();
+	cache.Remove(sources);
+
+	Program first = cache.Build(sources);
+	BOOST_CHECK_EQUAL(cache.Stats().misses, 1u);
+	BOOST_CHECK_EQUAL(cache.Stats().stored, 1u);
+	BOOST_CHECK_EQUAL(recorder.CountOf("CompileShader"), 2u);
+	BOOST_CHECK_EQUAL(recorder.CountOf("LinkProgram"), 1u);
+
+	recorder.Clear();
+	Program second = cache.Build(sources);
+	BOOST_CHECK_EQUAL(cache.Stats().hits, 1u);
+	BOOST_CHECK_EQUAL(recorder.CountOf("CompileShader"), 0u);
+	BOOST_CHECK_EQUAL(recorder.CountOf("LinkProgram"), 0u);
+	BOOST_CHECK_EQUAL(recorder.CountOf("ProgramBinary"), 1u);
+
+	BOOST_CHECK(cache.Remove(sources));
+}
+
+BOOST_AUTO_TEST_CASE(ProgramBinaryCaching_driver_change)
+{
+	using namespace oglplus;
+
+	BinaryRecorder recorder;
+	GLDispatchBackendScope scope(recorder);
+
+	ProgramSources sources = TestSources();
+
+	ProgramBinaryCache old_cache(".");
+	old_cache.Remove(sources);
+	old_cache.Build(sources);
+
+	// a different driver does not see the binaries of the other one
+	recorder.SetRenderer("Updated");
+	ProgramBinaryCache new_cache(".");
+	BOOST_CHECK(old_cache.Path(sources) != new_cache.Path(sources));
+
+	new_cache.Build(sources);
+	BOOST_CHECK_EQUAL(new_cache.Stats().misses, 1u);
+
+	BOOST_CHECK(old_cache.Remove(sources));
+	BOOST_CHECK(new_cache.Remove(sources));
+}
+
+BOOST_AUTO_TEST_CASE(ProgramBinaryCaching_rejected)
+{
+	using namespace oglplus;
+
+	BinaryRecorder recorder;
+	GLDispatchBackendScope scope(recorder);
+
+	ProgramBinaryCache cache(".");
+	ProgramSources sources = TestSources();
+	cache.Remove(sources);
+	cache.Build(sources);
+
+	// corrupt the stored binary
+	const String path = cache.Path(sources);
+	std::FILE* file = std::fopen(path.c_str(), "r+b");
+	BOOST_REQUIRE(file != nullptr);
+	std::fseek(file, -8, SEEK_END);
+	std::fwrite("garbage!", 1, 8, file);
+	std::fclose(file);
+
+	recorder.Clear();
+	cache.ResetStats();
+	cache.Build(sources);
+	BOOST_CHECK_EQUAL(cache.Stats().rejected, 1u);
+	BOOST_CHECK_EQUAL(cache.Stats().misses, 1u);
+	BOOST_CHECK_EQUAL(cache.Stats().stored, 1u);
+	BOOST_CHECK_EQUAL(recorder.CountOf("LinkProgram"), 1u);
+
+	// the rebuilt binary replaced the rejected one
+	cache.Build(sources);
+	BOOST_CHECK_EQUAL(cache.Stats().hits, 1u);
+
+	BOOST_CHECK(cache.Remove(sources));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
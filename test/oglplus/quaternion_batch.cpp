@@ -0,0 +1,289 @@
+/**
+ *  .file test/oglplus/quaternion_batch.cpp
+ *  .brief Test case for the batch quaternion operations.
+ *
+ *  .author Matus Chochlik
+ *
+ *  Copyright 2011-2015 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE OGLPLUS_QuaternionBatch
+#include <boost/test/unit_test.hpp>
+
+#include <oglplus/gl.hpp>
+#include <oglplus/quaternion_batch.hpp>
+
+#include <random>
+#include <vector>
+#include <cmath>
+
+BOOST_AUTO_TEST_SUITE(QuaternionBatchOps)
+
+// the sizes are not multiples of the SIMD width to test the tails
+static const std::size_t test_sizes[] = {1, 7, 13, 1001};
+
+static oglplus::QuaternionArray test_quaternions(
+	std::size_t count,
+	unsigned seed
+)
+{
+	using namespace oglplus;
+
+	std::mt19937 rng(seed);
+	std::uniform_real_distribution<GLfloat> comp(-1.0f, 1.0f);
+
+	QuaternionArray result;
+	result.Reserve(count);
+	for(std::size_t i=0; i!=count; ++i)
+	{
+		Quatf q(comp(rng), comp(rng), comp(rng), comp(rng));
+		result.Add(q.Normalize());
+	}
+	return result;
+}
+
+static double quat_distance(
+	const oglplus::Quatf& q,
+	double a, double x, double y, double z
+)
+{
+	double da = q.At(0)-a, dx = q.At(1)-x, dy = q.At(2)-y, dz = q.At(3)-z;
+	return std::sqrt(da*da + dx*dx + dy*dy + dz*dz);
+}
+
+BOOST_AUTO_TEST_CASE(QuaternionBatch_array)
+{
+	using namespace oglplus;
+
+	QuaternionArray qa;
+	BOOST_CHECK(qa.Empty());
+	qa.Add(Quatf(1, 2, 3, 4));
+	qa.Resize(3);
+	BOOST_CHECK_EQUAL(qa.Size(), 3u);
+	BOOST_CHECK(qa.Get(0) == Quatf(1, 2, 3, 4));
+	BOOST_CHECK(qa.Get(2) == Quatf(1, 0, 0, 0));
+	qa.Set(1, Quatf(5, 6, 7, 8));
+	BOOST_CHECK_EQUAL(qa.A()[1], 5.0f);
+	BOOST_CHECK_EQUAL(qa.Z()[1], 8.0f);
+
+	Vec3Array va;
+	va.Add(Vec3f(1.0f, 2.0f, 3.0f));
+	va.Resize(2);
+	BOOST_CHECK(va.Get(0) == Vec3f(1.0f, 2.0f, 3.0f));
+	BOOST_CHECK(va.Get(1) == Vec3f(0.0f, 0.0f, 0.0f));
+	va.Clear();
+	BOOST_CHECK(va.Empty());
+}
+
+BOOST_AUTO_TEST_CASE(QuaternionBatch_multiply_rotate)
+{
+	using namespace oglplus;
+
+	for(std::size_t n : test_sizes)
+	{
+		QuaternionArray q1 = test_quaternions(n, 1);
+		QuaternionArray q2 = test_quaternions(n, 2);
+
+		std::mt19937 rng(3);
+		std::uniform_real_distribution<GLfloat> coord(-10.0f, 10.0f);
+		Vec3Array vectors;
+		for(std::size_t i=0; i!=n; ++i)
+		{
+			vectors.Add(coord(rng), coord(rng), coord(rng));
+		}
+
+		QuaternionArray products;
+		QuaternionBatch::Multiply(q1, q2, products);
+		BOOST_REQUIRE_EQUAL(products.Size(), n);
+
+		Vec3Array rotated;
+		QuaternionBatch::Rotate(q1, vectors, rotated);
+		BOOST_REQUIRE_EQUAL(rotated.Size(), n);
+
+		for(std::size_t i=0; i!=n; ++i)
+		{
+			Quatf p = q1.Get(i)*q2.Get(i);
+			BOOST_CHECK(Close(products.Get(i), p, 1e-5f));
+
+			Vec3f v = Rotate(q1.Get(i), vectors.Get(i));
+			BOOST_CHECK_SMALL(Distance(rotated.Get(i), v), 1e-4f);
+		}
+
+		// the result may be one of the arguments
+		QuaternionBatch::Multiply(q1, q2, q1);
+		for(std::size_t i=0; i!=n; ++i)
+		{
+			BOOST_CHECK(q1.Get(i) == products.Get(i));
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE(QuaternionBatch_normalize)
+{
+	using namespace oglplus;
+
+	for(std::size_t n : test_sizes)
+	{
+		QuaternionArray q = test_quaternions(n, 4);
+		QuaternionArray scaled;
+		for(std::size_t i=0; i!=n; ++i)
+		{
+			scaled.Add(q.Get(i)*GLfloat(1+i%5));
+		}
+		QuaternionBatch::Normalize(scaled);
+		for(std::size_t i=0; i!=n; ++i)
+		{
+			BOOST_CHECK(scaled.Get(i).IsNormal(2e-6f));
+			BOOST_CHECK(Close(scaled.Get(i), q.Get(i), 1e-5f));
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE(QuaternionBatch_interpolation)
+{
+	using namespace oglplus;
+
+	for(std::size_t n : test_sizes)
+	{
+		QuaternionArray q1 = test_quaternions(n, 5);
+		QuaternionArray q2 = test_quaternions(n, 6);
+
+		std::mt19937 rng(7);
+		std::uniform_real_distribution<GLfloat> param(0.0f, 1.0f);
+		std::vector<GLfloat> t(n);
+		for(std::size_t i=0; i!=n; ++i)
+		{
+			t[i] = param(rng);
+		}
+
+		QuaternionArray slerp, slerp_half, nlerp;
+		QuaternionBatch::SLERP(q1, q2, t, slerp);
+		QuaternionBatch::SLERP(q1, q2, 0.5f, slerp_half);
+		QuaternionBatch::NLERP(q1, q2, t, nlerp);
+
+		for(std::size_t i=0; i!=n; ++i)
+		{
+			Quatf p = q1.Get(i), q = q2.Get(i);
+			double d = Dot(p, q);
+			double s = 1;
+			if(d < 0) { d = -d; s = -1; }
+			double w = std::acos(std::min(d, 1.0));
+
+			// the reference SLERP along the shorter arc in double
+			auto expected = [&](double f, unsigned k) -> double
+			{
+				double c0 = 1-f, c1 = f;
+				if(w > 1e-6)
+				{
+					c0 = std::sin((1-f)*w)/std::sin(w);
+					c1 = std::sin(f*w)/std::sin(w);
+				}
+				return c0*p.At(k) + s*c1*q.At(k);
+			};
+			BOOST_CHECK_SMALL(quat_distance(
+				slerp.Get(i),
+				expected(t[i], 0), expected(t[i], 1),
+				expected(t[i], 2), expected(t[i], 3)
+			), 2.0*QuaternionBatch::SLERPMaxError());
+			BOOST_CHECK_SMALL(quat_distance(
+				slerp_half.Get(i),
+				expected(0.5, 0), expected(0.5, 1),
+				expected(0.5, 2), expected(0.5, 3)
+			), 2.0*QuaternionBatch::SLERPMaxError());
+
+			BOOST_CHECK(nlerp.Get(i).IsNormal(2e-6f));
+			// NLERP lies on the same great arc as SLERP
+			Quatf l = p*(1-t[i]) + q*GLfloat(s*t[i]);
+			BOOST_CHECK(Close(nlerp.Get(i), l.Normalize(), 1e-4f));
+		}
+
+		// matches QuaternionSLERP when the pair is on the shorter arc
+		for(std::size_t i=0; i!=n; ++i)
+		{
+			Quatf p = q1.Get(i), q = q2.Get(i);
+			if(Dot(p, q) < 0.0f) q = q*-1.0f;
+			QuatfSLERP ref(p, q, 1e-5f);
+			BOOST_CHECK_SMALL(
+				quat_distance(slerp_half.Get(i),
+					ref(0.5f).At(0), ref(0.5f).At(1),
+					ref(0.5f).At(2), ref(0.5f).At(3)
+				),
+				1e-5
+			);
+		}
+	}
+
+	// the end points and identical pairs
+	QuaternionArray q1 = test_quaternions(9, 8);
+	QuaternionArray r;
+	QuaternionBatch::SLERP(q1, q1, 0.3f, r);
+	for(std::size_t i=0; i!=r.Size(); ++i)
+	{
+		BOOST_CHECK(Close(r.Get(i), q1.Get(i), 1e-5f));
+	}
+	QuaternionArray q2 = test_quaternions(9, 9);
+	QuaternionBatch::SLERP(q1, q2, 0.0f, r);
+	for(std::size_t i=0; i!=r.Size(); ++i)
+	{
+		BOOST_CHECK_SMALL(quat_distance(r.Get(i),
+			q1.Get(i).At(0), q1.Get(i).At(1),
+			q1.Get(i).At(2), q1.Get(i).At(3)
+		), 1e-6);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(QuaternionBatch_matrices)
+{
+	using namespace oglplus;
+
+	for(std::size_t n : test_sizes)
+	{
+		QuaternionArray q = test_quaternions(n, 10);
+		// non-unit quaternions give the same rotation
+		QuaternionArray scaled;
+		Vec3Array translations;
+		for(std::size_t i=0; i!=n; ++i)
+		{
+			scaled.Add(q.Get(i)*GLfloat(1+i%3));
+			translations.Add(GLfloat(i), -GLfloat(i), 0.5f);
+		}
+
+		std::vector<Mat4f> rotations, models;
+		std::vector<Mat3x4f> palette;
+		QuaternionBatch::ToMatrices(scaled, rotations);
+		QuaternionBatch::ToMatrices(q, translations, models);
+		QuaternionBatch::ToMatrices(q, translations, palette);
+		BOOST_REQUIRE_EQUAL(rotations.size(), n);
+		BOOST_REQUIRE_EQUAL(models.size(), n);
+		BOOST_REQUIRE_EQUAL(palette.size(), n);
+
+		for(std::size_t i=0; i!=n; ++i)
+		{
+			Mat4f expected = ModelMatrixf::RotationQ(q.Get(i));
+			Mat4f translation = ModelMatrixf::Translation(
+				translations.Get(i)
+			);
+			for(std::size_t r=0; r!=4; ++r)
+			for(std::size_t c=0; c!=4; ++c)
+			{
+				BOOST_CHECK_SMALL(
+					rotations[i].At(r, c)-expected.At(r, c),
+					1e-5f
+				);
+				GLfloat m = (translation*expected).At(r, c);
+				BOOST_CHECK_SMALL(models[i].At(r, c)-m, 1e-5f);
+				if(r < 3)
+				{
+					BOOST_CHECK_EQUAL(
+						palette[i].At(r, c),
+						models[i].At(r, c)
+					);
+				}
+			}
+		}
+	}
+}
+
+BOOST_AUTO_TEST_SUITE_END()
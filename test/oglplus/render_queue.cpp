@@ -0,0 +1,236 @@
+/**
+ *  .file test/oglplus/render_queue.cpp
+ *  .brief Test case for the render queue.
+ *
+ *  .author Matus Chochlik
+ *
+ *  Copyright 2011-2015 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE OGLPLUS_RenderQueue
+#include <boost/test/unit_test.hpp>
+
+#define OGLPLUS_USE_GL_DISPATCH 1
+
+#include <oglplus/gl.hpp>
+#include <oglplus/config/fix_gl_version.hpp>
+#include <oglplus/render_queue.hpp>
+#include <oglplus/dispatch/recorder.hpp>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(RenderQueueSorting)
+
+static oglplus::RenderQueueItem test_item(
+	GLuint program,
+	GLuint texture,
+	GLuint vao,
+	GLfloat depth,
+	std::size_t user_data
+)
+{
+	using namespace oglplus;
+
+	RenderQueueItem item;
+	item.program = ProgramName(program);
+	item.vertex_array = VertexArrayName(vao);
+	item.BindTexture(0, TextureTarget::_2D, TextureName(texture));
+	item.depth = depth;
+	item.user_data = user_data;
+	item.DrawArrays(PrimitiveType::Triangles, 0, 36);
+	return item;
+}
+
+BOOST_AUTO_TEST_CASE(RenderQueue_keys)
+{
+	using namespace oglplus;
+
+	const GLuint max = (1u << RenderQueue::DepthBits)-1;
+	BOOST_CHECK_EQUAL(RenderQueue::QuantizeDepth(-1.0f, 0, 1), 0u);
+	BOOST_CHECK_EQUAL(RenderQueue::QuantizeDepth(2.0f, 0, 1), max);
+	BOOST_CHECK(
+		RenderQueue::QuantizeDepth(0.25f, 0, 1) <
+		RenderQueue::QuantizeDepth(0.50f, 0, 1)
+	);
+
+	// the program is more significant than the depth of opaque items
+	BOOST_CHECK(
+		RenderQueue::MakeKey(false, 1, 0, 0, 0, max) <
+		RenderQueue::MakeKey(false, 2, 0, 0, 0, 0)
+	);
+	// opaque front-to-back
+	BOOST_CHECK(
+		RenderQueue::MakeKey(false, 1, 3, 2, 1, 10) <
+		RenderQueue::MakeKey(false, 1, 3, 2, 1, 20)
+	);
+	// translucent after opaque
+	BOOST_CHECK(
+		RenderQueue::MakeKey(false, 1023, 255, 4095, 1023, max) <
+		RenderQueue::MakeKey(true, 0, 0, 0, 0, max)
+	);
+	// translucent back-to-front, before the program
+	BOOST_CHECK(
+		RenderQueue::MakeKey(true, 2, 0, 0, 0, 20) <
+		RenderQueue::MakeKey(true, 1, 0, 0, 0, 10)
+	);
+}
+
+BOOST_AUTO_TEST_CASE(RenderQueue_radix_sort)
+{
+	using namespace oglplus;
+
+	std::mt19937_64 rng(12345);
+	std::vector<RenderQueue::Entry> entries(5000), scratch;
+	for(std::size_t i=0; i!=entries.size(); ++i)
+	{
+		// few distinct keys to check that the sort is stable
+		entries[i].key = rng() % 64;
+		entries[i].key |= (rng() % 4) << 56;
+		entries[i].index = GLuint(i);
+	}
+	std::vector<RenderQueue::Entry> expected(entries);
+	std::stable_sort(
+		expected.begin(),
+		expected.end(),
+		[](const RenderQueue::Entry& a, const RenderQueue::Entry& b)
+		{
+			return a.key < b.key;
+		}
+	);
+
+	RenderQueue::RadixSort(entries, scratch);
+
+	BOOST_REQUIRE_EQUAL(entries.size(), expected.size());
+	for(std::size_t i=0; i!=entries.size(); ++i)
+	{
+		BOOST_CHECK_EQUAL(entries[i].key, expected[i].key);
+		BOOST_CHECK_EQUAL(entries[i].index, expected[i].index);
+	}
+
+	entries.clear();
+	RenderQueue::RadixSort(entries, scratch);
+	BOOST_CHECK(entries.empty());
+}
+
+BOOST_AUTO_TEST_CASE(RenderQueue_sort)
+{
+	using namespace oglplus;
+
+	GLHeadlessRecorder recorder;
+	GLDispatchBackendScope scope(recorder);
+
+	RenderQueue queue;
+	for(std::size_t i=0; i!=32; ++i)
+	{
+		RenderQueueItem item = test_item(
+			GLuint(1+i%2),
+			GLuint(1+i%4),
+			GLuint(1+i%3),
+			GLfloat(i)/32,
+			i
+		);
+		if(i % 8 == 0)
+		{
+			item.state = RenderQueueState::Blended(
+				BlendFunction::SrcAlpha,
+				BlendFunction::OneMinusSrcAlpha
+			);
+		}
+		queue.Submit(item);
+	}
+	BOOST_CHECK_EQUAL(queue.Size(), 32u);
+
+	queue.Sort();
+	BOOST_CHECK_EQUAL(recorder.CallCount(), 0u);
+
+	const std::vector<RenderQueue::Entry>& entries = queue.Entries();
+	for(std::size_t i=1; i!=entries.size(); ++i)
+	{
+		BOOST_CHECK(entries[i-1].key <= entries[i].key);
+	}
+	// the four translucent items are last and back-to-front
+	for(std::size_t i=0; i!=4; ++i)
+	{
+		const RenderQueueItem& item = queue.Item(entries[28+i].index);
+		BOOST_CHECK(item.state.blend);
+		BOOST_CHECK_EQUAL(item.user_data, 24-i*8);
+	}
+	// the opaque items are grouped by program
+	std::size_t program_changes = 0;
+	for(std::size_t i=1; i!=28; ++i)
+	{
+		if(queue.Item(entries[i-1].index).program !=
+			queue.Item(entries[i].index).program)
+		{
+			++program_changes;
+		}
+	}
+	BOOST_CHECK_EQUAL(program_changes, 1u);
+
+	RenderQueueStats stats = queue.Stats();
+	BOOST_CHECK_EQUAL(stats.items, 32u);
+	BOOST_CHECK(stats.sorted_changes < stats.submitted_changes);
+	BOOST_CHECK_EQUAL(
+		stats.Avoided(),
+		stats.submitted_changes-stats.sorted_changes
+	);
+
+	queue.Clear();
+	BOOST_CHECK_EQUAL(queue.Size(), 0u);
+	BOOST_CHECK(queue.Entries().empty());
+}
+
+BOOST_AUTO_TEST_CASE(RenderQueue_replay)
+{
+	using namespace oglplus;
+
+	GLHeadlessRecorder recorder;
+	GLDispatchBackendScope scope(recorder);
+
+	ClientContext gl;
+
+	RenderQueue queue;
+	for(std::size_t i=0; i!=16; ++i)
+	{
+		queue.Submit(test_item(
+			GLuint(1+i%2),
+			GLuint(1+i%2),
+			1,
+			GLfloat(i)/16,
+			i
+		));
+	}
+
+	recorder.Clear();
+	std::vector<std::size_t> drawn;
+	queue.Replay(gl, [&drawn](const RenderQueueItem& item)
+	{
+		drawn.push_back(item.user_data);
+	});
+
+	BOOST_CHECK_EQUAL(drawn.size(), 16u);
+	BOOST_CHECK_EQUAL(recorder.CountOf("DrawArrays"), 16u);
+	BOOST_CHECK_EQUAL(recorder.CountOf("UseProgram"), 2u);
+	BOOST_CHECK_EQUAL(recorder.CountOf("BindTexture"), 2u);
+	BOOST_CHECK_EQUAL(recorder.CountOf("BindVertexArray"), 1u);
+	// the items with the same program are drawn front-to-back
+	for(std::size_t i=1; i!=8; ++i)
+	{
+		BOOST_CHECK(drawn[i-1] < drawn[i]);
+	}
+
+	// replaying again does not re-apply the unchanged state
+	recorder.Clear();
+	queue.Replay(gl);
+	BOOST_CHECK_EQUAL(recorder.CountOf("DrawArrays"), 16u);
+	BOOST_CHECK_EQUAL(recorder.CountOf("UseProgram"), 2u);
+	BOOST_CHECK_EQUAL(recorder.CountOf("BindVertexArray"), 0u);
+	BOOST_CHECK_EQUAL(recorder.CountOf("Enable"), 0u);
+	BOOST_CHECK_EQUAL(recorder.CountOf("DepthFunc"), 0u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
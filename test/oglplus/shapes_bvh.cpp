@@ -0,0 +1,512 @@
+/**
+ *  .file test/oglplus/shapes_bvh.cpp
+ *  .brief Test case for the bounding-volume hierarchies.
+ *
+ *  .author Matus Chochlik
+ *
+ *  Copyright 2011-2015 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE OGLPLUS_ShapesBVH
+#include <boost/test/unit_test.hpp>
+
+#include <oglplus/gl.hpp>
+#include <oglplus/config/fix_gl_version.hpp>
+#include <oglplus/shapes/bvh.hpp>
+#include <oglplus/shapes/torus.hpp>
+#include <oglplus/shapes/obj_mesh.hpp>
+#include <oglplus/math/matrix.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+// makes a strip and a fan, both with a primitive restart
+struct StripFanInstructionWriter
+ : oglplus::shapes::DrawingInstructionWriter
+{
+	static oglplus::shapes::DrawingInstructions Make(void)
+	{
+		using namespace oglplus;
+		using namespace oglplus::shapes;
+
+		DrawingInstructions instr = MakeInstructions();
+		const PrimitiveType modes[2] = {
+			PrimitiveType::TriangleStrip,
+			PrimitiveType::TriangleFan
+		};
+		const GLuint firsts[2] = {0, 9};
+		const GLuint counts[2] = {9, 8};
+		for(GLuint i=0; i!=2; ++i)
+		{
+			DrawOperation operation;
+			operation.method = DrawOperation::Method::DrawElements;
+			operation.mode = modes[i];
+			operation.first = firsts[i];
+			operation.count = counts[i];
+			operation.restart_index = 99;
+			operation.phase = 0;
+			AddInstruction(instr, operation);
+		}
+		return instr;
+	}
+};
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(ShapesBVH)
+
+static std::vector<oglplus::Spheref> test_spheres(std::size_t count)
+{
+	using namespace oglplus;
+
+	std::mt19937 rng(count);
+	std::uniform_real_distribution<GLfloat> pos(-100.0f, 100.0f);
+	std::uniform_real_distribution<GLfloat> rad(0.1f, 3.0f);
+
+	std::vector<Spheref> spheres;
+	spheres.reserve(count);
+	for(std::size_t i=0; i!=count; ++i)
+	{
+		spheres.push_back(Spheref(pos(rng), pos(rng), pos(rng), rad(rng)));
+	}
+	return spheres;
+}
+
+static oglplus::shapes::InstanceBVH test_bvh(
+	const std::vector<oglplus::Spheref>& spheres,
+	unsigned threads
+)
+{
+	oglplus::shapes::InstanceBVH bvh;
+	bvh.Resize(GLuint(spheres.size()));
+	for(std::size_t i=0; i!=spheres.size(); ++i)
+	{
+		bvh.SetSphere(GLuint(i), spheres[i]);
+	}
+	bvh.Build(threads);
+	return bvh;
+}
+
+// returns the distance to the ray/sphere intersection or -1
+static GLfloat ray_sphere(
+	const oglplus::Vec3f& o,
+	const oglplus::Vec3f& d,
+	const oglplus::Spheref& s
+)
+{
+	using namespace oglplus;
+
+	Vec3f oc = o-s.Center();
+	GLfloat a = Dot(d, d);
+	GLfloat b = Dot(oc, d);
+	GLfloat c = Dot(oc, oc)-s.Radius()*s.Radius();
+	GLfloat disc = b*b-a*c;
+	if(disc < 0.0f) return -1.0f;
+	GLfloat t = (-b-std::sqrt(disc))/a;
+	if(t < 0.0f) t = (-b+std::sqrt(disc))/a;
+	return t;
+}
+
+// returns the distance to the ray/triangle intersection or -1
+static GLfloat ray_triangle(
+	const oglplus::Vec3f& o,
+	const oglplus::Vec3f& d,
+	const oglplus::Vec3f& v0,
+	const oglplus::Vec3f& v1,
+	const oglplus::Vec3f& v2
+)
+{
+	using namespace oglplus;
+
+	Vec3f e1 = v1-v0, e2 = v2-v0;
+	Vec3f p = Cross(d, e2);
+	GLfloat det = Dot(e1, p);
+	if(det == 0.0f) return -1.0f;
+	Vec3f s = o-v0;
+	GLfloat u = Dot(s, p)/det;
+	if(u < 0.0f || u > 1.0f) return -1.0f;
+	Vec3f q = Cross(s, e1);
+	GLfloat v = Dot(d, q)/det;
+	if(v < 0.0f || u+v > 1.0f) return -1.0f;
+	return Dot(e2, q)/det;
+}
+
+static void check_nodes(const std::vector<oglplus::shapes::BVHNode>& nodes)
+{
+	for(std::size_t n=0; n!=nodes.size(); ++n)
+	{
+		if(!nodes[n].IsLeaf())
+		{
+			BOOST_REQUIRE(nodes[n].offset > n);
+			BOOST_REQUIRE(nodes[n].offset+1 < nodes.size());
+			for(GLuint c=0; c!=2; ++c)
+			{
+				const oglplus::shapes::BVHNode& child =
+					nodes[nodes[n].offset+c];
+				for(std::size_t a=0; a!=3; ++a)
+				{
+					BOOST_CHECK(nodes[n].min[a] <= child.min[a]);
+					BOOST_CHECK(nodes[n].max[a] >= child.max[a]);
+				}
+			}
+		}
+	}
+}
+
+static void check_ray_hits(
+	const std::vector<oglplus::Spheref>& spheres,
+	const oglplus::shapes::InstanceBVH& bvh
+)
+{
+	using namespace oglplus;
+
+	std::mt19937 rng(7);
+	std::uniform_real_distribution<GLfloat> dir(-1.0f, 1.0f);
+
+	std::vector<GLuint> hits;
+	for(std::size_t r=0; r!=100; ++r)
+	{
+		Vec3f o(0, 0, 0);
+		Vec3f d(dir(rng), dir(rng), dir(rng));
+
+		GLuint nearest = shapes::InstanceBVH::NoInstance();
+		GLfloat nearest_t = 1e30f;
+		for(std::size_t i=0; i!=spheres.size(); ++i)
+		{
+			GLfloat t = ray_sphere(o, d, spheres[i]);
+			if(t >= 0.0f && t < nearest_t)
+			{
+				nearest_t = t;
+				nearest = GLuint(i);
+			}
+		}
+
+		GLfloat distance = 1e30f;
+		GLuint picked = bvh.Pick(
+			o, d,
+			[&spheres, &o, &d](GLuint i, GLfloat& t) -> bool
+			{
+				GLfloat s = ray_sphere(o, d, spheres[i]);
+				if(s >= 0.0f && s < t)
+				{
+					t = s;
+					return true;
+				}
+				return false;
+			},
+			distance
+		);
+		BOOST_CHECK_EQUAL(picked, nearest);
+		if(nearest != shapes::InstanceBVH::NoInstance())
+		{
+			BOOST_CHECK_CLOSE(distance, nearest_t, 0.001);
+
+			bvh.IntersectRay(o, d, hits);
+			BOOST_CHECK(
+				std::find(hits.begin(), hits.end(), nearest)!=
+				hits.end()
+			);
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE(InstanceBVH_build)
+{
+	using namespace oglplus;
+
+	std::vector<Spheref> spheres = test_spheres(5000);
+
+	shapes::InstanceBVH bvh1 = test_bvh(spheres, 1);
+	shapes::InstanceBVH bvh4 = test_bvh(spheres, 4);
+
+	BOOST_CHECK(!bvh1.Empty());
+	BOOST_CHECK(bvh1.Nodes().size() < 2*spheres.size());
+	check_nodes(bvh1.Nodes());
+	check_nodes(bvh4.Nodes());
+
+	// every instance is referenced by exactly one leaf
+	std::vector<GLuint> counts(spheres.size(), 0);
+	for(auto n=bvh4.Nodes().begin(), e=bvh4.Nodes().end(); n!=e; ++n)
+	{
+		if(n->IsLeaf())
+		{
+			for(GLuint i=0; i!=n->count; ++i)
+			{
+				BOOST_REQUIRE(n->offset+i < spheres.size());
+				++counts[n->offset+i];
+			}
+		}
+	}
+	BOOST_CHECK(std::count(counts.begin(), counts.end(), 1u) == 5000);
+}
+
+BOOST_AUTO_TEST_CASE(InstanceBVH_cull)
+{
+	using namespace oglplus;
+
+	std::vector<Spheref> spheres = test_spheres(5000);
+	shapes::InstanceBVH bvh = test_bvh(spheres, 1);
+
+	Frustumf frustum(
+		CamMatrixf::PerspectiveX(Degrees(60), 1.5f, 1.0f, 80.0f)*
+		CamMatrixf::LookingAt(Vec3f(0, 0, 0), Vec3f(10, 5, -10))
+	);
+
+	std::vector<GLuint> visible;
+	bvh.Cull(frustum, visible);
+	std::sort(visible.begin(), visible.end());
+	BOOST_CHECK(std::adjacent_find(visible.begin(), visible.end())==
+		visible.end()
+	);
+
+	std::size_t expected = 0;
+	for(std::size_t i=0; i!=spheres.size(); ++i)
+	{
+		if(frustum.Intersects(spheres[i]))
+		{
+			++expected;
+			BOOST_CHECK(std::binary_search(
+				visible.begin(),
+				visible.end(),
+				GLuint(i)
+			));
+		}
+	}
+	BOOST_CHECK(expected > 0u);
+	// boxes are conservative, but not by much
+	BOOST_CHECK(visible.size() >= expected);
+	BOOST_CHECK(visible.size() < spheres.size()/2);
+}
+
+BOOST_AUTO_TEST_CASE(InstanceBVH_pick)
+{
+	using namespace oglplus;
+
+	std::vector<Spheref> spheres = test_spheres(2000);
+	shapes::InstanceBVH bvh = test_bvh(spheres, 1);
+	check_ray_hits(spheres, bvh);
+}
+
+BOOST_AUTO_TEST_CASE(InstanceBVH_refit)
+{
+	using namespace oglplus;
+
+	std::vector<Spheref> spheres = test_spheres(2000);
+	shapes::InstanceBVH bvh = test_bvh(spheres, 1);
+	std::size_t node_count = bvh.Nodes().size();
+
+	for(std::size_t i=0; i!=spheres.size(); ++i)
+	{
+		Vec3f offset(GLfloat(i%7)-3, GLfloat(i%5)-2, GLfloat(i%3)-1);
+		spheres[i] = Spheref(
+			spheres[i].Center()+offset,
+			spheres[i].Radius()
+		);
+		bvh.SetSphere(GLuint(i), spheres[i]);
+	}
+	bvh.Refit();
+
+	BOOST_CHECK_EQUAL(bvh.Nodes().size(), node_count);
+	check_nodes(bvh.Nodes());
+	check_ray_hits(spheres, bvh);
+}
+
+BOOST_AUTO_TEST_CASE(InstanceBVH_refit_resized)
+{
+	using namespace oglplus;
+
+	std::vector<Spheref> spheres = test_spheres(100);
+	shapes::InstanceBVH bvh = test_bvh(spheres, 1);
+	bvh.Resize(GLuint(spheres.size()+1));
+	BOOST_CHECK_THROW(bvh.Refit(), std::runtime_error);
+
+	bvh.Build();
+	bvh.Refit();
+	check_nodes(bvh.Nodes());
+}
+
+BOOST_AUTO_TEST_CASE(InstanceBVH_empty)
+{
+	using namespace oglplus;
+
+	shapes::InstanceBVH bvh;
+	bvh.Build();
+	BOOST_CHECK(bvh.Empty());
+
+	std::vector<GLuint> result(3, 1u);
+	BOOST_CHECK_EQUAL(bvh.Cull(Frustumf(Mat4f()), result), 0u);
+	BOOST_CHECK(result.empty());
+
+	GLfloat distance = 1e30f;
+	BOOST_CHECK_EQUAL(
+		bvh.Pick(
+			Vec3f(), Vec3f(0, 0, 1),
+			[](GLuint, GLfloat&) -> bool { return true; },
+			distance
+		),
+		shapes::InstanceBVH::NoInstance()
+	);
+}
+
+static void check_raycast(
+	const std::vector<GLfloat>& positions,
+	GLuint npv,
+	const std::vector<GLuint>& triangles,
+	const oglplus::shapes::TriangleBVH& bvh,
+	GLfloat spread
+)
+{
+	using namespace oglplus;
+
+	BOOST_REQUIRE_EQUAL(bvh.TriangleCount(), triangles.size()/3);
+	check_nodes(bvh.Nodes());
+
+	auto vertex = [&](GLuint i) -> Vec3f
+	{
+		return Vec3f(
+			positions[i*npv+0],
+			positions[i*npv+1],
+			positions[i*npv+2]
+		);
+	};
+
+	std::mt19937 rng(11);
+	std::uniform_real_distribution<GLfloat> coord(-spread, spread);
+
+	std::size_t hit_count = 0;
+	for(std::size_t r=0; r!=200; ++r)
+	{
+		Vec3f o(coord(rng), coord(rng), 5.0f);
+		Vec3f d = Vec3f(coord(rng), coord(rng), -5.0f)-o;
+
+		GLfloat nearest_t = 1e30f;
+		for(std::size_t t=0; t!=triangles.size()/3; ++t)
+		{
+			GLfloat s = ray_triangle(
+				o, d,
+				vertex(triangles[t*3+0]),
+				vertex(triangles[t*3+1]),
+				vertex(triangles[t*3+2])
+			);
+			if(s >= 0.0f && s < nearest_t) nearest_t = s;
+		}
+
+		shapes::BVHRayHit hit;
+		bool found = bvh.Raycast(o, d, hit);
+		BOOST_CHECK_EQUAL(found, nearest_t < 1e30f);
+		if(found)
+		{
+			++hit_count;
+			BOOST_CHECK_CLOSE(hit.distance, nearest_t, 0.01);
+			BOOST_REQUIRE(hit.triangle < triangles.size()/3);
+			GLfloat s = ray_triangle(
+				o, d,
+				vertex(triangles[hit.triangle*3+0]),
+				vertex(triangles[hit.triangle*3+1]),
+				vertex(triangles[hit.triangle*3+2])
+			);
+			BOOST_CHECK_CLOSE(s, hit.distance, 0.01);
+			BOOST_CHECK(!bvh.Raycast(o, d, hit, nearest_t*0.99f));
+		}
+	}
+	BOOST_CHECK(hit_count > 0u);
+}
+
+BOOST_AUTO_TEST_CASE(TriangleBVH_torus)
+{
+	using namespace oglplus;
+
+	shapes::Torus torus(1.0, 0.5, 36, 24);
+
+	std::vector<GLfloat> positions;
+	GLuint npv = torus.Positions(positions);
+	auto shape_indices = torus.Indices();
+	std::vector<GLuint> indices(shape_indices.begin(), shape_indices.end());
+	std::vector<GLuint> triangles;
+	shapes::TriangleBVH::Triangles(torus.Instructions(), indices, triangles);
+	BOOST_CHECK_EQUAL(triangles.size(), 36u*24u*2u*3u);
+
+	shapes::TriangleBVH bvh = shapes::TriangleBVH::FromShape(torus, 2);
+	check_raycast(positions, npv, triangles, bvh, 1.6f);
+}
+
+BOOST_AUTO_TEST_CASE(TriangleBVH_obj_mesh)
+{
+	using namespace oglplus;
+
+	std::stringstream input(
+		"o quad\n"
+		"v -1 -1 0\nv 1 -1 0\nv 1 1 0\nv -1 1 0\n"
+		"f 1 2 3\nf 1 3 4\n"
+		"o fan\n"
+		"v -1 -1 1\nv 1 -1 1\nv 1 1 1\nv -1 1 1\nv 0 0 2\n"
+		"f 5 6 9\nf 6 7 9\nf 7 8 9\nf 8 5 9\n"
+	);
+	shapes::ObjMesh mesh(input);
+
+	std::vector<GLfloat> positions;
+	GLuint npv = mesh.Positions(positions);
+	std::vector<GLuint> triangles;
+	shapes::TriangleBVH::Triangles(
+		mesh.Instructions(),
+		std::vector<GLuint>(),
+		triangles
+	);
+	BOOST_CHECK_EQUAL(triangles.size(), 6u*3u);
+
+	shapes::TriangleBVH bvh = shapes::TriangleBVH::FromShape(mesh);
+	check_raycast(positions, npv, triangles, bvh, 1.2f);
+
+	shapes::BVHRayHit hit;
+	BOOST_REQUIRE(bvh.Raycast(Vec3f(0, 0, 5), Vec3f(0, 0, -1), hit));
+	BOOST_CHECK_CLOSE(hit.distance, 3.0f, 0.001);
+}
+
+BOOST_AUTO_TEST_CASE(TriangleBVH_strip_fan_winding)
+{
+	using namespace oglplus;
+
+	const GLuint index_data[17] = {
+		0, 1, 2, 3, 99, 4, 5, 6, 7,
+		10, 11, 12, 13, 99, 14, 15, 16
+	};
+	const std::vector<GLuint> indices(index_data, index_data+17);
+	std::vector<GLuint> triangles;
+	shapes::TriangleBVH::Triangles(
+		StripFanInstructionWriter::Make(),
+		indices,
+		triangles
+	);
+
+	// every other triangle of the strips is swapped like by the GL
+	const GLuint expected[21] = {
+		0, 1, 2,   2, 1, 3,
+		4, 5, 6,   6, 5, 7,
+		10, 11, 12,   10, 12, 13,
+		14, 15, 16
+	};
+	BOOST_CHECK_EQUAL_COLLECTIONS(
+		triangles.begin(), triangles.end(),
+		expected, expected+21
+	);
+}
+
+BOOST_AUTO_TEST_CASE(TriangleBVH_empty)
+{
+	using namespace oglplus;
+
+	shapes::TriangleBVH bvh;
+	shapes::BVHRayHit hit;
+	BOOST_CHECK_EQUAL(bvh.TriangleCount(), 0u);
+	BOOST_CHECK(!bvh.Raycast(Vec3f(), Vec3f(0, 0, 1), hit));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
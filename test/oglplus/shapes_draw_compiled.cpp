@@ -0,0 +1,253 @@
+/**
+ *  .file test/oglplus/shapes_draw_compiled.cpp
+ *  .brief Test case for the compiled shape drawing instructions.
+ *
+ *  .author Matus Chochlik
+ *
+ *  Copyright 2011-2015 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE OGLPLUS_ShapesDrawCompiled
+#include <boost/test/unit_test.hpp>
+
+#define OGLPLUS_USE_GL_DISPATCH 1
+
+#include <oglplus/gl.hpp>
+#include <oglplus/config/fix_gl_version.hpp>
+#include <oglplus/shapes/draw_compiled.hpp>
+#include <oglplus/shapes/cube.hpp>
+#include <oglplus/shapes/spiral_sphere.hpp>
+#include <oglplus/shapes/twisted_torus.hpp>
+#include <oglplus/dispatch/recorder.hpp>
+
+#include <vector>
+#include <string>
+
+namespace {
+
+// makes custom instructions with several primitive restart indices
+struct TestInstructionWriter
+ : oglplus::shapes::DrawingInstructionWriter
+{
+	static oglplus::shapes::DrawingInstructions Make(void)
+	{
+		using namespace oglplus;
+		using namespace oglplus::shapes;
+
+		DrawingInstructions instr = MakeInstructions();
+		const GLuint restart[6] = {
+			7, 7, 9,
+			DrawOperation::NoRestartIndex(),
+			9, 9
+		};
+		for(GLuint i=0; i!=6; ++i)
+		{
+			DrawOperation operation;
+			operation.method = DrawOperation::Method::DrawElements;
+			operation.mode = PrimitiveType::TriangleStrip;
+			operation.first = i*10;
+			operation.count = 10;
+			operation.restart_index = restart[i];
+			operation.phase = 0;
+			AddInstruction(instr, operation);
+		}
+		return instr;
+	}
+};
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(ShapesDrawCompiled)
+
+#if GL_VERSION_4_3 || GL_ARB_multi_draw_indirect
+BOOST_AUTO_TEST_CASE(ShapesDrawCompiled_indirect_elements)
+{
+	using namespace oglplus;
+
+	GLHeadlessRecorder recorder;
+	GLDispatchBackendScope scope(recorder);
+
+	shapes::SpiralSphere sphere;
+	shapes::DrawingInstructions instr = sphere.Instructions();
+	shapes::ElementIndexInfo index_info(sphere);
+
+	recorder.Clear();
+	instr.Draw(index_info);
+	const std::size_t op_count = instr.Operations().size();
+	BOOST_CHECK_EQUAL(recorder.CountOf("DrawElements"), op_count);
+
+	shapes::CompiledDrawingInstructions compiled(instr, index_info);
+	BOOST_CHECK(compiled.Indirect());
+	BOOST_CHECK_EQUAL(compiled.OperationCount(), op_count);
+	BOOST_CHECK(compiled.BatchCount() < op_count);
+
+	recorder.Clear();
+	compiled.Draw();
+	BOOST_CHECK_EQUAL(recorder.CountOf("DrawElements"), 0u);
+	BOOST_CHECK_EQUAL(
+		recorder.CountOf("MultiDrawElementsIndirect"),
+		compiled.BatchCount()
+	);
+	// the command buffer is bound and the previous binding restored
+	BOOST_CHECK_EQUAL(recorder.CountOf("BindBuffer"), 2u);
+	BOOST_CHECK_EQUAL(recorder.CountOf("BufferSubData"), 0u);
+#if GL_VERSION_3_1
+	BOOST_CHECK_EQUAL(recorder.CountOf("Disable"), 1u);
+#endif
+}
+
+BOOST_AUTO_TEST_CASE(ShapesDrawCompiled_indirect_arrays_phases)
+{
+	using namespace oglplus;
+
+	GLHeadlessRecorder recorder;
+	GLDispatchBackendScope scope(recorder);
+
+	shapes::TwistedTorus torus;
+	shapes::DrawingInstructions instr = torus.Instructions();
+	shapes::ElementIndexInfo index_info(torus);
+
+	std::vector<GLuint> phases, compiled_phases;
+	instr.Draw(index_info, 1, 0, [&phases](GLuint phase) -> bool
+	{
+		phases.push_back(phase);
+		return phase != 1;
+	});
+
+	shapes::CompiledDrawingInstructions compiled(instr, index_info);
+	BOOST_CHECK_EQUAL(compiled.BatchCount(), phases.size());
+
+	recorder.Clear();
+	compiled.Draw(1, 0, [&compiled_phases](GLuint phase) -> bool
+	{
+		compiled_phases.push_back(phase);
+		return phase != 1;
+	});
+	BOOST_CHECK(phases == compiled_phases);
+	BOOST_CHECK_EQUAL(recorder.CountOf("DrawArrays"), 0u);
+	BOOST_CHECK_EQUAL(
+		recorder.CountOf("MultiDrawArraysIndirect"),
+		compiled.BatchCount()-1
+	);
+}
+
+BOOST_AUTO_TEST_CASE(ShapesDrawCompiled_indirect_instanced)
+{
+	using namespace oglplus;
+
+	GLHeadlessRecorder recorder;
+	GLDispatchBackendScope scope(recorder);
+
+	shapes::Cube cube;
+	shapes::CompiledDrawingInstructions compiled(
+		cube.Instructions(shapes::DrawMode::Edges()),
+		shapes::ElementIndexInfo(cube)
+	);
+	BOOST_CHECK_EQUAL(compiled.OperationCount(), 6u);
+	BOOST_CHECK_EQUAL(compiled.BatchCount(), 1u);
+
+	recorder.Clear();
+	compiled.Draw(4, 2);
+	compiled.Draw(4, 2);
+	BOOST_CHECK_EQUAL(recorder.CountOf("MultiDrawElementsIndirect"), 2u);
+	BOOST_CHECK_EQUAL(recorder.CountOf("BufferSubData"), 1u);
+
+	recorder.Clear();
+	compiled.Draw();
+	BOOST_CHECK_EQUAL(recorder.CountOf("MultiDrawElementsIndirect"), 1u);
+	BOOST_CHECK_EQUAL(recorder.CountOf("BufferSubData"), 1u);
+}
+
+BOOST_AUTO_TEST_CASE(ShapesDrawCompiled_indirect_binding)
+{
+	using namespace oglplus;
+
+	GLHeadlessRecorder recorder;
+	GLDispatchBackendScope scope(recorder);
+	recorder.SetInteger(GL_DRAW_INDIRECT_BUFFER_BINDING, 42);
+
+	shapes::Cube cube;
+	recorder.Clear();
+	shapes::CompiledDrawingInstructions compiled(
+		cube.Instructions(shapes::DrawMode::Edges()),
+		shapes::ElementIndexInfo(cube)
+	);
+	compiled.Draw();
+
+	// each BindBuffer of the command buffer is followed by a rebinding
+	// of the previously bound buffer
+	std::vector<GLuint> bound;
+	for(std::size_t i=0, n=recorder.CallCount(); i!=n; ++i)
+	{
+		const GLCallRecord& call = recorder.Call(i);
+		if(std::string(call.name) == "BindBuffer")
+		{
+			bound.push_back(GLuint(recorder.Arg(call, 1).value.i));
+		}
+	}
+	BOOST_ASSERT(bound.size() == 4);
+	BOOST_CHECK(bound[0] != 42u);
+	BOOST_CHECK_EQUAL(bound[1], 42u);
+	BOOST_CHECK_EQUAL(bound[2], bound[0]);
+	BOOST_CHECK_EQUAL(bound[3], 42u);
+}
+#endif // GL_VERSION_4_3 || GL_ARB_multi_draw_indirect
+
+BOOST_AUTO_TEST_CASE(ShapesDrawCompiled_fallback)
+{
+	using namespace oglplus;
+
+	GLHeadlessRecorder recorder;
+	GLDispatchBackendScope scope(recorder);
+
+	shapes::Cube cube;
+	shapes::CompiledDrawingInstructions compiled(
+		cube.Instructions(shapes::DrawMode::Edges()),
+		shapes::ElementIndexInfo(cube),
+		false
+	);
+	BOOST_CHECK(!compiled.Indirect());
+
+	recorder.Clear();
+	compiled.Draw();
+	BOOST_CHECK_EQUAL(recorder.CountOf("MultiDrawElements"), 1u);
+	BOOST_CHECK_EQUAL(recorder.CountOf("DrawElements"), 0u);
+	BOOST_CHECK_EQUAL(recorder.CountOf("BindBuffer"), 0u);
+
+#if GL_VERSION_3_1
+	recorder.Clear();
+	compiled.Draw(3);
+	BOOST_CHECK_EQUAL(recorder.CountOf("MultiDrawElements"), 0u);
+	BOOST_CHECK_EQUAL(recorder.CountOf("DrawElementsInstanced"), 6u);
+#endif
+}
+
+#if GL_VERSION_3_1
+BOOST_AUTO_TEST_CASE(ShapesDrawCompiled_primitive_restart)
+{
+	using namespace oglplus;
+
+	GLHeadlessRecorder recorder;
+	GLDispatchBackendScope scope(recorder);
+
+	shapes::DrawingInstructions instr = TestInstructionWriter::Make();
+	shapes::CompiledDrawingInstructions compiled(
+		instr,
+		shapes::ElementIndexInfo(shapes::Cube()),
+		false
+	);
+	BOOST_CHECK_EQUAL(compiled.BatchCount(), 4u);
+
+	recorder.Clear();
+	compiled.Draw();
+	// 7 -> 9 -> none -> 9 -> none
+	BOOST_CHECK_EQUAL(recorder.CountOf("Enable"), 2u);
+	BOOST_CHECK_EQUAL(recorder.CountOf("PrimitiveRestartIndex"), 3u);
+	BOOST_CHECK_EQUAL(recorder.CountOf("Disable"), 2u);
+	BOOST_CHECK_EQUAL(recorder.CountOf("MultiDrawElements"), 4u);
+}
+#endif // GL_VERSION_3_1
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,254 @@
+/**
+ *  .file test/oglplus/shapes_mesh_pool.cpp
+ *  .brief Test case for the shape mesh pool.
+ *
+ *  .author Matus Chochlik
+ *
+ *  Copyright 2011-2015 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE OGLPLUS_ShapesMeshPool
+#include <boost/test/unit_test.hpp>
+
+#define OGLPLUS_USE_GL_DISPATCH 1
+
+#include <oglplus/gl.hpp>
+#include <oglplus/config/fix_gl_version.hpp>
+#include <oglplus/shapes/mesh_pool.hpp>
+#include <oglplus/shapes/cube.hpp>
+#include <oglplus/shapes/torus.hpp>
+#include <oglplus/shapes/spiral_sphere.hpp>
+#include <oglplus/shapes/twisted_torus.hpp>
+#include <oglplus/dispatch/recorder.hpp>
+
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(ShapesMeshPool)
+
+static const std::vector<oglplus::String>& test_names(void)
+{
+	static std::vector<oglplus::String> names = {
+		"Position", "Normal", "TexCoord"
+	};
+	return names;
+}
+
+static const std::vector<GLuint>& test_npvs(void)
+{
+	static std::vector<GLuint> npvs = {3, 3, 2};
+	return npvs;
+}
+
+BOOST_AUTO_TEST_CASE(ShapesMeshPool_packing)
+{
+	using namespace oglplus;
+
+	GLHeadlessRecorder recorder;
+	GLDispatchBackendScope scope(recorder);
+
+	shapes::ShapeMeshPool pool(test_names(), test_npvs());
+	shapes::Cube cube;
+	shapes::SpiralSphere sphere;
+
+	auto a = pool.Add(cube);
+	auto b = pool.Add(sphere);
+	auto c = pool.Add(cube);
+
+	BOOST_CHECK_EQUAL(pool.MeshCount(), 3u);
+	BOOST_CHECK_EQUAL(pool.BaseVertex(a), 0u);
+	BOOST_CHECK_EQUAL(pool.BaseVertex(b), pool.VertexCount(a));
+	BOOST_CHECK_EQUAL(
+		pool.BaseVertex(c),
+		pool.VertexCount(a)+pool.VertexCount(b)
+	);
+	BOOST_CHECK_EQUAL(pool.FirstIndex(b), pool.IndexCount(a));
+	BOOST_CHECK_EQUAL(pool.VertexCount(a), pool.VertexCount(c));
+
+	shapes::ShapeMeshPoolStats stats = pool.Stats();
+	BOOST_CHECK_EQUAL(stats.meshes, 3u);
+	BOOST_CHECK_EQUAL(
+		stats.vertices_used,
+		2*pool.VertexCount(a)+pool.VertexCount(b)
+	);
+	BOOST_CHECK_EQUAL(
+		stats.largest_free_vertices,
+		stats.vertex_capacity-stats.vertices_used
+	);
+	BOOST_CHECK_EQUAL(stats.growths, 0u);
+	BOOST_CHECK_EQUAL(
+		pool.AttribOffset(1),
+		GLsizeiptr(stats.vertex_capacity*3*sizeof(GLfloat))
+	);
+}
+
+BOOST_AUTO_TEST_CASE(ShapesMeshPool_free_ranges)
+{
+	using namespace oglplus;
+
+	GLHeadlessRecorder recorder;
+	GLDispatchBackendScope scope(recorder);
+
+	shapes::ShapeMeshPool pool(test_names(), test_npvs());
+	shapes::Cube cube;
+
+	auto a = pool.Add(cube);
+	auto b = pool.Add(cube);
+	auto c = pool.Add(cube);
+	const GLuint n = pool.VertexCount(a);
+
+	pool.Remove(b);
+	pool.Remove(a);
+	BOOST_CHECK_EQUAL(pool.MeshCount(), 1u);
+
+	shapes::ShapeMeshPoolStats stats = pool.Stats();
+	BOOST_CHECK_EQUAL(stats.vertices_used, n);
+	BOOST_CHECK_EQUAL(
+		stats.largest_free_vertices,
+		stats.vertex_capacity-3*n
+	);
+
+	// the freed ranges are merged and reused
+	auto d = pool.Add(cube);
+	auto e = pool.Add(cube);
+	BOOST_CHECK_EQUAL(pool.BaseVertex(d), 0u);
+	BOOST_CHECK_EQUAL(pool.BaseVertex(e), n);
+	BOOST_CHECK_EQUAL(pool.BaseVertex(c), 2*n);
+
+	pool.Remove(d);
+	recorder.Clear();
+	pool.Defragment();
+	BOOST_CHECK(recorder.CountOf("CopyBufferSubData") > 0u);
+	BOOST_CHECK_EQUAL(pool.BaseVertex(e), 0u);
+	BOOST_CHECK_EQUAL(pool.BaseVertex(c), n);
+	BOOST_CHECK_EQUAL(pool.FirstIndex(c), pool.IndexCount(e));
+	BOOST_CHECK_EQUAL(pool.Stats().defragmentations, 1u);
+}
+
+BOOST_AUTO_TEST_CASE(ShapesMeshPool_growth)
+{
+	using namespace oglplus;
+
+	GLHeadlessRecorder recorder;
+	GLDispatchBackendScope scope(recorder);
+
+	shapes::ShapeMeshPool pool(test_names(), test_npvs(), 16, 16);
+	shapes::Cube cube;
+
+	auto a = pool.Add(cube);
+	auto b = pool.Add(cube);
+
+	shapes::ShapeMeshPoolStats stats = pool.Stats();
+	BOOST_CHECK(stats.growths > 0u);
+	BOOST_CHECK_EQUAL(stats.defragmentations, 0u);
+	BOOST_CHECK(stats.vertex_capacity >= 2*pool.VertexCount(a));
+	BOOST_CHECK(stats.index_capacity >= 2*pool.IndexCount(a));
+	BOOST_CHECK_EQUAL(pool.BaseVertex(b), pool.VertexCount(a));
+}
+
+BOOST_AUTO_TEST_CASE(ShapesMeshPool_defragmentation)
+{
+	using namespace oglplus;
+
+	GLHeadlessRecorder recorder;
+	GLDispatchBackendScope scope(recorder);
+
+	shapes::Torus small(1.0, 0.5, 4, 4);
+	shapes::Torus large(1.0, 0.5, 6, 6);
+
+	shapes::ShapeMeshPool probe(test_names(), test_npvs());
+	const GLuint n = probe.VertexCount(probe.Add(small));
+	const GLuint m = probe.VertexCount(probe.Add(large));
+	BOOST_REQUIRE((n < m) && (m <= 2*n));
+
+	shapes::ShapeMeshPool pool(test_names(), test_npvs(), 3*n, 4096);
+	auto a = pool.Add(small);
+	auto b = pool.Add(small);
+	auto c = pool.Add(small);
+	pool.Remove(a);
+	pool.Remove(c);
+	BOOST_CHECK_EQUAL(pool.Stats().largest_free_vertices, n);
+
+	// fits only after compacting the remaining mesh
+	auto d = pool.Add(large);
+	shapes::ShapeMeshPoolStats stats = pool.Stats();
+	BOOST_CHECK_EQUAL(stats.defragmentations, 1u);
+	BOOST_CHECK_EQUAL(stats.growths, 0u);
+	BOOST_CHECK_EQUAL(stats.vertex_capacity, 3*n);
+	BOOST_CHECK_EQUAL(pool.BaseVertex(b), 0u);
+	BOOST_CHECK_EQUAL(pool.BaseVertex(d), n);
+}
+
+#if GL_VERSION_4_3 || GL_ARB_multi_draw_indirect
+BOOST_AUTO_TEST_CASE(ShapesMeshPool_indirect)
+{
+	using namespace oglplus;
+
+	GLHeadlessRecorder recorder;
+	GLDispatchBackendScope scope(recorder);
+
+	shapes::ShapeMeshPool pool(test_names(), test_npvs());
+	BOOST_CHECK(pool.Indirect());
+
+	shapes::SpiralSphere sphere;
+	shapes::TwistedTorus torus;
+	std::vector<shapes::ShapeMeshPool::MeshID> meshes;
+	for(int i=0; i!=10; ++i)
+	{
+		meshes.push_back(pool.Add(sphere));
+		meshes.push_back(pool.Add(torus));
+	}
+
+	recorder.Clear();
+	pool.Draw(meshes);
+	BOOST_CHECK_EQUAL(recorder.CountOf("BindVertexArray"), 1u);
+	BOOST_CHECK_EQUAL(recorder.CountOf("BufferData"), 1u);
+	// the command buffer is bound and the previous binding restored
+	BOOST_CHECK_EQUAL(recorder.CountOf("BindBuffer"), 2u);
+	BOOST_CHECK_EQUAL(recorder.CountOf("DrawElements"), 0u);
+	BOOST_CHECK_EQUAL(recorder.CountOf("DrawArrays"), 0u);
+	// both shapes use triangle strips, one draw per face winding
+	BOOST_CHECK_EQUAL(
+		recorder.CountOf("MultiDrawElementsIndirect"),
+		(sphere.FaceWinding() == torus.FaceWinding())?1u:2u
+	);
+}
+#endif
+
+BOOST_AUTO_TEST_CASE(ShapesMeshPool_base_vertex)
+{
+	using namespace oglplus;
+
+	GLHeadlessRecorder recorder;
+	GLDispatchBackendScope scope(recorder);
+
+	shapes::ShapeMeshPool pool(
+		test_names(),
+		test_npvs(),
+		64*1024,
+		256*1024,
+		false
+	);
+	BOOST_CHECK(!pool.Indirect());
+
+	pool.Add(shapes::Cube());
+	pool.Add(shapes::SpiralSphere());
+	pool.Add(shapes::TwistedTorus());
+	pool.Add(shapes::Torus());
+
+	recorder.Clear();
+	pool.DrawAll();
+	BOOST_CHECK_EQUAL(recorder.CountOf("BindVertexArray"), 1u);
+	BOOST_CHECK_EQUAL(recorder.CountOf("DrawElements"), 0u);
+	// cube triangles and the strips of the other shapes
+	BOOST_CHECK(recorder.CountOf("MultiDrawElementsBaseVertex") >= 2u);
+	BOOST_CHECK(recorder.CountOf("MultiDrawElementsBaseVertex") <= 3u);
+#if GL_VERSION_3_1
+	BOOST_CHECK_EQUAL(recorder.CountOf("Enable"), 1u);
+	BOOST_CHECK_EQUAL(recorder.CountOf("PrimitiveRestartIndex"), 1u);
+	BOOST_CHECK_EQUAL(recorder.CountOf("Disable"), 1u);
+#endif
+}
+
+BOOST_AUTO_TEST_SUITE_END()
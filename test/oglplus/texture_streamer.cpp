@@ -0,0 +1,279 @@
+/**
+ *  .file test/oglplus/texture_streamer.cpp
+ *  .brief Test case for the streaming texture uploads.
+ *
+ *  .author Matus Chochlik
+ *
+ *  Copyright 2011-2015 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE OGLPLUS_TextureStreamer
+#include <boost/test/unit_test.hpp>
+
+#define OGLPLUS_USE_GL_DISPATCH 1
+
+#include <oglplus/gl.hpp>
+#include <oglplus/config/fix_gl_version.hpp>
+#include <oglplus/texture_streamer.hpp>
+#include <oglplus/dispatch/recorder.hpp>
+
+#include <stdexcept>
+#include <cstring>
+#include <vector>
+
+// headless recorder emulating the persistent mapping and the fences
+class StreamingRecorder
+ : public oglplus::GLHeadlessRecorder
+{
+private:
+	std::vector<GLubyte> _mapped;
+public:
+	bool signaled;
+	std::vector<std::size_t> offsets;
+
+	StreamingRecorder(void)
+	 : signaled(true)
+	{ }
+
+	const GLubyte* Mapped(void) const
+	{
+		return _mapped.data();
+	}
+protected:
+	void Emulate(oglplus::GLCallInfo& call)
+	{
+		oglplus::GLHeadlessRecorder::Emulate(call);
+		if(std::strcmp(call.name, "MapBufferRange") == 0)
+		{
+			_mapped.resize(std::size_t(call.args[2].value.i));
+			call.result.value.p = _mapped.data();
+		}
+		else if(std::strcmp(call.name, "GetSynciv") == 0)
+		{
+			*static_cast<GLint*>(call.args[4].value.p) =
+				signaled?GL_SIGNALED:GL_UNSIGNALED;
+		}
+		else if(std::strcmp(call.name, "TexSubImage2D") == 0)
+		{
+			offsets.push_back(reinterpret_cast<std::size_t>(
+				call.args[8].value.p
+			));
+		}
+		else if(std::strcmp(call.name, "TexSubImage3D") == 0)
+		{
+			offsets.push_back(reinterpret_cast<std::size_t>(
+				call.args[10].value.p
+			));
+		}
+	}
+};
+
+static oglplus::images::Image make_image(
+	GLsizei w,
+	GLsizei h,
+	GLsizei d,
+	GLsizei c,
+	unsigned seed
+)
+{
+	std::vector<GLubyte> data(std::size_t(w)*h*d*c);
+	for(std::size_t i=0; i!=data.size(); ++i)
+	{
+		data[i] = GLubyte((i*37+seed*11) & 0xFF);
+	}
+	return oglplus::images::Image(w, h, d, c, data.data());
+}
+
+BOOST_AUTO_TEST_SUITE(TextureStreaming)
+
+BOOST_AUTO_TEST_CASE(TextureStreaming_upload)
+{
+	using namespace oglplus;
+
+	StreamingRecorder recorder;
+	GLDispatchBackendScope scope(recorder);
+
+	Texture texture;
+	TextureStreamer streamer(4096);
+	BOOST_CHECK_EQUAL(streamer.RingSize(), 4096u);
+	BOOST_CHECK_EQUAL(recorder.CountOf("BufferStorage"), 1u);
+
+	// the 15-byte RGB rows are padded to 16 bytes in the ring
+	for(unsigned i=0; i!=3; ++i)
+	{
+		streamer.Upload(
+			texture,
+			Texture::Target::_2D,
+			make_image(5, 3, 1, 3, i),
+			0, 0, GLint(i*3)
+		);
+	}
+	BOOST_CHECK_EQUAL(streamer.RingUsed(), 3u*48u);
+	streamer.Finish();
+	BOOST_CHECK_EQUAL(streamer.Pending(), 0u);
+	BOOST_CHECK_EQUAL(streamer.RingUsed(), 0u);
+
+	BOOST_CHECK_EQUAL(recorder.CountOf("TexSubImage2D"), 3u);
+	BOOST_CHECK_EQUAL(recorder.CountOf("FenceSync"), 1u);
+	BOOST_REQUIRE_EQUAL(recorder.offsets.size(), 3u);
+	for(unsigned i=0; i!=3; ++i)
+	{
+		BOOST_CHECK_EQUAL(recorder.offsets[i], i*48u);
+
+		images::Image image = make_image(5, 3, 1, 3, i);
+		for(std::size_t r=0; r!=3; ++r)
+		{
+			BOOST_CHECK(std::equal(
+				image.Data<GLubyte>()+r*15,
+				image.Data<GLubyte>()+r*15+15,
+				recorder.Mapped()+i*48+r*16
+			));
+		}
+	}
+
+	const TextureStreamerStats& stats = streamer.Stats();
+	BOOST_CHECK_EQUAL(stats.uploads, 3u);
+	BOOST_CHECK_EQUAL(stats.direct_uploads, 0u);
+	BOOST_CHECK_EQUAL(stats.bytes, 3u*45u);
+	BOOST_CHECK_EQUAL(stats.fences, 1u);
+	BOOST_CHECK_EQUAL(stats.stalls, 0u);
+
+	streamer.ResetStats();
+	BOOST_CHECK_EQUAL(streamer.Stats().uploads, 0u);
+}
+
+BOOST_AUTO_TEST_CASE(TextureStreaming_stall)
+{
+	using namespace oglplus;
+
+	StreamingRecorder recorder;
+	GLDispatchBackendScope scope(recorder);
+	recorder.signaled = false;
+
+	Texture texture;
+	TextureStreamer streamer(1024);
+
+	// each image takes the whole ring
+	for(unsigned i=0; i!=3; ++i)
+	{
+		streamer.Upload(
+			texture,
+			Texture::Target::_2D,
+			make_image(16, 16, 1, 4, i)
+		);
+	}
+	streamer.Finish();
+
+	BOOST_CHECK_EQUAL(recorder.CountOf("TexSubImage2D"), 3u);
+	BOOST_CHECK_EQUAL(recorder.CountOf("FenceSync"), 3u);
+	BOOST_CHECK_EQUAL(recorder.CountOf("ClientWaitSync"), 2u);
+	BOOST_CHECK_EQUAL(streamer.Stats().stalls, 2u);
+	BOOST_CHECK_EQUAL(streamer.RingUsed(), 1024u);
+
+	// the last segment is recycled once its fence signals
+	recorder.signaled = true;
+	BOOST_CHECK_EQUAL(streamer.Poll(), 0u);
+	BOOST_CHECK_EQUAL(streamer.RingUsed(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(TextureStreaming_wrap)
+{
+	using namespace oglplus;
+
+	StreamingRecorder recorder;
+	GLDispatchBackendScope scope(recorder);
+	recorder.signaled = false;
+
+	Texture texture;
+	TextureStreamer streamer(1024);
+
+	// 400-byte images, the third does not fit at the end of the ring
+	for(unsigned i=0; i!=3; ++i)
+	{
+		streamer.Upload(
+			texture,
+			Texture::Target::_2D,
+			make_image(10, 10, 1, 4, i)
+		);
+		streamer.Finish();
+	}
+	BOOST_REQUIRE_EQUAL(recorder.offsets.size(), 3u);
+	BOOST_CHECK_EQUAL(recorder.offsets[0], 0u);
+	BOOST_CHECK_EQUAL(recorder.offsets[1], 400u);
+	BOOST_CHECK_EQUAL(recorder.offsets[2], 0u);
+	BOOST_CHECK_EQUAL(streamer.Stats().stalls, 1u);
+	BOOST_CHECK_EQUAL(streamer.RingUsed(), 400u+624u);
+}
+
+BOOST_AUTO_TEST_CASE(TextureStreaming_direct_and_3D)
+{
+	using namespace oglplus;
+
+	StreamingRecorder recorder;
+	GLDispatchBackendScope scope(recorder);
+
+	Texture texture;
+	TextureStreamer streamer(256);
+
+	streamer.Upload(
+		texture,
+		Texture::Target::_2DArray,
+		make_image(4, 4, 2, 4, 0),
+		0, 0, 0, 1
+	);
+	streamer.Upload(
+		texture,
+		Texture::Target::_2D,
+		make_image(16, 16, 1, 4, 1)
+	);
+	// the queued upload is issued before the direct one
+	BOOST_CHECK_EQUAL(streamer.Pending(), 0u);
+	BOOST_CHECK_EQUAL(recorder.CountOf("TexSubImage3D"), 1u);
+	BOOST_CHECK_EQUAL(recorder.CountOf("TexSubImage2D"), 1u);
+	BOOST_REQUIRE_EQUAL(recorder.offsets.size(), 2u);
+	BOOST_CHECK_EQUAL(recorder.offsets[0], 0u);
+	BOOST_CHECK(recorder.offsets[1] != 0u);
+
+	BOOST_CHECK_EQUAL(streamer.Stats().uploads, 1u);
+	BOOST_CHECK_EQUAL(streamer.Stats().direct_uploads, 1u);
+	BOOST_CHECK_EQUAL(streamer.Stats().bytes, 128u+1024u);
+}
+
+BOOST_AUTO_TEST_CASE(TextureStreaming_1D_target)
+{
+	using namespace oglplus;
+
+	StreamingRecorder recorder;
+	GLDispatchBackendScope scope(recorder);
+
+	Texture texture;
+	TextureStreamer streamer(256);
+
+	BOOST_CHECK_THROW(
+		streamer.Upload(
+			texture,
+			Texture::Target::_1D,
+			make_image(16, 1, 1, 4, 0)
+		),
+		std::runtime_error
+	);
+	// the large image would be uploaded directly
+	BOOST_CHECK_THROW(
+		streamer.Upload(
+			texture,
+			Texture::Target::_1D,
+			make_image(256, 1, 1, 4, 0)
+		),
+		std::runtime_error
+	);
+	BOOST_CHECK_EQUAL(streamer.Pending(), 0u);
+	BOOST_CHECK_EQUAL(streamer.RingUsed(), 0u);
+	BOOST_CHECK_EQUAL(recorder.CountOf("TexSubImage1D"), 0u);
+
+	streamer.Finish();
+	BOOST_CHECK_EQUAL(recorder.CountOf("FenceSync"), 0u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
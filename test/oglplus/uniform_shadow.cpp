@@ -0,0 +1,246 @@
+/**
+ *  .file test/oglplus/uniform_shadow.cpp
+ *  .brief Test case for the redundant uniform update elimination.
+ *
+ *  .author Matus Chochlik
+ *
+ *  Copyright 2011-2015 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE OGLPLUS_UniformShadow
+#include <boost/test/unit_test.hpp>
+
+#define OGLPLUS_USE_GL_DISPATCH 1
+#define OGLPLUS_SHADOW_UNIFORM_VALUES 1
+
+#include <oglplus/gl.hpp>
+#include <oglplus/config/fix_gl_version.hpp>
+#include <oglplus/math/vector.hpp>
+#include <oglplus/math/matrix.hpp>
+#include <oglplus/program.hpp>
+#include <oglplus/uniform.hpp>
+#include <oglplus/dsa/uniform.hpp>
+#include <oglplus/prog_var/shadow.hpp>
+#include <oglplus/error/deferred.hpp>
+#include <oglplus/dispatch/recorder.hpp>
+
+#include <cstring>
+
+// headless recorder failing the glUniform1f calls when requested
+class FailingUniformRecorder
+ : public oglplus::GLHeadlessRecorder
+{
+private:
+	GLenum _error;
+protected:
+	void Emulate(oglplus::GLCallInfo& call)
+	{
+		oglplus::GLHeadlessRecorder::Emulate(call);
+		if(std::strcmp(call.name, "GetError") == 0)
+		{
+			call.result.value.i = _error;
+			_error = GL_NO_ERROR;
+		}
+		else if(fail && std::strcmp(call.name, "Uniform1f") == 0)
+		{
+			// for example the program is not current
+			_error = GL_INVALID_OPERATION;
+		}
+	}
+public:
+	bool fail;
+
+	FailingUniformRecorder(void)
+	 : _error(GL_NO_ERROR)
+	 , fail(false)
+	{ }
+};
+
+BOOST_AUTO_TEST_SUITE(UniformShadowing)
+
+BOOST_AUTO_TEST_CASE(UniformShadowing_scalars)
+{
+	using namespace oglplus;
+
+	GLHeadlessRecorder recorder;
+	GLDispatchBackendScope scope(recorder);
+
+	Program prog;
+	prog.Link();
+	UniformShadow::ResetStats();
+
+	Uniform<GLfloat> scale(UniformLoc(prog, 3));
+	Uniform<GLint> index(UniformLoc(prog, 4));
+	recorder.Clear();
+
+	scale.Set(1.0f);
+	scale.Set(1.0f);
+	scale.Set(2.0f);
+	index.Set(2);
+	index.Set(2);
+
+	BOOST_CHECK_EQUAL(recorder.CountOf("Uniform1f"), 2u);
+	BOOST_CHECK_EQUAL(recorder.CountOf("Uniform1i"), 1u);
+	BOOST_CHECK_EQUAL(UniformShadow::Stats().writes, 3u);
+	BOOST_CHECK_EQUAL(UniformShadow::Stats().skips, 2u);
+}
+
+BOOST_AUTO_TEST_CASE(UniformShadowing_vectors_and_matrices)
+{
+	using namespace oglplus;
+
+	GLHeadlessRecorder recorder;
+	GLDispatchBackendScope scope(recorder);
+
+	Program prog;
+	prog.Link();
+
+	Uniform<Vec3f> color(UniformLoc(prog, 1));
+	Uniform<Mat4f> matrix(UniformLoc(prog, 2));
+	ProgramUniform<Vec3f> dsa_color(UniformLoc(prog, 5));
+	recorder.Clear();
+
+	color.Set(Vec3f(1, 2, 3));
+	color.Set(Vec3f(1, 2, 3));
+	color.Set(Vec3f(1, 2, 4));
+	matrix.Set(Mat4f());
+	matrix.Set(Mat4f());
+	dsa_color.Set(Vec3f(1, 2, 3));
+	dsa_color.Set(Vec3f(1, 2, 3));
+
+	BOOST_CHECK_EQUAL(recorder.CountOf("Uniform3fv"), 2u);
+	BOOST_CHECK_EQUAL(recorder.CountOf("UniformMatrix4fv"), 1u);
+	BOOST_CHECK_EQUAL(recorder.CountOf("ProgramUniform3fv"), 1u);
+}
+
+BOOST_AUTO_TEST_CASE(UniformShadowing_arrays)
+{
+	using namespace oglplus;
+
+	GLHeadlessRecorder recorder;
+	GLDispatchBackendScope scope(recorder);
+
+	Program prog;
+	prog.Link();
+
+	Uniform<GLfloat> array(UniformLoc(prog, 10));
+	Uniform<GLfloat> element(UniformLoc(prog, 12));
+	recorder.Clear();
+
+	const GLfloat values[4] = {1, 2, 3, 4};
+	array.SetValues(4, values);
+	array.SetValues(4, values);
+	BOOST_CHECK_EQUAL(recorder.CountOf("Uniform1fv"), 1u);
+
+	// the element shadows are updated by the array writes
+	element.Set(3.0f);
+	BOOST_CHECK_EQUAL(recorder.CountOf("Uniform1f"), 0u);
+
+	// and the array shadow by the element writes
+	element.Set(5.0f);
+	array.SetValues(4, values);
+	BOOST_CHECK_EQUAL(recorder.CountOf("Uniform1f"), 1u);
+	BOOST_CHECK_EQUAL(recorder.CountOf("Uniform1fv"), 2u);
+}
+
+BOOST_AUTO_TEST_CASE(UniformShadowing_exclude_and_invalidate)
+{
+	using namespace oglplus;
+
+	GLHeadlessRecorder recorder;
+	GLDispatchBackendScope scope(recorder);
+
+	Program prog;
+	prog.Link();
+
+	Uniform<GLfloat> scale(UniformLoc(prog, 3));
+	Uniform<GLfloat> bias(UniformLoc(prog, 4));
+	recorder.Clear();
+
+	UniformShadow::Exclude(scale);
+	scale.Set(1.0f);
+	scale.Set(1.0f);
+	BOOST_CHECK_EQUAL(recorder.CountOf("Uniform1f"), 2u);
+
+	bias.Set(1.0f);
+	UniformShadow::Invalidate(bias);
+	bias.Set(1.0f);
+	BOOST_CHECK_EQUAL(recorder.CountOf("Uniform1f"), 4u);
+
+	// linking resets the uniform values
+	prog.Link();
+	bias.Set(1.0f);
+	BOOST_CHECK_EQUAL(recorder.CountOf("Uniform1f"), 5u);
+
+	// but not the exclusions
+	scale.Set(1.0f);
+	scale.Set(1.0f);
+	BOOST_CHECK_EQUAL(recorder.CountOf("Uniform1f"), 7u);
+
+	UniformShadow::Exclude(scale, false);
+	scale.Set(1.0f);
+	scale.Set(1.0f);
+	BOOST_CHECK_EQUAL(recorder.CountOf("Uniform1f"), 8u);
+}
+
+BOOST_AUTO_TEST_CASE(UniformShadowing_exclusion_survives_invalidation)
+{
+	using namespace oglplus;
+
+	GLHeadlessRecorder recorder;
+	GLDispatchBackendScope scope(recorder);
+
+	Program prog, other;
+	prog.Link();
+	other.Link();
+
+	Uniform<GLfloat> scale(UniformLoc(prog, 3));
+	Uniform<GLfloat> bias(UniformLoc(prog, 4));
+	UniformShadow::Exclude(scale);
+	bias.Set(1.0f);
+	recorder.Clear();
+
+	// bump the generation by invalidating another program
+	UniformShadow::Invalidate(other);
+	scale.Set(1.0f);
+	scale.Set(1.0f);
+	BOOST_CHECK_EQUAL(recorder.CountOf("Uniform1f"), 2u);
+
+	// the values of the other programs are kept
+	bias.Set(1.0f);
+	BOOST_CHECK_EQUAL(recorder.CountOf("Uniform1f"), 2u);
+
+	UniformShadow::Clear();
+	scale.Set(1.0f);
+	scale.Set(1.0f);
+	BOOST_CHECK_EQUAL(recorder.CountOf("Uniform1f"), 4u);
+}
+
+BOOST_AUTO_TEST_CASE(UniformShadowing_deferred_error)
+{
+	using namespace oglplus;
+
+	FailingUniformRecorder recorder;
+	GLDispatchBackendScope scope(recorder);
+
+	Program prog;
+	prog.Link();
+
+	Uniform<GLfloat> scale(UniformLoc(prog, 6));
+	recorder.Clear();
+	{
+		ErrorCheckScope deferred(ErrorCheckPolicy::Deferred);
+		recorder.fail = true;
+		scale.Set(1.0f);
+		recorder.fail = false;
+		BOOST_CHECK_THROW(deferred.Flush(), DeferredError);
+	}
+	// the failed write is not remembered
+	scale.Set(1.0f);
+	scale.Set(1.0f);
+	BOOST_CHECK_EQUAL(recorder.CountOf("Uniform1f"), 2u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,147 @@
+/**
+ *  .file test/oglplus/utf8.cpp
+ *  .brief Test case for the UTF-8 conversions and validation.
+ *
+ *  .author Matus Chochlik
+ *
+ *  Copyright 2011-2015 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE OGLPLUS_UTF8
+#include <boost/test/unit_test.hpp>
+
+#include <oglplus/string/utf8.hpp>
+
+#include <string>
+#include <vector>
+
+struct utf8_sample
+{
+	const char* utf8;
+	const char32_t* code_points;
+};
+
+static const utf8_sample samples[] = {
+	{"Hello World!", U"Hello World!"},
+	{u8"Příliš žluťoučký kůň",
+	  U"Příliš žluťoučký kůň"},
+	{u8"日本語のテキスト",
+	  U"日本語のテキスト"},
+	{u8"\U0001F600\U0001F680 \U0001F44D!", U"\U0001F600\U0001F680 \U0001F44D!"}
+};
+
+// repeats the sample after a prefix of ASCII characters
+static void make_text(
+	const utf8_sample& sample,
+	std::size_t prefix,
+	std::size_t repeat,
+	std::string& utf8,
+	std::u32string& code_points
+)
+{
+	utf8.assign(prefix, 'x');
+	code_points.assign(prefix, U'x');
+	for(std::size_t r=0; r!=repeat; ++r)
+	{
+		utf8.append(sample.utf8);
+		code_points.append(sample.code_points);
+	}
+}
+
+BOOST_AUTO_TEST_SUITE(UTF8)
+
+BOOST_AUTO_TEST_CASE(UTF8_decode_encode)
+{
+	using namespace oglplus::aux;
+
+	std::string utf8;
+	std::u32string expected;
+	std::vector<UnicodeCP> decoded;
+	std::vector<char> encoded;
+
+	for(const utf8_sample& sample: samples)
+	for(std::size_t prefix=0; prefix!=40; ++prefix)
+	for(std::size_t repeat=0; repeat!=5; ++repeat)
+	{
+		make_text(sample, prefix, repeat, utf8, expected);
+
+		BOOST_CHECK_EQUAL(
+			CodePointsRequired(utf8.data(), utf8.size()),
+			expected.size()
+		);
+		ConvertUTF8ToCodePoints(utf8.data(), utf8.size(), decoded);
+		BOOST_REQUIRE_EQUAL(decoded.size(), expected.size());
+		BOOST_CHECK(std::equal(
+			decoded.begin(),
+			decoded.end(),
+			expected.begin()
+		));
+
+		BOOST_CHECK_EQUAL(
+			UTF8BytesRequired(expected.data(), expected.size()),
+			utf8.size()
+		);
+		ConvertCodePointsToUTF8(expected.data(), expected.size(), encoded);
+		BOOST_REQUIRE_EQUAL(encoded.size(), utf8.size());
+		BOOST_CHECK(std::equal(
+			encoded.begin(),
+			encoded.end(),
+			utf8.begin()
+		));
+	}
+}
+
+BOOST_AUTO_TEST_CASE(UTF8_code_point)
+{
+	using namespace oglplus::aux;
+
+	const UnicodeCP cps[] = {
+		0x24, 0x7F, 0x80, 0xA2, 0x7FF, 0x800, 0x20AC,
+		0xFFFF, 0x10000, 0x10348, 0x10FFFF
+	};
+	const std::size_t lens[] = {1, 1, 2, 2, 2, 3, 3, 3, 4, 4, 4};
+
+	for(std::size_t i=0; i!=sizeof(lens)/sizeof(lens[0]); ++i)
+	{
+		char str[6];
+		std::size_t len = 0, cp_len = 0;
+		ConvertCodePointToUTF8(cps[i], str, len);
+		BOOST_CHECK_EQUAL(len, lens[i]);
+		BOOST_CHECK_EQUAL(UTF8BytesRequired(cps+i, 1), lens[i]);
+		BOOST_CHECK(ConvertUTF8ToCodePoint(str, len, cp_len) == cps[i]);
+		BOOST_CHECK_EQUAL(cp_len, lens[i]);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(UTF8_validate)
+{
+	using namespace oglplus::aux;
+
+	std::string utf8;
+	std::u32string expected;
+
+	for(const utf8_sample& sample: samples)
+	for(std::size_t prefix=0; prefix!=40; ++prefix)
+	{
+		make_text(sample, prefix, 3, utf8, expected);
+		BOOST_CHECK(ValidUTF8(utf8.data(), utf8.data()+utf8.size()));
+
+		// an unexpected continuation byte after a lead byte
+		std::string invalid = utf8;
+		invalid.append(std::string(prefix, 'y'));
+		invalid.append("\xC3\x28");
+		invalid.append(std::string(20, 'z'));
+		BOOST_CHECK(!ValidUTF8(invalid.data(), invalid.data()+invalid.size()));
+
+		// the validation stops at zero bytes
+		invalid = utf8;
+		invalid.insert(invalid.begin()+std::ptrdiff_t(prefix), '\0');
+		BOOST_CHECK(!ValidUTF8(invalid.data(), invalid.data()+invalid.size()));
+	}
+	const char overlong[] = "abcdefghijklmnopqrstuvwxyz\xC0\x80";
+	BOOST_CHECK(!ValidUTF8(overlong, overlong+sizeof(overlong)-1));
+}
+
+BOOST_AUTO_TEST_SUITE_END()